@@ -22,8 +22,9 @@ INCLUDE_FLAGS := -Iengine/src -I$(VULKAN_SDK)/include
 # -I              : Adds include directories for header resolution
 
 # Linker flags
-LINKER_FLAGS := -g -shared -lvulkan -lxcb -lX11 -lX11-xcb -lxkbcommon -L$(VULKAN_SDK)/lib -L/usr/X11R6/lib
+LINKER_FLAGS := -g -shared -lpthread -lvulkan -lxcb -lX11 -lX11-xcb -lxkbcommon -L$(VULKAN_SDK)/lib -L/usr/X11R6/lib
 # -shared         : Builds a shared object (.so)
+# -lpthread       : POSIX threads (job system workers)
 # -lvulkan        : Links against Vulkan SDK
 # -lxcb           : XCB support for windowing
 # -lX11          : X11 compatibility layer
@@ -0,0 +1,92 @@
+# Makefile.packer.linux.mak
+# Purpose: Build the asset packer, which packs assets/ into a .kpak archive.
+
+# Output directories
+BUILD_DIR := bin
+OBJ_DIR := obj
+
+# Binary name and extension
+ASSEMBLY := packer
+EXTENSION := 
+
+# Compiler flags
+COMPILER_FLAGS := -g -MD -Werror=vla -fdeclspec -fPIC
+# -g             : Debug symbols for GDB
+# -MD           : Generate dependency files (.d) for header tracking
+# -Werror=vla   : Treat variable-length arrays as errors (enforces strict C99 compliance)
+#                  This is useful for catching potential issues early.
+# -fdeclspec     : Allows dllimport/dlexport syntax
+# -fPIC          : Required for position-independent code (even for executables)
+
+# Include paths
+INCLUDE_FLAGS := -Iengine/src -Ipacker\src
+# Includes headers from engine and Vulkan SDK
+
+# Linker flags
+LINKER_FLAGS := -L./$(BUILD_DIR)/ -lengine -Wl,-rpath,. -lm
+# -L...           : Looks for libengine.so in bin/
+# -lengine        : Links with libengine.so
+# -Wl,-rpath,.   : Tells the binary where to look for shared libraries at runtime
+
+# Defines
+DEFINES := -D_DEBUG -DKIMPORT
+# -D_DEBUG        : Enables debug logging and asserts
+# -DKIMPORT       : Treats engine functions as imported (from .so)
+
+# Recursive wildcard function (not used yet but available)
+# rwildcard=$(wildcard $1$2) $(foreach d,$(wildcard $1*),$(call rwildcard,$d/,$2))
+
+# Source files
+SRC_FILES := $(shell find $(ASSEMBLY) -name *.c)
+# Finds all C files inside the packer directory
+
+# Directories (for scaffolding)
+DIRECTORIES := $(shell find $(ASSEMBLY) -type d)
+# Used to create obj/packer directory structure
+
+# Object files
+OBJ_FILES := $(SRC_FILES:%=$(OBJ_DIR)/%.o)
+# Maps each .c file to a corresponding .o in obj/
+
+# Targets
+all: log-start scaffold compile link log-finish
+# Default target — runs log start time, scaffold, compile, link and log finish time
+
+.PHONY: log-start
+log-start: # Logs build start time (EAT)
+	@echo "===== Build started at $$(TZ=Africa/Nairobi date +'%Y-%m-%d %H:%M:%S.%3N %Z') ====="
+
+.PHONY: log-finish
+log-finish: # Logs build finish time (EAT)
+	@echo "===== Build finished at $$(TZ=Africa/Nairobi date +'%Y-%m-%d %H:%M:%S.%3N %Z') ====="
+
+.PHONY: scaffold
+scaffold: # Create folder structure for object files
+	@echo Scaffolding folder structure...
+	@mkdir -p $(addprefix $(OBJ_DIR)/,$(DIRECTORIES))
+	@echo Done.
+
+.PHONY: link
+link: scaffold $(OBJ_FILES) # Link the packer executable
+	@echo Linking $(ASSEMBLY)...
+	clang $(OBJ_FILES) -o $(BUILD_DIR)/$(ASSEMBLY)$(EXTENSION) $(LINKER_FLAGS) -lm
+# Links packer main.c with libengine.so and other dependencies
+
+.PHONY: compile
+compile: # Compile all .c files into .o
+	@echo Compiling...
+
+.PHONY: clean
+clean: # Clean up build artifacts
+	rm -rf $(BUILD_DIR)/$(ASSEMBLY)
+	rm -rf $(OBJ_DIR)/$(ASSEMBLY)
+
+# Rule to compile .c -> .o
+$(OBJ_DIR)/%.c.o: %.c # Compile each .c file
+	@echo   $<...
+	@clang $< $(COMPILER_FLAGS) -c -o $@ $(DEFINES) $(INCLUDE_FLAGS)
+# Compiles individual C files with debug info and Vulkan includes
+
+-include $(OBJ_FILES:.o=.d)
+# Include dependency files generated by -MD
+# This allows Make to track header dependencies and rebuild as needed
\ No newline at end of file
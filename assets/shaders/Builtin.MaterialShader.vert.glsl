@@ -4,16 +4,14 @@
 layout(location = 0) in vec3 in_position;
 layout(location = 1) in vec2 in_texcoord;
 
+// Per instance. A mat4 takes locations 2 to 5.
+layout(location = 2) in mat4 in_model;
+
 layout(set = 0, binding = 0) uniform global_uniform_object {
     mat4 projection;
     mat4 view;
 } global_ubo;
 
-layout(push_constant) uniform push_constants {
-    // Only guarantee a total of 128 bytes
-    mat4 model; // 64 bytes
-} u_push_constants;
-
 layout(location = 0) out int out_mode;
 
 // Data Transfer Object
@@ -23,5 +21,5 @@ layout(location = 1) out struct dto {
 
 void main() {
     out_dto.tex_coord = in_texcoord;
-    gl_Position = global_ubo.projection * global_ubo.view * u_push_constants.model * vec4(in_position, 1.0);
+    gl_Position = global_ubo.projection * global_ubo.view * in_model * vec4(in_position, 1.0);
 }
\ No newline at end of file
@@ -27,5 +27,11 @@ IF %ERRORLEVEL% NEQ 0 (
     echo Error:%ERRORLEVEL% && exit
 )
 
+REM Asset packer
+make -f "Makefile.packer.windows.mak" all
+IF %ERRORLEVEL% NEQ 0 (
+    echo Error:%ERRORLEVEL% && exit
+)
+
 REM Success message
 ECHO "All assemblies built successfully."
\ No newline at end of file
@@ -33,5 +33,15 @@ then
     echo "Error:"$ERRORLEVEL && exit
 fi
 
+# Asset packer
+make -f Makefile.packer.linux.mak all
+
+# Check again
+ERRORLEVEL=$?
+if [ $ERRORLEVEL -ne 0 ]
+then
+    echo "Error:"$ERRORLEVEL && exit
+fi
+
 # Final success message
 echo "All assemblies built successfully."
\ No newline at end of file
@@ -13,4 +13,9 @@ make -f "Makefile.testbed.windows.mak" clean
 
 IF %ERRORLEVEL% NEQ 0 (echo Error:%ERRORLEVEL% && exit)
 
+REM Asset packer
+make -f "Makefile.packer.windows.mak" clean
+
+IF %ERRORLEVEL% NEQ 0 (echo Error:%ERRORLEVEL% && exit)
+
 ECHO "All assemblies cleaned successfully."
\ No newline at end of file
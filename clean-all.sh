@@ -17,4 +17,11 @@ if [ $? -ne 0 ]; then
     exit 1
 fi
 
+# Asset packer
+make -f Makefile.packer.linux.mak clean
+if [ $? -ne 0 ]; then
+    echo "Error: $?"
+    exit 1
+fi
+
 echo "All assemblies cleaned successfully."
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include "handle_pool.h"
+
+#include "core/kmemory.h"
+#include "core/logger.h"
+
+/**
+ * @file handle_pool.c
+ *
+ * @brief Implementation of the handle pool.
+ */
+
+b8 handle_pool_create(u32 capacity, u64* memory_requirement, void* memory, handle_pool* out_pool) {
+    if (!memory_requirement) {
+        KERROR("handle_pool_create requires a valid pointer to memory_requirement.");
+        return False;
+    }
+
+    // Every index must fit below INVALID_ID.
+    if (!capacity || capacity == INVALID_ID) {
+        KERROR("handle_pool_create requires a capacity between 1 and %u.", INVALID_ID - 1);
+        return False;
+    }
+
+    // The free stack, then the generations.
+    *memory_requirement = sizeof(u32) * capacity * 2;
+
+    if (!memory) {
+        return True;
+    }
+
+    if (!out_pool) {
+        KERROR("handle_pool_create requires a valid pointer to out_pool.");
+        return False;
+    }
+
+    out_pool->capacity = capacity;
+    out_pool->free_slots = memory;
+    out_pool->generations = out_pool->free_slots + capacity;
+
+    // Lowest index on top, so slots are handed out in order.
+    for (u32 i = 0; i < capacity; ++i) {
+        out_pool->free_slots[i] = capacity - 1 - i;
+    }
+    out_pool->free_count = capacity;
+    kzero_memory(out_pool->generations, sizeof(u32) * capacity);
+
+    return True;
+}
+
+void handle_pool_destroy(handle_pool* pool) {
+    if (pool) {
+        kzero_memory(pool, sizeof(handle_pool));
+    }
+}
+
+b8 handle_pool_acquire(handle_pool* pool, khandle* out_handle) {
+    if (!pool || !out_handle || pool->free_count == 0) {
+        return False;
+    }
+
+    u32 index = pool->free_slots[--pool->free_count];
+    u32 generation = ++pool->generations[index];
+    *out_handle = ((u64)generation << 32) | index;
+    return True;
+}
+
+b8 handle_pool_release(handle_pool* pool, khandle handle) {
+    if (!handle_pool_is_valid(pool, handle)) {
+        KWARN("handle_pool_release called with a stale or invalid handle 0x%llx. Nothing was released.", handle);
+        return False;
+    }
+
+    u32 index = handle_pool_index(handle);
+    pool->generations[index]++;
+    pool->free_slots[pool->free_count++] = index;
+    return True;
+}
+
+b8 handle_pool_is_valid(const handle_pool* pool, khandle handle) {
+    if (!pool || !pool->generations) {
+        return False;
+    }
+
+    u32 index = handle_pool_index(handle);
+    u32 generation = handle_pool_generation(handle);
+    return index < pool->capacity && (generation & 1) && pool->generations[index] == generation;
+}
+
+khandle handle_pool_handle_at(const handle_pool* pool, u32 index) {
+    if (!pool || index >= pool->capacity || !(pool->generations[index] & 1)) {
+        return KHANDLE_INVALID;
+    }
+    return ((u64)pool->generations[index] << 32) | index;
+}
+
+u32 handle_pool_live_count(const handle_pool* pool) {
+    return pool ? pool->capacity - pool->free_count : 0;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * @file handle_pool.h
+ *
+ * @brief Hands out slots of a fixed-size array as generational handles.
+ *
+ * A handle holds the index of its slot in the low 32 bits, and the generation of that slot in
+ * the high 32 bits. Free slots are kept on a stack, so acquiring and releasing are O(1) no matter
+ * how large the array is.
+ *
+ * Each slot's generation is bumped both when it is acquired and when it is released, so it is
+ * odd while the slot is live and even while it is free. A handle is valid only while its slot is
+ * live and its generation matches. Once a slot is released and reused, handles to its previous
+ * occupant stop matching, and a handle released twice is caught rather than freeing the slot's
+ * next occupant. The zero handle is never valid.
+ *
+ * The stack and generations live in a caller-provided block. Like the engine's systems, the pool
+ * is created in two passes: once to obtain the memory requirement, then again with a block of
+ * that size.
+ *
+ * NOTE: Not thread-safe. Callers sharing a pool across threads must synchronize access.
+ */
+
+/** @brief A handle to a slot: the index in the low 32 bits, and the generation in the high 32 bits. */
+typedef u64 khandle;
+
+/** @brief A handle that never refers to a slot. */
+#define KHANDLE_INVALID 0
+
+/**
+ * @struct handle_pool
+ *
+ * @brief Represents a handle pool. Members should not be modified outside the handle_pool_ functions.
+ */
+typedef struct handle_pool {
+    u32 capacity;      // Number of slots.
+    u32 free_count;    // Number of slots on the free stack.
+    u32* free_slots;   // Stack of free slot indices, the next to hand out on top.
+    u32* generations;  // Generation of each slot. Odd while live, even while free.
+} handle_pool;
+
+/**
+ * @brief Creates a handle pool with every slot free. Slots are handed out lowest index first
+ * until they have all been used once.
+ *
+ * Should be called twice; once with memory = 0 to obtain the memory requirement, then a
+ * second time passing a block of that size.
+ *
+ * @param capacity The number of slots.
+ * @param memory_requirement A pointer to hold the size of the block the pool needs.
+ * @param memory A block of memory_requirement bytes, or 0 to only obtain the memory requirement.
+ * @param out_pool Pointer to the handle_pool structure to initialize. Ignored when memory is 0.
+ * @return True on success; otherwise False.
+ */
+KAPI b8 handle_pool_create(u32 capacity, u64* memory_requirement, void* memory, handle_pool* out_pool);
+
+/**
+ * @brief Destroys the pool. The block holding its slots is not freed, as it belongs to the caller.
+ *
+ * @param pool Pointer to the handle_pool structure to destroy.
+ */
+KAPI void handle_pool_destroy(handle_pool* pool);
+
+/**
+ * @brief Takes a free slot.
+ *
+ * @param pool Pointer to the pool.
+ * @param out_handle A pointer to hold the handle of the slot.
+ * @return True if a slot was free; otherwise False.
+ */
+KAPI b8 handle_pool_acquire(handle_pool* pool, khandle* out_handle);
+
+/**
+ * @brief Gives a slot back, invalidating every handle to it.
+ *
+ * @param pool Pointer to the pool.
+ * @param handle The handle of the slot.
+ * @return True if the handle was valid; otherwise False, and nothing is released.
+ */
+KAPI b8 handle_pool_release(handle_pool* pool, khandle handle);
+
+/**
+ * @brief Checks whether a handle still refers to a live slot.
+ *
+ * @param pool Pointer to the pool.
+ * @param handle The handle to check.
+ * @return True if the slot is live and was not released since the handle was acquired.
+ */
+KAPI b8 handle_pool_is_valid(const handle_pool* pool, khandle handle);
+
+/**
+ * @brief Gets the handle of a live slot from its index.
+ *
+ * For registries whose public ids are plain indices.
+ *
+ * @param pool Pointer to the pool.
+ * @param index The index of the slot.
+ * @return The handle of the slot, or KHANDLE_INVALID if the slot is free or out of range.
+ */
+KAPI khandle handle_pool_handle_at(const handle_pool* pool, u32 index);
+
+/**
+ * @brief Gets the number of live slots.
+ *
+ * @param pool Pointer to the pool.
+ * @return The number of slots acquired and not yet released.
+ */
+KAPI u32 handle_pool_live_count(const handle_pool* pool);
+
+/**
+ * @brief Gets the index of the slot a handle refers to.
+ *
+ * @param handle The handle.
+ * @return The index of the slot.
+ */
+KINLINE u32 handle_pool_index(khandle handle) {
+    return (u32)(handle & 0xFFFFFFFFull);
+}
+
+/**
+ * @brief Gets the generation of the slot a handle was acquired at.
+ *
+ * @param handle The handle.
+ * @return The generation.
+ */
+KINLINE u32 handle_pool_generation(khandle handle) {
+    return (u32)(handle >> 32);
+}
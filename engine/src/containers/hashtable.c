@@ -1,56 +1,264 @@
 #include "hashtable.h"
 
 #include "core/kmemory.h"
+#include "core/kstring.h"
 #include "core/logger.h"
 
 /**
  * @file hashtable.c
- * @brief Implementation of a simple hashtable.
+ * @brief Implementation of an open-addressing hashtable.
  *
- * This module provides a basic hashtable implementation that supports storing and retrieving
- * both pointer and non-pointer types. It uses a simple hashing function to map string keys to
- * indices in a fixed-size array.
+ * This module provides a hashtable implementation that supports storing and retrieving
+ * both pointer and non-pointer types. Keys are hashed to a 64-bit value, the upper bits of
+ * which select the starting slot and the lower 7 bits of which are kept in a per-slot control
+ * byte. Lookups probe linearly from the starting slot, comparing control bytes first and only
+ * falling back to the full hash and key compare on a control byte match.
  *
  * Usage:
  * - Create a hashtable with `hashtable_create()`, providing element size, count, memory block, and type info.
  * - Use `hashtable_set()` and `hashtable_get()` for non-pointer types.
  * - Use `hashtable_set_ptr()` and `hashtable_get_ptr()` for pointer types.
+ * - Use `hashtable_remove()` to delete entries.
  * - Destroy the hashtable with `hashtable_destroy()`.
  *
  * Note:
- * - The hashtable does not handle collisions; ensure unique keys or increase element count.
+ * - Removing an entry leaves a tombstone so that probe chains passing through it stay intact.
+ *   Tombstones are reused by later inserts and purged whenever the table is rehashed.
  * - Memory management for pointer types is the responsibility of the caller.
  */
 
+/** @brief Control byte marking a slot that has never held an entry. Terminates a probe. */
+#define CONTROL_EMPTY 0x80
+
+/** @brief Control byte marking a slot whose entry was removed. Probes continue past it. */
+#define CONTROL_DELETED 0xFE
+
+/** @brief Maximum load factor (occupied + tombstones) before a rehash, as a fraction of 8. */
+#define MAX_LOAD_EIGHTHS 7
+
 /**
  * @brief Generates a hash value for a given string.
  *
- * Uses a simple hashing algorithm to compute a hash based on character values and a prime multiplier.
- * The resulting hash is then modded by the element_count to ensure it fits within the table size.
- *
- * Simple hash function for strings, based on [djb2 by Dan Bernstein](https://theartincode.stanis.me/008-djb2/).
+ * Uses 64-bit FNV-1a, which spreads short, similar names (i.e. "texture_01", "texture_02")
+ * far better than the previous multiply-by-97 scheme. The full hash is returned; callers
+ * derive the slot index and control byte from it.
  *
  * @param name The input string to hash.
- * @param element_count The size of the hashtable (number of elements).
- * @return A hash value in the range [0, element_count - 1].
+ * @return A 64-bit hash value.
  */
-u64 hash_name(const char* name, u32 element_count) {
-    // A multipler to use when generating a hash. Prime to hopefully avoid collisions.
-    static const u64 multiplier = 97;
+static u64 hash_name(const char* name) {
+    static const u64 offset_basis = 14695981039346656037ULL;
+    static const u64 prime = 1099511628211ULL;
 
     unsigned const char* us;
-    u64 hash = 0;
+    u64 hash = offset_basis;
 
     for (us = (unsigned const char*)name; *us; us++) {
-        hash = hash * multiplier + *us;
+        hash ^= *us;
+        hash *= prime;
     }
 
-    // Mod it against the size of the table.
-    hash %= element_count;
-
     return hash;
 }
 
+/** @brief Obtains the control byte stored for the given hash. Never collides with the empty/deleted markers. */
+KINLINE u8 hash_control(u64 hash) {
+    return (u8)(hash & 0x7F);
+}
+
+/** @brief Obtains the starting slot for the given hash. */
+KINLINE u32 hash_slot(u64 hash, u32 element_count) {
+    return (u32)((hash >> 7) % element_count);
+}
+
+/** @brief Obtains a pointer to the value stored in the given slot. */
+KINLINE void* slot_value(hashtable* table, u32 index) {
+    return (u8*)table->memory + (table->element_size * index);
+}
+
+/** @brief Size of the per-slot bookkeeping block (control bytes, hashes and keys) for the given slot count. */
+static u64 metadata_size(u32 element_count) {
+    return get_aligned(sizeof(u8) * element_count, sizeof(u64)) + (sizeof(u64) * element_count) + (sizeof(char*) * element_count);
+}
+
+/**
+ * @brief Allocates and initializes the per-slot bookkeeping for the given slot count.
+ * All slots start out empty.
+ */
+static void metadata_create(u32 element_count, u8** out_control, u64** out_hashes, char*** out_keys) {
+    u8* block = kallocate(metadata_size(element_count), MEMORY_TAG_DICT);
+    *out_control = block;
+    *out_hashes = (u64*)(block + get_aligned(sizeof(u8) * element_count, sizeof(u64)));
+    *out_keys = (char**)(*out_hashes + element_count);
+    kset_memory(*out_control, CONTROL_EMPTY, sizeof(u8) * element_count);
+}
+
+/**
+ * @brief Searches for the slot holding the given name.
+ *
+ * @param table The table to search.
+ * @param name The name to search for.
+ * @param hash The precomputed hash of name.
+ * @param out_index Receives the index of the slot holding name if found. Otherwise receives
+ * the slot a new entry for name should be placed in (the first tombstone passed, or the empty
+ * slot the probe ended on), or INVALID_ID if the table is completely full.
+ * @return True if the name was found; otherwise false.
+ */
+static b8 find_slot(hashtable* table, const char* name, u64 hash, u32* out_index) {
+    u8 control = hash_control(hash);
+    u32 index = hash_slot(hash, table->element_count);
+    u32 first_free = INVALID_ID;
+
+    for (u32 probe = 0; probe < table->element_count; ++probe) {
+        u8 c = table->control[index];
+        if (c == CONTROL_EMPTY) {
+            *out_index = first_free != INVALID_ID ? first_free : index;
+            return False;
+        }
+
+        if (c == CONTROL_DELETED) {
+            if (first_free == INVALID_ID) {
+                first_free = index;
+            }
+        } else if (c == control && table->hashes[index] == hash && strings_equal(table->keys[index], name)) {
+            *out_index = index;
+            return True;
+        }
+
+        index++;
+        if (index == table->element_count) {
+            index = 0;
+        }
+    }
+
+    *out_index = first_free;
+    return False;
+}
+
+/**
+ * @brief Moves all live entries into freshly allocated storage with the given slot count,
+ * dropping any tombstones in the process. The table owns its value storage afterwards.
+ *
+ * @param table The table to rehash.
+ * @param new_element_count The new number of slots. Must be greater than the live entry count.
+ * @return True on success; otherwise false.
+ */
+static b8 hashtable_rehash(hashtable* table, u32 new_element_count) {
+    if (new_element_count <= table->count) {
+        KERROR("hashtable_rehash - new element count %u cannot hold %u entries.", new_element_count, table->count);
+        return False;
+    }
+
+    void* new_memory = kallocate(table->element_size * new_element_count, MEMORY_TAG_DICT);
+    u8* new_control;
+    u64* new_hashes;
+    char** new_keys;
+    metadata_create(new_element_count, &new_control, &new_hashes, &new_keys);
+
+    for (u32 i = 0; i < table->element_count; ++i) {
+        u8 c = table->control[i];
+        if (c == CONTROL_EMPTY || c == CONTROL_DELETED) {
+            continue;
+        }
+
+        // Keys are unique and there are no tombstones, so the first empty slot is the one.
+        u64 hash = table->hashes[i];
+        u32 index = hash_slot(hash, new_element_count);
+        while (new_control[index] != CONTROL_EMPTY) {
+            index++;
+            if (index == new_element_count) {
+                index = 0;
+            }
+        }
+
+        new_control[index] = c;
+        new_hashes[index] = hash;
+        new_keys[index] = table->keys[i];
+        kcopy_memory((u8*)new_memory + (table->element_size * index), slot_value(table, i), table->element_size);
+    }
+
+    kfree(table->control, metadata_size(table->element_count), MEMORY_TAG_DICT);
+    if (table->owns_memory) {
+        kfree(table->memory, table->element_size * table->element_count, MEMORY_TAG_DICT);
+    }
+
+    table->memory = new_memory;
+    table->owns_memory = True;
+    table->control = new_control;
+    table->hashes = new_hashes;
+    table->keys = new_keys;
+    table->element_count = new_element_count;
+    table->tombstone_count = 0;
+    return True;
+}
+
+/**
+ * @brief Makes sure there is room for one more entry without passing the maximum load factor.
+ *
+ * Grows the table when live entries are the problem, or rehashes at the current size when
+ * tombstones are and the live entries fill less than half of the maximum load.
+ *
+ * @param table The table to check.
+ * @return True if there is room; otherwise false.
+ */
+static b8 ensure_capacity(hashtable* table) {
+    u64 limit = ((u64)table->element_count * MAX_LOAD_EIGHTHS) / 8;
+    if ((u64)table->count + table->tombstone_count + 1 <= limit) {
+        return True;
+    }
+
+    // Only rehash in place if that leaves plenty of headroom, otherwise a table sitting near the
+    // limit would rehash on nearly every insert following a removal.
+    u64 new_element_count = table->element_count;
+    while ((new_element_count * MAX_LOAD_EIGHTHS) / 16 < (u64)table->count + 1) {
+        new_element_count *= 2;
+        if (new_element_count > 0xFFFFFFFEULL) {
+            KERROR("hashtable could not grow past %u slots.", table->element_count);
+            return False;
+        }
+    }
+
+    return hashtable_rehash(table, (u32)new_element_count);
+}
+
+/**
+ * @brief Inserts or overwrites the value stored for the given name.
+ *
+ * @param table The table to insert into.
+ * @param name The name of the entry.
+ * @param value A pointer to element_size bytes to copy in.
+ * @return True on success; otherwise false.
+ */
+static b8 insert(hashtable* table, const char* name, const void* value) {
+    u64 hash = hash_name(name);
+    u32 index;
+    if (find_slot(table, name, hash, &index)) {
+        kcopy_memory(slot_value(table, index), value, table->element_size);
+        return True;
+    }
+
+    if (!ensure_capacity(table)) {
+        return False;
+    }
+
+    // The table may have been rehashed, so find the insertion slot again.
+    find_slot(table, name, hash, &index);
+    if (index == INVALID_ID) {
+        KERROR("hashtable insert failed to find a free slot for '%s'.", name);
+        return False;
+    }
+
+    if (table->control[index] == CONTROL_DELETED) {
+        table->tombstone_count--;
+    }
+    table->control[index] = hash_control(hash);
+    table->hashes[index] = hash;
+    table->keys[index] = string_duplicate(name);
+    table->count++;
+    kcopy_memory(slot_value(table, index), value, table->element_size);
+    return True;
+}
+
 void hashtable_create(u64 element_size, u32 element_count, void* memory, b8 is_pointer_type, hashtable* out_hashtable) {
     // Confirm if memory exists and is large enough.
     if (!memory || !out_hashtable) {
@@ -64,18 +272,40 @@ void hashtable_create(u64 element_size, u32 element_count, void* memory, b8 is_p
         return;
     }
 
-    // TODO: Might want to require an allocator and allocate this memory instead.
-    // Cuurently allocated externally.
+    // Value storage starts out in the externally allocated block. If the table needs to
+    // grow, it allocates (and then owns) its own storage.
     out_hashtable->memory = memory;
+    out_hashtable->owns_memory = False;
     out_hashtable->element_count = element_count;
     out_hashtable->element_size = element_size;
     out_hashtable->is_pointer_type = is_pointer_type;
+    out_hashtable->count = 0;
+    out_hashtable->tombstone_count = 0;
     kzero_memory(out_hashtable->memory, element_size * element_count);
+
+    metadata_create(element_count, &out_hashtable->control, &out_hashtable->hashes, &out_hashtable->keys);
+    out_hashtable->default_value = kallocate(element_size, MEMORY_TAG_DICT);
 }
 
 void hashtable_destroy(hashtable* table) {
     if (table) {
-        // TODO: If using allocator above, free memory here.
+        if (table->control) {
+            for (u32 i = 0; i < table->element_count; ++i) {
+                if (table->control[i] != CONTROL_EMPTY && table->control[i] != CONTROL_DELETED) {
+                    kfree(table->keys[i], string_length(table->keys[i]) + 1, MEMORY_TAG_STRING);
+                }
+            }
+            kfree(table->control, metadata_size(table->element_count), MEMORY_TAG_DICT);
+        }
+
+        if (table->default_value) {
+            kfree(table->default_value, table->element_size, MEMORY_TAG_DICT);
+        }
+
+        if (table->owns_memory) {
+            kfree(table->memory, table->element_size * table->element_count, MEMORY_TAG_DICT);
+        }
+
         kzero_memory(table, sizeof(hashtable));
     }
 }
@@ -93,9 +323,7 @@ b8 hashtable_set(hashtable* table, const char* name, void* value) {
         return False;
     }
 
-    u64 hash = hash_name(name, table->element_count);
-    kcopy_memory(table->memory + (table->element_size * hash), value, table->element_size);
-    return True;
+    return insert(table, name, value);
 }
 
 b8 hashtable_set_ptr(hashtable* table, const char* name, void** value) {
@@ -111,10 +339,13 @@ b8 hashtable_set_ptr(hashtable* table, const char* name, void** value) {
         return False;
     }
 
-    u64 hash = hash_name(name, table->element_count);
-    // Cast to a void** and set the pointer (or 0 if value is null).
-    ((void**)table->memory)[hash] = value ? *value : 0;
-    return True;
+    // Setting a null pointer 'unsets' the entry.
+    if (!value || !*value) {
+        hashtable_remove(table, name);
+        return True;
+    }
+
+    return insert(table, name, value);
 }
 
 b8 hashtable_get(hashtable* table, const char* name, void* out_value) {
@@ -130,8 +361,12 @@ b8 hashtable_get(hashtable* table, const char* name, void* out_value) {
         return False;
     }
 
-    u64 hash = hash_name(name, table->element_count);
-    kcopy_memory(out_value, table->memory + (table->element_size * hash), table->element_size);
+    u32 index;
+    if (find_slot(table, name, hash_name(name), &index)) {
+        kcopy_memory(out_value, slot_value(table, index), table->element_size);
+    } else {
+        kcopy_memory(out_value, table->default_value, table->element_size);
+    }
     return True;
 }
 
@@ -148,9 +383,12 @@ b8 hashtable_get_ptr(hashtable* table, const char* name, void** out_value) {
         return False;
     }
 
-    u64 hash = hash_name(name, table->element_count);
-    // Cast to a void** and get the pointer (or 0 if value is null).
-    *out_value = ((void**)table->memory)[hash];
+    u32 index;
+    if (find_slot(table, name, hash_name(name), &index)) {
+        *out_value = *(void**)slot_value(table, index);
+    } else {
+        *out_value = 0;
+    }
     // Modify return value to indicate if the retrieved pointer is non-null.
     return *out_value != 0;
 }
@@ -168,9 +406,48 @@ b8 hashtable_fill(hashtable* table, void* value) {
         return False;
     }
 
+    kcopy_memory(table->default_value, value, table->element_size);
     for (u32 i = 0; i < table->element_count; ++i) {
-        kcopy_memory(table->memory + (table->element_size * i), value, table->element_size);
+        kcopy_memory(slot_value(table, i), value, table->element_size);
+    }
+
+    return True;
+}
+
+b8 hashtable_remove(hashtable* table, const char* name) {
+    // Validate input.
+    if (!table || !name) {
+        KWARN("hashtable_remove requires table and name to exist.");
+        return False;
+    }
+
+    u32 index;
+    if (!find_slot(table, name, hash_name(name), &index)) {
+        return False;
+    }
+
+    kfree(table->keys[index], string_length(table->keys[index]) + 1, MEMORY_TAG_STRING);
+    table->keys[index] = 0;
+    kcopy_memory(slot_value(table, index), table->default_value, table->element_size);
+    table->count--;
+
+    if (table->count == 0) {
+        // Nothing left to probe past, so all tombstones can be cleared outright.
+        kset_memory(table->control, CONTROL_EMPTY, sizeof(u8) * table->element_count);
+        table->tombstone_count = 0;
+    } else {
+        table->control[index] = CONTROL_DELETED;
+        table->tombstone_count++;
     }
 
     return True;
 }
+
+b8 hashtable_contains(hashtable* table, const char* name) {
+    if (!table || !name) {
+        return False;
+    }
+
+    u32 index;
+    return find_slot(table, name, hash_name(name), &index);
+}
@@ -5,46 +5,75 @@
 /**
  * @file hashtable.h
  *
- * @brief Represents a simple hashtable. Members of this structure should not be modified outside
- * the functions associated with it.
+ * @brief Represents an open-addressing hashtable keyed by strings. Members of this structure
+ * should not be modified outside the functions associated with it.
  *
  * For non-pointer types, table retains a copy of the value. For pointer types, make sure to use
  * the _ptr setter and getter. Table does not take ownership of pointers or associated memory
  * allocations, and should be managed externally.
  *
+ * Each slot has a control byte (empty, deleted, or the low 7 bits of the key's hash) which is
+ * checked before the stored hash and key are compared, so most probes touch a single byte.
+ * Collisions are resolved with linear probing, removals leave a tombstone, and the table
+ * grows (or rehashes in place to purge tombstones) once it passes a 7/8 load factor.
+ *
  * Usage:
  * - Create a hashtable with `hashtable_create()`, providing element size, count, memory block, and type info.
  * - Use `hashtable_set()` and `hashtable_get()` for non-pointer types.
  * - Use `hashtable_set_ptr()` and `hashtable_get_ptr()` for pointer types.
+ * - Use `hashtable_remove()` to delete an entry.
  * - Destroy the hashtable with `hashtable_destroy()`.
  * Note:
- * - The hashtable does not handle collisions; ensure unique keys or increase element count.
+ * - Keys are copied into the table, so callers may free/reuse their name buffers after a set.
+ * - The provided memory block is used until the table first grows, after which the table
+ *   allocates (and owns) its own value storage.
  *
  */
 
 /**
  * @struct hashtable
- * @brief Represents a simple hashtable structure.
+ * @brief Represents an open-addressing hashtable structure.
  */
 typedef struct hashtable {
     /** Size of each element in bytes. */
     u64 element_size;
 
-    /** Maximum number of elements in the hashtable. */
+    /** Number of slots currently available in the hashtable. Grows as required. */
     u32 element_count;
 
+    /** Number of live entries stored in the hashtable. */
+    u32 count;
+
+    /** Number of slots holding a tombstone left behind by a removal. */
+    u32 tombstone_count;
+
     /** Indicates if the hashtable holds pointer types. */
     b8 is_pointer_type;
 
+    /** Indicates if memory was allocated by the hashtable (after a resize) and must be freed by it. */
+    b8 owns_memory;
+
     /** Pointer to the memory block used for storing elements. */
     void* memory;
+
+    /** Per-slot control bytes. One of the empty/deleted markers, or the low 7 bits of the hash. */
+    u8* control;
+
+    /** Per-slot full hash of the stored key, used to skip string compares and to rehash. */
+    u64* hashes;
+
+    /** Per-slot copy of the stored key. */
+    char** keys;
+
+    /** Value returned by `hashtable_get()` for names not present in the table. Set by `hashtable_fill()`. */
+    void* default_value;
 } hashtable;
 
 /**
  * @brief Creates a hashtable and stores it in out_hashtable.
  *
  * @param element_size The size of each element in bytes.
- * @param element_count The maximum number of elements. Cannot be resized.
+ * @param element_count The initial number of slots. The table grows past this when needed.
  * @param memory A block of memory to be used. Should be equal in size to element_size * element_count;
  * @param is_pointer_type Indicates if this hashtable will hold pointer types.
  * @param out_hashtable A pointer to a hashtable in which to hold relevant data.
@@ -52,7 +81,8 @@ typedef struct hashtable {
 KAPI void hashtable_create(u64 element_size, u32 element_count, void* memory, b8 is_pointer_type, hashtable* out_hashtable);
 
 /**
- * @brief Destroys the provided hashtable. Does not release memory for pointer types.
+ * @brief Destroys the provided hashtable. Frees internal bookkeeping and any value storage
+ * allocated by a resize. Does not release memory for pointer types.
  *
  * @param table A pointer to the table to be destroyed.
  */
@@ -65,7 +95,7 @@ KAPI void hashtable_destroy(hashtable* table);
  * @param table A pointer to the table to get from. Required.
  * @param name The name of the entry to set. Required.
  * @param value The value to be set. Required.
- * @return True, or false if a null pointer is passed.
+ * @return True, or false if a null pointer is passed or the table could not grow.
  */
 KAPI b8 hashtable_set(hashtable* table, const char* name, void* value);
 
@@ -75,14 +105,15 @@ KAPI b8 hashtable_set(hashtable* table, const char* name, void* value);
  *
  * @param table A pointer to the table to get from. Required.
  * @param name The name of the entry to set. Required.
- * @param value A pointer value to be set. Can pass 0 to 'unset' an entry.
- * @return True; or false if a null pointer is passed or if the entry is 0.
+ * @param value A pointer value to be set. Can pass 0 to 'unset' (remove) an entry.
+ * @return True; or false if a null pointer is passed or the table could not grow.
  */
 KAPI b8 hashtable_set_ptr(hashtable* table, const char* name, void** value);
 
 /**
  * @brief Obtains a copy of data present in the hashtable.
  * Only use for tables which were *NOT* created with `is_pointer_type` = true.
+ * If the name is not present, the default value (see `hashtable_fill()`) is copied instead.
  *
  * @param table A pointer to the table to retrieved from. Required.
  * @param name The name of the entry to retrieved. Required.
@@ -103,7 +134,8 @@ KAPI b8 hashtable_get(hashtable* table, const char* name, void* out_value);
 KAPI b8 hashtable_get_ptr(hashtable* table, const char* name, void** out_value);
 
 /**
- * @brief Fills all entries in the hashtable with the given value.
+ * @brief Fills all entries in the hashtable with the given value, and sets it as the
+ * default value returned for names that are not present.
  *
  * Useful when non-existent names should return some default value.
  * Should not be used with pointer table types.
@@ -112,4 +144,23 @@ KAPI b8 hashtable_get_ptr(hashtable* table, const char* name, void** out_value);
  * @param value The value to be filled with. Required.
  * @return True if successful; otherwise false.
  */
-KAPI b8 hashtable_fill(hashtable* table, void* value);
\ No newline at end of file
+KAPI b8 hashtable_fill(hashtable* table, void* value);
+
+/**
+ * @brief Removes an entry from the hashtable, leaving a tombstone in its slot.
+ * Can be used with both pointer and non-pointer table types.
+ *
+ * @param table A pointer to the table to remove from. Required.
+ * @param name The name of the entry to remove. Required.
+ * @return True if the entry existed and was removed; otherwise false.
+ */
+KAPI b8 hashtable_remove(hashtable* table, const char* name);
+
+/**
+ * @brief Indicates if an entry with the given name exists in the hashtable.
+ *
+ * @param table A pointer to the table to search. Required.
+ * @param name The name of the entry to look for. Required.
+ * @return True if the entry exists; otherwise false.
+ */
+KAPI b8 hashtable_contains(hashtable* table, const char* name);
@@ -7,6 +7,7 @@
 #include "core/input.h"
 #include "core/clock.h"
 #include "memory/linear_allocator.h"
+#include "memory/frame_allocator.h"
 #include "renderer/renderer_frontend.h"
 #include "core/event.h"
 
@@ -15,6 +16,9 @@
 #include "systems/material_system.h"
 #include "systems/geometry_system.h"
 #include "systems/resource_system.h"
+#include "systems/job_system.h"
+#include "systems/transform_system.h"
+#include "ecs/ecs.h"
 
 // TODO: Temp code
 #include "math/kmath.h"
@@ -118,6 +122,16 @@ typedef struct application_state {
      */
     void* logging_system_state;
 
+    /**
+     * @brief The total memory requirement for the frame allocator, including both frame buffers.
+     */
+    u64 frame_allocator_memory_requirement;
+
+    /**
+     * @brief Pointer to the frame allocator state.
+     */
+    void* frame_allocator_state;
+
     /**
      * @brief The total memory requirement for the input system.
      */
@@ -138,6 +152,31 @@ typedef struct application_state {
      */
     void* platform_system_state;
 
+    /**
+     * @brief The total memory requirement for the job system.
+     */
+    u64 job_system_memory_requirement;
+
+    /**
+     * @brief Pointer to the job system state.
+     */
+    void* job_system_state;
+
+    /**
+     * @brief The total memory requirement for the transform system.
+     */
+    u64 transform_system_memory_requirement;
+
+    /**
+     * @brief Pointer to the transform system state.
+     */
+    void* transform_system_state;
+
+    /**
+     * @brief The entities of the game, handed to it through game->world.
+     */
+    ecs_world world;
+
     /**
      * @brief The total memory requirement for the resource system.
      */
@@ -190,6 +229,7 @@ typedef struct application_state {
 
     // TODO: Temp code
     geometry* test_geometry;  // Scene or game addition
+    u32 test_transform;
     // TODO: End Temp code
 } application_state;
 
@@ -278,7 +318,7 @@ b8 event_on_debug_event(u16 code, void* sender, void* listener_inst, event_conte
     // Acquire the new texture.
     if (app_state->test_geometry) {
         // Fetch material in test_geometry
-        app_state->test_geometry->material->diffuse_map.texture = texture_system_acquire(names[choice], True);
+        app_state->test_geometry->material->diffuse_map.texture = texture_system_acquire_streamed(names[choice], True);
 
         if (!app_state->test_geometry->material->diffuse_map.texture) {
             KWARN("event_on_debug_event no texture! Using default");
@@ -319,31 +359,47 @@ b8 application_create(game* game_inst) {
     app_state->is_running = False;
     app_state->is_suspended = False;
 
-    // Allocate memory for the application state
+    // Allocate memory for the application state. System states hold vec4/mat4 members, so each one
+    // is carved at 16-byte alignment.
     u64 systems_allocator_total_size = 64 * 1024 * 1024;  // 64 MB
     linear_allocator_create(systems_allocator_total_size, 0, &app_state->systems_allocator);
 
     // Initialize event system
     event_system_initialize(&app_state->event_system_memory_requirement, 0);
-    app_state->event_system_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->event_system_memory_requirement);
+    app_state->event_system_state = linear_allocator_allocate_aligned(&app_state->systems_allocator, app_state->event_system_memory_requirement, 16);
     event_system_initialize(&app_state->event_system_memory_requirement, app_state->event_system_state);
 
     // Initialize memory system
-    initialize_memory(&app_state->memory_system_memory_requirement, 0);
-    app_state->memory_system_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->memory_system_memory_requirement);
-    initialize_memory(&app_state->memory_system_memory_requirement, app_state->memory_system_state);
+    memory_system_config memory_config;
+    memory_config.total_alloc_size = game_inst->app_config.heap_size;
+    initialize_memory(&app_state->memory_system_memory_requirement, 0, memory_config);
+    app_state->memory_system_state = linear_allocator_allocate_aligned(&app_state->systems_allocator, app_state->memory_system_memory_requirement, 16);
+    if (!initialize_memory(&app_state->memory_system_memory_requirement, app_state->memory_system_state, memory_config)) {
+        KFATAL("Failed to initialize memory system; shutting down.");
+        return False;
+    }
 
     // Initialize Logging Subsystem
     initialize_logging(&app_state->logging_system_memory_requirement, 0);
-    app_state->logging_system_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->logging_system_memory_requirement);
+    app_state->logging_system_state = linear_allocator_allocate_aligned(&app_state->systems_allocator, app_state->logging_system_memory_requirement, 16);
     if (!initialize_logging(&app_state->logging_system_memory_requirement, app_state->logging_system_state)) {
         KERROR("Failed to initialize logging system. Application cannot continue. Shutting down...");
         return False;
     }
 
+    // Per-frame scratch memory.
+    frame_allocator_config frame_alloc_config;
+    frame_alloc_config.frame_size = 4 * 1024 * 1024;  // 4 MB per frame.
+    frame_allocator_initialize(&app_state->frame_allocator_memory_requirement, 0, frame_alloc_config);
+    app_state->frame_allocator_state = linear_allocator_allocate_aligned(&app_state->systems_allocator, app_state->frame_allocator_memory_requirement, 16);
+    if (!frame_allocator_initialize(&app_state->frame_allocator_memory_requirement, app_state->frame_allocator_state, frame_alloc_config)) {
+        KFATAL("Failed to initialize frame allocator. Aborting application.");
+        return False;
+    }
+
     // Initialize input system
     input_system_initialize(&app_state->input_system_memory_requirement, 0);
-    app_state->input_system_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->input_system_memory_requirement);
+    app_state->input_system_state = linear_allocator_allocate_aligned(&app_state->systems_allocator, app_state->input_system_memory_requirement, 16);
     input_system_initialize(&app_state->input_system_memory_requirement, app_state->input_system_state);
 
     // Register for Key press events
@@ -357,19 +413,51 @@ b8 application_create(game* game_inst) {
 
     // Start platform layer
     platform_system_startup(&app_state->platform_system_memory_requirement, 0, 0, 0, 0, 0, 0);
-    app_state->platform_system_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->platform_system_memory_requirement);
+    app_state->platform_system_state = linear_allocator_allocate_aligned(&app_state->systems_allocator, app_state->platform_system_memory_requirement, 16);
     if (!platform_system_startup(&app_state->platform_system_memory_requirement, app_state->platform_system_state, game_inst->app_config.name, game_inst->app_config.start_pos_x, game_inst->app_config.start_pos_y, game_inst->app_config.start_width, game_inst->app_config.start_height)) {
         return False;
     }
 
+    // Job system startup. One worker per logical core, less one for the main thread.
+    job_system_config job_sys_config;
+    job_sys_config.max_worker_count = 0;
+    job_sys_config.max_job_count = 1024;
+
+    job_system_initialize(&app_state->job_system_memory_requirement, 0, job_sys_config);
+    app_state->job_system_state = linear_allocator_allocate_aligned(&app_state->systems_allocator, app_state->job_system_memory_requirement, 16);
+    if (!job_system_initialize(&app_state->job_system_memory_requirement, app_state->job_system_state, job_sys_config)) {
+        KFATAL("Failed to initialize job system. Aborting application.");
+        return False;
+    }
+
+    // Transform system startup. Its arrays are loaded four at a time with SIMD, so need 16-byte alignment.
+    transform_system_config transform_sys_config;
+    transform_sys_config.max_transform_count = 16384;
+
+    transform_system_initialize(&app_state->transform_system_memory_requirement, 0, transform_sys_config);
+    app_state->transform_system_state = linear_allocator_allocate_aligned(&app_state->systems_allocator, app_state->transform_system_memory_requirement, 16);
+    if (!transform_system_initialize(&app_state->transform_system_memory_requirement, app_state->transform_system_state, transform_sys_config)) {
+        KFATAL("Failed to initialize transform system. Aborting application.");
+        return False;
+    }
+
     // Resource system startup
     resource_system_config resource_sys_config;
     resource_sys_config.asset_base_path = "../assets";
     resource_sys_config.max_loader_count = 32;
+    resource_sys_config.max_async_load_count = 64;
+    // Written by the packer in post-build. Loose files are used when it is missing.
+    resource_sys_config.archive_path = "assets.kpak";
+#ifdef _DEBUG
+    // Reload textures and materials as they are edited. Only loose assets are watched.
+    resource_sys_config.watch_for_changes = True;
+#else
+    resource_sys_config.watch_for_changes = False;
+#endif
 
     resource_system_initialize(&app_state->resource_system_memory_requirement, 0, resource_sys_config);
     
-    app_state->resource_system_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->resource_system_memory_requirement);
+    app_state->resource_system_state = linear_allocator_allocate_aligned(&app_state->systems_allocator, app_state->resource_system_memory_requirement, 16);
     
     if (!resource_system_initialize(&app_state->resource_system_memory_requirement, app_state->resource_system_state, resource_sys_config)) {
         KFATAL("Failed to initialize resource system. Aborting application.");
@@ -377,9 +465,12 @@ b8 application_create(game* game_inst) {
     }
 
     // Renderer startup
-    renderer_system_initialize(&app_state->renderer_system_memory_requirement, 0, 0);
-    app_state->renderer_system_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->renderer_system_memory_requirement);
-    if (!renderer_system_initialize(&app_state->renderer_system_memory_requirement, app_state->renderer_system_state, game_inst->app_config.name)) {
+    renderer_backend_config renderer_config;
+    renderer_config.application_name = game_inst->app_config.name;
+    renderer_config.staging_buffer_size = game_inst->app_config.staging_buffer_size;
+    renderer_system_initialize(&app_state->renderer_system_memory_requirement, 0, renderer_config);
+    app_state->renderer_system_state = linear_allocator_allocate_aligned(&app_state->systems_allocator, app_state->renderer_system_memory_requirement, 16);
+    if (!renderer_system_initialize(&app_state->renderer_system_memory_requirement, app_state->renderer_system_state, renderer_config)) {
         KFATAL("Failed to initialize renderer. Aborting application.");
 
         return False;
@@ -387,11 +478,12 @@ b8 application_create(game* game_inst) {
 
     // Texture system startup
     texture_system_config texture_sys_config;
-    texture_sys_config.max_texture_count = 65536;  // Arbitrary limit for now
+    texture_sys_config.max_texture_count = 4096;
+    texture_sys_config.max_resident_bytes = 256 * 1024 * 1024;
 
     texture_system_initialize(&app_state->texture_system_memory_requirement, 0, texture_sys_config);
 
-    app_state->texture_system_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->texture_system_memory_requirement);
+    app_state->texture_system_state = linear_allocator_allocate_aligned(&app_state->systems_allocator, app_state->texture_system_memory_requirement, 16);
     if (!texture_system_initialize(&app_state->texture_system_memory_requirement, app_state->texture_system_state, texture_sys_config)) {
         KFATAL("Failed to initialize texture system. Aborting application.");
         return False;
@@ -399,11 +491,11 @@ b8 application_create(game* game_inst) {
 
     // Material system startup
     material_system_config material_sys_config;
-    material_sys_config.max_material_count = 4096;
+    material_sys_config.max_material_count = 1024;  // Matches the renderer's material instance limit.
 
     material_system_initialize(&app_state->material_system_memory_requirement, 0, material_sys_config);
 
-    app_state->material_system_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->material_system_memory_requirement);
+    app_state->material_system_state = linear_allocator_allocate_aligned(&app_state->systems_allocator, app_state->material_system_memory_requirement, 16);
     if (!material_system_initialize(&app_state->material_system_memory_requirement, app_state->material_system_state, material_sys_config)) {
         KFATAL("Failed to initialize material system. Application cannot continue.");
         return False;
@@ -415,7 +507,7 @@ b8 application_create(game* game_inst) {
 
     geometry_system_initialize(&app_state->geometry_system_memory_requirement, 0, geometry_sys_config);
 
-    app_state->geometry_system_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->material_system_memory_requirement);
+    app_state->geometry_system_state = linear_allocator_allocate_aligned(&app_state->systems_allocator, app_state->geometry_system_memory_requirement, 16);
     if (!geometry_system_initialize(&app_state->geometry_system_memory_requirement, app_state->geometry_system_state, geometry_sys_config)) {
         KFATAL("Failed to initialize geometry system. Application cannot continue.");
         return False;
@@ -425,6 +517,7 @@ b8 application_create(game* game_inst) {
     // Load up a plane configuration, and load geometry from it.
     geometry_config g_config = geometry_system_generate_plane_config(10.0f, 5.0f, 5, 5, 5.0f, 2.0f, "test geometry", "test_material");
     app_state->test_geometry = geometry_system_acquire_from_config(g_config, True);
+    app_state->test_transform = transform_create();
 
     // Clean up the allocations for the geometry config.
     kfree(g_config.vertices, sizeof(vertex_3d) * g_config.vertex_count, MEMORY_TAG_ARRAY);
@@ -434,6 +527,13 @@ b8 application_create(game* game_inst) {
     // app_state->test_geometry = geometry_system_get_default();
     // TODO: end temp
 
+    // The game registers its components and systems with the world as it initializes.
+    if (!ecs_world_create(&app_state->world)) {
+        KFATAL("Failed to create the entity world. Application cannot continue.");
+        return False;
+    }
+    app_state->game_inst->world = &app_state->world;
+
     // Initialize Game
     if (!app_state->game_inst->initialize(app_state->game_inst)) {
         KFATAL("Game failed to initialize");
@@ -480,6 +580,11 @@ b8 application_run() {
 
             f64 frame_start_time = platform_get_absolute_time();
 
+            // Finish the resource loads that completed on worker threads since last frame.
+            resource_system_update();
+            // Bring streamed textures up to full resolution.
+            texture_system_update();
+
             if (!app_state->game_inst->update(app_state->game_inst, (f32)delta)) {
                 KFATAL("Game update failed. Shutting down!");
 
@@ -488,6 +593,9 @@ b8 application_run() {
                 break;
             }
 
+            // Run the game's entity systems over this frame's changes.
+            ecs_world_run_systems(&app_state->world, (f32)delta);
+
             // Call game render routine
             if (!app_state->game_inst->render(app_state->game_inst, (f32)delta)) {
                 KFATAL("Game render failed. Shutting down!");
@@ -497,18 +605,21 @@ b8 application_run() {
                 break;
             }
 
+            // Bring every world matrix up to date with this frame's changes before drawing.
+            transform_system_update();
+
             // TODO: refactor packet creation
             render_packet packet;
 
             packet.delta_time = delta;
 
             // TODO: temp
-            geometry_render_data test_render;
-            test_render.geometry = app_state->test_geometry;
-            test_render.model = mat4_identity();
+            geometry_render_data* test_render = frame_alloc(sizeof(geometry_render_data), 16);
+            test_render->geometry = app_state->test_geometry;
+            test_render->model = transform_get_world(app_state->test_transform);
 
             packet.geometry_count = 1;
-            packet.geometries = &test_render;
+            packet.geometries = test_render;
             // TODO: end temp
 
             renderer_draw_frame(&packet);
@@ -541,6 +652,9 @@ b8 application_run() {
             // this frame ends.
             input_update(delta);
 
+            // Anything allocated with frame_alloc() during the previous frame is now gone.
+            frame_allocator_end_frame();
+
             // Update last time
             app_state->last_time = current_time;
         }
@@ -560,6 +674,13 @@ b8 application_run() {
 
     input_system_shutdown(app_state->input_system_state);
 
+    // Stop workers before any system their jobs may touch goes away.
+    job_system_shutdown(app_state->job_system_state);
+
+    ecs_world_destroy(&app_state->world);
+
+    transform_system_shutdown(app_state->transform_system_state);
+
     geometry_system_shutdown(app_state->geometry_system_state);
 
     material_system_shutdown(app_state->material_system_state);
@@ -568,15 +689,21 @@ b8 application_run() {
 
     renderer_system_shutdown(app_state->renderer_system_state);
 
+    frame_allocator_shutdown(app_state->frame_allocator_state);
+
     resource_system_shutdown(app_state->resource_system_state);
 
     // Clean up platform resources
     platform_system_shutdown(app_state->platform_system_state);
 
-    shutdown_memory(app_state->memory_system_state);
+    // Writes out anything still queued. Later messages go straight to the console.
+    shutdown_logging(app_state->logging_system_state);
 
     event_system_shutdown(app_state->event_system_state);
 
+    // Last, as blocks from the engine heap are invalid once it is gone.
+    shutdown_memory(app_state->memory_system_state);
+
     return True;
 }
 
@@ -53,6 +53,18 @@ typedef struct application_config {
      * @brief The name/title of the application shown in the window title bar.
      */
     char* name;
+
+    /**
+     * @brief The size in bytes of the engine heap that kallocate() allocates from, reserved at
+     * startup. Acts as a hard cap on engine memory use. 0 allocates from the platform instead.
+     */
+    u64 heap_size;
+
+    /**
+     * @brief The size in bytes of the renderer's staging buffer, which all uploads to the GPU go
+     * through. Larger allows more uploads per frame without stalling. 0 uses the renderer default.
+     */
+    u64 staging_buffer_size;
 } application_config;
 
 /**
@@ -1,7 +1,9 @@
 #include "kmemory.h"
 
 #include "core/logger.h"
+#include "core/kmutex.h"
 #include "platform/platform.h"
+#include "memory/dynamic_allocator.h"
 
 // TODO: Add custom string lib
 #include <string.h>
@@ -18,8 +20,10 @@
  * - Helper functions like `kzero_memory()`, `kcopy_memory()`, and `kset_memory()`
  * - A utility function to generate formatted memory usage strings for debugging
  *
- * The system wraps platform-specific memory functions (`platform_allocate`, `platform_free`)
- * to ensure consistent behavior and logging.
+ * When an engine heap is configured, allocations are served by a dynamic_allocator carved from one
+ * block reserved at startup. Otherwise the system wraps platform-specific memory functions
+ * (`platform_allocate`, `platform_free`). kfree() routes each block back to wherever it came
+ * from, so blocks allocated before the system started can be freed at any time.
  *
  * Usage:
  * Replace raw memory operations with `kallocate()` / `kfree()` to enable tracking.
@@ -67,7 +71,10 @@ static const char* memory_tag_strings[MEMORY_TAG_MAX_TAGS] = {
     "TRANSFORM    ",
     "ENTITY       ",
     "ENTITY_NODE  ",
-    "SCENE        "};
+    "SCENE        ",
+    "GPU_LOCAL    ",
+    "GPU_HOST     ",
+    "GPU_GEOMETRY "};
 
 /**
  * @struct memory_system_state
@@ -75,37 +82,120 @@ static const char* memory_tag_strings[MEMORY_TAG_MAX_TAGS] = {
  * @brief Represents the state of the memory tracking system.
  */
 typedef struct memory_system_state {
-    struct memory_stats stats; /**< Memory usage statistics */
-    u64 alloc_count;           /**< Total number of allocations made */
+    memory_system_config config; /**< Configuration the system was initialized with */
+    struct memory_stats stats;   /**< Memory usage statistics */
+    u64 alloc_count;             /**< Total number of allocations made */
+    u64 allocator_memory_size;   /**< Size of the block reserved for the engine heap */
+    void* allocator_memory;      /**< Block reserved for the engine heap, if configured */
+    dynamic_allocator allocator; /**< Allocator for the engine heap, if configured */
+    kmutex allocation_mutex;     /**< Guards the stats and the engine heap across threads */
 } memory_system_state;
 
+/** @brief Blocks from the platform allocator are at least this aligned. */
+#define PLATFORM_MIN_ALIGNMENT 16
+
 // Global instance of memory tracking state
 static memory_system_state* state_ptr;
 
+/**
+ * @brief Allocates from the platform, honouring alignments beyond what it guarantees.
+ *
+ * Over-aligned blocks are over-allocated, with the platform's pointer stashed just before
+ * the aligned block so it can be recovered on free.
+ */
+static void* platform_allocate_aligned(u64 size, u16 alignment) {
+    if (alignment <= PLATFORM_MIN_ALIGNMENT) {
+        return platform_allocate(size, False);
+    }
+
+    u8* raw = platform_allocate(size + alignment + sizeof(void*), True);
+    void** aligned = (void**)get_aligned((u64)(raw + sizeof(void*)), alignment);
+    aligned[-1] = raw;
+    return aligned;
+}
+
+/**
+ * @brief Frees a block allocated with platform_allocate_aligned().
+ */
+static void platform_free_aligned(void* block, u16 alignment) {
+    if (alignment <= PLATFORM_MIN_ALIGNMENT) {
+        platform_free(block, False);
+    } else {
+        platform_free(((void**)block)[-1], True);
+    }
+}
+
 /**
  * @brief Initializes the memory tracking system.
  *
- * Resets all counters to zero.
+ * Resets all counters to zero, and reserves the engine heap if one is configured.
  */
-void initialize_memory(u64* memory_requirement, void* state) {
+b8 initialize_memory(u64* memory_requirement, void* state, memory_system_config config) {
     *memory_requirement = sizeof(memory_system_state);
 
     if (state == 0) {
-        return;
+        return True;
+    }
+
+    memory_system_state* new_state = state;
+    platform_zero_memory(new_state, sizeof(memory_system_state));
+    new_state->config = config;
+
+    if (config.total_alloc_size) {
+        u64 allocator_requirement = 0;
+        if (!dynamic_allocator_create(config.total_alloc_size, &allocator_requirement, 0, 0)) {
+            KFATAL("initialize_memory - Unable to size the engine heap.");
+            return False;
+        }
+
+        new_state->allocator_memory_size = allocator_requirement;
+        new_state->allocator_memory = platform_allocate(allocator_requirement, True);
+        if (!new_state->allocator_memory) {
+            KFATAL("initialize_memory - Unable to reserve %llu bytes for the engine heap.", allocator_requirement);
+            return False;
+        }
+
+        if (!dynamic_allocator_create(config.total_alloc_size, &allocator_requirement, new_state->allocator_memory, &new_state->allocator)) {
+            KFATAL("initialize_memory - Unable to create the engine heap.");
+            platform_free(new_state->allocator_memory, True);
+            return False;
+        }
+    }
+
+    if (!kmutex_create(&new_state->allocation_mutex)) {
+        KFATAL("initialize_memory - Unable to create the allocation mutex.");
+        if (new_state->allocator_memory) {
+            platform_free(new_state->allocator_memory, True);
+        }
+        return False;
+    }
+
+    // Only publish the state once it is fully set up.
+    state_ptr = new_state;
+
+    if (config.total_alloc_size) {
+        KDEBUG("Memory system using a %llu byte engine heap.", config.total_alloc_size);
     }
 
-    state_ptr = state;
-    state_ptr->alloc_count = 0;
-    platform_zero_memory(&state_ptr->stats, sizeof(state_ptr->stats));
+    return True;
 }
 
 /**
  * @brief Shuts down the memory tracking system.
  *
- * Currently does nothing but can be extended to log final usage or detect leaks.
+ * Releases the engine heap, if any. Blocks allocated from it are invalid afterwards.
  */
 void shutdown_memory(void* state) {
-    // Optional TO-DO: Log final memory usage
+    if (state_ptr) {
+        if (state_ptr->allocator_memory) {
+            u64 heap_used = state_ptr->allocator.total_size - state_ptr->allocator.free_space;
+            KDEBUG("Releasing engine heap (%llu bytes still in use).", heap_used);
+            dynamic_allocator_destroy(&state_ptr->allocator);
+            platform_free(state_ptr->allocator_memory, True);
+            state_ptr->allocator_memory = 0;
+        }
+        kmutex_destroy(&state_ptr->allocation_mutex);
+    }
 
     state_ptr = 0;
 }
@@ -120,18 +210,38 @@ void shutdown_memory(void* state) {
  * @return A pointer to the allocated memory block.
  */
 void* kallocate(u64 size, memory_tag tag) {
+    return kallocate_aligned(size, 1, tag);
+}
+
+void* kallocate_aligned(u64 size, u16 alignment, memory_tag tag) {
     if (tag == MEMORY_TAG_UNKNOWN) {
         KWARN("kallocate called using MEMORY_TAG_UNKNOWN. Re-class this allocation.");
     }
 
+    void* block = 0;
     if (state_ptr) {
-        state_ptr->stats.total_allocated += size;
-        state_ptr->stats.tagged_allocations[tag] += size;
-        state_ptr->alloc_count++;
+        kmutex_lock(&state_ptr->allocation_mutex);
+        if (state_ptr->allocator_memory) {
+            block = dynamic_allocator_allocate_aligned(&state_ptr->allocator, size, alignment);
+        } else {
+            block = platform_allocate_aligned(size, alignment);
+        }
+
+        if (block) {
+            state_ptr->stats.total_allocated += size;
+            state_ptr->stats.tagged_allocations[tag] += size;
+            state_ptr->alloc_count++;
+        }
+        kmutex_unlock(&state_ptr->allocation_mutex);
+    } else {
+        block = platform_allocate_aligned(size, alignment);
+    }
+
+    if (!block) {
+        KFATAL("kallocate - Out of memory allocating %llu bytes (tag %s).", size, memory_tag_strings[tag]);
+        return 0;
     }
 
-    // TODO: Memory alignment
-    void* block = platform_allocate(size, False);
     platform_zero_memory(block, size);
 
     return block;
@@ -147,17 +257,45 @@ void* kallocate(u64 size, memory_tag tag) {
  * @param tag Tag used when originally allocating the block.
  */
 void kfree(void* block, u64 size, memory_tag tag) {
+    kfree_aligned(block, size, 1, tag);
+}
+
+void kfree_aligned(void* block, u64 size, u16 alignment, memory_tag tag) {
     if (tag == MEMORY_TAG_UNKNOWN) {
         KWARN("kfree called using MEMORY_TAG_UNKNOWN. Re-class this allocation.");
     }
 
     if (state_ptr) {
+        kmutex_lock(&state_ptr->allocation_mutex);
         state_ptr->stats.total_allocated -= size;
         state_ptr->stats.tagged_allocations[tag] -= size;
+
+        // Blocks allocated before the heap existed come from the platform.
+        if (dynamic_allocator_owns(&state_ptr->allocator, block)) {
+            dynamic_allocator_free(&state_ptr->allocator, block);
+            kmutex_unlock(&state_ptr->allocation_mutex);
+            return;
+        }
+        kmutex_unlock(&state_ptr->allocation_mutex);
     }
 
-    // TODO: Memory alignment
-    platform_free(block, False);
+    platform_free_aligned(block, alignment);
+}
+
+void kmemory_report_allocation(u64 size, memory_tag tag) {
+    if (state_ptr) {
+        kmutex_lock(&state_ptr->allocation_mutex);
+        state_ptr->stats.tagged_allocations[tag] += size;
+        kmutex_unlock(&state_ptr->allocation_mutex);
+    }
+}
+
+void kmemory_report_free(u64 size, memory_tag tag) {
+    if (state_ptr) {
+        kmutex_lock(&state_ptr->allocation_mutex);
+        state_ptr->stats.tagged_allocations[tag] -= size;
+        kmutex_unlock(&state_ptr->allocation_mutex);
+    }
 }
 
 /**
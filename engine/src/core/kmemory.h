@@ -11,6 +11,10 @@
  * - Total allocations per tag
  * - Potential leaks or misuses
  *
+ * When configured with a non-zero total_alloc_size, all allocations are served from a single
+ * engine-owned heap reserved at startup (see memory/dynamic_allocator.h), giving O(1) allocation
+ * and a hard cap on memory use. Otherwise allocations go straight to the platform allocator.
+ *
  * Usage:
  * Replace raw `malloc()`/`free()` calls with `kallocate()`/`kfree()`.
  */
@@ -76,21 +80,52 @@ typedef enum memory_tag {
     /** Scene management */
     MEMORY_TAG_SCENE,
 
+    /** GPU memory in device-local heaps. Reported by the renderer, not allocated with kallocate() */
+    MEMORY_TAG_GPU_LOCAL,
+
+    /** GPU memory in host-visible heaps. Reported by the renderer, not allocated with kallocate() */
+    MEMORY_TAG_GPU_HOST,
+
+    /** Vertex and index data in the renderer's geometry buffers. Part of the GPU_LOCAL figure */
+    MEMORY_TAG_GPU_GEOMETRY,
+
     /** Must be last -- represents total number of tags */
     MEMORY_TAG_MAX_TAGS
 } memory_tag;
 
+/**
+ * @struct memory_system_config
+ * @brief Configuration for the memory system.
+ */
+typedef struct memory_system_config {
+    /**
+     * @brief The total size, in bytes, of the engine heap reserved at startup that kallocate()
+     * allocates from. Allocations beyond it fail. 0 allocates straight from the platform instead.
+     */
+    u64 total_alloc_size;
+} memory_system_config;
+
 /**
  * @brief Initializes the memory allocator subsystem.
  *
- * Sets internal counters to zero and prepares for tracking allocations.
+ * Sets internal counters to zero and, if configured, reserves the engine heap.
+ * Should be called twice; once with state = 0 to obtain the memory requirement, then a
+ * second time passing an allocated block of that size.
+ *
+ * Blocks allocated before the system is initialized come from the platform allocator, and
+ * may still be freed with kfree() afterwards.
+ *
+ * @param memory_requirement A pointer to hold the memory requirement of the system.
+ * @param state A block of memory to hold the state, or 0 to only obtain the memory requirement.
+ * @param config The configuration for the system.
+ * @return True on success; otherwise False.
  */
-KAPI void initialize_memory(u64* memory_requirement, void* state);
+KAPI b8 initialize_memory(u64* memory_requirement, void* state, memory_system_config config);
 
 /**
- * @brief Shuts down the memory allocator subsystem.
+ * @brief Shuts down the memory allocator subsystem, releasing the engine heap.
  *
- * Currently does nothing but may be extended to log final stats or validate leaks.
+ * Should be the last system shut down, as blocks from the engine heap are invalid afterwards.
  */
 KAPI void shutdown_memory(void* state);
 
@@ -112,6 +147,43 @@ KAPI void* kallocate(u64 size, memory_tag tag);
  */
 KAPI void kfree(void* block, u64 size, memory_tag tag);
 
+/**
+ * @brief Allocates memory with the given size, alignment and tag.
+ *
+ * @param size The number of bytes to allocate.
+ * @param alignment The alignment of the block in bytes. Must be a power of 2.
+ * @param tag A memory_tag to classify this allocation.
+ * @return A pointer to the allocated memory block.
+ */
+KAPI void* kallocate_aligned(u64 size, u16 alignment, memory_tag tag);
+
+/**
+ * @brief Frees a memory block allocated with kallocate_aligned().
+ *
+ * @param block Pointer to the memory block to free.
+ * @param size Size of the memory block in bytes.
+ * @param alignment The alignment the block was allocated with.
+ * @param tag Tag used when originally allocating the block.
+ */
+KAPI void kfree_aligned(void* block, u64 size, u16 alignment, memory_tag tag);
+
+/**
+ * @brief Reports memory allocated outside of the engine (e.g. GPU memory) under the given tag,
+ * so it shows up in get_memory_usage_str(). Not included in the total allocated by kallocate().
+ *
+ * @param size The number of bytes allocated.
+ * @param tag The tag to report the allocation under.
+ */
+KAPI void kmemory_report_allocation(u64 size, memory_tag tag);
+
+/**
+ * @brief Reports that memory previously reported with kmemory_report_allocation() was freed.
+ *
+ * @param size The number of bytes freed.
+ * @param tag The tag the allocation was reported under.
+ */
+KAPI void kmemory_report_free(u64 size, memory_tag tag);
+
 /**
  * @brief Fills the provided memory block with zeros.
  *
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * @file kmutex.h
+ * @brief Platform-agnostic mutual exclusion lock.
+ *
+ * Implemented separately for each OS in the platform_*.c files.
+ */
+
+/**
+ * @struct kmutex
+ * @brief A mutex, used to synchronize access to a resource between threads.
+ */
+typedef struct kmutex {
+    /** Platform-specific mutex handle. */
+    void* internal_data;
+} kmutex;
+
+/**
+ * @brief Creates a mutex.
+ *
+ * @param out_mutex A pointer to hold the created mutex. Required.
+ * @return True if created successfully; otherwise False.
+ */
+KAPI b8 kmutex_create(kmutex* out_mutex);
+
+/**
+ * @brief Destroys the provided mutex.
+ *
+ * @param mutex A pointer to the mutex to be destroyed.
+ */
+KAPI void kmutex_destroy(kmutex* mutex);
+
+/**
+ * @brief Creates a mutex lock, blocking until the lock is obtained.
+ *
+ * @param mutex A pointer to the mutex to lock.
+ * @return True if locked successfully; otherwise False.
+ */
+KAPI b8 kmutex_lock(kmutex* mutex);
+
+/**
+ * @brief Unlocks the given mutex.
+ *
+ * @param mutex A pointer to the mutex to unlock.
+ * @return True if unlocked successfully; otherwise False.
+ */
+KAPI b8 kmutex_unlock(kmutex* mutex);
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * @file ksemaphore.h
+ * @brief Platform-agnostic counting semaphore.
+ *
+ * Used to put threads to sleep until work is available, rather than spinning.
+ * Implemented separately for each OS in the platform_*.c files.
+ */
+
+/**
+ * @struct ksemaphore
+ * @brief A counting semaphore.
+ */
+typedef struct ksemaphore {
+    /** Platform-specific semaphore handle. */
+    void* internal_data;
+} ksemaphore;
+
+/**
+ * @brief Creates a semaphore.
+ *
+ * @param out_semaphore A pointer to hold the created semaphore. Required.
+ * @param max_count The maximum count the semaphore can reach. Ignored on platforms without a limit.
+ * @param start_count The count the semaphore starts at.
+ * @return True if created successfully; otherwise False.
+ */
+KAPI b8 ksemaphore_create(ksemaphore* out_semaphore, u32 max_count, u32 start_count);
+
+/**
+ * @brief Destroys the provided semaphore.
+ *
+ * @param semaphore A pointer to the semaphore to be destroyed.
+ */
+KAPI void ksemaphore_destroy(ksemaphore* semaphore);
+
+/**
+ * @brief Increments the semaphore count, waking one waiting thread if any.
+ *
+ * @param semaphore A pointer to the semaphore to signal.
+ * @return True if signaled successfully; otherwise False.
+ */
+KAPI b8 ksemaphore_signal(ksemaphore* semaphore);
+
+/**
+ * @brief Blocks until the semaphore count is above zero, then decrements it.
+ *
+ * @param semaphore A pointer to the semaphore to wait on.
+ * @return True if the wait succeeded; otherwise False.
+ */
+KAPI b8 ksemaphore_wait(ksemaphore* semaphore);
@@ -73,6 +73,30 @@ i32 string_format_v(char* dest, const char* format, void* va_listp) {
     return -1;
 }
 
+i32 string_nformat(char* dest, u64 dest_size, const char* format, ...) {
+    if (dest) {
+        __builtin_va_list arg_ptr;
+        va_start(arg_ptr, format);
+        i32 written = string_nformat_v(dest, dest_size, format, arg_ptr);
+        va_end(arg_ptr);
+        return written;
+    }
+    return -1;
+}
+
+i32 string_nformat_v(char* dest, u64 dest_size, const char* format, void* va_listp) {
+    if (dest && dest_size) {
+        i32 written = vsnprintf(dest, dest_size, format, va_listp);
+        if (written < 0) {
+            dest[0] = 0;
+            return -1;
+        }
+        // vsnprintf reports the untruncated length.
+        return written < (i64)dest_size ? written : (i32)(dest_size - 1);
+    }
+    return -1;
+}
+
 char* string_copy(char* dest, const char* source) {
     return strcpy(dest, source);
 }
@@ -78,6 +78,29 @@ KAPI i32 string_format(char* dest, const char* format, ...);
  */
 KAPI i32 string_format_v(char* dest, const char* format, void* va_list);
 
+/**
+ * @brief Performs string formatting into a buffer of limited size, truncating if needed.
+ * Unlike string_format(), no large intermediate buffer is used.
+ *
+ * @param dest The destination buffer.
+ * @param dest_size The size of the destination buffer, including room for the null terminator.
+ * @param format The format string to use for the operation.
+ * @param ... The format arguments.
+ * @returns The number of characters written, excluding the null terminator, or -1 on error.
+ */
+KAPI i32 string_nformat(char* dest, u64 dest_size, const char* format, ...);
+
+/**
+ * @brief Performs variadic string formatting into a buffer of limited size, truncating if needed.
+ *
+ * @param dest The destination buffer.
+ * @param dest_size The size of the destination buffer, including room for the null terminator.
+ * @param format The string to be formatted.
+ * @param va_list The variadic argument list.
+ * @returns The number of characters written, excluding the null terminator, or -1 on error.
+ */
+KAPI i32 string_nformat_v(char* dest, u64 dest_size, const char* format, void* va_list);
+
 /**
  * @brief Copies the source string to the destination string, including the null terminator.
  *
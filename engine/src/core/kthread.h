@@ -0,0 +1,76 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * @file kthread.h
+ * @brief Platform-agnostic thread interface.
+ *
+ * Threads are created through the platform layer, which owns the native handle.
+ * Implemented separately for each OS in the platform_*.c files.
+ */
+
+/**
+ * @brief A function pointer to be invoked when a thread starts.
+ *
+ * @param params The parameters passed to `kthread_create()`.
+ * @return An exit code for the thread.
+ */
+typedef u32 (*pfn_thread_start)(void* params);
+
+/**
+ * @struct kthread
+ * @brief Represents a process thread in the system.
+ */
+typedef struct kthread {
+    /** Platform-specific thread handle. */
+    void* internal_data;
+
+    /** The id of the thread, as reported by the OS. */
+    u64 thread_id;
+} kthread;
+
+/**
+ * @brief Creates a new thread, immediately calling the function pointed to.
+ *
+ * @param start_function_ptr The function to be invoked on the new thread. Required.
+ * @param params Data to be passed to the start function. Optional.
+ * @param auto_detach Indicates if the thread should immediately release its resources when the work is complete. If True, out_thread is not set.
+ * @param out_thread A pointer to hold the created thread, if auto_detach is False.
+ * @return True if successfully created; otherwise False.
+ */
+KAPI b8 kthread_create(pfn_thread_start start_function_ptr, void* params, b8 auto_detach, kthread* out_thread);
+
+/**
+ * @brief Destroys the given thread, releasing its platform handle.
+ *
+ * @param thread A pointer to the thread to be destroyed.
+ */
+KAPI void kthread_destroy(kthread* thread);
+
+/**
+ * @brief Detaches the thread, automatically releasing its resources when work is complete.
+ *
+ * @param thread A pointer to the thread to be detached.
+ */
+KAPI void kthread_detach(kthread* thread);
+
+/**
+ * @brief Blocks the calling thread until the given thread has exited.
+ *
+ * @param thread A pointer to the thread to wait on.
+ * @return True if the thread exited; otherwise False.
+ */
+KAPI b8 kthread_wait(kthread* thread);
+
+/**
+ * @brief Obtains the identifier of the calling thread.
+ *
+ * @return The OS identifier of the calling thread.
+ */
+KAPI u64 kthread_get_id();
+
+/**
+ * @brief Hints to the OS that the calling thread can give up the rest of its time slice.
+ */
+KAPI void kthread_yield();
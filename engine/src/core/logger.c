@@ -1,17 +1,31 @@
 #include "logger.h"
 #include "kmemory.h"
 #include "kstring.h"
+#include "kthread.h"
+#include "ksemaphore.h"
 #include "platform/platform.h"
 #include "platform/filesystem.h"
 
 // TO-DO: TEMPORARY
 #include <stdarg.h>  // for variable argument lists (va_list)
+#include <stdatomic.h>
 // #include <unistd.h>  // for isatty() - seeing if terminal supports colour
 
 /**
- * @brief Maximum length of a log message.
+ * @brief Maximum length of a single log record, including the level prefix and colour codes.
+ * Longer messages are truncated.
  */
-#define MSG_LENGTH 32000
+#define LOG_RECORD_MAX_LENGTH 1024
+
+/**
+ * @brief Number of records the ring buffer holds. Must be a power of 2.
+ */
+#define LOG_RING_CAPACITY 1024
+
+/**
+ * @brief Size of the writer thread's output batches.
+ */
+#define LOG_BATCH_SIZE (32 * 1024)
 
 /**
  * @file logger.c
@@ -20,6 +34,16 @@
  * Implements the logging functionality with color-coded terminal output,
  * message formatting, and integration with platform-specific console writes.
  *
+ * Once initialized, output is asynchronous: log_output() formats a record on the calling thread
+ * and copies it into a bounded multi-producer/single-consumer ring buffer, and a dedicated writer
+ * thread drains the ring in batches to the console and console.log. If the ring is full the
+ * record is dropped and counted, rather than blocking the caller. ERROR messages are never
+ * dropped: if the ring is full they are written synchronously instead. FATAL messages (including
+ * assertion failures) bypass the ring, waiting until everything logged so far has been written
+ * and then writing themselves synchronously.
+ *
+ * Before initialization and after shutdown, output is written synchronously.
+ *
  * Features:
  * - Level-based filtering
  * - ANSI escape codes for color output
@@ -27,6 +51,24 @@
  * - Assertion failure handler
  */
 
+/**
+ * @struct log_record
+ * @brief A single formatted message in the ring buffer.
+ */
+typedef struct log_record {
+    /**
+     * @brief Sequence number coordinating producers and the writer. Equals the record's ring
+     * position when free for that position, and position + 1 once the record is published.
+     */
+    _Atomic u64 sequence;
+    /** @brief The level the message was logged at. */
+    log_level level;
+    /** @brief The length of text, excluding the null terminator. */
+    u32 length;
+    /** @brief The fully formatted message. */
+    char text[LOG_RECORD_MAX_LENGTH];
+} log_record;
+
 /**
  * @struct logger_system_state
  *
@@ -37,6 +79,34 @@ typedef struct logger_system_state {
      * @brief Handle to the log file.
      */
     file_handle log_file_handle;
+
+    /** @brief The ring buffer of records waiting to be written. */
+    log_record records[LOG_RING_CAPACITY];
+    /** @brief The next ring position producers will claim. */
+    _Atomic u64 enqueue_pos;
+    /** @brief The next ring position the writer will read. Only touched by the writer thread. */
+    u64 dequeue_pos;
+    /** @brief All positions below this have been written out. Used to wait for a flush. */
+    _Atomic u64 written_pos;
+    /** @brief The number of records dropped because the ring was full. */
+    _Atomic u64 dropped_count;
+    /** @brief The number of dropped records the writer has already reported. */
+    u64 reported_dropped_count;
+
+    /** @brief Set while the writer thread should keep running. */
+    _Atomic b8 running;
+    /** @brief The writer thread. */
+    kthread writer_thread;
+    /** @brief Signalled when records are published, waking the writer thread. */
+    ksemaphore wake_semaphore;
+
+    /** @brief Consecutive records of one level, written to the console together. */
+    char console_batch[LOG_BATCH_SIZE];
+    u64 console_batch_length;
+    log_level console_batch_level;
+    /** @brief Records waiting to be written to the log file. */
+    char file_batch[LOG_BATCH_SIZE];
+    u64 file_batch_length;
 } logger_system_state;
 
 // Pointer to the logger system state.
@@ -45,22 +115,154 @@ static logger_system_state* state_ptr;
 /**
  * @brief Appends a message to the log file.
  *
+ * @param state The logger state holding the log file.
  * @param message The message to append.
+ * @param length The length of the message.
  */
-void append_to_log_file(const char* message) {
-    if (state_ptr && state_ptr->log_file_handle.is_valid) {
-        // Since the message contains '\n' write it out
-        u64 length = string_length(message);
+static void append_to_log_file(logger_system_state* state, const char* message, u64 length) {
+    if (state->log_file_handle.is_valid) {
         u64 written = 0;
 
-        if (!filesystem_write(&state_ptr->log_file_handle, length, message, &written)) {
+        if (!filesystem_write(&state->log_file_handle, length, message, &written)) {
             platform_console_write_error("Error writing to console.log.", LOG_LEVEL_ERROR);
         }
     }
 }
 
-// Initialize the logging system.
-// For now it just returns True. Later, you can create/open a log file here.
+/**
+ * @brief Writes a message to the console, routing errors to the error stream.
+ */
+static void write_to_console(const char* message, log_level level) {
+    // True if the log level is FATAL or ERROR
+    b8 is_error = level < LOG_LEVEL_WARN;
+
+    // Platform Specific Output
+    if (is_error) {
+        platform_console_write_error(message, level);
+    } else {
+        platform_console_write(message, level);
+    }
+}
+
+/** @brief Writes out the pending console batch. Writer thread only. */
+static void flush_console_batch(logger_system_state* state) {
+    if (state->console_batch_length) {
+        state->console_batch[state->console_batch_length] = 0;
+        write_to_console(state->console_batch, state->console_batch_level);
+        state->console_batch_length = 0;
+    }
+}
+
+/** @brief Writes out the pending file batch. Writer thread only. */
+static void flush_file_batch(logger_system_state* state) {
+    if (state->file_batch_length) {
+        append_to_log_file(state, state->file_batch, state->file_batch_length);
+        state->file_batch_length = 0;
+    }
+}
+
+/** @brief Adds a record's text to both output batches, writing them out first if needed. Writer thread only. */
+static void batch_record(logger_system_state* state, log_level level, const char* text, u64 length) {
+    // The console batch only holds one level, as the console colours by level.
+    if (state->console_batch_length && (state->console_batch_level != level || state->console_batch_length + length >= LOG_BATCH_SIZE)) {
+        flush_console_batch(state);
+    }
+    kcopy_memory(state->console_batch + state->console_batch_length, text, length);
+    state->console_batch_length += length;
+    state->console_batch_level = level;
+
+    if (state->file_batch_length + length > LOG_BATCH_SIZE) {
+        flush_file_batch(state);
+    }
+    kcopy_memory(state->file_batch + state->file_batch_length, text, length);
+    state->file_batch_length += length;
+}
+
+/**
+ * @brief Writes out every published record. Writer thread only.
+ */
+static void drain_records(logger_system_state* state) {
+    while (True) {
+        log_record* record = &state->records[state->dequeue_pos & (LOG_RING_CAPACITY - 1)];
+        u64 sequence = atomic_load_explicit(&record->sequence, memory_order_acquire);
+        if (sequence != state->dequeue_pos + 1) {
+            // Not yet published; everything before it has been handled.
+            break;
+        }
+
+        batch_record(state, record->level, record->text, record->length);
+
+        // Hand the record back to producers for its next lap around the ring.
+        atomic_store_explicit(&record->sequence, state->dequeue_pos + LOG_RING_CAPACITY, memory_order_release);
+        state->dequeue_pos++;
+    }
+
+    u64 dropped = atomic_load_explicit(&state->dropped_count, memory_order_relaxed);
+    if (dropped != state->reported_dropped_count) {
+        char notice[128];
+        i32 length = string_nformat(notice, sizeof(notice), "\033[0;33m[WARN]:  Logger dropped %llu messages; the log ring buffer was full.\033[0m\n", dropped - state->reported_dropped_count);
+        batch_record(state, LOG_LEVEL_WARN, notice, length);
+        state->reported_dropped_count = dropped;
+    }
+
+    flush_console_batch(state);
+    flush_file_batch(state);
+
+    atomic_store_explicit(&state->written_pos, state->dequeue_pos, memory_order_release);
+}
+
+/**
+ * @brief Entry point of the writer thread. Sleeps until records are published, then writes them out.
+ */
+static u32 log_writer_thread(void* params) {
+    logger_system_state* state = params;
+    while (True) {
+        ksemaphore_wait(&state->wake_semaphore);
+        b8 running = atomic_load(&state->running);
+        drain_records(state);
+        if (!running) {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Copies a record into the ring buffer and wakes the writer.
+ *
+ * @return True if the record was queued; False if the ring was full.
+ */
+static b8 enqueue_record(logger_system_state* state, log_level level, const char* text, u32 length) {
+    log_record* record = 0;
+    u64 pos = atomic_load_explicit(&state->enqueue_pos, memory_order_relaxed);
+    while (True) {
+        record = &state->records[pos & (LOG_RING_CAPACITY - 1)];
+        u64 sequence = atomic_load_explicit(&record->sequence, memory_order_acquire);
+        i64 difference = (i64)sequence - (i64)pos;
+        if (difference == 0) {
+            // The record is free for this position; try to claim it.
+            if (atomic_compare_exchange_weak_explicit(&state->enqueue_pos, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // The writer hasn't freed this record from the previous lap yet: the ring is full.
+            return False;
+        } else {
+            // Another producer claimed this position first.
+            pos = atomic_load_explicit(&state->enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    record->level = level;
+    record->length = length;
+    kcopy_memory(record->text, text, length + 1);
+    atomic_store_explicit(&record->sequence, pos + 1, memory_order_release);
+
+    ksemaphore_signal(&state->wake_semaphore);
+    return True;
+}
+
 b8 initialize_logging(u64* memory_requirement, void* state) {
     *memory_requirement = sizeof(logger_system_state);
 
@@ -68,24 +270,73 @@ b8 initialize_logging(u64* memory_requirement, void* state) {
         return True;  // No state provided, nothing to initialize
     }
 
-    state_ptr = state;
+    logger_system_state* new_state = state;
+    kzero_memory(new_state, sizeof(logger_system_state));
+    for (u64 i = 0; i < LOG_RING_CAPACITY; ++i) {
+        atomic_init(&new_state->records[i].sequence, i);
+    }
 
     // Create new/wipe existing log_file, then open it
-    if (!filesystem_open("console.log", FILE_MODE_WRITE, False, &state_ptr->log_file_handle)) {
+    if (!filesystem_open("console.log", FILE_MODE_WRITE, False, &new_state->log_file_handle)) {
         platform_console_write_error("Failed to open console.log for writing.", LOG_LEVEL_ERROR);
         return False;  // Failed to open log file
     }
 
-    // TO-DO: Create log file
+    if (!ksemaphore_create(&new_state->wake_semaphore, LOG_RING_CAPACITY, 0)) {
+        platform_console_write_error("Failed to create the log writer semaphore.", LOG_LEVEL_ERROR);
+        filesystem_close(&new_state->log_file_handle);
+        return False;
+    }
+
+    atomic_store(&new_state->running, True);
+    if (!kthread_create(log_writer_thread, new_state, False, &new_state->writer_thread)) {
+        platform_console_write_error("Failed to start the log writer thread.", LOG_LEVEL_ERROR);
+        ksemaphore_destroy(&new_state->wake_semaphore);
+        filesystem_close(&new_state->log_file_handle);
+        return False;
+    }
+
+    // Only route messages to the writer once it is running.
+    state_ptr = new_state;
+
     return True;
 }
 
-// Clean up the logging system.
-// Placeholder for cleanup, like flushing buffers or closing the log file.
 void shutdown_logging(void* state) {
-    // TO-DO: Cleanup logging/write queued
+    if (state_ptr) {
+        logger_system_state* old_state = state_ptr;
+
+        // New messages are written synchronously from here on.
+        state_ptr = 0;
+
+        // Wake the writer one last time so it drains whatever is left, then exits.
+        atomic_store(&old_state->running, False);
+        ksemaphore_signal(&old_state->wake_semaphore);
+        kthread_wait(&old_state->writer_thread);
+        kthread_destroy(&old_state->writer_thread);
+        ksemaphore_destroy(&old_state->wake_semaphore);
+
+        filesystem_close(&old_state->log_file_handle);
+    }
+}
 
-    state_ptr = 0;
+void logger_flush() {
+    logger_system_state* state = state_ptr;
+    if (!state) {
+        return;
+    }
+
+    // Wait for everything claimed so far to be written out.
+    u64 target = atomic_load(&state->enqueue_pos);
+    ksemaphore_signal(&state->wake_semaphore);
+    while (atomic_load_explicit(&state->written_pos, memory_order_acquire) < target) {
+        kthread_yield();
+    }
+}
+
+u64 logger_dropped_count() {
+    logger_system_state* state = state_ptr;
+    return state ? atomic_load(&state->dropped_count) : 0;
 }
 
 // Logs a message at a given level, with formatting like printf.
@@ -93,11 +344,6 @@ void shutdown_logging(void* state) {
 // message is a printf-style format string.
 // ... are the variable arguments for formatting.
 void log_output(log_level level, const char* message, ...) {
-    /**
-     * TO-DO: Move string operations to their own thread
-     * The ops are pretty slow, and can slow down the engine during startup/shutdown.
-     * Work on threading and offset these ops.
-     */
     // ANSI color prefixes
     const char* level_colors[6] = {
         "\033[1;31m",  // FATAL - bold red
@@ -108,22 +354,18 @@ void log_output(log_level level, const char* message, ...) {
         "\033[0;37m"   // TRACE - light gray
     };
 
-    // Resets the terminal color
-    const char* level_reset = "\033[0m";
+    // Resets the terminal color, and ends the line.
+    const char* level_reset = "\033[0m\n";
+    const u64 reset_length = 5;
 
     // Level prefixes to show log severity
     const char* level_strings[6] = {"[FATAL]: ", "[ERROR]: ", "[WARN]:  ", "[INFO]:  ", "[DEBUG]: ", "[TRACE]: "};
 
-    // True if the log level is FATAL or ERROR
-    b8 is_error = level < LOG_LEVEL_WARN;
-
-    // RISKY Code since we are avoiding memory allocation which is slow
-    // It technically imposes a 32k character limit on a single log entry, this SHOULD NOT HAPPEN
-    // Buffer for the formatted message. Large buffer to avoid malloc.
-    char out_message[MSG_LENGTH];
-    kzero_memory(out_message, sizeof(out_message));
+    // The whole record is formatted on the stack, then copied into the ring buffer.
+    char record[LOG_RECORD_MAX_LENGTH];
+    i32 length = string_nformat(record, LOG_RECORD_MAX_LENGTH, "%s%s", level_colors[level], level_strings[level]);
 
-    // Format original message.
+    // Format original message, leaving room for the reset sequence.
     // NOTE: Oddly enough, MS's headers override the GCC/Clang va_list type with a "typedef char* va_list" in some
     // cases, and as a result throws a strange error here. The workaround for now is to just use __builtin_va_list,
     // which is the type GCC/Clang's va_start expects.
@@ -135,24 +377,35 @@ void log_output(log_level level, const char* message, ...) {
     va_start(arg_ptr, message);
 
     // Format into buffer
-    string_format_v(out_message, message, arg_ptr);
+    i32 message_length = string_nformat_v(record + length, LOG_RECORD_MAX_LENGTH - length - reset_length, message, arg_ptr);
     va_end(arg_ptr);
 
-    // Final buffer with level prefix added
-    char out_message2[MSG_LENGTH];
-    string_format(out_message2, "%s%s%s%s\n", level_colors[level], level_strings[level], out_message, level_reset);
-
-    // Platform Specific Output
-    if (is_error) {
-        platform_console_write_error(out_message2, level);
-    } else {
-        platform_console_write(out_message2, level);
+    if (message_length > 0) {
+        length += message_length;
     }
+    kcopy_memory(record + length, level_reset, reset_length + 1);
+    length += reset_length;
 
-    append_to_log_file(out_message2);
+    logger_system_state* state = state_ptr;
+    if (!state) {
+        write_to_console(record, level);
+    } else if (level == LOG_LEVEL_FATAL) {
+        // Whatever comes next may take the process down, so don't leave the message in the ring.
+        logger_flush();
+        write_to_console(record, level);
+        append_to_log_file(state, record, length);
+    } else if (!enqueue_record(state, level, record, length)) {
+        if (level == LOG_LEVEL_ERROR) {
+            // Errors are too important to drop. Both streams lock, so this can't tear the writer's output.
+            write_to_console(record, level);
+            append_to_log_file(state, record, length);
+        } else {
+            atomic_fetch_add_explicit(&state->dropped_count, 1, memory_order_relaxed);
+        }
+    }
 }
 
-// Called when an assertion fails to log useful debugging info.
 void report_assertion_failure(const char* expression, const char* message, const char* file, i32 line) {
+    // Logged as FATAL, so this is flushed before the debug break.
     log_output(LOG_LEVEL_FATAL, "Assertion Failure: %s, message: '%s', in file: %s, line: %d\n", expression, message, file, line);
-}
\ No newline at end of file
+}
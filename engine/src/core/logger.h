@@ -11,6 +11,7 @@
  * - Compile-time log level filtering
  * - Color-coded console output
  * - Assertion failure reporting
+ * - Asynchronous output on a dedicated writer thread, so logging doesn't stall callers
  *
  * Usage:
  * Use the provided macros (`KFATAL`, `KERROR`, `KWARN`, etc.) to log messages at different severity levels.
@@ -118,13 +119,27 @@ b8 initialize_logging(u64* memory_requirement, void* state);
 /**
  * @brief Shuts down the logging system.
  *
- * Currently just returns. In future versions, this may include:
- * - Flushing buffered logs
- * - Closing log files
- * - Releasing logging resources
+ * Writes out any queued messages, stops the writer thread and closes the log file.
+ * Messages logged afterwards are written synchronously to the console.
+ * Should only be called once no other threads are logging.
  */
 void shutdown_logging(void* state);
 
+/**
+ * @brief Blocks until every message logged so far has been written out.
+ *
+ * Called automatically before FATAL messages, including assertion failures, are written.
+ */
+KAPI void logger_flush();
+
+/**
+ * @brief Obtains the number of messages dropped so far because the log ring buffer was full.
+ * ERROR and FATAL messages are never dropped.
+ *
+ * @return The number of dropped messages, or 0 if the logging system is not running.
+ */
+KAPI u64 logger_dropped_count();
+
 /**
  * @brief Logs a formatted message at the specified log level.
  *
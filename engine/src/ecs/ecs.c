@@ -0,0 +1,534 @@
+#include "ecs.h"
+
+#include "core/kmemory.h"
+#include "core/logger.h"
+#include "systems/job_system.h"
+
+/**
+ * @file ecs.c
+ * @brief Implementation of the entity component system.
+ *
+ * Chunk layout, for an archetype holding n entities per chunk:
+ * - n entity handles, from offset 0.
+ * - For each component in the archetype, in id order, n components, from a 16-byte aligned offset.
+ *
+ * n is the largest count that fits in ECS_CHUNK_SIZE once the arrays are aligned. Chunks are
+ * aligned to a cache line, and freed as soon as they empty.
+ *
+ * Archetypes remember which archetype adding or removing each component leads to, so moving
+ * entities between archetypes only searches the archetype list the first time.
+ */
+
+/** @brief The alignment of each chunk. */
+#define ECS_CHUNK_ALIGNMENT 64
+
+/** @brief The alignment of each component array within a chunk. */
+#define ECS_ARRAY_ALIGNMENT 16
+
+/** @brief The fewest chunks each job of `ecs_world_run_systems()` runs. */
+#define ECS_JOB_CHUNK_COUNT 8
+
+/** @brief The number of jobs per worker thread a phase aims to be split into, so workers stay busy as they finish at different times. */
+#define ECS_JOBS_PER_WORKER 4
+
+/**
+ * @struct ecs_job_params
+ * @brief The work items handed to each job of `ecs_world_run_systems()`.
+ */
+typedef struct ecs_job_params {
+    ecs_world* world;
+    const ecs_work_item* items;
+    u32 item_count;
+    f32 delta_time;
+} ecs_job_params;
+
+static u32 entity_index(ecs_entity entity) {
+    return (u32)(entity & 0xFFFFFFFFu);
+}
+
+static u32 entity_generation(ecs_entity entity) {
+    return (u32)(entity >> 32);
+}
+
+/** @brief Grows an array to hold at least the given number of entries, doubling its size. */
+static void grow(void** array, u32* slots, u32 needed, u64 stride) {
+    if (needed <= *slots) {
+        return;
+    }
+    u32 new_slots = *slots ? *slots : 16;
+    while (new_slots < needed) {
+        new_slots *= 2;
+    }
+    void* block = kallocate(stride * new_slots, MEMORY_TAG_ENTITY);
+    if (*array) {
+        kcopy_memory(block, *array, stride * *slots);
+        kfree(*array, stride * *slots, MEMORY_TAG_ENTITY);
+    }
+    *array = block;
+    *slots = new_slots;
+}
+
+/** @brief Returns the record of the entity a handle refers to, or 0 if it no longer exists. */
+static ecs_entity_record* resolve(const ecs_world* world, ecs_entity entity) {
+    u32 index = entity_index(entity);
+    if (index >= world->record_count) {
+        return 0;
+    }
+    ecs_entity_record* record = &world->records[index];
+    if (record->archetype == INVALID_ID || record->generation != entity_generation(entity)) {
+        return 0;
+    }
+    return record;
+}
+
+static ecs_component_mask registered_mask(const ecs_world* world) {
+    return world->component_count == ECS_MAX_COMPONENTS ? ~0ull : ECS_COMPONENT_BIT(world->component_count) - 1;
+}
+
+static b8 query_matches(ecs_query query, ecs_component_mask mask) {
+    return (mask & query.all) == query.all && !(mask & query.none);
+}
+
+static u32 archetype_find_or_create(ecs_world* world, ecs_component_mask mask) {
+    for (u32 i = 0; i < world->archetype_count; ++i) {
+        if (world->archetypes[i].mask == mask) {
+            return i;
+        }
+    }
+
+    grow((void**)&world->archetypes, &world->archetype_slots, world->archetype_count + 1, sizeof(ecs_archetype));
+    u32 index = world->archetype_count++;
+    ecs_archetype* archetype = &world->archetypes[index];
+    kzero_memory(archetype, sizeof(ecs_archetype));
+    kset_memory(archetype->add_edges, 0xFF, sizeof(archetype->add_edges));
+    kset_memory(archetype->remove_edges, 0xFF, sizeof(archetype->remove_edges));
+    archetype->mask = mask;
+
+    // Fit as many rows as possible, leaving room to align each array.
+    u32 row_size = sizeof(ecs_entity);
+    u32 array_count = 1;
+    for (u32 c = 0; c < world->component_count; ++c) {
+        if (mask & ECS_COMPONENT_BIT(c)) {
+            row_size += world->component_sizes[c];
+            array_count++;
+        }
+    }
+    u32 padding = array_count * ECS_ARRAY_ALIGNMENT;
+    u32 capacity = ECS_CHUNK_SIZE > padding ? (ECS_CHUNK_SIZE - padding) / row_size : 0;
+    archetype->chunk_capacity = capacity ? capacity : 1;
+
+    u32 offset = sizeof(ecs_entity) * archetype->chunk_capacity;
+    for (u32 c = 0; c < world->component_count; ++c) {
+        if (mask & ECS_COMPONENT_BIT(c)) {
+            offset = (offset + ECS_ARRAY_ALIGNMENT - 1) & ~(ECS_ARRAY_ALIGNMENT - 1);
+            archetype->offsets[c] = offset;
+            offset += world->component_sizes[c] * archetype->chunk_capacity;
+        }
+    }
+    archetype->chunk_size = offset > ECS_CHUNK_SIZE ? offset : ECS_CHUNK_SIZE;
+
+    return index;
+}
+
+/** @brief Returns the archetype reached by adding or removing a component, creating it if needed. */
+static u32 archetype_neighbour(ecs_world* world, u32 from, u32 component, b8 add) {
+    ecs_archetype* archetype = &world->archetypes[from];
+    u32 to = add ? archetype->add_edges[component] : archetype->remove_edges[component];
+    if (to != INVALID_ID) {
+        return to;
+    }
+
+    ecs_component_mask bit = ECS_COMPONENT_BIT(component);
+    to = archetype_find_or_create(world, add ? archetype->mask | bit : archetype->mask & ~bit);
+
+    // Creating the archetype may have moved the array.
+    archetype = &world->archetypes[from];
+    if (add) {
+        archetype->add_edges[component] = to;
+    } else {
+        archetype->remove_edges[component] = to;
+    }
+    return to;
+}
+
+/** @brief Appends an entity to the last chunk of an archetype, starting a new chunk if it is full. */
+static void archetype_push(ecs_archetype* archetype, ecs_entity entity, u32* out_chunk, u32* out_row) {
+    if (archetype->chunk_count == 0 || archetype->chunks[archetype->chunk_count - 1].count == archetype->chunk_capacity) {
+        grow((void**)&archetype->chunks, &archetype->chunk_slots, archetype->chunk_count + 1, sizeof(ecs_chunk));
+        ecs_chunk* chunk = &archetype->chunks[archetype->chunk_count++];
+        chunk->data = kallocate_aligned(archetype->chunk_size, ECS_CHUNK_ALIGNMENT, MEMORY_TAG_ENTITY);
+        chunk->count = 0;
+    }
+
+    ecs_chunk* chunk = &archetype->chunks[archetype->chunk_count - 1];
+    u32 row = chunk->count++;
+    ((ecs_entity*)chunk->data)[row] = entity;
+    archetype->entity_count++;
+
+    *out_chunk = archetype->chunk_count - 1;
+    *out_row = row;
+}
+
+/** @brief Removes a row from an archetype, moving the archetype's last entity into it. */
+static void archetype_remove_row(ecs_world* world, u32 archetype_index, u32 chunk_index, u32 row) {
+    ecs_archetype* archetype = &world->archetypes[archetype_index];
+    ecs_chunk* chunk = &archetype->chunks[chunk_index];
+    ecs_chunk* last = &archetype->chunks[archetype->chunk_count - 1];
+    u32 last_row = last->count - 1;
+
+    if (chunk != last || row != last_row) {
+        ecs_entity moved = ((ecs_entity*)last->data)[last_row];
+        ((ecs_entity*)chunk->data)[row] = moved;
+        for (u32 c = 0; c < world->component_count; ++c) {
+            if (archetype->mask & ECS_COMPONENT_BIT(c)) {
+                u32 size = world->component_sizes[c];
+                kcopy_memory(chunk->data + archetype->offsets[c] + row * size, last->data + archetype->offsets[c] + last_row * size, size);
+            }
+        }
+        ecs_entity_record* record = &world->records[entity_index(moved)];
+        record->chunk = chunk_index;
+        record->row = row;
+    }
+
+    last->count--;
+    archetype->entity_count--;
+    if (last->count == 0) {
+        kfree_aligned(last->data, archetype->chunk_size, ECS_CHUNK_ALIGNMENT, MEMORY_TAG_ENTITY);
+        last->data = 0;
+        archetype->chunk_count--;
+    }
+}
+
+/** @brief Moves an entity to another archetype, keeping the components both share and zeroing the rest. */
+static void entity_move(ecs_world* world, ecs_entity_record* record, ecs_entity entity, u32 to) {
+    ecs_archetype* source = &world->archetypes[record->archetype];
+    ecs_archetype* dest = &world->archetypes[to];
+
+    u32 chunk_index;
+    u32 row;
+    archetype_push(dest, entity, &chunk_index, &row);
+    u8* source_data = source->chunks[record->chunk].data;
+    u8* dest_data = dest->chunks[chunk_index].data;
+    for (u32 c = 0; c < world->component_count; ++c) {
+        ecs_component_mask bit = ECS_COMPONENT_BIT(c);
+        if (!(dest->mask & bit)) {
+            continue;
+        }
+        u32 size = world->component_sizes[c];
+        u8* target = dest_data + dest->offsets[c] + row * size;
+        if (source->mask & bit) {
+            kcopy_memory(target, source_data + source->offsets[c] + record->row * size, size);
+        } else {
+            kzero_memory(target, size);
+        }
+    }
+
+    archetype_remove_row(world, record->archetype, record->chunk, record->row);
+    record->archetype = to;
+    record->chunk = chunk_index;
+    record->row = row;
+}
+
+static void run_items(ecs_world* world, const ecs_work_item* items, u32 item_count, f32 delta_time) {
+    for (u32 i = 0; i < item_count; ++i) {
+        const ecs_system* system = &world->systems[items[i].system];
+        const ecs_archetype* archetype = &world->archetypes[items[i].archetype];
+        const ecs_chunk* chunk = &archetype->chunks[items[i].chunk];
+
+        ecs_view view;
+        view.world = world;
+        view.archetype = archetype;
+        view.count = chunk->count;
+        view.entities = (const ecs_entity*)chunk->data;
+        view.data = chunk->data;
+        system->config.run(&view, delta_time, system->config.user_data);
+    }
+}
+
+static b8 run_items_job(void* param_data) {
+    ecs_job_params* params = param_data;
+    run_items(params->world, params->items, params->item_count, params->delta_time);
+    return True;
+}
+
+b8 ecs_world_create(ecs_world* out_world) {
+    if (!out_world) {
+        KERROR("ecs_world_create requires a valid pointer to hold the world.");
+        return False;
+    }
+    kzero_memory(out_world, sizeof(ecs_world));
+
+    // Entities without components live in archetype 0.
+    archetype_find_or_create(out_world, 0);
+    return True;
+}
+
+void ecs_world_destroy(ecs_world* world) {
+    if (!world) {
+        return;
+    }
+    for (u32 i = 0; i < world->archetype_count; ++i) {
+        ecs_archetype* archetype = &world->archetypes[i];
+        for (u32 c = 0; c < archetype->chunk_count; ++c) {
+            kfree_aligned(archetype->chunks[c].data, archetype->chunk_size, ECS_CHUNK_ALIGNMENT, MEMORY_TAG_ENTITY);
+        }
+        if (archetype->chunks) {
+            kfree(archetype->chunks, sizeof(ecs_chunk) * archetype->chunk_slots, MEMORY_TAG_ENTITY);
+        }
+    }
+    if (world->archetypes) {
+        kfree(world->archetypes, sizeof(ecs_archetype) * world->archetype_slots, MEMORY_TAG_ENTITY);
+    }
+    if (world->records) {
+        kfree(world->records, sizeof(ecs_entity_record) * world->record_slots, MEMORY_TAG_ENTITY);
+        kfree(world->free_indices, sizeof(u32) * world->record_slots, MEMORY_TAG_ENTITY);
+    }
+    if (world->work_items) {
+        kfree(world->work_items, sizeof(ecs_work_item) * world->work_item_slots, MEMORY_TAG_ENTITY);
+    }
+    kzero_memory(world, sizeof(ecs_world));
+}
+
+u32 ecs_component_register(ecs_world* world, u32 size) {
+    if (world->component_count == ECS_MAX_COMPONENTS) {
+        KERROR("ecs_component_register - Cannot register more than %u components.", ECS_MAX_COMPONENTS);
+        return INVALID_ID;
+    }
+    if (size == 0) {
+        KERROR("ecs_component_register - Components must have a size.");
+        return INVALID_ID;
+    }
+    world->component_sizes[world->component_count] = size;
+    return world->component_count++;
+}
+
+ecs_entity ecs_entity_create(ecs_world* world, ecs_component_mask components) {
+    if (components & ~registered_mask(world)) {
+        KERROR("ecs_entity_create - Cannot create an entity with unregistered components.");
+        return ECS_ENTITY_NULL;
+    }
+
+    u32 archetype_index = archetype_find_or_create(world, components);
+
+    u32 index;
+    if (world->free_count > 0) {
+        index = world->free_indices[--world->free_count];
+    } else {
+        u32 slots = world->record_slots;
+        grow((void**)&world->records, &world->record_slots, world->record_count + 1, sizeof(ecs_entity_record));
+        grow((void**)&world->free_indices, &slots, world->record_slots, sizeof(u32));
+        index = world->record_count++;
+        world->records[index].generation = 1;
+    }
+
+    ecs_entity_record* record = &world->records[index];
+    ecs_entity entity = ((u64)record->generation << 32) | index;
+
+    ecs_archetype* archetype = &world->archetypes[archetype_index];
+    archetype_push(archetype, entity, &record->chunk, &record->row);
+    record->archetype = archetype_index;
+
+    u8* data = archetype->chunks[record->chunk].data;
+    for (u32 c = 0; c < world->component_count; ++c) {
+        if (components & ECS_COMPONENT_BIT(c)) {
+            u32 size = world->component_sizes[c];
+            kzero_memory(data + archetype->offsets[c] + record->row * size, size);
+        }
+    }
+
+    world->entity_count++;
+    return entity;
+}
+
+void ecs_entity_destroy(ecs_world* world, ecs_entity entity) {
+    ecs_entity_record* record = resolve(world, entity);
+    if (!record) {
+        return;
+    }
+
+    archetype_remove_row(world, record->archetype, record->chunk, record->row);
+    record->archetype = INVALID_ID;
+
+    // Stale handles stop matching. Generation 0 is skipped so that no handle is ever ECS_ENTITY_NULL.
+    record->generation++;
+    if (record->generation == 0) {
+        record->generation = 1;
+    }
+    world->free_indices[world->free_count++] = entity_index(entity);
+    world->entity_count--;
+}
+
+b8 ecs_entity_is_alive(const ecs_world* world, ecs_entity entity) {
+    return resolve(world, entity) != 0;
+}
+
+b8 ecs_entity_add(ecs_world* world, ecs_entity entity, u32 component) {
+    ecs_entity_record* record = resolve(world, entity);
+    if (!record || component >= world->component_count) {
+        return False;
+    }
+    if (world->archetypes[record->archetype].mask & ECS_COMPONENT_BIT(component)) {
+        return True;
+    }
+    u32 to = archetype_neighbour(world, record->archetype, component, True);
+    entity_move(world, record, entity, to);
+    return True;
+}
+
+b8 ecs_entity_remove(ecs_world* world, ecs_entity entity, u32 component) {
+    ecs_entity_record* record = resolve(world, entity);
+    if (!record || component >= world->component_count) {
+        return False;
+    }
+    if (!(world->archetypes[record->archetype].mask & ECS_COMPONENT_BIT(component))) {
+        return True;
+    }
+    u32 to = archetype_neighbour(world, record->archetype, component, False);
+    entity_move(world, record, entity, to);
+    return True;
+}
+
+b8 ecs_entity_has(const ecs_world* world, ecs_entity entity, u32 component) {
+    ecs_entity_record* record = resolve(world, entity);
+    if (!record || component >= world->component_count) {
+        return False;
+    }
+    return (world->archetypes[record->archetype].mask & ECS_COMPONENT_BIT(component)) != 0;
+}
+
+void* ecs_entity_get(const ecs_world* world, ecs_entity entity, u32 component) {
+    if (!ecs_entity_has(world, entity, component)) {
+        return 0;
+    }
+    ecs_entity_record* record = resolve(world, entity);
+    const ecs_archetype* archetype = &world->archetypes[record->archetype];
+    return archetype->chunks[record->chunk].data + archetype->offsets[component] + record->row * world->component_sizes[component];
+}
+
+ecs_query_iter ecs_query_begin(ecs_query query) {
+    ecs_query_iter iter;
+    kzero_memory(&iter, sizeof(ecs_query_iter));
+    iter.query = query;
+    return iter;
+}
+
+b8 ecs_query_next(ecs_world* world, ecs_query_iter* iter) {
+    while (iter->archetype < world->archetype_count) {
+        const ecs_archetype* archetype = &world->archetypes[iter->archetype];
+        if (query_matches(iter->query, archetype->mask) && iter->chunk < archetype->chunk_count) {
+            const ecs_chunk* chunk = &archetype->chunks[iter->chunk++];
+            iter->view.world = world;
+            iter->view.archetype = archetype;
+            iter->view.count = chunk->count;
+            iter->view.entities = (const ecs_entity*)chunk->data;
+            iter->view.data = chunk->data;
+            return True;
+        }
+        iter->archetype++;
+        iter->chunk = 0;
+    }
+    return False;
+}
+
+u32 ecs_query_count(const ecs_world* world, ecs_query query) {
+    u32 count = 0;
+    for (u32 i = 0; i < world->archetype_count; ++i) {
+        if (query_matches(query, world->archetypes[i].mask)) {
+            count += world->archetypes[i].entity_count;
+        }
+    }
+    return count;
+}
+
+void* ecs_view_get(const ecs_view* view, u32 component) {
+    if (component >= ECS_MAX_COMPONENTS || !(view->archetype->mask & ECS_COMPONENT_BIT(component))) {
+        return 0;
+    }
+    return view->data + view->archetype->offsets[component];
+}
+
+u32 ecs_system_register(ecs_world* world, const ecs_system_config* config) {
+    if (!config || !config->run) {
+        KERROR("ecs_system_register requires a configuration with a function to run.");
+        return INVALID_ID;
+    }
+    if (world->system_count == ECS_MAX_SYSTEMS) {
+        KERROR("ecs_system_register - Cannot register more than %u systems.", ECS_MAX_SYSTEMS);
+        return INVALID_ID;
+    }
+
+    // Run after every earlier system that writes what this one touches, or touches what it writes.
+    ecs_component_mask touched = config->read | config->write;
+    u32 phase = 0;
+    for (u32 i = 0; i < world->system_count; ++i) {
+        const ecs_system_config* other = &world->systems[i].config;
+        b8 conflicts = (config->write & (other->read | other->write)) || (other->write & touched);
+        if (conflicts && world->systems[i].phase + 1 > phase) {
+            phase = world->systems[i].phase + 1;
+        }
+    }
+
+    ecs_system* system = &world->systems[world->system_count];
+    system->config = *config;
+    system->phase = phase;
+    if (phase + 1 > world->phase_count) {
+        world->phase_count = phase + 1;
+    }
+    KDEBUG("ecs_system_register - System '%s' runs in phase %u.", config->name ? config->name : "unnamed", phase);
+    return world->system_count++;
+}
+
+void ecs_world_run_systems(ecs_world* world, f32 delta_time) {
+    u32 worker_count = job_system_worker_count();
+
+    for (u32 phase = 0; phase < world->phase_count; ++phase) {
+        // Gather every chunk each system of the phase runs over.
+        u32 item_count = 0;
+        for (u32 s = 0; s < world->system_count; ++s) {
+            if (world->systems[s].phase != phase) {
+                continue;
+            }
+            for (u32 a = 0; a < world->archetype_count; ++a) {
+                const ecs_archetype* archetype = &world->archetypes[a];
+                if (!query_matches(world->systems[s].config.query, archetype->mask)) {
+                    continue;
+                }
+                grow((void**)&world->work_items, &world->work_item_slots, item_count + archetype->chunk_count, sizeof(ecs_work_item));
+                for (u32 c = 0; c < archetype->chunk_count; ++c) {
+                    ecs_work_item* item = &world->work_items[item_count++];
+                    item->system = s;
+                    item->archetype = a;
+                    item->chunk = c;
+                }
+            }
+        }
+
+        if (item_count == 0) {
+            continue;
+        }
+        if (worker_count == 0 || item_count <= ECS_JOB_CHUNK_COUNT) {
+            run_items(world, world->work_items, item_count, delta_time);
+            continue;
+        }
+
+        // Split the phase evenly over a few jobs per worker, without making jobs too small to be worth it.
+        u32 job_target = worker_count * ECS_JOBS_PER_WORKER;
+        u32 per_job = (item_count + job_target - 1) / job_target;
+        if (per_job < ECS_JOB_CHUNK_COUNT) {
+            per_job = ECS_JOB_CHUNK_COUNT;
+        }
+
+        job_counter counter = {0};
+        for (u32 start = 0; start < item_count; start += per_job) {
+            ecs_job_params params;
+            params.world = world;
+            params.items = world->work_items + start;
+            params.item_count = item_count - start < per_job ? item_count - start : per_job;
+            params.delta_time = delta_time;
+            job_info job = job_create_priority(run_items_job, &params, sizeof(ecs_job_params), JOB_PRIORITY_HIGH);
+            job.counter = &counter;
+            job_system_submit(job);
+        }
+        job_counter_wait(&counter);
+    }
+}
@@ -0,0 +1,405 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * @file ecs.h
+ * @brief An archetype-based entity component system.
+ *
+ * An entity is a handle to a set of components. Components are plain data of a fixed size,
+ * registered with the world before use. Every entity with the same set of components belongs to
+ * the same archetype, which stores them in chunks of ECS_CHUNK_SIZE bytes:
+ * - Each chunk holds one array per component, plus the handle of each entity, all in the same
+ *   order. Row i of every array belongs to the same entity.
+ * - Chunks are kept full except for the last one of each archetype: destroying an entity, or
+ *   moving it to another archetype, moves the last entity of the archetype into its row.
+ *
+ * Queries find the archetypes with a given set of components and walk their chunks in order, so
+ * the data a system touches is read linearly, one component array at a time.
+ *
+ * Systems are functions run over every chunk that matches their query, declaring which
+ * components they read and write. Systems are grouped into phases in the order they are
+ * registered: a system joins the phase after the last earlier system it conflicts with, that is
+ * one writing a component the other reads or writes. The chunks of every system in a phase are
+ * split into jobs and run in parallel on the job system.
+ *
+ * Usage:
+ * - Create a world with `ecs_world_create()`, and register components with `ecs_component_register()`.
+ * - Create entities with `ecs_entity_create()`, and change their components with `ecs_entity_add()`
+ *   and `ecs_entity_remove()`.
+ * - Iterate matching chunks with `ecs_query_begin()` and `ecs_query_next()`, or register systems
+ *   with `ecs_system_register()` and run them each frame with `ecs_world_run_systems()`.
+ * - Destroy the world with `ecs_world_destroy()`.
+ *
+ * NOTE: Not thread-safe. Entities must not be created, destroyed or change components while a
+ * query is iterating or systems are running, as this moves entities between rows and chunks.
+ */
+
+/** @brief The maximum number of component types a world can register. */
+#define ECS_MAX_COMPONENTS 64
+
+/** @brief The maximum number of systems a world can register. */
+#define ECS_MAX_SYSTEMS 64
+
+/** @brief The size of a chunk of component storage, in bytes. */
+#define ECS_CHUNK_SIZE (16 * 1024)
+
+/**
+ * @brief A handle to an entity. The index of the entity is in the low 32 bits, and the
+ * generation of that index in the high 32 bits. A handle outlives its entity: once the entity
+ * is destroyed, its index is reused with a new generation, and the old handle stops matching.
+ */
+typedef u64 ecs_entity;
+
+/** @brief A handle that never refers to an entity. */
+#define ECS_ENTITY_NULL 0
+
+/** @brief A set of component ids, with bit i set when component i is in the set. */
+typedef u64 ecs_component_mask;
+
+/** @brief The mask holding only the given component id. */
+#define ECS_COMPONENT_BIT(component) (1ull << (component))
+
+/**
+ * @struct ecs_chunk
+ * @brief A block of storage for the entities of an archetype.
+ */
+typedef struct ecs_chunk {
+    /** @brief The handles of the entities, followed by one array per component. */
+    u8* data;
+    /** @brief The number of entities in the chunk. */
+    u32 count;
+} ecs_chunk;
+
+/**
+ * @struct ecs_archetype
+ * @brief The storage of every entity with a given set of components.
+ */
+typedef struct ecs_archetype {
+    /** @brief The components of the entities. */
+    ecs_component_mask mask;
+    /** @brief The number of entities each chunk holds. */
+    u32 chunk_capacity;
+    /** @brief The size of each chunk, in bytes. ECS_CHUNK_SIZE unless a single entity needs more. */
+    u32 chunk_size;
+    /** @brief The number of entities in the archetype. */
+    u32 entity_count;
+    /** @brief The offset of each component's array within a chunk. Only valid for components in the mask. */
+    u32 offsets[ECS_MAX_COMPONENTS];
+    /** @brief The archetype reached by adding each component, or INVALID_ID if not yet known. */
+    u32 add_edges[ECS_MAX_COMPONENTS];
+    /** @brief The archetype reached by removing each component, or INVALID_ID if not yet known. */
+    u32 remove_edges[ECS_MAX_COMPONENTS];
+    /** @brief The chunks, all full except the last one. */
+    ecs_chunk* chunks;
+    /** @brief The number of chunks in use. */
+    u32 chunk_count;
+    /** @brief The number of chunks there is room for in chunks. */
+    u32 chunk_slots;
+} ecs_archetype;
+
+/**
+ * @struct ecs_entity_record
+ * @brief Where an entity's components are stored.
+ */
+typedef struct ecs_entity_record {
+    /** @brief The index of the entity's archetype, or INVALID_ID if the index is free. */
+    u32 archetype;
+    /** @brief The index of the chunk within the archetype. */
+    u32 chunk;
+    /** @brief The row within the chunk. */
+    u32 row;
+    /** @brief The current generation of the index. */
+    u32 generation;
+} ecs_entity_record;
+
+/**
+ * @struct ecs_query
+ * @brief Describes the entities a query matches.
+ */
+typedef struct ecs_query {
+    /** @brief The components an entity must have. */
+    ecs_component_mask all;
+    /** @brief The components an entity must not have. */
+    ecs_component_mask none;
+} ecs_query;
+
+/**
+ * @struct ecs_view
+ * @brief The entities of one chunk matched by a query or system.
+ */
+typedef struct ecs_view {
+    /** @brief The world the chunk belongs to. */
+    struct ecs_world* world;
+    /** @brief The archetype the chunk belongs to. */
+    const ecs_archetype* archetype;
+    /** @brief The number of entities in the chunk. */
+    u32 count;
+    /** @brief The handles of the entities in the chunk. */
+    const ecs_entity* entities;
+    /** @brief The storage of the chunk. */
+    u8* data;
+} ecs_view;
+
+/**
+ * @brief A function run by a system over every chunk matching its query.
+ *
+ * Runs on a worker thread, at the same time as the other systems of its phase. It may only
+ * access the components the system declared, and may not create, destroy or change the
+ * components of entities.
+ *
+ * @param view The entities of the chunk.
+ * @param delta_time The time in seconds since the last frame.
+ * @param user_data The user data given when the system was registered.
+ */
+typedef void (*pfn_ecs_system)(const ecs_view* view, f32 delta_time, void* user_data);
+
+/**
+ * @struct ecs_system_config
+ * @brief Describes a system to register.
+ */
+typedef struct ecs_system_config {
+    /** @brief The name of the system, for logging. */
+    const char* name;
+    /** @brief The entities the system runs over. */
+    ecs_query query;
+    /** @brief The components the system reads but does not write. */
+    ecs_component_mask read;
+    /** @brief The components the system writes. */
+    ecs_component_mask write;
+    /** @brief The function run over each matching chunk. */
+    pfn_ecs_system run;
+    /** @brief Passed to run. */
+    void* user_data;
+} ecs_system_config;
+
+/**
+ * @struct ecs_system
+ * @brief A registered system.
+ */
+typedef struct ecs_system {
+    /** @brief The configuration given at registration. */
+    ecs_system_config config;
+    /** @brief The phase the system runs in. Phases run in order, starting at 0. */
+    u32 phase;
+} ecs_system;
+
+/** @brief The chunk of one system a job of `ecs_world_run_systems()` runs. */
+typedef struct ecs_work_item {
+    /** @brief The index of the system. */
+    u32 system;
+    /** @brief The index of the archetype. */
+    u32 archetype;
+    /** @brief The index of the chunk within the archetype. */
+    u32 chunk;
+} ecs_work_item;
+
+/**
+ * @struct ecs_world
+ * @brief A collection of entities, their components and the systems that run over them.
+ * Members should not be modified outside the functions associated with it.
+ */
+typedef struct ecs_world {
+    /** @brief The number of registered components. */
+    u32 component_count;
+    /** @brief The size of each registered component, in bytes. */
+    u32 component_sizes[ECS_MAX_COMPONENTS];
+
+    /** @brief The archetypes. Archetype 0 has no components. */
+    ecs_archetype* archetypes;
+    /** @brief The number of archetypes. */
+    u32 archetype_count;
+    /** @brief The number of archetypes there is room for. */
+    u32 archetype_slots;
+
+    /** @brief The record of each entity index. */
+    ecs_entity_record* records;
+    /** @brief The number of entity indices handed out. */
+    u32 record_count;
+    /** @brief The number of records there is room for. */
+    u32 record_slots;
+    /** @brief Entity indices of destroyed entities, reused before new ones. */
+    u32* free_indices;
+    /** @brief The number of indices in free_indices. */
+    u32 free_count;
+    /** @brief The number of live entities. */
+    u32 entity_count;
+
+    /** @brief The registered systems, in the order they were registered. */
+    ecs_system systems[ECS_MAX_SYSTEMS];
+    /** @brief The number of registered systems. */
+    u32 system_count;
+    /** @brief The number of phases the systems are grouped into. */
+    u32 phase_count;
+
+    /** @brief The chunks to run for the current phase of `ecs_world_run_systems()`. */
+    ecs_work_item* work_items;
+    /** @brief The number of work items there is room for. */
+    u32 work_item_slots;
+} ecs_world;
+
+/**
+ * @struct ecs_query_iter
+ * @brief The state of an iteration over the chunks matched by a query.
+ */
+typedef struct ecs_query_iter {
+    /** @brief The query. */
+    ecs_query query;
+    /** @brief The archetype being iterated. */
+    u32 archetype;
+    /** @brief The next chunk of the archetype. */
+    u32 chunk;
+    /** @brief The current chunk. Valid after `ecs_query_next()` returns True. */
+    ecs_view view;
+} ecs_query_iter;
+
+/**
+ * @brief Creates an empty world.
+ *
+ * @param out_world A pointer to hold the world.
+ * @return True on success; otherwise False.
+ */
+KAPI b8 ecs_world_create(ecs_world* out_world);
+
+/**
+ * @brief Destroys a world, freeing every entity and its storage.
+ *
+ * @param world A pointer to the world.
+ */
+KAPI void ecs_world_destroy(ecs_world* world);
+
+/**
+ * @brief Registers a type of component.
+ *
+ * Components are copied bytewise when entities move between chunks, and zeroed when added.
+ * Each component's array in a chunk is 16-byte aligned, so components whose size is a multiple
+ * of 16 (e.g. vec4 and mat4) are aligned for SIMD.
+ *
+ * @param world A pointer to the world.
+ * @param size The size of the component, in bytes.
+ * @return The id of the component, or INVALID_ID if no more components can be registered.
+ */
+KAPI u32 ecs_component_register(ecs_world* world, u32 size);
+
+/**
+ * @brief Creates an entity with the given components, all zeroed.
+ *
+ * @param world A pointer to the world.
+ * @param components The components of the entity.
+ * @return A handle to the entity, or ECS_ENTITY_NULL if a component is not registered.
+ */
+KAPI ecs_entity ecs_entity_create(ecs_world* world, ecs_component_mask components);
+
+/**
+ * @brief Destroys an entity. Does nothing if the handle no longer refers to an entity.
+ *
+ * @param world A pointer to the world.
+ * @param entity A handle to the entity.
+ */
+KAPI void ecs_entity_destroy(ecs_world* world, ecs_entity entity);
+
+/**
+ * @brief Indicates whether a handle still refers to an entity.
+ *
+ * @param world A pointer to the world.
+ * @param entity A handle to the entity.
+ * @return True if the entity exists; otherwise False.
+ */
+KAPI b8 ecs_entity_is_alive(const ecs_world* world, ecs_entity entity);
+
+/**
+ * @brief Adds a zeroed component to an entity, moving it to the archetype with that component.
+ * Does nothing if the entity already has the component.
+ *
+ * @param world A pointer to the world.
+ * @param entity A handle to the entity.
+ * @param component The id of the component.
+ * @return True on success; False if the entity does not exist or the component is not registered.
+ */
+KAPI b8 ecs_entity_add(ecs_world* world, ecs_entity entity, u32 component);
+
+/**
+ * @brief Removes a component from an entity, moving it to the archetype without that component.
+ * Does nothing if the entity does not have the component.
+ *
+ * @param world A pointer to the world.
+ * @param entity A handle to the entity.
+ * @param component The id of the component.
+ * @return True on success; False if the entity does not exist or the component is not registered.
+ */
+KAPI b8 ecs_entity_remove(ecs_world* world, ecs_entity entity, u32 component);
+
+/**
+ * @brief Indicates whether an entity has a component.
+ *
+ * @param world A pointer to the world.
+ * @param entity A handle to the entity.
+ * @param component The id of the component.
+ * @return True if the entity exists and has the component; otherwise False.
+ */
+KAPI b8 ecs_entity_has(const ecs_world* world, ecs_entity entity, u32 component);
+
+/**
+ * @brief Gets a component of an entity. The pointer is valid until entities are next created,
+ * destroyed or change components.
+ *
+ * @param world A pointer to the world.
+ * @param entity A handle to the entity.
+ * @param component The id of the component.
+ * @return A pointer to the component, or 0 if the entity does not exist or does not have it.
+ */
+KAPI void* ecs_entity_get(const ecs_world* world, ecs_entity entity, u32 component);
+
+/**
+ * @brief Starts iterating over the chunks matched by a query. Call `ecs_query_next()` to reach
+ * the first chunk.
+ *
+ * @param query The query.
+ * @return The state of the iteration.
+ */
+KAPI ecs_query_iter ecs_query_begin(ecs_query query);
+
+/**
+ * @brief Moves to the next non-empty chunk matched by a query.
+ *
+ * @param world A pointer to the world.
+ * @param iter A pointer to the state of the iteration. Its view holds the chunk.
+ * @return True if there is another chunk; False once every chunk has been visited.
+ */
+KAPI b8 ecs_query_next(ecs_world* world, ecs_query_iter* iter);
+
+/**
+ * @brief Counts the entities matched by a query.
+ *
+ * @param world A pointer to the world.
+ * @param query The query.
+ * @return The number of entities.
+ */
+KAPI u32 ecs_query_count(const ecs_world* world, ecs_query query);
+
+/**
+ * @brief Gets the array of a component in a chunk, with one entry per entity of the view.
+ *
+ * @param view A pointer to the view.
+ * @param component The id of the component.
+ * @return A pointer to the array, or 0 if the chunk's archetype does not have the component.
+ */
+KAPI void* ecs_view_get(const ecs_view* view, u32 component);
+
+/**
+ * @brief Registers a system, placing it in the phase after the last system it conflicts with.
+ *
+ * @param world A pointer to the world.
+ * @param config The system to register.
+ * @return The index of the system, or INVALID_ID if no more systems can be registered.
+ */
+KAPI u32 ecs_system_register(ecs_world* world, const ecs_system_config* config);
+
+/**
+ * @brief Runs every system over its matching chunks, phase by phase. The chunks of a phase are
+ * spread over the job system, and each phase waits for the one before it to finish.
+ *
+ * @param world A pointer to the world.
+ * @param delta_time The time in seconds since the last frame, passed to each system.
+ */
+KAPI void ecs_world_run_systems(ecs_world* world, f32 delta_time);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/application.h"
+#include "ecs/ecs.h"
 
 /**
  * @file game_types.h
@@ -56,6 +57,14 @@ typedef struct game {
      */
     void (*on_resize)(struct game* game_inst, u32 width, u32 height);
 
+    /**
+     * @brief The entities of the game.
+     *
+     * Created by the engine before initialize() is called. Systems registered with it run
+     * every frame, right after update().
+     */
+    ecs_world* world;
+
     /**
      * @brief Pointer to game-specific state data.
      *
@@ -2,6 +2,7 @@
 
 #include "core/kmemory.h"
 #include "defines.h"
+#include "ksimd.h"
 #include "math_types.h"
 
 /**
@@ -14,6 +15,9 @@
  * - Basic trigonometric functions
  * - Random number generation
  * - Utility functions for game math
+ *
+ * The hot vec4, mat4 and quaternion operations use SIMD where the target has it (see ksimd.h).
+ * Their scalar versions, suffixed with _scalar, are always available to check them against.
  */
 
 // ----------|
@@ -685,6 +689,17 @@ KINLINE vec4 vec4_one() {
     return (vec4){1.0f, 1.0f, 1.0f, 1.0f};
 }
 
+/**
+ * @brief Scalar implementation of vec4_add().
+ */
+KINLINE vec4 vec4_add_scalar(vec4 vector_0, vec4 vector_1) {
+    vec4 result;
+    for (u64 i = 0; i < 4; ++i) {
+        result.elements[i] = vector_0.elements[i] + vector_1.elements[i];
+    }
+    return result;
+}
+
 /**
  * @brief Adds vector_1 to vector_0 and returns a copy of the result.
  *
@@ -693,9 +708,22 @@ KINLINE vec4 vec4_one() {
  * @return The resulting vector.
  */
 KINLINE vec4 vec4_add(vec4 vector_0, vec4 vector_1) {
+#if KSIMD_ENABLED
+    vec4 result;
+    f32x4_store(result.elements, f32x4_add(f32x4_load(vector_0.elements), f32x4_load(vector_1.elements)));
+    return result;
+#else
+    return vec4_add_scalar(vector_0, vector_1);
+#endif
+}
+
+/**
+ * @brief Scalar implementation of vec4_sub().
+ */
+KINLINE vec4 vec4_sub_scalar(vec4 vector_0, vec4 vector_1) {
     vec4 result;
     for (u64 i = 0; i < 4; ++i) {
-        result.elements[i] = vector_0.elements[i] + vector_1.elements[i];
+        result.elements[i] = vector_0.elements[i] - vector_1.elements[i];
     }
     return result;
 }
@@ -708,9 +736,22 @@ KINLINE vec4 vec4_add(vec4 vector_0, vec4 vector_1) {
  * @return The resulting vector.
  */
 KINLINE vec4 vec4_sub(vec4 vector_0, vec4 vector_1) {
+#if KSIMD_ENABLED
+    vec4 result;
+    f32x4_store(result.elements, f32x4_sub(f32x4_load(vector_0.elements), f32x4_load(vector_1.elements)));
+    return result;
+#else
+    return vec4_sub_scalar(vector_0, vector_1);
+#endif
+}
+
+/**
+ * @brief Scalar implementation of vec4_mul().
+ */
+KINLINE vec4 vec4_mul_scalar(vec4 vector_0, vec4 vector_1) {
     vec4 result;
     for (u64 i = 0; i < 4; ++i) {
-        result.elements[i] = vector_0.elements[i] - vector_1.elements[i];
+        result.elements[i] = vector_0.elements[i] * vector_1.elements[i];
     }
     return result;
 }
@@ -723,9 +764,22 @@ KINLINE vec4 vec4_sub(vec4 vector_0, vec4 vector_1) {
  * @return The resulting vector.
  */
 KINLINE vec4 vec4_mul(vec4 vector_0, vec4 vector_1) {
+#if KSIMD_ENABLED
+    vec4 result;
+    f32x4_store(result.elements, f32x4_mul(f32x4_load(vector_0.elements), f32x4_load(vector_1.elements)));
+    return result;
+#else
+    return vec4_mul_scalar(vector_0, vector_1);
+#endif
+}
+
+/**
+ * @brief Scalar implementation of vec4_div().
+ */
+KINLINE vec4 vec4_div_scalar(vec4 vector_0, vec4 vector_1) {
     vec4 result;
     for (u64 i = 0; i < 4; ++i) {
-        result.elements[i] = vector_0.elements[i] * vector_1.elements[i];
+        result.elements[i] = vector_0.elements[i] / vector_1.elements[i];
     }
     return result;
 }
@@ -738,11 +792,13 @@ KINLINE vec4 vec4_mul(vec4 vector_0, vec4 vector_1) {
  * @return The resulting vector.
  */
 KINLINE vec4 vec4_div(vec4 vector_0, vec4 vector_1) {
+#if KSIMD_ENABLED
     vec4 result;
-    for (u64 i = 0; i < 4; ++i) {
-        result.elements[i] = vector_0.elements[i] / vector_1.elements[i];
-    }
+    f32x4_store(result.elements, f32x4_div(f32x4_load(vector_0.elements), f32x4_load(vector_1.elements)));
     return result;
+#else
+    return vec4_div_scalar(vector_0, vector_1);
+#endif
 }
 
 /**
@@ -874,13 +930,9 @@ KINLINE mat4 mat4_identity() {
 }
 
 /**
- * @brief Returns the result of multiplying matrix_0 and matrix_1.
- * 
- * @param matrix_0 The first matrix to be multiplied.
- * @param matrix_1 The second matrix to be multiplied.
- * @return The result of the matrix multiplication.
+ * @brief Scalar implementation of mat4_mul().
  */
-KINLINE mat4 mat4_mul(mat4 matrix_0, mat4 matrix_1) {
+KINLINE mat4 mat4_mul_scalar(mat4 matrix_0, mat4 matrix_1) {
     mat4 out_matrix = mat4_identity();
 
     const f32* m1_ptr = matrix_0.data;
@@ -901,6 +953,57 @@ KINLINE mat4 mat4_mul(mat4 matrix_0, mat4 matrix_1) {
     return out_matrix;
 }
 
+/**
+ * @brief Returns the result of multiplying matrix_0 and matrix_1.
+ * 
+ * @param matrix_0 The first matrix to be multiplied.
+ * @param matrix_1 The second matrix to be multiplied.
+ * @return The result of the matrix multiplication.
+ */
+KINLINE mat4 mat4_mul(mat4 matrix_0, mat4 matrix_1) {
+#if defined(KSIMD_AVX)
+    // Two rows of the result at a time, one in each 128-bit half.
+    mat4 out_matrix;
+    __m256 b_0 = _mm256_broadcast_ps((const __m128*)(matrix_1.data + 0));
+    __m256 b_1 = _mm256_broadcast_ps((const __m128*)(matrix_1.data + 4));
+    __m256 b_2 = _mm256_broadcast_ps((const __m128*)(matrix_1.data + 8));
+    __m256 b_3 = _mm256_broadcast_ps((const __m128*)(matrix_1.data + 12));
+    for (i32 i = 0; i < 16; i += 8) {
+        __m256 a = _mm256_loadu_ps(matrix_0.data + i);
+        __m256 r = _mm256_mul_ps(_mm256_shuffle_ps(a, a, 0x00), b_0);
+#if defined(KSIMD_FMA)
+        r = _mm256_fmadd_ps(_mm256_shuffle_ps(a, a, 0x55), b_1, r);
+        r = _mm256_fmadd_ps(_mm256_shuffle_ps(a, a, 0xAA), b_2, r);
+        r = _mm256_fmadd_ps(_mm256_shuffle_ps(a, a, 0xFF), b_3, r);
+#else
+        r = _mm256_add_ps(_mm256_mul_ps(_mm256_shuffle_ps(a, a, 0x55), b_1), r);
+        r = _mm256_add_ps(_mm256_mul_ps(_mm256_shuffle_ps(a, a, 0xAA), b_2), r);
+        r = _mm256_add_ps(_mm256_mul_ps(_mm256_shuffle_ps(a, a, 0xFF), b_3), r);
+#endif
+        _mm256_storeu_ps(out_matrix.data + i, r);
+    }
+    return out_matrix;
+#elif KSIMD_ENABLED
+    // Each row of the result is a sum of the rows of matrix_1, weighted by a row of matrix_0.
+    mat4 out_matrix;
+    f32x4 b_0 = f32x4_load(matrix_1.data + 0);
+    f32x4 b_1 = f32x4_load(matrix_1.data + 4);
+    f32x4 b_2 = f32x4_load(matrix_1.data + 8);
+    f32x4 b_3 = f32x4_load(matrix_1.data + 12);
+    for (i32 i = 0; i < 16; i += 4) {
+        f32x4 a = f32x4_load(matrix_0.data + i);
+        f32x4 r = f32x4_mul(F32X4_SPLAT_LANE(a, 0), b_0);
+        r = f32x4_madd(F32X4_SPLAT_LANE(a, 1), b_1, r);
+        r = f32x4_madd(F32X4_SPLAT_LANE(a, 2), b_2, r);
+        r = f32x4_madd(F32X4_SPLAT_LANE(a, 3), b_3, r);
+        f32x4_store(out_matrix.data + i, r);
+    }
+    return out_matrix;
+#else
+    return mat4_mul_scalar(matrix_0, matrix_1);
+#endif
+}
+
 /**
  * @brief Creates and returns an orthographic projection matrix. Typically used to
  * render flat or 2D scenes.
@@ -1019,12 +1122,9 @@ KINLINE mat4 mat4_transposed(mat4 matrix) {
 }
 
 /**
- * @brief Creates and returns an inverse of the provided matrix.
- * 
- * @param matrix The matrix to be inverted.
- * @return A inverted copy of the provided matrix. 
+ * @brief Scalar implementation of mat4_inverse().
  */
-KINLINE mat4 mat4_inverse(mat4 matrix) {
+KINLINE mat4 mat4_inverse_scalar(mat4 matrix) {
     const f32* m = matrix.data;
 
     f32 t0 = m[10] * m[15];
@@ -1082,6 +1182,95 @@ KINLINE mat4 mat4_inverse(mat4 matrix) {
     return out_matrix;
 }
 
+/**
+ * @brief Creates and returns an inverse of the provided matrix.
+ * 
+ * @param matrix The matrix to be inverted.
+ * @return A inverted copy of the provided matrix. 
+ */
+KINLINE mat4 mat4_inverse(mat4 matrix) {
+#if KSIMD_ENABLED
+    // Inverts by 2x2 blocks, M = | A B |, each block held in one register as (m00, m01, m10, m11).
+    //                            | C D |
+    // The inverse is 1/|M| times the adjugates of X, Y, Z and W, where
+    // X = |D|A - B(D#C), Y = |B|C - D(A#B)#, Z = |C|B - A(D#C)#, W = |A|D - C(A#B),
+    // |M| = |A||D| + |B||C| - tr((A#B)(D#C)), and A# is the adjugate of A.
+    // As the inverse of the transpose is the transpose of the inverse, the rows here may as well be columns.
+    f32x4 r_0 = f32x4_load(matrix.data + 0);
+    f32x4 r_1 = f32x4_load(matrix.data + 4);
+    f32x4 r_2 = f32x4_load(matrix.data + 8);
+    f32x4 r_3 = f32x4_load(matrix.data + 12);
+
+    f32x4 a = F32X4_SHUFFLE(r_0, r_1, 0, 1, 0, 1);
+    f32x4 b = F32X4_SHUFFLE(r_0, r_1, 2, 3, 2, 3);
+    f32x4 c = F32X4_SHUFFLE(r_2, r_3, 0, 1, 0, 1);
+    f32x4 d = F32X4_SHUFFLE(r_2, r_3, 2, 3, 2, 3);
+
+    // The determinants of the blocks, as (|A|, |B|, |C|, |D|).
+    f32x4 det_sub = f32x4_sub(
+        f32x4_mul(F32X4_SHUFFLE(r_0, r_2, 0, 2, 0, 2), F32X4_SHUFFLE(r_1, r_3, 1, 3, 1, 3)),
+        f32x4_mul(F32X4_SHUFFLE(r_0, r_2, 1, 3, 1, 3), F32X4_SHUFFLE(r_1, r_3, 0, 2, 0, 2)));
+    f32x4 det_a = F32X4_SPLAT_LANE(det_sub, 0);
+    f32x4 det_b = F32X4_SPLAT_LANE(det_sub, 1);
+    f32x4 det_c = F32X4_SPLAT_LANE(det_sub, 2);
+    f32x4 det_d = F32X4_SPLAT_LANE(det_sub, 3);
+
+    // D#C and A#B.
+    f32x4 d_c = f32x4_sub(
+        f32x4_mul(F32X4_SWIZZLE(d, 3, 3, 0, 0), c),
+        f32x4_mul(F32X4_SWIZZLE(d, 1, 1, 2, 2), F32X4_SWIZZLE(c, 2, 3, 0, 1)));
+    f32x4 a_b = f32x4_sub(
+        f32x4_mul(F32X4_SWIZZLE(a, 3, 3, 0, 0), b),
+        f32x4_mul(F32X4_SWIZZLE(a, 1, 1, 2, 2), F32X4_SWIZZLE(b, 2, 3, 0, 1)));
+
+    // X = |D|A - B(D#C) and W = |A|D - C(A#B).
+    f32x4 x = f32x4_sub(
+        f32x4_mul(det_d, a),
+        f32x4_add(
+            f32x4_mul(b, F32X4_SWIZZLE(d_c, 0, 3, 0, 3)),
+            f32x4_mul(F32X4_SWIZZLE(b, 1, 0, 3, 2), F32X4_SWIZZLE(d_c, 2, 1, 2, 1))));
+    f32x4 w = f32x4_sub(
+        f32x4_mul(det_a, d),
+        f32x4_add(
+            f32x4_mul(c, F32X4_SWIZZLE(a_b, 0, 3, 0, 3)),
+            f32x4_mul(F32X4_SWIZZLE(c, 1, 0, 3, 2), F32X4_SWIZZLE(a_b, 2, 1, 2, 1))));
+
+    // Y = |B|C - D(A#B)# and Z = |C|B - A(D#C)#.
+    f32x4 y = f32x4_sub(
+        f32x4_mul(det_b, c),
+        f32x4_sub(
+            f32x4_mul(d, F32X4_SWIZZLE(a_b, 3, 0, 3, 0)),
+            f32x4_mul(F32X4_SWIZZLE(d, 1, 0, 3, 2), F32X4_SWIZZLE(a_b, 2, 1, 2, 1))));
+    f32x4 z = f32x4_sub(
+        f32x4_mul(det_c, b),
+        f32x4_sub(
+            f32x4_mul(a, F32X4_SWIZZLE(d_c, 3, 0, 3, 0)),
+            f32x4_mul(F32X4_SWIZZLE(a, 1, 0, 3, 2), F32X4_SWIZZLE(d_c, 2, 1, 2, 1))));
+
+    // |M| = |A||D| + |B||C| - tr((A#B)(D#C)).
+    f32x4 det_m = f32x4_add(f32x4_mul(det_a, det_d), f32x4_mul(det_b, det_c));
+    f32x4 trace = f32x4_sum(f32x4_mul(a_b, F32X4_SWIZZLE(d_c, 0, 2, 1, 3)));
+    det_m = f32x4_sub(det_m, trace);
+
+    // (1/|M|, -1/|M|, -1/|M|, 1/|M|) also negates the off-diagonal of each adjugate.
+    f32x4 inverse_det = f32x4_div(f32x4_set(1.0f, -1.0f, -1.0f, 1.0f), det_m);
+    x = f32x4_mul(x, inverse_det);
+    y = f32x4_mul(y, inverse_det);
+    z = f32x4_mul(z, inverse_det);
+    w = f32x4_mul(w, inverse_det);
+
+    // Swapping the diagonal completes the adjugates, and the blocks are transposed back into rows.
+    mat4 out_matrix;
+    f32x4_store(out_matrix.data + 0, F32X4_SHUFFLE(x, y, 3, 1, 3, 1));
+    f32x4_store(out_matrix.data + 4, F32X4_SHUFFLE(x, y, 2, 0, 2, 0));
+    f32x4_store(out_matrix.data + 8, F32X4_SHUFFLE(z, w, 3, 1, 3, 1));
+    f32x4_store(out_matrix.data + 12, F32X4_SHUFFLE(z, w, 2, 0, 2, 0));
+    return out_matrix;
+#else
+    return mat4_inverse_scalar(matrix);
+#endif
+}
+
 /**
  * @brief Creates a translation matrix from the given position vector.
  * 
@@ -1340,13 +1529,9 @@ KINLINE quat quat_inverse(quat q) {
 }
 
 /**
- * @brief Multiplies two quaternions together.
- * 
- * @param q_0 The first quaternion.
- * @param q_1 The second quaternion.
- * @return The product of the two quaternions.
+ * @brief Scalar implementation of quat_mul().
  */
-KINLINE quat quat_mul(quat q_0, quat q_1) {
+KINLINE quat quat_mul_scalar(quat q_0, quat q_1) {
     quat out_quaternion;
 
     out_quaternion.x = q_0.x * q_1.w +
@@ -1372,6 +1557,32 @@ KINLINE quat quat_mul(quat q_0, quat q_1) {
     return out_quaternion;
 }
 
+/**
+ * @brief Multiplies two quaternions together.
+ * 
+ * @param q_0 The first quaternion.
+ * @param q_1 The second quaternion.
+ * @return The product of the two quaternions.
+ */
+KINLINE quat quat_mul(quat q_0, quat q_1) {
+#if KSIMD_ENABLED
+    // Each component of q_0 scales q_1, reordered and with its signs flipped to match the scalar version.
+    f32x4 a = f32x4_load(q_0.elements);
+    f32x4 b = f32x4_load(q_1.elements);
+
+    f32x4 r = f32x4_mul(F32X4_SPLAT_LANE(a, 3), b);
+    r = f32x4_madd(F32X4_SPLAT_LANE(a, 0), f32x4_mul(F32X4_SWIZZLE(b, 3, 2, 1, 0), f32x4_set(1.0f, -1.0f, 1.0f, -1.0f)), r);
+    r = f32x4_madd(F32X4_SPLAT_LANE(a, 1), f32x4_mul(F32X4_SWIZZLE(b, 2, 3, 0, 1), f32x4_set(1.0f, 1.0f, -1.0f, -1.0f)), r);
+    r = f32x4_madd(F32X4_SPLAT_LANE(a, 2), f32x4_mul(F32X4_SWIZZLE(b, 1, 0, 3, 2), f32x4_set(-1.0f, 1.0f, 1.0f, -1.0f)), r);
+
+    quat out_quaternion;
+    f32x4_store(out_quaternion.elements, r);
+    return out_quaternion;
+#else
+    return quat_mul_scalar(q_0, q_1);
+#endif
+}
+
 /**
  * @brief Calculates the dot product of two quaternions.
  * 
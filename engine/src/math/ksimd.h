@@ -0,0 +1,253 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * @file ksimd.h
+ * @brief A thin layer over the 4-wide float SIMD instructions of the target.
+ *
+ * The instruction set is selected at compile time:
+ * - SSE2 on x86-64 (and 32-bit x86 built with SSE2), plus FMA and AVX when the compiler
+ *   is allowed to emit them (e.g. -mfma -mavx2).
+ * - NEON on ARM.
+ * - Otherwise, or when built with KSIMD_DISABLE, no SIMD at all. KSIMD_ENABLED is then 0 and
+ *   the math library uses its scalar implementations.
+ *
+ * Every operation works on an f32x4, which maps directly to a register of the target. Loads and
+ * stores expect 16-byte aligned memory, which vec4 and mat4 always are.
+ *
+ * NOTE: The shuffles on NEON use __builtin_shufflevector, so they need clang or GCC 12+.
+ */
+
+#if !defined(KSIMD_DISABLE) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+/** @brief Defined as 1 when SSE2 is used. */
+#define KSIMD_SSE 1
+#if defined(__FMA__)
+/** @brief Defined as 1 when fused multiply-add is used on x86. */
+#define KSIMD_FMA 1
+#endif
+#if defined(__AVX__)
+/** @brief Defined as 1 when 8-wide AVX is used where it helps (e.g. mat4 multiplication). */
+#define KSIMD_AVX 1
+#endif
+#include <immintrin.h>
+#elif !defined(KSIMD_DISABLE) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+/** @brief Defined as 1 when NEON is used. */
+#define KSIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(KSIMD_SSE) || defined(KSIMD_NEON)
+/** @brief 1 when a SIMD instruction set is in use, otherwise 0. */
+#define KSIMD_ENABLED 1
+#else
+/** @brief 1 when a SIMD instruction set is in use, otherwise 0. */
+#define KSIMD_ENABLED 0
+#endif
+
+#if KSIMD_ENABLED
+
+#if defined(KSIMD_SSE)
+/** @brief Four packed 32-bit floats. */
+typedef __m128 f32x4;
+
+/**
+ * @brief Builds a vector from lanes x and y of a and lanes z and w of b.
+ * Each lane index must be a constant from 0 to 3.
+ */
+#define F32X4_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps((a), (b), _MM_SHUFFLE((w), (z), (y), (x)))
+#else
+/** @brief Four packed 32-bit floats. */
+typedef float32x4_t f32x4;
+
+/**
+ * @brief Builds a vector from lanes x and y of a and lanes z and w of b.
+ * Each lane index must be a constant from 0 to 3.
+ */
+#define F32X4_SHUFFLE(a, b, x, y, z, w) __builtin_shufflevector((a), (b), (x), (y), (z) + 4, (w) + 4)
+#endif
+
+/** @brief Reorders the lanes of a vector. Each lane index must be a constant from 0 to 3. */
+#define F32X4_SWIZZLE(a, x, y, z, w) F32X4_SHUFFLE(a, a, x, y, z, w)
+
+/** @brief Fills every lane of a vector with one of its lanes. The lane must be a constant from 0 to 3. */
+#define F32X4_SPLAT_LANE(a, lane) F32X4_SWIZZLE(a, lane, lane, lane, lane)
+
+/** @brief Loads four floats from 16-byte aligned memory. */
+KINLINE f32x4 f32x4_load(const f32* block) {
+#if defined(KSIMD_SSE)
+    return _mm_load_ps(block);
+#else
+    return vld1q_f32(block);
+#endif
+}
+
+/** @brief Stores four floats to 16-byte aligned memory. */
+KINLINE void f32x4_store(f32* block, f32x4 v) {
+#if defined(KSIMD_SSE)
+    _mm_store_ps(block, v);
+#else
+    vst1q_f32(block, v);
+#endif
+}
+
+/** @brief Creates a vector from four values, x in the lowest lane. */
+KINLINE f32x4 f32x4_set(f32 x, f32 y, f32 z, f32 w) {
+#if defined(KSIMD_SSE)
+    return _mm_setr_ps(x, y, z, w);
+#else
+    f32x4 v = {x, y, z, w};
+    return v;
+#endif
+}
+
+/** @brief Creates a vector with every lane set to value. */
+KINLINE f32x4 f32x4_splat(f32 value) {
+#if defined(KSIMD_SSE)
+    return _mm_set1_ps(value);
+#else
+    return vdupq_n_f32(value);
+#endif
+}
+
+/** @brief Returns a + b. */
+KINLINE f32x4 f32x4_add(f32x4 a, f32x4 b) {
+#if defined(KSIMD_SSE)
+    return _mm_add_ps(a, b);
+#else
+    return vaddq_f32(a, b);
+#endif
+}
+
+/** @brief Returns a - b. */
+KINLINE f32x4 f32x4_sub(f32x4 a, f32x4 b) {
+#if defined(KSIMD_SSE)
+    return _mm_sub_ps(a, b);
+#else
+    return vsubq_f32(a, b);
+#endif
+}
+
+/** @brief Returns a * b. */
+KINLINE f32x4 f32x4_mul(f32x4 a, f32x4 b) {
+#if defined(KSIMD_SSE)
+    return _mm_mul_ps(a, b);
+#else
+    return vmulq_f32(a, b);
+#endif
+}
+
+/** @brief Returns a / b. */
+KINLINE f32x4 f32x4_div(f32x4 a, f32x4 b) {
+#if defined(KSIMD_SSE)
+    return _mm_div_ps(a, b);
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    return vdivq_f32(a, b);
+#else
+    // 32-bit NEON has no division. Refine the reciprocal estimate twice.
+    f32x4 reciprocal = vrecpeq_f32(b);
+    reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+    reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+    return vmulq_f32(a, reciprocal);
+#endif
+}
+
+/** @brief Returns the square root of each lane. */
+KINLINE f32x4 f32x4_sqrt(f32x4 v) {
+#if defined(KSIMD_SSE)
+    return _mm_sqrt_ps(v);
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    return vsqrtq_f32(v);
+#else
+    // 32-bit NEON has no square root. Refine the reciprocal square root estimate twice.
+    f32x4 estimate = vrsqrteq_f32(v);
+    estimate = vmulq_f32(vrsqrtsq_f32(vmulq_f32(v, estimate), estimate), estimate);
+    estimate = vmulq_f32(vrsqrtsq_f32(vmulq_f32(v, estimate), estimate), estimate);
+    return vmulq_f32(v, estimate);
+#endif
+}
+
+/** @brief Returns a * b + c, fused where the target supports it. */
+KINLINE f32x4 f32x4_madd(f32x4 a, f32x4 b, f32x4 c) {
+#if defined(KSIMD_FMA)
+    return _mm_fmadd_ps(a, b, c);
+#elif defined(KSIMD_SSE)
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    return vfmaq_f32(c, a, b);
+#else
+    return vmlaq_f32(c, a, b);
+#endif
+}
+
+/** @brief Returns a vector with the sum of the lanes of v in every lane. */
+KINLINE f32x4 f32x4_sum(f32x4 v) {
+    f32x4 sum = f32x4_add(v, F32X4_SWIZZLE(v, 1, 0, 3, 2));
+    return f32x4_add(sum, F32X4_SWIZZLE(sum, 2, 3, 0, 1));
+}
+
+/**
+ * @brief Transposes four vectors as the rows of a 4x4 matrix, so that each holds one lane of
+ * every input. Used to convert between one lane per object and one vector per object.
+ */
+KINLINE void f32x4_transpose(f32x4* r_0, f32x4* r_1, f32x4* r_2, f32x4* r_3) {
+    f32x4 t_0 = F32X4_SHUFFLE(*r_0, *r_1, 0, 1, 0, 1);
+    f32x4 t_1 = F32X4_SHUFFLE(*r_0, *r_1, 2, 3, 2, 3);
+    f32x4 t_2 = F32X4_SHUFFLE(*r_2, *r_3, 0, 1, 0, 1);
+    f32x4 t_3 = F32X4_SHUFFLE(*r_2, *r_3, 2, 3, 2, 3);
+    *r_0 = F32X4_SHUFFLE(t_0, t_2, 0, 2, 0, 2);
+    *r_1 = F32X4_SHUFFLE(t_0, t_2, 1, 3, 1, 3);
+    *r_2 = F32X4_SHUFFLE(t_1, t_3, 0, 2, 0, 2);
+    *r_3 = F32X4_SHUFFLE(t_1, t_3, 1, 3, 1, 3);
+}
+
+/** @brief Returns the smaller of a and b in each lane. */
+KINLINE f32x4 f32x4_min(f32x4 a, f32x4 b) {
+#if defined(KSIMD_SSE)
+    return _mm_min_ps(a, b);
+#else
+    return vminq_f32(a, b);
+#endif
+}
+
+/** @brief Returns the larger of a and b in each lane. */
+KINLINE f32x4 f32x4_max(f32x4 a, f32x4 b) {
+#if defined(KSIMD_SSE)
+    return _mm_max_ps(a, b);
+#else
+    return vmaxq_f32(a, b);
+#endif
+}
+
+/** @brief Returns the absolute value of each lane. */
+KINLINE f32x4 f32x4_abs(f32x4 v) {
+#if defined(KSIMD_SSE)
+    // Clear the sign bits.
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+#else
+    return vabsq_f32(v);
+#endif
+}
+
+/** @brief Returns a bit mask with bit i set when lane i of a is less than lane i of b. */
+KINLINE u32 f32x4_less_mask(f32x4 a, f32x4 b) {
+#if defined(KSIMD_SSE)
+    return (u32)_mm_movemask_ps(_mm_cmplt_ps(a, b));
+#else
+    static const u32 lane_bits[4] = {1, 2, 4, 8};
+    uint32x4_t bits = vandq_u32(vcltq_f32(a, b), vld1q_u32(lane_bits));
+    uint32x2_t pairs = vorr_u32(vget_low_u32(bits), vget_high_u32(bits));
+    return vget_lane_u32(vpadd_u32(pairs, pairs), 0);
+#endif
+}
+
+/** @brief Returns the lowest lane of v. */
+KINLINE f32 f32x4_first(f32x4 v) {
+#if defined(KSIMD_SSE)
+    return _mm_cvtss_f32(v);
+#else
+    return vgetq_lane_f32(v, 0);
+#endif
+}
+
+#endif
@@ -2,6 +2,8 @@
 
 #include "defines.h"
 
+#include <stdalign.h>
+
 /**
  * @file math_types.h
  * @brief Core mathematical types used throughout the Koru engine.
@@ -90,13 +92,8 @@ typedef struct vec3_u {
  * - SIMD operations when enabled
  */
 typedef union vec4_u {
-    // #if defined(KUSE_SIMD)
-    //     /** @brief SIMD register for optimized operations (16-byte aligned) */
-    //     alignas(16) __m128 data;
-    // #endif
-
-    //     /** @brief Array access for direct component manipulation (16-byte aligned) */
-    f32 elements[4];
+    /** @brief Array access for direct component manipulation (16-byte aligned, so it loads straight into a SIMD register) */
+    alignas(16) f32 elements[4];
 
     /** @brief Named component access */
     union {
@@ -156,10 +153,13 @@ typedef vec4 quat;
  * - Basis for camera/view/projection matrices
  */
 typedef union mat4_u {
-    /** @brief Flat array of 16 elements in column-major order */
-    f32 data[16];
+    /** @brief Flat array of 16 elements in column-major order (16-byte aligned, so each column loads straight into a SIMD register) */
+    alignas(16) f32 data[16];
 } mat4;
 
+STATIC_ASSERT(sizeof(vec4) == 16 && alignof(vec4) == 16, "Expected vec4 to be 16 bytes with 16-byte alignment.");
+STATIC_ASSERT(sizeof(mat4) == 64 && alignof(mat4) == 16, "Expected mat4 to be 64 bytes with 16-byte alignment.");
+
 /**
  * @brief A 3D vertex structure.
  *
@@ -175,4 +175,45 @@ typedef struct vertex_3d {
     vec3 position;  ///< Vertex position in 3D space
 
     vec2 texcoord;
-} vertex_3d;
\ No newline at end of file
+} vertex_3d;
+/**
+ * @brief An axis-aligned box, given by its lowest and highest corners.
+ *
+ * Why needed:
+ * - Cheap, conservative bounds for culling and spatial queries
+ * - Computed once from vertex data, then transformed with the object
+ */
+typedef struct extents_3d {
+    /** @brief The lowest corner of the box */
+    vec3 min;
+    /** @brief The highest corner of the box */
+    vec3 max;
+} extents_3d;
+
+/**
+ * @brief A view frustum, as six planes facing inward.
+ *
+ * Each plane is a vec4 holding its unit normal in xyz and its distance in w, so a point p
+ * is on the inner side when dot(normal, p) + w >= 0.
+ *
+ * Why needed:
+ * - Visibility tests of bounding volumes against the camera
+ * - Planes load straight into SIMD registers
+ */
+typedef struct frustum {
+    /** @brief The left, right, bottom, top, near and far planes, in that order */
+    vec4 planes[6];
+} frustum;
+
+/**
+ * @brief A ray, starting at an origin and extending along a direction.
+ *
+ * Why needed:
+ * - Picking, line of sight and other scene queries
+ */
+typedef struct ray {
+    /** @brief Where the ray starts */
+    vec3 origin;
+    /** @brief The direction of the ray. Distances along the ray are in multiples of its length */
+    vec3 direction;
+} ray;
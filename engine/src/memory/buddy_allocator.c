@@ -0,0 +1,164 @@
+#include "buddy_allocator.h"
+
+#include "core/kmemory.h"
+#include "core/logger.h"
+
+/**
+ * @file buddy_allocator.c
+ *
+ * @brief Implementation of the buddy allocator.
+ *
+ * The tree is stored breadth-first: node i has children 2i+1 and 2i+2, and the nodes at depth d
+ * start at index 2^d - 1. A node at depth d covers a block of total_size >> d bytes, and its value
+ * when entirely free is level_count - d.
+ *
+ * Allocating a node sets it to 0 without touching its descendants, which are all free at the
+ * time and keep their "entirely free" values. So when freeing, the allocated node is the first
+ * node with a value of 0 found walking up from the leaf at the freed offset.
+ */
+
+/** @brief The deepest tree supported, which keeps the bookkeeping to a sensible size. */
+#define BUDDY_MAX_LEVELS 24
+
+KINLINE b8 is_power_of_2(u64 value) { return value && (value & (value - 1)) == 0; }
+KINLINE u32 log2_u64(u64 value) { return 63 - __builtin_clzll(value); }
+
+KINLINE u64 next_power_of_2(u64 value) {
+    return value <= 1 ? 1 : 1ull << (64 - __builtin_clzll(value - 1));
+}
+
+b8 buddy_allocator_create(u64 total_size, u64 min_block_size, u64* memory_requirement, void* memory, buddy_allocator* out_allocator) {
+    if (!memory_requirement) {
+        KERROR("buddy_allocator_create requires a valid pointer to memory_requirement.");
+        return False;
+    }
+
+    if (!is_power_of_2(total_size) || !is_power_of_2(min_block_size) || min_block_size > total_size) {
+        KERROR("buddy_allocator_create - total_size (%llu) and min_block_size (%llu) must be powers of 2, with min_block_size no larger.", total_size, min_block_size);
+        return False;
+    }
+
+    u32 level_count = log2_u64(total_size / min_block_size) + 1;
+    if (level_count > BUDDY_MAX_LEVELS) {
+        KERROR("buddy_allocator_create - %llu blocks of %llu bytes is too many. Use a larger min_block_size.", total_size / min_block_size, min_block_size);
+        return False;
+    }
+
+    u64 node_count = (1ull << level_count) - 1;
+    *memory_requirement = node_count;
+
+    if (!memory) {
+        return True;
+    }
+
+    if (!out_allocator) {
+        KERROR("buddy_allocator_create requires a valid pointer to out_allocator.");
+        return False;
+    }
+
+    out_allocator->total_size = total_size;
+    out_allocator->min_block_size = min_block_size;
+    out_allocator->free_space = total_size;
+    out_allocator->level_count = level_count;
+    out_allocator->tree = memory;
+
+    // Everything starts free.
+    for (u32 depth = 0; depth < level_count; ++depth) {
+        u64 first = (1ull << depth) - 1;
+        kset_memory(out_allocator->tree + first, (i32)(level_count - depth), 1ull << depth);
+    }
+
+    return True;
+}
+
+void buddy_allocator_destroy(buddy_allocator* allocator) {
+    if (allocator) {
+        kzero_memory(allocator, sizeof(buddy_allocator));
+    }
+}
+
+b8 buddy_allocator_allocate(buddy_allocator* allocator, u64 size, u64 alignment, u64* out_offset) {
+    if (!allocator || !out_offset || !size) {
+        KERROR("buddy_allocator_allocate requires a valid allocator, out_offset and non-zero size.");
+        return False;
+    }
+
+    // Blocks are aligned to their own size, so a large enough block satisfies any alignment.
+    u64 block_size = KMAX(next_power_of_2(size), allocator->min_block_size);
+    block_size = KMAX(block_size, alignment);
+    if (block_size > allocator->total_size) {
+        return False;
+    }
+
+    u8 needed = (u8)(log2_u64(block_size / allocator->min_block_size) + 1);
+    if (allocator->tree[0] < needed) {
+        return False;
+    }
+
+    // Walk down to a node of exactly the needed size, preferring the left so allocations pack low.
+    u64 index = 0;
+    u32 depth = 0;
+    for (u8 value = (u8)allocator->level_count; value != needed; --value) {
+        u64 left = (index * 2) + 1;
+        index = allocator->tree[left] >= needed ? left : left + 1;
+        depth++;
+    }
+
+    allocator->tree[index] = 0;
+    *out_offset = (index - ((1ull << depth) - 1)) * block_size;
+
+    // Update the ancestors' largest free blocks.
+    while (index) {
+        index = (index - 1) / 2;
+        allocator->tree[index] = KMAX(allocator->tree[(index * 2) + 1], allocator->tree[(index * 2) + 2]);
+    }
+
+    allocator->free_space -= block_size;
+    return True;
+}
+
+u64 buddy_allocator_free(buddy_allocator* allocator, u64 offset) {
+    if (!allocator || offset >= allocator->total_size || (offset & (allocator->min_block_size - 1))) {
+        return 0;
+    }
+
+    // Start at the leaf for the offset and walk up to the allocated node.
+    u32 depth = allocator->level_count - 1;
+    u64 index = ((1ull << depth) - 1) + (offset / allocator->min_block_size);
+    u8 value = 1;
+    while (allocator->tree[index] != 0) {
+        if (index == 0) {
+            return 0;
+        }
+        index = (index - 1) / 2;
+        depth--;
+        value++;
+    }
+
+    u64 block_size = allocator->total_size >> depth;
+    if ((index - ((1ull << depth) - 1)) * block_size != offset) {
+        KERROR("buddy_allocator_free - Offset %llu is within, but not the start of, an allocated block.", offset);
+        return 0;
+    }
+
+    allocator->tree[index] = value;
+    allocator->free_space += block_size;
+
+    // Merge with buddies on the way up.
+    while (index) {
+        index = (index - 1) / 2;
+        u8 left = allocator->tree[(index * 2) + 1];
+        u8 right = allocator->tree[(index * 2) + 2];
+        allocator->tree[index] = (left == value && right == value) ? value + 1 : KMAX(left, right);
+        value++;
+    }
+
+    return block_size;
+}
+
+u64 buddy_allocator_largest_free_block(const buddy_allocator* allocator) {
+    if (!allocator || !allocator->tree || allocator->tree[0] == 0) {
+        return 0;
+    }
+    return allocator->min_block_size << (allocator->tree[0] - 1);
+}
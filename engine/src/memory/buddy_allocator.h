@@ -0,0 +1,88 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * @file buddy_allocator.h
+ *
+ * @brief Buddy allocator handing out offsets within a range the allocator never touches.
+ *
+ * The range is split into power-of-two blocks. A request is rounded up to the next power of two
+ * and served by halving a larger free block until it fits; freeing a block merges it with its
+ * "buddy" (the other half of its parent) whenever both are free. Every block is aligned to its
+ * own size, so alignments up to the block size come for free.
+ *
+ * Because the bookkeeping is kept apart from the managed range, the range does not need to be
+ * addressable by the CPU. It is used to sub-allocate GPU memory, where only offsets matter.
+ *
+ * The state is a complete binary tree with one node per possible block, each holding the order
+ * of the largest free block beneath it, so allocating and freeing are O(log n).
+ *
+ * Like the engine's systems, it is created in two passes: once to obtain the memory
+ * requirement, then again with a block of that size.
+ *
+ * NOTE: Not thread-safe. Callers sharing an allocator across threads must synchronize access.
+ */
+
+/**
+ * @struct buddy_allocator
+ *
+ * @brief Represents a buddy allocator. Members should not be modified outside the buddy_allocator_ functions.
+ */
+typedef struct buddy_allocator {
+    u64 total_size;      // Size of the managed range. Always a power of 2.
+    u64 min_block_size;  // Size of the smallest block. Always a power of 2.
+    u64 free_space;      // Bytes not covered by an allocated block.
+    u32 level_count;     // Number of block sizes, from total_size down to min_block_size.
+    u8* tree;            // Per node, 0 if nothing beneath it is free, else 1 + log2(largest free block / min_block_size).
+} buddy_allocator;
+
+/**
+ * @brief Creates a buddy allocator.
+ *
+ * Should be called twice; once with memory = 0 to obtain the memory requirement, then a
+ * second time passing a block of that size.
+ *
+ * @param total_size The size of the range to manage. Must be a power of 2.
+ * @param min_block_size The size of the smallest block handed out. Must be a power of 2, no larger than total_size.
+ * @param memory_requirement A pointer to hold the size of the block the allocator needs for its bookkeeping.
+ * @param memory A block of memory_requirement bytes, or 0 to only obtain the memory requirement.
+ * @param out_allocator Pointer to the buddy_allocator structure to initialize. Ignored when memory is 0.
+ * @return True on success; otherwise False.
+ */
+KAPI b8 buddy_allocator_create(u64 total_size, u64 min_block_size, u64* memory_requirement, void* memory, buddy_allocator* out_allocator);
+
+/**
+ * @brief Destroys the buddy allocator. The bookkeeping block is not freed, as it belongs to the caller.
+ *
+ * @param allocator Pointer to the buddy_allocator structure to destroy.
+ */
+KAPI void buddy_allocator_destroy(buddy_allocator* allocator);
+
+/**
+ * @brief Allocates a block from the range.
+ *
+ * @param allocator Pointer to the buddy_allocator structure to allocate from.
+ * @param size The size of the block in bytes. Rounded up to a power of 2 of at least min_block_size.
+ * @param alignment The required alignment of the offset. Must be a power of 2.
+ * @param out_offset A pointer to hold the offset of the block within the range.
+ * @return True on success; False if there is no free block large enough.
+ */
+KAPI b8 buddy_allocator_allocate(buddy_allocator* allocator, u64 size, u64 alignment, u64* out_offset);
+
+/**
+ * @brief Returns a block to the allocator, merging it with its buddies where possible.
+ *
+ * @param allocator Pointer to the buddy_allocator structure the block was allocated from.
+ * @param offset The offset of the block, as returned by buddy_allocator_allocate().
+ * @return The size of the block that was freed, or 0 if offset is not the start of an allocated block.
+ */
+KAPI u64 buddy_allocator_free(buddy_allocator* allocator, u64 offset);
+
+/**
+ * @brief Obtains the size of the largest block that can currently be allocated.
+ *
+ * @param allocator Pointer to the buddy_allocator structure to query.
+ * @return The size of the largest free block in bytes, or 0 if the range is full.
+ */
+KAPI u64 buddy_allocator_largest_free_block(const buddy_allocator* allocator);
@@ -0,0 +1,443 @@
+#include "dynamic_allocator.h"
+
+#include "core/kmemory.h"
+#include "core/logger.h"
+
+/**
+ * @file dynamic_allocator.c
+ *
+ * @brief Implementation of a two-level segregated fit (TLSF) allocator.
+ *
+ * Memory layout of the provided block:
+ * - The allocator_control structure (bitmaps and free list heads).
+ * - The pool: a sequence of physically adjacent blocks, each a block header followed by its
+ *   payload, terminated by a zero-sized "sentinel" block that is always marked as used.
+ *
+ * Size classes: sizes below SMALL_BLOCK_SIZE map linearly onto the first level's second-level
+ * bins (one bin per DYNAMIC_ALLOCATOR_MIN_ALIGNMENT bytes). Larger sizes map to a first level of
+ * floor(log2(size)) and one of SL_COUNT linear subdivisions within it.
+ */
+
+#define ALIGN_SIZE_LOG2 4
+#define ALIGN_SIZE (1ull << ALIGN_SIZE_LOG2)
+
+/** @brief log2 of the number of second-level subdivisions per first-level class. */
+#define SL_INDEX_COUNT_LOG2 4
+#define SL_INDEX_COUNT (1u << SL_INDEX_COUNT_LOG2)
+
+/** @brief The largest first-level class, i.e. the largest block is just under 2^FL_INDEX_MAX bytes. */
+#define FL_INDEX_MAX 40
+#define FL_INDEX_SHIFT (SL_INDEX_COUNT_LOG2 + ALIGN_SIZE_LOG2)
+#define FL_INDEX_COUNT (FL_INDEX_MAX - FL_INDEX_SHIFT + 1)
+
+/** @brief Sizes below this are all binned in the first first-level class. */
+#define SMALL_BLOCK_SIZE (1ull << FL_INDEX_SHIFT)
+
+/** @brief Set on a block's size when the block is free. */
+#define BLOCK_FLAG_FREE 0x1ull
+/** @brief Set on a block's size when the physically previous block is free. */
+#define BLOCK_FLAG_PREV_FREE 0x2ull
+#define BLOCK_FLAGS (BLOCK_FLAG_FREE | BLOCK_FLAG_PREV_FREE)
+
+/**
+ * @struct block_header
+ * @brief Precedes every block in the pool.
+ */
+typedef struct block_header {
+    /** @brief The physically previous block. Always kept up to date. */
+    struct block_header* prev_physical;
+    /** @brief The payload size, with BLOCK_FLAGS in the low bits (sizes are always aligned). */
+    u64 size;
+    /** @brief The next block in the same free list. Only valid while free; overlaps the payload. */
+    struct block_header* next_free;
+    /** @brief The previous block in the same free list. Only valid while free; overlaps the payload. */
+    struct block_header* prev_free;
+} block_header;
+
+/** @brief The header overhead of a used block. The free list links live in the payload. */
+#define BLOCK_HEADER_OVERHEAD (sizeof(block_header*) + sizeof(u64))
+
+/** @brief The smallest payload a block can have, large enough to hold the free list links. */
+#define BLOCK_SIZE_MIN (sizeof(block_header) - BLOCK_HEADER_OVERHEAD)
+#define BLOCK_SIZE_MAX (1ull << FL_INDEX_MAX)
+
+/**
+ * @struct allocator_control
+ * @brief Tracks which size classes have free blocks, and the head of each class's free list.
+ */
+typedef struct allocator_control {
+    /** @brief Bit n is set when first-level class n has any free blocks. */
+    u64 fl_bitmap;
+    /** @brief Per first-level class, bit n is set when second-level class n has any free blocks. */
+    u32 sl_bitmap[FL_INDEX_COUNT];
+    /** @brief Heads of the free lists, per size class. */
+    block_header* blocks[FL_INDEX_COUNT][SL_INDEX_COUNT];
+} allocator_control;
+
+#define CONTROL_SIZE ((sizeof(allocator_control) + (ALIGN_SIZE - 1)) & ~(ALIGN_SIZE - 1))
+
+// Bit scans. Callers guarantee a non-zero value.
+KINLINE u32 bit_scan_msb(u64 value) { return 63 - __builtin_clzll(value); }
+KINLINE u32 bit_scan_lsb(u64 value) { return __builtin_ctzll(value); }
+
+KINLINE u64 align_up(u64 value, u64 alignment) { return (value + (alignment - 1)) & ~(alignment - 1); }
+
+KINLINE u64 block_size(const block_header* block) { return block->size & ~BLOCK_FLAGS; }
+KINLINE void block_set_size(block_header* block, u64 size) { block->size = size | (block->size & BLOCK_FLAGS); }
+
+KINLINE b8 block_is_free(const block_header* block) { return (block->size & BLOCK_FLAG_FREE) != 0; }
+KINLINE void block_set_free(block_header* block) { block->size |= BLOCK_FLAG_FREE; }
+KINLINE void block_set_used(block_header* block) { block->size &= ~BLOCK_FLAG_FREE; }
+
+KINLINE b8 block_is_prev_free(const block_header* block) { return (block->size & BLOCK_FLAG_PREV_FREE) != 0; }
+KINLINE void block_set_prev_free(block_header* block) { block->size |= BLOCK_FLAG_PREV_FREE; }
+KINLINE void block_set_prev_used(block_header* block) { block->size &= ~BLOCK_FLAG_PREV_FREE; }
+
+KINLINE block_header* block_from_ptr(const void* ptr) { return (block_header*)((u8*)ptr - BLOCK_HEADER_OVERHEAD); }
+KINLINE void* block_to_ptr(const block_header* block) { return (u8*)block + BLOCK_HEADER_OVERHEAD; }
+
+KINLINE allocator_control* get_control(const dynamic_allocator* allocator) { return (allocator_control*)allocator->memory; }
+KINLINE u8* get_pool(const dynamic_allocator* allocator) { return (u8*)allocator->memory + CONTROL_SIZE; }
+
+/** @brief Obtains the physically next block. */
+KINLINE block_header* block_next(const block_header* block) {
+    return (block_header*)((u8*)block_to_ptr(block) + block_size(block));
+}
+
+/** @brief Points the physically next block back at this one, and returns it. */
+KINLINE block_header* block_link_next(block_header* block) {
+    block_header* next = block_next(block);
+    next->prev_physical = block;
+    return next;
+}
+
+static void block_mark_as_free(block_header* block) {
+    block_header* next = block_link_next(block);
+    block_set_prev_free(next);
+    block_set_free(block);
+}
+
+static void block_mark_as_used(block_header* block) {
+    block_header* next = block_next(block);
+    block_set_prev_used(next);
+    block_set_used(block);
+}
+
+/** @brief Maps a block size to the size class it is filed under. */
+static void mapping_insert(u64 size, u32* fl, u32* sl) {
+    if (size < SMALL_BLOCK_SIZE) {
+        *fl = 0;
+        *sl = (u32)(size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT));
+    } else {
+        u32 msb = bit_scan_msb(size);
+        *sl = (u32)(size >> (msb - SL_INDEX_COUNT_LOG2)) ^ SL_INDEX_COUNT;
+        *fl = msb - (FL_INDEX_SHIFT - 1);
+    }
+}
+
+/**
+ * @brief Maps a requested size to the smallest size class whose blocks are all large enough,
+ * by rounding the size up to the next class boundary first.
+ */
+static void mapping_search(u64 size, u32* fl, u32* sl) {
+    if (size >= SMALL_BLOCK_SIZE) {
+        size += (1ull << (bit_scan_msb(size) - SL_INDEX_COUNT_LOG2)) - 1;
+    }
+    mapping_insert(size, fl, sl);
+}
+
+/** @brief Finds the first non-empty size class at or above fl/sl, updating them to match. */
+static block_header* search_suitable_block(allocator_control* control, u32* fl, u32* sl) {
+    u32 sl_map = control->sl_bitmap[*fl] & (~0u << *sl);
+    if (!sl_map) {
+        // Nothing left in this first-level class; move up to the next one with free blocks.
+        u64 fl_map = control->fl_bitmap & (~0ull << (*fl + 1));
+        if (!fl_map) {
+            return 0;
+        }
+        *fl = bit_scan_lsb(fl_map);
+        sl_map = control->sl_bitmap[*fl];
+    }
+    *sl = bit_scan_lsb(sl_map);
+
+    return control->blocks[*fl][*sl];
+}
+
+static void remove_free_block(allocator_control* control, block_header* block, u32 fl, u32 sl) {
+    block_header* prev = block->prev_free;
+    block_header* next = block->next_free;
+    if (next) {
+        next->prev_free = prev;
+    }
+    if (prev) {
+        prev->next_free = next;
+    } else {
+        // Block was the list head; update it, clearing the bitmaps if the list is now empty.
+        control->blocks[fl][sl] = next;
+        if (!next) {
+            control->sl_bitmap[fl] &= ~(1u << sl);
+            if (!control->sl_bitmap[fl]) {
+                control->fl_bitmap &= ~(1ull << fl);
+            }
+        }
+    }
+}
+
+static void insert_free_block(allocator_control* control, block_header* block, u32 fl, u32 sl) {
+    block_header* current = control->blocks[fl][sl];
+    block->next_free = current;
+    block->prev_free = 0;
+    if (current) {
+        current->prev_free = block;
+    }
+    control->blocks[fl][sl] = block;
+    control->fl_bitmap |= (1ull << fl);
+    control->sl_bitmap[fl] |= (1u << sl);
+}
+
+static void block_remove(allocator_control* control, block_header* block) {
+    u32 fl, sl;
+    mapping_insert(block_size(block), &fl, &sl);
+    remove_free_block(control, block, fl, sl);
+}
+
+static void block_insert(allocator_control* control, block_header* block) {
+    u32 fl, sl;
+    mapping_insert(block_size(block), &fl, &sl);
+    insert_free_block(control, block, fl, sl);
+}
+
+KINLINE b8 block_can_split(const block_header* block, u64 size) {
+    return block_size(block) >= sizeof(block_header) + size;
+}
+
+/** @brief Splits the block at size bytes of payload. The remainder is marked free but not inserted. */
+static block_header* block_split(block_header* block, u64 size) {
+    block_header* remaining = (block_header*)((u8*)block_to_ptr(block) + size);
+    u64 remaining_size = block_size(block) - (size + BLOCK_HEADER_OVERHEAD);
+
+    remaining->size = remaining_size;
+    block_set_size(block, size);
+    remaining->prev_physical = block;
+    block_mark_as_free(remaining);
+
+    return remaining;
+}
+
+/** @brief Absorbs a free block into the physically previous one. */
+static block_header* block_absorb(block_header* prev, block_header* block) {
+    block_set_size(prev, block_size(prev) + block_size(block) + BLOCK_HEADER_OVERHEAD);
+    block_link_next(prev);
+    return prev;
+}
+
+static block_header* block_merge_prev(allocator_control* control, block_header* block) {
+    if (block_is_prev_free(block)) {
+        block_header* prev = block->prev_physical;
+        block_remove(control, prev);
+        block = block_absorb(prev, block);
+    }
+    return block;
+}
+
+static block_header* block_merge_next(allocator_control* control, block_header* block) {
+    block_header* next = block_next(block);
+    if (block_is_free(next)) {
+        block_remove(control, next);
+        block = block_absorb(block, next);
+    }
+    return block;
+}
+
+/** @brief Returns any space beyond size at the end of the block to the free lists. */
+static void block_trim_free(allocator_control* control, block_header* block, u64 size) {
+    if (block_can_split(block, size)) {
+        block_header* remaining = block_split(block, size);
+        block_insert(control, remaining);
+    }
+}
+
+/** @brief Returns the first gap bytes of the block to the free lists, returning the block that follows. */
+static block_header* block_trim_free_leading(allocator_control* control, block_header* block, u64 gap) {
+    block_header* remaining = block;
+    if (block_can_split(block, gap)) {
+        remaining = block_split(block, gap - BLOCK_HEADER_OVERHEAD);
+        block_set_prev_free(remaining);
+        block_insert(control, block);
+    }
+    return remaining;
+}
+
+/** @brief Rounds a requested size up to a valid block size. Returns 0 if too large. */
+static u64 adjust_request_size(u64 size) {
+    u64 adjusted = align_up(KMAX(size, BLOCK_SIZE_MIN), ALIGN_SIZE);
+    return adjusted < BLOCK_SIZE_MAX ? adjusted : 0;
+}
+
+b8 dynamic_allocator_create(u64 total_size, u64* memory_requirement, void* memory, dynamic_allocator* out_allocator) {
+    if (!memory_requirement) {
+        KERROR("dynamic_allocator_create requires a valid pointer to memory_requirement.");
+        return False;
+    }
+
+    // Room for the first block's header, the sentinel's header and a minimum-size payload.
+    u64 pool_size = align_up(total_size, ALIGN_SIZE);
+    if (pool_size < (BLOCK_HEADER_OVERHEAD * 2) + BLOCK_SIZE_MIN || pool_size - (BLOCK_HEADER_OVERHEAD * 2) >= BLOCK_SIZE_MAX) {
+        KERROR("dynamic_allocator_create - total_size of %llu is outside of the supported range.", total_size);
+        return False;
+    }
+
+    // Padding allows the provided block to be realigned.
+    *memory_requirement = CONTROL_SIZE + pool_size + (ALIGN_SIZE - 1);
+
+    if (!memory) {
+        return True;
+    }
+
+    if (!out_allocator) {
+        KERROR("dynamic_allocator_create requires a valid pointer to out_allocator.");
+        return False;
+    }
+
+    out_allocator->memory = (void*)align_up((u64)memory, ALIGN_SIZE);
+    out_allocator->total_size = pool_size;
+    kzero_memory(out_allocator->memory, sizeof(allocator_control));
+
+    // One large free block spanning the pool...
+    block_header* block = (block_header*)get_pool(out_allocator);
+    block->prev_physical = 0;
+    block->size = pool_size - (BLOCK_HEADER_OVERHEAD * 2);
+    block_set_free(block);
+    block_insert(get_control(out_allocator), block);
+
+    // ...followed by a zero-sized, permanently used sentinel so the last block has a next.
+    block_header* sentinel = block_link_next(block);
+    sentinel->size = 0;
+    block_set_used(sentinel);
+    block_set_prev_free(sentinel);
+
+    out_allocator->free_space = pool_size - BLOCK_HEADER_OVERHEAD;
+
+    return True;
+}
+
+void dynamic_allocator_destroy(dynamic_allocator* allocator) {
+    if (allocator) {
+        allocator->total_size = 0;
+        allocator->free_space = 0;
+        allocator->memory = 0;
+    }
+}
+
+void* dynamic_allocator_allocate(dynamic_allocator* allocator, u64 size) {
+    return dynamic_allocator_allocate_aligned(allocator, size, ALIGN_SIZE);
+}
+
+void* dynamic_allocator_allocate_aligned(dynamic_allocator* allocator, u64 size, u64 alignment) {
+    if (!allocator || !allocator->memory) {
+        KERROR("dynamic_allocator_allocate_aligned - provided allocator not initialized.");
+        return 0;
+    }
+
+    if (alignment & (alignment - 1)) {
+        KERROR("dynamic_allocator_allocate_aligned - alignment of %llu is not a power of 2.", alignment);
+        return 0;
+    }
+
+    allocator_control* control = get_control(allocator);
+    u64 adjusted = adjust_request_size(size);
+    if (!adjusted) {
+        KERROR("dynamic_allocator_allocate_aligned - size of %llu is too large.", size);
+        return 0;
+    }
+
+    // For larger alignments, search for enough room to move the payload up to an aligned
+    // address, leaving a gap at the front large enough to become a free block of its own.
+    const u64 gap_minimum = sizeof(block_header);
+    u64 search_size = adjusted;
+    if (alignment > ALIGN_SIZE) {
+        search_size = adjust_request_size(adjusted + alignment + gap_minimum);
+        if (!search_size) {
+            KERROR("dynamic_allocator_allocate_aligned - size of %llu is too large.", size);
+            return 0;
+        }
+    }
+
+    u32 fl, sl;
+    mapping_search(search_size, &fl, &sl);
+    block_header* block = 0;
+    if (fl < FL_INDEX_COUNT) {
+        block = search_suitable_block(control, &fl, &sl);
+    }
+    if (!block) {
+        KWARN("dynamic_allocator_allocate_aligned - no free block large enough for %llu bytes (%llu bytes free).", size, allocator->free_space);
+        return 0;
+    }
+    remove_free_block(control, block, fl, sl);
+
+    if (alignment > ALIGN_SIZE) {
+        u64 ptr = (u64)block_to_ptr(block);
+        u64 aligned = align_up(ptr, alignment);
+        u64 gap = aligned - ptr;
+        if (gap && gap < gap_minimum) {
+            // Too small to be a block; move to the next aligned address that leaves enough room.
+            aligned = align_up(ptr + gap_minimum, alignment);
+            gap = aligned - ptr;
+        }
+        if (gap) {
+            block = block_trim_free_leading(control, block, gap);
+        }
+    }
+
+    block_trim_free(control, block, adjusted);
+    block_mark_as_used(block);
+
+    allocator->free_space -= block_size(block) + BLOCK_HEADER_OVERHEAD;
+
+    return block_to_ptr(block);
+}
+
+b8 dynamic_allocator_free(dynamic_allocator* allocator, void* block) {
+    if (!allocator || !block) {
+        KERROR("dynamic_allocator_free requires a valid allocator and block.");
+        return False;
+    }
+
+    if (!dynamic_allocator_owns(allocator, block)) {
+        KERROR("dynamic_allocator_free - block %p does not belong to this allocator.", block);
+        return False;
+    }
+
+    block_header* header = block_from_ptr(block);
+    if (block_is_free(header)) {
+        KERROR("dynamic_allocator_free - block %p is already free.", block);
+        return False;
+    }
+
+    allocator->free_space += block_size(header) + BLOCK_HEADER_OVERHEAD;
+
+    allocator_control* control = get_control(allocator);
+    block_mark_as_free(header);
+    header = block_merge_prev(control, header);
+    header = block_merge_next(control, header);
+    block_insert(control, header);
+
+    return True;
+}
+
+b8 dynamic_allocator_owns(const dynamic_allocator* allocator, const void* block) {
+    if (!allocator || !allocator->memory) {
+        return False;
+    }
+
+    const u8* pool = get_pool(allocator);
+    return (const u8*)block >= pool && (const u8*)block < pool + allocator->total_size;
+}
+
+u64 dynamic_allocator_block_size(const dynamic_allocator* allocator, const void* block) {
+    if (!dynamic_allocator_owns(allocator, block)) {
+        return 0;
+    }
+
+    return block_size(block_from_ptr(block));
+}
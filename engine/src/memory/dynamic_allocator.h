@@ -0,0 +1,107 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * @file dynamic_allocator.h
+ *
+ * @brief General-purpose allocator for variable-sized blocks, carved from a single block of memory.
+ *
+ * Implements a two-level segregated fit (TLSF) allocator. Free blocks are binned by size class
+ * (a power-of-two first level, subdivided linearly into a second level), with a bitmap per level
+ * recording which bins are non-empty. Finding a suitable free block is a couple of bit scans, and
+ * freed blocks are immediately merged with free physical neighbours, so both allocating and
+ * freeing are O(1) regardless of how many blocks are live.
+ *
+ * Every block carries a small header, and payloads are always aligned to at least
+ * DYNAMIC_ALLOCATOR_MIN_ALIGNMENT bytes.
+ *
+ * The allocator never allocates memory itself; the caller provides one block up front.
+ * Like the engine's systems, it is created in two passes: once to obtain the memory
+ * requirement, then again with a block of that size.
+ *
+ * NOTE: Not thread-safe. Callers sharing an allocator across threads must synchronize access.
+ */
+
+/** @brief The minimum alignment of every block handed out by the allocator. */
+#define DYNAMIC_ALLOCATOR_MIN_ALIGNMENT 16
+
+/**
+ * @struct dynamic_allocator
+ *
+ * @brief Represents a dynamic allocator. Members should not be modified outside the dynamic_allocator_ functions.
+ */
+typedef struct dynamic_allocator {
+    u64 total_size;  // Total size of the block memory is allocated from, including block headers.
+    u64 free_space;  // Free space remaining, including block headers.
+    void* memory;    // The caller-provided block. Allocator bookkeeping lives at its start.
+} dynamic_allocator;
+
+/**
+ * @brief Creates a dynamic allocator.
+ *
+ * Should be called twice; once with memory = 0 to obtain the memory requirement, then a
+ * second time passing a block of that size.
+ *
+ * @param total_size The number of bytes available for allocations, including per-block overhead.
+ * @param memory_requirement A pointer to hold the total size of the block the allocator needs.
+ * @param memory A block of memory_requirement bytes, or 0 to only obtain the memory requirement.
+ * @param out_allocator Pointer to the dynamic_allocator structure to initialize. Ignored when memory is 0.
+ * @return True on success; otherwise False.
+ */
+KAPI b8 dynamic_allocator_create(u64 total_size, u64* memory_requirement, void* memory, dynamic_allocator* out_allocator);
+
+/**
+ * @brief Destroys the dynamic allocator. The memory block itself is not freed, as it belongs to the caller.
+ *
+ * @param allocator Pointer to the dynamic_allocator structure to destroy.
+ */
+KAPI void dynamic_allocator_destroy(dynamic_allocator* allocator);
+
+/**
+ * @brief Allocates a block from the allocator, aligned to DYNAMIC_ALLOCATOR_MIN_ALIGNMENT.
+ * The contents of the block are undefined.
+ *
+ * @param allocator Pointer to the dynamic_allocator structure to allocate from.
+ * @param size The size of the block in bytes.
+ * @return Pointer to the allocated block, or 0 if there is no free block large enough.
+ */
+KAPI void* dynamic_allocator_allocate(dynamic_allocator* allocator, u64 size);
+
+/**
+ * @brief Allocates a block from the allocator with the given alignment.
+ * The contents of the block are undefined.
+ *
+ * @param allocator Pointer to the dynamic_allocator structure to allocate from.
+ * @param size The size of the block in bytes.
+ * @param alignment The alignment of the block. Must be a power of 2. Values below DYNAMIC_ALLOCATOR_MIN_ALIGNMENT are raised to it.
+ * @return Pointer to the allocated block, or 0 if there is no free block large enough.
+ */
+KAPI void* dynamic_allocator_allocate_aligned(dynamic_allocator* allocator, u64 size, u64 alignment);
+
+/**
+ * @brief Returns a block to the allocator, merging it with any free neighbours.
+ *
+ * @param allocator Pointer to the dynamic_allocator structure the block was allocated from.
+ * @param block The block to free.
+ * @return True on success; False if the block does not belong to the allocator.
+ */
+KAPI b8 dynamic_allocator_free(dynamic_allocator* allocator, void* block);
+
+/**
+ * @brief Indicates if the given block lies within the memory managed by the allocator.
+ *
+ * @param allocator Pointer to the dynamic_allocator structure to check.
+ * @param block The block to check.
+ * @return True if the block belongs to the allocator; otherwise False.
+ */
+KAPI b8 dynamic_allocator_owns(const dynamic_allocator* allocator, const void* block);
+
+/**
+ * @brief Obtains the usable size of an allocated block, which may be larger than was requested.
+ *
+ * @param allocator Pointer to the dynamic_allocator structure the block was allocated from.
+ * @param block The allocated block.
+ * @return The usable size of the block in bytes.
+ */
+KAPI u64 dynamic_allocator_block_size(const dynamic_allocator* allocator, const void* block);
@@ -0,0 +1,88 @@
+#include "frame_allocator.h"
+
+#include "core/logger.h"
+#include "memory/linear_allocator.h"
+
+/**
+ * @file frame_allocator.c
+ *
+ * @brief Implementation of the double-buffered frame allocator.
+ */
+
+/**
+ * @struct frame_allocator_state
+ * @brief Internal state of the frame allocator.
+ */
+typedef struct frame_allocator_state {
+    /** @brief Configuration the allocator was initialized with. */
+    frame_allocator_config config;
+    /** @brief The two frame buffers. Their memory follows this structure in the state block. */
+    linear_allocator frames[2];
+    /** @brief Index of the frame buffer currently being allocated from. */
+    u32 current;
+    /** @brief The most bytes used by any single frame, to help size frame_size. */
+    u64 peak_usage;
+} frame_allocator_state;
+
+/** @brief Pointer to the frame allocator state. */
+static frame_allocator_state* state_ptr = 0;
+
+b8 frame_allocator_initialize(u64* memory_requirement, void* state, frame_allocator_config config) {
+    if (config.frame_size == 0) {
+        KFATAL("frame_allocator_initialize - config.frame_size must be greater than 0.");
+        return False;
+    }
+
+    *memory_requirement = sizeof(frame_allocator_state) + (config.frame_size * 2);
+
+    if (!state) {
+        return True;
+    }
+
+    state_ptr = state;
+    state_ptr->config = config;
+    state_ptr->current = 0;
+    state_ptr->peak_usage = 0;
+
+    u8* frame_memory = (u8*)state + sizeof(frame_allocator_state);
+    linear_allocator_create(config.frame_size, frame_memory, &state_ptr->frames[0]);
+    linear_allocator_create(config.frame_size, frame_memory + config.frame_size, &state_ptr->frames[1]);
+
+    return True;
+}
+
+void frame_allocator_shutdown(void* state) {
+    if (state_ptr) {
+        KDEBUG("Frame allocator peak usage: %llu of %llu bytes per frame.", state_ptr->peak_usage, state_ptr->config.frame_size);
+        linear_allocator_destroy(&state_ptr->frames[0]);
+        linear_allocator_destroy(&state_ptr->frames[1]);
+    }
+
+    state_ptr = 0;
+}
+
+void frame_allocator_end_frame() {
+    if (state_ptr) {
+        u64 usage = state_ptr->frames[state_ptr->current].allocated;
+        if (usage > state_ptr->peak_usage) {
+            state_ptr->peak_usage = usage;
+        }
+
+        // The buffer becoming current was last used two frames ago, so nothing can refer to it.
+        state_ptr->current ^= 1;
+        linear_allocator_free_all(&state_ptr->frames[state_ptr->current], False);
+    }
+}
+
+void* frame_alloc(u64 size, u16 alignment) {
+    if (!state_ptr) {
+        KERROR("frame_alloc called before the frame allocator was initialized.");
+        return 0;
+    }
+
+    return linear_allocator_allocate_aligned(&state_ptr->frames[state_ptr->current], size, alignment);
+}
+
+u64 frame_allocator_frame_usage() {
+    return state_ptr ? state_ptr->frames[state_ptr->current].allocated : 0;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * @file frame_allocator.h
+ *
+ * @brief Double-buffered scratch memory for per-frame temporaries.
+ *
+ * Holds two linear allocators. Allocations come from the current one, and are simple pointer
+ * bumps. At the end of each frame the allocators swap, and the one becoming current is reset
+ * without being cleared. A block allocated during frame N therefore stays valid until the end
+ * of frame N + 1, which lets data built in one frame be read while the next is being put together.
+ *
+ * Nothing is ever freed individually, and blocks are NOT zeroed.
+ *
+ * NOTE: Not thread-safe. Only allocate from the main thread.
+ */
+
+/**
+ * @struct frame_allocator_config
+ * @brief Configuration for the frame allocator.
+ */
+typedef struct frame_allocator_config {
+    /** @brief The size in bytes of each of the two frame buffers. */
+    u64 frame_size;
+} frame_allocator_config;
+
+/**
+ * @brief Initializes the frame allocator.
+ *
+ * Should be called twice; once with state = 0 to obtain the memory requirement, then a
+ * second time passing an allocated block of that size. The frame buffers live in that block.
+ *
+ * @param memory_requirement A pointer to hold the memory requirement of the system.
+ * @param state A block of memory to hold the state, or 0 to only obtain the memory requirement.
+ * @param config The configuration for the system.
+ * @return True on success; otherwise False.
+ */
+b8 frame_allocator_initialize(u64* memory_requirement, void* state, frame_allocator_config config);
+
+/**
+ * @brief Shuts down the frame allocator. All frame allocations become invalid.
+ *
+ * @param state A pointer to the system state.
+ */
+void frame_allocator_shutdown(void* state);
+
+/**
+ * @brief Ends the current frame: swaps frame buffers and resets the one becoming current.
+ * Blocks allocated during the frame before the one just ended become invalid.
+ */
+void frame_allocator_end_frame();
+
+/**
+ * @brief Allocates scratch memory that lives until the end of the next frame.
+ * The contents of the block are undefined.
+ *
+ * @param size The size of the block in bytes.
+ * @param alignment The alignment of the block in bytes. Must be a power of 2.
+ * @return Pointer to the block, or 0 if the current frame buffer is full or the allocator is not running.
+ */
+KAPI void* frame_alloc(u64 size, u16 alignment);
+
+/**
+ * @brief Obtains the number of bytes allocated so far in the current frame.
+ *
+ * @return The bytes in use in the current frame buffer, including alignment padding.
+ */
+KAPI u64 frame_allocator_frame_usage();
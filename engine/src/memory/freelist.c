@@ -0,0 +1,203 @@
+#include "freelist.h"
+
+#include "core/kmemory.h"
+#include "core/logger.h"
+
+/**
+ * @file freelist.c
+ *
+ * @brief Implementation of the free list.
+ */
+
+/** @brief Inserts a range at the given index, shifting later ranges up. */
+static void insert_range(freelist* list, u32 index, u64 offset, u64 size) {
+    for (u32 i = list->range_count; i > index; --i) {
+        list->ranges[i] = list->ranges[i - 1];
+    }
+    list->ranges[index].offset = offset;
+    list->ranges[index].size = size;
+    list->range_count++;
+}
+
+/** @brief Removes the range at the given index, shifting later ranges down. */
+static void remove_range(freelist* list, u32 index) {
+    for (u32 i = index; i + 1 < list->range_count; ++i) {
+        list->ranges[i] = list->ranges[i + 1];
+    }
+    list->range_count--;
+}
+
+b8 freelist_create(u64 total_size, u32 max_ranges, u64* memory_requirement, void* memory, freelist* out_list) {
+    if (!memory_requirement) {
+        KERROR("freelist_create requires a valid pointer to memory_requirement.");
+        return False;
+    }
+
+    if (!total_size || !max_ranges) {
+        KERROR("freelist_create requires a non-zero total_size and max_ranges.");
+        return False;
+    }
+
+    *memory_requirement = sizeof(freelist_range) * max_ranges;
+
+    if (!memory) {
+        return True;
+    }
+
+    if (!out_list) {
+        KERROR("freelist_create requires a valid pointer to out_list.");
+        return False;
+    }
+
+    out_list->max_ranges = max_ranges;
+    out_list->ranges = memory;
+    out_list->total_size = total_size;
+    freelist_clear(out_list);
+
+    return True;
+}
+
+void freelist_destroy(freelist* list) {
+    if (list) {
+        kzero_memory(list, sizeof(freelist));
+    }
+}
+
+/** @brief Takes size bytes from the start of the free range at the given index. */
+static void take_from_range(freelist* list, u32 index, u64 size, u64* out_offset) {
+    freelist_range* range = &list->ranges[index];
+    *out_offset = range->offset;
+    if (range->size == size) {
+        remove_range(list, index);
+    } else {
+        range->offset += size;
+        range->size -= size;
+    }
+
+    list->free_space -= size;
+}
+
+b8 freelist_allocate_block(freelist* list, u64 size, u64* out_offset) {
+    if (!list || !out_offset || !size) {
+        KERROR("freelist_allocate_block requires a valid list, out_offset and non-zero size.");
+        return False;
+    }
+
+    // Best fit. Ranges are sorted by offset, so the first of equally good fits is the lowest.
+    u32 best = INVALID_ID;
+    for (u32 i = 0; i < list->range_count; ++i) {
+        u64 range_size = list->ranges[i].size;
+        if (range_size >= size && (best == INVALID_ID || range_size < list->ranges[best].size)) {
+            best = i;
+            if (range_size == size) {
+                break;
+            }
+        }
+    }
+
+    if (best == INVALID_ID) {
+        return False;
+    }
+
+    take_from_range(list, best, size, out_offset);
+    return True;
+}
+
+b8 freelist_allocate_block_lowest(freelist* list, u64 size, u64* out_offset) {
+    if (!list || !out_offset || !size) {
+        KERROR("freelist_allocate_block_lowest requires a valid list, out_offset and non-zero size.");
+        return False;
+    }
+
+    for (u32 i = 0; i < list->range_count; ++i) {
+        if (list->ranges[i].size >= size) {
+            take_from_range(list, i, size, out_offset);
+            return True;
+        }
+    }
+
+    return False;
+}
+
+b8 freelist_free_block(freelist* list, u64 size, u64 offset) {
+    if (!list || !size) {
+        KERROR("freelist_free_block requires a valid list and non-zero size.");
+        return False;
+    }
+
+    if (offset + size > list->total_size) {
+        KERROR("freelist_free_block - Range [%llu, %llu) lies outside the %llu byte block.", offset, offset + size, list->total_size);
+        return False;
+    }
+
+    // Find the first free range after the one being freed.
+    u32 next = 0;
+    while (next < list->range_count && list->ranges[next].offset < offset) {
+        next++;
+    }
+
+    freelist_range* prev_range = next > 0 ? &list->ranges[next - 1] : 0;
+    freelist_range* next_range = next < list->range_count ? &list->ranges[next] : 0;
+    if ((prev_range && prev_range->offset + prev_range->size > offset) || (next_range && offset + size > next_range->offset)) {
+        KERROR("freelist_free_block - Range [%llu, %llu) overlaps free space. Was it freed twice?", offset, offset + size);
+        return False;
+    }
+
+    b8 merge_prev = prev_range && prev_range->offset + prev_range->size == offset;
+    b8 merge_next = next_range && offset + size == next_range->offset;
+    if (merge_prev && merge_next) {
+        prev_range->size += size + next_range->size;
+        remove_range(list, next);
+    } else if (merge_prev) {
+        prev_range->size += size;
+    } else if (merge_next) {
+        next_range->offset = offset;
+        next_range->size += size;
+    } else {
+        if (list->range_count == list->max_ranges) {
+            KERROR("freelist_free_block - The list is full at %u ranges. The range is lost until the list is cleared.", list->max_ranges);
+            return False;
+        }
+        insert_range(list, next, offset, size);
+    }
+
+    list->free_space += size;
+    return True;
+}
+
+b8 freelist_resize(freelist* list, u64 new_size) {
+    if (!list || new_size < list->total_size) {
+        KERROR("freelist_resize - The list can only grow.");
+        return False;
+    }
+
+    if (new_size == list->total_size) {
+        return True;
+    }
+
+    u64 old_size = list->total_size;
+    list->total_size = new_size;
+    if (!freelist_free_block(list, new_size - old_size, old_size)) {
+        list->total_size = old_size;
+        return False;
+    }
+
+    return True;
+}
+
+void freelist_clear(freelist* list) {
+    list->ranges[0].offset = 0;
+    list->ranges[0].size = list->total_size;
+    list->range_count = 1;
+    list->free_space = list->total_size;
+}
+
+u64 freelist_largest_free_block(const freelist* list) {
+    u64 largest = 0;
+    for (u32 i = 0; i < list->range_count; ++i) {
+        if (list->ranges[i].size > largest) {
+            largest = list->ranges[i].size;
+        }
+    }
+    return largest;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * @file freelist.h
+ *
+ * @brief Free list tracking which ranges of a block of a given size are free.
+ *
+ * Like the buddy allocator, it only hands out offsets and never touches the block it manages, so
+ * it is used to sub-allocate GPU buffers. Ranges are handed out at exactly the size requested.
+ *
+ * Free ranges are kept sorted by offset. Allocation takes the best-fitting range, preferring the
+ * lowest offset among equally good fits, and freeing merges a range with any free neighbours, so
+ * the list never holds two adjacent ranges. Both are O(n) in the number of free ranges, which
+ * stays small as long as the number of live allocations does.
+ *
+ * The list of free ranges lives in a caller-provided block. Like the engine's systems, it is
+ * created in two passes: once to obtain the memory requirement, then again with a block of that
+ * size. The managed size may grow afterwards without a new block.
+ *
+ * NOTE: Not thread-safe. Callers sharing a free list across threads must synchronize access.
+ */
+
+/**
+ * @struct freelist_range
+ * @brief A free range of the managed block.
+ */
+typedef struct freelist_range {
+    u64 offset;
+    u64 size;
+} freelist_range;
+
+/**
+ * @struct freelist
+ *
+ * @brief Represents a free list. Members should not be modified outside the freelist_ functions.
+ */
+typedef struct freelist {
+    u64 total_size;          // Size of the managed block.
+    u64 free_space;          // Total size of the free ranges.
+    u32 range_count;         // Number of free ranges.
+    u32 max_ranges;          // Capacity of ranges.
+    freelist_range* ranges;  // Free ranges, sorted by offset. Lives in the caller-provided block.
+} freelist;
+
+/**
+ * @brief Creates a free list with the whole block free.
+ *
+ * Should be called twice; once with memory = 0 to obtain the memory requirement, then a
+ * second time passing a block of that size.
+ *
+ * @param total_size The size of the block to manage.
+ * @param max_ranges The most free ranges the list can track. A block split among n live
+ * allocations has at most n + 1 free ranges.
+ * @param memory_requirement A pointer to hold the size of the block the free list needs.
+ * @param memory A block of memory_requirement bytes, or 0 to only obtain the memory requirement.
+ * @param out_list Pointer to the freelist structure to initialize. Ignored when memory is 0.
+ * @return True on success; otherwise False.
+ */
+KAPI b8 freelist_create(u64 total_size, u32 max_ranges, u64* memory_requirement, void* memory, freelist* out_list);
+
+/**
+ * @brief Destroys the free list. The block holding the ranges is not freed, as it belongs to the caller.
+ *
+ * @param list Pointer to the freelist structure to destroy.
+ */
+KAPI void freelist_destroy(freelist* list);
+
+/**
+ * @brief Allocates a range from the free list.
+ *
+ * @param list Pointer to the freelist structure to allocate from.
+ * @param size The size of the range in bytes.
+ * @param out_offset A pointer to hold the offset of the range.
+ * @return True on success; False if there is no free range large enough.
+ */
+KAPI b8 freelist_allocate_block(freelist* list, u64 size, u64* out_offset);
+
+/**
+ * @brief Allocates the lowest-offset free range large enough, rather than the best fit. Used to
+ * compact allocations toward the start of the block.
+ *
+ * @param list Pointer to the freelist structure to allocate from.
+ * @param size The size of the range in bytes.
+ * @param out_offset A pointer to hold the offset of the range.
+ * @return True on success; False if there is no free range large enough.
+ */
+KAPI b8 freelist_allocate_block_lowest(freelist* list, u64 size, u64* out_offset);
+
+/**
+ * @brief Returns a range to the free list, merging it with any free neighbours.
+ *
+ * @param list Pointer to the freelist structure the range was allocated from.
+ * @param size The size the range was allocated with.
+ * @param offset The offset of the range.
+ * @return True on success; False if the range overlaps free space or lies outside the block, or the list is full.
+ */
+KAPI b8 freelist_free_block(freelist* list, u64 size, u64 offset);
+
+/**
+ * @brief Grows the managed block, adding the new space at its end to the free list.
+ *
+ * @param list Pointer to the freelist structure to grow.
+ * @param new_size The new size of the managed block. Must not be smaller than the current size.
+ * @return True on success; otherwise False.
+ */
+KAPI b8 freelist_resize(freelist* list, u64 new_size);
+
+/**
+ * @brief Frees everything, leaving the whole block as one free range.
+ *
+ * @param list Pointer to the freelist structure to clear.
+ */
+KAPI void freelist_clear(freelist* list);
+
+/**
+ * @brief Obtains the size of the largest range that can currently be allocated.
+ *
+ * @param list Pointer to the freelist structure to query.
+ * @return The size of the largest free range in bytes, or 0 if the block is full.
+ */
+KAPI u64 freelist_largest_free_block(const freelist* list);
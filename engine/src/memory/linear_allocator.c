@@ -62,9 +62,31 @@ void* linear_allocator_allocate(linear_allocator* allocator, u64 size) {
     return 0;
 }
 
-void linear_allocator_free_all(linear_allocator* allocator) {
+void* linear_allocator_allocate_aligned(linear_allocator* allocator, u64 size, u64 alignment) {
+    if (allocator && allocator->memory) {
+        // Align the address rather than the offset, as the memory block itself may not be aligned.
+        u64 base = (u64)allocator->memory;
+        u64 padding = get_aligned(base + allocator->allocated, alignment) - (base + allocator->allocated);
+        if (allocator->allocated + padding + size > allocator->total_size) {
+            u64 remaining = allocator->total_size - allocator->allocated;
+            KFATAL("linear_allocator_allocate_aligned - Out of memory! Requested: %lluB (+%lluB alignment), Available: %lluB", size, padding, remaining);
+            return 0;
+        }
+
+        allocator->allocated += padding;
+        return linear_allocator_allocate(allocator, size);
+    }
+
+    KFATAL("linear_allocator_allocate_aligned, provided allocator not initialized");
+
+    return 0;
+}
+
+void linear_allocator_free_all(linear_allocator* allocator, b8 clear) {
     if (allocator && allocator->memory) {
         allocator->allocated = 0;
-        kzero_memory(allocator->memory, allocator->total_size);
+        if (clear) {
+            kzero_memory(allocator->memory, allocator->total_size);
+        }
     }
 }
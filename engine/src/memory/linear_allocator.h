@@ -59,6 +59,18 @@ KAPI void linear_allocator_destroy(linear_allocator* out_allocator);
  */
 KAPI void* linear_allocator_allocate(linear_allocator* allocator, u64 size);
 
+/**
+ * @brief Allocates a block of memory from the linear allocator with the given alignment.
+ *
+ * Any padding needed to reach the alignment is consumed from the allocator.
+ *
+ * @param allocator Pointer to the linear_allocator structure to allocate from.
+ * @param size The size of the memory block to allocate in bytes.
+ * @param alignment The alignment of the block in bytes. Must be a power of 2.
+ * @return Pointer to the allocated memory block, or NULL if allocation fails.
+ */
+KAPI void* linear_allocator_allocate_aligned(linear_allocator* allocator, u64 size, u64 alignment);
+
 /**
  * @brief Frees all allocated memory in the linear allocator.
  *
@@ -66,6 +78,8 @@ KAPI void* linear_allocator_allocate(linear_allocator* allocator, u64 size);
  * It does not free the memory block itself, only resets the allocation state.
  *
  * @param allocator Pointer to the linear_allocator structure to free.
+ * @param clear If True, zeroes the whole block, not just the part that was in use. Pass False when callers
+ * don't rely on fresh blocks being zeroed, i.e. for per-frame scratch memory.
  * @return void
  */
-KAPI void linear_allocator_free_all(linear_allocator* allocator);
+KAPI void linear_allocator_free_all(linear_allocator* allocator, b8 clear);
@@ -0,0 +1,125 @@
+#include "pool_allocator.h"
+
+#include "core/logger.h"
+
+/**
+ * @file pool_allocator.c
+ *
+ * @brief Implementation of a fixed-size block pool allocator.
+ *
+ * Each chunk is laid out as a header (holding the pointer to the next chunk) followed by
+ * blocks_per_chunk blocks. New chunks thread all of their blocks onto the free list.
+ */
+
+/** @brief Alignment of every block, and of the first block after a chunk header. */
+#define POOL_BLOCK_ALIGNMENT 16
+
+/** @brief Size of the header at the start of each chunk. Keeps blocks aligned. */
+#define POOL_CHUNK_HEADER_SIZE POOL_BLOCK_ALIGNMENT
+
+/** @brief Obtains the size of a single chunk for the given pool. */
+KINLINE u64 chunk_size(const pool_allocator* allocator) {
+    return POOL_CHUNK_HEADER_SIZE + (allocator->block_size * allocator->blocks_per_chunk);
+}
+
+/**
+ * @brief Allocates a new chunk and pushes all of its blocks onto the free list.
+ *
+ * @param allocator The pool to grow.
+ * @return True if a chunk was added; False if the pool is at its chunk limit.
+ */
+static b8 pool_allocator_grow(pool_allocator* allocator) {
+    if (allocator->max_chunk_count && allocator->chunk_count >= allocator->max_chunk_count) {
+        return False;
+    }
+
+    u8* chunk = kallocate(chunk_size(allocator), allocator->tag);
+    *(void**)chunk = allocator->chunks;
+    allocator->chunks = chunk;
+    allocator->chunk_count++;
+
+    // Thread the blocks together back to front, so they are handed out in address order.
+    u8* blocks = chunk + POOL_CHUNK_HEADER_SIZE;
+    for (i64 i = (i64)allocator->blocks_per_chunk - 1; i >= 0; --i) {
+        void* block = blocks + (allocator->block_size * i);
+        *(void**)block = allocator->free_list;
+        allocator->free_list = block;
+    }
+
+    return True;
+}
+
+b8 pool_allocator_create(u64 block_size, u32 blocks_per_chunk, u32 max_chunk_count, memory_tag tag, pool_allocator* out_allocator) {
+    if (!out_allocator) {
+        KERROR("pool_allocator_create requires a valid pointer to out_allocator.");
+        return False;
+    }
+
+    if (!block_size || !blocks_per_chunk) {
+        KERROR("pool_allocator_create - block_size and blocks_per_chunk must be a positive non-zero value.");
+        return False;
+    }
+
+    kzero_memory(out_allocator, sizeof(pool_allocator));
+    // Each free block must be able to hold the free list link.
+    out_allocator->block_size = get_aligned(KMAX(block_size, sizeof(void*)), POOL_BLOCK_ALIGNMENT);
+    out_allocator->blocks_per_chunk = blocks_per_chunk;
+    out_allocator->max_chunk_count = max_chunk_count;
+    out_allocator->tag = tag;
+
+    return pool_allocator_grow(out_allocator);
+}
+
+void pool_allocator_destroy(pool_allocator* allocator) {
+    if (allocator) {
+        if (allocator->allocated_count) {
+            KWARN("pool_allocator_destroy - %u blocks of %llu bytes still allocated.", allocator->allocated_count, allocator->block_size);
+        }
+
+        u64 size = chunk_size(allocator);
+        void* chunk = allocator->chunks;
+        while (chunk) {
+            void* next = *(void**)chunk;
+            kfree(chunk, size, allocator->tag);
+            chunk = next;
+        }
+
+        kzero_memory(allocator, sizeof(pool_allocator));
+    }
+}
+
+void* pool_allocator_allocate(pool_allocator* allocator) {
+    if (!allocator || !allocator->block_size) {
+        KFATAL("pool_allocator_allocate, provided allocator not initialized");
+        return 0;
+    }
+
+    if (!allocator->free_list && !pool_allocator_grow(allocator)) {
+        KERROR("pool_allocator_allocate - Pool of %llu byte blocks is out of memory (%u chunks).", allocator->block_size, allocator->chunk_count);
+        return 0;
+    }
+
+    void* block = allocator->free_list;
+    allocator->free_list = *(void**)block;
+    allocator->allocated_count++;
+    if (allocator->allocated_count > allocator->peak_count) {
+        allocator->peak_count = allocator->allocated_count;
+    }
+
+    return block;
+}
+
+void pool_allocator_free(pool_allocator* allocator, void* block) {
+    if (!allocator || !block) {
+        KWARN("pool_allocator_free requires a valid allocator and block.");
+        return;
+    }
+
+    *(void**)block = allocator->free_list;
+    allocator->free_list = block;
+    allocator->allocated_count--;
+}
+
+u32 pool_allocator_capacity(const pool_allocator* allocator) {
+    return allocator ? allocator->chunk_count * allocator->blocks_per_chunk : 0;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "defines.h"
+#include "core/kmemory.h"
+
+/**
+ * @file pool_allocator.h
+ *
+ * @brief Pool allocator for fixed-size blocks.
+ *
+ * Hands out blocks of a single size from larger chunks. Free blocks are kept in an intrusive
+ * singly-linked free list (the link lives in the free block itself), so both allocating and
+ * freeing are O(1) with no per-block bookkeeping. When the free list runs dry, a new chunk is
+ * allocated (if growth is allowed).
+ *
+ * Chunks are allocated with `kallocate()` under the pool's memory_tag, so pool memory shows up
+ * in `get_memory_usage_str()` alongside everything else using that tag.
+ *
+ * NOTE: Not thread-safe. Each pool should only be used from one thread at a time.
+ */
+
+/**
+ * @struct pool_allocator
+ *
+ * @brief Represents a pool allocator. Members should not be modified outside the pool_allocator_ functions.
+ */
+typedef struct pool_allocator {
+    u64 block_size;        // Size of each block, rounded up to the block alignment.
+    u32 blocks_per_chunk;  // Number of blocks carved from each chunk.
+    u32 max_chunk_count;   // Maximum number of chunks. 0 means unlimited.
+    u32 chunk_count;       // Number of chunks currently allocated.
+    u32 allocated_count;   // Number of blocks currently handed out.
+    u32 peak_count;        // Highest allocated_count seen.
+    memory_tag tag;        // Tag chunk memory is allocated with.
+    void* free_list;       // First free block. Each free block holds a pointer to the next.
+    void* chunks;          // First chunk. Each chunk starts with a pointer to the next.
+} pool_allocator;
+
+/**
+ * @brief Creates a pool allocator and allocates its first chunk.
+ *
+ * @param block_size The size of each block in bytes. Rounded up to a multiple of 16.
+ * @param blocks_per_chunk The number of blocks allocated at once each time the pool grows.
+ * @param max_chunk_count The maximum number of chunks the pool may grow to. Pass 1 for a fixed-size pool, or 0 for no limit.
+ * @param tag The memory tag chunk allocations are reported under.
+ * @param out_allocator Pointer to the pool_allocator structure to initialize.
+ * @return True on success; otherwise False.
+ */
+KAPI b8 pool_allocator_create(u64 block_size, u32 blocks_per_chunk, u32 max_chunk_count, memory_tag tag, pool_allocator* out_allocator);
+
+/**
+ * @brief Destroys the pool allocator, freeing all of its chunks.
+ * Any blocks still allocated from the pool become invalid.
+ *
+ * @param allocator Pointer to the pool_allocator structure to destroy.
+ */
+KAPI void pool_allocator_destroy(pool_allocator* allocator);
+
+/**
+ * @brief Allocates a block from the pool. The contents of the block are undefined.
+ *
+ * @param allocator Pointer to the pool_allocator structure to allocate from.
+ * @return Pointer to the allocated block, or 0 if the pool is exhausted and cannot grow.
+ */
+KAPI void* pool_allocator_allocate(pool_allocator* allocator);
+
+/**
+ * @brief Returns a block to the pool.
+ *
+ * @param allocator Pointer to the pool_allocator structure the block was allocated from.
+ * @param block The block to free. Must have come from this pool.
+ */
+KAPI void pool_allocator_free(pool_allocator* allocator, void* block);
+
+/**
+ * @brief Obtains the total number of blocks the pool can currently hand out without growing.
+ *
+ * @param allocator Pointer to the pool_allocator structure to query.
+ * @return The number of blocks across all chunks.
+ */
+KAPI u32 pool_allocator_capacity(const pool_allocator* allocator);
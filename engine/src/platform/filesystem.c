@@ -1,11 +1,32 @@
 #include "filesystem.h"
 
 #include "core/logger.h"
+#include "core/kmemory.h"
+#include "core/kstring.h"
+#include "containers/darray.h"
 
 #include <stdio.h>
 #include <string.h>
 #include <sys/stat.h>
 
+#if KPLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if KPLATFORM_LINUX
+#include <dirent.h>
+#include <errno.h>
+#include <sys/inotify.h>
+#endif
+
+/** @brief The longest path a file watch handles. */
+#define FILE_WATCH_MAX_PATH 512
+
 /**
  * @file filesystem.c
  *
@@ -155,4 +176,310 @@ b8 filesystem_read_all_text(file_handle* handle, char* out_text, u64* out_bytes_
         return *out_bytes_read == size;
     }
     return False;
-}
\ No newline at end of file
+}
+
+b8 filesystem_map(const char* path, file_mapping* out_mapping) {
+    out_mapping->memory = 0;
+    out_mapping->size = 0;
+    out_mapping->handle = 0;
+
+#if KPLATFORM_WINDOWS
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if (file == INVALID_HANDLE_VALUE) {
+        KERROR("Error opening file for mapping: '%s'", path);
+        return False;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        KERROR("Unable to map empty or unreadable file: '%s'", path);
+        CloseHandle(file);
+        return False;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+    // The mapping keeps the file open.
+    CloseHandle(file);
+    if (!mapping) {
+        KERROR("Error mapping file: '%s'", path);
+        return False;
+    }
+
+    void* memory = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!memory) {
+        KERROR("Error mapping view of file: '%s'", path);
+        CloseHandle(mapping);
+        return False;
+    }
+
+    out_mapping->memory = memory;
+    out_mapping->size = (u64)size.QuadPart;
+    out_mapping->handle = mapping;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        KERROR("Error opening file for mapping: '%s'", path);
+        return False;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        KERROR("Unable to map empty or unreadable file: '%s'", path);
+        close(fd);
+        return False;
+    }
+
+    void* memory = mmap(0, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps the file open.
+    close(fd);
+    if (memory == MAP_FAILED) {
+        KERROR("Error mapping file: '%s'", path);
+        return False;
+    }
+
+    out_mapping->memory = memory;
+    out_mapping->size = (u64)info.st_size;
+#endif
+
+    return True;
+}
+
+void filesystem_unmap(file_mapping* mapping) {
+    if (!mapping->memory) {
+        return;
+    }
+
+#if KPLATFORM_WINDOWS
+    UnmapViewOfFile(mapping->memory);
+    CloseHandle((HANDLE)mapping->handle);
+#else
+    munmap((void*)mapping->memory, (size_t)mapping->size);
+#endif
+
+    mapping->memory = 0;
+    mapping->size = 0;
+    mapping->handle = 0;
+}
+
+#if KPLATFORM_LINUX
+
+/**
+ * @struct file_watch_directory
+ * @brief A directory watched by inotify.
+ */
+typedef struct file_watch_directory {
+    // The inotify watch descriptor.
+    i32 descriptor;
+    // The path of the directory relative to the root, or "" for the root itself.
+    char path[FILE_WATCH_MAX_PATH];
+} file_watch_directory;
+
+/**
+ * @struct file_watch_state
+ * @brief The state behind a file_watch.
+ */
+typedef struct file_watch_state {
+    // The inotify instance.
+    i32 fd;
+    // The path of the watched root directory.
+    char root[FILE_WATCH_MAX_PATH];
+    // darray of the watched directories.
+    file_watch_directory* directories;
+} file_watch_state;
+
+/**
+ * @brief Watches a directory, and every directory below it.
+ *
+ * @param state The watch state.
+ * @param relative_path The path of the directory relative to the root, or "" for the root.
+ */
+static void watch_directory(file_watch_state* state, const char* relative_path) {
+    char full_path[FILE_WATCH_MAX_PATH];
+    if (relative_path[0]) {
+        string_nformat(full_path, FILE_WATCH_MAX_PATH, "%s/%s", state->root, relative_path);
+    } else {
+        string_nformat(full_path, FILE_WATCH_MAX_PATH, "%s", state->root);
+    }
+
+    // Editors either write a file in place, or write a copy and move it over the original.
+    u32 mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR;
+    i32 descriptor = inotify_add_watch(state->fd, full_path, mask);
+    if (descriptor == -1) {
+        KWARN("Unable to watch directory '%s'.", full_path);
+        return;
+    }
+
+    file_watch_directory directory;
+    directory.descriptor = descriptor;
+    string_ncopy(directory.path, relative_path, FILE_WATCH_MAX_PATH);
+    directory.path[FILE_WATCH_MAX_PATH - 1] = 0;
+    darray_push(state->directories, directory);
+
+    DIR* dir = opendir(full_path);
+    if (!dir) {
+        return;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != 0) {
+        if (strings_equal(entry->d_name, ".") || strings_equal(entry->d_name, "..")) {
+            continue;
+        }
+
+        // Not every filesystem fills in d_type, so ask.
+        char child_full_path[FILE_WATCH_MAX_PATH];
+        string_nformat(child_full_path, FILE_WATCH_MAX_PATH, "%s/%s", full_path, entry->d_name);
+        struct stat info;
+        if (stat(child_full_path, &info) != 0 || !S_ISDIR(info.st_mode)) {
+            continue;
+        }
+
+        char child[FILE_WATCH_MAX_PATH];
+        if (relative_path[0]) {
+            string_nformat(child, FILE_WATCH_MAX_PATH, "%s/%s", relative_path, entry->d_name);
+        } else {
+            string_nformat(child, FILE_WATCH_MAX_PATH, "%s", entry->d_name);
+        }
+        watch_directory(state, child);
+    }
+    closedir(dir);
+}
+
+/**
+ * @brief Finds the watched directory with a watch descriptor.
+ *
+ * @param state The watch state.
+ * @param descriptor The watch descriptor.
+ * @return The index of the directory, or INVALID_ID if it is not watched.
+ */
+static u32 find_directory(file_watch_state* state, i32 descriptor) {
+    u32 count = (u32)darray_length(state->directories);
+    for (u32 i = 0; i < count; ++i) {
+        if (state->directories[i].descriptor == descriptor) {
+            return i;
+        }
+    }
+    return INVALID_ID;
+}
+
+b8 filesystem_watch_create(const char* path, file_watch* out_watch) {
+    out_watch->internal_data = 0;
+
+    i32 fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd == -1) {
+        KERROR("Unable to create a file watch for '%s'.", path);
+        return False;
+    }
+
+    file_watch_state* state = kallocate(sizeof(file_watch_state), MEMORY_TAG_APPLICATION);
+    state->fd = fd;
+    string_ncopy(state->root, path, FILE_WATCH_MAX_PATH);
+    state->root[FILE_WATCH_MAX_PATH - 1] = 0;
+    state->directories = darray_create(file_watch_directory);
+
+    watch_directory(state, "");
+    if (darray_length(state->directories) == 0) {
+        KERROR("Unable to watch directory '%s'.", path);
+        darray_destroy(state->directories);
+        close(fd);
+        kfree(state, sizeof(file_watch_state), MEMORY_TAG_APPLICATION);
+        return False;
+    }
+
+    out_watch->internal_data = state;
+    return True;
+}
+
+void filesystem_watch_destroy(file_watch* watch) {
+    file_watch_state* state = watch->internal_data;
+    if (!state) {
+        return;
+    }
+
+    // Closing the instance removes every watch.
+    close(state->fd);
+    darray_destroy(state->directories);
+    kfree(state, sizeof(file_watch_state), MEMORY_TAG_APPLICATION);
+    watch->internal_data = 0;
+}
+
+u32 filesystem_watch_poll(file_watch* watch, pfn_file_changed callback, void* listener) {
+    file_watch_state* state = watch->internal_data;
+    if (!state) {
+        return 0;
+    }
+
+    u32 reported = 0;
+    // Events are variable length, each holding a name after a struct inotify_event.
+    _Alignas(struct inotify_event) char buffer[4096];
+    for (;;) {
+        ssize_t length = read(state->fd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            if (length == -1 && errno != EAGAIN && errno != EINTR) {
+                KWARN("Reading file watch events failed.");
+            }
+            break;
+        }
+
+        for (char* p = buffer; p < buffer + length;) {
+            const struct inotify_event* event = (const struct inotify_event*)p;
+            p += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                KWARN("File watch events overflowed; some changes were missed.");
+                continue;
+            }
+
+            u32 index = find_directory(state, event->wd);
+            if (index == INVALID_ID) {
+                continue;
+            }
+
+            if (event->mask & IN_IGNORED) {
+                // The directory was removed, taking its watch with it.
+                file_watch_directory removed;
+                darray_pop_at(state->directories, index, &removed);
+                continue;
+            }
+            if (!event->len) {
+                continue;
+            }
+
+            char path[FILE_WATCH_MAX_PATH];
+            const char* directory = state->directories[index].path;
+            if (directory[0]) {
+                string_nformat(path, FILE_WATCH_MAX_PATH, "%s/%s", directory, event->name);
+            } else {
+                string_nformat(path, FILE_WATCH_MAX_PATH, "%s", event->name);
+            }
+
+            if (event->mask & IN_ISDIR) {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    watch_directory(state, path);
+                }
+            } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                callback(path, listener);
+                reported++;
+            }
+        }
+    }
+
+    return reported;
+}
+
+#else
+
+b8 filesystem_watch_create(const char* path, file_watch* out_watch) {
+    out_watch->internal_data = 0;
+    KWARN("File watching is not supported on this platform; '%s' will not be watched.", path);
+    return False;
+}
+
+void filesystem_watch_destroy(file_watch* watch) {
+    watch->internal_data = 0;
+}
+
+u32 filesystem_watch_poll(file_watch* watch, pfn_file_changed callback, void* listener) {
+    return 0;
+}
+
+#endif
@@ -23,6 +23,38 @@ typedef struct file_handle {
     b8 is_valid;
 } file_handle;
 
+/**
+ * @struct file_mapping
+ *
+ * @brief A read-only view of a whole file, mapped into memory.
+ */
+typedef struct file_mapping {
+    // The start of the mapped file, or 0 if nothing is mapped.
+    const void* memory;
+    // The size of the file in bytes.
+    u64 size;
+    // Opaque handle to the platform's mapping object, where it needs one.
+    void* handle;
+} file_mapping;
+
+/**
+ * @struct file_watch
+ *
+ * @brief Watches a directory tree for files that are written.
+ */
+typedef struct file_watch {
+    // Opaque pointer to the platform's watch state.
+    void* internal_data;
+} file_watch;
+
+/**
+ * @brief Called for each file that has been written since the last poll.
+ *
+ * @param path The path of the file, relative to the watched directory and using '/'.
+ * @param listener The listener given to the poll.
+ */
+typedef void (*pfn_file_changed)(const char* path, void* listener);
+
 /**
  * @enum file_modes
  *
@@ -123,4 +155,45 @@ KAPI b8 filesystem_write(file_handle* handle, u64 data_size, const void* data, u
  * @param out_bytes_read A pointer to a number which will be populated with the number of bytes actually read from the file.
  * @returns True if successful; otherwise false.
  */
-KAPI b8 filesystem_read_all_text(file_handle* handle, char* out_text, u64* out_bytes_read);
\ No newline at end of file
+KAPI b8 filesystem_read_all_text(file_handle* handle, char* out_text, u64* out_bytes_read);
+
+/**
+ * Maps the whole file located at path into memory for reading. Pages are read in by the
+ * operating system as they are touched, and are shared by every process mapping the file.
+ * @param path The path of the file to be mapped.
+ * @param out_mapping A pointer to a file_mapping structure which holds the mapping information.
+ * @returns True if mapped successfully; otherwise false. Empty files cannot be mapped.
+ */
+KAPI b8 filesystem_map(const char* path, file_mapping* out_mapping);
+
+/**
+ * Unmaps a file mapped with filesystem_map. Pointers into the mapping are invalid afterward.
+ * @param mapping A pointer to the file_mapping structure to be unmapped.
+ */
+KAPI void filesystem_unmap(file_mapping* mapping);
+
+/**
+ * Starts watching the directory at path, and every directory below it, for files that are
+ * written or moved in. Directories created later are watched as they appear.
+ * NOTE: Only supported on Linux, where it uses inotify.
+ * @param path The path of the directory to watch.
+ * @param out_watch A pointer to a file_watch structure which holds the watch.
+ * @returns True if the directory is being watched; otherwise false.
+ */
+KAPI b8 filesystem_watch_create(const char* path, file_watch* out_watch);
+
+/**
+ * Stops watching and releases the watch.
+ * @param watch A pointer to the file_watch structure to be destroyed.
+ */
+KAPI void filesystem_watch_destroy(file_watch* watch);
+
+/**
+ * Reports each file written since the last poll, without blocking. A file written several
+ * times may be reported several times.
+ * @param watch A pointer to the file_watch structure.
+ * @param callback Called with the path of each file written.
+ * @param listener Passed to the callback. May be 0.
+ * @returns The number of files reported.
+ */
+KAPI u32 filesystem_watch_poll(file_watch* watch, pfn_file_changed callback, void* listener);
@@ -11,6 +11,10 @@
  * - Input handling (keyboard, mouse)
  * - Time and sleep functions
  * - Memory allocation and manipulation
+ * - Processor information
+ *
+ * Threads, mutexes and semaphores are declared in core/kthread.h, core/kmutex.h and
+ * core/ksemaphore.h, but are also implemented by each platform file.
  *
  * Implemented separately for each OS (e.g., Win32, Linux).
  */
@@ -147,4 +151,13 @@ f64 platform_get_absolute_time();
  *
  * @param ms The number of milliseconds to sleep.
  */
-void platform_sleep(u64 ms);
\ No newline at end of file
+void platform_sleep(u64 ms);
+
+/**
+ * @brief Obtains the number of logical processor cores available to the application.
+ *
+ * Used to decide how many worker threads to spin up.
+ *
+ * @return The number of logical processor cores. Always at least 1.
+ */
+i32 platform_get_processor_count();
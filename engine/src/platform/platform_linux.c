@@ -1,10 +1,13 @@
-#define _POSIX_C_SOURCE 199309L  // Enables clock_gettime, CLOCK_MONOTONIC
+#define _POSIX_C_SOURCE 200809L  // Enables clock_gettime, CLOCK_MONOTONIC, pthreads and sysconf
 
 #include "platform.h"
 #include "containers/darray.h"
 #include "core/input.h"
 #include "core/logger.h"  // Custom logging system used in engine/application
 #include "core/event.h"
+#include "core/kthread.h"
+#include "core/kmutex.h"
+#include "core/ksemaphore.h"
 
 /**
  * @file platform_linux.c
@@ -15,6 +18,7 @@
  * - Input device polling
  * - Memory allocation and manipulation
  * - Timing and sleep functions
+ * - Threads, mutexes and semaphores (pthreads)
  */
 
 // Linux platform layer.
@@ -37,6 +41,13 @@
 #include <unistd.h>  // usleep (less precise but older alternative)
 #endif
 
+// Threading
+#include <pthread.h>    // Threads and mutexes
+#include <semaphore.h>  // Counting semaphores
+#include <sched.h>      // sched_yield
+#include <unistd.h>     // sysconf
+#include <errno.h>      // EINTR
+
 // Standard C libraries
 #include <stdlib.h>  // malloc, free, etc.
 #include <stdio.h>   // printf
@@ -527,6 +538,171 @@ void platform_sleep(u64 ms) {
 #endif
 }
 
+i32 platform_get_processor_count() {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (i32)count : 1;
+}
+
+// NOTE: Begin threads.
+
+b8 kthread_create(pfn_thread_start start_function_ptr, void* params, b8 auto_detach, kthread* out_thread) {
+    if (!start_function_ptr) {
+        return False;
+    }
+
+    // pthread_create uses a function pointer that returns void*, so cold-cast to this type.
+    pthread_t thread_id;
+    i32 result = pthread_create(&thread_id, 0, (void* (*)(void*))start_function_ptr, params);
+    if (result != 0) {
+        KERROR("kthread_create - pthread_create failed with error code %i.", result);
+        return False;
+    }
+
+    if (auto_detach) {
+        pthread_detach(thread_id);
+        return True;
+    }
+
+    out_thread->thread_id = (u64)thread_id;
+    out_thread->internal_data = platform_allocate(sizeof(pthread_t), False);
+    *(pthread_t*)out_thread->internal_data = thread_id;
+    return True;
+}
+
+void kthread_destroy(kthread* thread) {
+    if (thread && thread->internal_data) {
+        platform_free(thread->internal_data, False);
+        thread->internal_data = 0;
+        thread->thread_id = 0;
+    }
+}
+
+void kthread_detach(kthread* thread) {
+    if (thread && thread->internal_data) {
+        i32 result = pthread_detach(*(pthread_t*)thread->internal_data);
+        if (result != 0) {
+            KERROR("kthread_detach - pthread_detach failed with error code %i.", result);
+        }
+        kthread_destroy(thread);
+    }
+}
+
+b8 kthread_wait(kthread* thread) {
+    if (thread && thread->internal_data) {
+        i32 result = pthread_join(*(pthread_t*)thread->internal_data, 0);
+        if (result != 0) {
+            KERROR("kthread_wait - pthread_join failed with error code %i.", result);
+            return False;
+        }
+        return True;
+    }
+    return False;
+}
+
+u64 kthread_get_id() {
+    return (u64)pthread_self();
+}
+
+void kthread_yield() {
+    sched_yield();
+}
+
+// NOTE: End threads.
+
+// NOTE: Begin mutexes.
+
+b8 kmutex_create(kmutex* out_mutex) {
+    if (!out_mutex) {
+        return False;
+    }
+
+    pthread_mutex_t* mutex = platform_allocate(sizeof(pthread_mutex_t), False);
+    i32 result = pthread_mutex_init(mutex, 0);
+    if (result != 0) {
+        KERROR("kmutex_create - pthread_mutex_init failed with error code %i.", result);
+        platform_free(mutex, False);
+        return False;
+    }
+
+    out_mutex->internal_data = mutex;
+    return True;
+}
+
+void kmutex_destroy(kmutex* mutex) {
+    if (mutex && mutex->internal_data) {
+        pthread_mutex_destroy(mutex->internal_data);
+        platform_free(mutex->internal_data, False);
+        mutex->internal_data = 0;
+    }
+}
+
+b8 kmutex_lock(kmutex* mutex) {
+    if (!mutex || !mutex->internal_data) {
+        return False;
+    }
+    return pthread_mutex_lock(mutex->internal_data) == 0;
+}
+
+b8 kmutex_unlock(kmutex* mutex) {
+    if (!mutex || !mutex->internal_data) {
+        return False;
+    }
+    return pthread_mutex_unlock(mutex->internal_data) == 0;
+}
+
+// NOTE: End mutexes.
+
+// NOTE: Begin semaphores.
+
+b8 ksemaphore_create(ksemaphore* out_semaphore, u32 max_count, u32 start_count) {
+    if (!out_semaphore) {
+        return False;
+    }
+
+    // NOTE: POSIX semaphores have no maximum count, so max_count is ignored.
+    sem_t* semaphore = platform_allocate(sizeof(sem_t), False);
+    if (sem_init(semaphore, 0, start_count) != 0) {
+        KERROR("ksemaphore_create - sem_init failed.");
+        platform_free(semaphore, False);
+        return False;
+    }
+
+    out_semaphore->internal_data = semaphore;
+    return True;
+}
+
+void ksemaphore_destroy(ksemaphore* semaphore) {
+    if (semaphore && semaphore->internal_data) {
+        sem_destroy(semaphore->internal_data);
+        platform_free(semaphore->internal_data, False);
+        semaphore->internal_data = 0;
+    }
+}
+
+b8 ksemaphore_signal(ksemaphore* semaphore) {
+    if (!semaphore || !semaphore->internal_data) {
+        return False;
+    }
+    return sem_post(semaphore->internal_data) == 0;
+}
+
+b8 ksemaphore_wait(ksemaphore* semaphore) {
+    if (!semaphore || !semaphore->internal_data) {
+        return False;
+    }
+
+    // Retry if interrupted by a signal.
+    while (sem_wait(semaphore->internal_data) != 0) {
+        if (errno != EINTR) {
+            KERROR("ksemaphore_wait - sem_wait failed with errno %i.", errno);
+            return False;
+        }
+    }
+    return True;
+}
+
+// NOTE: End semaphores.
+
 // Surface creation for VulkanAdd commentMore actions
 b8 platform_create_vulkan_surface(vulkan_context* context) {
     if(!state_ptr) {
@@ -9,6 +9,7 @@
  * - Input device polling (keyboard, mouse)
  * - Memory allocation and manipulation
  * - Timing and sleep functions
+ * - Threads, mutexes (pthreads) and semaphores (libdispatch)
  * Uses GLFW for windowing and input handling.
  */
 
@@ -19,6 +20,9 @@
 #include "core/input.h"
 #include "core/kstring.h"
 #include "core/logger.h"
+#include "core/kthread.h"
+#include "core/kmutex.h"
+#include "core/ksemaphore.h"
 #include "renderer/vulkan/vulkan_types.inl"  // For surface creation.
 
 // Include Vulkan before GLFW.
@@ -33,6 +37,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <dispatch/dispatch.h>  // Unnamed POSIX semaphores are not supported on macOS.
 
 typedef struct platform_state {
     GLFWwindow* glfw_window;
@@ -163,6 +171,146 @@ void platform_sleep(u64 ms) {
     nanosleep(&ts, 0);
 }
 
+i32 platform_get_processor_count() {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (i32)count : 1;
+}
+
+// NOTE: Begin threads.
+
+b8 kthread_create(pfn_thread_start start_function_ptr, void* params, b8 auto_detach, kthread* out_thread) {
+    if (!start_function_ptr) {
+        return False;
+    }
+
+    // pthread_create uses a function pointer that returns void*, so cold-cast to this type.
+    pthread_t thread_id;
+    i32 result = pthread_create(&thread_id, 0, (void* (*)(void*))start_function_ptr, params);
+    if (result != 0) {
+        KERROR("kthread_create - pthread_create failed with error code %i.", result);
+        return False;
+    }
+
+    if (auto_detach) {
+        pthread_detach(thread_id);
+        return True;
+    }
+
+    out_thread->thread_id = (u64)thread_id;
+    out_thread->internal_data = platform_allocate(sizeof(pthread_t), False);
+    *(pthread_t*)out_thread->internal_data = thread_id;
+    return True;
+}
+
+void kthread_destroy(kthread* thread) {
+    if (thread && thread->internal_data) {
+        platform_free(thread->internal_data, False);
+        thread->internal_data = 0;
+        thread->thread_id = 0;
+    }
+}
+
+void kthread_detach(kthread* thread) {
+    if (thread && thread->internal_data) {
+        pthread_detach(*(pthread_t*)thread->internal_data);
+        kthread_destroy(thread);
+    }
+}
+
+b8 kthread_wait(kthread* thread) {
+    if (thread && thread->internal_data) {
+        return pthread_join(*(pthread_t*)thread->internal_data, 0) == 0;
+    }
+    return False;
+}
+
+u64 kthread_get_id() {
+    return (u64)pthread_self();
+}
+
+void kthread_yield() {
+    sched_yield();
+}
+
+// NOTE: End threads.
+
+// NOTE: Begin mutexes.
+
+b8 kmutex_create(kmutex* out_mutex) {
+    if (!out_mutex) {
+        return False;
+    }
+
+    pthread_mutex_t* mutex = platform_allocate(sizeof(pthread_mutex_t), False);
+    if (pthread_mutex_init(mutex, 0) != 0) {
+        KERROR("kmutex_create - pthread_mutex_init failed.");
+        platform_free(mutex, False);
+        return False;
+    }
+
+    out_mutex->internal_data = mutex;
+    return True;
+}
+
+void kmutex_destroy(kmutex* mutex) {
+    if (mutex && mutex->internal_data) {
+        pthread_mutex_destroy(mutex->internal_data);
+        platform_free(mutex->internal_data, False);
+        mutex->internal_data = 0;
+    }
+}
+
+b8 kmutex_lock(kmutex* mutex) {
+    if (!mutex || !mutex->internal_data) {
+        return False;
+    }
+    return pthread_mutex_lock(mutex->internal_data) == 0;
+}
+
+b8 kmutex_unlock(kmutex* mutex) {
+    if (!mutex || !mutex->internal_data) {
+        return False;
+    }
+    return pthread_mutex_unlock(mutex->internal_data) == 0;
+}
+
+// NOTE: End mutexes.
+
+// NOTE: Begin semaphores.
+
+b8 ksemaphore_create(ksemaphore* out_semaphore, u32 max_count, u32 start_count) {
+    if (!out_semaphore) {
+        return False;
+    }
+
+    out_semaphore->internal_data = dispatch_semaphore_create(start_count);
+    return out_semaphore->internal_data != 0;
+}
+
+void ksemaphore_destroy(ksemaphore* semaphore) {
+    if (semaphore && semaphore->internal_data) {
+        dispatch_release((dispatch_semaphore_t)semaphore->internal_data);
+        semaphore->internal_data = 0;
+    }
+}
+
+b8 ksemaphore_signal(ksemaphore* semaphore) {
+    if (!semaphore || !semaphore->internal_data) {
+        return False;
+    }
+    dispatch_semaphore_signal((dispatch_semaphore_t)semaphore->internal_data);
+    return True;
+}
+
+b8 ksemaphore_wait(ksemaphore* semaphore) {
+    if (!semaphore || !semaphore->internal_data) {
+        return False;
+    }
+    return dispatch_semaphore_wait((dispatch_semaphore_t)semaphore->internal_data, DISPATCH_TIME_FOREVER) == 0;
+}
+
+// NOTE: End semaphores.
+
 void platform_get_required_extension_names(const char*** names_darray) {
     u32 count = 0;
     const char** extensions = glfwGetRequiredInstanceExtensions(&count);
@@ -15,6 +15,9 @@
 #include "core/input.h"
 #include "containers/darray.h"
 #include "core/event.h"
+#include "core/kthread.h"
+#include "core/kmutex.h"
+#include "core/ksemaphore.h"
 #include <windows.h>
 #include <windowsx.h>  // param input extraction
 #include <stdlib.h>
@@ -223,6 +226,141 @@ void platform_sleep(u64 ms) {
     Sleep(ms);
 }
 
+i32 platform_get_processor_count() {
+    SYSTEM_INFO sysinfo;
+    GetSystemInfo(&sysinfo);
+    return sysinfo.dwNumberOfProcessors > 0 ? (i32)sysinfo.dwNumberOfProcessors : 1;
+}
+
+// NOTE: Begin threads.
+
+b8 kthread_create(pfn_thread_start start_function_ptr, void *params, b8 auto_detach, kthread *out_thread) {
+    if (!start_function_ptr) {
+        return False;
+    }
+
+    DWORD thread_id = 0;
+    HANDLE handle = CreateThread(0, 0, (LPTHREAD_START_ROUTINE)start_function_ptr, params, 0, &thread_id);
+    if (!handle) {
+        KERROR("kthread_create - CreateThread failed with error code %u.", GetLastError());
+        return False;
+    }
+
+    if (auto_detach) {
+        CloseHandle(handle);
+        return True;
+    }
+
+    out_thread->thread_id = thread_id;
+    out_thread->internal_data = handle;
+    return True;
+}
+
+void kthread_destroy(kthread *thread) {
+    if (thread && thread->internal_data) {
+        CloseHandle((HANDLE)thread->internal_data);
+        thread->internal_data = 0;
+        thread->thread_id = 0;
+    }
+}
+
+void kthread_detach(kthread *thread) {
+    kthread_destroy(thread);
+}
+
+b8 kthread_wait(kthread *thread) {
+    if (thread && thread->internal_data) {
+        return WaitForSingleObject((HANDLE)thread->internal_data, INFINITE) == WAIT_OBJECT_0;
+    }
+    return False;
+}
+
+u64 kthread_get_id() {
+    return (u64)GetCurrentThreadId();
+}
+
+void kthread_yield() {
+    SwitchToThread();
+}
+
+// NOTE: End threads.
+
+// NOTE: Begin mutexes.
+
+b8 kmutex_create(kmutex *out_mutex) {
+    if (!out_mutex) {
+        return False;
+    }
+
+    out_mutex->internal_data = CreateMutex(0, 0, 0);
+    if (!out_mutex->internal_data) {
+        KERROR("kmutex_create - CreateMutex failed with error code %u.", GetLastError());
+        return False;
+    }
+    return True;
+}
+
+void kmutex_destroy(kmutex *mutex) {
+    if (mutex && mutex->internal_data) {
+        CloseHandle((HANDLE)mutex->internal_data);
+        mutex->internal_data = 0;
+    }
+}
+
+b8 kmutex_lock(kmutex *mutex) {
+    if (!mutex || !mutex->internal_data) {
+        return False;
+    }
+    return WaitForSingleObject((HANDLE)mutex->internal_data, INFINITE) == WAIT_OBJECT_0;
+}
+
+b8 kmutex_unlock(kmutex *mutex) {
+    if (!mutex || !mutex->internal_data) {
+        return False;
+    }
+    return ReleaseMutex((HANDLE)mutex->internal_data) != 0;
+}
+
+// NOTE: End mutexes.
+
+// NOTE: Begin semaphores.
+
+b8 ksemaphore_create(ksemaphore *out_semaphore, u32 max_count, u32 start_count) {
+    if (!out_semaphore) {
+        return False;
+    }
+
+    out_semaphore->internal_data = CreateSemaphore(0, start_count, max_count, 0);
+    if (!out_semaphore->internal_data) {
+        KERROR("ksemaphore_create - CreateSemaphore failed with error code %u.", GetLastError());
+        return False;
+    }
+    return True;
+}
+
+void ksemaphore_destroy(ksemaphore *semaphore) {
+    if (semaphore && semaphore->internal_data) {
+        CloseHandle((HANDLE)semaphore->internal_data);
+        semaphore->internal_data = 0;
+    }
+}
+
+b8 ksemaphore_signal(ksemaphore *semaphore) {
+    if (!semaphore || !semaphore->internal_data) {
+        return False;
+    }
+    return ReleaseSemaphore((HANDLE)semaphore->internal_data, 1, 0) != 0;
+}
+
+b8 ksemaphore_wait(ksemaphore *semaphore) {
+    if (!semaphore || !semaphore->internal_data) {
+        return False;
+    }
+    return WaitForSingleObject((HANDLE)semaphore->internal_data, INFINITE) == WAIT_OBJECT_0;
+}
+
+// NOTE: End semaphores.
+
 void platform_get_required_extension_names(const char ***names_darray) {
     darray_push(*names_darray, &"VK_KHR_win32_surface");
 }
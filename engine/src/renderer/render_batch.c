@@ -0,0 +1,111 @@
+#include "render_batch.h"
+
+#include "core/kmemory.h"
+
+/**
+ * @file render_batch.c
+ * @brief Implementation of draw sorting and batching.
+ */
+
+/** @brief The pipeline every geometry is drawn with until there is more than one. */
+#define RENDER_BATCH_DEFAULT_PIPELINE 0
+
+/** @brief A geometry's sort key and its index in the submitted array. */
+typedef struct render_sort_item {
+    u64 key;
+    u32 index;
+} render_sort_item;
+
+u64 render_batch_scratch_size(u32 geometry_count) {
+    // The items, and a second array to sort them into.
+    return sizeof(render_sort_item) * geometry_count * 2;
+}
+
+/**
+ * @brief Sorts items by key, keeping equal keys in order. Returns whichever of the two arrays
+ * holds the sorted items.
+ */
+static render_sort_item* radix_sort(render_sort_item* items, render_sort_item* temp, u32 count) {
+    // Bytes that are the same in every key do not affect the order, so their passes are skipped.
+    u64 differing = 0;
+    for (u32 i = 1; i < count; ++i) {
+        differing |= items[i].key ^ items[0].key;
+    }
+
+    for (u32 shift = 0; shift < 64; shift += 8) {
+        if (((differing >> shift) & 0xFF) == 0) {
+            continue;
+        }
+
+        u32 offsets[256];
+        kzero_memory(offsets, sizeof(offsets));
+        for (u32 i = 0; i < count; ++i) {
+            offsets[(items[i].key >> shift) & 0xFF]++;
+        }
+
+        u32 total = 0;
+        for (u32 b = 0; b < 256; ++b) {
+            u32 bucket_count = offsets[b];
+            offsets[b] = total;
+            total += bucket_count;
+        }
+
+        for (u32 i = 0; i < count; ++i) {
+            temp[offsets[(items[i].key >> shift) & 0xFF]++] = items[i];
+        }
+
+        render_sort_item* swap = items;
+        items = temp;
+        temp = swap;
+    }
+
+    return items;
+}
+
+u32 render_batch_build(
+    const geometry_render_data* geometries,
+    u32 geometry_count,
+    material* default_material,
+    void* scratch,
+    mat4* out_transforms,
+    render_batch* out_batches) {
+    render_sort_item* items = scratch;
+    render_sort_item* temp = items + geometry_count;
+
+    u32 item_count = 0;
+    for (u32 i = 0; i < geometry_count; ++i) {
+        const geometry* g = geometries[i].geometry;
+        if (!g || g->internal_id == INVALID_ID) {
+            continue;
+        }
+
+        material* m = g->material ? g->material : default_material;
+        items[item_count].key = render_batch_key_create(RENDER_BATCH_DEFAULT_PIPELINE, m ? m->id : 0, g->id);
+        items[item_count].index = i;
+        item_count++;
+    }
+
+    if (item_count == 0) {
+        return 0;
+    }
+
+    render_sort_item* sorted = radix_sort(items, temp, item_count);
+
+    // Runs of equal keys are instances of one geometry with one material.
+    u32 batch_count = 0;
+    for (u32 i = 0; i < item_count; ++i) {
+        const geometry_render_data* data = &geometries[sorted[i].index];
+        out_transforms[i] = data->model;
+
+        if (i == 0 || sorted[i].key != sorted[i - 1].key) {
+            render_batch* batch = &out_batches[batch_count++];
+            batch->geometry = data->geometry;
+            batch->material = data->geometry->material ? data->geometry->material : default_material;
+            batch->first_instance = i;
+            batch->instance_count = 0;
+        }
+        out_batches[batch_count - 1].instance_count++;
+    }
+
+    return batch_count;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "renderer_types.inl"
+
+/**
+ * @file render_batch.h
+ * @brief Sorts the geometries of a frame by render state and merges them into instanced batches.
+ *
+ * Each geometry is given a 64-bit sort key, most significant first: the pipeline, then the
+ * material, then the geometry. Sorting by the key puts draws that share state next to each other,
+ * so the backend only binds what changes between batches. Draws with the same key differ only in
+ * their transform, so each run of equal keys becomes one instanced draw.
+ *
+ * The keys are sorted with an LSD radix sort, one byte per pass, skipping the passes in which
+ * every key has the same byte. Equal keys keep their submission order.
+ */
+
+/** @brief Bits of the sort key holding the pipeline. */
+#define RENDER_BATCH_KEY_PIPELINE_BITS 8
+
+/** @brief Bits of the sort key holding the material. */
+#define RENDER_BATCH_KEY_MATERIAL_BITS 24
+
+/** @brief Bits of the sort key holding the geometry. */
+#define RENDER_BATCH_KEY_GEOMETRY_BITS 32
+
+/**
+ * @brief Creates a sort key. Each id is truncated to the bits available for it.
+ *
+ * @param pipeline_id The pipeline the geometry is drawn with.
+ * @param material_id The id of the material the geometry is drawn with.
+ * @param geometry_id The id of the geometry.
+ * @return The sort key.
+ */
+KINLINE u64 render_batch_key_create(u32 pipeline_id, u32 material_id, u32 geometry_id) {
+    u64 pipeline = (u64)(pipeline_id & ((1u << RENDER_BATCH_KEY_PIPELINE_BITS) - 1));
+    u64 material = (u64)(material_id & ((1u << RENDER_BATCH_KEY_MATERIAL_BITS) - 1));
+    return (pipeline << (RENDER_BATCH_KEY_MATERIAL_BITS + RENDER_BATCH_KEY_GEOMETRY_BITS)) |
+           (material << RENDER_BATCH_KEY_GEOMETRY_BITS) |
+           (u64)geometry_id;
+}
+
+/**
+ * @brief Obtains the size of the scratch memory render_batch_build() needs to sort the given
+ * number of geometries.
+ *
+ * @param geometry_count The number of geometries.
+ * @return The size of the scratch memory in bytes.
+ */
+KAPI u64 render_batch_scratch_size(u32 geometry_count);
+
+/**
+ * @brief Sorts geometries by render state and merges them into instanced batches.
+ *
+ * Geometries not yet uploaded to the backend (with an internal_id of INVALID_ID) are skipped.
+ *
+ * @param geometries The geometries to draw.
+ * @param geometry_count The number of geometries.
+ * @param default_material The material used by geometries that do not have one.
+ * @param scratch A block of render_batch_scratch_size() bytes, aligned to 8 bytes.
+ * @param out_transforms An array of at least geometry_count matrices to hold the transforms of
+ * every instance, in batch order.
+ * @param out_batches An array of at least geometry_count batches to hold the batches, in key order.
+ * @return The number of batches.
+ */
+KAPI u32 render_batch_build(
+    const geometry_render_data* geometries,
+    u32 geometry_count,
+    material* default_material,
+    void* scratch,
+    mat4* out_transforms,
+    render_batch* out_batches);
@@ -0,0 +1,194 @@
+#include "render_cull.h"
+
+#include "math/kmath.h"
+
+/**
+ * @file render_cull.c
+ * @brief Implementation of frustum culling.
+ *
+ * Model matrices put points in rows (p' = p * model), so the rows of the upper 3x3 are the
+ * model's basis vectors and row 3 is its translation. Moving the bounds into world space:
+ * - Centres are transformed as points.
+ * - Box half extents become the sum of the absolute basis vectors scaled by each extent.
+ * - Sphere radii are scaled by the longest basis vector, which covers non-uniform scale.
+ */
+
+frustum render_cull_frustum_create(mat4 view_projection) {
+    // Gribb and Hartmann: clip = p * view_projection, so each clip coordinate is a column of the
+    // matrix, and each plane is the w column plus or minus another one.
+    const f32* m = view_projection.data;
+    frustum f;
+    for (u32 i = 0; i < 3; ++i) {
+        for (u32 side = 0; side < 2; ++side) {
+            f32 sign = side == 0 ? 1.0f : -1.0f;
+            vec4 plane = vec4_create(
+                m[3] + sign * m[i],
+                m[7] + sign * m[4 + i],
+                m[11] + sign * m[8 + i],
+                m[15] + sign * m[12 + i]);
+            f32 length = ksqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+            f.planes[i * 2 + side] = length > 0.0f ? vec4_create(plane.x / length, plane.y / length, plane.z / length, plane.w / length) : plane;
+        }
+    }
+    return f;
+}
+
+#if !KSIMD_ENABLED
+/** @brief Tests one geometry. Matches outside_mask_simd(). */
+static b8 is_visible_scalar(const frustum* f, const geometry_render_data* data) {
+    const geometry* g = data->geometry;
+    const f32* m = data->model.data;
+
+    vec3 box_center = vec3_mul_scalar(vec3_add(g->extents.min, g->extents.max), 0.5f);
+    vec3 half_extents = vec3_mul_scalar(vec3_sub(g->extents.max, g->extents.min), 0.5f);
+    vec3 box_world;
+    vec3 sphere_world;
+    vec3 extents_world;
+    for (u32 j = 0; j < 3; ++j) {
+        box_world.elements[j] = box_center.x * m[j] + box_center.y * m[4 + j] + box_center.z * m[8 + j] + m[12 + j];
+        sphere_world.elements[j] = g->center.x * m[j] + g->center.y * m[4 + j] + g->center.z * m[8 + j] + m[12 + j];
+        extents_world.elements[j] = half_extents.x * kabs(m[j]) + half_extents.y * kabs(m[4 + j]) + half_extents.z * kabs(m[8 + j]);
+    }
+
+    f32 scale_squared = 0.0f;
+    for (u32 i = 0; i < 3; ++i) {
+        scale_squared = KMAX(scale_squared, m[i * 4] * m[i * 4] + m[i * 4 + 1] * m[i * 4 + 1] + m[i * 4 + 2] * m[i * 4 + 2]);
+    }
+    f32 radius_world = g->radius * ksqrt(scale_squared);
+
+    for (u32 p = 0; p < 6; ++p) {
+        vec4 plane = f->planes[p];
+        f32 box_distance = plane.x * box_world.x + plane.y * box_world.y + plane.z * box_world.z + plane.w;
+        f32 box_reach = kabs(plane.x) * extents_world.x + kabs(plane.y) * extents_world.y + kabs(plane.z) * extents_world.z;
+        f32 sphere_distance = plane.x * sphere_world.x + plane.y * sphere_world.y + plane.z * sphere_world.z + plane.w;
+        if (box_distance + box_reach < 0.0f || sphere_distance + radius_world < 0.0f) {
+            return False;
+        }
+    }
+    return True;
+}
+#else
+/** @brief The planes of a frustum, each component splatted across a vector. */
+typedef struct cull_planes {
+    f32x4 x[6];
+    f32x4 y[6];
+    f32x4 z[6];
+    f32x4 w[6];
+    f32x4 abs_x[6];
+    f32x4 abs_y[6];
+    f32x4 abs_z[6];
+} cull_planes;
+
+/**
+ * @brief Tests up to four geometries at once, one per lane.
+ * Returns a mask with bit i set when geometry i is outside the frustum.
+ */
+static u32 outside_mask_simd(const cull_planes* planes, const geometry_render_data* const* group, u32 count) {
+    f32x4 zero = f32x4_splat(0.0f);
+    f32x4 box[4] = {zero, zero, zero, zero};
+    f32x4 sphere[4] = {zero, zero, zero, zero};
+    f32x4 extents[4] = {zero, zero, zero, zero};
+    f32 radii[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+    // World bounds of each geometry, one vector each.
+    for (u32 i = 0; i < count; ++i) {
+        const geometry* g = group[i]->geometry;
+        const f32* m = group[i]->model.data;
+        f32x4 r_0 = f32x4_load(m);
+        f32x4 r_1 = f32x4_load(m + 4);
+        f32x4 r_2 = f32x4_load(m + 8);
+        f32x4 r_3 = f32x4_load(m + 12);
+
+        f32 half = 0.5f;
+        box[i] = f32x4_madd(f32x4_splat((g->extents.min.x + g->extents.max.x) * half), r_0,
+                            f32x4_madd(f32x4_splat((g->extents.min.y + g->extents.max.y) * half), r_1,
+                                       f32x4_madd(f32x4_splat((g->extents.min.z + g->extents.max.z) * half), r_2, r_3)));
+        sphere[i] = f32x4_madd(f32x4_splat(g->center.x), r_0,
+                               f32x4_madd(f32x4_splat(g->center.y), r_1,
+                                          f32x4_madd(f32x4_splat(g->center.z), r_2, r_3)));
+        extents[i] = f32x4_madd(f32x4_splat((g->extents.max.x - g->extents.min.x) * half), f32x4_abs(r_0),
+                                f32x4_madd(f32x4_splat((g->extents.max.y - g->extents.min.y) * half), f32x4_abs(r_1),
+                                           f32x4_mul(f32x4_splat((g->extents.max.z - g->extents.min.z) * half), f32x4_abs(r_2))));
+
+        f32x4 scale_squared = f32x4_max(f32x4_max(f32x4_sum(f32x4_mul(r_0, r_0)), f32x4_sum(f32x4_mul(r_1, r_1))), f32x4_sum(f32x4_mul(r_2, r_2)));
+        radii[i] = g->radius * f32x4_first(f32x4_sqrt(scale_squared));
+    }
+
+    // One vector per component, one lane per geometry.
+    f32x4_transpose(&box[0], &box[1], &box[2], &box[3]);
+    f32x4_transpose(&sphere[0], &sphere[1], &sphere[2], &sphere[3]);
+    f32x4_transpose(&extents[0], &extents[1], &extents[2], &extents[3]);
+    f32x4 radius = f32x4_set(radii[0], radii[1], radii[2], radii[3]);
+
+    u32 outside = 0;
+    for (u32 p = 0; p < 6; ++p) {
+        f32x4 box_distance = f32x4_madd(planes->x[p], box[0], f32x4_madd(planes->y[p], box[1], f32x4_madd(planes->z[p], box[2], planes->w[p])));
+        f32x4 box_reach = f32x4_madd(planes->abs_x[p], extents[0], f32x4_madd(planes->abs_y[p], extents[1], f32x4_mul(planes->abs_z[p], extents[2])));
+        f32x4 sphere_distance = f32x4_madd(planes->x[p], sphere[0], f32x4_madd(planes->y[p], sphere[1], f32x4_madd(planes->z[p], sphere[2], planes->w[p])));
+        outside |= f32x4_less_mask(f32x4_add(box_distance, box_reach), zero);
+        outside |= f32x4_less_mask(f32x4_add(sphere_distance, radius), zero);
+    }
+
+    // Unused lanes are not geometries.
+    return outside & ((1u << count) - 1);
+}
+#endif
+
+u32 render_cull_geometries(
+    const frustum* f,
+    const geometry_render_data* geometries,
+    u32 geometry_count,
+    geometry_render_data* out_visible,
+    render_cull_stats* out_stats) {
+    u32 tested = 0;
+    u32 visible_count = 0;
+
+#if KSIMD_ENABLED
+    cull_planes planes;
+    for (u32 p = 0; p < 6; ++p) {
+        vec4 plane = f->planes[p];
+        planes.x[p] = f32x4_splat(plane.x);
+        planes.y[p] = f32x4_splat(plane.y);
+        planes.z[p] = f32x4_splat(plane.z);
+        planes.w[p] = f32x4_splat(plane.w);
+        planes.abs_x[p] = f32x4_splat(kabs(plane.x));
+        planes.abs_y[p] = f32x4_splat(kabs(plane.y));
+        planes.abs_z[p] = f32x4_splat(kabs(plane.z));
+    }
+
+    // Gather geometries four at a time, skipping empty entries, and keep the visible ones in order.
+    const geometry_render_data* group[4];
+    u32 group_count = 0;
+    for (u32 i = 0; i < geometry_count; ++i) {
+        if (geometries[i].geometry) {
+            group[group_count++] = &geometries[i];
+        }
+        if (group_count == 4 || (i == geometry_count - 1 && group_count > 0)) {
+            u32 outside = outside_mask_simd(&planes, group, group_count);
+            for (u32 lane = 0; lane < group_count; ++lane) {
+                if (!(outside & (1u << lane))) {
+                    out_visible[visible_count++] = *group[lane];
+                }
+            }
+            tested += group_count;
+            group_count = 0;
+        }
+    }
+#else
+    for (u32 i = 0; i < geometry_count; ++i) {
+        if (!geometries[i].geometry) {
+            continue;
+        }
+        tested++;
+        if (is_visible_scalar(f, &geometries[i])) {
+            out_visible[visible_count++] = geometries[i];
+        }
+    }
+#endif
+
+    if (out_stats) {
+        out_stats->tested = tested;
+        out_stats->culled = tested - visible_count;
+    }
+    return visible_count;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "renderer_types.inl"
+
+/**
+ * @file render_cull.h
+ * @brief Drops the geometries of a frame that lie outside the view frustum.
+ *
+ * Every geometry carries a bounding box and sphere in model space. Both are moved into world
+ * space by the geometry's model matrix, then tested against the six planes of the frustum.
+ * A geometry is culled when either volume lies entirely outside any one plane. The test is
+ * conservative: anything that may be visible is kept.
+ *
+ * Geometries are tested four at a time with SIMD, one per lane, where the target supports it.
+ */
+
+/**
+ * @struct render_cull_stats
+ * @brief How many geometries a culling pass tested, and how many of them it culled.
+ */
+typedef struct render_cull_stats {
+    /** @brief The number of geometries tested. */
+    u32 tested;
+
+    /** @brief The number of geometries found to be outside the frustum. */
+    u32 culled;
+} render_cull_stats;
+
+/**
+ * @brief Extracts the planes of the frustum of a view and projection.
+ *
+ * @param view_projection The view matrix followed by the projection matrix,
+ * i.e. mat4_mul(view, projection).
+ * @return The frustum, with normalized planes facing inward.
+ */
+KAPI frustum render_cull_frustum_create(mat4 view_projection);
+
+/**
+ * @brief Copies the geometries that may be visible within a frustum, in their original order.
+ *
+ * Entries without a geometry are dropped, and not counted as tested.
+ *
+ * @param f The frustum to test against.
+ * @param geometries The geometries of the frame.
+ * @param geometry_count The number of geometries.
+ * @param out_visible An array of at least geometry_count entries to hold the visible geometries.
+ * May not overlap geometries.
+ * @param out_stats Optional pointer to hold the number of geometries tested and culled.
+ * @return The number of visible geometries.
+ */
+KAPI u32 render_cull_geometries(
+    const frustum* f,
+    const geometry_render_data* geometries,
+    u32 geometry_count,
+    geometry_render_data* out_visible,
+    render_cull_stats* out_stats);
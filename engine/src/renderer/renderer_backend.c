@@ -31,9 +31,10 @@ b8 renderer_backend_create(renderer_backend_type type, renderer_backend* out_ren
         out_renderer_backend->update_global_state = vulkan_renderer_update_global_state;
         out_renderer_backend->end_frame = vulkan_renderer_backend_end_frame;
         out_renderer_backend->resized = vulkan_renderer_backend_on_resized;
-        out_renderer_backend->draw_geometry = vulkan_backend_draw_geometry;
+        out_renderer_backend->draw_batches = vulkan_backend_draw_batches;
         out_renderer_backend->create_texture = vulkan_renderer_create_texture;
         out_renderer_backend->destroy_texture = vulkan_renderer_destroy_texture;
+        out_renderer_backend->texture_is_ready = vulkan_renderer_texture_is_ready;
         out_renderer_backend->create_material = vulkan_renderer_create_material;
         out_renderer_backend->destroy_material = vulkan_renderer_destroy_material;
         out_renderer_backend->create_geometry = vulkan_renderer_create_geometry;
@@ -64,9 +65,10 @@ void renderer_backend_destroy(renderer_backend* renderer_backend) {
     renderer_backend->update_global_state = 0;
     renderer_backend->end_frame = 0;
     renderer_backend->resized = 0;
-    renderer_backend->draw_geometry = 0;
+    renderer_backend->draw_batches = 0;
     renderer_backend->create_texture = 0;
     renderer_backend->destroy_texture = 0;
+    renderer_backend->texture_is_ready = 0;
     renderer_backend->create_material = 0;
     renderer_backend->destroy_material = 0;
     renderer_backend->create_geometry = 0;
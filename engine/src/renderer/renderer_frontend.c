@@ -1,8 +1,13 @@
 #include "renderer_frontend.h"
 #include "renderer_backend.h"
+#include "render_batch.h"
+#include "render_cull.h"
 
 #include "core/logger.h"
+#include "core/kmemory.h"
 #include "math/kmath.h"
+#include "memory/frame_allocator.h"
+#include "systems/material_system.h"
 
 #include "resources/resource_types.h"
 
@@ -47,12 +52,22 @@ typedef struct renderer_system_state {
      * @brief Far clipping plane distance.
      */
     f32 far_clip;
+
+    /**
+     * @brief How the backend submits draws.
+     */
+    renderer_draw_mode draw_mode;
+
+    /**
+     * @brief How many geometries the last frame tested against the view frustum, and culled.
+     */
+    render_cull_stats cull_stats;
 } renderer_system_state;
 
 // Global pointer to the renderer backend instance
 static renderer_system_state* state_ptr;
 
-b8 renderer_system_initialize(u64* memory_requirement, void* state, const char* application_name) {
+b8 renderer_system_initialize(u64* memory_requirement, void* state, renderer_backend_config config) {
     *memory_requirement = sizeof(renderer_system_state);
     if (state == 0) {
         return True;  // No state provided, nothing to initialize
@@ -66,11 +81,12 @@ b8 renderer_system_initialize(u64* memory_requirement, void* state, const char*
     state_ptr->backend.frame_number = 0;
 
     // Call the backend's initialization routine
-    if (!state_ptr->backend.initialize(&state_ptr->backend, application_name)) {
+    if (!state_ptr->backend.initialize(&state_ptr->backend, &config)) {
         KFATAL("Renderer backend failed to initialize. Shutting down.");
         return False;
     }
 
+    state_ptr->draw_mode = RENDERER_DRAW_MODE_DIRECT;
     state_ptr->near_clip = 0.1f;
     state_ptr->far_clip = 1000.0f;
     state_ptr->projection = mat4_perspective(deg_to_rad(45.0f), 1280 / 720.0f, state_ptr->near_clip, state_ptr->far_clip);
@@ -137,8 +153,9 @@ void renderer_on_resized(u16 width, u16 height) {
 /**
  * @brief Performs the complete frame rendering process.
  *
- * Begins the frame, executes draw commands (not yet implemented here),
- * and ends the frame. Called once per frame by the engine.
+ * Begins the frame, drops the packet's geometries that are outside the view frustum,
+ * sorts the rest into instanced batches and draws them, and ends the frame. Called once
+ * per frame by the engine.
  *
  * @param packet A pointer to the render packet containing frame-specific data.
  * @return True if the frame was drawn successfully; otherwise False.
@@ -148,9 +165,35 @@ b8 renderer_draw_frame(render_packet* packet) {
     if (renderer_begin_frame(packet->delta_time)) {
         state_ptr->backend.update_global_state(state_ptr->projection, state_ptr->view, vec3_zero(), vec4_one(), 0);
 
-        u32 count = packet->geometry_count;
-        for (u32 i = 0; i < count; ++i) {
-            state_ptr->backend.draw_geometry(packet->geometries[i]);
+        // Only geometries that may be visible go any further.
+        u32 count = 0;
+        geometry_render_data* visible = 0;
+        kzero_memory(&state_ptr->cull_stats, sizeof(render_cull_stats));
+        if (packet->geometry_count > 0) {
+            visible = frame_alloc(sizeof(geometry_render_data) * packet->geometry_count, 16);
+            if (visible) {
+                frustum f = render_cull_frustum_create(mat4_mul(state_ptr->view, state_ptr->projection));
+                count = render_cull_geometries(&f, packet->geometries, packet->geometry_count, visible, &state_ptr->cull_stats);
+            } else {
+                KERROR("renderer_draw_frame - Failed to allocate culling memory for %u geometries. Skipping draws.", packet->geometry_count);
+            }
+        }
+
+        // Sort the geometries by state and merge repeats into instanced batches, so the cost of
+        // submission scales with the number of batches rather than objects.
+        if (count > 0) {
+            void* scratch = frame_alloc(render_batch_scratch_size(count), 8);
+            mat4* transforms = frame_alloc(sizeof(mat4) * count, 16);
+            render_batch* batches = frame_alloc(sizeof(render_batch) * count, 8);
+            if (scratch && transforms && batches) {
+                u32 batch_count = render_batch_build(visible, count, material_system_get_default(), scratch, transforms, batches);
+                if (batch_count > 0) {
+                    u32 transform_count = batches[batch_count - 1].first_instance + batches[batch_count - 1].instance_count;
+                    state_ptr->backend.draw_batches(transforms, transform_count, batches, batch_count, state_ptr->draw_mode);
+                }
+            } else {
+                KERROR("renderer_draw_frame - Failed to allocate batching memory for %u geometries. Skipping draws.", count);
+            }
         }
 
         // End the frame. If this fails, it is likely unrecoverable.
@@ -176,21 +219,50 @@ void renderer_set_view(mat4 view) {
     state_ptr->view = view;
 }
 
+void renderer_set_draw_mode(renderer_draw_mode mode) {
+    if (state_ptr) {
+        state_ptr->draw_mode = mode;
+        KINFO("Renderer draw mode set to %s.", mode == RENDERER_DRAW_MODE_INDIRECT ? "indirect" : "direct");
+    }
+}
+
+renderer_draw_mode renderer_get_draw_mode() {
+    return state_ptr ? state_ptr->draw_mode : RENDERER_DRAW_MODE_DIRECT;
+}
+
+render_cull_stats renderer_get_cull_stats() {
+    if (!state_ptr) {
+        render_cull_stats empty = {0};
+        return empty;
+    }
+    return state_ptr->cull_stats;
+}
+
+u64 renderer_get_frame_number() {
+    return state_ptr ? state_ptr->backend.frame_number : 0;
+}
+
 void renderer_create_texture(
     const char* name,
     i32 width,
     i32 height,
     i32 channel_count,
+    texture_format format,
+    u32 mip_count,
     const u8* pixels,
     b8 has_transparency,
     struct texture* out_texture) {
-    state_ptr->backend.create_texture(name, width, height, channel_count, pixels, has_transparency, out_texture);
+    state_ptr->backend.create_texture(name, width, height, channel_count, format, mip_count, pixels, has_transparency, out_texture);
 }
 
 void renderer_destroy_texture(struct texture* texture) {
     state_ptr->backend.destroy_texture(texture);
 }
 
+b8 renderer_texture_is_ready(struct texture* texture) {
+    return state_ptr->backend.texture_is_ready(texture);
+}
+
 b8 renderer_create_material(struct material* material) {
     return state_ptr->backend.create_material(material);
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "renderer_types.inl"
+#include "render_cull.h"
 
 /**
  * @file renderer_frontend.h
@@ -38,11 +39,12 @@ struct platform_state;
  * Sets up the appropriate rendering backend (e.g., Vulkan), creates necessary
  * context, device, swapchain, etc. based on application requirements.
  *
- * @param application_name Name of the application using the renderer.
- * @param plat_state A pointer to the platform-specific state.
+ * @param memory_requirement A pointer to hold the memory requirement of the system.
+ * @param state A block of memory to hold the state, or 0 to only obtain the memory requirement.
+ * @param config The configuration passed on to the backend.
  * @return True if initialization was successful; otherwise False.
  */
-b8 renderer_system_initialize(u64* memory_requirement, void* state, const char* application_name);
+b8 renderer_system_initialize(u64* memory_requirement, void* state, renderer_backend_config config);
 
 /**
  * @brief Shuts down the rendering system.
@@ -83,6 +85,38 @@ b8 renderer_draw_frame(render_packet* packet);
  */
 void renderer_set_view(mat4 view);
 
+/**
+ * @brief Sets how the backend submits draws. Takes effect from the next frame, so the draw
+ * paths can be compared at runtime.
+ *
+ * @param mode The draw mode to use.
+ */
+KAPI void renderer_set_draw_mode(renderer_draw_mode mode);
+
+/**
+ * @brief Obtains how the backend submits draws.
+ *
+ * @return The current draw mode.
+ */
+KAPI renderer_draw_mode renderer_get_draw_mode();
+
+/**
+ * @brief Obtains how many geometries the last frame tested against the view frustum, and
+ * how many of them were culled rather than drawn.
+ *
+ * @return The culling counters of the last frame.
+ */
+KAPI render_cull_stats renderer_get_cull_stats();
+
+/**
+ * @brief Obtains the number of the frame being built, counted from zero.
+ *
+ * Textures record the frame they were last drawn in against this.
+ *
+ * @return The current frame number.
+ */
+KAPI u64 renderer_get_frame_number();
+
 /**
  * @brief Creates a texture resource from raw pixel data.
  *
@@ -93,7 +127,9 @@ void renderer_set_view(mat4 view);
  * @param width Width of the texture in pixels.
  * @param height Height of the texture in pixels.
  * @param channel_count Number of color channels (e.g., 3 for RGB, 4 for RGBA).
- * @param pixels Pointer to the raw pixel data.
+ * @param format The format of the pixel data. Block-compressed data is uploaded as-is.
+ * @param mip_count The number of mip levels in the pixel data.
+ * @param pixels Pointer to the pixel data: every mip level, largest first, tightly packed.
  * @param has_transparency Whether the texture contains transparency (alpha channel).
  * @param out_texture Pointer to the texture structure to be filled out.
  */
@@ -102,6 +138,8 @@ void renderer_create_texture(
     i32 width,
     i32 height,
     i32 channel_count,
+    texture_format format,
+    u32 mip_count,
     const u8* pixels,
     b8 has_transparency,
     struct texture* out_texture);
@@ -113,6 +151,15 @@ void renderer_create_texture(
  */
 void renderer_destroy_texture(struct texture* texture);
 
+/**
+ * @brief Indicates whether a texture's pixels have finished uploading, so draws sample it
+ * rather than the default texture.
+ *
+ * @param texture Pointer to the texture to check.
+ * @return True if the texture can be sampled; otherwise False.
+ */
+b8 renderer_texture_is_ready(struct texture* texture);
+
 /**
  * @brief Creates a material resource.
  *
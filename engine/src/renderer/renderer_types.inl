@@ -104,6 +104,53 @@ typedef struct geometry_render_data {
     geometry* geometry;
 } geometry_render_data;
 
+/**
+ * @enum renderer_draw_mode
+ * @brief How the backend submits the draws of a frame.
+ */
+typedef enum renderer_draw_mode {
+    /** @brief One draw call per batch. */
+    RENDERER_DRAW_MODE_DIRECT,
+
+    /**
+     * @brief Draws are written to a GPU-visible list and submitted with indirect multi-draws.
+     * Falls back to direct draws if the device does not support multi-draw indirect.
+     */
+    RENDERER_DRAW_MODE_INDIRECT
+} renderer_draw_mode;
+
+/**
+ * @struct render_batch
+ * @brief A run of instances of the same geometry with the same material, drawn with one call.
+ *
+ * Produced by render_batch_build() from the geometries of a render packet.
+ */
+typedef struct render_batch {
+    /** Pointer to the geometry drawn by every instance. */
+    geometry* geometry;
+
+    /** Pointer to the material the instances are drawn with. Never 0. */
+    material* material;
+
+    /** Index of the first instance's transform in the frame's transform array. */
+    u32 first_instance;
+
+    /** Number of instances in the batch. */
+    u32 instance_count;
+} render_batch;
+
+/**
+ * @struct renderer_backend_config
+ * @brief Configuration for the renderer backend.
+ */
+typedef struct renderer_backend_config {
+    /** @brief Name of the application using the renderer. */
+    const char* application_name;
+
+    /** @brief The size in bytes of the buffer uploads to the GPU are staged through. 0 uses the backend default. */
+    u64 staging_buffer_size;
+} renderer_backend_config;
+
 /**
  *
  * @brief Represents an abstract rendering backend interface.
@@ -126,11 +173,10 @@ typedef struct renderer_backend {
      * @brief Function pointer to initialize the backend.
      *
      * @param backend A pointer to the renderer backend instance.
-     * @param application_name Name of the application using the renderer.
-     * @param plat_state A pointer to the platform-specific state.
+     * @param config A pointer to the backend configuration.
      * @return True if successful; otherwise False.
      */
-    b8 (*initialize)(struct renderer_backend* backend, const char* application_name);
+    b8 (*initialize)(struct renderer_backend* backend, const renderer_backend_config* config);
 
     /**
      * @brief Function pointer to shut down the backend.
@@ -181,13 +227,15 @@ typedef struct renderer_backend {
     b8 (*end_frame)(struct renderer_backend* backend, f32 delta_time);
 
     /**
-     * @brief Updates the model matrix for a specific object.
-     *
-     * @param model The model matrix for the object.
+     * @brief Draws the batches of a frame. Must be called between begin_frame and end_frame.
      *
-     * @return void
+     * @param transforms The model matrices of every instance, in batch order.
+     * @param transform_count The number of transforms.
+     * @param batches The batches to draw, sorted so that equal state is adjacent.
+     * @param batch_count The number of batches.
+     * @param mode How the draws are submitted.
      */
-    void (*draw_geometry)(geometry_render_data data);
+    void (*draw_batches)(const mat4* transforms, u32 transform_count, const render_batch* batches, u32 batch_count, renderer_draw_mode mode);
 
     /**
      * @brief Creates a texture resource from raw pixel data.
@@ -199,7 +247,9 @@ typedef struct renderer_backend {
      * @param width Width of the texture in pixels.
      * @param height Height of the texture in pixels.
      * @param channel_count Number of color channels (e.g., 3 for RGB, 4 for RGBA).
-     * @param pixels Pointer to the raw pixel data
+     * @param format The format of the pixel data.
+     * @param mip_count The number of mip levels in the pixel data.
+     * @param pixels Pointer to the pixel data: every mip level, largest first, tightly packed.
      * @param has_transparency Whether the texture contains transparency (alpha channel).
      * @param out_texture Pointer to the texture structure to be filled out.
      */
@@ -208,6 +258,8 @@ typedef struct renderer_backend {
         i32 width,
         i32 height,
         i32 channel_count,
+        texture_format format,
+        u32 mip_count,
         const u8* pixels,
         b8 has_transparency,
         struct texture* out_texture);
@@ -218,6 +270,14 @@ typedef struct renderer_backend {
      */
     void (*destroy_texture)(struct texture* texture);
 
+    /**
+     * @brief Indicates whether a texture's pixels have finished uploading, so draws sample it
+     * rather than the default texture.
+     * @param texture Pointer to the texture to check.
+     * @return True if the texture can be sampled; otherwise False.
+     */
+    b8 (*texture_is_ready)(struct texture* texture);
+
     /**
      * @brief Creates a material resource.
      *
@@ -6,8 +6,10 @@
 #include "systems/texture_system.h"
 
 #include "renderer/vulkan/vulkan_buffer.h"
+#include "renderer/vulkan/vulkan_deletion_queue.h"
 #include "renderer/vulkan/vulkan_pipeline.h"
 #include "renderer/vulkan/vulkan_shader_utils.h"
+#include "renderer/vulkan/vulkan_staging.h"
 
 /**
  * @file vulkan_material_shader.c
@@ -23,10 +25,15 @@
 #define BUILTIN_SHADER_NAME_OBJECT "Builtin.MaterialShader"
 
 /**
- * @brief Number of shader stages in the object shader.
+ * @brief Number of per-vertex attributes in the object shader.
  */
 #define ATTRIBUTE_COUNT 2
 
+/**
+ * @brief Number of per-instance attributes in the object shader; the four columns of the model matrix.
+ */
+#define INSTANCE_ATTRIBUTE_COUNT 4
+
 b8 vulkan_material_shader_create(vulkan_context* context, vulkan_material_shader* out_shader) {
     // TODO: MAKE CONFIGURABLE
 
@@ -124,9 +131,18 @@ b8 vulkan_material_shader_create(vulkan_context* context, vulkan_material_shader
     scissor.extent.width = context->framebuffer_width;
     scissor.extent.height = context->framebuffer_height;
 
+    // Bindings. Binding 0 is the vertex data, binding 1 the model matrix of each instance.
+    VkVertexInputBindingDescription binding_descriptions[2];
+    binding_descriptions[0].binding = 0;
+    binding_descriptions[0].stride = sizeof(vertex_3d);
+    binding_descriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    binding_descriptions[1].binding = 1;
+    binding_descriptions[1].stride = sizeof(mat4);
+    binding_descriptions[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
     // Attributes
     u32 offset = 0;
-    VkVertexInputAttributeDescription attribute_descriptions[ATTRIBUTE_COUNT];
+    VkVertexInputAttributeDescription attribute_descriptions[ATTRIBUTE_COUNT + INSTANCE_ATTRIBUTE_COUNT];
     // Position, texCoord
     VkFormat formats[ATTRIBUTE_COUNT] = {VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32_SFLOAT};
 
@@ -143,6 +159,15 @@ b8 vulkan_material_shader_create(vulkan_context* context, vulkan_material_shader
         offset += sizes[i];
     }
 
+    // Model matrix, one column per location.
+    for (u32 i = 0; i < INSTANCE_ATTRIBUTE_COUNT; ++i) {
+        VkVertexInputAttributeDescription* attribute = &attribute_descriptions[ATTRIBUTE_COUNT + i];
+        attribute->binding = 1;
+        attribute->location = ATTRIBUTE_COUNT + i;
+        attribute->format = VK_FORMAT_R32G32B32A32_SFLOAT;
+        attribute->offset = sizeof(vec4) * i;
+    }
+
     // Descriptor Set Layouts
     const i32 descriptor_set_layout_count = 2;
     VkDescriptorSetLayout layouts[2] = {
@@ -162,7 +187,9 @@ b8 vulkan_material_shader_create(vulkan_context* context, vulkan_material_shader
     if (!vulkan_graphics_pipeline_create(
             context,
             &context->main_renderpass,
-            ATTRIBUTE_COUNT,
+            2,
+            binding_descriptions,
+            ATTRIBUTE_COUNT + INSTANCE_ATTRIBUTE_COUNT,
             attribute_descriptions,
             descriptor_set_layout_count,
             layouts,
@@ -293,15 +320,6 @@ void vulkan_material_shader_update_global_state(vulkan_context* context, struct
     vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shader->pipeline.pipeline_layout, 0, 1, &global_descriptor, 0, 0);
 }
 
-void vulkan_material_shader_set_model(vulkan_context* context, struct vulkan_material_shader* shader, mat4 model) {
-    if (context && shader) {
-        u32 image_index = context->image_index;
-        VkCommandBuffer command_buffer = context->graphics_command_buffers[image_index].handle;
-
-        vkCmdPushConstants(command_buffer, shader->pipeline.pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(mat4), &model);
-    }
-}
-
 void vulkan_material_shader_apply_material(vulkan_context* context, struct vulkan_material_shader* shader, material* material) {
     if (context && shader) {
         u32 image_index = context->image_index;
@@ -376,8 +394,18 @@ void vulkan_material_shader_apply_material(vulkan_context* context, struct vulka
             u32* descriptor_generation = &object_state->descriptor_states[descriptor_index].generations[image_index];
             u32* descriptor_id = &object_state->descriptor_states[descriptor_index].ids[image_index];
 
-            // If the texture hasn't been loaded yet, use the default.
-            if (t->generation == INVALID_ID) {
+            // A material without a map samples the default.
+            if (!t) {
+                t = texture_system_get_default_texture();
+            }
+
+            // Recorded before any fallback, so the texture system sees an evicted texture being
+            // drawn and brings it back.
+            t->last_used_frame = context->frame_number;
+
+            // If the texture hasn't been loaded or finished uploading yet, use the default.
+            if (t->generation == INVALID_ID ||
+                !vulkan_staging_ring_ticket_complete(&context->staging, ((vulkan_texture_data*)t->internal_data)->upload_ticket)) {
                 t = texture_system_get_default_texture();
 
                 // Reset the descriptor generation if using the default texture.
@@ -385,7 +413,7 @@ void vulkan_material_shader_apply_material(vulkan_context* context, struct vulka
             }
 
             // Check if the descriptor needs updating first.
-            if (t && (*descriptor_id != t->id || *descriptor_generation != t->generation || *descriptor_generation == INVALID_ID)) {
+            if (*descriptor_id != t->id || *descriptor_generation != t->generation || *descriptor_generation == INVALID_ID) {
                 vulkan_texture_data* internal_data = (vulkan_texture_data*)t->internal_data;
 
                 // Assign view and sampler.
@@ -462,13 +490,8 @@ void vulkan_material_shader_release_resources(vulkan_context* context, struct vu
 
     const u32 descriptor_set_count = context->swapchain.image_count;
 
-    vkDeviceWaitIdle(context->device.logical_device);
-
-    // Release object descriptor sets
-    VkResult result = vkFreeDescriptorSets(context->device.logical_device, shader->object_descriptor_pool, descriptor_set_count, instance_state->descriptor_sets);
-    if (result != VK_SUCCESS) {
-        KERROR("Error Freeing object shader descriptor sets!");
-    }
+    // Release object descriptor sets once the frames in flight that may be using them are finished.
+    vulkan_deletion_queue_push_descriptor_sets(context, &context->deletion_queue, shader->object_descriptor_pool, descriptor_set_count, instance_state->descriptor_sets);
 
     for (u32 i = 0; i < VULKAN_MATERIAL_SHADER_DESCRIPTOR_COUNT; ++i) {
         for (u32 j = 0; j < context->swapchain.image_count; ++j) {
@@ -58,24 +58,12 @@ void vulkan_material_shader_use(vulkan_context* context, struct vulkan_material_
  */
 void vulkan_material_shader_update_global_state(vulkan_context* context, struct vulkan_material_shader* shader, f32 delta_time);
 
-/**
- * @brief Sets the model matrix for the Vulkan object shader using push constants.
- *
- * This function updates the model matrix used for transforming vertices in the vertex shader.
- * It utilizes push constants for efficient updates without needing to modify uniform buffers.
- *
- * @param context The Vulkan context containing command buffers and frame information.
- * @param shader Pointer to the vulkan_material_shader structure whose model matrix is to be set.
- * @param model The model matrix to be applied to the shader.
- */
-void vulkan_material_shader_set_model(vulkan_context* context, struct vulkan_material_shader* shader, mat4 model);
-
 /**
  * @brief Updates per-object descriptor data (UBO + texture) and binds the descriptor set.
  *
  * This function updates the uniform buffer object (UBO) and texture bindings
  * for a specific object being rendered, and binds the appropriate descriptor set
- * for the current frame. It should be called once per object before drawing.
+ * for the current frame. It should be called whenever the material changes between draws.
  *
  * @param context The Vulkan context containing command buffers and frame information.
  * @param shader Pointer to the vulkan_material_shader structure whose object state is to be updated.
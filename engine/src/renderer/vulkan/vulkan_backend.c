@@ -5,21 +5,23 @@
 #include "core/kmemory.h"
 #include "math/math_types.h"
 #include "platform/platform.h"
+#include "resources/ktex.h"
 #include "shaders/vulkan_material_shader.h"
 #include "vulkan_buffer.h"
 #include "vulkan_backend.h"
 #include "vulkan_command_buffer.h"
+#include "vulkan_deletion_queue.h"
 #include "vulkan_device.h"
 #include "vulkan_image.h"
+#include "vulkan_memory.h"
 #include "vulkan_fence.h"
 #include "vulkan_framebuffer.h"
 #include "vulkan_platform.h"
 #include "vulkan_renderpass.h"
+#include "vulkan_staging.h"
 #include "vulkan_swapchain.h"
 #include "vulkan_utils.h"
 
-#include "systems/material_system.h"
-
 /**
  * @file vulkan_backend.c
  * @brief Implementation of the Vulkan renderer backend.
@@ -33,6 +35,21 @@
 
 #define INDEX_COUNT 6
 
+// The number of vulkan_texture_data blocks the texture data pool grows by at a time.
+#define VULKAN_TEXTURE_DATA_POOL_BLOCKS_PER_CHUNK 64
+
+// The staging ring size used when the config does not specify one.
+#define VULKAN_DEFAULT_STAGING_BUFFER_SIZE (64 * 1024 * 1024)
+
+// Alignment of allocations in the staging ring. Covers the texel alignment required of image copies.
+#define VULKAN_STAGING_ALIGNMENT 16
+
+// The most geometry moves per buffer each frame when compacting the geometry buffers.
+#define VULKAN_GEOMETRY_MOVES_PER_FRAME 4
+
+// Size of a frame's region of the indirect buffer: its draw commands, then one draw count per indirect draw.
+#define VULKAN_INDIRECT_REGION_SIZE ((sizeof(VkDrawIndexedIndirectCommand) + sizeof(u32)) * VULKAN_MAX_INDIRECT_DRAWS_PER_FRAME)
+
 // Static global context for the Vulkan renderer
 static vulkan_context context;
 
@@ -42,57 +59,198 @@ static u32 cached_framebuffer_width = 0;
 // Static global cached_framebuffer_height
 static u32 cached_framebuffer_height = 0;
 
-void upload_data_range(vulkan_context* context,
-                       VkCommandPool pool,
-                       VkFence fence,
-                       VkQueue queue,
-                       vulkan_buffer* buffer,
-                       u64 offset,
-                       u64 size,
-                       const void* data) {
-    // Create a host-visible staging buffer to upload to. Mark it as the source of the transfer
-    VkBufferUsageFlags flags = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-
-    vulkan_buffer staging;
-
-    vulkan_buffer_create(context, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, flags, True, &staging);
-
-    // Load the data into the staging buffer
-    vulkan_buffer_load_data(
-        context,
-        &staging,
-        0,
-        size,
-        0,
-        data);
-
-    // Perform the copy from staging to the device local buffer
-    vulkan_buffer_copy_to(
-        context,
-        pool,
-        fence,
-        queue,
-        staging.handle,
-        0,
-        buffer->handle,
-        offset,
-        size);
-
-    // Clean up the staging buffer
-    vulkan_buffer_destroy(context, &staging);
+b8 upload_data_range(vulkan_context* context, vulkan_buffer* buffer, u64 offset, u64 size, const void* data) {
+    // Keep each piece to half the ring, so one piece can be written while the previous is in flight.
+    u64 max_chunk_size = context->staging.size / 2;
+    u64 uploaded = 0;
+    while (uploaded < size) {
+        u64 chunk_size = KMIN(size - uploaded, max_chunk_size);
+
+        u64 staging_offset = 0;
+        void* staging_memory = vulkan_staging_ring_allocate(context, &context->staging, chunk_size, VULKAN_STAGING_ALIGNMENT, &staging_offset);
+        if (!staging_memory) {
+            KERROR("upload_data_range - Failed to allocate staging space.");
+            return False;
+        }
+        kcopy_memory(staging_memory, (const u8*)data + uploaded, chunk_size);
+
+        // Record the copy from staging to the device local buffer into the upload batch.
+        vulkan_command_buffer* command_buffer = vulkan_staging_ring_command_buffer(context, &context->staging);
+        VkBufferCopy copy_region;
+        copy_region.srcOffset = staging_offset;
+        copy_region.dstOffset = offset + uploaded;
+        copy_region.size = chunk_size;
+        vkCmdCopyBuffer(command_buffer->handle, context->staging.buffer.handle, buffer->handle, 1, &copy_region);
+        vulkan_staging_ring_release_buffer(context, &context->staging, buffer->handle, offset + uploaded, chunk_size);
+
+        uploaded += chunk_size;
+    }
+
+    return True;
 }
 
 void free_data_range(vulkan_buffer* buffer, u64 offset, u64 size) {
-    // No-op for Vulkan as memory is managed by the Vulkan driver.
-    // In a more complex implementation, you might track allocations within the buffer.
-    // (void)buffer;
-    // (void)offset;
-    // (void)size;
-
-    // TODO: Free this in the buffer
-    // TODO: Update free list with this range being free
+    // Frames still in flight may be reading the range, so it is only freed once they are finished.
+    vulkan_deletion_queue_push_buffer_range(&context, &context.deletion_queue, buffer, offset, size);
+    kmemory_report_free(size, MEMORY_TAG_GPU_GEOMETRY);
+}
+
+/**
+ * @brief Grows a geometry buffer so that it has room for at least size more bytes.
+ *
+ * Waits for the device to go idle, as frames in flight and pending uploads refer to the old
+ * buffer. This should be rare, as the buffer at least doubles each time.
+ */
+static b8 grow_geometry_buffer(vulkan_buffer* buffer, u64 size) {
+    if (context.frame_in_progress) {
+        KERROR("grow_geometry_buffer - A geometry buffer cannot be grown while a frame is recorded. Create geometry outside of the frame.");
+        return False;
+    }
+
+    u64 new_size = KMAX(buffer->total_size * 2, buffer->total_size + size);
+    KINFO("Growing geometry buffer from %llu to %llu bytes.", buffer->total_size, new_size);
+
+    // Submit pending uploads, wait for them, and take ownership of them before the old buffer goes.
+    if (!vulkan_staging_ring_flush(&context, &context.staging)) {
+        return False;
+    }
+    vkDeviceWaitIdle(context.device.logical_device);
+
+    vulkan_command_buffer command_buffer;
+    vulkan_command_buffer_allocate_and_begin_single_use(&context, context.device.graphics_command_pool, &command_buffer);
+    vulkan_staging_ring_acquire(&context, &context.staging, &command_buffer);
+    vulkan_command_buffer_end_single_use(&context, context.device.graphics_command_pool, &command_buffer, context.device.graphics_queue);
+
+    return vulkan_buffer_resize(&context, new_size, buffer, context.device.graphics_queue, context.device.graphics_command_pool);
+}
+
+/** @brief Allocates a range of a geometry buffer, growing the buffer if no free range is large enough. */
+static b8 allocate_data_range(vulkan_buffer* buffer, u64 size, u64* out_offset) {
+    if (!vulkan_buffer_allocate(buffer, size, out_offset)) {
+        if (!grow_geometry_buffer(buffer, size) || !vulkan_buffer_allocate(buffer, size, out_offset)) {
+            KERROR("allocate_data_range - Unable to allocate %llu bytes of geometry buffer.", size);
+            return False;
+        }
+    }
+
+    kmemory_report_allocation(size, MEMORY_TAG_GPU_GEOMETRY);
+    return True;
+}
+
+/**
+ * @brief Checks whether a free list has free space below its highest allocation, i.e. whether
+ * anything besides the tail of the block is free.
+ */
+static b8 freelist_has_hole(const freelist* list) {
+    u64 tail_size = 0;
+    if (list->range_count > 0) {
+        const freelist_range* last = &list->ranges[list->range_count - 1];
+        if (last->offset + last->size == list->total_size) {
+            tail_size = last->size;
+        }
+    }
+    return list->free_space > tail_size;
+}
+
+/**
+ * @brief Moves the highest geometry in a geometry buffer into the lowest free range that fits it,
+ * if that is lower. Each move records a copy within the buffer into the command buffer.
+ *
+ * @return True if a geometry was moved; otherwise False.
+ */
+static b8 compact_geometry_buffer(vulkan_command_buffer* command_buffer, vulkan_buffer* buffer, b8 is_index_buffer) {
+    if (!freelist_has_hole(&buffer->freelist)) {
+        return False;
+    }
+
+    // Find the highest geometry that has finished uploading.
+    vulkan_geometry_data* highest = 0;
+    u64 highest_offset = 0;
+    for (u32 i = 0; i < VULKAN_MAX_GEOMETRY_COUNT; ++i) {
+        vulkan_geometry_data* data = &context.geometries[i];
+        u64 size = is_index_buffer ? data->index_size : data->vertex_size;
+        u64 offset = is_index_buffer ? data->index_buffer_offset : data->vertex_buffer_offset;
+        if (data->id == INVALID_ID || !size || (highest && offset < highest_offset) ||
+            !vulkan_staging_ring_ticket_complete(&context.staging, data->upload_ticket)) {
+            continue;
+        }
+        highest = data;
+        highest_offset = offset;
+    }
+
+    if (!highest) {
+        return False;
+    }
+
+    u64 size = is_index_buffer ? highest->index_size : highest->vertex_size;
+    u64 new_offset = 0;
+    if (!freelist_allocate_block_lowest(&buffer->freelist, size, &new_offset)) {
+        return False;
+    }
+    if (new_offset > highest_offset) {
+        // Nothing lower fits it.
+        freelist_free_block(&buffer->freelist, size, new_offset);
+        return False;
+    }
+    kmemory_report_allocation(size, MEMORY_TAG_GPU_GEOMETRY);
+
+    // Earlier moves this frame may have written the range being read.
+    VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(
+        command_buffer->handle,
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 1, &barrier, 0, 0, 0, 0);
+
+    VkBufferCopy copy_region;
+    copy_region.srcOffset = highest_offset;
+    copy_region.dstOffset = new_offset;
+    copy_region.size = size;
+    vkCmdCopyBuffer(command_buffer->handle, buffer->handle, buffer->handle, 1, &copy_region);
+
+    // Frames in flight may still be drawing from the old range.
+    free_data_range(buffer, highest_offset, size);
+    if (is_index_buffer) {
+        highest->index_buffer_offset = new_offset;
+    } else {
+        highest->vertex_buffer_offset = new_offset;
+    }
+
+    return True;
 }
-b8 vulkan_renderer_backend_initialize(renderer_backend* backend, const char* application_name) {
+
+/**
+ * @brief Closes holes left in the geometry buffers by freed geometry, a few moves per frame, so
+ * that the free space stays in one range at the end of each buffer. Must be recorded outside of
+ * the render pass.
+ */
+static void compact_geometry_buffers(vulkan_command_buffer* command_buffer) {
+    u32 move_count = 0;
+    while (move_count < VULKAN_GEOMETRY_MOVES_PER_FRAME) {
+        b8 moved_vertices = compact_geometry_buffer(command_buffer, &context.object_vertex_buffer, False);
+        b8 moved_indices = compact_geometry_buffer(command_buffer, &context.object_index_buffer, True);
+        if (!moved_vertices && !moved_indices) {
+            break;
+        }
+        move_count++;
+    }
+
+    if (move_count > 0) {
+        // Make the moved data visible to the draws that follow.
+        VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+        vkCmdPipelineBarrier(
+            command_buffer->handle,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+            0, 1, &barrier, 0, 0, 0, 0);
+    }
+}
+
+b8 vulkan_renderer_backend_initialize(renderer_backend* backend, const renderer_backend_config* config) {
     KINFO("Creating Vulkan instance...");
     // Function pointers
     context.find_memory_index = find_memory_index;
@@ -100,6 +258,12 @@ b8 vulkan_renderer_backend_initialize(renderer_backend* backend, const char* app
     // TODO: Implement support for custom allocators
     context.allocator = 0;
 
+    // Texture internal data is fixed-size, so pool it rather than hitting the general allocator per texture.
+    if (!pool_allocator_create(sizeof(vulkan_texture_data), VULKAN_TEXTURE_DATA_POOL_BLOCKS_PER_CHUNK, 0, MEMORY_TAG_TEXTURE, &context.texture_data_pool)) {
+        KERROR("Failed to create the Vulkan texture data pool.");
+        return False;
+    }
+
     application_get_framebuffer_size(&cached_framebuffer_width, &cached_framebuffer_height);
     context.framebuffer_width = (cached_framebuffer_width != 0) ? cached_framebuffer_width : 800;
     context.framebuffer_height = (cached_framebuffer_height != 0) ? cached_framebuffer_height : 600;
@@ -109,7 +273,7 @@ b8 vulkan_renderer_backend_initialize(renderer_backend* backend, const char* app
     // Application info for the Vulkan instance
     VkApplicationInfo app_info = {VK_STRUCTURE_TYPE_APPLICATION_INFO};
     app_info.apiVersion = VK_MAKE_API_VERSION(0, 1, 4, 313);
-    app_info.pApplicationName = application_name;
+    app_info.pApplicationName = config->application_name;
     // VK_MAKE_API_VERSION(major, minor, patch, variant)
     app_info.applicationVersion = VK_MAKE_API_VERSION(0, 1, 0, 0);
     app_info.pEngineName = "Koru Engine";
@@ -231,6 +395,18 @@ b8 vulkan_renderer_backend_initialize(renderer_backend* backend, const char* app
         return False;
     }
 
+    // Device memory allocator, which every buffer and image allocates from.
+    if (!vulkan_memory_allocator_create(&context, &context.memory_allocator)) {
+        KERROR("Failed to create the device memory allocator!");
+        return False;
+    }
+
+    // Resources released while frames in flight may still use them wait here.
+    if (!vulkan_deletion_queue_create(&context.deletion_queue)) {
+        KERROR("Failed to create the deletion queue!");
+        return False;
+    }
+
     // Swapchain Creation
     KDEBUG("Creating Vulkan Swapchain...");
     vulkan_swapchain_create(
@@ -284,6 +460,13 @@ b8 vulkan_renderer_backend_initialize(renderer_backend* backend, const char* app
         context.images_in_flight[i] = 0;
     }
 
+    // Staging ring for uploads.
+    u64 staging_size = config->staging_buffer_size ? config->staging_buffer_size : VULKAN_DEFAULT_STAGING_BUFFER_SIZE;
+    if (!vulkan_staging_ring_create(&context, staging_size, &context.staging)) {
+        KERROR("Failed to create the Vulkan staging ring.");
+        return False;
+    }
+
     // Create builtin shaders
     if (!vulkan_material_shader_create(&context, &context.material_shader)) {
         KERROR("Error loading built-in basic_lighting shader.");
@@ -296,6 +479,10 @@ b8 vulkan_renderer_backend_initialize(renderer_backend* backend, const char* app
     for (u32 i = 0; i < VULKAN_MAX_GEOMETRY_COUNT; ++i) {
         context.geometries[i].id = INVALID_ID;
     }
+    u64 geometry_slots_requirement = 0;
+    handle_pool_create(VULKAN_MAX_GEOMETRY_COUNT, &geometry_slots_requirement, 0, 0);
+    KASSERT(geometry_slots_requirement == sizeof(context.geometry_slot_memory));
+    handle_pool_create(VULKAN_MAX_GEOMETRY_COUNT, &geometry_slots_requirement, context.geometry_slot_memory, &context.geometry_slots);
     KINFO("Geometry slots marked as invalid.");
 
     KINFO("Vulkan renderer initialized successfully.");
@@ -306,10 +493,23 @@ void vulkan_renderer_backend_shutdown(renderer_backend* backend) {
     KINFO("Shutting down Vulkan renderer...");
     vkDeviceWaitIdle(context.device.logical_device);
 
+    KDEBUG("Destroying Vulkan Staging Ring...");
+    vulkan_staging_ring_destroy(&context, &context.staging);
+
+    // The device is idle, so everything released can be destroyed.
+    KDEBUG("Destroying Vulkan deletion queue...");
+    vulkan_deletion_queue_destroy(&context, &context.deletion_queue);
+
+    KDEBUG("Geometry buffers at shutdown: %llu of %llu vertex bytes free in %u ranges, %llu of %llu index bytes free in %u ranges.",
+           context.object_vertex_buffer.freelist.free_space, context.object_vertex_buffer.total_size, context.object_vertex_buffer.freelist.range_count,
+           context.object_index_buffer.freelist.free_space, context.object_index_buffer.total_size, context.object_index_buffer.freelist.range_count);
+
     // Destroy buffers
     KDEBUG("Destorying Vulkan Buffers...");
     vulkan_buffer_destroy(&context, &context.object_vertex_buffer);
     vulkan_buffer_destroy(&context, &context.object_index_buffer);
+    vulkan_buffer_destroy(&context, &context.instance_buffer);
+    vulkan_buffer_destroy(&context, &context.indirect_buffer);
 
     KDEBUG("Destroying Vulkan Object Shaders...");
     vulkan_material_shader_destroy(&context, &context.material_shader);
@@ -375,6 +575,9 @@ void vulkan_renderer_backend_shutdown(renderer_backend* backend) {
     KDEBUG("Destroying Vulkan Swapchain...");
     vulkan_swapchain_destroy(&context, &context.swapchain);
 
+    KDEBUG("Destroying Vulkan memory allocator...");
+    vulkan_memory_allocator_destroy(&context, &context.memory_allocator);
+
     KDEBUG("Destroying logical device...");
     vulkan_device_destroy(&context);
 
@@ -397,6 +600,8 @@ void vulkan_renderer_backend_shutdown(renderer_backend* backend) {
     KDEBUG("Destroying Vulkan instance...");
     vkDestroyInstance(context.instance, context.allocator);
     context.instance = 0;
+
+    pool_allocator_destroy(&context.texture_data_pool);
 }
 
 void vulkan_renderer_backend_on_resized(renderer_backend* backend, u16 width, u16 height) {
@@ -412,29 +617,18 @@ void vulkan_renderer_backend_on_resized(renderer_backend* backend, u16 width, u1
 
 b8 vulkan_renderer_backend_begin_frame(renderer_backend* backend, f32 delta_time) {
     context.frame_delta_time = delta_time;
+    context.frame_number = backend->frame_number;
     vulkan_device* device = &context.device;
 
     // Check if recreating swap chain and boot out.
     if (context.recreating_swapchain) {
-        VkResult result = vkDeviceWaitIdle(device->logical_device);
-
-        if (!vulkan_result_is_success(result)) {
-            KERROR("vulkan_renderer_backend_begin_frame vkDeviceWaitIdle (1) failed: '%s'", vulkan_result_string(result, True));
-            return False;
-        }
-
         KINFO("Recreating swapchain, booting.");
         return False;
     }
 
     // Check if the framebuffer has been resized. If so, a new swapchain must be created.
+    // recreate_swapchain() waits for the device itself, as the old swapchain may still be in use.
     if (context.framebuffer_size_generation != context.framebuffer_size_last_generation) {
-        VkResult result = vkDeviceWaitIdle(device->logical_device);
-        if (!vulkan_result_is_success(result)) {
-            KERROR("vulkan_renderer_backend_begin_frame vkDeviceWaitIdle (2) failed: '%s'", vulkan_result_string(result, True));
-            return False;
-        }
-
         // If the swapchain recreation failed (because, for example, the window was minimized),
         // boot out before unsetting the flag.
         if (!recreate_swapchain(backend)) {
@@ -455,6 +649,9 @@ b8 vulkan_renderer_backend_begin_frame(renderer_backend* backend, f32 delta_time
         return False;
     }
 
+    // The frame that last used this slot is finished, so whatever was released against it can go.
+    vulkan_deletion_queue_flush(&context, &context.deletion_queue, context.current_frame);
+
     // Acquire the next image from the swap chain. Pass along the semaphore that should signaled when this completes.
     // This same semaphore will later be waited on by the queue submission to ensure this image is available.
     if (!vulkan_swapchain_acquire_next_image_index(
@@ -490,6 +687,14 @@ b8 vulkan_renderer_backend_begin_frame(renderer_backend* backend, f32 delta_time
     vkCmdSetViewport(command_buffer->handle, 0, 1, &viewport);
     vkCmdSetScissor(command_buffer->handle, 0, 1, &scissor);
 
+    // Take ownership of anything the transfer queue has finished uploading since the last frame.
+    vulkan_staging_ring_acquire(&context, &context.staging, command_buffer);
+
+    context.frame_in_progress = True;
+
+    // Copies cannot be recorded within the render pass, so the geometry buffers are compacted ahead of it.
+    compact_geometry_buffers(command_buffer);
+
     context.main_renderpass.w = context.framebuffer_width;
     context.main_renderpass.h = context.framebuffer_height;
 
@@ -534,6 +739,11 @@ b8 vulkan_renderer_backend_end_frame(renderer_backend* backend, f32 delta_time)
     // Mark the image fence as in-use by this frame.
     context.images_in_flight[context.image_index] = &context.in_flight_fences[context.current_frame];
 
+    // Submit the uploads made since the last frame ahead of the frame that may use them.
+    if (!vulkan_staging_ring_flush(&context, &context.staging)) {
+        return False;
+    }
+
     // Reset the fence for use on the next frame
     vulkan_fence_reset(&context, &context.in_flight_fences[context.current_frame]);
 
@@ -550,15 +760,26 @@ b8 vulkan_renderer_backend_end_frame(renderer_backend* backend, f32 delta_time)
     submit_info.pSignalSemaphores = &context.queue_complete_semaphores[context.current_frame];
 
     // Wait semaphore ensures that the operation cannot begin until the image is available.
-    submit_info.waitSemaphoreCount = 1;
-    submit_info.pWaitSemaphores = &context.image_available_semaphores[context.current_frame];
+    // If any uploads were acquired, also wait on the transfer queue's timeline semaphore until they are complete.
+    // This never blocks the frame on uploads still in progress, as only completed ones are acquired.
+    VkSemaphore wait_semaphores[2] = {context.image_available_semaphores[context.current_frame], context.staging.timeline};
+    u64 wait_values[2] = {0, context.staging.acquired_value};
+    submit_info.waitSemaphoreCount = context.staging.acquired_value > 0 ? 2 : 1;
+    submit_info.pWaitSemaphores = wait_semaphores;
+
+    VkTimelineSemaphoreSubmitInfo timeline_info = {VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO};
+    timeline_info.waitSemaphoreValueCount = submit_info.waitSemaphoreCount;
+    timeline_info.pWaitSemaphoreValues = wait_values;
+    submit_info.pNext = &timeline_info;
 
     /*
      * Each semaphore waits on the corresponding pipeline stage to complete. 1:1 ratio.
      * VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT prevents subsequent colour attachment
      * writes from executing until the semaphore signals (i.e. one frame is presented at a time)
      */
-    VkPipelineStageFlags flags[1] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+    VkPipelineStageFlags flags[2] = {
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT};
     submit_info.pWaitDstStageMask = flags;
 
     VkResult result = vkQueueSubmit(
@@ -574,6 +795,7 @@ b8 vulkan_renderer_backend_end_frame(renderer_backend* backend, f32 delta_time)
     }
 
     vulkan_command_buffer_update_submitted(command_buffer);  // End queue submission
+    context.frame_in_progress = False;
 
     // Give the image back to the swapchain.
     vulkan_swapchain_present(
@@ -695,6 +917,10 @@ b8 recreate_swapchain(renderer_backend* backend) {
     // Wait for any operations to complete.
     vkDeviceWaitIdle(context.device.logical_device);
 
+    // Frame indices restart with the new swapchain, and nothing is in flight, so destroy everything released
+    // that no unsubmitted upload still writes.
+    vulkan_deletion_queue_flush_all(&context, &context.deletion_queue);
+
     // Clear these out just in case.
     for (u32 i = 0; i < context.swapchain.image_count; ++i) {
         context.images_in_flight[i] = 0;
@@ -766,7 +992,10 @@ b8 create_buffers(vulkan_context* context) {
         KERROR("Error creating vertex buffer.");
         return False;
     }
-    context->geometry_vertex_offset = 0;
+    if (!vulkan_buffer_create_freelist(&context->object_vertex_buffer, VULKAN_MAX_GEOMETRY_COUNT + 1)) {
+        KERROR("Error creating vertex buffer free list.");
+        return False;
+    }
 
     const u64 index_buffer_size = sizeof(u32) * 1024 * 1024;
     if (!vulkan_buffer_create(
@@ -776,41 +1005,162 @@ b8 create_buffers(vulkan_context* context) {
             memory_property_flags,
             True,
             &context->object_index_buffer)) {
-        KERROR("Error creating vertex buffer.");
+        KERROR("Error creating index buffer.");
+        return False;
+    }
+    if (!vulkan_buffer_create_freelist(&context->object_index_buffer, VULKAN_MAX_GEOMETRY_COUNT + 1)) {
+        KERROR("Error creating index buffer free list.");
+        return False;
+    }
+
+    // Instance data is rewritten every frame, so it lives in host-visible memory.
+    u32 device_local_bits = context->device.supports_device_local_host_visible ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT : 0;
+    const u64 instance_buffer_size = sizeof(mat4) * VULKAN_MAX_INSTANCES_PER_FRAME * MAX_FRAMES_IN_FLIGHT;
+    if (!vulkan_buffer_create(
+            context,
+            instance_buffer_size,
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | device_local_bits,
+            True,
+            &context->instance_buffer)) {
+        KERROR("Error creating instance buffer.");
+        return False;
+    }
+
+    // The indirect draw list is also rewritten every frame.
+    if (!vulkan_buffer_create(
+            context,
+            VULKAN_INDIRECT_REGION_SIZE * MAX_FRAMES_IN_FLIGHT,
+            VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | device_local_bits,
+            True,
+            &context->indirect_buffer)) {
+        KERROR("Error creating indirect buffer.");
         return False;
     }
-    context->geometry_index_offset = 0;
 
     KDEBUG("Vulkan Buffers created successfully.");
     return True;
 }
 
-void vulkan_renderer_create_texture(const char* name, i32 width, i32 height, i32 channel_count, const u8* pixels, b8 has_transparency, texture* out_texture) {
+/**
+ * @brief Gets the Vulkan format a texture format is uploaded as.
+ *
+ * @param format The texture format.
+ * @return The matching VkFormat.
+ */
+static VkFormat texture_format_to_vulkan(texture_format format) {
+    switch (format) {
+        case TEXTURE_FORMAT_BC1:
+            // Only opaque textures are cooked to BC1, so its 1-bit alpha mode is never used.
+            return VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+        case TEXTURE_FORMAT_BC3:
+            return VK_FORMAT_BC3_UNORM_BLOCK;
+        case TEXTURE_FORMAT_RGBA8:
+        default:
+            return VK_FORMAT_R8G8B8A8_UNORM;
+    }
+}
+
+/**
+ * @brief Records the copies of every mip level of a texture through the staging ring.
+ *
+ * Each level is copied a band of rows at a time if it is larger than half the ring. Compressed
+ * levels are banded by whole rows of blocks.
+ *
+ * @param name The name of the texture, for logging.
+ * @param image The image to copy into, in the transfer destination layout.
+ * @param format The format of the pixel data.
+ * @param pixels The pixel data of every level, largest first.
+ * @return True if every level was copied; otherwise False.
+ */
+static b8 upload_texture_levels(const char* name, vulkan_image* image, texture_format format, const u8* pixels) {
+    u32 band_height = format == TEXTURE_FORMAT_RGBA8 ? 1 : 4;
+    const u8* level_pixels = pixels;
+    for (u32 level = 0; level < image->mip_levels; ++level) {
+        u32 level_width = KMAX(image->width >> level, 1u);
+        u32 level_height = KMAX(image->height >> level, 1u);
+        u64 level_size = ktex_level_size(format, level_width, level_height);
+        u32 band_count = (level_height + band_height - 1) / band_height;
+        u64 band_size = level_size / band_count;
+
+        u32 bands_per_copy = (u32)KMIN((u64)band_count, (context.staging.size / 2) / band_size);
+        if (bands_per_copy == 0) {
+            KERROR("vulkan_renderer_create_texture - A row of texture '%s' does not fit in the staging ring.", name);
+            return False;
+        }
+        for (u32 band = 0; band < band_count; band += bands_per_copy) {
+            u32 copy_band_count = KMIN(bands_per_copy, band_count - band);
+            u64 staging_offset = 0;
+            void* staging_memory = vulkan_staging_ring_allocate(&context, &context.staging, band_size * copy_band_count, VULKAN_STAGING_ALIGNMENT, &staging_offset);
+            if (!staging_memory) {
+                KERROR("vulkan_renderer_create_texture - Failed to allocate staging space for texture '%s'.", name);
+                return False;
+            }
+            kcopy_memory(staging_memory, level_pixels + (band_size * band), band_size * copy_band_count);
+
+            // The last band of blocks may hang off the bottom of the level.
+            u32 first_row = band * band_height;
+            u32 row_count = KMIN(copy_band_count * band_height, level_height - first_row);
+            vulkan_image_copy_from_buffer(
+                &context,
+                image,
+                context.staging.buffer.handle,
+                staging_offset,
+                level,
+                first_row,
+                row_count,
+                vulkan_staging_ring_command_buffer(&context, &context.staging));
+        }
+        level_pixels += level_size;
+    }
+    return True;
+}
+
+void vulkan_renderer_create_texture(const char* name, i32 width, i32 height, i32 channel_count, texture_format format, u32 mip_count, const u8* pixels, b8 has_transparency, texture* out_texture) {
     out_texture->width = width;
     out_texture->height = height;
     out_texture->channel_count = channel_count;
     out_texture->generation = INVALID_ID;
 
     // Internal data creation.
-    // TODO: Use an allocator for this.
-    out_texture->internal_data = (vulkan_texture_data*)kallocate(sizeof(vulkan_texture_data), MEMORY_TAG_TEXTURE);
+    out_texture->internal_data = (vulkan_texture_data*)pool_allocator_allocate(&context.texture_data_pool);
     vulkan_texture_data* data = (vulkan_texture_data*)out_texture->internal_data;
+    if (!data) {
+        KERROR("vulkan_renderer_create_texture - Failed to allocate internal data for texture '%s'.", name);
+        return;
+    }
+    // Pool blocks are not zeroed.
+    kzero_memory(data, sizeof(vulkan_texture_data));
+
+    // Devices that cannot sample block-compressed images get the levels decoded back to RGBA8.
+    u8* decoded = 0;
+    u64 decoded_size = 0;
+    if (format != TEXTURE_FORMAT_RGBA8 && !context.device.supports_bc_compression) {
+        decoded_size = ktex_data_size(TEXTURE_FORMAT_RGBA8, width, height, mip_count);
+        decoded = kallocate(decoded_size, MEMORY_TAG_TEXTURE);
+        const u8* source = pixels;
+        u8* target = decoded;
+        for (u32 level = 0; level < mip_count; ++level) {
+            u32 level_width = KMAX((u32)width >> level, 1u);
+            u32 level_height = KMAX((u32)height >> level, 1u);
+            ktex_decode(format, source, level_width, level_height, target);
+            source += ktex_level_size(format, level_width, level_height);
+            target += ktex_level_size(TEXTURE_FORMAT_RGBA8, level_width, level_height);
+        }
+        pixels = decoded;
+        format = TEXTURE_FORMAT_RGBA8;
+    }
+    out_texture->format = format;
+    out_texture->mip_count = mip_count;
 
-    VkDeviceSize image_size = width * height * channel_count;
-
-    // NOTE: Assumes 8 bits per channel.
-    VkFormat image_format = VK_FORMAT_R8G8B8A8_UNORM;
-
-    // Create a staging buffer and load data into it.
-    VkBufferUsageFlags usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-
-    VkMemoryPropertyFlags memory_prop_flags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-
-    vulkan_buffer staging;
-
-    vulkan_buffer_create(&context, image_size, usage, memory_prop_flags, True, &staging);
+    VkFormat image_format = texture_format_to_vulkan(format);
 
-    vulkan_buffer_load_data(&context, &staging, 0, image_size, 0, pixels);
+    // Block-compressed images can only be copied into and sampled.
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    if (format == TEXTURE_FORMAT_RGBA8) {
+        usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    }
 
     // NOTE: Lots of assumptions here, different texture types will require
     // different options here.
@@ -819,48 +1169,40 @@ void vulkan_renderer_create_texture(const char* name, i32 width, i32 height, i32
         VK_IMAGE_TYPE_2D,
         width,
         height,
+        mip_count,
         image_format,
         VK_IMAGE_TILING_OPTIMAL,
-        VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+        usage,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
         True,
         VK_IMAGE_ASPECT_COLOR_BIT,
         &data->image);
 
-    vulkan_command_buffer temp_buffer;
-
-    VkCommandPool pool = context.device.graphics_command_pool;
-
-    VkQueue queue = context.device.graphics_queue;
-
-    vulkan_command_buffer_allocate_and_begin_single_use(&context, pool, &temp_buffer);
-
     // Transition the layout from whatever it is currently to optimal for recieving data.
     vulkan_image_transition_layout(
         &context,
-        &temp_buffer,
+        vulkan_staging_ring_command_buffer(&context, &context.staging),
         &data->image,
         image_format,
         VK_IMAGE_LAYOUT_UNDEFINED,
         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 
-    // Copy the data from the buffer.
-    vulkan_image_copy_from_buffer(&context, &data->image, staging.handle, &temp_buffer);
-
-    // Transition from optimal for data reciept to shader-read-only optimal layout.
-    vulkan_image_transition_layout(
-        &context,
-        &temp_buffer,
-        &data->image,
-        image_format,
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
-    // End the command buffer and wait for execution (ensures copy is done)
-    vulkan_command_buffer_end_single_use(&context, pool, &temp_buffer, queue);
+    b8 uploaded = upload_texture_levels(name, &data->image, format, pixels);
+    if (decoded) {
+        kfree(decoded, decoded_size, MEMORY_TAG_TEXTURE);
+    }
+    if (!uploaded) {
+        // The upload batch may already reference the image, so its destruction is deferred.
+        vulkan_deletion_queue_push_image(&context, &context.deletion_queue, &data->image);
+        pool_allocator_free(&context.texture_data_pool, data);
+        out_texture->internal_data = 0;
+        return;
+    }
 
-    // Destroy buffer
-    vulkan_buffer_destroy(&context, &staging);
+    // Hand the image over to the graphics queue, transitioning it to shader-read-only optimal layout.
+    // It is not sampled until the upload's ticket is complete.
+    vulkan_staging_ring_release_image(&context, &context.staging, &data->image);
+    data->upload_ticket = vulkan_staging_ring_ticket(&context.staging);
 
     // Create a sampler for the texture
     VkSamplerCreateInfo sampler_info = {VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
@@ -886,7 +1228,7 @@ void vulkan_renderer_create_texture(const char* name, i32 width, i32 height, i32
     sampler_info.mipLodBias = 0.0f;
 
     sampler_info.minLod = 0.0f;
-    sampler_info.maxLod = 0.0f;
+    sampler_info.maxLod = (f32)mip_count;
 
     VkResult result = vkCreateSampler(context.device.logical_device, &sampler_info, context.allocator, &data->sampler);
 
@@ -901,25 +1243,27 @@ void vulkan_renderer_create_texture(const char* name, i32 width, i32 height, i32
 }
 
 void vulkan_renderer_destroy_texture(struct texture* texture) {
-    vkDeviceWaitIdle(context.device.logical_device);
-
     vulkan_texture_data* data = (vulkan_texture_data*)texture->internal_data;
 
     if (data) {
-        vulkan_image_destroy(&context, &data->image);
-
-        kzero_memory(&data->image, sizeof(vulkan_image));
-
-        vkDestroySampler(context.device.logical_device, data->sampler, context.allocator);
+        // Frames in flight may still be sampling the image, so its destruction is deferred.
+        vulkan_staging_ring_discard_image(&context.staging, data->image.handle);
+        vulkan_deletion_queue_push_image(&context, &context.deletion_queue, &data->image);
+        vulkan_deletion_queue_push_sampler(&context, &context.deletion_queue, data->sampler);
 
         data->sampler = 0;
 
-        kfree(texture->internal_data, sizeof(vulkan_texture_data), MEMORY_TAG_TEXTURE);
+        pool_allocator_free(&context.texture_data_pool, texture->internal_data);
     }
 
     kzero_memory(texture, sizeof(struct texture));
 }
 
+b8 vulkan_renderer_texture_is_ready(texture* texture) {
+    vulkan_texture_data* data = (vulkan_texture_data*)texture->internal_data;
+    return data && vulkan_staging_ring_ticket_complete(&context.staging, data->upload_ticket);
+}
+
 b8 vulkan_renderer_create_material(struct material* material) {
     if (material) {
         if (!vulkan_material_shader_acquire_resources(&context, &context.material_shader, material)) {
@@ -969,15 +1313,13 @@ b8 vulkan_renderer_create_geometry(geometry* geometry, u32 vertex_count, const v
         old_range.vertex_count = internal_data->vertex_count;
         old_range.vertex_size = internal_data->vertex_size;
     } else {
-        // Search for a free index and use it.
-        for (u32 i = 0; i < VULKAN_MAX_GEOMETRY_COUNT; ++i) {
-            if (context.geometries[i].id == INVALID_ID) {
-                // Found a free index.
-                geometry->internal_id = i;
-                context.geometries[i].id = i;
-                internal_data = &context.geometries[i];
-                break;
-            }
+        // Take a free index.
+        khandle handle;
+        if (handle_pool_acquire(&context.geometry_slots, &handle)) {
+            u32 i = handle_pool_index(handle);
+            geometry->internal_id = i;
+            context.geometries[i].id = i;
+            internal_data = &context.geometries[i];
         }
     }
     if (!internal_data) {
@@ -985,31 +1327,41 @@ b8 vulkan_renderer_create_geometry(geometry* geometry, u32 vertex_count, const v
         return False;
     }
 
-    VkCommandPool pool = context.device.graphics_command_pool;
-    VkQueue queue = context.device.graphics_queue;
-
     // Vertex data.
-    internal_data->vertex_buffer_offset = context.geometry_vertex_offset;
     internal_data->vertex_count = vertex_count;
     internal_data->vertex_size = sizeof(vertex_3d) * vertex_count;
+    if (!allocate_data_range(&context.object_vertex_buffer, internal_data->vertex_size, &internal_data->vertex_buffer_offset)) {
+        KERROR("vulkan_renderer_create_geometry - Failed to allocate vertex data.");
+        return False;
+    }
 
-    upload_data_range(&context, pool, 0, queue, &context.object_vertex_buffer, internal_data->vertex_buffer_offset, internal_data->vertex_size, vertices);
-
-    // TODO: should maintain a free list instead of this.
-    context.geometry_vertex_offset += internal_data->vertex_size;
+    if (!upload_data_range(&context, &context.object_vertex_buffer, internal_data->vertex_buffer_offset, internal_data->vertex_size, vertices)) {
+        KERROR("vulkan_renderer_create_geometry - Failed to upload vertex data.");
+        return False;
+    }
 
     // Index data, if applicable
     if (index_count && indices) {
-        internal_data->index_buffer_offset = context.geometry_index_offset;
         internal_data->index_count = index_count;
         internal_data->index_size = sizeof(u32) * index_count;
+        if (!allocate_data_range(&context.object_index_buffer, internal_data->index_size, &internal_data->index_buffer_offset)) {
+            KERROR("vulkan_renderer_create_geometry - Failed to allocate index data.");
+            return False;
+        }
 
-        upload_data_range(&context, pool, 0, queue, &context.object_index_buffer, internal_data->index_buffer_offset, internal_data->index_size, indices);
-
-        // TODO: should maintain a free list instead of this.
-        context.geometry_index_offset += internal_data->index_size;
+        if (!upload_data_range(&context, &context.object_index_buffer, internal_data->index_buffer_offset, internal_data->index_size, indices)) {
+            KERROR("vulkan_renderer_create_geometry - Failed to upload index data.");
+            return False;
+        }
+    } else {
+        internal_data->index_buffer_offset = 0;
+        internal_data->index_count = 0;
+        internal_data->index_size = 0;
     }
 
+    // The geometry is not drawn until its upload has completed.
+    internal_data->upload_ticket = vulkan_staging_ring_ticket(&context.staging);
+
     if (internal_data->generation == INVALID_ID) {
         internal_data->generation = 0;
     } else {
@@ -1031,7 +1383,6 @@ b8 vulkan_renderer_create_geometry(geometry* geometry, u32 vertex_count, const v
 
 void vulkan_renderer_destroy_geometry(geometry* geometry) {
     if (geometry && geometry->internal_id != INVALID_ID) {
-        vkDeviceWaitIdle(context.device.logical_device);  // Kind of overkill but hey, better safe ...!
         vulkan_geometry_data* internal_data = &context.geometries[geometry->internal_id];
 
         // Free vertex data
@@ -1042,54 +1393,172 @@ void vulkan_renderer_destroy_geometry(geometry* geometry) {
             free_data_range(&context.object_index_buffer, internal_data->index_buffer_offset, internal_data->index_size);
         }
 
-        // Clean up data.
+        // Clean up data, and free the slot.
         kzero_memory(internal_data, sizeof(vulkan_geometry_data));
         internal_data->id = INVALID_ID;
         internal_data->generation = INVALID_ID;
+        handle_pool_release(&context.geometry_slots, handle_pool_handle_at(&context.geometry_slots, geometry->internal_id));
     }
 }
 
-void vulkan_backend_draw_geometry(geometry_render_data data) {
-    // Ignore non-uploaded geometries
-    if (data.geometry && data.geometry->internal_id == INVALID_ID) {
+/** @brief Issues a batch as a direct draw. */
+static void draw_batch_direct(vulkan_command_buffer* command_buffer, const vulkan_geometry_data* buffer_data, u32 instance_count, u32 first_instance) {
+    // Geometry offsets are always multiples of the element size, as every range is allocated in whole elements.
+    u32 first_vertex = (u32)(buffer_data->vertex_buffer_offset / sizeof(vertex_3d));
+    if (buffer_data->index_count > 0) {
+        u32 first_index = (u32)(buffer_data->index_buffer_offset / sizeof(u32));
+        vkCmdDrawIndexed(command_buffer->handle, buffer_data->index_count, instance_count, first_index, (i32)first_vertex, first_instance);
+    } else {
+        vkCmdDraw(command_buffer->handle, buffer_data->vertex_count, instance_count, first_vertex, first_instance);
+    }
+}
+
+/**
+ * @brief Issues a run of indirect draw commands written to the frame's region of the indirect buffer.
+ */
+static void draw_indirect_run(vulkan_command_buffer* command_buffer, u64 region_offset, u32* counts, u32 first_command, u32 command_count) {
+    if (command_count == 0) {
         return;
     }
 
-    vulkan_geometry_data* buffer_data = &context.geometries[data.geometry->internal_id];
-    vulkan_command_buffer* command_buffer = &context.graphics_command_buffers[context.image_index];
+    u64 command_offset = region_offset + sizeof(VkDrawIndexedIndirectCommand) * first_command;
+    if (context.device.supports_draw_indirect_count) {
+        // The count is read from the buffer, so it could later be written by the GPU, e.g. by culling.
+        // Each run takes the count slot matching its first command, so runs never share one.
+        counts[first_command] = command_count;
+        u64 count_offset = region_offset + sizeof(VkDrawIndexedIndirectCommand) * VULKAN_MAX_INDIRECT_DRAWS_PER_FRAME + sizeof(u32) * first_command;
+        vkCmdDrawIndexedIndirectCount(
+            command_buffer->handle,
+            context.indirect_buffer.handle,
+            command_offset,
+            context.indirect_buffer.handle,
+            count_offset,
+            command_count,
+            sizeof(VkDrawIndexedIndirectCommand));
+    } else {
+        vkCmdDrawIndexedIndirect(command_buffer->handle, context.indirect_buffer.handle, command_offset, command_count, sizeof(VkDrawIndexedIndirectCommand));
+    }
+}
 
-    // TODO: check if this is actually needed.
-    vulkan_material_shader_use(&context, &context.material_shader);
+/**
+ * @brief Writes the indexed batches to the frame's draw list and draws each run of batches sharing
+ * a material with one indirect draw. Non-indexed batches, and any past the frame's command limit,
+ * are drawn directly.
+ */
+static void draw_batches_indirect(vulkan_command_buffer* command_buffer, u32 transform_count, const render_batch* batches, u32 batch_count) {
+    u64 region_offset = VULKAN_INDIRECT_REGION_SIZE * context.current_frame;
+    u8* region = vulkan_buffer_lock_memory(&context, &context.indirect_buffer, region_offset, VULKAN_INDIRECT_REGION_SIZE, 0);
+    VkDrawIndexedIndirectCommand* commands = (VkDrawIndexedIndirectCommand*)region;
+    u32* counts = (u32*)(region + sizeof(VkDrawIndexedIndirectCommand) * VULKAN_MAX_INDIRECT_DRAWS_PER_FRAME);
+
+    u32 command_count = 0;
+    u32 run_start = 0;
+    material* bound_material = 0;
+    for (u32 i = 0; i < batch_count; ++i) {
+        const render_batch* batch = &batches[i];
+        if (batch->first_instance >= transform_count) {
+            break;
+        }
+        u32 instance_count = KMIN(batch->instance_count, transform_count - batch->first_instance);
 
-    vulkan_material_shader_set_model(&context, &context.material_shader, data.model);
+        vulkan_geometry_data* buffer_data = &context.geometries[batch->geometry->internal_id];
 
-    material* m = 0;
-    if (data.geometry->material) {
-        m = data.geometry->material;
-    } else {
-        m = material_system_get_default();
+        // Skip geometries whose upload is still in flight.
+        if (!vulkan_staging_ring_ticket_complete(&context.staging, buffer_data->upload_ticket)) {
+            continue;
+        }
+
+        // A new material ends the run drawn with the previous one.
+        if (batch->material != bound_material) {
+            draw_indirect_run(command_buffer, region_offset, counts, run_start, command_count - run_start);
+            run_start = command_count;
+
+            vulkan_material_shader_apply_material(&context, &context.material_shader, batch->material);
+            bound_material = batch->material;
+        }
+
+        if (buffer_data->index_count == 0) {
+            draw_batch_direct(command_buffer, buffer_data, instance_count, batch->first_instance);
+            continue;
+        }
+
+        // The draw list is full, so the rest are drawn directly with the material already bound.
+        if (command_count == VULKAN_MAX_INDIRECT_DRAWS_PER_FRAME) {
+            static b8 warned = False;
+            if (!warned) {
+                KWARN("draw_batches_indirect - more than %u batches in a frame. The rest are drawn directly.", VULKAN_MAX_INDIRECT_DRAWS_PER_FRAME);
+                warned = True;
+            }
+            draw_batch_direct(command_buffer, buffer_data, instance_count, batch->first_instance);
+            continue;
+        }
+
+        VkDrawIndexedIndirectCommand* command = &commands[command_count++];
+        command->indexCount = buffer_data->index_count;
+        command->instanceCount = instance_count;
+        command->firstIndex = (u32)(buffer_data->index_buffer_offset / sizeof(u32));
+        command->vertexOffset = (i32)(buffer_data->vertex_buffer_offset / sizeof(vertex_3d));
+        command->firstInstance = batch->first_instance;
     }
+    draw_indirect_run(command_buffer, region_offset, counts, run_start, command_count - run_start);
 
-    vulkan_material_shader_apply_material(&context, &context.material_shader, m);
+    vulkan_buffer_unlock_memory(&context, &context.indirect_buffer);
+}
 
-    vkCmdBindPipeline(
-        command_buffer->handle,
-        VK_PIPELINE_BIND_POINT_GRAPHICS,
-        context.material_shader.pipeline.handle);
+void vulkan_backend_draw_batches(const mat4* transforms, u32 transform_count, const render_batch* batches, u32 batch_count, renderer_draw_mode mode) {
+    vulkan_command_buffer* command_buffer = &context.graphics_command_buffers[context.image_index];
 
-    // Bind vertex buffer at offset.
-    VkDeviceSize offsets[1] = {buffer_data->vertex_buffer_offset};
+    if (transform_count > VULKAN_MAX_INSTANCES_PER_FRAME) {
+        KWARN("vulkan_backend_draw_batches - %u instances exceeds the limit of %u per frame. The rest are not drawn.", transform_count, VULKAN_MAX_INSTANCES_PER_FRAME);
+        transform_count = VULKAN_MAX_INSTANCES_PER_FRAME;
+    }
 
-    vkCmdBindVertexBuffers(command_buffer->handle, 0, 1, &context.object_vertex_buffer.handle, (VkDeviceSize*)offsets);
+    // Write this frame's transforms into its region of the instance buffer.
+    u64 instance_offset = sizeof(mat4) * VULKAN_MAX_INSTANCES_PER_FRAME * context.current_frame;
+    vulkan_buffer_load_data(&context, &context.instance_buffer, instance_offset, sizeof(mat4) * transform_count, 0, transforms);
+
+    // The pipeline and global state are already bound by update_global_state. Every geometry lives
+    // in the shared vertex and index buffers, so they are bound once, and each draw addresses its
+    // geometry by its first vertex and index.
+    VkBuffer vertex_buffers[2] = {context.object_vertex_buffer.handle, context.instance_buffer.handle};
+    VkDeviceSize offsets[2] = {0, instance_offset};
+    vkCmdBindVertexBuffers(command_buffer->handle, 0, 2, vertex_buffers, offsets);
+    vkCmdBindIndexBuffer(command_buffer->handle, context.object_index_buffer.handle, 0, VK_INDEX_TYPE_UINT32);
+
+    if (mode == RENDERER_DRAW_MODE_INDIRECT) {
+        if (context.device.supports_multi_draw_indirect) {
+            draw_batches_indirect(command_buffer, transform_count, batches, batch_count);
+            return;
+        }
 
-    // Draw indexed or non-indexed.
-    if (buffer_data->index_count > 0) {
-        // Bind index buffer at offset.
-        vkCmdBindIndexBuffer(command_buffer->handle, context.object_index_buffer.handle, buffer_data->index_buffer_offset, VK_INDEX_TYPE_UINT32);
+        static b8 warned = False;
+        if (!warned) {
+            KWARN("The device does not support multi-draw indirect. Drawing directly instead.");
+            warned = True;
+        }
+    }
 
-        // Issue the draw.
-        vkCmdDrawIndexed(command_buffer->handle, buffer_data->index_count, 1, 0, 0, 0);
-    } else {
-        vkCmdDraw(command_buffer->handle, buffer_data->vertex_count, 1, 0, 0);
+    material* bound_material = 0;
+    for (u32 i = 0; i < batch_count; ++i) {
+        const render_batch* batch = &batches[i];
+        if (batch->first_instance >= transform_count) {
+            break;
+        }
+        u32 instance_count = KMIN(batch->instance_count, transform_count - batch->first_instance);
+
+        vulkan_geometry_data* buffer_data = &context.geometries[batch->geometry->internal_id];
+
+        // Skip geometries whose upload is still in flight.
+        if (!vulkan_staging_ring_ticket_complete(&context.staging, buffer_data->upload_ticket)) {
+            continue;
+        }
+
+        // Batches are sorted by material, so it only changes between runs.
+        if (batch->material != bound_material) {
+            vulkan_material_shader_apply_material(&context, &context.material_shader, batch->material);
+            bound_material = batch->material;
+        }
+
+        draw_batch_direct(command_buffer, buffer_data, instance_count, batch->first_instance);
     }
 }
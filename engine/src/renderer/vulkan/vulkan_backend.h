@@ -115,26 +115,18 @@ b8 recreate_swapchain(renderer_backend* backend);
 /**
  * @brief Uploads data to a specified range of a Vulkan buffer.
  *
- * This function creates a staging buffer, uploads the data to it, and then copies it to the
- * specified Vulkan buffer.
+ * The data is written into the staging ring and a copy to the buffer is recorded into the
+ * current upload batch, which is submitted at the end of the frame. Uploads larger than the
+ * ring are split into several copies.
  *
  * @param context The Vulkan context.
- * @param pool The command pool to use for buffer operations.
- * @param fence The fence to signal when the operation is complete.
- * @param queue The queue to submit the copy command to.
  * @param buffer The Vulkan buffer to upload data to.
  * @param offset The offset within the buffer to upload data to.
  * @param size The size of the data to upload.
  * @param data The data to upload.
+ * @return True on success; otherwise False.
  */
-void upload_data_range(vulkan_context* context,
-                       VkCommandPool pool,
-                       VkFence fence,
-                       VkQueue queue,
-                       vulkan_buffer* buffer,
-                       u64 offset,
-                       u64 size,
-                       const void* data);
+b8 upload_data_range(vulkan_context* context, vulkan_buffer* buffer, u64 offset, u64 size, const void* data);
 
 /**
  * @brief Initializes the Vulkan renderer backend.
@@ -142,11 +134,10 @@ void upload_data_range(vulkan_context* context,
  * Creates the Vulkan instance and prepares internal resources needed for rendering.
  *
  * @param backend A pointer to the renderer backend structure.
- * @param application_name Name of the application using the renderer.
- * @param plat_state A pointer to the platform-specific state.
+ * @param config A pointer to the backend configuration.
  * @return True if successful; otherwise False.
  */
-b8 vulkan_renderer_backend_initialize(renderer_backend* backend, const char* application_name);
+b8 vulkan_renderer_backend_initialize(renderer_backend* backend, const renderer_backend_config* config);
 
 /**
  * @brief Shuts down the Vulkan renderer backend.
@@ -206,12 +197,23 @@ b8 vulkan_renderer_backend_end_frame(renderer_backend* backend, f32 delta_time);
 void vulkan_renderer_update_global_state(mat4 projection, mat4 view, vec3 view_position, vec4 ambient_colour, i32 mode);
 
 /**
- * @brief Updates the model matrix for a specific object in the Vulkan backend.
+ * @brief Draws a frame's batches in the Vulkan backend.
  *
- * @param model The model matrix for the object.
- * @return void
+ * The transforms are written to the current frame's region of the instance buffer. The shared
+ * vertex and index buffers are bound once, and each batch is one instanced draw. The material is
+ * only applied when it changes.
+ *
+ * In the indirect draw mode, the indexed batches are instead written to the current frame's region
+ * of the indirect buffer, and each run of batches sharing a material is one indirect multi-draw,
+ * which takes its draw count from the buffer where vkCmdDrawIndexedIndirectCount is supported.
+ *
+ * @param transforms The model matrices of every instance, in batch order.
+ * @param transform_count The number of transforms.
+ * @param batches The batches to draw, sorted so that equal state is adjacent.
+ * @param batch_count The number of batches.
+ * @param mode How the draws are submitted.
  */
-void vulkan_backend_draw_geometry(geometry_render_data data);
+void vulkan_backend_draw_batches(const mat4* transforms, u32 transform_count, const render_batch* batches, u32 batch_count, renderer_draw_mode mode);
 
 /**
  * @brief Creates a texture in the Vulkan renderer backend.
@@ -222,11 +224,14 @@ void vulkan_backend_draw_geometry(geometry_render_data data);
  * @param width The width of the texture in pixels.
  * @param height The height of the texture in pixels.
  * @param channel_count The number of channels in the texture (e.g., 4 for RGBA).
- * @param pixels Pointer to the pixel data to upload to the texture.
+ * @param format The format of the pixel data. Block-compressed formats are decoded first if the
+ * device cannot sample them.
+ * @param mip_count The number of mip levels in the pixel data.
+ * @param pixels Pointer to the pixel data to upload to the texture, every mip level in turn.
  * @param has_transparency Whether the texture has an alpha channel for transparency.
  * @param out_texture Pointer to the texture structure to fill with the created texture.
  */
-void vulkan_renderer_create_texture(const char* name, i32 width, i32 height, i32 channel_count, const u8* pixels, b8 has_transparency, texture* out_texture);
+void vulkan_renderer_create_texture(const char* name, i32 width, i32 height, i32 channel_count, texture_format format, u32 mip_count, const u8* pixels, b8 has_transparency, texture* out_texture);
 
 /**
  * @brief Destroys a texture in the Vulkan renderer backend.
@@ -237,6 +242,14 @@ void vulkan_renderer_create_texture(const char* name, i32 width, i32 height, i32
  */
 void vulkan_renderer_destroy_texture(texture* texture);
 
+/**
+ * @brief Indicates whether a texture's upload has completed and the graphics queue owns its image.
+ *
+ * @param texture Pointer to the texture to check.
+ * @return True if the texture can be sampled; otherwise False.
+ */
+b8 vulkan_renderer_texture_is_ready(texture* texture);
+
 /**
  * @brief Creates a material resource.
  *
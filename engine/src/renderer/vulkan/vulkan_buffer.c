@@ -3,6 +3,7 @@
 #include "vulkan_buffer.h"
 #include "vulkan_command_buffer.h"
 #include "vulkan_device.h"
+#include "vulkan_memory.h"
 #include "vulkan_utils.h"
 
 /**
@@ -36,23 +37,15 @@ b8 vulkan_buffer_create(
 
     VkMemoryRequirements requirements;
     vkGetBufferMemoryRequirements(context->device.logical_device, out_buffer->handle, &requirements);
-    out_buffer->memory_index = context->find_memory_index(requirements.memoryTypeBits, memory_property_flags);
-    if (out_buffer->memory_index == -1) {
-        KERROR("Failed to create vulkan buffer: No suitable memory type index was found!");
-        return False;
-    }
 
-    // Allocate the memory info
-    VkMemoryAllocateInfo allocate_info = {VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
-    allocate_info.allocationSize = requirements.size;
-    allocate_info.memoryTypeIndex = (u32)out_buffer->memory_index;
-
-    // Allocate the memory
-    VkResult result = vkAllocateMemory(context->device.logical_device, &allocate_info, context->allocator, &out_buffer->memory);
-    if (result != VK_SUCCESS) {
-        KERROR("Unable to create vulkan buffer because the required memory allocation failed. Error: i%", result);
+    // Sub-allocate the memory.
+    if (!vulkan_memory_allocate(context, &context->memory_allocator, &requirements, memory_property_flags, VULKAN_MEMORY_RESOURCE_TYPE_LINEAR, &out_buffer->allocation)) {
+        KERROR("Unable to create vulkan buffer because the required memory allocation failed.");
+        vkDestroyBuffer(context->device.logical_device, out_buffer->handle, context->allocator);
+        out_buffer->handle = 0;
         return False;
     }
+    out_buffer->memory_index = (i32)out_buffer->allocation.memory_type_index;
 
     if (bind_on_create) {
         vulkan_buffer_bind(context, out_buffer, 0);
@@ -63,16 +56,19 @@ b8 vulkan_buffer_create(
 
 void vulkan_buffer_destroy(vulkan_context* context, vulkan_buffer* buffer) {
     KDEBUG("Destroying vulkan buffer %p", buffer->handle);
-    if (buffer->memory) {
-        vkFreeMemory(context->device.logical_device, buffer->memory, context->allocator);
-        buffer->memory = 0;
-    }
-
     if (buffer->handle) {
         vkDestroyBuffer(context->device.logical_device, buffer->handle, context->allocator);
         buffer->handle = 0;
     }
 
+    vulkan_memory_free(context, &context->memory_allocator, &buffer->allocation);
+
+    if (buffer->freelist_memory) {
+        freelist_destroy(&buffer->freelist);
+        kfree(buffer->freelist_memory, buffer->freelist_memory_requirement, MEMORY_TAG_RENDERER);
+        buffer->freelist_memory = 0;
+    }
+
     buffer->total_size = 0;
     buffer->usage = 0;
     buffer->is_locked = False;
@@ -97,21 +93,16 @@ b8 vulkan_buffer_resize(
     VkMemoryRequirements requirements;
     vkGetBufferMemoryRequirements(context->device.logical_device, new_buffer, &requirements);
 
-    // Allocate memory info
-    VkMemoryAllocateInfo allocate_info = {VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
-    allocate_info.allocationSize = requirements.size;
-    allocate_info.memoryTypeIndex = (u32)buffer->memory_index;
-
-    // Allocate the memory.
-    VkDeviceMemory new_memory;
-    VkResult result = vkAllocateMemory(context->device.logical_device, &allocate_info, context->allocator, &new_memory);
-    if (result != VK_SUCCESS) {
-        KERROR("Unable to resize vulkan buffer because the required memory allocation failed. Error: %i", result);
+    // Sub-allocate the memory.
+    vulkan_memory_allocation new_allocation;
+    if (!vulkan_memory_allocate(context, &context->memory_allocator, &requirements, buffer->memory_property_flags, VULKAN_MEMORY_RESOURCE_TYPE_LINEAR, &new_allocation)) {
+        KERROR("Unable to resize vulkan buffer because the required memory allocation failed.");
+        vkDestroyBuffer(context->device.logical_device, new_buffer, context->allocator);
         return False;
     }
 
     // Bind the new buffer's memory
-    VK_CHECK(vkBindBufferMemory(context->device.logical_device, new_buffer, new_memory, 0));
+    VK_CHECK(vkBindBufferMemory(context->device.logical_device, new_buffer, new_allocation.memory, new_allocation.offset));
 
     // Copy over the data
     vulkan_buffer_copy_to(context, pool, 0, queue, buffer->handle, 0, new_buffer, 0, buffer->total_size);
@@ -120,42 +111,78 @@ b8 vulkan_buffer_resize(
     vkDeviceWaitIdle(context->device.logical_device);
 
     // Destroy the old
-    if (buffer->memory) {
-        vkFreeMemory(context->device.logical_device, buffer->memory, context->allocator);
-        buffer->memory = 0;
-    }
     if (buffer->handle) {
         vkDestroyBuffer(context->device.logical_device, buffer->handle, context->allocator);
         buffer->handle = 0;
     }
+    vulkan_memory_free(context, &context->memory_allocator, &buffer->allocation);
 
     // Set new properties
     buffer->total_size = new_size;
-    buffer->memory = new_memory;
+    buffer->allocation = new_allocation;
     buffer->handle = new_buffer;
 
+    // The new space is free.
+    if (buffer->freelist_memory && !freelist_resize(&buffer->freelist, new_size)) {
+        KERROR("vulkan_buffer_resize - Failed to grow the buffer's free list.");
+        return False;
+    }
+
     return True;
 }
 
+b8 vulkan_buffer_create_freelist(vulkan_buffer* buffer, u32 max_ranges) {
+    if (buffer->freelist_memory) {
+        KERROR("vulkan_buffer_create_freelist - The buffer already has a free list.");
+        return False;
+    }
+
+    if (!freelist_create(buffer->total_size, max_ranges, &buffer->freelist_memory_requirement, 0, 0)) {
+        return False;
+    }
+    buffer->freelist_memory = kallocate(buffer->freelist_memory_requirement, MEMORY_TAG_RENDERER);
+    return freelist_create(buffer->total_size, max_ranges, &buffer->freelist_memory_requirement, buffer->freelist_memory, &buffer->freelist);
+}
+
+b8 vulkan_buffer_allocate(vulkan_buffer* buffer, u64 size, u64* out_offset) {
+    if (!buffer->freelist_memory) {
+        KERROR("vulkan_buffer_allocate - The buffer has no free list.");
+        return False;
+    }
+    return freelist_allocate_block(&buffer->freelist, size, out_offset);
+}
+
+b8 vulkan_buffer_free(vulkan_buffer* buffer, u64 size, u64 offset) {
+    if (!buffer->freelist_memory) {
+        KERROR("vulkan_buffer_free - The buffer has no free list.");
+        return False;
+    }
+    return freelist_free_block(&buffer->freelist, size, offset);
+}
+
 void vulkan_buffer_bind(vulkan_context* context, vulkan_buffer* buffer, u64 offset) {
-    VK_CHECK(vkBindBufferMemory(context->device.logical_device, buffer->handle, buffer->memory, offset));
+    VK_CHECK(vkBindBufferMemory(context->device.logical_device, buffer->handle, buffer->allocation.memory, buffer->allocation.offset + offset));
 }
 
 void* vulkan_buffer_lock_memory(vulkan_context* context, vulkan_buffer* buffer, u64 offset, u64 size, u32 flags) {
-    void* data;
-    VK_CHECK(vkMapMemory(context->device.logical_device, buffer->memory, offset, size, flags, &data));
-    return data;
+    // Host-visible memory is mapped for as long as it is allocated, since it may be shared.
+    if (!buffer->allocation.mapped) {
+        KERROR("vulkan_buffer_lock_memory - Buffer memory is not host-visible.");
+        return 0;
+    }
+    return buffer->allocation.mapped + offset;
 }
 
 void vulkan_buffer_unlock_memory(vulkan_context* context, vulkan_buffer* buffer) {
-    vkUnmapMemory(context->device.logical_device, buffer->memory);
+    // Nothing to do; the memory stays mapped until it is freed.
 }
 
 void vulkan_buffer_load_data(vulkan_context* context, vulkan_buffer* buffer, u64 offset, u64 size, u32 flags, const void* data) {
-    void* data_ptr;
-    VK_CHECK(vkMapMemory(context->device.logical_device, buffer->memory, offset, size, flags, &data_ptr));
-    kcopy_memory(data_ptr, data, size);
-    vkUnmapMemory(context->device.logical_device, buffer->memory);
+    void* data_ptr = vulkan_buffer_lock_memory(context, buffer, offset, size, flags);
+    if (data_ptr) {
+        kcopy_memory(data_ptr, data, size);
+    }
+    vulkan_buffer_unlock_memory(context, buffer);
 }
 
 void vulkan_buffer_copy_to(
@@ -45,6 +45,54 @@ b8 vulkan_buffer_create(
  */
 void vulkan_buffer_destroy(vulkan_context* context, vulkan_buffer* buffer);
 
+/**
+ * @brief Resizes a buffer, preserving its contents. Waits for the device to go idle, so it must
+ * not be used while a frame is being recorded. Any free list grows along with the buffer.
+ *
+ * @param context A pointer to the active Vulkan context.
+ * @param new_size The new size of the buffer in bytes. Must not be smaller than the current size.
+ * @param buffer A pointer to the vulkan_buffer to resize.
+ * @param queue The queue to copy the contents on.
+ * @param pool The command pool to allocate the copy command buffer from.
+ * @return True on success; otherwise False.
+ */
+b8 vulkan_buffer_resize(
+    vulkan_context* context,
+    u64 new_size,
+    vulkan_buffer* buffer,
+    VkQueue queue,
+    VkCommandPool pool);
+
+/**
+ * @brief Creates a free list over the buffer, so ranges of it can be handed out with
+ * vulkan_buffer_allocate() and returned with vulkan_buffer_free().
+ *
+ * @param buffer A pointer to the vulkan_buffer to sub-allocate.
+ * @param max_ranges The most free ranges to track. At least one more than the most live ranges.
+ * @return True on success; otherwise False.
+ */
+b8 vulkan_buffer_create_freelist(vulkan_buffer* buffer, u32 max_ranges);
+
+/**
+ * @brief Allocates a range of the buffer from its free list.
+ *
+ * @param buffer A pointer to the vulkan_buffer to allocate from. Must have a free list.
+ * @param size The size of the range in bytes.
+ * @param out_offset A pointer to hold the offset of the range.
+ * @return True on success; False if no free range is large enough.
+ */
+b8 vulkan_buffer_allocate(vulkan_buffer* buffer, u64 size, u64* out_offset);
+
+/**
+ * @brief Returns a range of the buffer to its free list. The GPU must be finished with it.
+ *
+ * @param buffer A pointer to the vulkan_buffer the range was allocated from.
+ * @param size The size the range was allocated with.
+ * @param offset The offset of the range.
+ * @return True on success; otherwise False.
+ */
+b8 vulkan_buffer_free(vulkan_buffer* buffer, u64 size, u64 offset);
+
 /**
  * @brief Locks a region of the buffer's memory for CPU access.
  * Returns a pointer to the mapped memory region.
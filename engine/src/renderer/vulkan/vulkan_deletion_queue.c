@@ -0,0 +1,156 @@
+#include "vulkan_deletion_queue.h"
+
+#include "containers/darray.h"
+#include "core/kmemory.h"
+#include "core/logger.h"
+#include "vulkan_buffer.h"
+#include "vulkan_image.h"
+#include "vulkan_staging.h"
+#include "vulkan_utils.h"
+
+/**
+ * @file vulkan_deletion_queue.c
+ * @brief Implementation of the deletion queue.
+ */
+
+b8 vulkan_deletion_queue_create(vulkan_deletion_queue* out_queue) {
+    kzero_memory(out_queue, sizeof(vulkan_deletion_queue));
+    for (u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+        out_queue->pending[i] = darray_create(vulkan_deferred_deletion);
+    }
+    return True;
+}
+
+/** @brief Queues a resource against the latest frame that may use it. */
+static void push(vulkan_context* context, vulkan_deletion_queue* queue, const vulkan_deferred_deletion* deletion) {
+    u32 frame_index = context->current_frame;
+    if (!context->frame_in_progress) {
+        // Released between frames, so the last frame submitted is the latest that may use it.
+        u32 max_frames = context->swapchain.max_frames_in_flight;
+        frame_index = (context->current_frame + max_frames - 1) % max_frames;
+    }
+
+    darray_push(queue->pending[frame_index], *deletion);
+
+    u32 pending_count = 0;
+    for (u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+        pending_count += (u32)darray_length(queue->pending[i]);
+    }
+    if (pending_count > queue->peak_pending_count) {
+        queue->peak_pending_count = pending_count;
+    }
+}
+
+void vulkan_deletion_queue_push_buffer_range(vulkan_context* context, vulkan_deletion_queue* queue, vulkan_buffer* buffer, u64 offset, u64 size) {
+    vulkan_deferred_deletion deletion = {};
+    deletion.type = VULKAN_DEFERRED_DELETION_TYPE_BUFFER_RANGE;
+    deletion.buffer_range.buffer = buffer;
+    deletion.buffer_range.offset = offset;
+    deletion.buffer_range.size = size;
+    deletion.ticket = vulkan_staging_ring_ticket(&context->staging);
+    push(context, queue, &deletion);
+}
+
+void vulkan_deletion_queue_push_image(vulkan_context* context, vulkan_deletion_queue* queue, vulkan_image* image) {
+    vulkan_deferred_deletion deletion = {};
+    deletion.type = VULKAN_DEFERRED_DELETION_TYPE_IMAGE;
+    deletion.image = *image;
+    deletion.ticket = vulkan_staging_ring_ticket(&context->staging);
+    push(context, queue, &deletion);
+    kzero_memory(image, sizeof(vulkan_image));
+}
+
+void vulkan_deletion_queue_push_sampler(vulkan_context* context, vulkan_deletion_queue* queue, VkSampler sampler) {
+    vulkan_deferred_deletion deletion = {};
+    deletion.type = VULKAN_DEFERRED_DELETION_TYPE_SAMPLER;
+    deletion.sampler = sampler;
+    push(context, queue, &deletion);
+}
+
+void vulkan_deletion_queue_push_descriptor_sets(vulkan_context* context, vulkan_deletion_queue* queue, VkDescriptorPool pool, u32 count, const VkDescriptorSet* sets) {
+    // Each entry holds up to MAX_FRAMES_IN_FLIGHT sets, but there is one set per swapchain image, which can be more.
+    for (u32 first = 0; first < count; first += MAX_FRAMES_IN_FLIGHT) {
+        u32 chunk_count = KMIN(count - first, MAX_FRAMES_IN_FLIGHT);
+
+        vulkan_deferred_deletion deletion = {};
+        deletion.type = VULKAN_DEFERRED_DELETION_TYPE_DESCRIPTOR_SETS;
+        deletion.descriptor_sets.pool = pool;
+        deletion.descriptor_sets.count = chunk_count;
+        kcopy_memory(deletion.descriptor_sets.sets, sets + first, sizeof(VkDescriptorSet) * chunk_count);
+        push(context, queue, &deletion);
+    }
+}
+
+/** @brief Destroys a queued resource. */
+static void destroy_deletion(vulkan_context* context, vulkan_deferred_deletion* deletion) {
+    switch (deletion->type) {
+        case VULKAN_DEFERRED_DELETION_TYPE_BUFFER_RANGE:
+            if (!vulkan_buffer_free(deletion->buffer_range.buffer, deletion->buffer_range.size, deletion->buffer_range.offset)) {
+                KWARN("Failed to free the buffer range at offset %llu of size %llu.", deletion->buffer_range.offset, deletion->buffer_range.size);
+            }
+            break;
+        case VULKAN_DEFERRED_DELETION_TYPE_IMAGE:
+            vulkan_image_destroy(context, &deletion->image);
+            break;
+        case VULKAN_DEFERRED_DELETION_TYPE_SAMPLER:
+            vkDestroySampler(context->device.logical_device, deletion->sampler, context->allocator);
+            break;
+        case VULKAN_DEFERRED_DELETION_TYPE_DESCRIPTOR_SETS: {
+            VkResult result = vkFreeDescriptorSets(
+                context->device.logical_device,
+                deletion->descriptor_sets.pool,
+                deletion->descriptor_sets.count,
+                deletion->descriptor_sets.sets);
+            if (result != VK_SUCCESS) {
+                KERROR("Error freeing descriptor sets: '%s'", vulkan_result_string(result, True));
+            }
+        } break;
+    }
+}
+
+/** @brief Destroys the resources queued against a frame whose tickets are no later than max_ticket, keeping the rest. */
+static void flush_pending(vulkan_context* context, vulkan_deletion_queue* queue, u32 frame_index, u64 max_ticket) {
+    vulkan_deferred_deletion* pending = queue->pending[frame_index];
+    u64 count = darray_length(pending);
+    u64 kept = 0;
+    for (u64 i = 0; i < count; ++i) {
+        if (pending[i].ticket > max_ticket) {
+            // The transfer queue may still be writing it.
+            pending[kept++] = pending[i];
+        } else {
+            destroy_deletion(context, &pending[i]);
+        }
+    }
+    darray_length_set(pending, kept);
+}
+
+void vulkan_deletion_queue_flush(vulkan_context* context, vulkan_deletion_queue* queue, u32 frame_index) {
+    // vulkan_staging_ring_ticket_complete() holds for every ticket up to the acquired value.
+    flush_pending(context, queue, frame_index, context->staging.acquired_value);
+}
+
+void vulkan_deletion_queue_flush_all(vulkan_context* context, vulkan_deletion_queue* queue) {
+    // The device is idle, so every submitted upload is complete. The current batch is not submitted yet.
+    for (u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+        if (queue->pending[i]) {
+            flush_pending(context, queue, i, context->staging.submitted_value);
+        }
+    }
+}
+
+void vulkan_deletion_queue_destroy(vulkan_context* context, vulkan_deletion_queue* queue) {
+    // Nothing will be submitted anymore, so unsubmitted uploads are abandoned along with their resources.
+    for (u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+        if (queue->pending[i]) {
+            flush_pending(context, queue, i, UINT64_MAX);
+        }
+    }
+    KDEBUG("Vulkan deletion queue peak pending count: %u.", queue->peak_pending_count);
+
+    for (u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+        if (queue->pending[i]) {
+            darray_destroy(queue->pending[i]);
+        }
+    }
+    kzero_memory(queue, sizeof(vulkan_deletion_queue));
+}
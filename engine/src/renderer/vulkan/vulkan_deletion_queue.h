@@ -0,0 +1,98 @@
+#pragma once
+
+#include "vulkan_types.inl"
+
+/**
+ * @file vulkan_deletion_queue.h
+ * @brief Deferred destruction of resources the GPU may still be using.
+ *
+ * Releasing a resource does not wait for the device to go idle. Instead, it is queued against
+ * the latest frame that may use it: the frame being recorded, or if there is none, the last frame
+ * submitted. Once that frame's in-flight fence signals, the resource is destroyed. With several
+ * frames in flight, this lets the CPU keep recording while the GPU finishes earlier frames.
+ *
+ * Buffer ranges and images may also still be written by uploads on the transfer queue, which
+ * frame fences do not cover. They are stamped with the current staging ticket, and are kept
+ * past their frame until that ticket completes too.
+ *
+ * Usage:
+ * - Queue resources with the vulkan_deletion_queue_push_* functions rather than destroying them.
+ * - Each frame, call vulkan_deletion_queue_flush() for the current frame right after waiting
+ *   on its in-flight fence.
+ * - Once the device is idle, vulkan_deletion_queue_flush_all() destroys everything queued.
+ */
+
+/**
+ * @brief Creates the deletion queue.
+ *
+ * @param out_queue A pointer to hold the created queue.
+ * @return True on success; otherwise False.
+ */
+b8 vulkan_deletion_queue_create(vulkan_deletion_queue* out_queue);
+
+/**
+ * @brief Destroys everything queued, then the queue itself. The device must be idle.
+ *
+ * @param context A pointer to the active Vulkan context.
+ * @param queue A pointer to the queue to destroy.
+ */
+void vulkan_deletion_queue_destroy(vulkan_context* context, vulkan_deletion_queue* queue);
+
+/**
+ * @brief Queues a range of a sub-allocated buffer to be returned to its free list.
+ *
+ * @param context A pointer to the active Vulkan context.
+ * @param queue A pointer to the deletion queue.
+ * @param buffer A pointer to the buffer the range belongs to. Must outlive the queued range.
+ * @param offset The offset of the range.
+ * @param size The size the range was allocated with.
+ */
+void vulkan_deletion_queue_push_buffer_range(vulkan_context* context, vulkan_deletion_queue* queue, vulkan_buffer* buffer, u64 offset, u64 size);
+
+/**
+ * @brief Queues an image, its view and its memory to be destroyed.
+ *
+ * @param context A pointer to the active Vulkan context.
+ * @param queue A pointer to the deletion queue.
+ * @param image A pointer to the image. It is copied into the queue and zeroed.
+ */
+void vulkan_deletion_queue_push_image(vulkan_context* context, vulkan_deletion_queue* queue, vulkan_image* image);
+
+/**
+ * @brief Queues a sampler to be destroyed.
+ *
+ * @param context A pointer to the active Vulkan context.
+ * @param queue A pointer to the deletion queue.
+ * @param sampler The sampler to destroy.
+ */
+void vulkan_deletion_queue_push_sampler(vulkan_context* context, vulkan_deletion_queue* queue, VkSampler sampler);
+
+/**
+ * @brief Queues descriptor sets to be freed back to their pool.
+ *
+ * @param context A pointer to the active Vulkan context.
+ * @param queue A pointer to the deletion queue.
+ * @param pool The pool the sets were allocated from. Must be created with VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT.
+ * @param count The number of sets.
+ * @param sets The sets to free. Copied into the queue.
+ */
+void vulkan_deletion_queue_push_descriptor_sets(vulkan_context* context, vulkan_deletion_queue* queue, VkDescriptorPool pool, u32 count, const VkDescriptorSet* sets);
+
+/**
+ * @brief Destroys the resources queued against a frame whose uploads have completed. Its in-flight
+ * fence must have signaled. The rest stay queued against the frame until its next flush.
+ *
+ * @param context A pointer to the active Vulkan context.
+ * @param queue A pointer to the deletion queue.
+ * @param frame_index The index of the frame in flight.
+ */
+void vulkan_deletion_queue_flush(vulkan_context* context, vulkan_deletion_queue* queue, u32 frame_index);
+
+/**
+ * @brief Destroys everything queued, except resources written by uploads not yet submitted to the
+ * transfer queue. The device must be idle.
+ *
+ * @param context A pointer to the active Vulkan context.
+ * @param queue A pointer to the deletion queue.
+ */
+void vulkan_deletion_queue_flush_all(vulkan_context* context, vulkan_deletion_queue* queue);
@@ -59,6 +59,11 @@ typedef struct vulkan_physical_device_requirements {
      * @brief Must be a discrete GPU (if enabled).
      */
     b8 discrete_gpu;
+
+    /**
+     * @brief Must support timeline semaphores.
+     */
+    b8 timeline_semaphore;
 } vulkan_physical_device_requirements;
 
 /**
@@ -178,6 +183,8 @@ b8 vulkan_device_create(vulkan_context* context) {
         indices[index++] = context->device.transfer_queue_index;
     }
 
+    // NOTE: Outlives the loop, since the create infos point at it.
+    f32 queue_priority = 1.0f;
     VkDeviceQueueCreateInfo queue_create_infos[32];
     for (u32 i = 0; i < index_count; ++i) {
         queue_create_infos[i].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
@@ -188,7 +195,6 @@ b8 vulkan_device_create(vulkan_context* context) {
         // }
         queue_create_infos[i].flags = 0;
         queue_create_infos[i].pNext = 0;
-        f32 queue_priority = 1.0f;
         queue_create_infos[i].pQueuePriorities = &queue_priority;
     }
 
@@ -196,8 +202,19 @@ b8 vulkan_device_create(vulkan_context* context) {
     // TODO: should be config driven
     VkPhysicalDeviceFeatures device_features = {};
     device_features.samplerAnisotropy = VK_TRUE;  // Request anisotropy
+    // Indirect draws of more than one command, where supported.
+    device_features.multiDrawIndirect = context->device.supports_multi_draw_indirect ? VK_TRUE : VK_FALSE;
+    // Cooked textures are uploaded block-compressed, where supported.
+    device_features.textureCompressionBC = context->device.supports_bc_compression ? VK_TRUE : VK_FALSE;
+
+    // Timeline semaphores track upload completion across queues.
+    // Indirect draws may take their draw count from a buffer, where supported.
+    VkPhysicalDeviceVulkan12Features vulkan12_features = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES};
+    vulkan12_features.timelineSemaphore = VK_TRUE;
+    vulkan12_features.drawIndirectCount = context->device.supports_draw_indirect_count ? VK_TRUE : VK_FALSE;
 
     VkDeviceCreateInfo device_create_info = {VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO};
+    device_create_info.pNext = &vulkan12_features;
     device_create_info.queueCreateInfoCount = index_count;
     device_create_info.pQueueCreateInfos = queue_create_infos;
     device_create_info.pEnabledFeatures = &device_features;
@@ -252,6 +269,17 @@ b8 vulkan_device_create(vulkan_context* context) {
 
     KINFO("Graphics command pool created.");
 
+    // Create command pool for the transfer queue.
+    pool_create_info.queueFamilyIndex = context->device.transfer_queue_index;
+    VK_CHECK(vkCreateCommandPool(
+        context->device.logical_device,
+        &pool_create_info,
+        context->allocator,
+        &context->device.transfer_command_pool));
+
+    context->device.has_dedicated_transfer_queue = !transfer_shares_graphics_queue;
+    KINFO("Transfer command pool created. Uploads use a %s queue.", context->device.has_dedicated_transfer_queue ? "dedicated transfer" : "shared graphics");
+
     return True;
 }
 
@@ -263,7 +291,12 @@ void vulkan_device_destroy(vulkan_context* context) {
         context->device.graphics_command_pool = 0;
     }
 
-    // If we add more command pools (e.g., compute, transfer), destroy them here
+    if (context->device.transfer_command_pool) {
+        vkDestroyCommandPool(context->device.logical_device, context->device.transfer_command_pool, context->allocator);
+        context->device.transfer_command_pool = 0;
+    }
+
+    // If we add more command pools (e.g., compute), destroy them here
     // if (context->device.compute_command_pool) {
     //     vkDestroyCommandPool(context->device.logical_device, context->device.compute_command_pool, context->allocator);
     //     context->device.compute_command_pool = 0;
@@ -311,6 +344,7 @@ void vulkan_device_destroy(vulkan_context* context) {
     context->device.graphics_queue_index = -1;
     context->device.present_queue_index = -1;
     context->device.transfer_queue_index = -1;
+    context->device.has_dedicated_transfer_queue = False;
 
     // Optional: Reset other device fields
     kzero_memory(&context->device.properties, sizeof(context->device.properties));
@@ -435,6 +469,7 @@ b8 select_physical_device(vulkan_context* context) {
         requirements.compute = True;
         requirements.sampler_anisotropy = True;
         requirements.discrete_gpu = False;
+        requirements.timeline_semaphore = True;
         requirements.device_extension_names = darray_create(const char*);
         darray_push(requirements.device_extension_names, &VK_KHR_SWAPCHAIN_EXTENSION_NAME);
 
@@ -504,6 +539,21 @@ b8 select_physical_device(vulkan_context* context) {
             context->device.features = features;
             context->device.memory = memory;
             context->device.supports_device_local_host_visible = supports_device_local_host_visible;
+
+            // Optional indirect drawing features.
+            VkPhysicalDeviceVulkan12Features vulkan12_features = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES};
+            VkPhysicalDeviceFeatures2 features2 = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2};
+            features2.pNext = &vulkan12_features;
+            vkGetPhysicalDeviceFeatures2(physical_devices[i], &features2);
+            context->device.supports_multi_draw_indirect = features.multiDrawIndirect == VK_TRUE;
+            context->device.supports_draw_indirect_count = vulkan12_features.drawIndirectCount == VK_TRUE;
+            KINFO("Multi-draw indirect: %s, draw indirect count: %s",
+                  context->device.supports_multi_draw_indirect ? "supported" : "not supported",
+                  context->device.supports_draw_indirect_count ? "supported" : "not supported");
+
+            // Block-compressed textures are decoded on the CPU where they cannot be sampled.
+            context->device.supports_bc_compression = features.textureCompressionBC == VK_TRUE;
+            KINFO("BC texture compression: %s", context->device.supports_bc_compression ? "supported" : "not supported");
             break;
         }
     }
@@ -660,6 +710,18 @@ b8 physical_device_meets_requirements(
             return False;
         }
 
+        // Timeline semaphores
+        if (requirements->timeline_semaphore) {
+            VkPhysicalDeviceTimelineSemaphoreFeatures timeline_features = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES};
+            VkPhysicalDeviceFeatures2 features2 = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2};
+            features2.pNext = &timeline_features;
+            vkGetPhysicalDeviceFeatures2(device, &features2);
+            if (!timeline_features.timelineSemaphore) {
+                KINFO("Device does not support timeline semaphores, skipping.");
+                return False;
+            }
+        }
+
         // Device meets all requirements.
         return True;
     }
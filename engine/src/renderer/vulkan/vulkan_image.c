@@ -2,6 +2,7 @@
 #include "core/logger.h"
 #include "vulkan_device.h"
 #include "vulkan_image.h"
+#include "vulkan_memory.h"
 
 /**
  * @file vulkan_image.c
@@ -30,6 +31,7 @@
  * @param image_type Type of image (1D, 2D, 3D).
  * @param width Width of the image in pixels.
  * @param height Height of the image in pixels.
+ * @param mip_levels The number of mip levels of the image.
  * @param format Pixel format (e.g., VK_FORMAT_B8G8R8A8_UNORM).
  * @param tiling Tiling mode: VK_IMAGE_TILING_LINEAR or VK_IMAGE_TILING_OPTIMAL.
  * @param usage Usage flags indicating how this image will be used.
@@ -43,6 +45,7 @@ void vulkan_image_create(
     VkImageType image_type,
     u32 width,
     u32 height,
+    u32 mip_levels,
     VkFormat format,
     VkImageTiling tiling,
     VkImageUsageFlags usage,
@@ -53,6 +56,7 @@ void vulkan_image_create(
     // Copy params to output structure
     out_image->width = width;
     out_image->height = height;
+    out_image->mip_levels = mip_levels;
 
     // Set up image creation info
     VkImageCreateInfo image_create_info = {VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
@@ -60,7 +64,7 @@ void vulkan_image_create(
     image_create_info.extent.width = width;
     image_create_info.extent.height = height;
     image_create_info.extent.depth = 1;  // TODO: Support configurable depth (e.g., 3D textures or volume data)
-    image_create_info.mipLevels = 4;     // TODO: Add support for mip mapping and make this configurable
+    image_create_info.mipLevels = mip_levels;
     image_create_info.arrayLayers = 1;   // TODO: Support array layers for texture arrays
     image_create_info.format = format;
     image_create_info.tiling = tiling;
@@ -76,20 +80,15 @@ void vulkan_image_create(
     VkMemoryRequirements memory_requirements;
     vkGetImageMemoryRequirements(context->device.logical_device, out_image->handle, &memory_requirements);
 
-    // Find suitable memory type
-    i32 memory_type = context->find_memory_index(memory_requirements.memoryTypeBits, memory_flags);
-    if (memory_type == -1) {
-        KERROR("Required memory type not found. Image not valid.");
+    // Sub-allocate device memory for the image
+    vulkan_memory_resource_type resource_type = tiling == VK_IMAGE_TILING_OPTIMAL ? VULKAN_MEMORY_RESOURCE_TYPE_OPTIMAL : VULKAN_MEMORY_RESOURCE_TYPE_LINEAR;
+    if (!vulkan_memory_allocate(context, &context->memory_allocator, &memory_requirements, memory_flags, resource_type, &out_image->allocation)) {
+        KERROR("Failed to allocate image memory. Image not valid.");
+        return;
     }
 
-    // Allocate device memory for the image
-    VkMemoryAllocateInfo memory_allocate_info = {VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
-    memory_allocate_info.allocationSize = memory_requirements.size;
-    memory_allocate_info.memoryTypeIndex = memory_type;
-    VK_CHECK(vkAllocateMemory(context->device.logical_device, &memory_allocate_info, context->allocator, &out_image->memory));
-
     // Bind allocated memory to the image handle
-    VK_CHECK(vkBindImageMemory(context->device.logical_device, out_image->handle, out_image->memory, 0));  // TODO: Make offset configurable
+    VK_CHECK(vkBindImageMemory(context->device.logical_device, out_image->handle, out_image->allocation.memory, out_image->allocation.offset));
 
     // Optionally create an image view
     if (create_view) {
@@ -122,8 +121,8 @@ void vulkan_image_view_create(
     view_create_info.subresourceRange.aspectMask = aspect_flags;
 
     // Subresource range defaults
-    view_create_info.subresourceRange.baseMipLevel = 0;  // TODO: Configurable mipmap level
-    view_create_info.subresourceRange.levelCount = 1;
+    view_create_info.subresourceRange.baseMipLevel = 0;
+    view_create_info.subresourceRange.levelCount = image->mip_levels;
     view_create_info.subresourceRange.baseArrayLayer = 0;
     view_create_info.subresourceRange.layerCount = 1;
 
@@ -143,14 +142,15 @@ void vulkan_image_transition_layout(
     barrier.oldLayout = old_layout;
     barrier.newLayout = new_layout;
 
-    barrier.srcQueueFamilyIndex = context->device.graphics_queue_index;
-    barrier.dstQueueFamilyIndex = context->device.graphics_queue_index;
+    // Not an ownership transfer, so this can be recorded on any queue.
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 
     barrier.image = image->handle;
 
     barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.levelCount = image->mip_levels;
     barrier.subresourceRange.baseArrayLayer = 0;
     barrier.subresourceRange.layerCount = 1;
 
@@ -197,23 +197,29 @@ void vulkan_image_copy_from_buffer(
     vulkan_context* context,
     vulkan_image* image,
     VkBuffer buffer,
+    u64 buffer_offset,
+    u32 mip_level,
+    u32 first_row,
+    u32 row_count,
     vulkan_command_buffer* command_buffer) {
     // Region to copy
     VkBufferImageCopy region;
 
     kzero_memory(&region, sizeof(VkBufferImageCopy));
 
-    region.bufferOffset = 0;
+    region.bufferOffset = buffer_offset;
     region.bufferRowLength = 0;
     region.bufferImageHeight = 0;
 
     region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.mipLevel = mip_level;
     region.imageSubresource.baseArrayLayer = 0;
     region.imageSubresource.layerCount = 1;
 
-    region.imageExtent.width = image->width;
-    region.imageExtent.height = image->height;
+    region.imageOffset.y = first_row;
+
+    region.imageExtent.width = KMAX(image->width >> mip_level, 1u);
+    region.imageExtent.height = row_count;
     region.imageExtent.depth = 1;
 
     vkCmdCopyBufferToImage(
@@ -230,8 +236,8 @@ void vulkan_image_copy_from_buffer(
  *
  * Cleans up:
  * - The image view (if present)
- * - Allocated memory for the image
  * - The image handle itself
+ * - Allocated memory for the image
  *
  * Must be called before destroying the logical device.
  *
@@ -245,15 +251,12 @@ void vulkan_image_destroy(vulkan_context* context, vulkan_image* image) {
         image->view = 0;
     }
 
-    // Free image memory
-    if (image->memory) {
-        vkFreeMemory(context->device.logical_device, image->memory, context->allocator);
-        image->memory = 0;
-    }
-
-    // Destroy image handle last
+    // Destroy image handle
     if (image->handle) {
         vkDestroyImage(context->device.logical_device, image->handle, context->allocator);
         image->handle = 0;
     }
+
+    // Free image memory last, once nothing is bound to it
+    vulkan_memory_free(context, &context->memory_allocator, &image->allocation);
 }
\ No newline at end of file
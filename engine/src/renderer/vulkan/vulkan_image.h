@@ -29,6 +29,7 @@
  * @param image_type Type of image (1D, 2D, 3D).
  * @param width Width of the image in pixels.
  * @param height Height of the image in pixels.
+ * @param mip_levels The number of mip levels of the image.
  * @param format Pixel format (e.g., VK_FORMAT_B8G8R8A8_UNORM).
  * @param tiling Tiling mode (linear or optimal).
  * @param usage Usage flags indicating how this image will be used.
@@ -42,6 +43,7 @@ void vulkan_image_create(
     VkImageType image_type,
     u32 width,
     u32 height,
+    u32 mip_levels,
     VkFormat format,
     VkImageTiling tiling,
     VkImageUsageFlags usage,
@@ -74,7 +76,7 @@ void vulkan_image_view_create(
  *
  * Cleans up:
  * - Image handle (`vkDestroyImage`)
- * - Allocated memory (`vkFreeMemory`)
+ * - Allocated memory (returned to the memory allocator)
  * - Image view (if present)
  *
  * Must be called before destroying the logical device.
@@ -109,19 +111,29 @@ void vulkan_image_transition_layout(
     VkImageLayout new_layout);
 
 /**
- * @brief Copies data from a buffer to a Vulkan image.
+ * @brief Copies a range of rows from a buffer to a mip level of a Vulkan image.
  *
- * Used for uploading texture data or other image content from CPU-visible buffers.
+ * Used for uploading texture data or other image content from CPU-visible buffers. Large images
+ * can be uploaded in several copies of a few rows each. For block-compressed images, the rows
+ * must start on a block boundary, and cover whole blocks unless they reach the bottom edge.
  *
  * @param context A pointer to the active Vulkan context.
  * @param image A pointer to the destination vulkan_image.
  * @param buffer The source VkBuffer containing the data to copy.
+ * @param buffer_offset The byte offset of the first row's data within the buffer.
+ * @param mip_level The mip level to copy to.
+ * @param first_row The first row of the mip level to copy to.
+ * @param row_count The number of tightly-packed rows to copy.
  * @param command_buffer A command buffer to record the copy operation into.
  */
 void vulkan_image_copy_from_buffer(
     vulkan_context* context,
     vulkan_image* image,
     VkBuffer buffer,
+    u64 buffer_offset,
+    u32 mip_level,
+    u32 first_row,
+    u32 row_count,
     vulkan_command_buffer* command_buffer);
 
 /**
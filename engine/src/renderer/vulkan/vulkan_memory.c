@@ -0,0 +1,270 @@
+#include "vulkan_memory.h"
+
+#include "containers/darray.h"
+#include "core/kmemory.h"
+#include "core/logger.h"
+#include "vulkan_utils.h"
+
+/**
+ * @file vulkan_memory.c
+ * @brief Implementation of the device memory sub-allocator.
+ */
+
+/** @brief The size of a page, unless its heap is too small to hold several. */
+#define VULKAN_MEMORY_PAGE_SIZE (64 * 1024 * 1024)
+
+/** @brief Pages are never made smaller than this, however small the heap. */
+#define VULKAN_MEMORY_MIN_PAGE_SIZE (1 * 1024 * 1024)
+
+/** @brief The smallest range handed out within a page. */
+#define VULKAN_MEMORY_MIN_BLOCK_SIZE 1024
+
+/**
+ * @brief Obtains the page size for a memory type. Small heaps, such as host-visible device-local
+ * memory, are split into at least 8 pages.
+ */
+static u64 page_size_for_type(vulkan_context* context, u32 memory_type_index) {
+    u32 heap_index = context->device.memory.memoryTypes[memory_type_index].heapIndex;
+    u64 heap_size = context->device.memory.memoryHeaps[heap_index].size;
+
+    u64 size = VULKAN_MEMORY_PAGE_SIZE;
+    while (size > VULKAN_MEMORY_MIN_PAGE_SIZE && size > heap_size / 8) {
+        size /= 2;
+    }
+    return size;
+}
+
+/** @brief Obtains the memory tag allocations of a memory type are reported under. */
+static memory_tag tag_for_type(vulkan_context* context, u32 memory_type_index) {
+    b8 host_visible = (context->device.memory.memoryTypes[memory_type_index].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+    return host_visible ? MEMORY_TAG_GPU_HOST : MEMORY_TAG_GPU_LOCAL;
+}
+
+/** @brief Allocates device memory, mapping it if it is host-visible. */
+static b8 allocate_device_memory(
+    vulkan_context* context,
+    vulkan_memory_allocator* allocator,
+    u64 size,
+    u32 memory_type_index,
+    VkDeviceMemory* out_memory,
+    u8** out_mapped) {
+    if (allocator->device_allocation_count >= context->device.properties.limits.maxMemoryAllocationCount) {
+        KERROR("Unable to allocate device memory: the device limit of %u allocations has been reached.", context->device.properties.limits.maxMemoryAllocationCount);
+        return False;
+    }
+
+    VkMemoryAllocateInfo allocate_info = {VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+    allocate_info.allocationSize = size;
+    allocate_info.memoryTypeIndex = memory_type_index;
+    VkResult result = vkAllocateMemory(context->device.logical_device, &allocate_info, context->allocator, out_memory);
+    if (!vulkan_result_is_success(result)) {
+        KERROR("Unable to allocate %llu bytes of device memory: '%s'", size, vulkan_result_string(result, True));
+        return False;
+    }
+
+    *out_mapped = 0;
+    if (context->device.memory.memoryTypes[memory_type_index].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        void* mapped = 0;
+        VK_CHECK(vkMapMemory(context->device.logical_device, *out_memory, 0, VK_WHOLE_SIZE, 0, &mapped));
+        *out_mapped = mapped;
+    }
+
+    allocator->device_allocation_count++;
+    if (allocator->device_allocation_count > allocator->peak_device_allocation_count) {
+        allocator->peak_device_allocation_count = allocator->device_allocation_count;
+    }
+    allocator->heap_reserved[context->device.memory.memoryTypes[memory_type_index].heapIndex] += size;
+
+    return True;
+}
+
+/** @brief Frees device memory allocated with allocate_device_memory(). */
+static void free_device_memory(
+    vulkan_context* context,
+    vulkan_memory_allocator* allocator,
+    VkDeviceMemory memory,
+    u64 size,
+    u32 memory_type_index,
+    b8 is_mapped) {
+    if (is_mapped) {
+        vkUnmapMemory(context->device.logical_device, memory);
+    }
+    vkFreeMemory(context->device.logical_device, memory, context->allocator);
+
+    allocator->device_allocation_count--;
+    allocator->heap_reserved[context->device.memory.memoryTypes[memory_type_index].heapIndex] -= size;
+}
+
+/** @brief Creates a page, reusing an empty slot if there is one. */
+static vulkan_memory_page* create_page(
+    vulkan_context* context,
+    vulkan_memory_allocator* allocator,
+    u32 memory_type_index,
+    vulkan_memory_resource_type resource_type,
+    u32* out_page_index) {
+    vulkan_memory_page page = {};
+    page.size = page_size_for_type(context, memory_type_index);
+    page.memory_type_index = memory_type_index;
+    page.resource_type = resource_type;
+    if (!allocate_device_memory(context, allocator, page.size, memory_type_index, &page.memory, &page.mapped)) {
+        return 0;
+    }
+
+    buddy_allocator_create(page.size, VULKAN_MEMORY_MIN_BLOCK_SIZE, &page.allocator_memory_requirement, 0, 0);
+    page.allocator_memory = kallocate(page.allocator_memory_requirement, MEMORY_TAG_RENDERER);
+    buddy_allocator_create(page.size, VULKAN_MEMORY_MIN_BLOCK_SIZE, &page.allocator_memory_requirement, page.allocator_memory, &page.allocator);
+
+    KDEBUG("Allocated a %llu byte device memory page (memory type %u, %s resources).",
+           page.size, memory_type_index, resource_type == VULKAN_MEMORY_RESOURCE_TYPE_OPTIMAL ? "optimal" : "linear");
+
+    u32 page_count = (u32)darray_length(allocator->pages);
+    for (u32 i = 0; i < page_count; ++i) {
+        if (!allocator->pages[i].memory) {
+            allocator->pages[i] = page;
+            *out_page_index = i;
+            return &allocator->pages[i];
+        }
+    }
+
+    darray_push(allocator->pages, page);
+    *out_page_index = page_count;
+    return &allocator->pages[page_count];
+}
+
+/** @brief Frees a page's device memory and bookkeeping, leaving its slot empty. */
+static void destroy_page(vulkan_context* context, vulkan_memory_allocator* allocator, u32 page_index) {
+    vulkan_memory_page* page = &allocator->pages[page_index];
+
+    buddy_allocator_destroy(&page->allocator);
+    kfree(page->allocator_memory, page->allocator_memory_requirement, MEMORY_TAG_RENDERER);
+    free_device_memory(context, allocator, page->memory, page->size, page->memory_type_index, page->mapped != 0);
+
+    kzero_memory(page, sizeof(vulkan_memory_page));
+}
+
+b8 vulkan_memory_allocator_create(vulkan_context* context, vulkan_memory_allocator* out_allocator) {
+    kzero_memory(out_allocator, sizeof(vulkan_memory_allocator));
+    out_allocator->pages = darray_create(vulkan_memory_page);
+
+    KDEBUG("Vulkan memory allocator created. The device allows %u memory allocations.", context->device.properties.limits.maxMemoryAllocationCount);
+    return True;
+}
+
+void vulkan_memory_allocator_destroy(vulkan_context* context, vulkan_memory_allocator* allocator) {
+    if (allocator->allocation_count) {
+        KWARN("Vulkan memory allocator destroyed with %u allocations still live.", allocator->allocation_count);
+    }
+    KDEBUG("Vulkan memory allocator peak device memory allocation count: %u.", allocator->peak_device_allocation_count);
+
+    if (allocator->pages) {
+        u32 page_count = (u32)darray_length(allocator->pages);
+        for (u32 i = 0; i < page_count; ++i) {
+            if (allocator->pages[i].memory) {
+                destroy_page(context, allocator, i);
+            }
+        }
+        darray_destroy(allocator->pages);
+    }
+
+    kzero_memory(allocator, sizeof(vulkan_memory_allocator));
+}
+
+b8 vulkan_memory_allocate(
+    vulkan_context* context,
+    vulkan_memory_allocator* allocator,
+    const VkMemoryRequirements* requirements,
+    u32 memory_property_flags,
+    vulkan_memory_resource_type resource_type,
+    vulkan_memory_allocation* out_allocation) {
+    kzero_memory(out_allocation, sizeof(vulkan_memory_allocation));
+
+    i32 memory_type_index = context->find_memory_index(requirements->memoryTypeBits, memory_property_flags);
+    if (memory_type_index == -1) {
+        KERROR("vulkan_memory_allocate - No suitable memory type was found.");
+        return False;
+    }
+    out_allocation->memory_type_index = (u32)memory_type_index;
+    out_allocation->size = requirements->size;
+
+    if (requirements->size > page_size_for_type(context, memory_type_index) / 2) {
+        // Too large to share a page; give it memory of its own.
+        if (!allocate_device_memory(context, allocator, requirements->size, memory_type_index, &out_allocation->memory, &out_allocation->mapped)) {
+            return False;
+        }
+        out_allocation->offset = 0;
+        out_allocation->page_index = INVALID_ID;
+    } else {
+        u64 offset = 0;
+        u32 page_index = INVALID_ID;
+        u32 page_count = (u32)darray_length(allocator->pages);
+        for (u32 i = 0; i < page_count; ++i) {
+            vulkan_memory_page* page = &allocator->pages[i];
+            if (page->memory && page->memory_type_index == (u32)memory_type_index && page->resource_type == resource_type &&
+                buddy_allocator_allocate(&page->allocator, requirements->size, requirements->alignment, &offset)) {
+                page_index = i;
+                break;
+            }
+        }
+
+        if (page_index == INVALID_ID) {
+            // Every page is full, so start another.
+            vulkan_memory_page* page = create_page(context, allocator, memory_type_index, resource_type, &page_index);
+            if (!page) {
+                return False;
+            }
+            if (!buddy_allocator_allocate(&page->allocator, requirements->size, requirements->alignment, &offset)) {
+                KERROR("vulkan_memory_allocate - Unable to allocate %llu bytes from an empty page.", requirements->size);
+                destroy_page(context, allocator, page_index);
+                return False;
+            }
+        }
+
+        vulkan_memory_page* page = &allocator->pages[page_index];
+        page->allocation_count++;
+        out_allocation->memory = page->memory;
+        out_allocation->offset = offset;
+        out_allocation->page_index = page_index;
+        out_allocation->mapped = page->mapped ? page->mapped + offset : 0;
+    }
+
+    allocator->allocation_count++;
+    allocator->heap_used[context->device.memory.memoryTypes[memory_type_index].heapIndex] += requirements->size;
+    kmemory_report_allocation(requirements->size, tag_for_type(context, memory_type_index));
+
+    return True;
+}
+
+void vulkan_memory_free(vulkan_context* context, vulkan_memory_allocator* allocator, vulkan_memory_allocation* allocation) {
+    if (!allocation->memory) {
+        return;
+    }
+
+    if (allocation->page_index == INVALID_ID) {
+        free_device_memory(context, allocator, allocation->memory, allocation->size, allocation->memory_type_index, allocation->mapped != 0);
+    } else {
+        vulkan_memory_page* page = &allocator->pages[allocation->page_index];
+        if (!buddy_allocator_free(&page->allocator, allocation->offset)) {
+            KWARN("vulkan_memory_free - Offset %llu is not allocated in page %u.", allocation->offset, allocation->page_index);
+        }
+        page->allocation_count--;
+
+        // Give empty pages back, keeping one per memory and resource type to avoid churn.
+        if (page->allocation_count == 0) {
+            u32 page_count = (u32)darray_length(allocator->pages);
+            for (u32 i = 0; i < page_count; ++i) {
+                vulkan_memory_page* other = &allocator->pages[i];
+                if (i != allocation->page_index && other->memory &&
+                    other->memory_type_index == page->memory_type_index && other->resource_type == page->resource_type) {
+                    destroy_page(context, allocator, allocation->page_index);
+                    break;
+                }
+            }
+        }
+    }
+
+    allocator->allocation_count--;
+    allocator->heap_used[context->device.memory.memoryTypes[allocation->memory_type_index].heapIndex] -= allocation->size;
+    kmemory_report_free(allocation->size, tag_for_type(context, allocation->memory_type_index));
+
+    kzero_memory(allocation, sizeof(vulkan_memory_allocation));
+}
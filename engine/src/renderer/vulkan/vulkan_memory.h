@@ -0,0 +1,66 @@
+#pragma once
+
+#include "vulkan_types.inl"
+
+/**
+ * @file vulkan_memory.h
+ * @brief Device memory sub-allocation for buffers and images.
+ *
+ * Rather than one vkAllocateMemory per resource, memory is allocated in large pages per memory
+ * type, and each resource is bound at an offset within a page. Ranges within a page are handed
+ * out by a buddy allocator, whose blocks are aligned to their own size, so any alignment up to
+ * the size of a resource is met without padding. Buffers and optimal-tiling images never share
+ * a page, which keeps them bufferImageGranularity apart.
+ *
+ * Requests larger than half a page get memory of their own. Host-visible memory is mapped once
+ * when it is allocated, and stays mapped until it is freed.
+ *
+ * Bytes handed out are reported under MEMORY_TAG_GPU_LOCAL and MEMORY_TAG_GPU_HOST.
+ */
+
+/**
+ * @brief Creates the memory allocator. No device memory is allocated until it is needed.
+ *
+ * @param context A pointer to the active Vulkan context. The device must already be created.
+ * @param out_allocator A pointer to hold the created allocator.
+ * @return True on success; otherwise False.
+ */
+b8 vulkan_memory_allocator_create(vulkan_context* context, vulkan_memory_allocator* out_allocator);
+
+/**
+ * @brief Destroys the memory allocator, freeing all of its pages. Anything still bound to them
+ * must already be destroyed.
+ *
+ * @param context A pointer to the active Vulkan context.
+ * @param allocator A pointer to the allocator to destroy.
+ */
+void vulkan_memory_allocator_destroy(vulkan_context* context, vulkan_memory_allocator* allocator);
+
+/**
+ * @brief Allocates memory for a buffer or image.
+ *
+ * @param context A pointer to the active Vulkan context.
+ * @param allocator A pointer to the allocator.
+ * @param requirements The memory requirements of the resource.
+ * @param memory_property_flags The memory properties the memory must have.
+ * @param resource_type The kind of resource the memory is for.
+ * @param out_allocation A pointer to hold the allocation.
+ * @return True on success; otherwise False.
+ */
+b8 vulkan_memory_allocate(
+    vulkan_context* context,
+    vulkan_memory_allocator* allocator,
+    const VkMemoryRequirements* requirements,
+    u32 memory_property_flags,
+    vulkan_memory_resource_type resource_type,
+    vulkan_memory_allocation* out_allocation);
+
+/**
+ * @brief Frees an allocation. Anything bound to it must already be destroyed, or no longer
+ * in use by the GPU. Does nothing if the allocation is empty.
+ *
+ * @param context A pointer to the active Vulkan context.
+ * @param allocator A pointer to the allocator the memory was allocated from.
+ * @param allocation A pointer to the allocation to free. Zeroed once freed.
+ */
+void vulkan_memory_free(vulkan_context* context, vulkan_memory_allocator* allocator, vulkan_memory_allocation* allocation);
@@ -19,6 +19,8 @@
 b8 vulkan_graphics_pipeline_create(
     vulkan_context* context,
     vulkan_renderpass* renderpass,
+    u32 binding_count,
+    VkVertexInputBindingDescription* bindings,
     u32 attribute_count,
     VkVertexInputAttributeDescription* attributes,
     u32 descriptor_set_layout_count,
@@ -95,15 +97,9 @@ b8 vulkan_graphics_pipeline_create(
     dynamic_state_create_info.pDynamicStates = dynamic_states;
 
     // Vertex input state
-    VkVertexInputBindingDescription binding_description = {};
-    binding_description.binding = 0;                              // Binding index
-    binding_description.stride = sizeof(vertex_3d);               // Size of each vertex attribute
-    binding_description.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;  // Move to next data entry per vertex
-
-    // Attributes
     VkPipelineVertexInputStateCreateInfo vertex_input_state_create_info = {VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
-    vertex_input_state_create_info.vertexBindingDescriptionCount = 1;
-    vertex_input_state_create_info.pVertexBindingDescriptions = &binding_description;
+    vertex_input_state_create_info.vertexBindingDescriptionCount = binding_count;
+    vertex_input_state_create_info.pVertexBindingDescriptions = bindings;
     vertex_input_state_create_info.vertexAttributeDescriptionCount = attribute_count;
     vertex_input_state_create_info.pVertexAttributeDescriptions = attributes;
 
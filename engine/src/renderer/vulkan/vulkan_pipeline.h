@@ -20,6 +20,8 @@
  *
  * @param context A pointer to the active Vulkan context.
  * @param renderpass A pointer to the vulkan_renderpass defining the render pass to use.
+ * @param binding_count The number of vertex input bindings.
+ * @param bindings An array of VkVertexInputBindingDescription defining the vertex buffers read, and at which rate.
  * @param attribute_count The number of vertex input attributes.
  * @param attributes An array of VkVertexInputAttributeDescription defining vertex attributes.
  * @param descriptor_set_layout_count The number of descriptor set layouts.
@@ -35,6 +37,8 @@
 b8 vulkan_graphics_pipeline_create(
     vulkan_context* context,
     vulkan_renderpass* renderpass,
+    u32 binding_count,
+    VkVertexInputBindingDescription* bindings,
     u32 attribute_count,
     VkVertexInputAttributeDescription* attributes,
     u32 descriptor_set_layout_count,
@@ -0,0 +1,390 @@
+#include "vulkan_staging.h"
+
+#include "containers/darray.h"
+#include "core/kmemory.h"
+#include "core/logger.h"
+#include "vulkan_buffer.h"
+#include "vulkan_command_buffer.h"
+#include "vulkan_image.h"
+#include "vulkan_utils.h"
+
+/**
+ * @file vulkan_staging.c
+ * @brief Implementation of the persistent staging ring and asynchronous uploads.
+ */
+
+/** @brief The pipeline stages the graphics queue waits on uploads at, and acquires their resources for. */
+#define UPLOAD_CONSUMER_STAGES (VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT)
+
+/** @brief Obtains the current value of the ring's timeline semaphore. */
+static u64 completed_value(vulkan_context* context, vulkan_staging_ring* ring) {
+    u64 value = 0;
+    VK_CHECK(vkGetSemaphoreCounterValue(context->device.logical_device, ring->timeline, &value));
+    return value;
+}
+
+/**
+ * @brief Waits for the oldest submitted batch and reclaims its space. Submits the current batch
+ * first, since the space being waited for may belong to it.
+ *
+ * @return False if there was nothing to wait for; otherwise True.
+ */
+static b8 wait_for_oldest_batch(vulkan_context* context, vulkan_staging_ring* ring) {
+    if (!vulkan_staging_ring_flush(context, ring)) {
+        return False;
+    }
+
+    // Batches are submitted in turn, so the oldest is the first submitted one from the current index on.
+    for (u32 i = 0; i < VULKAN_STAGING_BATCH_COUNT; ++i) {
+        vulkan_staging_batch* batch = &ring->batches[(ring->current_batch + i) % VULKAN_STAGING_BATCH_COUNT];
+        if (batch->is_submitted) {
+            VkSemaphoreWaitInfo wait_info = {VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO};
+            wait_info.semaphoreCount = 1;
+            wait_info.pSemaphores = &ring->timeline;
+            wait_info.pValues = &batch->timeline_value;
+            VkResult result = vkWaitSemaphores(context->device.logical_device, &wait_info, UINT64_MAX);
+            if (!vulkan_result_is_success(result)) {
+                KERROR("Staging ring failed to wait for an upload batch: '%s'", vulkan_result_string(result, True));
+                return False;
+            }
+            vulkan_staging_ring_reclaim(context, ring);
+            return True;
+        }
+    }
+
+    return False;
+}
+
+b8 vulkan_staging_ring_create(vulkan_context* context, u64 size, vulkan_staging_ring* out_ring) {
+    kzero_memory(out_ring, sizeof(vulkan_staging_ring));
+    out_ring->size = size;
+
+    if (!vulkan_buffer_create(
+            context,
+            size,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            True,
+            &out_ring->buffer)) {
+        KERROR("Failed to create the staging ring buffer.");
+        return False;
+    }
+
+    // Host-coherent, so writes through the mapping never need flushing.
+    out_ring->mapped = vulkan_buffer_lock_memory(context, &out_ring->buffer, 0, size, 0);
+    out_ring->buffer.is_locked = True;
+
+    VkSemaphoreTypeCreateInfo type_create_info = {VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO};
+    type_create_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    type_create_info.initialValue = 0;
+    VkSemaphoreCreateInfo semaphore_create_info = {VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+    semaphore_create_info.pNext = &type_create_info;
+    VK_CHECK(vkCreateSemaphore(context->device.logical_device, &semaphore_create_info, context->allocator, &out_ring->timeline));
+
+    for (u32 i = 0; i < VULKAN_STAGING_BATCH_COUNT; ++i) {
+        vulkan_command_buffer_allocate(context, context->device.transfer_command_pool, True, &out_ring->batches[i].command_buffer);
+    }
+
+    out_ring->pending_acquires = darray_create(vulkan_upload_acquire);
+
+    KDEBUG("Staging ring created with %llu bytes.", size);
+    return True;
+}
+
+void vulkan_staging_ring_destroy(vulkan_context* context, vulkan_staging_ring* ring) {
+    KDEBUG("Staging ring peak usage: %llu of %llu bytes.", ring->peak_usage, ring->size);
+
+    for (u32 i = 0; i < VULKAN_STAGING_BATCH_COUNT; ++i) {
+        vulkan_staging_batch* batch = &ring->batches[i];
+        if (batch->command_buffer.handle) {
+            vulkan_command_buffer_free(context, context->device.transfer_command_pool, &batch->command_buffer);
+        }
+    }
+
+    if (ring->pending_acquires) {
+        darray_destroy(ring->pending_acquires);
+        ring->pending_acquires = 0;
+    }
+
+    if (ring->timeline) {
+        vkDestroySemaphore(context->device.logical_device, ring->timeline, context->allocator);
+        ring->timeline = 0;
+    }
+
+    if (ring->mapped) {
+        vulkan_buffer_unlock_memory(context, &ring->buffer);
+        ring->mapped = 0;
+    }
+    vulkan_buffer_destroy(context, &ring->buffer);
+
+    kzero_memory(ring, sizeof(vulkan_staging_ring));
+}
+
+void* vulkan_staging_ring_allocate(vulkan_context* context, vulkan_staging_ring* ring, u64 size, u64 alignment, u64* out_offset) {
+    if (size > ring->size) {
+        KERROR("vulkan_staging_ring_allocate - Upload of %llu bytes is larger than the %llu byte staging ring.", size, ring->size);
+        return 0;
+    }
+
+    while (True) {
+        vulkan_staging_ring_reclaim(context, ring);
+
+        u64 position = ring->head % ring->size;
+        u64 aligned = (position + (alignment - 1)) & ~(alignment - 1);
+        u64 start = ring->head + (aligned - position);
+        if (aligned + size > ring->size) {
+            // Does not fit before the end of the ring, so skip the remainder and start again at 0.
+            start = ring->head + (ring->size - position);
+        }
+
+        if (start + size - ring->tail <= ring->size) {
+            ring->head = start + size;
+            if (ring->head - ring->tail > ring->peak_usage) {
+                ring->peak_usage = ring->head - ring->tail;
+            }
+
+            *out_offset = start % ring->size;
+            return ring->mapped + *out_offset;
+        }
+
+        // Out of space. Wait for the GPU to finish with the oldest batch.
+        if (!wait_for_oldest_batch(context, ring)) {
+            KERROR("vulkan_staging_ring_allocate - Unable to reclaim %llu bytes of staging space.", size);
+            return 0;
+        }
+    }
+}
+
+vulkan_command_buffer* vulkan_staging_ring_command_buffer(vulkan_context* context, vulkan_staging_ring* ring) {
+    vulkan_staging_batch* batch = &ring->batches[ring->current_batch];
+    if (!batch->is_recording) {
+        // The batch is reused in turn; if its last submission is still running, wait for it.
+        while (batch->is_submitted) {
+            if (!wait_for_oldest_batch(context, ring)) {
+                break;
+            }
+        }
+
+        vulkan_command_buffer_reset(&batch->command_buffer);
+        vulkan_command_buffer_begin(&batch->command_buffer, True, False, False);
+        batch->is_recording = True;
+    }
+
+    return &batch->command_buffer;
+}
+
+u64 vulkan_staging_ring_ticket(vulkan_staging_ring* ring) {
+    // The current batch signals the value after the last submitted one.
+    return ring->submitted_value + 1;
+}
+
+b8 vulkan_staging_ring_ticket_complete(vulkan_staging_ring* ring, u64 ticket) {
+    return ticket <= ring->acquired_value;
+}
+
+void vulkan_staging_ring_release_buffer(vulkan_context* context, vulkan_staging_ring* ring, VkBuffer buffer, u64 offset, u64 size) {
+    if (!context->device.has_dedicated_transfer_queue) {
+        // Same queue family; the timeline semaphore wait alone makes the data visible.
+        return;
+    }
+
+    VkBufferMemoryBarrier barrier = {VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+    barrier.srcQueueFamilyIndex = context->device.transfer_queue_index;
+    barrier.dstQueueFamilyIndex = context->device.graphics_queue_index;
+    barrier.buffer = buffer;
+    barrier.offset = offset;
+    barrier.size = size;
+    vkCmdPipelineBarrier(
+        vulkan_staging_ring_command_buffer(context, ring)->handle,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+        0,
+        0, 0,
+        1, &barrier,
+        0, 0);
+
+    vulkan_upload_acquire acquire = {};
+    acquire.ticket = vulkan_staging_ring_ticket(ring);
+    acquire.buffer = buffer;
+    acquire.offset = offset;
+    acquire.size = size;
+    darray_push(ring->pending_acquires, acquire);
+}
+
+void vulkan_staging_ring_release_image(vulkan_context* context, vulkan_staging_ring* ring, vulkan_image* image) {
+    vulkan_command_buffer* command_buffer = vulkan_staging_ring_command_buffer(context, ring);
+    if (!context->device.has_dedicated_transfer_queue) {
+        // Same queue family, so the layout can simply be transitioned in place.
+        vulkan_image_transition_layout(
+            context,
+            command_buffer,
+            image,
+            VK_FORMAT_UNDEFINED,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        return;
+    }
+
+    // The layout transition is part of the ownership transfer, and must match the acquire.
+    VkImageMemoryBarrier barrier = {VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcQueueFamilyIndex = context->device.transfer_queue_index;
+    barrier.dstQueueFamilyIndex = context->device.graphics_queue_index;
+    barrier.image = image->handle;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = image->mip_levels;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    vkCmdPipelineBarrier(
+        command_buffer->handle,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+        0,
+        0, 0,
+        0, 0,
+        1, &barrier);
+
+    vulkan_upload_acquire acquire = {};
+    acquire.ticket = vulkan_staging_ring_ticket(ring);
+    acquire.image = image->handle;
+    acquire.mip_levels = image->mip_levels;
+    darray_push(ring->pending_acquires, acquire);
+}
+
+void vulkan_staging_ring_discard_image(vulkan_staging_ring* ring, VkImage image) {
+    u64 count = darray_length(ring->pending_acquires);
+    u64 kept = 0;
+    for (u64 i = 0; i < count; ++i) {
+        if (ring->pending_acquires[i].image != image) {
+            ring->pending_acquires[kept++] = ring->pending_acquires[i];
+        }
+    }
+    darray_length_set(ring->pending_acquires, kept);
+}
+
+void vulkan_staging_ring_acquire(vulkan_context* context, vulkan_staging_ring* ring, vulkan_command_buffer* command_buffer) {
+    u64 completed = completed_value(context, ring);
+    if (completed <= ring->acquired_value) {
+        return;
+    }
+
+    // Acquire everything released by the batches that have completed. Acquires are queued in
+    // ticket order, so stop at the first one still in flight.
+    u64 count = darray_length(ring->pending_acquires);
+    u64 acquired = 0;
+    for (; acquired < count; ++acquired) {
+        vulkan_upload_acquire* acquire = &ring->pending_acquires[acquired];
+        if (acquire->ticket > completed) {
+            break;
+        }
+
+        if (acquire->image) {
+            VkImageMemoryBarrier barrier = {VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            barrier.srcQueueFamilyIndex = context->device.transfer_queue_index;
+            barrier.dstQueueFamilyIndex = context->device.graphics_queue_index;
+            barrier.image = acquire->image;
+            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            barrier.subresourceRange.baseMipLevel = 0;
+            barrier.subresourceRange.levelCount = acquire->mip_levels;
+            barrier.subresourceRange.baseArrayLayer = 0;
+            barrier.subresourceRange.layerCount = 1;
+            vkCmdPipelineBarrier(
+                command_buffer->handle,
+                UPLOAD_CONSUMER_STAGES, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                0,
+                0, 0,
+                0, 0,
+                1, &barrier);
+        } else {
+            VkBufferMemoryBarrier barrier = {VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+            barrier.srcAccessMask = 0;
+            // Geometry may also be copied elsewhere in its buffer when the buffer is compacted.
+            barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+            barrier.srcQueueFamilyIndex = context->device.transfer_queue_index;
+            barrier.dstQueueFamilyIndex = context->device.graphics_queue_index;
+            barrier.buffer = acquire->buffer;
+            barrier.offset = acquire->offset;
+            barrier.size = acquire->size;
+            vkCmdPipelineBarrier(
+                command_buffer->handle,
+                UPLOAD_CONSUMER_STAGES, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                0,
+                0, 0,
+                1, &barrier,
+                0, 0);
+        }
+    }
+
+    // Drop the acquired entries from the front of the queue.
+    u64 remaining = count - acquired;
+    if (acquired > 0 && remaining > 0) {
+        kcopy_memory(ring->pending_acquires, ring->pending_acquires + acquired, sizeof(vulkan_upload_acquire) * remaining);
+    }
+    darray_length_set(ring->pending_acquires, remaining);
+
+    ring->acquired_value = completed;
+}
+
+b8 vulkan_staging_ring_flush(vulkan_context* context, vulkan_staging_ring* ring) {
+    vulkan_staging_batch* batch = &ring->batches[ring->current_batch];
+    if (!batch->is_recording) {
+        return True;
+    }
+
+    vulkan_command_buffer_end(&batch->command_buffer);
+
+    u64 signal_value = ring->submitted_value + 1;
+    VkTimelineSemaphoreSubmitInfo timeline_info = {VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO};
+    timeline_info.signalSemaphoreValueCount = 1;
+    timeline_info.pSignalSemaphoreValues = &signal_value;
+
+    VkSubmitInfo submit_info = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
+    submit_info.pNext = &timeline_info;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &batch->command_buffer.handle;
+    submit_info.signalSemaphoreCount = 1;
+    submit_info.pSignalSemaphores = &ring->timeline;
+    VkResult result = vkQueueSubmit(context->device.transfer_queue, 1, &submit_info, 0);
+    if (!vulkan_result_is_success(result)) {
+        KERROR("vulkan_staging_ring_flush - vkQueueSubmit failed: '%s'", vulkan_result_string(result, True));
+        return False;
+    }
+    vulkan_command_buffer_update_submitted(&batch->command_buffer);
+
+    ring->submitted_value = signal_value;
+    batch->timeline_value = signal_value;
+    batch->is_recording = False;
+    batch->is_submitted = True;
+    batch->ring_end = ring->head;
+
+    ring->current_batch = (ring->current_batch + 1) % VULKAN_STAGING_BATCH_COUNT;
+
+    return True;
+}
+
+void vulkan_staging_ring_reclaim(vulkan_context* context, vulkan_staging_ring* ring) {
+    u64 completed = completed_value(context, ring);
+
+    // Walk from oldest to newest, stopping at the first batch still running, since the
+    // space is freed in the order it was handed out.
+    for (u32 i = 0; i < VULKAN_STAGING_BATCH_COUNT; ++i) {
+        vulkan_staging_batch* batch = &ring->batches[(ring->current_batch + i) % VULKAN_STAGING_BATCH_COUNT];
+        if (!batch->is_submitted) {
+            continue;
+        }
+        if (batch->timeline_value > completed) {
+            break;
+        }
+
+        ring->tail = batch->ring_end;
+        batch->is_submitted = False;
+    }
+}
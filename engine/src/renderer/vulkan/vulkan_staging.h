@@ -0,0 +1,146 @@
+#pragma once
+
+#include "vulkan_types.inl"
+
+/**
+ * @file vulkan_staging.h
+ * @brief Persistent staging ring and asynchronous uploads to device-local buffers and images.
+ *
+ * Uploads are sub-allocated from one persistently-mapped, host-visible buffer instead of
+ * creating a staging buffer per upload. The copy commands are recorded into a shared batch
+ * command buffer, which is submitted to the transfer queue once per frame. Each batch signals
+ * the next value of a timeline semaphore when it completes; that value is the "ticket" of
+ * every upload in the batch. The staging space a batch read from is reclaimed once its value
+ * is reached. Nothing waits for a queue to go idle unless the ring is full.
+ *
+ * If the transfer queue is a dedicated family, resources written by an upload are released
+ * by the transfer queue and acquired by the graphics queue at the start of the first frame
+ * after the upload completes. Until then the resource must not be used; check its ticket with
+ * vulkan_staging_ring_ticket_complete(). Frames never wait for uploads still in progress.
+ *
+ * Usage:
+ * - Allocate staging space and write the data into the returned pointer.
+ * - Record the commands that read it into vulkan_staging_ring_command_buffer() BEFORE making
+ *   another allocation, since an allocation may submit the current batch to make room.
+ * - Release the written resources and keep vulkan_staging_ring_ticket() as the upload's ticket.
+ * - Each frame, call vulkan_staging_ring_acquire() outside the render pass, and have the
+ *   frame's submission wait on the timeline semaphore for ring->acquired_value.
+ */
+
+/**
+ * @brief Creates the staging ring, maps it, and creates its batch command buffers and timeline semaphore.
+ *
+ * @param context A pointer to the active Vulkan context.
+ * @param size The size of the ring in bytes.
+ * @param out_ring A pointer to hold the created ring.
+ * @return True on success; otherwise False.
+ */
+b8 vulkan_staging_ring_create(vulkan_context* context, u64 size, vulkan_staging_ring* out_ring);
+
+/**
+ * @brief Destroys the staging ring. Any batch still being recorded is discarded, so the device
+ * must be idle.
+ *
+ * @param context A pointer to the active Vulkan context.
+ * @param ring A pointer to the ring to destroy.
+ */
+void vulkan_staging_ring_destroy(vulkan_context* context, vulkan_staging_ring* ring);
+
+/**
+ * @brief Allocates staging space. If the ring is full, the current batch is submitted and the
+ * oldest batch waited on until enough space is reclaimed.
+ *
+ * @param context A pointer to the active Vulkan context.
+ * @param ring A pointer to the ring.
+ * @param size The size in bytes to allocate. Must not exceed the ring size.
+ * @param alignment The alignment of the allocation within the staging buffer. Must be a power of 2.
+ * @param out_offset A pointer to hold the offset of the allocation within ring->buffer.
+ * @return A pointer to the mapped memory to write to, or 0 on failure.
+ */
+void* vulkan_staging_ring_allocate(vulkan_context* context, vulkan_staging_ring* ring, u64 size, u64 alignment, u64* out_offset);
+
+/**
+ * @brief Obtains the command buffer of the current batch, beginning it if required.
+ * Commands recorded into it run on the transfer queue.
+ *
+ * @param context A pointer to the active Vulkan context.
+ * @param ring A pointer to the ring.
+ * @return A pointer to the command buffer to record upload commands into.
+ */
+vulkan_command_buffer* vulkan_staging_ring_command_buffer(vulkan_context* context, vulkan_staging_ring* ring);
+
+/**
+ * @brief Obtains the ticket of the uploads recorded into the current batch.
+ *
+ * @param ring A pointer to the ring.
+ * @return The ticket, to pass to vulkan_staging_ring_ticket_complete().
+ */
+u64 vulkan_staging_ring_ticket(vulkan_staging_ring* ring);
+
+/**
+ * @brief Indicates whether the upload with the given ticket has completed, and the graphics
+ * queue owns what it wrote. A ticket of 0 is always complete.
+ *
+ * @param ring A pointer to the ring.
+ * @param ticket The ticket of the upload.
+ * @return True if the uploaded resources can be used; otherwise False.
+ */
+b8 vulkan_staging_ring_ticket_complete(vulkan_staging_ring* ring, u64 ticket);
+
+/**
+ * @brief Hands a buffer range written by the current batch over to the graphics queue.
+ *
+ * @param context A pointer to the active Vulkan context.
+ * @param ring A pointer to the ring.
+ * @param buffer The buffer that was written.
+ * @param offset The offset of the written range.
+ * @param size The size of the written range.
+ */
+void vulkan_staging_ring_release_buffer(vulkan_context* context, vulkan_staging_ring* ring, VkBuffer buffer, u64 offset, u64 size);
+
+/**
+ * @brief Hands an image written by the current batch over to the graphics queue, transitioning
+ * it from the transfer destination layout to the shader read-only layout.
+ *
+ * @param context A pointer to the active Vulkan context.
+ * @param ring A pointer to the ring.
+ * @param image The image that was written.
+ */
+void vulkan_staging_ring_release_image(vulkan_context* context, vulkan_staging_ring* ring, vulkan_image* image);
+
+/**
+ * @brief Forgets any pending acquire of the given image, so it can be destroyed.
+ *
+ * @param ring A pointer to the ring.
+ * @param image The image about to be destroyed.
+ */
+void vulkan_staging_ring_discard_image(vulkan_staging_ring* ring, VkImage image);
+
+/**
+ * @brief Records the graphics queue's acquire of everything uploaded by batches that have
+ * completed, and marks their tickets complete. Must be recorded outside of a render pass, into
+ * a command buffer whose submission waits on the timeline semaphore for ring->acquired_value.
+ *
+ * @param context A pointer to the active Vulkan context.
+ * @param ring A pointer to the ring.
+ * @param command_buffer The graphics command buffer to record into.
+ */
+void vulkan_staging_ring_acquire(vulkan_context* context, vulkan_staging_ring* ring, vulkan_command_buffer* command_buffer);
+
+/**
+ * @brief Submits the current batch to the transfer queue, if anything was recorded into it.
+ *
+ * @param context A pointer to the active Vulkan context.
+ * @param ring A pointer to the ring.
+ * @return True on success; otherwise False.
+ */
+b8 vulkan_staging_ring_flush(vulkan_context* context, vulkan_staging_ring* ring);
+
+/**
+ * @brief Reclaims the staging space of every batch the GPU has finished with, in order.
+ * Does not block.
+ *
+ * @param context A pointer to the active Vulkan context.
+ * @param ring A pointer to the ring.
+ */
+void vulkan_staging_ring_reclaim(vulkan_context* context, vulkan_staging_ring* ring);
@@ -3,6 +3,10 @@
 #include "core/asserts.h"
 #include "defines.h"
 #include "renderer/renderer_types.inl"
+#include "containers/handle_pool.h"
+#include "memory/buddy_allocator.h"
+#include "memory/freelist.h"
+#include "memory/pool_allocator.h"
 
 #include <vulkan/vulkan.h>
 
@@ -32,6 +36,12 @@
 /** Max geometries that can be handled by the system. */
 #define VULKAN_MAX_GEOMETRY_COUNT 4096
 
+/** Max instances that can be drawn in one frame. Each takes a model matrix in the instance buffer. */
+#define VULKAN_MAX_INSTANCES_PER_FRAME 16384
+
+/** Max indirect draw commands in one frame. Each batch is a unique geometry, so one per geometry is enough. */
+#define VULKAN_MAX_INDIRECT_DRAWS_PER_FRAME VULKAN_MAX_GEOMETRY_COUNT
+
 /**
  * @struct vulkan_descriptor_state
  * @brief Tracks the state of a descriptor across multiple frames in flight.
@@ -87,6 +97,9 @@ typedef struct vulkan_geometry_data {
 
     /** Offset in the index buffer where this geometry's data starts */
     u32 index_buffer_offset;
+
+    /** Ticket of the upload of the geometry's data. Not drawn until it completes. */
+    u64 upload_ticket;
 } vulkan_geometry_data;
 
 /**
@@ -112,6 +125,160 @@ typedef struct vulkan_geometry_data {
  */
 #define MATERIAL_SHADER_STAGE_COUNT 2
 
+/**
+ * @struct vulkan_buffer_range
+ * @brief A range of a sub-allocated vulkan_buffer.
+ */
+typedef struct vulkan_buffer_range {
+    /** @brief The buffer the range belongs to. */
+    struct vulkan_buffer* buffer;
+    /** @brief Offset of the range in bytes. */
+    u64 offset;
+    /** @brief Size of the range in bytes. */
+    u64 size;
+} vulkan_buffer_range;
+
+/**
+ * @struct vulkan_memory_allocation
+ * @brief A range of device memory a buffer or image is bound to.
+ *
+ * Most allocations are sub-allocated from a page shared with other resources, so the range must
+ * never be freed or mapped on its own; use vulkan_memory_free() and the mapped pointer instead.
+ */
+typedef struct vulkan_memory_allocation {
+    /**
+     * @brief The device memory the range lies within.
+     */
+    VkDeviceMemory memory;
+
+    /**
+     * @brief Offset of the range within memory.
+     */
+    u64 offset;
+
+    /**
+     * @brief Size of the range in bytes, as required by the resource.
+     */
+    u64 size;
+
+    /**
+     * @brief Index of the page the range was allocated from, or INVALID_ID if it has memory of its own.
+     */
+    u32 page_index;
+
+    /**
+     * @brief Index of the memory type the range was allocated from.
+     */
+    u32 memory_type_index;
+
+    /**
+     * @brief Host pointer to the start of the range if the memory is host-visible; otherwise 0.
+     * Host-visible memory stays mapped for as long as it is allocated.
+     */
+    u8* mapped;
+} vulkan_memory_allocation;
+
+/**
+ * @enum vulkan_memory_resource_type
+ * @brief The kind of resource memory is allocated for.
+ *
+ * Linear and optimal resources must be bufferImageGranularity apart when they share memory.
+ * They are simply never placed in the same page.
+ */
+typedef enum vulkan_memory_resource_type {
+    /** @brief Buffers and linear-tiling images. */
+    VULKAN_MEMORY_RESOURCE_TYPE_LINEAR,
+    /** @brief Optimal-tiling images. */
+    VULKAN_MEMORY_RESOURCE_TYPE_OPTIMAL
+} vulkan_memory_resource_type;
+
+/**
+ * @struct vulkan_memory_page
+ * @brief One large block of device memory that allocations of one memory and resource type share.
+ */
+typedef struct vulkan_memory_page {
+    /**
+     * @brief The device memory of the page. 0 if the page slot is unused.
+     */
+    VkDeviceMemory memory;
+
+    /**
+     * @brief Size of the page in bytes. Always a power of 2.
+     */
+    u64 size;
+
+    /**
+     * @brief Index of the memory type the page was allocated from.
+     */
+    u32 memory_type_index;
+
+    /**
+     * @brief The kind of resource the page holds.
+     */
+    vulkan_memory_resource_type resource_type;
+
+    /**
+     * @brief Number of live allocations in the page.
+     */
+    u32 allocation_count;
+
+    /**
+     * @brief Sub-allocates ranges of the page.
+     */
+    buddy_allocator allocator;
+
+    /**
+     * @brief Size of the block holding the allocator's bookkeeping.
+     */
+    u64 allocator_memory_requirement;
+
+    /**
+     * @brief The block holding the allocator's bookkeeping.
+     */
+    void* allocator_memory;
+
+    /**
+     * @brief Host pointer to the page if its memory is host-visible; otherwise 0.
+     */
+    u8* mapped;
+} vulkan_memory_page;
+
+/**
+ * @struct vulkan_memory_allocator
+ * @brief Sub-allocates buffer and image memory from a small number of large device memory pages.
+ */
+typedef struct vulkan_memory_allocator {
+    /**
+     * @brief darray of pages. Freed pages leave an empty slot, so page indices stay valid.
+     */
+    vulkan_memory_page* pages;
+
+    /**
+     * @brief Number of live device memory allocations, across pages and dedicated allocations.
+     */
+    u32 device_allocation_count;
+
+    /**
+     * @brief Highest device_allocation_count seen.
+     */
+    u32 peak_device_allocation_count;
+
+    /**
+     * @brief Number of live buffer and image allocations.
+     */
+    u32 allocation_count;
+
+    /**
+     * @brief Per memory heap, bytes of device memory allocated, including unused space in pages.
+     */
+    u64 heap_reserved[VK_MAX_MEMORY_HEAPS];
+
+    /**
+     * @brief Per memory heap, bytes handed out to buffers and images.
+     */
+    u64 heap_used[VK_MAX_MEMORY_HEAPS];
+} vulkan_memory_allocator;
+
 /**
  * @struct vulkan_buffer
  * @brief Represents a Vulkan buffer with its size, handle, and memory binding.
@@ -143,9 +310,9 @@ typedef struct vulkan_buffer {
      */
     b8 is_locked;
     /**
-     * @brief Memory requirements for this buffer (alignment, size, memory type bits).
+     * @brief The device memory the buffer is bound to.
      */
-    VkDeviceMemory memory;
+    vulkan_memory_allocation allocation;
     /**
      * @brief Index of the memory type used for this buffer.
      *
@@ -158,6 +325,21 @@ typedef struct vulkan_buffer {
      * For example, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT for CPU access.
      */
     u32 memory_property_flags;
+
+    /**
+     * @brief Tracks which ranges of the buffer are free, if it is sub-allocated.
+     */
+    freelist freelist;
+
+    /**
+     * @brief Size of the block holding the free list.
+     */
+    u64 freelist_memory_requirement;
+
+    /**
+     * @brief The block holding the free list. 0 if the buffer is not sub-allocated.
+     */
+    void* freelist_memory;
 } vulkan_buffer;
 
 /**
@@ -248,6 +430,21 @@ typedef struct vulkan_device {
      */
     b8 supports_device_local_host_visible;
 
+    /**
+     * @brief Whether the device can draw more than one command per indirect draw call.
+     */
+    b8 supports_multi_draw_indirect;
+
+    /**
+     * @brief Whether the device supports indirect draws that read their draw count from a buffer.
+     */
+    b8 supports_draw_indirect_count;
+
+    /**
+     * @brief Whether the device can sample BC1-BC7 block-compressed images.
+     */
+    b8 supports_bc_compression;
+
     /**
      * @brief Graphics queue handle for submitting command buffers.
      */
@@ -270,6 +467,21 @@ typedef struct vulkan_device {
      */
     VkCommandPool graphics_command_pool;
 
+    /**
+     * @brief Command pool for transfer commands.
+     *
+     * Used to allocate command buffers that are submitted to the transfer queue.
+     */
+    VkCommandPool transfer_command_pool;
+
+    /**
+     * @brief Whether the transfer queue belongs to a different family than the graphics queue.
+     *
+     * If so, uploads run alongside rendering, and resources they write must have their
+     * ownership transferred to the graphics queue family before use.
+     */
+    b8 has_dedicated_transfer_queue;
+
     /**
      * @brief Properties of the physical device (name, type, driver version, etc.).
      */
@@ -305,9 +517,9 @@ typedef struct vulkan_image {
     VkImage handle;
 
     /**
-     * @brief Device memory bound to this image.
+     * @brief The device memory the image is bound to.
      */
-    VkDeviceMemory memory;
+    vulkan_memory_allocation allocation;
 
     /**
      * @brief Image view used to access the image in shaders/render passes.
@@ -323,6 +535,11 @@ typedef struct vulkan_image {
      * @brief Height of the image in pixels.
      */
     u32 height;
+
+    /**
+     * @brief The number of mip levels of the image.
+     */
+    u32 mip_levels;
 } vulkan_image;
 
 /**
@@ -616,6 +833,204 @@ typedef struct vulkan_fence {
     b8 is_signaled;
 } vulkan_fence;
 
+/** Number of upload batches the staging ring can have submitted to the GPU at once. */
+#define VULKAN_STAGING_BATCH_COUNT 4
+
+/**
+ * @struct vulkan_staging_batch
+ * @brief A command buffer of upload commands that read from the staging ring, and the timeline
+ * value that is signaled when the GPU has finished with them.
+ */
+typedef struct vulkan_staging_batch {
+    /**
+     * @brief Command buffer the upload commands are recorded into.
+     */
+    vulkan_command_buffer command_buffer;
+
+    /**
+     * @brief The value the ring's timeline semaphore is set to when the batch has executed, at
+     * which point its staging space can be reused.
+     */
+    u64 timeline_value;
+
+    /**
+     * @brief The staging ring's head when the batch was submitted. Everything before it is
+     * reclaimed once the batch completes.
+     */
+    u64 ring_end;
+
+    /**
+     * @brief Whether commands are currently being recorded into the batch.
+     */
+    b8 is_recording;
+
+    /**
+     * @brief Whether the batch has been submitted and not yet reclaimed.
+     */
+    b8 is_submitted;
+} vulkan_staging_batch;
+
+/**
+ * @struct vulkan_upload_acquire
+ * @brief A buffer range or image released by the transfer queue, which the graphics queue must
+ * acquire once the upload that wrote it completes.
+ */
+typedef struct vulkan_upload_acquire {
+    /** @brief The ticket of the upload that released the resource. */
+    u64 ticket;
+
+    /** @brief The image to acquire, or 0 if a buffer range is being acquired. */
+    VkImage image;
+
+    /** @brief The number of mip levels of the image, all of which are acquired. */
+    u32 mip_levels;
+
+    /** @brief The buffer to acquire. */
+    VkBuffer buffer;
+
+    /** @brief The offset of the buffer range. */
+    u64 offset;
+
+    /** @brief The size of the buffer range. */
+    u64 size;
+} vulkan_upload_acquire;
+
+/**
+ * @struct vulkan_staging_ring
+ * @brief A persistently-mapped, host-visible buffer that uploads are sub-allocated from.
+ *
+ * Space is handed out in order from a ring. The upload commands reading it are recorded into
+ * the current batch, which is submitted to the transfer queue once per frame (or early, if the
+ * ring fills up). Space is reclaimed when a batch's timeline value is reached, so nothing waits
+ * for a queue to go idle.
+ */
+typedef struct vulkan_staging_ring {
+    /**
+     * @brief The host-visible, host-coherent staging buffer.
+     */
+    vulkan_buffer buffer;
+
+    /**
+     * @brief The buffer's memory, mapped for the lifetime of the ring.
+     */
+    u8* mapped;
+
+    /**
+     * @brief Size of the ring in bytes.
+     */
+    u64 size;
+
+    /**
+     * @brief Total bytes ever allocated. The write position is head % size.
+     */
+    u64 head;
+
+    /**
+     * @brief Total bytes ever reclaimed. Space between tail and head is in use.
+     */
+    u64 tail;
+
+    /**
+     * @brief The most bytes that have been in use at once, to help size the ring.
+     */
+    u64 peak_usage;
+
+    /**
+     * @brief Upload batches, used in turn.
+     */
+    vulkan_staging_batch batches[VULKAN_STAGING_BATCH_COUNT];
+
+    /**
+     * @brief Index of the batch uploads are currently recorded into.
+     */
+    u32 current_batch;
+
+    /**
+     * @brief Timeline semaphore each batch signals with its timeline_value on completion.
+     * Upload tickets are values of this semaphore.
+     */
+    VkSemaphore timeline;
+
+    /**
+     * @brief The timeline value of the most recently submitted batch.
+     */
+    u64 submitted_value;
+
+    /**
+     * @brief Uploads with tickets up to this value are complete, and acquired by the graphics
+     * queue if required. The graphics queue waits on this value before using them.
+     */
+    u64 acquired_value;
+
+    /**
+     * @brief A darray of resources waiting to be acquired by the graphics queue.
+     * Only used with a dedicated transfer queue.
+     */
+    vulkan_upload_acquire* pending_acquires;
+} vulkan_staging_ring;
+
+/**
+ * @enum vulkan_deferred_deletion_type
+ * @brief The kinds of resource the deletion queue can destroy.
+ */
+typedef enum vulkan_deferred_deletion_type {
+    /** @brief A range of a sub-allocated buffer, returned to the buffer's free list. */
+    VULKAN_DEFERRED_DELETION_TYPE_BUFFER_RANGE,
+    /** @brief An image, its view and its memory. */
+    VULKAN_DEFERRED_DELETION_TYPE_IMAGE,
+    /** @brief A sampler. */
+    VULKAN_DEFERRED_DELETION_TYPE_SAMPLER,
+    /** @brief Descriptor sets, returned to their pool. */
+    VULKAN_DEFERRED_DELETION_TYPE_DESCRIPTOR_SETS
+} vulkan_deferred_deletion_type;
+
+/**
+ * @struct vulkan_deferred_deletion
+ * @brief A resource released by the CPU which the GPU may still be using.
+ */
+typedef struct vulkan_deferred_deletion {
+    /** @brief The kind of resource, which selects the member of the union in use. */
+    vulkan_deferred_deletion_type type;
+    /**
+     * @brief The staging ticket current when the resource was released. The transfer queue may
+     * still be writing buffer ranges and images until it completes. 0 for everything else.
+     */
+    u64 ticket;
+    union {
+        /** @brief The buffer range to free. */
+        vulkan_buffer_range buffer_range;
+        /** @brief A copy of the image to destroy. */
+        vulkan_image image;
+        /** @brief The sampler to destroy. */
+        VkSampler sampler;
+        /** @brief The descriptor sets to free, and the pool they came from. */
+        struct {
+            VkDescriptorPool pool;
+            u32 count;
+            VkDescriptorSet sets[MAX_FRAMES_IN_FLIGHT];
+        } descriptor_sets;
+    };
+} vulkan_deferred_deletion;
+
+/**
+ * @struct vulkan_deletion_queue
+ * @brief Resources waiting for the frames that may use them to finish before being destroyed.
+ *
+ * Each frame in flight has its own list, which is destroyed once the frame's in-flight fence
+ * next signals. Resources whose upload has not completed by then stay on the list until it has.
+ */
+typedef struct vulkan_deletion_queue {
+    /**
+     * @brief Per frame in flight, a darray of the resources released since that frame was last begun.
+     */
+    vulkan_deferred_deletion* pending[MAX_FRAMES_IN_FLIGHT];
+
+    /**
+     * @brief The most resources that have been pending at once.
+     */
+    u32 peak_pending_count;
+} vulkan_deletion_queue;
+
 /**
  * @struct vulkan_shader_stage
  * @brief Represents a single shader stage in Vulkan.
@@ -795,6 +1210,11 @@ typedef struct vulkan_material_shader {
  */
 typedef struct vulkan_context {
     f32 frame_delta_time;
+    /**
+     * @brief The number of the frame being recorded, copied from the frontend at the start of
+     * each frame.
+     */
+    u64 frame_number;
     /**
      * @brief The framebuffer's current width.
      */
@@ -875,6 +1295,22 @@ typedef struct vulkan_context {
      */
     vulkan_buffer object_index_buffer;
 
+    /**
+     * @brief Host-visible buffer holding the model matrix of every instance drawn.
+     *
+     * Split into one region of VULKAN_MAX_INSTANCES_PER_FRAME matrices per frame in flight, so
+     * a frame's matrices are not overwritten while the GPU may still read them.
+     */
+    vulkan_buffer instance_buffer;
+
+    /**
+     * @brief Host-visible buffer holding the draw list of the indirect draw mode.
+     *
+     * Each frame in flight has a region of VULKAN_MAX_INDIRECT_DRAWS_PER_FRAME draw commands,
+     * followed by as many draw counts, one per indirect draw call.
+     */
+    vulkan_buffer indirect_buffer;
+
     /**
      * @brief Array of command buffers for rendering (one per frame).
      */
@@ -919,6 +1355,11 @@ typedef struct vulkan_context {
      */
     u32 current_frame;
 
+    /**
+     * @brief Indicates whether a frame is being recorded, i.e. between begin_frame and its submission.
+     */
+    b8 frame_in_progress;
+
     /**
      * @brief Indicates whether the swapchain is currently being recreated.
      *
@@ -934,18 +1375,9 @@ typedef struct vulkan_context {
     vulkan_material_shader material_shader;
 
     /**
-     * @brief Offset in bytes for the vertex buffer used for geometry data.
-     *
-     * This is used to calculate where to start writing geometry vertex data in the buffer.
+     * @brief Resources released while frames in flight may still be using them.
      */
-    u64 geometry_vertex_offset;
-
-    /**
-     * @brief Offset in bytes for the index buffer used for geometry data.
-     *
-     * This is used to calculate where to start writing geometry index data in the buffer.
-     */
-    u64 geometry_index_offset;
+    vulkan_deletion_queue deletion_queue;
 
     // TODO: Make dynamic
     /**
@@ -956,6 +1388,27 @@ typedef struct vulkan_context {
      */
     vulkan_geometry_data geometries[VULKAN_MAX_GEOMETRY_COUNT];
 
+    /** @brief Hands out slots of geometries, so uploads do not scan for a free one. */
+    handle_pool geometry_slots;
+
+    /** @brief The free stack and generations of geometry_slots. */
+    u32 geometry_slot_memory[VULKAN_MAX_GEOMETRY_COUNT * 2];
+
+    /**
+     * @brief Allocator buffer and image memory is sub-allocated from.
+     */
+    vulkan_memory_allocator memory_allocator;
+
+    /**
+     * @brief Pool the fixed-size vulkan_texture_data blocks are allocated from.
+     */
+    pool_allocator texture_data_pool;
+
+    /**
+     * @brief Ring that geometry and texture uploads are staged through.
+     */
+    vulkan_staging_ring staging;
+
     /**
      * @brief Function pointer for finding a compatible memory index based on requirements.
      *
@@ -968,4 +1421,7 @@ typedef struct vulkan_texture_data {
     vulkan_image image;
 
     VkSampler sampler;
+
+    /** @brief Ticket of the upload of the texture's pixels. Not sampled until it completes. */
+    u64 upload_ticket;
 } vulkan_texture_data;
\ No newline at end of file
@@ -0,0 +1,468 @@
+#include "kpak.h"
+
+#include "core/logger.h"
+#include "core/kmemory.h"
+#include "core/kstring.h"
+
+/**
+ * @file kpak.c
+ * @brief Implementation of the packed asset archive.
+ *
+ * Archives are validated once when opened, so lookups and reads can trust every offset in the
+ * header and entry records without checking them again.
+ */
+
+/** @brief The shortest match the codec encodes. Shorter repeats are cheaper as literals. */
+#define KPAK_LZ_MIN_MATCH 4
+
+/** @brief The furthest back a match can reach, limited by its 16-bit offset. */
+#define KPAK_LZ_MAX_OFFSET 65535
+
+/** @brief The log2 of the number of positions the compressor remembers. */
+#define KPAK_LZ_HASH_BITS 12
+
+/** @brief Rounds value up to the next multiple of alignment, which must be a power of two. */
+#define KPAK_ALIGN(value, alignment) (((value) + ((alignment) - 1)) & ~((u64)(alignment) - 1))
+
+u64 kpak_hash(const char* name, u64 length) {
+    u64 hash = 0xCBF29CE484222325ULL;
+    for (u64 i = 0; i < length; ++i) {
+        hash ^= (u8)name[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+/**
+ * @brief Checks that every offset in an archive lies within its mapping.
+ *
+ * @param pak A pointer to the archive, with its mapping set.
+ * @param path The path of the archive, for logging.
+ * @return True if the archive is well formed; otherwise False.
+ */
+static b8 validate(kpak* pak, const char* path) {
+    u64 file_size = pak->mapping.size;
+    if (file_size < sizeof(kpak_header)) {
+        KERROR("kpak_open - '%s' is too small to be an archive.", path);
+        return False;
+    }
+
+    const kpak_header* header = pak->mapping.memory;
+    if (header->magic != KPAK_MAGIC) {
+        KERROR("kpak_open - '%s' is not an archive.", path);
+        return False;
+    }
+    if (header->version != KPAK_VERSION) {
+        KERROR("kpak_open - '%s' is version %u; only version %u is supported.", path, header->version, KPAK_VERSION);
+        return False;
+    }
+
+    // The slot count must be a power of two with room for every entry, so probing terminates.
+    u32 slot_count = header->slot_count;
+    if (slot_count == 0 || (slot_count & (slot_count - 1)) != 0 || slot_count <= header->entry_count) {
+        KERROR("kpak_open - '%s' has an invalid table of contents.", path);
+        return False;
+    }
+
+    u64 entries_size = (u64)header->entry_count * sizeof(kpak_entry);
+    u64 slots_size = (u64)slot_count * sizeof(u32);
+    if (header->entries_offset > file_size || entries_size > file_size - header->entries_offset ||
+        header->slots_offset > file_size || slots_size > file_size - header->slots_offset ||
+        header->names_offset > file_size || header->names_size > file_size - header->names_offset ||
+        header->entries_offset % sizeof(u64) != 0 || header->slots_offset % sizeof(u32) != 0) {
+        KERROR("kpak_open - '%s' is truncated or corrupt.", path);
+        return False;
+    }
+
+    const u8* base = pak->mapping.memory;
+    pak->header = header;
+    pak->entries = (const kpak_entry*)(base + header->entries_offset);
+    pak->slots = (const u32*)(base + header->slots_offset);
+    pak->names = (const char*)(base + header->names_offset);
+
+    for (u32 i = 0; i < header->entry_count; ++i) {
+        const kpak_entry* entry = &pak->entries[i];
+        b8 name_fits = entry->name_offset < header->names_size && entry->name_length < header->names_size - entry->name_offset &&
+                       pak->names[entry->name_offset + entry->name_length] == 0;
+        b8 data_fits = entry->offset <= file_size && entry->stored_size <= file_size - entry->offset;
+        b8 size_matches = entry->compression == KPAK_COMPRESSION_LZ || (entry->compression == KPAK_COMPRESSION_NONE && entry->stored_size == entry->size);
+        if (!name_fits || !data_fits || !size_matches) {
+            KERROR("kpak_open - '%s' has a corrupt entry at index %u.", path, i);
+            return False;
+        }
+    }
+
+    for (u32 i = 0; i < slot_count; ++i) {
+        if (pak->slots[i] != INVALID_ID && pak->slots[i] >= header->entry_count) {
+            KERROR("kpak_open - '%s' has a corrupt table of contents.", path);
+            return False;
+        }
+    }
+
+    return True;
+}
+
+b8 kpak_open(const char* path, kpak* out_pak) {
+    kzero_memory(out_pak, sizeof(kpak));
+    if (!filesystem_map(path, &out_pak->mapping)) {
+        return False;
+    }
+
+    if (!validate(out_pak, path)) {
+        kpak_close(out_pak);
+        return False;
+    }
+
+    KDEBUG("Opened archive '%s' with %u entries.", path, out_pak->header->entry_count);
+    return True;
+}
+
+void kpak_close(kpak* pak) {
+    filesystem_unmap(&pak->mapping);
+    kzero_memory(pak, sizeof(kpak));
+}
+
+const kpak_entry* kpak_find(const kpak* pak, const char* name) {
+    if (!pak || !pak->header || !name) {
+        return 0;
+    }
+
+    u64 length = string_length(name);
+    u64 hash = kpak_hash(name, length);
+    u32 mask = pak->header->slot_count - 1;
+
+    // Linear probing. There is always an empty slot, which ends the search.
+    for (u32 slot = (u32)hash & mask;; slot = (slot + 1) & mask) {
+        u32 index = pak->slots[slot];
+        if (index == INVALID_ID) {
+            return 0;
+        }
+        const kpak_entry* entry = &pak->entries[index];
+        if (entry->hash == hash && entry->name_length == length && strings_equal(pak->names + entry->name_offset, name)) {
+            return entry;
+        }
+    }
+}
+
+b8 kpak_read(const kpak* pak, const kpak_entry* entry, kpak_data* out_data) {
+    const u8* stored = (const u8*)pak->mapping.memory + entry->offset;
+    out_data->size = entry->size;
+
+    // Empty entries have nothing to decompress.
+    if (entry->compression == KPAK_COMPRESSION_NONE || entry->size == 0) {
+        out_data->data = stored;
+        out_data->owned = False;
+        return True;
+    }
+
+    void* buffer = kallocate(entry->size, MEMORY_TAG_ARRAY);
+    if (!kpak_decompress(stored, entry->stored_size, buffer, entry->size)) {
+        KERROR("kpak_read - entry '%s' is corrupt.", pak->names + entry->name_offset);
+        kfree(buffer, entry->size, MEMORY_TAG_ARRAY);
+        out_data->data = 0;
+        out_data->size = 0;
+        out_data->owned = False;
+        return False;
+    }
+
+    out_data->data = buffer;
+    out_data->owned = True;
+    return True;
+}
+
+void kpak_data_release(kpak_data* data) {
+    if (data->owned && data->data) {
+        kfree((void*)data->data, data->size, MEMORY_TAG_ARRAY);
+    }
+    data->data = 0;
+    data->size = 0;
+    data->owned = False;
+}
+
+b8 kpak_write(const char* path, u32 source_count, const kpak_source* sources) {
+    // Keep the table at most half full, so probes stay short.
+    u32 slot_count = 16;
+    while (slot_count < source_count * 2) {
+        slot_count <<= 1;
+    }
+
+    kpak_entry* entries = kallocate(sizeof(kpak_entry) * (source_count ? source_count : 1), MEMORY_TAG_ARRAY);
+    u32* slots = kallocate(sizeof(u32) * slot_count, MEMORY_TAG_ARRAY);
+    void** compressed = kallocate(sizeof(void*) * (source_count ? source_count : 1), MEMORY_TAG_ARRAY);
+    u64* compressed_capacity = kallocate(sizeof(u64) * (source_count ? source_count : 1), MEMORY_TAG_ARRAY);
+    kset_memory(slots, 0xFF, sizeof(u32) * slot_count);
+
+    u8* file = 0;
+    u64 file_size = 0;
+    b8 result = False;
+
+    // Hash the paths into the table, rejecting duplicates, and lay out the names.
+    u64 names_size = 0;
+    for (u32 i = 0; i < source_count; ++i) {
+        u64 length = string_length(sources[i].name);
+        if (length == 0 || length > 0xFFFF) {
+            KERROR("kpak_write - source %u has an invalid path.", i);
+            goto cleanup;
+        }
+
+        kpak_entry* entry = &entries[i];
+        entry->hash = kpak_hash(sources[i].name, length);
+        entry->name_offset = (u32)names_size;
+        entry->name_length = (u32)length;
+        names_size += length + 1;
+
+        u32 mask = slot_count - 1;
+        u32 slot = (u32)entry->hash & mask;
+        while (slots[slot] != INVALID_ID) {
+            const kpak_entry* other = &entries[slots[slot]];
+            if (other->hash == entry->hash && strings_equal(sources[slots[slot]].name, sources[i].name)) {
+                KERROR("kpak_write - '%s' was given more than once.", sources[i].name);
+                goto cleanup;
+            }
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = i;
+    }
+
+    // Compress where asked, keeping the result only if it saves at least an eighth.
+    for (u32 i = 0; i < source_count; ++i) {
+        kpak_entry* entry = &entries[i];
+        entry->size = sources[i].size;
+        entry->stored_size = sources[i].size;
+        entry->compression = KPAK_COMPRESSION_NONE;
+
+        if (sources[i].compress && sources[i].size > 0) {
+            compressed_capacity[i] = kpak_compress_bound(sources[i].size);
+            compressed[i] = kallocate(compressed_capacity[i], MEMORY_TAG_ARRAY);
+            u64 compressed_size = kpak_compress(sources[i].data, sources[i].size, compressed[i]);
+            if (compressed_size < sources[i].size - sources[i].size / 8) {
+                entry->stored_size = compressed_size;
+                entry->compression = KPAK_COMPRESSION_LZ;
+            }
+        }
+    }
+
+    kpak_header header;
+    kzero_memory(&header, sizeof(kpak_header));
+    header.magic = KPAK_MAGIC;
+    header.version = KPAK_VERSION;
+    header.entry_count = source_count;
+    header.slot_count = slot_count;
+    header.alignment = KPAK_ALIGNMENT;
+    header.entries_offset = sizeof(kpak_header);
+    header.slots_offset = header.entries_offset + sizeof(kpak_entry) * source_count;
+    header.names_offset = header.slots_offset + sizeof(u32) * slot_count;
+    header.names_size = names_size;
+
+    file_size = header.names_offset + names_size;
+    for (u32 i = 0; i < source_count; ++i) {
+        entries[i].offset = KPAK_ALIGN(file_size, KPAK_ALIGNMENT);
+        file_size = entries[i].offset + entries[i].stored_size;
+    }
+
+    file = kallocate(file_size, MEMORY_TAG_ARRAY);
+    kcopy_memory(file, &header, sizeof(kpak_header));
+    kcopy_memory(file + header.entries_offset, entries, sizeof(kpak_entry) * source_count);
+    kcopy_memory(file + header.slots_offset, slots, sizeof(u32) * slot_count);
+    for (u32 i = 0; i < source_count; ++i) {
+        kcopy_memory(file + header.names_offset + entries[i].name_offset, sources[i].name, entries[i].name_length);
+        const void* data = entries[i].compression == KPAK_COMPRESSION_LZ ? compressed[i] : sources[i].data;
+        if (entries[i].stored_size) {
+            kcopy_memory(file + entries[i].offset, data, entries[i].stored_size);
+        }
+    }
+
+    file_handle f;
+    if (!filesystem_open(path, FILE_MODE_WRITE, True, &f)) {
+        KERROR("kpak_write - unable to open '%s' for writing.", path);
+        goto cleanup;
+    }
+    u64 written = 0;
+    result = filesystem_write(&f, file_size, file, &written);
+    filesystem_close(&f);
+    if (!result) {
+        KERROR("kpak_write - unable to write '%s'.", path);
+    }
+
+cleanup:
+    if (file) {
+        kfree(file, file_size, MEMORY_TAG_ARRAY);
+    }
+    for (u32 i = 0; i < source_count; ++i) {
+        if (compressed[i]) {
+            kfree(compressed[i], compressed_capacity[i], MEMORY_TAG_ARRAY);
+        }
+    }
+    kfree(compressed_capacity, sizeof(u64) * (source_count ? source_count : 1), MEMORY_TAG_ARRAY);
+    kfree(compressed, sizeof(void*) * (source_count ? source_count : 1), MEMORY_TAG_ARRAY);
+    kfree(slots, sizeof(u32) * slot_count, MEMORY_TAG_ARRAY);
+    kfree(entries, sizeof(kpak_entry) * (source_count ? source_count : 1), MEMORY_TAG_ARRAY);
+    return result;
+}
+
+u64 kpak_compress_bound(u64 size) {
+    // Incompressible data costs a token plus a length byte per 255 literals.
+    return size + size / 255 + 16;
+}
+
+/**
+ * @brief Writes the part of a length that does not fit its token.
+ *
+ * @param out Where to write.
+ * @param length The remaining length.
+ * @return The position after the written bytes.
+ */
+static u8* write_length(u8* out, u64 length) {
+    while (length >= 255) {
+        *out++ = 255;
+        length -= 255;
+    }
+    *out++ = (u8)length;
+    return out;
+}
+
+/**
+ * @brief Writes a sequence of literals, followed by a match if match_length is non-zero.
+ *
+ * @param out Where to write.
+ * @param literals The literals.
+ * @param literal_count The number of literals.
+ * @param offset How far back the match starts.
+ * @param match_length The length of the match, or 0 for the final, literal-only sequence.
+ * @return The position after the sequence.
+ */
+static u8* write_sequence(u8* out, const u8* literals, u64 literal_count, u32 offset, u64 match_length) {
+    u8* token = out++;
+    *token = (u8)((literal_count < 15 ? literal_count : 15) << 4);
+    if (literal_count >= 15) {
+        out = write_length(out, literal_count - 15);
+    }
+    kcopy_memory(out, literals, literal_count);
+    out += literal_count;
+
+    if (match_length) {
+        *out++ = (u8)(offset & 0xFF);
+        *out++ = (u8)(offset >> 8);
+        u64 extra = match_length - KPAK_LZ_MIN_MATCH;
+        *token |= (u8)(extra < 15 ? extra : 15);
+        if (extra >= 15) {
+            out = write_length(out, extra - 15);
+        }
+    }
+    return out;
+}
+
+/** @brief Reads four bytes, in any alignment. */
+static u32 read_u32(const u8* p) {
+    return (u32)p[0] | ((u32)p[1] << 8) | ((u32)p[2] << 16) | ((u32)p[3] << 24);
+}
+
+u64 kpak_compress(const void* source, u64 size, void* out_buffer) {
+    const u8* in = source;
+    u8* out = out_buffer;
+
+    // The last position seen for each hash of four bytes, plus one so that zero means none.
+    u32 table[1 << KPAK_LZ_HASH_BITS];
+    kzero_memory(table, sizeof(table));
+
+    u64 pos = 0;
+    u64 anchor = 0;
+    while (pos + KPAK_LZ_MIN_MATCH <= size) {
+        u32 sequence = read_u32(in + pos);
+        u32 hash = (sequence * 2654435761U) >> (32 - KPAK_LZ_HASH_BITS);
+        u64 candidate = table[hash];
+        table[hash] = (u32)(pos + 1);
+
+        // Past 4GiB the remembered positions wrap, and fail the distance check.
+        if (candidate && pos - (candidate - 1) <= KPAK_LZ_MAX_OFFSET && read_u32(in + candidate - 1) == sequence) {
+            u64 match = candidate - 1;
+            u64 length = KPAK_LZ_MIN_MATCH;
+            while (pos + length < size && in[match + length] == in[pos + length]) {
+                length++;
+            }
+
+            out = write_sequence(out, in + anchor, pos - anchor, (u32)(pos - match), length);
+            pos += length;
+            anchor = pos;
+        } else {
+            pos++;
+        }
+    }
+
+    out = write_sequence(out, in + anchor, size - anchor, 0, 0);
+    return (u64)(out - (u8*)out_buffer);
+}
+
+/**
+ * @brief Reads the part of a length that did not fit its token.
+ *
+ * @param in The read position, advanced past the length.
+ * @param end The end of the input.
+ * @param length The length to add to.
+ * @return True if the length was read; False if the input ended first.
+ */
+static b8 read_length(const u8** in, const u8* end, u64* length) {
+    u8 byte;
+    do {
+        if (*in >= end) {
+            return False;
+        }
+        byte = *(*in)++;
+        *length += byte;
+    } while (byte == 255);
+    return True;
+}
+
+b8 kpak_decompress(const void* source, u64 source_size, void* out_buffer, u64 size) {
+    const u8* in = source;
+    const u8* in_end = in + source_size;
+    u8* out = out_buffer;
+    u8* out_end = out + size;
+
+    while (in < in_end) {
+        u8 token = *in++;
+
+        u64 literal_count = token >> 4;
+        if (literal_count == 15 && !read_length(&in, in_end, &literal_count)) {
+            return False;
+        }
+        if (literal_count > (u64)(in_end - in) || literal_count > (u64)(out_end - out)) {
+            return False;
+        }
+        kcopy_memory(out, in, literal_count);
+        in += literal_count;
+        out += literal_count;
+
+        // The final sequence has no match.
+        if (in == in_end) {
+            break;
+        }
+
+        if (in_end - in < 2) {
+            return False;
+        }
+        u64 offset = (u64)in[0] | ((u64)in[1] << 8);
+        in += 2;
+        if (offset == 0 || offset > (u64)(out - (u8*)out_buffer)) {
+            return False;
+        }
+
+        u64 length = token & 0x0F;
+        if (length == 15 && !read_length(&in, in_end, &length)) {
+            return False;
+        }
+        length += KPAK_LZ_MIN_MATCH;
+        if (length > (u64)(out_end - out)) {
+            return False;
+        }
+
+        // Byte by byte, as a match may overlap the bytes it produces.
+        const u8* match = out - offset;
+        for (u64 i = 0; i < length; ++i) {
+            out[i] = match[i];
+        }
+        out += length;
+    }
+
+    return out == out_end;
+}
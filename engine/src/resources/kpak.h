@@ -0,0 +1,240 @@
+#pragma once
+
+#include "defines.h"
+#include "platform/filesystem.h"
+
+/**
+ * @file kpak.h
+ *
+ * @brief The packed asset archive (.kpak).
+ *
+ * A kpak holds many files in one, so that loading assets costs one mapping instead of an open
+ * per file. The archive is mapped into memory and never read through a file handle; stored
+ * entries are handed out as pointers straight into the mapping.
+ *
+ * Layout, all little-endian:
+ * - A kpak_header.
+ * - entry_count kpak_entry records.
+ * - slot_count u32 slots, an open-addressed hash table of entry indices keyed on the hash of
+ *   each entry's path. Empty slots hold INVALID_ID.
+ * - The entry paths, each followed by a terminator.
+ * - The entry data, each entry starting on a multiple of the header's alignment.
+ *
+ * Entry paths are relative to the packed directory and use '/', e.g. "textures/paving.png".
+ *
+ * Entries may be compressed with a small LZ77 codec. Compressed entries are decompressed into
+ * a buffer on each read, so only stored entries are zero-copy. The packer only keeps the
+ * compressed form when it is meaningfully smaller.
+ */
+
+/** @brief The magic number at the start of every archive, "KPAK" in file order. */
+#define KPAK_MAGIC 0x4B41504BU
+
+/** @brief The version of the layout this engine reads and writes. */
+#define KPAK_VERSION 1
+
+/** @brief The alignment of entry data within archives written by this engine. */
+#define KPAK_ALIGNMENT 64
+
+/**
+ * @enum kpak_compression
+ * @brief How an entry's data is stored.
+ */
+typedef enum kpak_compression {
+    /** Stored as-is. Reads point into the mapping. */
+    KPAK_COMPRESSION_NONE = 0,
+    /** Compressed with kpak_compress(). */
+    KPAK_COMPRESSION_LZ = 1
+} kpak_compression;
+
+/**
+ * @struct kpak_header
+ * @brief The header at the start of an archive. Offsets are from the start of the file.
+ */
+typedef struct kpak_header {
+    /** KPAK_MAGIC. */
+    u32 magic;
+    /** KPAK_VERSION. */
+    u32 version;
+    /** The number of entries. */
+    u32 entry_count;
+    /** The number of hash table slots. A power of two, larger than entry_count. */
+    u32 slot_count;
+    /** The alignment of entry data. */
+    u32 alignment;
+    /** Reserved, 0. */
+    u32 reserved;
+    /** The offset of the kpak_entry records. */
+    u64 entries_offset;
+    /** The offset of the hash table slots. */
+    u64 slots_offset;
+    /** The offset of the entry paths. */
+    u64 names_offset;
+    /** The size of the entry paths, terminators included. */
+    u64 names_size;
+} kpak_header;
+
+/**
+ * @struct kpak_entry
+ * @brief The record of a file within an archive.
+ */
+typedef struct kpak_entry {
+    /** The hash of the path, from kpak_hash(). */
+    u64 hash;
+    /** The offset of the data from the start of the file. */
+    u64 offset;
+    /** The size of the data as stored. */
+    u64 stored_size;
+    /** The size of the data once decompressed. */
+    u64 size;
+    /** The offset of the path within the entry paths. */
+    u32 name_offset;
+    /** The length of the path, without the terminator. */
+    u32 name_length;
+    /** The kpak_compression of the data. */
+    u32 compression;
+    /** Reserved, 0. */
+    u32 reserved;
+} kpak_entry;
+
+/**
+ * @struct kpak
+ * @brief An archive opened for reading.
+ */
+typedef struct kpak {
+    /** The mapping of the archive. */
+    file_mapping mapping;
+    /** The header, at the start of the mapping. */
+    const kpak_header* header;
+    /** The entry records, header->entry_count long. */
+    const kpak_entry* entries;
+    /** The hash table slots, header->slot_count long. */
+    const u32* slots;
+    /** The entry paths. */
+    const char* names;
+} kpak;
+
+/**
+ * @struct kpak_data
+ * @brief The data of an entry, as read by kpak_read().
+ */
+typedef struct kpak_data {
+    /** The data. Points into the mapping unless owned is set. */
+    const void* data;
+    /** The size of the data in bytes. */
+    u64 size;
+    /** Whether data was allocated by the read, and must be released with kpak_data_release(). */
+    b8 owned;
+} kpak_data;
+
+/**
+ * @struct kpak_source
+ * @brief A file to be written into an archive by kpak_write().
+ */
+typedef struct kpak_source {
+    /** The path of the entry within the archive. */
+    const char* name;
+    /** The data of the file. */
+    const void* data;
+    /** The size of the data in bytes. */
+    u64 size;
+    /** Whether to try compressing the data. It is stored as-is if that saves little. */
+    b8 compress;
+} kpak_source;
+
+/**
+ * @brief Hashes an entry path (64-bit FNV-1a).
+ *
+ * @param name The path.
+ * @param length The length of the path.
+ * @return The hash.
+ */
+KAPI u64 kpak_hash(const char* name, u64 length);
+
+/**
+ * @brief Maps and validates the archive at path.
+ *
+ * @param path The path of the archive.
+ * @param out_pak A pointer to hold the opened archive.
+ * @return True if the archive was opened; otherwise False.
+ */
+KAPI b8 kpak_open(const char* path, kpak* out_pak);
+
+/**
+ * @brief Closes an archive. Stored data read from it is invalid afterward.
+ *
+ * @param pak A pointer to the archive.
+ */
+KAPI void kpak_close(kpak* pak);
+
+/**
+ * @brief Looks up an entry by path. Safe to call from any thread.
+ *
+ * @param pak A pointer to the archive.
+ * @param name The path of the entry, e.g. "textures/paving.png".
+ * @return A pointer to the entry, or 0 if the archive has no such entry.
+ */
+KAPI const kpak_entry* kpak_find(const kpak* pak, const char* name);
+
+/**
+ * @brief Reads the data of an entry. Safe to call from any thread.
+ *
+ * Stored entries point into the mapping and cost nothing to read. Compressed entries are
+ * decompressed into a new buffer.
+ *
+ * @param pak A pointer to the archive.
+ * @param entry A pointer to the entry, from kpak_find().
+ * @param out_data A pointer to hold the data. Release it with kpak_data_release().
+ * @return True if the data was read; otherwise False.
+ */
+KAPI b8 kpak_read(const kpak* pak, const kpak_entry* entry, kpak_data* out_data);
+
+/**
+ * @brief Releases data read with kpak_read(), freeing it if it was decompressed.
+ *
+ * @param data A pointer to the data.
+ */
+KAPI void kpak_data_release(kpak_data* data);
+
+/**
+ * @brief Writes an archive holding the given files.
+ *
+ * @param path The path of the archive to write.
+ * @param source_count The number of files.
+ * @param sources The files. Paths must be unique.
+ * @return True if the archive was written; otherwise False.
+ */
+KAPI b8 kpak_write(const char* path, u32 source_count, const kpak_source* sources);
+
+/**
+ * @brief Returns the largest size kpak_compress() can produce for the given input size.
+ *
+ * @param size The size of the input in bytes.
+ * @return The size the output buffer must have.
+ */
+KAPI u64 kpak_compress_bound(u64 size);
+
+/**
+ * @brief Compresses data with the archive's LZ77 codec.
+ *
+ * The output is a run of sequences, each a token byte holding a literal length and a match
+ * length, the literals, and a 16-bit offset back to the match. Lengths that do not fit a token
+ * continue in extra bytes.
+ *
+ * @param source The data to compress.
+ * @param size The size of the data in bytes.
+ * @param out_buffer The buffer to compress into, at least kpak_compress_bound(size) long.
+ * @return The size of the compressed data.
+ */
+KAPI u64 kpak_compress(const void* source, u64 size, void* out_buffer);
+
+/**
+ * @brief Decompresses data compressed with kpak_compress().
+ *
+ * @param source The compressed data.
+ * @param source_size The size of the compressed data in bytes.
+ * @param out_buffer The buffer to decompress into.
+ * @param size The size of the decompressed data, which must fill the buffer exactly.
+ * @return True if the data decompressed to exactly size bytes; otherwise False.
+ */
+KAPI b8 kpak_decompress(const void* source, u64 source_size, void* out_buffer, u64 size);
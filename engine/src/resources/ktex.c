@@ -0,0 +1,583 @@
+#include "ktex.h"
+
+#include "core/kmemory.h"
+#include "math/ksimd.h"
+
+/**
+ * @file ktex.c
+ * @brief Implementation of the cooked texture container, and its BC1/BC3 codec.
+ *
+ * Blocks are encoded one at a time from a 4x4 tile of RGBA8 pixels. Tiles hanging off the right
+ * or top edge repeat the last column or row, so padding never pulls the endpoints toward black.
+ *
+ * Mip levels are filtered four output pixels at a time with SSE2 or NEON where available, as
+ * the image loader builds them at load time for every uncooked texture.
+ */
+
+/** @brief The width and height of a compressed block, in pixels. */
+#define KTEX_BLOCK_DIMENSION 4
+
+/** @brief The number of pixels in a compressed block. */
+#define KTEX_BLOCK_PIXELS (KTEX_BLOCK_DIMENSION * KTEX_BLOCK_DIMENSION)
+
+/** @brief The number of power iterations used to find the principal axis of a block's colors. */
+#define KTEX_AXIS_ITERATIONS 8
+
+/** @brief Gets a dimension of a mip level, which halves each level but never drops below 1. */
+static u32 mip_dimension(u32 size, u32 level) {
+    u32 dimension = size >> level;
+    return dimension ? dimension : 1;
+}
+
+/** @brief Gets the size of one block of a compressed format. */
+static u32 block_size(texture_format format) {
+    return format == TEXTURE_FORMAT_BC1 ? 8 : 16;
+}
+
+u32 ktex_mip_count(u32 width, u32 height) {
+    u32 count = 1;
+    while (width > 1 || height > 1) {
+        width = mip_dimension(width, 1);
+        height = mip_dimension(height, 1);
+        count++;
+    }
+    return count;
+}
+
+u64 ktex_level_size(texture_format format, u32 width, u32 height) {
+    if (format == TEXTURE_FORMAT_RGBA8) {
+        return (u64)width * height * 4;
+    }
+    u64 blocks_wide = (width + KTEX_BLOCK_DIMENSION - 1) / KTEX_BLOCK_DIMENSION;
+    u64 blocks_high = (height + KTEX_BLOCK_DIMENSION - 1) / KTEX_BLOCK_DIMENSION;
+    return blocks_wide * blocks_high * block_size(format);
+}
+
+u64 ktex_data_size(texture_format format, u32 width, u32 height, u32 mip_count) {
+    u64 size = 0;
+    for (u32 i = 0; i < mip_count; ++i) {
+        size += ktex_level_size(format, mip_dimension(width, i), mip_dimension(height, i));
+    }
+    return size;
+}
+
+b8 ktex_has_transparency(const u8* pixels, u64 pixel_count) {
+    for (u64 i = 0; i < pixel_count; ++i) {
+        if (pixels[i * 4 + 3] < 255) {
+            return True;
+        }
+    }
+    return False;
+}
+
+/**
+ * @brief Box-filters four adjacent output pixels from eight pixels of each of two source rows.
+ *
+ * The sums are widened to 16 bits, so the rounding matches the scalar filter exactly.
+ */
+static void downsample_four(const u8* row0, const u8* row1, u8* out) {
+#if defined(KSIMD_SSE)
+    __m128i zero = _mm_setzero_si128();
+    __m128i a0 = _mm_loadu_si128((const __m128i*)row0);
+    __m128i b0 = _mm_loadu_si128((const __m128i*)(row0 + 16));
+    __m128i a1 = _mm_loadu_si128((const __m128i*)row1);
+    __m128i b1 = _mm_loadu_si128((const __m128i*)(row1 + 16));
+
+    // Columns summed down the two rows, two pixels per register.
+    __m128i p01 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(a1, zero));
+    __m128i p23 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(a1, zero));
+    __m128i p45 = _mm_add_epi16(_mm_unpacklo_epi8(b0, zero), _mm_unpacklo_epi8(b1, zero));
+    __m128i p67 = _mm_add_epi16(_mm_unpackhi_epi8(b0, zero), _mm_unpackhi_epi8(b1, zero));
+
+    // Then each even column added to the odd column beside it.
+    __m128i low = _mm_add_epi16(_mm_unpacklo_epi64(p01, p23), _mm_unpackhi_epi64(p01, p23));
+    __m128i high = _mm_add_epi16(_mm_unpacklo_epi64(p45, p67), _mm_unpackhi_epi64(p45, p67));
+
+    __m128i two = _mm_set1_epi16(2);
+    low = _mm_srli_epi16(_mm_add_epi16(low, two), 2);
+    high = _mm_srli_epi16(_mm_add_epi16(high, two), 2);
+    _mm_storeu_si128((__m128i*)out, _mm_packus_epi16(low, high));
+#elif defined(KSIMD_NEON)
+    uint8x16_t a0 = vld1q_u8(row0);
+    uint8x16_t b0 = vld1q_u8(row0 + 16);
+    uint8x16_t a1 = vld1q_u8(row1);
+    uint8x16_t b1 = vld1q_u8(row1 + 16);
+
+    // Columns summed down the two rows, two pixels per register.
+    uint16x8_t p01 = vaddl_u8(vget_low_u8(a0), vget_low_u8(a1));
+    uint16x8_t p23 = vaddl_u8(vget_high_u8(a0), vget_high_u8(a1));
+    uint16x8_t p45 = vaddl_u8(vget_low_u8(b0), vget_low_u8(b1));
+    uint16x8_t p67 = vaddl_u8(vget_high_u8(b0), vget_high_u8(b1));
+
+    // Then each even column added to the odd column beside it, and a rounding shift by 2.
+    uint16x8_t low = vcombine_u16(vadd_u16(vget_low_u16(p01), vget_high_u16(p01)), vadd_u16(vget_low_u16(p23), vget_high_u16(p23)));
+    uint16x8_t high = vcombine_u16(vadd_u16(vget_low_u16(p45), vget_high_u16(p45)), vadd_u16(vget_low_u16(p67), vget_high_u16(p67)));
+    vst1q_u8(out, vcombine_u8(vmovn_u16(vrshrq_n_u16(low, 2)), vmovn_u16(vrshrq_n_u16(high, 2))));
+#else
+    for (u32 x = 0; x < 4; ++x) {
+        const u8* a = row0 + x * 8;
+        const u8* b = row1 + x * 8;
+        for (u32 channel = 0; channel < 4; ++channel) {
+            out[x * 4 + channel] = (u8)((a[channel] + a[channel + 4] + b[channel] + b[channel + 4] + 2) >> 2);
+        }
+    }
+#endif
+}
+
+void ktex_downsample(const u8* pixels, u32 width, u32 height, u8* out_pixels) {
+    u32 out_width = mip_dimension(width, 1);
+    u32 out_height = mip_dimension(height, 1);
+    // Output pixels whose 2x2 footprint lies fully within a row, which go four at a time.
+    u32 paired_width = width / 2;
+    for (u32 y = 0; y < out_height; ++y) {
+        u32 y0 = y * 2;
+        u32 y1 = y0 + 1 < height ? y0 + 1 : y0;
+        const u8* row0 = pixels + (u64)y0 * width * 4;
+        const u8* row1 = pixels + (u64)y1 * width * 4;
+        u8* out_row = out_pixels + (u64)y * out_width * 4;
+
+        u32 x = 0;
+        for (; x + 4 <= paired_width; x += 4) {
+            downsample_four(row0 + x * 8, row1 + x * 8, out_row + x * 4);
+        }
+        for (; x < out_width; ++x) {
+            u32 x0 = x * 2;
+            u32 x1 = x0 + 1 < width ? x0 + 1 : x0;
+            u8* out = out_row + x * 4;
+            for (u32 channel = 0; channel < 4; ++channel) {
+                out[channel] = (u8)((row0[x0 * 4 + channel] + row0[x1 * 4 + channel] + row1[x0 * 4 + channel] + row1[x1 * 4 + channel] + 2) >> 2);
+            }
+        }
+    }
+}
+
+b8 ktex_build_mip_chain(const u8* pixels, u32 width, u32 height, u8* out_pixels) {
+    if (!pixels || !out_pixels || !width || !height) {
+        return False;
+    }
+
+    u64 level_size = ktex_level_size(TEXTURE_FORMAT_RGBA8, width, height);
+    kcopy_memory(out_pixels, pixels, level_size);
+
+    // Each level is filtered from the one just written before it.
+    u8* level = out_pixels;
+    u32 mip_count = ktex_mip_count(width, height);
+    for (u32 i = 1; i < mip_count; ++i) {
+        ktex_downsample(level, width, height, level + level_size);
+        level += level_size;
+        width = mip_dimension(width, 1);
+        height = mip_dimension(height, 1);
+        level_size = ktex_level_size(TEXTURE_FORMAT_RGBA8, width, height);
+    }
+    return True;
+}
+
+/**
+ * @brief Copies the 4x4 tile of pixels a block covers, repeating the edge past the image.
+ */
+static void gather_block(const u8* pixels, u32 width, u32 height, u32 block_x, u32 block_y, u8* out_texels) {
+    for (u32 y = 0; y < KTEX_BLOCK_DIMENSION; ++y) {
+        u32 source_y = block_y * KTEX_BLOCK_DIMENSION + y;
+        if (source_y >= height) {
+            source_y = height - 1;
+        }
+        for (u32 x = 0; x < KTEX_BLOCK_DIMENSION; ++x) {
+            u32 source_x = block_x * KTEX_BLOCK_DIMENSION + x;
+            if (source_x >= width) {
+                source_x = width - 1;
+            }
+            kcopy_memory(out_texels + (y * KTEX_BLOCK_DIMENSION + x) * 4, pixels + ((u64)source_y * width + source_x) * 4, 4);
+        }
+    }
+}
+
+/**
+ * @brief Writes the pixels of a decoded block that lie within the image.
+ */
+static void scatter_block(const u8* texels, u32 width, u32 height, u32 block_x, u32 block_y, u8* out_pixels) {
+    for (u32 y = 0; y < KTEX_BLOCK_DIMENSION; ++y) {
+        u32 target_y = block_y * KTEX_BLOCK_DIMENSION + y;
+        for (u32 x = 0; x < KTEX_BLOCK_DIMENSION; ++x) {
+            u32 target_x = block_x * KTEX_BLOCK_DIMENSION + x;
+            if (target_x < width && target_y < height) {
+                kcopy_memory(out_pixels + ((u64)target_y * width + target_x) * 4, texels + (y * KTEX_BLOCK_DIMENSION + x) * 4, 4);
+            }
+        }
+    }
+}
+
+/** @brief Packs an 8-bit color to 5:6:5, rounding to nearest. */
+static u16 pack_565(const u8* color) {
+    u32 r = (color[0] * 31 + 127) / 255;
+    u32 g = (color[1] * 63 + 127) / 255;
+    u32 b = (color[2] * 31 + 127) / 255;
+    return (u16)((r << 11) | (g << 5) | b);
+}
+
+/** @brief Expands a 5:6:5 color back to 8 bits per channel, as the hardware does. */
+static void unpack_565(u16 packed, i32* out_color) {
+    i32 r = (packed >> 11) & 31;
+    i32 g = (packed >> 5) & 63;
+    i32 b = packed & 31;
+    out_color[0] = (r << 3) | (r >> 2);
+    out_color[1] = (g << 2) | (g >> 4);
+    out_color[2] = (b << 3) | (b >> 2);
+}
+
+/**
+ * @brief Encodes the colors of a tile as a 4-color BC1 block.
+ *
+ * The endpoints are the two colors furthest apart along the principal axis of the tile, found
+ * by power iteration on the covariance of its colors. Each pixel then takes the nearest of the
+ * four palette entries.
+ */
+static void encode_color_block(const u8* texels, u8* out_block) {
+    f32 mean[3] = {0, 0, 0};
+    for (u32 i = 0; i < KTEX_BLOCK_PIXELS; ++i) {
+        for (u32 c = 0; c < 3; ++c) {
+            mean[c] += texels[i * 4 + c];
+        }
+    }
+    for (u32 c = 0; c < 3; ++c) {
+        mean[c] /= KTEX_BLOCK_PIXELS;
+    }
+
+    // The covariance is symmetric: rr, rg, rb, gg, gb, bb.
+    f32 covariance[6] = {0, 0, 0, 0, 0, 0};
+    for (u32 i = 0; i < KTEX_BLOCK_PIXELS; ++i) {
+        f32 r = texels[i * 4 + 0] - mean[0];
+        f32 g = texels[i * 4 + 1] - mean[1];
+        f32 b = texels[i * 4 + 2] - mean[2];
+        covariance[0] += r * r;
+        covariance[1] += r * g;
+        covariance[2] += r * b;
+        covariance[3] += g * g;
+        covariance[4] += g * b;
+        covariance[5] += b * b;
+    }
+
+    // Start from the column of the channel that varies most, which cannot be orthogonal to the axis.
+    static const u32 columns[3][3] = {{0, 1, 2}, {1, 3, 4}, {2, 4, 5}};
+    u32 channel = 2;
+    if (covariance[0] >= covariance[3] && covariance[0] >= covariance[5]) {
+        channel = 0;
+    } else if (covariance[3] >= covariance[5]) {
+        channel = 1;
+    }
+    const u32* column = columns[channel];
+    f32 axis[3] = {covariance[column[0]], covariance[column[1]], covariance[column[2]]};
+    for (u32 iteration = 0; iteration < KTEX_AXIS_ITERATIONS; ++iteration) {
+        f32 r = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+        f32 g = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+        f32 b = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+        f32 largest = r > 0 ? r : -r;
+        largest = KMAX(largest, (g > 0 ? g : -g));
+        largest = KMAX(largest, (b > 0 ? b : -b));
+        if (largest < 1e-6f) {
+            break;
+        }
+        axis[0] = r / largest;
+        axis[1] = g / largest;
+        axis[2] = b / largest;
+    }
+
+    u32 min_index = 0;
+    u32 max_index = 0;
+    f32 min_projection = 0;
+    f32 max_projection = 0;
+    for (u32 i = 0; i < KTEX_BLOCK_PIXELS; ++i) {
+        f32 projection = texels[i * 4 + 0] * axis[0] + texels[i * 4 + 1] * axis[1] + texels[i * 4 + 2] * axis[2];
+        if (i == 0 || projection < min_projection) {
+            min_projection = projection;
+            min_index = i;
+        }
+        if (i == 0 || projection > max_projection) {
+            max_projection = projection;
+            max_index = i;
+        }
+    }
+
+    // The first endpoint must be the larger, which selects the 4-color mode.
+    u16 color0 = pack_565(texels + max_index * 4);
+    u16 color1 = pack_565(texels + min_index * 4);
+    if (color0 < color1) {
+        u16 swap = color0;
+        color0 = color1;
+        color1 = swap;
+    }
+
+    u32 indices = 0;
+    if (color0 != color1) {
+        i32 palette[4][3];
+        unpack_565(color0, palette[0]);
+        unpack_565(color1, palette[1]);
+        for (u32 c = 0; c < 3; ++c) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        for (u32 i = 0; i < KTEX_BLOCK_PIXELS; ++i) {
+            u32 best = 0;
+            i32 best_distance = 0;
+            for (u32 p = 0; p < 4; ++p) {
+                i32 dr = texels[i * 4 + 0] - palette[p][0];
+                i32 dg = texels[i * 4 + 1] - palette[p][1];
+                i32 db = texels[i * 4 + 2] - palette[p][2];
+                i32 distance = dr * dr + dg * dg + db * db;
+                if (p == 0 || distance < best_distance) {
+                    best = p;
+                    best_distance = distance;
+                }
+            }
+            indices |= best << (i * 2);
+        }
+    }
+
+    out_block[0] = (u8)(color0 & 0xFF);
+    out_block[1] = (u8)(color0 >> 8);
+    out_block[2] = (u8)(color1 & 0xFF);
+    out_block[3] = (u8)(color1 >> 8);
+    for (u32 i = 0; i < 4; ++i) {
+        out_block[4 + i] = (u8)(indices >> (i * 8));
+    }
+}
+
+/** @brief Builds the 8-entry alpha palette of a BC3 block from its endpoints. */
+static void alpha_palette(u8 alpha0, u8 alpha1, i32* out_palette) {
+    out_palette[0] = alpha0;
+    out_palette[1] = alpha1;
+    if (alpha0 > alpha1) {
+        for (i32 i = 1; i < 7; ++i) {
+            out_palette[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7;
+        }
+    } else {
+        for (i32 i = 1; i < 5; ++i) {
+            out_palette[i + 1] = ((5 - i) * alpha0 + i * alpha1) / 5;
+        }
+        out_palette[6] = 0;
+        out_palette[7] = 255;
+    }
+}
+
+/**
+ * @brief Encodes the alpha of a tile as a BC3 alpha block, using the 8-value mode between the
+ * tile's smallest and largest alpha.
+ */
+static void encode_alpha_block(const u8* texels, u8* out_block) {
+    u8 alpha_min = 255;
+    u8 alpha_max = 0;
+    for (u32 i = 0; i < KTEX_BLOCK_PIXELS; ++i) {
+        u8 alpha = texels[i * 4 + 3];
+        alpha_min = KMIN(alpha_min, alpha);
+        alpha_max = KMAX(alpha_max, alpha);
+    }
+
+    u64 indices = 0;
+    if (alpha_max != alpha_min) {
+        i32 palette[8];
+        alpha_palette(alpha_max, alpha_min, palette);
+        for (u32 i = 0; i < KTEX_BLOCK_PIXELS; ++i) {
+            u64 best = 0;
+            i32 best_distance = 256;
+            for (u32 p = 0; p < 8; ++p) {
+                i32 distance = texels[i * 4 + 3] - palette[p];
+                distance = distance < 0 ? -distance : distance;
+                if (distance < best_distance) {
+                    best = p;
+                    best_distance = distance;
+                }
+            }
+            indices |= best << (i * 3);
+        }
+    }
+
+    out_block[0] = alpha_max;
+    out_block[1] = alpha_min;
+    for (u32 i = 0; i < 6; ++i) {
+        out_block[2 + i] = (u8)(indices >> (i * 8));
+    }
+}
+
+/**
+ * @brief Decodes a BC1 color block. BC3 color blocks always use the 4-color mode.
+ */
+static void decode_color_block(const u8* block, b8 four_color_only, u8* out_texels) {
+    u16 color0 = (u16)(block[0] | (block[1] << 8));
+    u16 color1 = (u16)(block[2] | (block[3] << 8));
+    u32 indices = (u32)block[4] | ((u32)block[5] << 8) | ((u32)block[6] << 16) | ((u32)block[7] << 24);
+
+    i32 palette[4][4];
+    unpack_565(color0, palette[0]);
+    unpack_565(color1, palette[1]);
+    palette[0][3] = 255;
+    palette[1][3] = 255;
+    palette[2][3] = 255;
+    palette[3][3] = 255;
+    if (color0 > color1 || four_color_only) {
+        for (u32 c = 0; c < 3; ++c) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+    } else {
+        // The 3-color mode, whose last entry is transparent black.
+        for (u32 c = 0; c < 3; ++c) {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+        palette[3][3] = 0;
+    }
+
+    for (u32 i = 0; i < KTEX_BLOCK_PIXELS; ++i) {
+        u32 index = (indices >> (i * 2)) & 3;
+        for (u32 c = 0; c < 4; ++c) {
+            out_texels[i * 4 + c] = (u8)palette[index][c];
+        }
+    }
+}
+
+/** @brief Decodes a BC3 alpha block into the alpha of a tile. */
+static void decode_alpha_block(const u8* block, u8* out_texels) {
+    i32 palette[8];
+    alpha_palette(block[0], block[1], palette);
+
+    u64 indices = 0;
+    for (u32 i = 0; i < 6; ++i) {
+        indices |= (u64)block[2 + i] << (i * 8);
+    }
+    for (u32 i = 0; i < KTEX_BLOCK_PIXELS; ++i) {
+        out_texels[i * 4 + 3] = (u8)palette[(indices >> (i * 3)) & 7];
+    }
+}
+
+void ktex_encode(texture_format format, const u8* pixels, u32 width, u32 height, u8* out_data) {
+    if (format == TEXTURE_FORMAT_RGBA8) {
+        kcopy_memory(out_data, pixels, ktex_level_size(format, width, height));
+        return;
+    }
+
+    u32 blocks_wide = (width + KTEX_BLOCK_DIMENSION - 1) / KTEX_BLOCK_DIMENSION;
+    u32 blocks_high = (height + KTEX_BLOCK_DIMENSION - 1) / KTEX_BLOCK_DIMENSION;
+    u8 texels[KTEX_BLOCK_PIXELS * 4];
+    u8* block = out_data;
+    for (u32 y = 0; y < blocks_high; ++y) {
+        for (u32 x = 0; x < blocks_wide; ++x) {
+            gather_block(pixels, width, height, x, y, texels);
+            if (format == TEXTURE_FORMAT_BC3) {
+                encode_alpha_block(texels, block);
+                block += 8;
+            }
+            encode_color_block(texels, block);
+            block += 8;
+        }
+    }
+}
+
+void ktex_decode(texture_format format, const u8* data, u32 width, u32 height, u8* out_pixels) {
+    if (format == TEXTURE_FORMAT_RGBA8) {
+        kcopy_memory(out_pixels, data, ktex_level_size(format, width, height));
+        return;
+    }
+
+    u32 blocks_wide = (width + KTEX_BLOCK_DIMENSION - 1) / KTEX_BLOCK_DIMENSION;
+    u32 blocks_high = (height + KTEX_BLOCK_DIMENSION - 1) / KTEX_BLOCK_DIMENSION;
+    u8 texels[KTEX_BLOCK_PIXELS * 4];
+    const u8* block = data;
+    for (u32 y = 0; y < blocks_high; ++y) {
+        for (u32 x = 0; x < blocks_wide; ++x) {
+            if (format == TEXTURE_FORMAT_BC3) {
+                decode_color_block(block + 8, True, texels);
+                decode_alpha_block(block, texels);
+                block += 16;
+            } else {
+                decode_color_block(block, False, texels);
+                block += 8;
+            }
+            scatter_block(texels, width, height, x, y, out_pixels);
+        }
+    }
+}
+
+b8 ktex_cook(const u8* pixels, u32 width, u32 height, b8 compress, void** out_data, u64* out_size) {
+    if (!pixels || !width || !height || !out_data || !out_size) {
+        return False;
+    }
+
+    b8 transparent = ktex_has_transparency(pixels, (u64)width * height);
+    texture_format format = TEXTURE_FORMAT_RGBA8;
+    if (compress) {
+        format = transparent ? TEXTURE_FORMAT_BC3 : TEXTURE_FORMAT_BC1;
+    }
+    u32 mip_count = ktex_mip_count(width, height);
+    u64 data_size = ktex_data_size(format, width, height, mip_count);
+    u64 size = sizeof(ktex_header) + data_size;
+
+    u8* data = kallocate(size, MEMORY_TAG_ARRAY);
+    ktex_header* header = (ktex_header*)data;
+    header->magic = KTEX_MAGIC;
+    header->version = KTEX_VERSION;
+    header->format = format;
+    header->width = width;
+    header->height = height;
+    header->mip_count = mip_count;
+    header->flags = transparent ? KTEX_FLAG_TRANSPARENT : 0;
+    header->reserved = 0;
+    header->data_size = data_size;
+
+    // Each level is filtered from the one before, through two scratch images the size of level 1.
+    u64 scratch_size = ktex_level_size(TEXTURE_FORMAT_RGBA8, mip_dimension(width, 1), mip_dimension(height, 1));
+    u8* scratch[2];
+    scratch[0] = kallocate(scratch_size, MEMORY_TAG_ARRAY);
+    scratch[1] = kallocate(scratch_size, MEMORY_TAG_ARRAY);
+
+    const u8* level = pixels;
+    u32 level_width = width;
+    u32 level_height = height;
+    u8* out = data + sizeof(ktex_header);
+    for (u32 i = 0; i < mip_count; ++i) {
+        ktex_encode(format, level, level_width, level_height, out);
+        out += ktex_level_size(format, level_width, level_height);
+
+        if (i + 1 < mip_count) {
+            u8* next = level == scratch[0] ? scratch[1] : scratch[0];
+            ktex_downsample(level, level_width, level_height, next);
+            level = next;
+            level_width = mip_dimension(level_width, 1);
+            level_height = mip_dimension(level_height, 1);
+        }
+    }
+
+    kfree(scratch[0], scratch_size, MEMORY_TAG_ARRAY);
+    kfree(scratch[1], scratch_size, MEMORY_TAG_ARRAY);
+
+    *out_data = data;
+    *out_size = size;
+    return True;
+}
+
+b8 ktex_parse(const void* data, u64 size, image_resource_data* out_image) {
+    if (!data || !out_image || size < sizeof(ktex_header)) {
+        return False;
+    }
+
+    const ktex_header* header = data;
+    if (header->magic != KTEX_MAGIC || header->version != KTEX_VERSION || header->format >= TEXTURE_FORMAT_COUNT) {
+        return False;
+    }
+    if (!header->width || !header->height || !header->mip_count || header->mip_count > ktex_mip_count(header->width, header->height)) {
+        return False;
+    }
+    if (header->data_size != ktex_data_size(header->format, header->width, header->height, header->mip_count) ||
+        header->data_size > size - sizeof(ktex_header)) {
+        return False;
+    }
+
+    out_image->channel_count = 4;
+    out_image->width = header->width;
+    out_image->height = header->height;
+    out_image->pixels = (u8*)data + sizeof(ktex_header);
+    out_image->format = header->format;
+    out_image->mip_count = header->mip_count;
+    out_image->size = header->data_size;
+    out_image->has_transparency = (header->flags & KTEX_FLAG_TRANSPARENT) != 0;
+    return True;
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "defines.h"
+#include "resources/resource_types.h"
+
+/**
+ * @file ktex.h
+ *
+ * @brief The cooked texture container (.ktex).
+ *
+ * A ktex holds a texture in the form the GPU samples it: block-compressed, with its whole mip
+ * chain computed offline. Loading one is a validation and a copy into the staging ring; there is
+ * no decode, no mip generation and no scan for transparency at runtime.
+ *
+ * Layout, all little-endian:
+ * - A ktex_header.
+ * - data_size bytes of pixel data: each mip level, largest first, tightly packed. Compressed
+ *   levels are rows of 4x4 blocks, with partial blocks at the edges padded out.
+ *
+ * Opaque textures are cooked to BC1 (8 bytes per block, 4 bits per pixel), and textures with any
+ * alpha below 255 to BC3 (16 bytes per block, 8 bits per pixel), against 32 bits per pixel for
+ * RGBA8. Pixels are stored bottom row first, matching what the image loader hands out for PNGs.
+ *
+ * The encoder fits each block's endpoints along the principal axis of its colors. It is meant for
+ * offline use, and is not fast enough to run at load time.
+ */
+
+/** @brief The magic number at the start of every cooked texture, "KTEX" in file order. */
+#define KTEX_MAGIC 0x5845544BU
+
+/** @brief The version of the layout this engine reads and writes. */
+#define KTEX_VERSION 1
+
+/** @brief Set in a header's flags when any pixel is not fully opaque. */
+#define KTEX_FLAG_TRANSPARENT 0x1U
+
+/**
+ * @struct ktex_header
+ * @brief The header at the start of a cooked texture.
+ */
+typedef struct ktex_header {
+    /** KTEX_MAGIC. */
+    u32 magic;
+    /** KTEX_VERSION. */
+    u32 version;
+    /** The texture_format of the pixel data. */
+    u32 format;
+    /** The width of the largest mip level, in pixels. */
+    u32 width;
+    /** The height of the largest mip level, in pixels. */
+    u32 height;
+    /** The number of mip levels. */
+    u32 mip_count;
+    /** KTEX_FLAG_* bits. */
+    u32 flags;
+    /** Unused, and zero. */
+    u32 reserved;
+    /** The size of the pixel data following the header, across every mip level. */
+    u64 data_size;
+} ktex_header;
+
+/**
+ * @brief Gets the number of levels in a full mip chain, down to 1x1.
+ *
+ * @param width The width of the largest level.
+ * @param height The height of the largest level.
+ * @return The number of mip levels.
+ */
+KAPI u32 ktex_mip_count(u32 width, u32 height);
+
+/**
+ * @brief Gets the size of one level of a texture.
+ *
+ * @param format The format of the level.
+ * @param width The width of the level, in pixels.
+ * @param height The height of the level, in pixels.
+ * @return The size of the level in bytes.
+ */
+KAPI u64 ktex_level_size(texture_format format, u32 width, u32 height);
+
+/**
+ * @brief Gets the size of a mip chain, with its levels tightly packed.
+ *
+ * @param format The format of the levels.
+ * @param width The width of the largest level.
+ * @param height The height of the largest level.
+ * @param mip_count The number of levels.
+ * @return The size of every level together, in bytes.
+ */
+KAPI u64 ktex_data_size(texture_format format, u32 width, u32 height, u32 mip_count);
+
+/**
+ * @brief Checks whether any RGBA8 pixel is not fully opaque.
+ *
+ * @param pixels The RGBA8 pixels.
+ * @param pixel_count The number of pixels.
+ * @return True if any alpha is below 255.
+ */
+KAPI b8 ktex_has_transparency(const u8* pixels, u64 pixel_count);
+
+/**
+ * @brief Halves an RGBA8 image with a 2x2 box filter.
+ *
+ * Each dimension is halved and rounded down, but never below 1. An odd last row or column is
+ * left out of the filter.
+ *
+ * @param pixels The RGBA8 pixels of the source image.
+ * @param width The width of the source image.
+ * @param height The height of the source image.
+ * @param out_pixels A buffer to hold the halved image.
+ */
+KAPI void ktex_downsample(const u8* pixels, u32 width, u32 height, u8* out_pixels);
+
+/**
+ * @brief Builds the full mip chain of an RGBA8 image, each level filtered from the one before.
+ *
+ * @param pixels The RGBA8 pixels of the image.
+ * @param width The width of the image.
+ * @param height The height of the image.
+ * @param out_pixels A buffer of ktex_data_size(TEXTURE_FORMAT_RGBA8, width, height,
+ * ktex_mip_count(width, height)) bytes, to hold every level, largest first.
+ * @return True on success; otherwise False.
+ */
+KAPI b8 ktex_build_mip_chain(const u8* pixels, u32 width, u32 height, u8* out_pixels);
+
+/**
+ * @brief Encodes an RGBA8 image into a format.
+ *
+ * @param format The format to encode into. RGBA8 copies the pixels.
+ * @param pixels The RGBA8 pixels.
+ * @param width The width of the image.
+ * @param height The height of the image.
+ * @param out_data A buffer of ktex_level_size() bytes to hold the encoded image.
+ */
+KAPI void ktex_encode(texture_format format, const u8* pixels, u32 width, u32 height, u8* out_data);
+
+/**
+ * @brief Decodes an image in a format back into RGBA8.
+ *
+ * Used where the device cannot sample a format itself.
+ *
+ * @param format The format of the data. RGBA8 copies the pixels.
+ * @param data The encoded image.
+ * @param width The width of the image.
+ * @param height The height of the image.
+ * @param out_pixels A buffer of width * height * 4 bytes to hold the decoded pixels.
+ */
+KAPI void ktex_decode(texture_format format, const u8* data, u32 width, u32 height, u8* out_pixels);
+
+/**
+ * @brief Cooks an RGBA8 image into a ktex, with a full mip chain.
+ *
+ * @param pixels The RGBA8 pixels of the image.
+ * @param width The width of the image.
+ * @param height The height of the image.
+ * @param compress True to block-compress the levels; otherwise they are kept as RGBA8.
+ * @param out_data A pointer to hold the cooked texture. Free it with kfree() using
+ * MEMORY_TAG_ARRAY and the size written to out_size.
+ * @param out_size A pointer to hold the size of the cooked texture.
+ * @return True on success; otherwise False.
+ */
+KAPI b8 ktex_cook(const u8* pixels, u32 width, u32 height, b8 compress, void** out_data, u64* out_size);
+
+/**
+ * @brief Validates a ktex in memory and describes it as an image.
+ *
+ * The image's pixels point into the data, which must outlive it.
+ *
+ * @param data The cooked texture.
+ * @param size The size of the cooked texture.
+ * @param out_image A pointer to hold the description of the image.
+ * @return True if the data is a valid ktex; otherwise False.
+ */
+KAPI b8 ktex_parse(const void* data, u64 size, image_resource_data* out_image);
@@ -3,8 +3,12 @@
 #include "core/logger.h"
 #include "core/kmemory.h"
 #include "core/kstring.h"
+#include "resources/ktex.h"
 #include "resources/resource_types.h"
 #include "systems/resource_system.h"
+#include "memory/pool_allocator.h"
+#include "core/kmutex.h"
+#include "platform/filesystem.h"
 
 // TODO: resource loader.
 #define STB_IMAGE_IMPLEMENTATION
@@ -15,8 +19,92 @@
  * @brief Implementation of the image resource loader.
  */
 
+/** @brief The number of image_loader_data blocks the pool grows by at a time. */
+#define IMAGE_DATA_POOL_BLOCKS_PER_CHUNK 64
+
+/**
+ * @struct image_loader_data
+ * @brief The resource data the loader hands out, with what it needs to free the pixels.
+ */
+typedef struct image_loader_data {
+    /** The image. Must be first, as the resource's data points here. */
+    image_resource_data image;
+    /**
+     * The memory the pixels live in: a cooked texture, in the archive or read from a loose file,
+     * or the mip chain built from a decoded PNG.
+     */
+    kpak_data storage;
+} image_loader_data;
+
+/** @brief Pool the fixed-size image_loader_data blocks are allocated from. */
+static pool_allocator image_data_pool;
+
+/** @brief Guards the pool, as loads may run on several worker threads at once. */
+static kmutex image_data_pool_mutex;
+
+/**
+ * @brief Reads a whole loose file into a new buffer.
+ * @param path The path of the file.
+ * @param out_data A pointer to hold the contents, which the caller owns.
+ * @return True if the file was read; otherwise False.
+ */
+static b8 read_loose_file(const char* path, kpak_data* out_data) {
+    file_handle f;
+    if (!filesystem_open(path, FILE_MODE_READ, True, &f)) {
+        return False;
+    }
+
+    u64 size = 0;
+    if (!filesystem_size(&f, &size) || !size) {
+        filesystem_close(&f);
+        return False;
+    }
+
+    u8* data = kallocate(size, MEMORY_TAG_ARRAY);
+    u64 read = 0;
+    b8 result = filesystem_read_all_bytes(&f, data, &read) && read == size;
+    filesystem_close(&f);
+    if (!result) {
+        kfree(data, size, MEMORY_TAG_ARRAY);
+        return False;
+    }
+
+    out_data->data = data;
+    out_data->size = size;
+    out_data->owned = True;
+    return True;
+}
+
+/**
+ * @brief Finds and validates a cooked texture, from the archive or a loose file.
+ * @param self The resource loader.
+ * @param name The name of the image.
+ * @param full_file_path The path of the loose cooked texture.
+ * @param out_cooked A pointer to hold the cooked texture.
+ * @param out_image A pointer to hold the description of the image.
+ * @return True if a valid cooked texture was found; otherwise False.
+ */
+static b8 load_cooked(struct resource_loader* self, const char* name, const char* full_file_path, kpak_data* out_cooked, image_resource_data* out_image) {
+    if (!resource_system_read_packed(self, name, ".ktex", out_cooked)) {
+        if (!filesystem_exists(full_file_path) || !read_loose_file(full_file_path, out_cooked)) {
+            return False;
+        }
+    }
+
+    if (!ktex_parse(out_cooked->data, out_cooked->size, out_image)) {
+        KWARN("Image resource loader found an invalid cooked texture '%s'. Falling back to the source image.", full_file_path);
+        kpak_data_release(out_cooked);
+        return False;
+    }
+    return True;
+}
+
 /**
  * @brief Loads an image resource.
+ *
+ * A cooked texture (.ktex) is preferred, as it is handed to the renderer as-is. Otherwise the
+ * source PNG is decoded to RGBA8, and its mip chain is built here, on the loading thread.
+ *
  * @param self The resource loader.
  * @param name The name of the resource to load.
  * @param out_resource The resource to load.
@@ -28,55 +116,99 @@ b8 image_loader_load(struct resource_loader* self, const char* name, resource* o
     }
 
     char* format_str = "%s/%s/%s%s";
-    const i32 required_channel_count = 4;
-    stbi_set_flip_vertically_on_load(True);
     char full_file_path[512];
 
-    // TODO: try different extensions
-    string_format(full_file_path, format_str, resource_system_base_path(), self->type_path, name, ".png");
-
-    i32 width;
-    i32 height;
-    i32 channel_count;
-
-    // For now, assume 8 bits per channel, 4 channels.
-    // TODO: extend this to make it configurable.
-    u8* data = stbi_load(
-        full_file_path,
-        &width,
-        &height,
-        &channel_count,
-        required_channel_count);
-
-    // Check for a failure reason. If there is one, abort, clear memory if allocated, return false.
-    const char* fail_reason = stbi_failure_reason();
-    if (fail_reason) {
-        KERROR("Image resource loader failed to load file '%s': %s", full_file_path, fail_reason);
-        // Clear the error so the next load doesn't fail.
-        stbi__err(0, 0);
-
-        if (data) {
-            stbi_image_free(data);
+    image_loader_data loaded;
+    kzero_memory(&loaded, sizeof(image_loader_data));
+
+    string_format(full_file_path, format_str, resource_system_base_path(), self->type_path, name, ".ktex");
+    if (!load_cooked(self, name, full_file_path, &loaded.storage, &loaded.image)) {
+        const i32 required_channel_count = 4;
+        stbi_set_flip_vertically_on_load(True);
+
+        // TODO: try different extensions
+        string_format(full_file_path, format_str, resource_system_base_path(), self->type_path, name, ".png");
+
+        i32 width;
+        i32 height;
+        i32 channel_count;
+
+        // For now, assume 8 bits per channel, 4 channels.
+        // TODO: extend this to make it configurable.
+        u8* data = 0;
+        kpak_data packed;
+        if (resource_system_read_packed(self, name, ".png", &packed)) {
+            // Decode straight out of the archive, without opening the file.
+            data = stbi_load_from_memory(
+                packed.data,
+                (i32)packed.size,
+                &width,
+                &height,
+                &channel_count,
+                required_channel_count);
+            kpak_data_release(&packed);
+        } else {
+            data = stbi_load(
+                full_file_path,
+                &width,
+                &height,
+                &channel_count,
+                required_channel_count);
         }
-        return False;
-    }
 
-    if (!data) {
-        KERROR("Image resource loader failed to load file '%s'.", full_file_path);
-        return False;
+        // Check for a failure reason. If there is one, abort, clear memory if allocated, return false.
+        const char* fail_reason = stbi_failure_reason();
+        if (fail_reason) {
+            KERROR("Image resource loader failed to load file '%s': %s", full_file_path, fail_reason);
+            // Clear the error so the next load doesn't fail.
+            stbi__err(0, 0);
+
+            if (data) {
+                stbi_image_free(data);
+            }
+            return False;
+        }
+
+        if (!data) {
+            KERROR("Image resource loader failed to load file '%s'.", full_file_path);
+            return False;
+        }
+
+        // Done here, so the scan and the filtering run on the loading thread rather than the main one.
+        u32 mip_count = ktex_mip_count(width, height);
+        u64 chain_size = ktex_data_size(TEXTURE_FORMAT_RGBA8, width, height, mip_count);
+        u8* chain = kallocate(chain_size, MEMORY_TAG_ARRAY);
+        ktex_build_mip_chain(data, width, height, chain);
+        loaded.image.has_transparency = ktex_has_transparency(data, (u64)width * height);
+        stbi_image_free(data);
+
+        loaded.storage.data = chain;
+        loaded.storage.size = chain_size;
+        loaded.storage.owned = True;
+
+        loaded.image.pixels = chain;
+        loaded.image.width = width;
+        loaded.image.height = height;
+        loaded.image.channel_count = required_channel_count;
+        loaded.image.format = TEXTURE_FORMAT_RGBA8;
+        loaded.image.mip_count = mip_count;
+        loaded.image.size = chain_size;
     }
 
     // TODO: Should be using an allocator here.
     out_resource->full_path = string_duplicate(full_file_path);
 
-    // TODO: Should be using an allocator here.
-    image_resource_data* resource_data = kallocate(sizeof(image_resource_data), MEMORY_TAG_TEXTURE);
-    resource_data->pixels = data;
-    resource_data->width = width;
-    resource_data->height = height;
-    resource_data->channel_count = required_channel_count;
+    kmutex_lock(&image_data_pool_mutex);
+    image_loader_data* resource_data = pool_allocator_allocate(&image_data_pool);
+    kmutex_unlock(&image_data_pool_mutex);
+    if (!resource_data) {
+        KERROR("Image resource loader failed to allocate resource data for '%s'.", full_file_path);
+        kpak_data_release(&loaded.storage);
+        return False;
+    }
+    *resource_data = loaded;
 
-    out_resource->data = resource_data;
+    out_resource->data = &resource_data->image;
     out_resource->data_size = sizeof(image_resource_data);
     out_resource->name = name;
 
@@ -100,23 +232,52 @@ void image_loader_unload(struct resource_loader* self, resource* resource) {
     }
 
     if (resource->data) {
-        image_resource_data* resource_data = (image_resource_data*)resource->data;
-        if (resource_data->pixels) {
-            stbi_image_free(resource_data->pixels);
-        }
-        kfree(resource->data, resource->data_size, MEMORY_TAG_TEXTURE);
+        image_loader_data* resource_data = (image_loader_data*)resource->data;
+        kpak_data_release(&resource_data->storage);
+        kmutex_lock(&image_data_pool_mutex);
+        pool_allocator_free(&image_data_pool, resource->data);
+        kmutex_unlock(&image_data_pool_mutex);
         resource->data = 0;
         resource->data_size = 0;
         resource->loader_id = INVALID_ID;
     }
 }
 
+/**
+ * @brief Initializes the image loader, creating its resource data pool.
+ * @param self The resource loader.
+ * @return True on success; otherwise False.
+ */
+b8 image_loader_initialize(struct resource_loader* self) {
+    if (!pool_allocator_create(sizeof(image_loader_data), IMAGE_DATA_POOL_BLOCKS_PER_CHUNK, 0, MEMORY_TAG_TEXTURE, &image_data_pool)) {
+        KERROR("image_loader_initialize - Failed to create the resource data pool.");
+        return False;
+    }
+    if (!kmutex_create(&image_data_pool_mutex)) {
+        KERROR("image_loader_initialize - Failed to create the resource data pool mutex.");
+        pool_allocator_destroy(&image_data_pool);
+        return False;
+    }
+    return True;
+}
+
+/**
+ * @brief Shuts down the image loader, releasing its resource data pool.
+ * @param self The resource loader.
+ */
+void image_loader_shutdown(struct resource_loader* self) {
+    pool_allocator_destroy(&image_data_pool);
+    kmutex_destroy(&image_data_pool_mutex);
+}
+
 resource_loader image_resource_loader_create() {
     resource_loader loader;
     loader.type = RESOURCE_TYPE_IMAGE;
     loader.custom_type = 0;
     loader.load = image_loader_load;
     loader.unload = image_loader_unload;
+    loader.initialize = image_loader_initialize;
+    loader.shutdown = image_loader_shutdown;
     loader.type_path = "textures";
 
     return loader;
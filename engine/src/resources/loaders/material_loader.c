@@ -6,6 +6,8 @@
 #include "resources/resource_types.h"
 #include "systems/resource_system.h"
 #include "math/kmath.h"
+#include "memory/pool_allocator.h"
+#include "core/kmutex.h"
 
 #include "platform/filesystem.h"
 
@@ -14,6 +16,78 @@
  * @brief Implements the material resource loader.
  */
 
+/** @brief The number of material_config blocks the pool grows by at a time. */
+#define MATERIAL_CONFIG_POOL_BLOCKS_PER_CHUNK 32
+
+/** @brief Pool the fixed-size material_config blocks are allocated from. */
+static pool_allocator material_config_pool;
+
+/** @brief Guards the pool, as loads may run on several worker threads at once. */
+static kmutex material_config_pool_mutex;
+
+/** @brief The longest line read from a material file, including the terminator. */
+#define MATERIAL_LINE_MAX_LENGTH 512
+
+/**
+ * @brief Parses one line of a material file into a material config.
+ * @param resource_data The config to fill out.
+ * @param line_buf The line, which is trimmed in place.
+ * @param full_file_path The path of the file, for logging.
+ * @param line_number The number of the line, for logging.
+ */
+static void material_loader_parse_line(material_config* resource_data, char* line_buf, const char* full_file_path, u32 line_number) {
+    // Trim the string.
+    char* trimmed = string_trim(line_buf);
+
+    // Get the trimmed length.
+    u64 line_length = string_length(trimmed);
+
+    // Skip blank lines and comments.
+    if (line_length < 1 || trimmed[0] == '#') {
+        return;
+    }
+
+    // Split into var/value
+    i32 equal_index = string_index_of(trimmed, '=');
+    if (equal_index == -1) {
+        KWARN("Potential formatting issue found in file '%s': '=' token not found. Skipping line %ui.", full_file_path, line_number);
+        return;
+    }
+
+    // Assume a max of 64 characters for the variable name.
+    char raw_var_name[64];
+
+    kzero_memory(raw_var_name, sizeof(char) * 64);
+    string_mid(raw_var_name, trimmed, 0, equal_index);
+
+    char* trimmed_var_name = string_trim(raw_var_name);
+
+    // Assume a max of 511-65 (446) for the max length of the value to account for the variable name and the '='.
+    char raw_value[446];
+
+    kzero_memory(raw_value, sizeof(char) * 446);
+    string_mid(raw_value, trimmed, equal_index + 1, -1);  // Read the rest of the line
+
+    char* trimmed_value = string_trim(raw_value);
+
+    // Process the variable.
+    if (strings_equali(trimmed_var_name, "version")) {
+        // TODO: version
+    } else if (strings_equali(trimmed_var_name, "name")) {
+        string_ncopy(resource_data->name, trimmed_value, MATERIAL_NAME_MAX_LENGTH);
+    } else if (strings_equali(trimmed_var_name, "diffuse_map_name")) {
+        string_ncopy(resource_data->diffuse_map_name, trimmed_value, TEXTURE_NAME_MAX_LENGTH);
+    } else if (strings_equali(trimmed_var_name, "diffuse_color")) {
+        // Parse the color
+        if (!string_to_vec4(trimmed_value, &resource_data->diffuse_color)) {
+            KWARN("Error parsing diffuse_color in file '%s'. Using default of white instead.", full_file_path);
+            // NOTE: already assigned above, no need to have it here.
+        }
+    }
+
+    // TODO: more fields.
+}
+
 /**
  * @brief Loads a material resource.
  * @param self The resource loader.
@@ -30,17 +104,34 @@ b8 material_loader_load(struct resource_loader* self, const char* name, resource
     char full_file_path[512];
     string_format(full_file_path, format_str, resource_system_base_path(), self->type_path, name, ".kmt");
 
-    // TODO: Should be using an allocator here.
-    out_resource->full_path = string_duplicate(full_file_path);
+    // Prefer the archive, falling back to the loose file.
+    kpak_data packed;
+    b8 is_packed = resource_system_read_packed(self, name, ".kmt", &packed);
 
     file_handle f;
-    if (!filesystem_open(full_file_path, FILE_MODE_READ, False, &f)) {
+    if (!is_packed && !filesystem_open(full_file_path, FILE_MODE_READ, False, &f)) {
         KERROR("material_loader_load - unable to open material file for reading: '%s'.", full_file_path);
         return False;
     }
 
+    kmutex_lock(&material_config_pool_mutex);
+    material_config* resource_data = pool_allocator_allocate(&material_config_pool);
+    kmutex_unlock(&material_config_pool_mutex);
+    if (!resource_data) {
+        KERROR("material_loader_load - unable to allocate material config for '%s'.", full_file_path);
+        if (is_packed) {
+            kpak_data_release(&packed);
+        } else {
+            filesystem_close(&f);
+        }
+        return False;
+    }
+
     // TODO: Should be using an allocator here.
-    material_config* resource_data = kallocate(sizeof(material_config), MEMORY_TAG_MATERIAL_INSTANCE);
+    out_resource->full_path = string_duplicate(full_file_path);
+
+    // Pool blocks are not zeroed.
+    kzero_memory(resource_data, sizeof(material_config));
     // Set some defaults.
     resource_data->auto_release = True;
     resource_data->diffuse_color = vec4_one();  // white.
@@ -49,73 +140,47 @@ b8 material_loader_load(struct resource_loader* self, const char* name, resource
     string_ncopy(resource_data->name, name, MATERIAL_NAME_MAX_LENGTH);
 
     // Read each line of the file.
-    char line_buf[512] = "";
-    char* p = &line_buf[0];
-
-    u64 line_length = 0;
+    char line_buf[MATERIAL_LINE_MAX_LENGTH] = "";
     u32 line_number = 1;
 
-    while (filesystem_read_line(&f, 511, &p, &line_length)) {
-        // Trim the string.
-        char* trimmed = string_trim(line_buf);
-
-        // Get the trimmed length.
-        line_length = string_length(trimmed);
+    if (is_packed) {
+        // Walk the lines in the archive, copying each out so it can be trimmed and split.
+        const char* cursor = packed.data;
+        const char* end = cursor + packed.size;
+        while (cursor < end) {
+            const char* line_end = cursor;
+            while (line_end < end && *line_end != '\n') {
+                line_end++;
+            }
 
-        // Skip blank lines and comments.
-        if (line_length < 1 || trimmed[0] == '#') {
-            line_number++;
-            continue;
-        }
+            u64 line_length = (u64)(line_end - cursor);
+            if (line_length > MATERIAL_LINE_MAX_LENGTH - 1) {
+                line_length = MATERIAL_LINE_MAX_LENGTH - 1;
+            }
+            kcopy_memory(line_buf, cursor, line_length);
+            line_buf[line_length] = 0;
 
-        // Split into var/value
-        i32 equal_index = string_index_of(trimmed, '=');
-        if (equal_index == -1) {
-            KWARN("Potential formatting issue found in file '%s': '=' token not found. Skipping line %ui.", full_file_path, line_number);
+            material_loader_parse_line(resource_data, line_buf, full_file_path, line_number);
             line_number++;
-            continue;
+            cursor = line_end + 1;
         }
 
-        // Assume a max of 64 characters for the variable name.
-        char raw_var_name[64];
+        kpak_data_release(&packed);
+    } else {
+        char* p = &line_buf[0];
+        u64 line_length = 0;
 
-        kzero_memory(raw_var_name, sizeof(char) * 64);
-        string_mid(raw_var_name, trimmed, 0, equal_index);
+        while (filesystem_read_line(&f, MATERIAL_LINE_MAX_LENGTH - 1, &p, &line_length)) {
+            material_loader_parse_line(resource_data, line_buf, full_file_path, line_number);
 
-        char* trimmed_var_name = string_trim(raw_var_name);
-
-        // Assume a max of 511-65 (446) for the max length of the value to account for the variable name and the '='.
-        char raw_value[446];
-
-        kzero_memory(raw_value, sizeof(char) * 446);
-        string_mid(raw_value, trimmed, equal_index + 1, -1);  // Read the rest of the line
-
-        char* trimmed_value = string_trim(raw_value);
-
-        // Process the variable.
-        if (strings_equali(trimmed_var_name, "version")) {
-            // TODO: version
-        } else if (strings_equali(trimmed_var_name, "name")) {
-            string_ncopy(resource_data->name, trimmed_value, MATERIAL_NAME_MAX_LENGTH);
-        } else if (strings_equali(trimmed_var_name, "diffuse_map_name")) {
-            string_ncopy(resource_data->diffuse_map_name, trimmed_value, TEXTURE_NAME_MAX_LENGTH);
-        } else if (strings_equali(trimmed_var_name, "diffuse_color")) {
-            // Parse the color
-            if (!string_to_vec4(trimmed_value, &resource_data->diffuse_color)) {
-                KWARN("Error parsing diffuse_color in file '%s'. Using default of white instead.", full_file_path);
-                // NOTE: already assigned above, no need to have it here.
-            }
+            // Clear the line buffer.
+            kzero_memory(line_buf, sizeof(char) * MATERIAL_LINE_MAX_LENGTH);
+            line_number++;
         }
 
-        // TODO: more fields.
-
-        // Clear the line buffer.
-        kzero_memory(line_buf, sizeof(char) * 512);
-        line_number++;
+        filesystem_close(&f);
     }
 
-    filesystem_close(&f);
-
     out_resource->data = resource_data;
     out_resource->data_size = sizeof(material_config);
     out_resource->name = name;
@@ -140,19 +205,50 @@ void material_loader_unload(struct resource_loader* self, resource* resource) {
     }
 
     if (resource->data) {
-        kfree(resource->data, resource->data_size, MEMORY_TAG_MATERIAL_INSTANCE);
+        kmutex_lock(&material_config_pool_mutex);
+        pool_allocator_free(&material_config_pool, resource->data);
+        kmutex_unlock(&material_config_pool_mutex);
         resource->data = 0;
         resource->data_size = 0;
         resource->loader_id = INVALID_ID;
     }
 }
 
+/**
+ * @brief Initializes the material loader, creating its config pool.
+ * @param self The resource loader.
+ * @return True on success; otherwise False.
+ */
+b8 material_loader_initialize(struct resource_loader* self) {
+    if (!pool_allocator_create(sizeof(material_config), MATERIAL_CONFIG_POOL_BLOCKS_PER_CHUNK, 0, MEMORY_TAG_MATERIAL_INSTANCE, &material_config_pool)) {
+        KERROR("material_loader_initialize - Failed to create the config pool.");
+        return False;
+    }
+    if (!kmutex_create(&material_config_pool_mutex)) {
+        KERROR("material_loader_initialize - Failed to create the config pool mutex.");
+        pool_allocator_destroy(&material_config_pool);
+        return False;
+    }
+    return True;
+}
+
+/**
+ * @brief Shuts down the material loader, releasing its config pool.
+ * @param self The resource loader.
+ */
+void material_loader_shutdown(struct resource_loader* self) {
+    pool_allocator_destroy(&material_config_pool);
+    kmutex_destroy(&material_config_pool_mutex);
+}
+
 resource_loader material_resource_loader_create() {
     resource_loader loader;
     loader.type = RESOURCE_TYPE_MATERIAL;
     loader.custom_type = 0;
     loader.load = material_loader_load;
     loader.unload = material_loader_unload;
+    loader.initialize = material_loader_initialize;
+    loader.shutdown = material_loader_shutdown;
     loader.type_path = "materials";
 
     return loader;
@@ -35,6 +35,16 @@ b8 text_loader_load(struct resource_loader* self, const char* name, resource* ou
     // TODO: Should be using an allocator here.
     out_resource->full_path = string_duplicate(full_file_path);
 
+    // Files stored in the archive are used in place. Compressed ones come back in a buffer of
+    // the same kind a loose file is read into.
+    kpak_data packed;
+    if (resource_system_read_packed(self, name, "", &packed)) {
+        out_resource->data = (void*)packed.data;
+        out_resource->data_size = packed.size;
+        out_resource->name = name;
+        return True;
+    }
+
     file_handle f;
     if (!filesystem_open(full_file_path, FILE_MODE_READ, False, &f)) {
         KERROR("text_loader_load - unable to open file for text reading: '%s'.", full_file_path);
@@ -84,7 +94,10 @@ void text_loader_unload(struct resource_loader* self, resource* resource) {
     }
 
     if (resource->data) {
-        kfree(resource->data, resource->data_size, MEMORY_TAG_ARRAY);
+        // Data used in place belongs to the archive.
+        if (!resource_system_is_packed(resource->data)) {
+            kfree(resource->data, resource->data_size, MEMORY_TAG_ARRAY);
+        }
         resource->data = 0;
         resource->data_size = 0;
         resource->loader_id = INVALID_ID;
@@ -97,6 +110,8 @@ resource_loader text_resource_loader_create() {
     loader.custom_type = 0;
     loader.load = text_loader_load;
     loader.unload = text_loader_unload;
+    loader.initialize = 0;
+    loader.shutdown = 0;
     loader.type_path = "";
 
     return loader;
@@ -20,6 +20,21 @@
 /** Maximum length for geometry names. */
 #define GEOMETRY_NAME_MAX_LENGTH 256
 
+/**
+ * @enum texture_format
+ * @brief The layouts texture pixels may be stored in.
+ */
+typedef enum texture_format {
+    /** 8 bits each of red, green, blue and alpha per pixel. */
+    TEXTURE_FORMAT_RGBA8 = 0,
+    /** BC1 blocks: 4x4 opaque pixels in 8 bytes. */
+    TEXTURE_FORMAT_BC1 = 1,
+    /** BC3 blocks: 4x4 pixels with alpha in 16 bytes. */
+    TEXTURE_FORMAT_BC3 = 2,
+    /** The number of formats. Not a format. */
+    TEXTURE_FORMAT_COUNT
+} texture_format;
+
 /**
  * @struct texture
  * @brief Represents a texture resource.
@@ -38,6 +53,12 @@ typedef struct texture {
     u8 channel_count;
     /** Indicates if the texture has an alpha channel for transparency. */
     b8 has_transparency;
+    /** The format the texture's pixels are stored in on the GPU. */
+    texture_format format;
+    /** The number of mip levels of the texture. */
+    u32 mip_count;
+    /** The renderer frame the texture was last bound for drawing in. */
+    u64 last_used_frame;
     /** Internal data pointer for backend-specific texture representation. */
     u32 generation;
     /** Name of the texture allocated for identification purposes. */
@@ -112,7 +133,8 @@ typedef struct material_config {
  * @struct geometry
  * @brief Represents a geometry (mesh) resource.
  *
- * Contains identifiers and references to materials used for rendering the geometry.
+ * Contains identifiers and references to materials used for rendering the geometry,
+ * and the bounds of its vertices used to cull it.
  */
 typedef struct geometry {
     /** Unique identifier for the geometry resource. */
@@ -125,6 +147,12 @@ typedef struct geometry {
     char name[GEOMETRY_NAME_MAX_LENGTH];
     /** Pointer to the associated material for rendering this geometry. */
     material* material;
+    /** Axis-aligned bounds of the vertices, in model space. */
+    extents_3d extents;
+    /** Centre of the bounding sphere of the vertices, in model space. */
+    vec3 center;
+    /** Radius of the bounding sphere of the vertices, in model space. */
+    f32 radius;
 } geometry;
 
 /**
@@ -182,6 +210,14 @@ typedef struct image_resource_data {
     u32 width;
     /** Height of the image in pixels. */
     u32 height;
-    /** Pointer to the raw pixel data of the image. */
+    /** Pointer to the pixel data of the image: every mip level, largest first, tightly packed. */
     u8* pixels;
+    /** The format of the pixel data. */
+    texture_format format;
+    /** The number of mip levels in the pixel data. */
+    u32 mip_count;
+    /** The size of the pixel data in bytes, across every mip level. */
+    u64 size;
+    /** Whether any pixel is not fully opaque. */
+    b8 has_transparency;
 } image_resource_data;
\ No newline at end of file
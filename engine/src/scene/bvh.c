@@ -0,0 +1,513 @@
+#include "bvh.h"
+
+#include "core/kmemory.h"
+#include "core/logger.h"
+#include "math/kmath.h"
+
+/**
+ * @file bvh.c
+ * @brief Implementation of the bounding volume hierarchy.
+ *
+ * The SAH cost of a tree is the expected cost of a query, relative to testing the root: the
+ * surface area of each internal node (the chance of visiting it) plus that of each leaf times
+ * its proxy count, over the surface area of the root. Splits are chosen to minimize it.
+ */
+
+/** @brief Ranges of at most this many proxies always become leaves. */
+#define BVH_LEAF_SIZE 4
+
+/** @brief Ranges of more than this many proxies are always split, even when SAH says not to. */
+#define BVH_MAX_LEAF_SIZE 16
+
+/** @brief The number of buckets proxies are sorted into along the split axis. */
+#define BVH_BIN_COUNT 16
+
+/** @brief The cost of visiting a node, relative to testing a proxy. */
+#define BVH_TRAVERSAL_COST 1.0f
+
+/**
+ * @brief Below this depth, ranges are split in half rather than by SAH, so the depth stays
+ * within BVH_STACK_SIZE whatever the boxes.
+ */
+#define BVH_MAX_SAH_DEPTH 64
+
+/** @brief The number of nodes a query can have pending. Covers any tree the build makes. */
+#define BVH_STACK_SIZE 128
+
+/** @brief Refits that raise the SAH cost by more than this factor since the build trigger a rebuild. */
+#define BVH_REBUILD_COST_RATIO 1.5f
+
+/** @brief Bit mask with one bit for each frustum plane. */
+#define BVH_ALL_PLANES 0x3F
+
+/** @brief An empty box, which any union replaces. */
+static extents_3d extents_empty() {
+    extents_3d e;
+    e.min = vec3_create(K_INFINITY, K_INFINITY, K_INFINITY);
+    e.max = vec3_create(-K_INFINITY, -K_INFINITY, -K_INFINITY);
+    return e;
+}
+
+static void extents_add_box(extents_3d* e, vec3 min, vec3 max) {
+    e->min = vec3_create(KMIN(e->min.x, min.x), KMIN(e->min.y, min.y), KMIN(e->min.z, min.z));
+    e->max = vec3_create(KMAX(e->max.x, max.x), KMAX(e->max.y, max.y), KMAX(e->max.z, max.z));
+}
+
+/** @brief The surface area of a box, or 0 if it is empty. */
+static f32 extents_area(extents_3d e) {
+    vec3 d = vec3_sub(e.max, e.min);
+    if (d.x < 0.0f || d.y < 0.0f || d.z < 0.0f) {
+        return 0.0f;
+    }
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+b8 bvh_create(u32 capacity, bvh* out_bvh) {
+    if (capacity == 0 || !out_bvh) {
+        KERROR("bvh_create requires a capacity above 0 and a valid pointer to hold the hierarchy.");
+        return False;
+    }
+
+    kzero_memory(out_bvh, sizeof(bvh));
+    out_bvh->capacity = capacity;
+    out_bvh->proxy_bounds = kallocate(sizeof(extents_3d) * capacity, MEMORY_TAG_SCENE);
+    out_bvh->proxy_user_data = kallocate(sizeof(u32) * capacity, MEMORY_TAG_SCENE);
+    out_bvh->proxy_active = kallocate(sizeof(b8) * capacity, MEMORY_TAG_SCENE);
+    out_bvh->free_proxies = kallocate(sizeof(u32) * capacity, MEMORY_TAG_SCENE);
+    out_bvh->order = kallocate(sizeof(u32) * capacity, MEMORY_TAG_SCENE);
+    out_bvh->centers = kallocate(sizeof(vec3) * capacity, MEMORY_TAG_SCENE);
+    // A binary tree with a proxy in every leaf has fewer than twice as many nodes as proxies.
+    out_bvh->nodes = kallocate(sizeof(bvh_node) * capacity * 2, MEMORY_TAG_ENTITY_NODE);
+    kzero_memory(out_bvh->proxy_active, sizeof(b8) * capacity);
+    return True;
+}
+
+void bvh_destroy(bvh* tree) {
+    if (!tree || !tree->nodes) {
+        return;
+    }
+
+    u32 capacity = tree->capacity;
+    kfree(tree->proxy_bounds, sizeof(extents_3d) * capacity, MEMORY_TAG_SCENE);
+    kfree(tree->proxy_user_data, sizeof(u32) * capacity, MEMORY_TAG_SCENE);
+    kfree(tree->proxy_active, sizeof(b8) * capacity, MEMORY_TAG_SCENE);
+    kfree(tree->free_proxies, sizeof(u32) * capacity, MEMORY_TAG_SCENE);
+    kfree(tree->order, sizeof(u32) * capacity, MEMORY_TAG_SCENE);
+    kfree(tree->centers, sizeof(vec3) * capacity, MEMORY_TAG_SCENE);
+    kfree(tree->nodes, sizeof(bvh_node) * capacity * 2, MEMORY_TAG_ENTITY_NODE);
+    kzero_memory(tree, sizeof(bvh));
+}
+
+u32 bvh_add(bvh* tree, extents_3d bounds, u32 user_data) {
+    u32 proxy;
+    if (tree->free_count > 0) {
+        proxy = tree->free_proxies[--tree->free_count];
+    } else if (tree->proxy_high_water < tree->capacity) {
+        proxy = tree->proxy_high_water++;
+    } else {
+        KERROR("bvh_add - All %u proxies in use.", tree->capacity);
+        return INVALID_ID;
+    }
+
+    tree->proxy_bounds[proxy] = bounds;
+    tree->proxy_user_data[proxy] = user_data;
+    tree->proxy_active[proxy] = True;
+    tree->proxy_count++;
+    tree->structure_dirty = True;
+    return proxy;
+}
+
+void bvh_remove(bvh* tree, u32 proxy) {
+    if (proxy >= tree->proxy_high_water || !tree->proxy_active[proxy]) {
+        KERROR("bvh_remove - Invalid proxy %u.", proxy);
+        return;
+    }
+
+    tree->proxy_active[proxy] = False;
+    tree->free_proxies[tree->free_count++] = proxy;
+    tree->proxy_count--;
+    tree->structure_dirty = True;
+}
+
+void bvh_move(bvh* tree, u32 proxy, extents_3d bounds) {
+    if (proxy >= tree->proxy_high_water || !tree->proxy_active[proxy]) {
+        KERROR("bvh_move - Invalid proxy %u.", proxy);
+        return;
+    }
+
+    tree->proxy_bounds[proxy] = bounds;
+    tree->bounds_dirty = True;
+}
+
+/**
+ * @brief Recomputes the box of every node from the proxies, and the SAH cost of the tree.
+ * Children come after their parents, so walking backwards reaches every child first.
+ */
+static void refit(bvh* tree) {
+    f32 total = 0.0f;
+    for (u32 i = tree->node_count; i-- > 0;) {
+        bvh_node* node = &tree->nodes[i];
+        extents_3d bounds = extents_empty();
+        if (node->count > 0) {
+            for (u32 k = 0; k < node->count; ++k) {
+                extents_3d proxy = tree->proxy_bounds[tree->order[node->offset + k]];
+                extents_add_box(&bounds, proxy.min, proxy.max);
+            }
+        } else {
+            const bvh_node* left = &tree->nodes[i + 1];
+            const bvh_node* right = &tree->nodes[node->offset];
+            extents_add_box(&bounds, left->min, left->max);
+            extents_add_box(&bounds, right->min, right->max);
+        }
+        node->min = bounds.min;
+        node->max = bounds.max;
+
+        f32 area = extents_area(bounds);
+        total += node->count > 0 ? area * node->count : area;
+    }
+
+    f32 root_area = tree->node_count > 0 ? extents_area((extents_3d){tree->nodes[0].min, tree->nodes[0].max}) : 0.0f;
+    tree->cost = root_area > 0.0f ? total / root_area : 0.0f;
+}
+
+/** @brief Moves the proxies of a range that belong left of a split to its front. Returns how many there are. */
+static u32 partition(bvh* tree, u32 first, u32 count, u32 axis, f32 centroid_min, f32 bin_scale, u32 split_bin) {
+    u32 left = first;
+    u32 right = first + count;
+    while (left < right) {
+        f32 c = tree->centers[tree->order[left]].elements[axis];
+        u32 bin = KMIN((u32)((c - centroid_min) * bin_scale), BVH_BIN_COUNT - 1);
+        if (bin <= split_bin) {
+            left++;
+        } else {
+            right--;
+            u32 temp = tree->order[left];
+            tree->order[left] = tree->order[right];
+            tree->order[right] = temp;
+        }
+    }
+    return left - first;
+}
+
+/**
+ * @brief Builds the subtree over the proxies at [first, first + count) of the proxy order.
+ * Returns the index of its root.
+ */
+static u32 build_node(bvh* tree, u32 first, u32 count, u32 depth) {
+    u32 index = tree->node_count++;
+    bvh_node* node = &tree->nodes[index];
+
+    extents_3d bounds = extents_empty();
+    extents_3d centroid_bounds = extents_empty();
+    for (u32 i = first; i < first + count; ++i) {
+        u32 proxy = tree->order[i];
+        extents_add_box(&bounds, tree->proxy_bounds[proxy].min, tree->proxy_bounds[proxy].max);
+        extents_add_box(&centroid_bounds, tree->centers[proxy], tree->centers[proxy]);
+    }
+    node->min = bounds.min;
+    node->max = bounds.max;
+
+    if (count <= BVH_LEAF_SIZE) {
+        node->offset = first;
+        node->count = count;
+        return index;
+    }
+
+    // Split along the axis the centres spread furthest on.
+    vec3 spread = vec3_sub(centroid_bounds.max, centroid_bounds.min);
+    u32 axis = spread.x >= spread.y && spread.x >= spread.z ? 0 : (spread.y >= spread.z ? 1 : 2);
+    f32 centroid_min = centroid_bounds.min.elements[axis];
+    f32 extent = spread.elements[axis];
+
+    u32 left_count = 0;
+    if (extent > 0.0f && depth < BVH_MAX_SAH_DEPTH) {
+        f32 bin_scale = BVH_BIN_COUNT / extent * 0.9999f;
+        u32 bin_counts[BVH_BIN_COUNT] = {0};
+        extents_3d bin_bounds[BVH_BIN_COUNT];
+        for (u32 b = 0; b < BVH_BIN_COUNT; ++b) {
+            bin_bounds[b] = extents_empty();
+        }
+        for (u32 i = first; i < first + count; ++i) {
+            u32 proxy = tree->order[i];
+            u32 bin = KMIN((u32)((tree->centers[proxy].elements[axis] - centroid_min) * bin_scale), BVH_BIN_COUNT - 1);
+            bin_counts[bin]++;
+            extents_add_box(&bin_bounds[bin], tree->proxy_bounds[proxy].min, tree->proxy_bounds[proxy].max);
+        }
+
+        // Sweep from the right to get the cost of everything right of each split, then from
+        // the left to find the cheapest split.
+        f32 right_costs[BVH_BIN_COUNT];
+        extents_3d right_bounds = extents_empty();
+        u32 right_count = 0;
+        for (u32 b = BVH_BIN_COUNT - 1; b > 0; --b) {
+            extents_add_box(&right_bounds, bin_bounds[b].min, bin_bounds[b].max);
+            right_count += bin_counts[b];
+            right_costs[b - 1] = extents_area(right_bounds) * right_count;
+        }
+
+        f32 best_cost = K_INFINITY;
+        u32 best_bin = 0;
+        extents_3d left_bounds = extents_empty();
+        u32 running_count = 0;
+        for (u32 b = 0; b < BVH_BIN_COUNT - 1; ++b) {
+            extents_add_box(&left_bounds, bin_bounds[b].min, bin_bounds[b].max);
+            running_count += bin_counts[b];
+            if (running_count == 0 || running_count == count) {
+                continue;
+            }
+            f32 cost = extents_area(left_bounds) * running_count + right_costs[b];
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_bin = b;
+            }
+        }
+
+        f32 area = extents_area(bounds);
+        f32 split_cost = area > 0.0f ? BVH_TRAVERSAL_COST + best_cost / area : BVH_TRAVERSAL_COST;
+        if (best_cost < K_INFINITY && split_cost >= (f32)count && count <= BVH_MAX_LEAF_SIZE) {
+            // Cheaper to test every proxy than to split.
+            node->offset = first;
+            node->count = count;
+            return index;
+        }
+        if (best_cost < K_INFINITY) {
+            left_count = partition(tree, first, count, axis, centroid_min, bin_scale, best_bin);
+        }
+    }
+
+    // Every centre in the same place, or too deep: split the range in half.
+    if (left_count == 0 || left_count == count) {
+        left_count = count / 2;
+    }
+
+    // The left child is always the next node.
+    node->count = 0;
+    build_node(tree, first, left_count, depth + 1);
+    node->offset = build_node(tree, first + left_count, count - left_count, depth + 1);
+    return index;
+}
+
+/** @brief Rebuilds the tree over every live proxy. */
+static void rebuild(bvh* tree) {
+    u32 count = 0;
+    for (u32 proxy = 0; proxy < tree->proxy_high_water; ++proxy) {
+        if (tree->proxy_active[proxy]) {
+            tree->order[count++] = proxy;
+            extents_3d b = tree->proxy_bounds[proxy];
+            tree->centers[proxy] = vec3_mul_scalar(vec3_add(b.min, b.max), 0.5f);
+        }
+    }
+
+    tree->node_count = 0;
+    if (count > 0) {
+        build_node(tree, 0, count, 0);
+    }
+    refit(tree);
+    tree->build_cost = tree->cost;
+}
+
+void bvh_update(bvh* tree) {
+    if (tree->structure_dirty) {
+        rebuild(tree);
+    } else if (tree->bounds_dirty) {
+        refit(tree);
+        // Refitting keeps the tree valid, but as proxies move apart the nodes overlap more.
+        if (tree->cost > tree->build_cost * BVH_REBUILD_COST_RATIO) {
+            rebuild(tree);
+        }
+    }
+
+    tree->structure_dirty = False;
+    tree->bounds_dirty = False;
+}
+
+/**
+ * @brief Tests a box against the planes of a frustum whose bits are set in mask.
+ * Returns False if the box is outside any of them. Otherwise clears the bits of the planes the
+ * box is entirely inside, which its contents need not be tested against.
+ */
+static b8 frustum_test_box(const frustum* f, vec3 min, vec3 max, u32* mask) {
+    vec3 center = vec3_mul_scalar(vec3_add(min, max), 0.5f);
+    vec3 half = vec3_mul_scalar(vec3_sub(max, min), 0.5f);
+    for (u32 p = 0; p < 6; ++p) {
+        if (!(*mask & (1u << p))) {
+            continue;
+        }
+        vec4 plane = f->planes[p];
+        f32 distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+        f32 reach = kabs(plane.x) * half.x + kabs(plane.y) * half.y + kabs(plane.z) * half.z;
+        if (distance + reach < 0.0f) {
+            return False;
+        }
+        if (distance - reach >= 0.0f) {
+            *mask &= ~(1u << p);
+        }
+    }
+    return True;
+}
+
+u32 bvh_query_frustum(const bvh* tree, const frustum* f, u32* out_user_data, u32 max_results) {
+    if (tree->node_count == 0 || max_results == 0) {
+        return 0;
+    }
+
+    u32 stack[BVH_STACK_SIZE];
+    u32 masks[BVH_STACK_SIZE];
+    u32 stack_size = 0;
+    stack[stack_size] = 0;
+    masks[stack_size++] = BVH_ALL_PLANES;
+
+    u32 result_count = 0;
+    while (stack_size > 0) {
+        stack_size--;
+        const bvh_node* node = &tree->nodes[stack[stack_size]];
+        u32 mask = masks[stack_size];
+        if (mask && !frustum_test_box(f, node->min, node->max, &mask)) {
+            continue;
+        }
+
+        if (node->count > 0) {
+            for (u32 k = 0; k < node->count; ++k) {
+                u32 proxy = tree->order[node->offset + k];
+                u32 proxy_mask = mask;
+                if (proxy_mask && !frustum_test_box(f, tree->proxy_bounds[proxy].min, tree->proxy_bounds[proxy].max, &proxy_mask)) {
+                    continue;
+                }
+                out_user_data[result_count++] = tree->proxy_user_data[proxy];
+                if (result_count == max_results) {
+                    return result_count;
+                }
+            }
+        } else {
+            // Right first, so the left child, which follows its parent in memory, is next.
+            u32 index = (u32)(node - tree->nodes);
+            stack[stack_size] = node->offset;
+            masks[stack_size++] = mask;
+            stack[stack_size] = index + 1;
+            masks[stack_size++] = mask;
+        }
+    }
+    return result_count;
+}
+
+/** @brief Whether two boxes overlap or touch. */
+static b8 boxes_overlap(vec3 a_min, vec3 a_max, vec3 b_min, vec3 b_max) {
+    return a_min.x <= b_max.x && a_max.x >= b_min.x &&
+           a_min.y <= b_max.y && a_max.y >= b_min.y &&
+           a_min.z <= b_max.z && a_max.z >= b_min.z;
+}
+
+u32 bvh_query_overlap(const bvh* tree, extents_3d bounds, u32* out_user_data, u32 max_results) {
+    if (tree->node_count == 0 || max_results == 0) {
+        return 0;
+    }
+
+    u32 stack[BVH_STACK_SIZE];
+    u32 stack_size = 0;
+    stack[stack_size++] = 0;
+
+    u32 result_count = 0;
+    while (stack_size > 0) {
+        u32 index = stack[--stack_size];
+        const bvh_node* node = &tree->nodes[index];
+        if (!boxes_overlap(node->min, node->max, bounds.min, bounds.max)) {
+            continue;
+        }
+
+        if (node->count > 0) {
+            for (u32 k = 0; k < node->count; ++k) {
+                u32 proxy = tree->order[node->offset + k];
+                if (boxes_overlap(tree->proxy_bounds[proxy].min, tree->proxy_bounds[proxy].max, bounds.min, bounds.max)) {
+                    out_user_data[result_count++] = tree->proxy_user_data[proxy];
+                    if (result_count == max_results) {
+                        return result_count;
+                    }
+                }
+            }
+        } else {
+            stack[stack_size++] = node->offset;
+            stack[stack_size++] = index + 1;
+        }
+    }
+    return result_count;
+}
+
+/**
+ * @brief The distance at which a ray enters a box, given the reciprocal of its direction, or
+ * K_INFINITY if it misses the box within [0, max_distance].
+ */
+static f32 ray_enter_box(vec3 origin, vec3 inverse_direction, vec3 min, vec3 max, f32 max_distance) {
+    f32 near = 0.0f;
+    f32 far = max_distance;
+    for (u32 axis = 0; axis < 3; ++axis) {
+        f32 t_0 = (min.elements[axis] - origin.elements[axis]) * inverse_direction.elements[axis];
+        f32 t_1 = (max.elements[axis] - origin.elements[axis]) * inverse_direction.elements[axis];
+        near = KMAX(near, KMIN(t_0, t_1));
+        far = KMIN(far, KMAX(t_0, t_1));
+    }
+    return near <= far ? near : K_INFINITY;
+}
+
+b8 bvh_raycast(const bvh* tree, ray r, f32 max_distance, bvh_hit* out_hit) {
+    if (tree->node_count == 0) {
+        return False;
+    }
+
+    // Axes the ray does not move along get a huge reciprocal, rather than a division by zero.
+    vec3 inverse_direction;
+    for (u32 axis = 0; axis < 3; ++axis) {
+        f32 d = r.direction.elements[axis];
+        inverse_direction.elements[axis] = d != 0.0f ? 1.0f / d : K_INFINITY;
+    }
+
+    u32 stack[BVH_STACK_SIZE];
+    u32 stack_size = 0;
+    stack[stack_size++] = 0;
+
+    f32 best = max_distance;
+    u32 best_proxy = INVALID_ID;
+    while (stack_size > 0) {
+        u32 index = stack[--stack_size];
+        const bvh_node* node = &tree->nodes[index];
+        // Anything nearer found since this node was pushed may rule it out.
+        if (ray_enter_box(r.origin, inverse_direction, node->min, node->max, best) == K_INFINITY) {
+            continue;
+        }
+
+        if (node->count > 0) {
+            for (u32 k = 0; k < node->count; ++k) {
+                u32 proxy = tree->order[node->offset + k];
+                f32 t = ray_enter_box(r.origin, inverse_direction, tree->proxy_bounds[proxy].min, tree->proxy_bounds[proxy].max, best);
+                if (t < best || (t == best && best_proxy == INVALID_ID)) {
+                    best = t;
+                    best_proxy = proxy;
+                }
+            }
+        } else {
+            // Visit the nearer child first, so the farther can often be skipped.
+            const bvh_node* left = &tree->nodes[index + 1];
+            const bvh_node* right = &tree->nodes[node->offset];
+            f32 t_left = ray_enter_box(r.origin, inverse_direction, left->min, left->max, best);
+            f32 t_right = ray_enter_box(r.origin, inverse_direction, right->min, right->max, best);
+            b8 left_first = t_left <= t_right;
+            u32 near_index = left_first ? index + 1 : node->offset;
+            u32 far_index = left_first ? node->offset : index + 1;
+            f32 t_far = left_first ? t_right : t_left;
+            f32 t_near = left_first ? t_left : t_right;
+            if (t_far != K_INFINITY) {
+                stack[stack_size++] = far_index;
+            }
+            if (t_near != K_INFINITY) {
+                stack[stack_size++] = near_index;
+            }
+        }
+    }
+
+    if (best_proxy == INVALID_ID) {
+        return False;
+    }
+    out_hit->proxy = best_proxy;
+    out_hit->user_data = tree->proxy_user_data[best_proxy];
+    out_hit->distance = best;
+    return True;
+}
@@ -0,0 +1,185 @@
+#pragma once
+
+#include "math/math_types.h"
+
+/**
+ * @file bvh.h
+ * @brief A bounding volume hierarchy over axis-aligned boxes, for visibility and scene queries.
+ *
+ * Each object in the hierarchy is a proxy: a box and a user value, such as the index of an
+ * instance. Proxies are grouped into a binary tree of boxes, each node bounding everything
+ * below it, so a query skips every proxy under a node it does not touch.
+ *
+ * The tree is built top-down with the surface area heuristic (SAH), binned along the longest
+ * axis of the proxies' centres. Nodes are stored depth first: a node's left child follows it,
+ * and the proxies below any node are contiguous. The tree is only changed by `bvh_update()`:
+ * - Moving proxies only refits the boxes of the nodes, bottom-up in a single pass.
+ * - Adding or removing proxies, or refits that have let the tree grow much worse than when it
+ *   was built, rebuild it.
+ *
+ * Usage:
+ * - Create a hierarchy with `bvh_create()`, giving the maximum number of proxies.
+ * - Add, move and remove proxies with `bvh_add()`, `bvh_move()` and `bvh_remove()`.
+ * - Call `bvh_update()` once the frame's changes are made, then query with `bvh_query_frustum()`,
+ *   `bvh_query_overlap()` or `bvh_raycast()`. Queries see the proxies as of the last update.
+ * - Destroy the hierarchy with `bvh_destroy()`.
+ *
+ * NOTE: Not thread-safe. Queries may run concurrently with each other, but not with changes.
+ */
+
+/**
+ * @struct bvh_node
+ * @brief A node of the hierarchy. 32 bytes, so two fit in a cache line.
+ */
+typedef struct bvh_node {
+    /** @brief The lowest corner of the box around everything below the node. */
+    vec3 min;
+    /** @brief Internal nodes: the index of the right child. Leaves: the first entry in the proxy order. */
+    u32 offset;
+    /** @brief The highest corner of the box around everything below the node. */
+    vec3 max;
+    /** @brief The number of proxies in a leaf, or 0 for an internal node. */
+    u32 count;
+} bvh_node;
+
+/**
+ * @struct bvh
+ * @brief A bounding volume hierarchy. Members should not be modified outside the functions
+ * associated with it.
+ */
+typedef struct bvh {
+    /** @brief The maximum number of proxies. */
+    u32 capacity;
+    /** @brief The number of live proxies. */
+    u32 proxy_count;
+    /** @brief One past the highest proxy id handed out. */
+    u32 proxy_high_water;
+    /** @brief The box of each proxy. */
+    extents_3d* proxy_bounds;
+    /** @brief The user value of each proxy. */
+    u32* proxy_user_data;
+    /** @brief Whether each proxy is live. */
+    b8* proxy_active;
+    /** @brief Ids of removed proxies, reused before new ones. */
+    u32* free_proxies;
+    /** @brief The number of ids in free_proxies. */
+    u32 free_count;
+
+    /** @brief The nodes, depth first, the root first. */
+    bvh_node* nodes;
+    /** @brief The number of nodes in use. */
+    u32 node_count;
+    /** @brief The proxy ids, in the order the leaves reference them. */
+    u32* order;
+    /** @brief The centre of each proxy's box, used while building. */
+    vec3* centers;
+
+    /** @brief Whether proxies were added or removed since the last update. */
+    b8 structure_dirty;
+    /** @brief Whether proxies were moved since the last update. */
+    b8 bounds_dirty;
+    /** @brief The SAH cost of the tree when it was last built. */
+    f32 build_cost;
+    /** @brief The SAH cost of the tree as of the last update. */
+    f32 cost;
+} bvh;
+
+/**
+ * @struct bvh_hit
+ * @brief The proxy a ray hit, and where.
+ */
+typedef struct bvh_hit {
+    /** @brief The id of the proxy hit. */
+    u32 proxy;
+    /** @brief The user value of the proxy hit. */
+    u32 user_data;
+    /** @brief The distance along the ray to where it enters the proxy's box, in multiples of the direction. */
+    f32 distance;
+} bvh_hit;
+
+/**
+ * @brief Creates an empty hierarchy, allocating storage for the given number of proxies.
+ *
+ * @param capacity The maximum number of proxies.
+ * @param out_bvh A pointer to hold the hierarchy.
+ * @return True on success; otherwise False.
+ */
+KAPI b8 bvh_create(u32 capacity, bvh* out_bvh);
+
+/**
+ * @brief Destroys a hierarchy, freeing its storage.
+ *
+ * @param tree A pointer to the hierarchy.
+ */
+KAPI void bvh_destroy(bvh* tree);
+
+/**
+ * @brief Adds a proxy. It takes part in queries from the next update.
+ *
+ * @param tree A pointer to the hierarchy.
+ * @param bounds The box of the proxy.
+ * @param user_data A value returned by queries that find the proxy.
+ * @return The id of the proxy, or INVALID_ID if the hierarchy is full.
+ */
+KAPI u32 bvh_add(bvh* tree, extents_3d bounds, u32 user_data);
+
+/**
+ * @brief Removes a proxy. It stops taking part in queries from the next update.
+ *
+ * @param tree A pointer to the hierarchy.
+ * @param proxy The id of the proxy.
+ */
+KAPI void bvh_remove(bvh* tree, u32 proxy);
+
+/**
+ * @brief Changes the box of a proxy. Queries see it from the next update.
+ *
+ * @param tree A pointer to the hierarchy.
+ * @param proxy The id of the proxy.
+ * @param bounds The new box.
+ */
+KAPI void bvh_move(bvh* tree, u32 proxy, extents_3d bounds);
+
+/**
+ * @brief Applies the changes made since the last update, refitting or rebuilding the tree.
+ *
+ * @param tree A pointer to the hierarchy.
+ */
+KAPI void bvh_update(bvh* tree);
+
+/**
+ * @brief Finds the proxies whose boxes may be inside a frustum.
+ *
+ * Whole subtrees inside a plane stop being tested against it, and those inside every plane
+ * are taken without testing.
+ *
+ * @param tree A pointer to the hierarchy.
+ * @param f The frustum.
+ * @param out_user_data An array to hold the user value of each proxy found.
+ * @param max_results The length of out_user_data. The query stops once it is full.
+ * @return The number of proxies found.
+ */
+KAPI u32 bvh_query_frustum(const bvh* tree, const frustum* f, u32* out_user_data, u32 max_results);
+
+/**
+ * @brief Finds the proxies whose boxes overlap a box. Boxes that only touch overlap.
+ *
+ * @param tree A pointer to the hierarchy.
+ * @param bounds The box.
+ * @param out_user_data An array to hold the user value of each proxy found.
+ * @param max_results The length of out_user_data. The query stops once it is full.
+ * @return The number of proxies found.
+ */
+KAPI u32 bvh_query_overlap(const bvh* tree, extents_3d bounds, u32* out_user_data, u32 max_results);
+
+/**
+ * @brief Finds the nearest proxy whose box a ray enters. A ray starting inside a box enters it
+ * at distance 0.
+ *
+ * @param tree A pointer to the hierarchy.
+ * @param r The ray.
+ * @param max_distance How far along the ray to look, in multiples of its direction.
+ * @param out_hit A pointer to hold the proxy hit. Unchanged if nothing is hit.
+ * @return True if a proxy was hit; otherwise False.
+ */
+KAPI b8 bvh_raycast(const bvh* tree, ray r, f32 max_distance, bvh_hit* out_hit);
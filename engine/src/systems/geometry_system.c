@@ -3,6 +3,8 @@
 #include "core/logger.h"
 #include "core/kmemory.h"
 #include "core/kstring.h"
+#include "containers/handle_pool.h"
+#include "math/kmath.h"
 #include "systems/material_system.h"
 #include "renderer/renderer_frontend.h"
 
@@ -32,6 +34,8 @@
 typedef struct geometry_reference {
     /** Reference count for the geometry. */
     u64 reference_count;
+    /** Handle to the geometry's slot. Goes stale once the geometry is destroyed, even if the slot is reused. */
+    khandle handle;
     /** The actual geometry data. */
     geometry geometry;
     /** Whether the geometry should be automatically released when the reference count reaches zero. */
@@ -52,6 +56,9 @@ typedef struct geometry_system_state {
 
     /** Array of registered meshes. */
     geometry_reference* registered_geometries;
+
+    /** Hands out slots of registered_geometries. */
+    handle_pool geometry_slots;
 } geometry_system_state;
 
 /** Static pointer to the system state. */
@@ -84,16 +91,27 @@ b8 create_geometry(geometry_system_state* state, geometry_config config, geometr
  */
 void destroy_geometry(geometry_system_state* state, geometry* g);
 
+/**
+ * @brief Computes the bounding box and sphere of a geometry from its vertices.
+ *
+ * @param vertex_count The number of vertices.
+ * @param vertices The vertices.
+ * @param g Pointer to the geometry to hold the bounds.
+ */
+void compute_geometry_bounds(u32 vertex_count, const vertex_3d* vertices, geometry* g);
+
 b8 geometry_system_initialize(u64* memory_requirement, void* state, geometry_system_config config) {
     if (config.max_geometry_count == 0) {
         KFATAL("geometry_system_initialize - config.max_geometry_count must be > 0.");
         return False;
     }
 
-    // Block of memory will contain state structure, then block for array, then block for hashtable.
+    // Block of memory will contain state structure, then block for array, then block for the slot pool.
     u64 struct_requirement = sizeof(geometry_system_state);
-    u64 array_requirement = sizeof(geometry) * config.max_geometry_count;
-    *memory_requirement = struct_requirement + array_requirement;
+    u64 array_requirement = sizeof(geometry_reference) * config.max_geometry_count;
+    u64 slots_requirement = 0;
+    handle_pool_create(config.max_geometry_count, &slots_requirement, 0, 0);
+    *memory_requirement = struct_requirement + array_requirement + slots_requirement;
 
     if (!state) {
         return True;
@@ -106,9 +124,14 @@ b8 geometry_system_initialize(u64* memory_requirement, void* state, geometry_sys
     void* array_block = state + struct_requirement;
     state_ptr->registered_geometries = array_block;
 
+    // Slot pool block is after array.
+    void* slots_block = array_block + array_requirement;
+    handle_pool_create(config.max_geometry_count, &slots_requirement, slots_block, &state_ptr->geometry_slots);
+
     // Invalidate all geometries in the array.
     u32 count = state_ptr->config.max_geometry_count;
     for (u32 i = 0; i < count; ++i) {
+        state_ptr->registered_geometries[i].handle = KHANDLE_INVALID;
         state_ptr->registered_geometries[i].geometry.id = INVALID_ID;
         state_ptr->registered_geometries[i].geometry.internal_id = INVALID_ID;
         state_ptr->registered_geometries[i].geometry.generation = INVALID_ID;
@@ -127,7 +150,8 @@ void geometry_system_shutdown(void* state) {
 }
 
 geometry* geometry_system_acquire_by_id(u32 id) {
-    if (id != INVALID_ID && state_ptr->registered_geometries[id].geometry.id != INVALID_ID) {
+    // Ids are slot indices, so only a live slot is accepted.
+    if (handle_pool_handle_at(&state_ptr->geometry_slots, id) != KHANDLE_INVALID) {
         state_ptr->registered_geometries[id].reference_count++;
         return &state_ptr->registered_geometries[id].geometry;
     }
@@ -138,25 +162,24 @@ geometry* geometry_system_acquire_by_id(u32 id) {
 }
 
 geometry* geometry_system_acquire_from_config(geometry_config config, b8 auto_release) {
-    geometry* g = 0;
-    for (u32 i = 0; i < state_ptr->config.max_geometry_count; ++i) {
-        if (state_ptr->registered_geometries[i].geometry.id == INVALID_ID) {
-            // Found empty slot.
-            state_ptr->registered_geometries[i].auto_release = auto_release;
-            state_ptr->registered_geometries[i].reference_count = 1;
-            g = &state_ptr->registered_geometries[i].geometry;
-            g->id = i;
-            break;
-        }
-    }
-
-    if (!g) {
+    khandle handle;
+    if (!handle_pool_acquire(&state_ptr->geometry_slots, &handle)) {
         KERROR("Unable to obtain free slot for geometry. Adjust configuration to allow more space. Returning nullptr.");
         return 0;
     }
 
+    u32 index = handle_pool_index(handle);
+    geometry_reference* ref = &state_ptr->registered_geometries[index];
+    ref->handle = handle;
+    ref->auto_release = auto_release;
+    ref->reference_count = 1;
+    geometry* g = &ref->geometry;
+    g->id = index;
+
     if (!create_geometry(state_ptr, config, g)) {
         KERROR("Failed to create geometry. Returning nullptr.");
+        handle_pool_release(&state_ptr->geometry_slots, handle);
+        ref->handle = KHANDLE_INVALID;
         return 0;
     }
 
@@ -164,11 +187,9 @@ geometry* geometry_system_acquire_from_config(geometry_config config, b8 auto_re
 }
 
 void geometry_system_release(geometry* geometry) {
-    if (geometry && geometry->id != INVALID_ID) {
+    if (geometry && handle_pool_handle_at(&state_ptr->geometry_slots, geometry->id) != KHANDLE_INVALID) {
         geometry_reference* ref = &state_ptr->registered_geometries[geometry->id];
 
-        // Take a copy of the id;
-        u32 id = geometry->id;
         if (ref->geometry.id == geometry->id) {
             if (ref->reference_count > 0) {
                 ref->reference_count--;
@@ -179,6 +200,8 @@ void geometry_system_release(geometry* geometry) {
                 destroy_geometry(state_ptr, &ref->geometry);
                 ref->reference_count = 0;
                 ref->auto_release = False;
+                handle_pool_release(&state_ptr->geometry_slots, ref->handle);
+                ref->handle = KHANDLE_INVALID;
             }
         } else {
             KFATAL("Geometry id mismatch. Check registration logic, as this should never occur.");
@@ -199,6 +222,8 @@ geometry* geometry_system_get_default() {
 }
 
 b8 create_geometry(geometry_system_state* state, geometry_config config, geometry* g) {
+    compute_geometry_bounds(config.vertex_count, config.vertices, g);
+
     // Send the geometry off to the renderer to be uploaded to the GPU.
     if (!renderer_create_geometry(g, config.vertex_count, config.vertices, config.index_count, config.indices)) {
         // Invalidate the entry.
@@ -213,7 +238,7 @@ b8 create_geometry(geometry_system_state* state, geometry_config config, geometr
 
     // Acquire the material
     if (string_length(config.material_name) > 0) {
-        g->material = material_system_acquire(config.material_name);
+        g->material = material_system_acquire_async(config.material_name);
         if (!g->material) {
             g->material = material_system_get_default();
         }
@@ -237,6 +262,34 @@ void destroy_geometry(geometry_system_state* state, geometry* g) {
     }
 }
 
+void compute_geometry_bounds(u32 vertex_count, const vertex_3d* vertices, geometry* g) {
+    if (vertex_count == 0) {
+        kzero_memory(&g->extents, sizeof(extents_3d));
+        g->center = vec3_zero();
+        g->radius = 0.0f;
+        return;
+    }
+
+    extents_3d extents = {vertices[0].position, vertices[0].position};
+    for (u32 i = 1; i < vertex_count; ++i) {
+        vec3 p = vertices[i].position;
+        extents.min = vec3_create(KMIN(extents.min.x, p.x), KMIN(extents.min.y, p.y), KMIN(extents.min.z, p.z));
+        extents.max = vec3_create(KMAX(extents.max.x, p.x), KMAX(extents.max.y, p.y), KMAX(extents.max.z, p.z));
+    }
+
+    // The sphere shares the centre of the box, but only reaches the furthest vertex, which is
+    // usually tighter than the corners of the box.
+    vec3 center = vec3_mul_scalar(vec3_add(extents.min, extents.max), 0.5f);
+    f32 radius_squared = 0.0f;
+    for (u32 i = 0; i < vertex_count; ++i) {
+        radius_squared = KMAX(radius_squared, vec3_length_squared(vec3_sub(vertices[i].position, center)));
+    }
+
+    g->extents = extents;
+    g->center = center;
+    g->radius = ksqrt(radius_squared);
+}
+
 b8 create_default_geometry(geometry_system_state* state) {
     vertex_3d verts[4];
     kzero_memory(verts, sizeof(vertex_3d) * 4);
@@ -265,6 +318,8 @@ b8 create_default_geometry(geometry_system_state* state) {
 
     u32 indices[6] = {0, 1, 2, 0, 3, 1};
 
+    compute_geometry_bounds(4, verts, &state->default_geometry);
+
     // Send the geometry off to the renderer to be uploaded to the GPU.
     if (!renderer_create_geometry(&state->default_geometry, 4, verts, 6, indices)) {
         KFATAL("Failed to create default geometry. Application cannot continue.");
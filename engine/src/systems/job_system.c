@@ -0,0 +1,492 @@
+#include "job_system.h"
+
+#include "core/logger.h"
+#include "core/kmemory.h"
+#include "core/kthread.h"
+#include "core/kmutex.h"
+#include "core/ksemaphore.h"
+#include "platform/platform.h"
+
+/**
+ * @file job_system.c
+ *
+ * @brief Implementation of the work-stealing job system.
+ *
+ * Every thread (the main thread at index 0, then each worker) owns one Chase-Lev deque per
+ * priority. Deques hold indices into a fixed pool of job slots, so no allocations happen when
+ * jobs are submitted. The owner pushes/pops at the bottom without locking; thieves take from
+ * the top with a single compare-and-swap. The deque algorithm follows "Correct and Efficient
+ * Work-Stealing for Weak Memory Models" (Lê, Pop, Cohen, Zappa Nardelli, 2013).
+ *
+ * Idle workers sleep on a semaphore which is signaled once per queued job.
+ *
+ * Jobs with an unfinished dependency are parked in a waiting list (guarded by a mutex) and are
+ * pushed onto the deque of whichever thread brings the dependency counter to zero.
+ */
+
+/** @brief The maximum number of worker threads, regardless of core count. */
+#define JOB_SYSTEM_MAX_WORKERS 31
+
+/**
+ * @enum steal_result
+ * @brief The outcome of an attempt to steal from another thread's deque.
+ */
+typedef enum steal_result {
+    /** @brief The deque was empty. */
+    STEAL_EMPTY,
+    /** @brief Lost a race with another thread for the top job. Worth trying again. */
+    STEAL_ABORT,
+    /** @brief A job was stolen. */
+    STEAL_SUCCESS
+} steal_result;
+
+/**
+ * @struct job_deque
+ * @brief A fixed-capacity Chase-Lev work-stealing deque of job slot indices.
+ */
+typedef struct job_deque {
+    /** @brief The index thieves steal from. Only ever incremented. */
+    _Atomic i64 top;
+    /** @brief Keeps top and bottom on separate cache lines to avoid false sharing. */
+    u8 padding[56];
+    /** @brief The index the owner pushes to/pops from. */
+    _Atomic i64 bottom;
+    /** @brief Ring buffer of job slot indices. Capacity is a power of two. */
+    _Atomic u32* buffer;
+} job_deque;
+
+/**
+ * @struct job_thread
+ * @brief Per-thread job system data.
+ */
+typedef struct job_thread {
+    /** @brief The worker thread. Unused for index 0, which is the main thread. */
+    kthread thread;
+    /** @brief The index of this thread within the job system. */
+    u32 index;
+    /** @brief One deque per priority, owned by this thread. */
+    job_deque deques[JOB_PRIORITY_COUNT];
+} job_thread;
+
+/**
+ * @struct job_system_state
+ * @brief Internal state of the job system.
+ */
+typedef struct job_system_state {
+    /** @brief Indicates if the worker threads should keep running. */
+    atomic_bool running;
+    /** @brief The number of threads with deques; the main thread plus all workers. */
+    u32 thread_count;
+    /** @brief The number of job slots. */
+    u32 max_job_count;
+    /** @brief Deque capacity - 1, used to wrap indices into the ring buffers. */
+    u32 deque_mask;
+    /** @brief Per-thread data, indexed by thread index. */
+    job_thread* threads;
+    /** @brief Job slots, indexed by the values held in the deques. */
+    job_info* jobs;
+    /** @brief Stack of free job slot indices. */
+    u32* free_slots;
+    /** @brief The number of entries in free_slots. */
+    u32 free_slot_count;
+    /** @brief Guards free_slots. */
+    kmutex slot_mutex;
+    /** @brief Job slot indices waiting on a dependency counter to reach zero. */
+    u32* waiting_slots;
+    /** @brief The number of entries in waiting_slots. */
+    u32 waiting_slot_count;
+    /** @brief Guards waiting_slots. */
+    kmutex waiting_mutex;
+    /** @brief Signaled once per queued job to wake idle workers. */
+    ksemaphore work_semaphore;
+} job_system_state;
+
+/** @brief Pointer to the job system state. */
+static job_system_state* state_ptr = 0;
+
+/** @brief The job system index of the calling thread. 0 for the main (or any non-worker) thread. */
+static _Thread_local u32 thread_index = 0;
+
+static b8 deque_push(job_deque* deque, u32 mask, u32 job_index) {
+    i64 bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    i64 top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    if (bottom - top > (i64)mask) {
+        return False;
+    }
+
+    // Release, so a thief that sees the new bottom also sees the entry and the job slot contents.
+    atomic_store_explicit(&deque->buffer[bottom & mask], job_index, memory_order_relaxed);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_release);
+    return True;
+}
+
+static b8 deque_pop(job_deque* deque, u32 mask, u32* out_job_index) {
+    i64 bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    i64 top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if (top > bottom) {
+        // Empty, restore.
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return False;
+    }
+
+    *out_job_index = atomic_load_explicit(&deque->buffer[bottom & mask], memory_order_relaxed);
+    if (top == bottom) {
+        // Last entry. Race any thieves for it.
+        b8 won = atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed);
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return won;
+    }
+
+    return True;
+}
+
+static steal_result deque_steal(job_deque* deque, u32 mask, u32* out_job_index) {
+    i64 top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    i64 bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+
+    if (top >= bottom) {
+        return STEAL_EMPTY;
+    }
+
+    u32 job_index = atomic_load_explicit(&deque->buffer[top & mask], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed)) {
+        return STEAL_ABORT;
+    }
+
+    *out_job_index = job_index;
+    return STEAL_SUCCESS;
+}
+
+static b8 slot_acquire(u32* out_index) {
+    b8 found = False;
+    kmutex_lock(&state_ptr->slot_mutex);
+    if (state_ptr->free_slot_count > 0) {
+        state_ptr->free_slot_count--;
+        *out_index = state_ptr->free_slots[state_ptr->free_slot_count];
+        found = True;
+    }
+    kmutex_unlock(&state_ptr->slot_mutex);
+    return found;
+}
+
+static void slot_release(u32 index) {
+    kmutex_lock(&state_ptr->slot_mutex);
+    state_ptr->free_slots[state_ptr->free_slot_count] = index;
+    state_ptr->free_slot_count++;
+    kmutex_unlock(&state_ptr->slot_mutex);
+}
+
+/**
+ * @brief Finds a job for the given thread to run. For each priority, highest first, the
+ * thread's own deque is checked, then every other thread's deque is stolen from.
+ */
+static b8 job_find(u32 self, u32* out_job_index) {
+    u32 mask = state_ptr->deque_mask;
+    u32 thread_count = state_ptr->thread_count;
+
+    for (u32 p = 0; p < JOB_PRIORITY_COUNT; ++p) {
+        if (deque_pop(&state_ptr->threads[self].deques[p], mask, out_job_index)) {
+            return True;
+        }
+
+        b8 retry;
+        do {
+            retry = False;
+            for (u32 i = 1; i < thread_count; ++i) {
+                u32 victim = (self + i) % thread_count;
+                steal_result result = deque_steal(&state_ptr->threads[victim].deques[p], mask, out_job_index);
+                if (result == STEAL_SUCCESS) {
+                    return True;
+                }
+                if (result == STEAL_ABORT) {
+                    retry = True;
+                }
+            }
+        } while (retry);
+    }
+
+    return False;
+}
+
+/**
+ * @brief Queues a job slot on the calling thread's deque and wakes a worker to pick it up.
+ */
+static void job_enqueue(u32 job_index) {
+    job_info* info = &state_ptr->jobs[job_index];
+    // NOTE: Deques are at least as large as the job pool, so this can only fail if misused
+    // from a thread the job system doesn't know about.
+    if (!deque_push(&state_ptr->threads[thread_index].deques[info->priority], state_ptr->deque_mask, job_index)) {
+        KFATAL("job_enqueue - deque overflow on thread %u.", thread_index);
+        return;
+    }
+    ksemaphore_signal(&state_ptr->work_semaphore);
+}
+
+/**
+ * @brief Moves all jobs waiting on the given counter onto the calling thread's deques.
+ */
+static void release_waiting(job_counter* counter) {
+    kmutex_lock(&state_ptr->waiting_mutex);
+    u32 i = 0;
+    while (i < state_ptr->waiting_slot_count) {
+        u32 job_index = state_ptr->waiting_slots[i];
+        if (state_ptr->jobs[job_index].dependency == counter) {
+            // Swap-remove, then re-check the same position.
+            state_ptr->waiting_slot_count--;
+            state_ptr->waiting_slots[i] = state_ptr->waiting_slots[state_ptr->waiting_slot_count];
+            job_enqueue(job_index);
+        } else {
+            i++;
+        }
+    }
+    kmutex_unlock(&state_ptr->waiting_mutex);
+}
+
+static void job_counter_decrement(job_counter* counter) {
+    if (atomic_fetch_sub_explicit(&counter->value, 1, memory_order_acq_rel) == 1 && state_ptr) {
+        release_waiting(counter);
+    }
+}
+
+static void job_run(u32 job_index) {
+    job_info* info = &state_ptr->jobs[job_index];
+    if (!info->entry_point(info->param_data)) {
+        KWARN("Job returned failure (thread %u).", thread_index);
+    }
+
+    // Release the slot before signaling, so a waiter can submit straight away.
+    job_counter* counter = info->counter;
+    slot_release(job_index);
+    if (counter) {
+        job_counter_decrement(counter);
+    }
+}
+
+static b8 job_run_inline(job_info* info) {
+    if (info->dependency) {
+        job_counter_wait(info->dependency);
+    }
+
+    b8 result = info->entry_point(info->param_data);
+    if (info->counter) {
+        job_counter_decrement(info->counter);
+    }
+    return result;
+}
+
+static u32 job_thread_run(void* params) {
+    job_thread* self = params;
+    thread_index = self->index;
+
+    KTRACE("Job thread #%u starting.", thread_index);
+    while (atomic_load_explicit(&state_ptr->running, memory_order_acquire)) {
+        u32 job_index;
+        if (job_find(thread_index, &job_index)) {
+            job_run(job_index);
+        } else {
+            ksemaphore_wait(&state_ptr->work_semaphore);
+        }
+    }
+    KTRACE("Job thread #%u exiting.", thread_index);
+
+    return 0;
+}
+
+b8 job_system_initialize(u64* memory_requirement, void* state, job_system_config config) {
+    if (config.max_job_count == 0) {
+        KFATAL("job_system_initialize - config.max_job_count must be > 0.");
+        return False;
+    }
+
+    // One worker per logical core, leaving one for the main thread.
+    i32 processor_count = platform_get_processor_count();
+    u32 worker_count = processor_count > 1 ? (u32)(processor_count - 1) : 1;
+    if (config.max_worker_count && worker_count > config.max_worker_count) {
+        worker_count = config.max_worker_count;
+    }
+    if (worker_count > JOB_SYSTEM_MAX_WORKERS) {
+        worker_count = JOB_SYSTEM_MAX_WORKERS;
+    }
+    u32 thread_count = worker_count + 1;
+
+    // Each deque can hold every job slot, so a push can never fail.
+    u32 deque_capacity = 1;
+    while (deque_capacity < config.max_job_count) {
+        deque_capacity <<= 1;
+    }
+
+    // Block of memory will contain state structure, then threads, deque buffers, job slots,
+    // the free slot stack and the waiting list.
+    u64 struct_requirement = sizeof(job_system_state);
+    u64 threads_requirement = sizeof(job_thread) * thread_count;
+    u64 deque_requirement = sizeof(_Atomic u32) * deque_capacity * JOB_PRIORITY_COUNT * thread_count;
+    u64 jobs_requirement = sizeof(job_info) * config.max_job_count;
+    u64 free_requirement = sizeof(u32) * config.max_job_count;
+    u64 waiting_requirement = sizeof(u32) * config.max_job_count;
+    *memory_requirement = struct_requirement + threads_requirement + deque_requirement + jobs_requirement + free_requirement + waiting_requirement;
+
+    if (!state) {
+        return True;
+    }
+
+    kzero_memory(state, *memory_requirement);
+    state_ptr = state;
+    state_ptr->thread_count = thread_count;
+    state_ptr->max_job_count = config.max_job_count;
+    state_ptr->deque_mask = deque_capacity - 1;
+
+    void* block = state + struct_requirement;
+    state_ptr->threads = block;
+    block += threads_requirement;
+    _Atomic u32* deque_block = block;
+    block += deque_requirement;
+    state_ptr->jobs = block;
+    block += jobs_requirement;
+    state_ptr->free_slots = block;
+    block += free_requirement;
+    state_ptr->waiting_slots = block;
+
+    for (u32 i = 0; i < thread_count; ++i) {
+        state_ptr->threads[i].index = i;
+        for (u32 p = 0; p < JOB_PRIORITY_COUNT; ++p) {
+            state_ptr->threads[i].deques[p].buffer = deque_block + ((i * JOB_PRIORITY_COUNT) + p) * deque_capacity;
+        }
+    }
+
+    // Push in reverse so that slot 0 is handed out first.
+    for (u32 i = 0; i < config.max_job_count; ++i) {
+        state_ptr->free_slots[i] = config.max_job_count - 1 - i;
+    }
+    state_ptr->free_slot_count = config.max_job_count;
+
+    if (!kmutex_create(&state_ptr->slot_mutex) || !kmutex_create(&state_ptr->waiting_mutex)) {
+        KFATAL("job_system_initialize - Failed to create mutexes.");
+        return False;
+    }
+    if (!ksemaphore_create(&state_ptr->work_semaphore, config.max_job_count + thread_count, 0)) {
+        KFATAL("job_system_initialize - Failed to create work semaphore.");
+        return False;
+    }
+
+    // The initializing thread becomes thread 0.
+    thread_index = 0;
+    atomic_store(&state_ptr->running, True);
+
+    for (u32 i = 1; i < thread_count; ++i) {
+        if (!kthread_create(job_thread_run, &state_ptr->threads[i], False, &state_ptr->threads[i].thread)) {
+            KFATAL("job_system_initialize - Failed to start worker thread %u.", i);
+            return False;
+        }
+    }
+
+    KINFO("Job system started with %u worker threads (%i logical cores).", worker_count, processor_count);
+    return True;
+}
+
+void job_system_shutdown(void* state) {
+    if (state_ptr) {
+        atomic_store(&state_ptr->running, False);
+
+        // Wake every worker so it sees the running flag, then wait for them to exit.
+        u32 worker_count = state_ptr->thread_count - 1;
+        for (u32 i = 0; i < worker_count; ++i) {
+            ksemaphore_signal(&state_ptr->work_semaphore);
+        }
+        for (u32 i = 1; i < state_ptr->thread_count; ++i) {
+            kthread_wait(&state_ptr->threads[i].thread);
+            kthread_destroy(&state_ptr->threads[i].thread);
+        }
+
+        ksemaphore_destroy(&state_ptr->work_semaphore);
+        kmutex_destroy(&state_ptr->waiting_mutex);
+        kmutex_destroy(&state_ptr->slot_mutex);
+
+        state_ptr = 0;
+    }
+}
+
+job_info job_create(pfn_job_entry entry_point, void* param_data, u32 param_data_size) {
+    return job_create_priority(entry_point, param_data, param_data_size, JOB_PRIORITY_NORMAL);
+}
+
+job_info job_create_priority(pfn_job_entry entry_point, void* param_data, u32 param_data_size, job_priority priority) {
+    job_info info;
+    kzero_memory(&info, sizeof(job_info));
+    info.entry_point = entry_point;
+    info.priority = priority < JOB_PRIORITY_COUNT ? priority : JOB_PRIORITY_NORMAL;
+
+    if (param_data_size > JOB_PARAM_DATA_MAX_SIZE) {
+        KERROR("job_create - param_data_size of %u exceeds the maximum of %u. Data will be truncated.", param_data_size, JOB_PARAM_DATA_MAX_SIZE);
+        param_data_size = JOB_PARAM_DATA_MAX_SIZE;
+    }
+    if (param_data && param_data_size) {
+        kcopy_memory(info.param_data, param_data, param_data_size);
+        info.param_data_size = param_data_size;
+    }
+
+    return info;
+}
+
+b8 job_system_submit(job_info info) {
+    if (!info.entry_point) {
+        KERROR("job_system_submit requires a job with an entry point.");
+        return False;
+    }
+
+    if (info.counter) {
+        atomic_fetch_add_explicit(&info.counter->value, 1, memory_order_relaxed);
+    }
+
+    if (!state_ptr || !atomic_load_explicit(&state_ptr->running, memory_order_acquire)) {
+        return job_run_inline(&info);
+    }
+
+    u32 job_index;
+    if (!slot_acquire(&job_index)) {
+        KWARN("job_system_submit - All %u job slots in use. Running job on the calling thread.", state_ptr->max_job_count);
+        return job_run_inline(&info);
+    }
+    kcopy_memory(&state_ptr->jobs[job_index], &info, sizeof(job_info));
+
+    if (info.dependency) {
+        // Check under the lock, so a counter reaching zero can't slip between the check and the park.
+        kmutex_lock(&state_ptr->waiting_mutex);
+        if (atomic_load_explicit(&info.dependency->value, memory_order_acquire) > 0) {
+            state_ptr->waiting_slots[state_ptr->waiting_slot_count] = job_index;
+            state_ptr->waiting_slot_count++;
+            kmutex_unlock(&state_ptr->waiting_mutex);
+            return True;
+        }
+        kmutex_unlock(&state_ptr->waiting_mutex);
+    }
+
+    job_enqueue(job_index);
+    return True;
+}
+
+void job_counter_wait(job_counter* counter) {
+    if (!counter) {
+        return;
+    }
+
+    while (atomic_load_explicit(&counter->value, memory_order_acquire) > 0) {
+        u32 job_index;
+        if (state_ptr && atomic_load_explicit(&state_ptr->running, memory_order_acquire) && job_find(thread_index, &job_index)) {
+            job_run(job_index);
+        } else {
+            kthread_yield();
+        }
+    }
+}
+
+b8 job_counter_is_done(job_counter* counter) {
+    return !counter || atomic_load_explicit(&counter->value, memory_order_acquire) <= 0;
+}
+
+u32 job_system_worker_count() {
+    return state_ptr ? state_ptr->thread_count - 1 : 0;
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "defines.h"
+
+#include <stdatomic.h>
+
+/**
+ * @file job_system.h
+ *
+ * @brief Work-stealing job system.
+ *
+ * Runs small units of work ("jobs") across one worker thread per logical core (less one for
+ * the main thread). Each thread owns a Chase-Lev deque per priority: the owner pushes and pops
+ * jobs at the bottom of its own deques, while idle threads steal from the top of everyone else's.
+ * Higher priorities are always drained (locally and by stealing) before lower ones.
+ *
+ * Jobs can be grouped and ordered with job counters:
+ * - A job's `counter` is incremented on submit and decremented when the job finishes, so a
+ *   counter shared by several jobs reaches zero once they are all done. It acts as a fence.
+ * - A job's `dependency` holds the job back until that counter reaches zero.
+ *
+ * Usage:
+ * - Initialize the job system with `job_system_initialize()`, providing configuration options.
+ * - Create jobs with `job_create()` / `job_create_priority()` and submit them with `job_system_submit()`.
+ * - Wait on a counter with `job_counter_wait()`, which runs jobs on the waiting thread until done.
+ * - Shutdown the job system with `job_system_shutdown()`.
+ *
+ * NOTE: Jobs may only be submitted from the thread that initialized the job system (the main
+ * thread) or from within a running job.
+ */
+
+/** @brief The maximum size, in bytes, of parameter data that can be copied into a job. */
+#define JOB_PARAM_DATA_MAX_SIZE 128
+
+/**
+ * @brief A function pointer to the entry point of a job. Invoked on a worker thread.
+ *
+ * @param param_data A pointer to the job's own copy of the parameter data passed at creation.
+ * @return True if the job succeeded; otherwise False.
+ */
+typedef b8 (*pfn_job_entry)(void* param_data);
+
+/**
+ * @enum job_priority
+ * @brief The priority of a job. Higher priority jobs are always picked up first.
+ */
+typedef enum job_priority {
+    /** @brief Work needed this frame, i.e. culling or animation. */
+    JOB_PRIORITY_HIGH = 0,
+    /** @brief General work. */
+    JOB_PRIORITY_NORMAL = 1,
+    /** @brief Background work, i.e. streaming or texture decoding. */
+    JOB_PRIORITY_LOW = 2,
+    /** @brief The number of priorities. Not a valid priority. */
+    JOB_PRIORITY_COUNT
+} job_priority;
+
+/**
+ * @struct job_counter
+ * @brief Counts outstanding jobs. Zero-initialize before first use.
+ */
+typedef struct job_counter {
+    /** @brief The number of submitted jobs that have not yet finished. */
+    _Atomic i32 value;
+} job_counter;
+
+/**
+ * @struct job_info
+ * @brief Describes a job to be run. Create with `job_create()`.
+ */
+typedef struct job_info {
+    /** @brief The function to be invoked when the job runs. */
+    pfn_job_entry entry_point;
+
+    /** @brief The priority of the job. */
+    job_priority priority;
+
+    /** @brief The size of the data in param_data. */
+    u32 param_data_size;
+
+    /** @brief A copy of the parameter data passed to the entry point. */
+    u8 param_data[JOB_PARAM_DATA_MAX_SIZE];
+
+    /** @brief Optional. Incremented on submit and decremented when the job finishes. */
+    job_counter* counter;
+
+    /** @brief Optional. The job does not start until this counter reaches zero. */
+    job_counter* dependency;
+} job_info;
+
+/**
+ * @struct job_system_config
+ * @brief Configuration for the job system.
+ */
+typedef struct job_system_config {
+    /** @brief The maximum number of worker threads. 0 uses one per logical core, less one for the main thread. */
+    u32 max_worker_count;
+
+    /** @brief The maximum number of jobs in flight (queued, waiting on a dependency, or running) at once. */
+    u32 max_job_count;
+} job_system_config;
+
+/**
+ * @brief Initializes the job system and starts its worker threads.
+ *
+ * Should be called twice; once with state = 0 to obtain the memory requirement, then a
+ * second time passing an allocated block of that size.
+ *
+ * @param memory_requirement A pointer to hold the memory requirement of the system.
+ * @param state A block of memory to hold the state, or 0 to only obtain the memory requirement.
+ * @param config The configuration for the system.
+ * @return True on success; otherwise False.
+ */
+b8 job_system_initialize(u64* memory_requirement, void* state, job_system_config config);
+
+/**
+ * @brief Stops all worker threads and shuts the job system down.
+ * Jobs that have not yet started are discarded.
+ *
+ * @param state A pointer to the system state.
+ */
+void job_system_shutdown(void* state);
+
+/**
+ * @brief Creates a job with normal priority.
+ *
+ * @param entry_point The function to be invoked when the job runs. Required.
+ * @param param_data Data to be copied into the job and passed to the entry point. Optional.
+ * @param param_data_size The size of param_data. Must not exceed JOB_PARAM_DATA_MAX_SIZE.
+ * @return The job description, ready to have its counter/dependency set and be submitted.
+ */
+KAPI job_info job_create(pfn_job_entry entry_point, void* param_data, u32 param_data_size);
+
+/**
+ * @brief Creates a job with the given priority.
+ *
+ * @param entry_point The function to be invoked when the job runs. Required.
+ * @param param_data Data to be copied into the job and passed to the entry point. Optional.
+ * @param param_data_size The size of param_data. Must not exceed JOB_PARAM_DATA_MAX_SIZE.
+ * @param priority The priority of the job.
+ * @return The job description, ready to have its counter/dependency set and be submitted.
+ */
+KAPI job_info job_create_priority(pfn_job_entry entry_point, void* param_data, u32 param_data_size, job_priority priority);
+
+/**
+ * @brief Submits a job to be run.
+ *
+ * If the job system is not running, or has no free job slots, the job is run immediately
+ * on the calling thread instead.
+ *
+ * @param info The job to submit.
+ * @return True if the job was queued or run; otherwise False.
+ */
+KAPI b8 job_system_submit(job_info info);
+
+/**
+ * @brief Blocks until the given counter reaches zero. The calling thread runs queued jobs
+ * while it waits rather than idling.
+ *
+ * @param counter A pointer to the counter to wait on.
+ */
+KAPI void job_counter_wait(job_counter* counter);
+
+/**
+ * @brief Indicates if all jobs tracked by the given counter have finished.
+ *
+ * @param counter A pointer to the counter to check.
+ * @return True if the counter is zero; otherwise False.
+ */
+KAPI b8 job_counter_is_done(job_counter* counter);
+
+/**
+ * @brief Obtains the number of worker threads the job system is running.
+ *
+ * @return The number of worker threads, or 0 if the job system is not running.
+ */
+KAPI u32 job_system_worker_count();
@@ -3,6 +3,7 @@
 #include "core/logger.h"
 #include "core/kstring.h"
 #include "containers/hashtable.h"
+#include "containers/handle_pool.h"
 #include "math/kmath.h"
 
 #include "renderer/renderer_frontend.h"
@@ -42,6 +43,9 @@ typedef struct material_system_state {
     /** Array of registered materials managed by the system. */
     material* registered_materials;
 
+    /** Hands out slots of registered_materials to references. */
+    handle_pool material_slots;
+
     /** Hashtable mapping material names to their indices in the registered_materials array. */
     hashtable registered_material_table;
 } material_system_state;
@@ -53,10 +57,12 @@ typedef struct material_system_state {
 typedef struct material_reference {
     /** Number of active references to the material. */
     u64 reference_count;
-    /** Unique handle identifying the material. */
-    u32 handle;
+    /** Handle to the material's slot. Goes stale once the material is released, even if the slot is reused. */
+    khandle handle;
     /** Auto-release flag indicating if the material should be automatically released when no longer referenced. */
     b8 auto_release;
+    /** Whether the material was acquired asynchronously and its configuration has yet to load. */
+    b8 loading;
 } material_reference;
 
 /** Pointer to the internal state of the material system. */
@@ -86,17 +92,44 @@ b8 load_material(material_config config, material* m);
  */
 void destroy_material(material* m);
 
+/**
+ * @brief Called when the configuration of an asynchronously acquired material has loaded.
+ */
+static void on_material_loaded(const char* name, const resource* r, void* listener);
+
+/**
+ * @brief Applies the properties of a loaded configuration to a material that already exists,
+ * swapping its diffuse map if the name changed, and bumps its generation.
+ *
+ * @param m Pointer to the material.
+ * @param config The loaded configuration.
+ */
+static void apply_config(material* m, const material_config* config);
+
+/**
+ * @brief Called when the file of a material changes on disk. Reloads the material if it is in use.
+ */
+static void on_material_file_changed(const char* name, void* listener);
+
+/**
+ * @brief Called when the configuration of a changed material has reloaded.
+ */
+static void on_material_reloaded(const char* name, const resource* r, void* listener);
+
 b8 material_system_initialize(u64* memory_requirement, void* state, material_system_config config) {
     if (config.max_material_count == 0) {
         KFATAL("material_system_initialize - config.max_material_count must be > 0.");
         return False;
     }
 
-    // Block of memory will contain state structure, then block for array, then block for hashtable.
+    // Block of memory will contain state structure, then block for array, then block for the
+    // slot pool, then block for hashtable.
     u64 struct_requirement = sizeof(material_system_state);
     u64 array_requirement = sizeof(material) * config.max_material_count;
+    u64 slots_requirement = 0;
+    handle_pool_create(config.max_material_count, &slots_requirement, 0, 0);
     u64 hashtable_requirement = sizeof(material_reference) * config.max_material_count;
-    *memory_requirement = struct_requirement + array_requirement + hashtable_requirement;
+    *memory_requirement = struct_requirement + array_requirement + slots_requirement + hashtable_requirement;
 
     if (!state) {
         return True;
@@ -109,8 +142,12 @@ b8 material_system_initialize(u64* memory_requirement, void* state, material_sys
     void* array_block = state + struct_requirement;
     state_ptr->registered_materials = array_block;
 
-    // Hashtable block is after array.
-    void* hashtable_block = array_block + array_requirement;
+    // Slot pool block is after array.
+    void* slots_block = array_block + array_requirement;
+    handle_pool_create(config.max_material_count, &slots_requirement, slots_block, &state_ptr->material_slots);
+
+    // Hashtable block is after the slot pool.
+    void* hashtable_block = slots_block + slots_requirement;
 
     // Create a hashtable for material lookups.
     hashtable_create(sizeof(material_reference), config.max_material_count, hashtable_block, False, &state_ptr->registered_material_table);
@@ -118,8 +155,9 @@ b8 material_system_initialize(u64* memory_requirement, void* state, material_sys
     // Fill the hashtable with invalid references to use as a default.
     material_reference invalid_ref;
     invalid_ref.auto_release = False;
-    invalid_ref.handle = INVALID_ID;  // Primary reason for needing default values.
+    invalid_ref.handle = KHANDLE_INVALID;  // Primary reason for needing default values.
     invalid_ref.reference_count = 0;
+    invalid_ref.loading = False;
     hashtable_fill(&state_ptr->registered_material_table, &invalid_ref);
 
     // Invalidate all materials in the array.
@@ -135,12 +173,17 @@ b8 material_system_initialize(u64* memory_requirement, void* state, material_sys
         return False;
     }
 
+    // Reload materials whose files are edited while running.
+    resource_system_register_change_listener(RESOURCE_TYPE_MATERIAL, on_material_file_changed, 0);
+
     return True;
 }
 
 void material_system_shutdown(void* state) {
     material_system_state* s = (material_system_state*)state;
     if (s) {
+        resource_system_unregister_change_listener(RESOURCE_TYPE_MATERIAL, on_material_file_changed, 0);
+
         // Invalidate all materials in the array.
         u32 count = s->config.max_material_count;
         for (u32 i = 0; i < count; ++i) {
@@ -151,6 +194,10 @@ void material_system_shutdown(void* state) {
 
         // Destroy the default material.
         destroy_material(&s->default_material);
+
+        // Release the lookup table's key copies and bookkeeping.
+        hashtable_destroy(&s->registered_material_table);
+        handle_pool_destroy(&s->material_slots);
     }
 
     state_ptr = 0;
@@ -180,6 +227,63 @@ material* material_system_acquire(const char* name) {
     return m;
 }
 
+material* material_system_acquire_async(const char* name) {
+    // Return default material.
+    if (strings_equali(name, DEFAULT_MATERIAL_NAME)) {
+        return &state_ptr->default_material;
+    }
+
+    material_reference ref;
+    if (!state_ptr || !hashtable_get(&state_ptr->registered_material_table, name, &ref)) {
+        KERROR("material_system_acquire_async failed to acquire material '%s'. Null pointer will be returned.", name);
+        return 0;
+    }
+
+    if (handle_pool_is_valid(&state_ptr->material_slots, ref.handle)) {
+        ref.reference_count++;
+        hashtable_set(&state_ptr->registered_material_table, name, &ref);
+        KTRACE("Material '%s' already exists, ref_count increased to %i.", name, ref.reference_count);
+        return &state_ptr->registered_materials[handle_pool_index(ref.handle)];
+    }
+
+    // Take a free slot.
+    if (!handle_pool_acquire(&state_ptr->material_slots, &ref.handle)) {
+        KFATAL("material_system_acquire_async - Material system cannot hold anymore materials. Adjust configuration to allow more.");
+        return 0;
+    }
+    material* m = &state_ptr->registered_materials[handle_pool_index(ref.handle)];
+
+    // Stand in as the default material until the configuration arrives.
+    kzero_memory(m, sizeof(material));
+    string_ncopy(m->name, name, MATERIAL_NAME_MAX_LENGTH);
+    m->diffuse_color = vec4_one();
+    m->diffuse_map.use = TEXTURE_USE_MAP_DIFFUSE;
+    m->diffuse_map.texture = texture_system_get_default_texture();
+    if (!renderer_create_material(m)) {
+        KERROR("Failed to acquire renderer resources for material '%s'.", name);
+        m->id = INVALID_ID;
+        handle_pool_release(&state_ptr->material_slots, ref.handle);
+        return 0;
+    }
+    m->generation = 0;
+    m->id = handle_pool_index(ref.handle);
+
+    // Material files are auto-released unless they say otherwise, which is applied once loaded.
+    ref.reference_count = 1;
+    ref.auto_release = True;
+    ref.loading = True;
+    hashtable_set(&state_ptr->registered_material_table, name, &ref);
+
+    if (!resource_system_load_async(name, RESOURCE_TYPE_MATERIAL, on_material_loaded, 0)) {
+        KWARN("Unable to request material '%s', the default properties will be used.", name);
+        ref.loading = False;
+        hashtable_set(&state_ptr->registered_material_table, name, &ref);
+    }
+
+    KTRACE("Material '%s' requested, and ref_count is now %i.", name, ref.reference_count);
+    return m;
+}
+
 material* material_system_acquire_from_config(material_config config) {
     // Return default material.
     if (strings_equali(config.name, DEFAULT_MATERIAL_NAME)) {
@@ -195,30 +299,19 @@ material* material_system_acquire_from_config(material_config config) {
 
         ref.reference_count++;
 
-        if (ref.handle == INVALID_ID) {
-            // This means no material exists here. Find a free index first.
-            u32 count = state_ptr->config.max_material_count;
-            material* m = 0;
-
-            for (u32 i = 0; i < count; ++i) {
-                if (state_ptr->registered_materials[i].id == INVALID_ID) {
-                    // A free slot has been found. Use its index as the handle.
-                    ref.handle = i;
-                    m = &state_ptr->registered_materials[i];
-
-                    break;
-                }
-            }
-
-            // Make sure an empty slot was actually found.
-            if (!m || ref.handle == INVALID_ID) {
+        if (!handle_pool_is_valid(&state_ptr->material_slots, ref.handle)) {
+            // This means no material exists here. Take a free slot.
+            if (!handle_pool_acquire(&state_ptr->material_slots, &ref.handle)) {
                 KFATAL("material_system_acquire - Material system cannot hold anymore materials. Adjust configuration to allow more.");
                 return 0;
             }
+            material* m = &state_ptr->registered_materials[handle_pool_index(ref.handle)];
 
             // Create new material.
             if (!load_material(config, m)) {
                 KERROR("Failed to load material '%s'.", config.name);
+                m->id = INVALID_ID;
+                handle_pool_release(&state_ptr->material_slots, ref.handle);
                 return 0;
             }
 
@@ -228,8 +321,8 @@ material* material_system_acquire_from_config(material_config config) {
                 m->generation++;
             }
 
-            // Also use the handle as the material id.
-            m->id = ref.handle;
+            // Also use the slot index as the material id.
+            m->id = handle_pool_index(ref.handle);
             KTRACE("Material '%s' does not yet exist. Created, and ref_count is now %i.", config.name, ref.reference_count);
         } else {
             KTRACE("Material '%s' already exists, ref_count increased to %i.", config.name, ref.reference_count);
@@ -237,7 +330,7 @@ material* material_system_acquire_from_config(material_config config) {
 
         // Update the entry.
         hashtable_set(&state_ptr->registered_material_table, config.name, &ref);
-        return &state_ptr->registered_materials[ref.handle];
+        return &state_ptr->registered_materials[handle_pool_index(ref.handle)];
     }
 
     // NOTE: This would only happen in the event something went wrong with the state.
@@ -258,23 +351,29 @@ void material_system_release(const char* name) {
             return;
         }
 
+        // Take a copy of the name since it will be wiped out by destroy,
+        // (as passed in name is generally a pointer to the actual material's name).
+        char name_copy[MATERIAL_NAME_MAX_LENGTH];
+        string_ncopy(name_copy, name, MATERIAL_NAME_MAX_LENGTH);
+
         ref.reference_count--;
         if (ref.reference_count == 0 && ref.auto_release) {
-            material* m = &state_ptr->registered_materials[ref.handle];
+            material* m = &state_ptr->registered_materials[handle_pool_index(ref.handle)];
 
-            // Destroy/reset material.
+            // Destroy/reset material, and free its slot.
             destroy_material(m);
+            handle_pool_release(&state_ptr->material_slots, ref.handle);
 
-            // Reset the reference.
-            ref.handle = INVALID_ID;
-            ref.auto_release = False;
-            KTRACE("Released material '%s'., Material unloaded because reference count=0 and auto_release=true.", name);
-        } else {
-            KTRACE("Released material '%s', now has a reference count of '%i' (auto_release=%s).", name, ref.reference_count, ref.auto_release ? "true" : "false");
+            // Remove the entry, so the name no longer takes up a slot in the table.
+            hashtable_remove(&state_ptr->registered_material_table, name_copy);
+            KTRACE("Released material '%s'., Material unloaded because reference count=0 and auto_release=true.", name_copy);
+            return;
         }
 
+        KTRACE("Released material '%s', now has a reference count of '%i' (auto_release=%s).", name_copy, ref.reference_count, ref.auto_release ? "true" : "false");
+
         // Update the entry.
-        hashtable_set(&state_ptr->registered_material_table, name, &ref);
+        hashtable_set(&state_ptr->registered_material_table, name_copy, &ref);
     } else {
         KERROR("material_system_release failed to release material '%s'.", name);
     }
@@ -334,6 +433,88 @@ void destroy_material(material* m) {
     m->internal_id = INVALID_ID;
 }
 
+static void on_material_loaded(const char* name, const resource* r, void* listener) {
+    // The material may have been released, and its slot reused, while it was loading.
+    material_reference ref;
+    if (!state_ptr || !hashtable_get(&state_ptr->registered_material_table, name, &ref) || !handle_pool_is_valid(&state_ptr->material_slots, ref.handle) || !ref.loading) {
+        return;
+    }
+    ref.loading = False;
+    material* m = &state_ptr->registered_materials[handle_pool_index(ref.handle)];
+
+    if (r) {
+        const material_config* config = r->data;
+        ref.auto_release = config->auto_release;
+        apply_config(m, config);
+        KTRACE("Material '%s' loaded and swapped in.", name);
+    } else {
+        KWARN("Unable to load material '%s', the default properties will be used.", name);
+    }
+
+    hashtable_set(&state_ptr->registered_material_table, name, &ref);
+}
+
+static void apply_config(material* m, const material_config* config) {
+    m->diffuse_color = config->diffuse_color;
+
+    // The default texture is not reference counted.
+    texture* old_map = m->diffuse_map.texture;
+    b8 owns_old_map = old_map && old_map != texture_system_get_default_texture();
+
+    if (string_length(config->diffuse_map_name) > 0) {
+        // An unchanged map is kept. If its image changed too, the texture system reloads it.
+        if (!owns_old_map || !strings_equali(old_map->name, config->diffuse_map_name)) {
+            texture* t = texture_system_acquire_async(config->diffuse_map_name, True);
+            if (t) {
+                m->diffuse_map.use = TEXTURE_USE_MAP_DIFFUSE;
+                m->diffuse_map.texture = t;
+                // Released after the new map is acquired, so a shared texture is not unloaded and reloaded.
+                if (owns_old_map) {
+                    texture_system_release(old_map->name);
+                }
+            } else {
+                KWARN("Unable to load texture '%s' for material '%s', using default.", config->diffuse_map_name, m->name);
+            }
+        }
+    } else if (owns_old_map) {
+        m->diffuse_map.texture = texture_system_get_default_texture();
+        texture_system_release(old_map->name);
+    }
+
+    // Have the renderer pick up the new properties.
+    m->generation++;
+}
+
+static void on_material_file_changed(const char* name, void* listener) {
+    // Materials are found by the name they were acquired with, which is their file name unless
+    // they were acquired from a configuration naming them otherwise.
+    material_reference ref;
+    if (!state_ptr || !hashtable_get(&state_ptr->registered_material_table, name, &ref) || !handle_pool_is_valid(&state_ptr->material_slots, ref.handle)) {
+        return;
+    }
+
+    if (!resource_system_load_async(name, RESOURCE_TYPE_MATERIAL, on_material_reloaded, 0)) {
+        KWARN("Unable to request a reload of material '%s'.", name);
+    }
+}
+
+static void on_material_reloaded(const char* name, const resource* r, void* listener) {
+    // The material may have been released while it was loading. One still loading for the first
+    // time picks the change up itself.
+    material_reference ref;
+    if (!state_ptr || !hashtable_get(&state_ptr->registered_material_table, name, &ref) || !handle_pool_is_valid(&state_ptr->material_slots, ref.handle) || ref.loading) {
+        return;
+    }
+
+    if (!r) {
+        KWARN("Unable to reload material '%s', the current properties will be kept.", name);
+        return;
+    }
+
+    apply_config(&state_ptr->registered_materials[handle_pool_index(ref.handle)], r->data);
+    KINFO("Material '%s' reloaded.", name);
+}
+
 b8 create_default_material(material_system_state* state) {
     kzero_memory(&state->default_material, sizeof(material));
 
@@ -16,6 +16,8 @@
  * - Initialize the material system with `material_system_initialize()`, providing configuration options.
  * - Acquire materials by name using `material_system_acquire()`. If the material is not
  * already loaded, it will be created with default properties.
+ * - Acquire materials without waiting for them to load using `material_system_acquire_async()`.
+ * The material looks like the default material until its configuration has loaded.
  * - Release materials using `material_system_release()`. If a material was marked for auto-release,
  * it will be freed when no longer in use.
  * - Shutdown the material system with `material_system_shutdown()` to free all resources.
@@ -63,6 +65,20 @@ void material_system_shutdown(void* state);
  */
 material* material_system_acquire(const char* name);
 
+/**
+ * @brief Acquires a material by name, loading its configuration on a worker thread if it is
+ * not already loaded.
+ *
+ * Until the configuration has loaded, the material has the properties of the default material.
+ * Once it has, during `resource_system_update()`, its properties are updated in place and its
+ * generation is incremented, and its textures are acquired with `texture_system_acquire_async()`.
+ * If the configuration fails to load, the material keeps the default properties.
+ *
+ * @param name Name of the material to acquire.
+ * @return Pointer to the acquired material, or `NULL` if acquisition failed.
+ */
+material* material_system_acquire_async(const char* name);
+
 /**
  * @brief Acquires a material based on the provided configuration.
  *
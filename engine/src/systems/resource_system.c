@@ -2,6 +2,12 @@
 
 #include "core/logger.h"
 #include "core/kstring.h"
+#include "core/kmemory.h"
+#include "systems/job_system.h"
+#include "platform/filesystem.h"
+#include "platform/platform.h"
+
+#include <stdatomic.h>
 
 // Known resource loaders.
 #include "resources/loaders/text_loader.h"
@@ -16,7 +22,117 @@
  *
  * This module implements the functions defined in `resource_system.h`.
  * It manages the loading, unloading, and registration of resources.
+ *
+ * Asynchronous loads live in a fixed array of requests. A request is handed to a worker as a
+ * job, which runs the loader and publishes the result by setting the request's status. Only
+ * the main thread touches a request's waiters, or frees it once its callbacks have run.
+ *
+ * The archive is mounted before any loader runs and is only read afterward, so loaders on
+ * worker threads can share it without locking.
+ *
+ * Changed files are held as pending changes until RESOURCE_CHANGE_SETTLE_TIME passes without
+ * another write, since editors often save a file in several writes, or as a copy followed by a
+ * move. Only then are the listeners told, so each save reloads a resource once.
+ */
+
+/** @brief The longest resource name an asynchronous load accepts, including the terminator. */
+#define RESOURCE_NAME_MAX_LENGTH 256
+
+/** @brief The number of callbacks that can wait on each asynchronous load, on average. */
+#define RESOURCE_WAITERS_PER_LOAD 4
+
+/** @brief The number of changed files that can wait to settle at once. */
+#define RESOURCE_MAX_PENDING_CHANGES 64
+
+/** @brief The number of functions that can listen for changed resources. */
+#define RESOURCE_MAX_CHANGE_LISTENERS 16
+
+/** @brief How long in seconds a changed file must go without another write before it is reported. */
+#define RESOURCE_CHANGE_SETTLE_TIME 0.1
+
+/**
+ * @enum resource_load_status
+ * @brief The stages of an asynchronous load.
+ */
+typedef enum resource_load_status {
+    /** The request is not in use. */
+    RESOURCE_LOAD_FREE,
+    /** The loader has been queued, or is running. */
+    RESOURCE_LOAD_PENDING,
+    /** The loader has finished, and the callbacks have yet to run. */
+    RESOURCE_LOAD_DONE,
+    /** The callbacks are running. New requests for the name start a new load. */
+    RESOURCE_LOAD_DISPATCHING
+} resource_load_status;
+
+/**
+ * @struct resource_load_request
+ * @brief An asynchronous load, shared by every request for the same resource while it runs.
+ */
+typedef struct resource_load_request {
+    /** The resource_load_status. Written with release order once the loader finishes. */
+    _Atomic u32 status;
+    /** Whether the loader succeeded. Written by the worker before the status. */
+    b8 success;
+    /** The loader to use. */
+    resource_loader* loader;
+    /** The name of the resource. */
+    char name[RESOURCE_NAME_MAX_LENGTH];
+    /** The loaded resource. Written by the worker before the status. */
+    resource result;
+    /** The first waiter to call back, or INVALID_ID. */
+    u32 first_waiter;
+    /** The last waiter to call back, or INVALID_ID. */
+    u32 last_waiter;
+} resource_load_request;
+
+/**
+ * @struct resource_load_waiter
+ * @brief A callback waiting on an asynchronous load.
+ */
+typedef struct resource_load_waiter {
+    /** The function to call, or 0 if the waiter is free. */
+    pfn_resource_loaded callback;
+    /** Passed to the callback. */
+    void* listener;
+    /** The next waiter on the same load, or INVALID_ID. */
+    u32 next;
+} resource_load_waiter;
+
+/**
+ * @struct resource_load_job_params
+ * @brief The parameters of the job that runs an asynchronous load.
+ */
+typedef struct resource_load_job_params {
+    /** The request to load. */
+    resource_load_request* request;
+} resource_load_job_params;
+
+/**
+ * @struct resource_change
+ * @brief A changed resource, waiting for its file to settle.
+ */
+typedef struct resource_change {
+    /** The loader whose type path the file is under. */
+    resource_loader* loader;
+    /** The name of the resource. */
+    char name[RESOURCE_NAME_MAX_LENGTH];
+    /** When the file was last written. */
+    f64 last_write_time;
+} resource_change;
+
+/**
+ * @struct resource_change_listener
+ * @brief A function listening for changed resources of a type.
  */
+typedef struct resource_change_listener {
+    /** The type of resource. */
+    resource_type type;
+    /** The function to call, or 0 if the listener is free. */
+    pfn_resource_changed callback;
+    /** Passed to the callback. */
+    void* listener;
+} resource_change_listener;
 
 /**
  * @struct resource_system_state
@@ -28,6 +144,26 @@ typedef struct resource_system_state {
     resource_system_config config;
     /** Array of registered loaders. */
     resource_loader* registered_loaders;
+    /** Array of asynchronous loads, config.max_async_load_count long. */
+    resource_load_request* requests;
+    /** Array of callbacks waiting on asynchronous loads. */
+    resource_load_waiter* waiters;
+    /** The length of the waiters array. */
+    u32 waiter_count;
+    /** Whether an archive is mounted. */
+    b8 archive_mounted;
+    /** The mounted archive, if archive_mounted is set. */
+    kpak archive;
+    /** Whether the base path is being watched. */
+    b8 watching;
+    /** The watch on the base path, if watching is set. */
+    file_watch watch;
+    /** Changed resources waiting for their files to settle. */
+    resource_change pending_changes[RESOURCE_MAX_PENDING_CHANGES];
+    /** The number of pending changes. */
+    u32 pending_change_count;
+    /** Functions listening for changed resources. */
+    resource_change_listener change_listeners[RESOURCE_MAX_CHANGE_LISTENERS];
 } resource_system_state;
 
 /**
@@ -45,23 +181,58 @@ static resource_system_state* state_ptr = 0;
  */
 static b8 load(const char* name, resource_loader* loader, resource* out_resource);
 
+/**
+ * @brief Finds the loader registered for a built-in resource type.
+ *
+ * @param type The type of resource.
+ * @return A pointer to the loader, or 0 if none is registered.
+ */
+static resource_loader* find_loader(resource_type type);
+
+/**
+ * @brief Records a file written under the base path as a pending change to its resource.
+ *
+ * @param path The path of the file, relative to the base path.
+ * @param listener Unused.
+ */
+static void on_file_changed(const char* path, void* listener);
+
+/**
+ * @brief Reports every pending change whose file has settled to its listeners.
+ */
+static void dispatch_settled_changes();
+
 b8 resource_system_initialize(u64* memory_requirement, void* state, resource_system_config config) {
     if (config.max_loader_count == 0) {
         KFATAL("resource_system_initialize failed because config.max_loader_count==0.");
         return False;
     }
 
-    *memory_requirement = sizeof(resource_system_state) + (sizeof(resource_loader) * config.max_loader_count);
+    if (config.max_async_load_count == 0) {
+        KFATAL("resource_system_initialize failed because config.max_async_load_count==0.");
+        return False;
+    }
+
+    // Block of memory will contain state structure, then the loaders, then the requests and their waiters.
+    u32 waiter_count = config.max_async_load_count * RESOURCE_WAITERS_PER_LOAD;
+    u64 loader_requirement = sizeof(resource_loader) * config.max_loader_count;
+    u64 request_requirement = sizeof(resource_load_request) * config.max_async_load_count;
+    u64 waiter_requirement = sizeof(resource_load_waiter) * waiter_count;
+    *memory_requirement = sizeof(resource_system_state) + loader_requirement + request_requirement + waiter_requirement;
 
     if (!state) {
         return True;
     }
 
+    kzero_memory(state, *memory_requirement);
     state_ptr = state;
     state_ptr->config = config;
 
     void* array_block = state + sizeof(resource_system_state);
     state_ptr->registered_loaders = array_block;
+    state_ptr->requests = array_block + loader_requirement;
+    state_ptr->waiters = array_block + loader_requirement + request_requirement;
+    state_ptr->waiter_count = waiter_count;
 
     // Invalidate all loaders
     u32 count = config.max_loader_count;
@@ -69,11 +240,34 @@ b8 resource_system_initialize(u64* memory_requirement, void* state, resource_sys
         state_ptr->registered_loaders[i].id = INVALID_ID;
     }
 
+    if (config.archive_path && filesystem_exists(config.archive_path)) {
+        state_ptr->archive_mounted = kpak_open(config.archive_path, &state_ptr->archive);
+        if (state_ptr->archive_mounted) {
+            KINFO("Resource system mounted archive '%s'.", config.archive_path);
+        } else {
+            KWARN("Unable to mount archive '%s'. Loading loose files instead.", config.archive_path);
+        }
+    }
+
+    if (config.watch_for_changes) {
+        if (state_ptr->archive_mounted) {
+            KINFO("Assets are served from an archive, so '%s' is not watched for changes.", config.asset_base_path);
+        } else {
+            state_ptr->watching = filesystem_watch_create(config.asset_base_path, &state_ptr->watch);
+            if (state_ptr->watching) {
+                KINFO("Watching '%s' for changed assets.", config.asset_base_path);
+            }
+        }
+    }
+
     // NOTE: Auto-register known loader types here.
-    resource_system_register_loader(text_resource_loader_create());
-    resource_system_register_loader(binary_resource_loader_create());
-    resource_system_register_loader(image_resource_loader_create());
-    resource_system_register_loader(material_resource_loader_create());
+    if (!resource_system_register_loader(text_resource_loader_create()) ||
+        !resource_system_register_loader(binary_resource_loader_create()) ||
+        !resource_system_register_loader(image_resource_loader_create()) ||
+        !resource_system_register_loader(material_resource_loader_create())) {
+        KERROR("resource_system_initialize failed to register the built-in loaders.");
+        return False;
+    }
 
     KINFO("Resource system initialized with base path '%s'.", config.asset_base_path);
 
@@ -82,6 +276,36 @@ b8 resource_system_initialize(u64* memory_requirement, void* state, resource_sys
 
 void resource_system_shutdown(void* state) {
     if (state_ptr) {
+        // Loads that finished but were never dispatched still own their data. Queued loads never run
+        // once the job system has stopped.
+        for (u32 i = 0; i < state_ptr->config.max_async_load_count; ++i) {
+            resource_load_request* request = &state_ptr->requests[i];
+            u32 status = atomic_load_explicit(&request->status, memory_order_acquire);
+            if (status == RESOURCE_LOAD_DONE && request->success && request->loader->unload) {
+                request->loader->unload(request->loader, &request->result);
+            } else if (status == RESOURCE_LOAD_PENDING) {
+                KWARN("resource_system_shutdown - Load of '%s' was still pending.", request->name);
+            }
+        }
+
+        // Give loaders a chance to release anything they own.
+        u32 count = state_ptr->config.max_loader_count;
+        for (u32 i = 0; i < count; ++i) {
+            resource_loader* l = &state_ptr->registered_loaders[i];
+            if (l->id != INVALID_ID && l->shutdown) {
+                l->shutdown(l);
+            }
+        }
+
+        if (state_ptr->watching) {
+            filesystem_watch_destroy(&state_ptr->watch);
+            state_ptr->watching = False;
+        }
+
+        if (state_ptr->archive_mounted) {
+            kpak_close(&state_ptr->archive);
+            state_ptr->archive_mounted = False;
+        }
         state_ptr = 0;
     }
 }
@@ -96,7 +320,7 @@ b8 resource_system_register_loader(resource_loader loader) {
                 if (l->type == loader.type) {
                     KERROR("resource_system_register_loader - Loader of type %d already exists and will not be registered.", loader.type);
                     return False;
-                } else if (loader.custom_type && string_length(loader.custom_type) > 0 && strings_equali(l->custom_type, loader.custom_type)) {
+                } else if (loader.custom_type && string_length(loader.custom_type) > 0 && l->custom_type && strings_equali(l->custom_type, loader.custom_type)) {
                     KERROR("resource_system_register_loader - Loader of custom type %s already exists and will not be registered.", loader.custom_type);
                     return False;
                 }
@@ -104,8 +328,14 @@ b8 resource_system_register_loader(resource_loader loader) {
         }
         for (u32 i = 0; i < count; ++i) {
             if (state_ptr->registered_loaders[i].id == INVALID_ID) {
-                state_ptr->registered_loaders[i] = loader;
-                state_ptr->registered_loaders[i].id = i;
+                resource_loader* l = &state_ptr->registered_loaders[i];
+                *l = loader;
+                if (l->initialize && !l->initialize(l)) {
+                    KERROR("resource_system_register_loader - Loader of type %d failed to initialize and will not be registered.", loader.type);
+                    l->id = INVALID_ID;
+                    return False;
+                }
+                l->id = i;
                 KTRACE("Loader registered.");
                 return True;
             }
@@ -116,15 +346,9 @@ b8 resource_system_register_loader(resource_loader loader) {
 }
 
 b8 resource_system_load(const char* name, resource_type type, resource* out_resource) {
-    if (state_ptr && type != RESOURCE_TYPE_CUSTOM) {
-        // Select loader.
-        u32 count = state_ptr->config.max_loader_count;
-        for (u32 i = 0; i < count; ++i) {
-            resource_loader* l = &state_ptr->registered_loaders[i];
-            if (l->id != INVALID_ID && l->type == type) {
-                return load(name, l, out_resource);
-            }
-        }
+    resource_loader* l = find_loader(type);
+    if (l) {
+        return load(name, l, out_resource);
     }
 
     out_resource->loader_id = INVALID_ID;
@@ -149,6 +373,169 @@ b8 resource_system_load_custom(const char* name, const char* custom_type, resour
     return False;
 }
 
+/** @brief Runs the loader of an asynchronous load on a worker thread. */
+static b8 resource_load_job(void* param_data) {
+    resource_load_job_params* params = param_data;
+    resource_load_request* request = params->request;
+
+    request->result.loader_id = request->loader->id;
+    request->success = request->loader->load(request->loader, request->name, &request->result);
+
+    // Publish the result to the main thread.
+    atomic_store_explicit(&request->status, RESOURCE_LOAD_DONE, memory_order_release);
+    return request->success;
+}
+
+b8 resource_system_load_async(const char* name, resource_type type, pfn_resource_loaded callback, void* listener) {
+    if (!state_ptr || !name || !callback) {
+        KERROR("resource_system_load_async requires an initialized system, a name and a callback.");
+        return False;
+    }
+    if (string_length(name) >= RESOURCE_NAME_MAX_LENGTH) {
+        KERROR("resource_system_load_async - Name '%s' is longer than the maximum of %u characters.", name, RESOURCE_NAME_MAX_LENGTH - 1);
+        return False;
+    }
+
+    resource_loader* loader = find_loader(type);
+    if (!loader || !loader->load) {
+        KERROR("resource_system_load_async - No loader for type %d was found.", type);
+        return False;
+    }
+
+    u32 waiter_index = INVALID_ID;
+    for (u32 i = 0; i < state_ptr->waiter_count; ++i) {
+        if (!state_ptr->waiters[i].callback) {
+            waiter_index = i;
+            break;
+        }
+    }
+    if (waiter_index == INVALID_ID) {
+        KERROR("resource_system_load_async - Too many callbacks are waiting on loads. Adjust configuration to allow more.");
+        return False;
+    }
+
+    // Join a load of the same resource that is already in flight, or start a new one.
+    resource_load_request* request = 0;
+    resource_load_request* free_request = 0;
+    for (u32 i = 0; i < state_ptr->config.max_async_load_count; ++i) {
+        resource_load_request* r = &state_ptr->requests[i];
+        u32 status = atomic_load_explicit(&r->status, memory_order_acquire);
+        if (status == RESOURCE_LOAD_FREE) {
+            if (!free_request) {
+                free_request = r;
+            }
+        } else if (status != RESOURCE_LOAD_DISPATCHING && r->loader == loader && strings_equal(r->name, name)) {
+            request = r;
+            break;
+        }
+    }
+
+    b8 start = False;
+    if (!request) {
+        if (!free_request) {
+            KERROR("resource_system_load_async - Too many loads are in flight. Adjust configuration to allow more.");
+            return False;
+        }
+        request = free_request;
+        kzero_memory(&request->result, sizeof(resource));
+        request->success = False;
+        request->loader = loader;
+        string_ncopy(request->name, name, RESOURCE_NAME_MAX_LENGTH);
+        request->first_waiter = INVALID_ID;
+        request->last_waiter = INVALID_ID;
+        atomic_store_explicit(&request->status, RESOURCE_LOAD_PENDING, memory_order_relaxed);
+        start = True;
+    }
+
+    resource_load_waiter* waiter = &state_ptr->waiters[waiter_index];
+    waiter->callback = callback;
+    waiter->listener = listener;
+    waiter->next = INVALID_ID;
+    if (request->last_waiter == INVALID_ID) {
+        request->first_waiter = waiter_index;
+    } else {
+        state_ptr->waiters[request->last_waiter].next = waiter_index;
+    }
+    request->last_waiter = waiter_index;
+
+    if (start) {
+        resource_load_job_params params;
+        params.request = request;
+        job_system_submit(job_create_priority(resource_load_job, &params, sizeof(resource_load_job_params), JOB_PRIORITY_LOW));
+    }
+    return True;
+}
+
+void resource_system_update() {
+    if (!state_ptr) {
+        return;
+    }
+
+    for (u32 i = 0; i < state_ptr->config.max_async_load_count; ++i) {
+        resource_load_request* request = &state_ptr->requests[i];
+        if (atomic_load_explicit(&request->status, memory_order_acquire) != RESOURCE_LOAD_DONE) {
+            continue;
+        }
+
+        // Callbacks may request the same resource again, which must start a new load rather than join this one.
+        atomic_store_explicit(&request->status, RESOURCE_LOAD_DISPATCHING, memory_order_relaxed);
+        if (!request->success) {
+            KERROR("resource_system_update - Failed to load '%s'.", request->name);
+        }
+
+        u32 waiter_index = request->first_waiter;
+        while (waiter_index != INVALID_ID) {
+            resource_load_waiter* waiter = &state_ptr->waiters[waiter_index];
+            waiter->callback(request->name, request->success ? &request->result : 0, waiter->listener);
+            waiter_index = waiter->next;
+            waiter->callback = 0;
+        }
+
+        if (request->success && request->loader->unload) {
+            request->loader->unload(request->loader, &request->result);
+        }
+        atomic_store_explicit(&request->status, RESOURCE_LOAD_FREE, memory_order_relaxed);
+    }
+
+    if (state_ptr->watching) {
+        filesystem_watch_poll(&state_ptr->watch, on_file_changed, 0);
+        dispatch_settled_changes();
+    }
+}
+
+b8 resource_system_register_change_listener(resource_type type, pfn_resource_changed callback, void* listener) {
+    if (!state_ptr || !callback) {
+        return False;
+    }
+
+    for (u32 i = 0; i < RESOURCE_MAX_CHANGE_LISTENERS; ++i) {
+        resource_change_listener* l = &state_ptr->change_listeners[i];
+        if (!l->callback) {
+            l->type = type;
+            l->callback = callback;
+            l->listener = listener;
+            return True;
+        }
+    }
+
+    KERROR("resource_system_register_change_listener - No room for more than %u listeners.", RESOURCE_MAX_CHANGE_LISTENERS);
+    return False;
+}
+
+void resource_system_unregister_change_listener(resource_type type, pfn_resource_changed callback, void* listener) {
+    if (!state_ptr) {
+        return;
+    }
+
+    for (u32 i = 0; i < RESOURCE_MAX_CHANGE_LISTENERS; ++i) {
+        resource_change_listener* l = &state_ptr->change_listeners[i];
+        if (l->callback == callback && l->listener == listener && l->type == type) {
+            kzero_memory(l, sizeof(resource_change_listener));
+            return;
+        }
+    }
+}
+
 void resource_system_unload(resource* resource) {
     if (state_ptr && resource) {
         if (resource->loader_id != INVALID_ID) {
@@ -160,6 +547,35 @@ void resource_system_unload(resource* resource) {
     }
 }
 
+b8 resource_system_read_packed(const resource_loader* loader, const char* name, const char* extension, kpak_data* out_data) {
+    if (!state_ptr || !state_ptr->archive_mounted || !loader || !name) {
+        return False;
+    }
+
+    char path[512];
+    if (loader->type_path && loader->type_path[0]) {
+        string_format(path, "%s/%s%s", loader->type_path, name, extension);
+    } else {
+        string_format(path, "%s%s", name, extension);
+    }
+
+    const kpak_entry* entry = kpak_find(&state_ptr->archive, path);
+    if (!entry) {
+        return False;
+    }
+    return kpak_read(&state_ptr->archive, entry, out_data);
+}
+
+b8 resource_system_is_packed(const void* data) {
+    if (!state_ptr || !state_ptr->archive_mounted) {
+        return False;
+    }
+
+    // Inclusive of the end, where an empty file at the end of the archive points.
+    const u8* begin = state_ptr->archive.mapping.memory;
+    return (const u8*)data >= begin && (const u8*)data <= begin + state_ptr->archive.mapping.size;
+}
+
 const char* resource_system_base_path() {
     if (state_ptr) {
         return state_ptr->config.asset_base_path;
@@ -169,6 +585,19 @@ const char* resource_system_base_path() {
     return "";
 }
 
+static resource_loader* find_loader(resource_type type) {
+    if (state_ptr && type != RESOURCE_TYPE_CUSTOM) {
+        u32 count = state_ptr->config.max_loader_count;
+        for (u32 i = 0; i < count; ++i) {
+            resource_loader* l = &state_ptr->registered_loaders[i];
+            if (l->id != INVALID_ID && l->type == type) {
+                return l;
+            }
+        }
+    }
+    return 0;
+}
+
 static b8 load(const char* name, resource_loader* loader, resource* out_resource) {
     if (!name || !loader || !loader->load || !out_resource) {
         out_resource->loader_id = INVALID_ID;
@@ -177,4 +606,82 @@ static b8 load(const char* name, resource_loader* loader, resource* out_resource
 
     out_resource->loader_id = loader->id;
     return loader->load(loader, name, out_resource);
-}
\ No newline at end of file
+}
+
+static void on_file_changed(const char* path, void* listener) {
+    // Find the loader with the longest type path the file is under.
+    resource_loader* loader = 0;
+    u64 type_path_length = 0;
+    for (u32 i = 0; i < state_ptr->config.max_loader_count; ++i) {
+        resource_loader* l = &state_ptr->registered_loaders[i];
+        if (l->id == INVALID_ID || !l->type_path) {
+            continue;
+        }
+        u64 length = string_length(l->type_path);
+        b8 under = length > type_path_length;
+        for (u64 c = 0; under && c < length; ++c) {
+            under = path[c] == l->type_path[c];
+        }
+        if (under && path[length] == '/') {
+            loader = l;
+            type_path_length = length;
+        }
+    }
+    if (!loader) {
+        return;
+    }
+
+    // The name is the rest of the path, without the extension.
+    char name[RESOURCE_NAME_MAX_LENGTH];
+    string_ncopy(name, path + type_path_length + 1, RESOURCE_NAME_MAX_LENGTH);
+    name[RESOURCE_NAME_MAX_LENGTH - 1] = 0;
+    for (i64 i = (i64)string_length(name) - 1; i >= 0 && name[i] != '/'; --i) {
+        if (name[i] == '.') {
+            name[i] = 0;
+            break;
+        }
+    }
+    if (!name[0]) {
+        return;
+    }
+
+    f64 now = platform_get_absolute_time();
+    for (u32 i = 0; i < state_ptr->pending_change_count; ++i) {
+        resource_change* change = &state_ptr->pending_changes[i];
+        if (change->loader == loader && strings_equal(change->name, name)) {
+            change->last_write_time = now;
+            return;
+        }
+    }
+
+    if (state_ptr->pending_change_count == RESOURCE_MAX_PENDING_CHANGES) {
+        KWARN("Too many assets changed at once; the change to '%s' was dropped.", path);
+        return;
+    }
+    resource_change* change = &state_ptr->pending_changes[state_ptr->pending_change_count++];
+    change->loader = loader;
+    string_ncopy(change->name, name, RESOURCE_NAME_MAX_LENGTH);
+    change->last_write_time = now;
+}
+
+static void dispatch_settled_changes() {
+    f64 now = platform_get_absolute_time();
+    for (u32 i = 0; i < state_ptr->pending_change_count;) {
+        if (now - state_ptr->pending_changes[i].last_write_time < RESOURCE_CHANGE_SETTLE_TIME) {
+            ++i;
+            continue;
+        }
+
+        // Take the change out first, as listeners may cause more changes to be recorded.
+        resource_change change = state_ptr->pending_changes[i];
+        state_ptr->pending_changes[i] = state_ptr->pending_changes[--state_ptr->pending_change_count];
+
+        KDEBUG("Asset '%s' changed.", change.name);
+        for (u32 l = 0; l < RESOURCE_MAX_CHANGE_LISTENERS; ++l) {
+            resource_change_listener* listener = &state_ptr->change_listeners[l];
+            if (listener->callback && listener->type == change.loader->type) {
+                listener->callback(change.name, listener->listener);
+            }
+        }
+    }
+}
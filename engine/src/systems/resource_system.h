@@ -1,6 +1,7 @@
 #pragma once
 
 #include "resources/resource_types.h"
+#include "resources/kpak.h"
 
 /**
  * @file resource_system.h
@@ -14,6 +15,12 @@
  * - Initialize the resource system with `resource_system_initialize()`, providing configuration options.
  * - Register resource loaders for different resource types using `resource_system_register_loader()`.
  * - Load resources by name and type using `resource_system_load()` or `resource_system_load_custom()`.
+ * - Load resources on worker threads using `resource_system_load_async()`. Loads complete, and
+ *   their callbacks run, on the main thread in `resource_system_update()`, called once per frame.
+ * - Loaders read files through `resource_system_read_packed()` first, which serves them from the
+ *   archive named by `config.archive_path` when one is mounted, and fall back to loose files.
+ * - Register for changes to loose files using `resource_system_register_change_listener()`.
+ *   Changes are reported from `resource_system_update()` once a file has stopped being written.
  * - Unload resources using `resource_system_unload()`.
  * - Shutdown the resource system with `resource_system_shutdown()` to free all resources.
  */
@@ -28,6 +35,12 @@ typedef struct resource_system_config {
     u32 max_loader_count;
     /** The relative base path for assets. */
     char* asset_base_path;
+    /** Maximum number of asynchronous loads in flight at once. */
+    u32 max_async_load_count;
+    /** The path of a .kpak archive of the assets to mount, or 0. Loose files are used if it does not exist. */
+    char* archive_path;
+    /** Whether to watch the base path for changed files and report them to change listeners. Ignored when an archive is mounted. */
+    b8 watch_for_changes;
 } resource_system_config;
 
 /**
@@ -62,8 +75,41 @@ typedef struct resource_loader {
      * @param resource Pointer to the resource to unload.
      */
     void (*unload)(struct resource_loader* self, resource* resource);
+    /**
+     * @brief Optional function pointer invoked when the loader is registered, allowing it to
+     * create anything it owns. The loader is not registered if this fails. May be 0.
+     *
+     * @param self Pointer to the resource_loader instance.
+     * @return True on success; otherwise False.
+     */
+    b8 (*initialize)(struct resource_loader* self);
+    /**
+     * @brief Optional function pointer invoked when the resource system shuts down,
+     * allowing the loader to release what initialize created. May be 0.
+     *
+     * @param self Pointer to the resource_loader instance.
+     */
+    void (*shutdown)(struct resource_loader* self);
 } resource_loader;
 
+/**
+ * @brief Called on the main thread when an asynchronous load finishes.
+ *
+ * @param name The name of the resource, as requested.
+ * @param r The loaded resource, or 0 if loading failed. Only valid during the call; it is
+ * unloaded once every callback waiting on it has run.
+ * @param listener The listener given when the load was requested.
+ */
+typedef void (*pfn_resource_loaded)(const char* name, const resource* r, void* listener);
+
+/**
+ * @brief Called on the main thread when the file of a resource has changed on disk.
+ *
+ * @param name The name of the resource, as it would be loaded.
+ * @param listener The listener given when registering.
+ */
+typedef void (*pfn_resource_changed)(const char* name, void* listener);
+
 /**
  * @brief Initializes the resource system with the provided configuration.
  *
@@ -109,6 +155,55 @@ KAPI b8 resource_system_load(const char* name, resource_type type, resource* out
  */
 KAPI b8 resource_system_load_custom(const char* name, const char* custom_type, resource* out_resource);
 
+/**
+ * @brief Loads a resource by name and type on a worker thread.
+ *
+ * Requests for a resource that is already being loaded share the one load, and each callback
+ * runs once it finishes. Callbacks always run from `resource_system_update()`, even when the
+ * job system is not running and the load happens right away.
+ *
+ * NOTE: Must be called from the main thread. The loader of the type must be safe to call from
+ * worker threads.
+ *
+ * @param name Name of the resource to load.
+ * @param type Type of the resource to load.
+ * @param callback Function called with the loaded resource.
+ * @param listener Passed to the callback. May be 0.
+ * @return True if the load was requested; False if there is no loader for the type or too
+ * many loads are in flight.
+ */
+KAPI b8 resource_system_load_async(const char* name, resource_type type, pfn_resource_loaded callback, void* listener);
+
+/**
+ * @brief Runs the callbacks of every asynchronous load that has finished since the last call,
+ * then unloads those resources. Also reports files that have changed and settled to change
+ * listeners. Called once per frame, on the main thread.
+ */
+KAPI void resource_system_update();
+
+/**
+ * @brief Registers a function to be called when the file of a resource of the given type changes.
+ *
+ * A file is matched to a type by the type path of its loader, so "textures/paving.png" is
+ * reported to image listeners as "paving". Writes in quick succession are reported once.
+ * Nothing is reported unless config.watch_for_changes is set and no archive is mounted.
+ *
+ * @param type The type of resource.
+ * @param callback The function to call.
+ * @param listener Passed to the callback. May be 0.
+ * @return True if registered; False if there is no room for more listeners.
+ */
+KAPI b8 resource_system_register_change_listener(resource_type type, pfn_resource_changed callback, void* listener);
+
+/**
+ * @brief Unregisters a function registered with resource_system_register_change_listener().
+ *
+ * @param type The type of resource.
+ * @param callback The function.
+ * @param listener The listener.
+ */
+KAPI void resource_system_unregister_change_listener(resource_type type, pfn_resource_changed callback, void* listener);
+
 /**
  * @brief Unloads a previously loaded resource, freeing its associated data.
  *
@@ -116,6 +211,30 @@ KAPI b8 resource_system_load_custom(const char* name, const char* custom_type, r
  */
 KAPI void resource_system_unload(resource* resource);
 
+/**
+ * @brief Reads a file of a loader's type from the mounted archive. Safe to call from any thread.
+ *
+ * The file is looked up as "<type_path>/<name><extension>", the path the loader would open
+ * relative to the base path. Stored files point straight into the archive's mapping, which
+ * stays valid until the resource system shuts down.
+ *
+ * @param loader The loader reading the file.
+ * @param name The name of the resource.
+ * @param extension The extension of the file, including the '.', or "".
+ * @param out_data A pointer to hold the data. Release it with kpak_data_release().
+ * @return True if the file was read from the archive; False if no archive is mounted, it has no
+ * such file, or the file is corrupt.
+ */
+KAPI b8 resource_system_read_packed(const resource_loader* loader, const char* name, const char* extension, kpak_data* out_data);
+
+/**
+ * @brief Checks whether memory lies within the mounted archive, and so must not be freed.
+ *
+ * @param data The memory.
+ * @return True if data points into the archive; otherwise False.
+ */
+KAPI b8 resource_system_is_packed(const void* data);
+
 /**
  * @brief Retrieves the base path used for asset loading.
  *
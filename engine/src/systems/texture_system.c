@@ -7,6 +7,7 @@
 
 #include "renderer/renderer_frontend.h"
 
+#include "resources/ktex.h"
 #include "resources/resource_types.h"
 #include "systems/resource_system.h"
 
@@ -16,6 +17,12 @@
 
 #define PIXEL_COUNT TEX_DIMENSIONS* TEX_DIMENSIONS  ///< Total number of pixels in the texture
 
+#define TEXTURE_REDUCED_DIMENSION 64  ///< Largest side of the mips streamed previews and reduced textures keep
+
+#define TEXTURE_MAX_PENDING_STREAMS 64  ///< Most full mip chains waiting to replace their previews
+
+#define TEXTURE_STREAM_BYTES_PER_UPDATE (8 * 1024 * 1024)  ///< Bytes of full mip chains uploaded per update, at least one chain
+
 /**
  * @file texture_system.c
  *
@@ -32,6 +39,16 @@
  * it will be freed when no longer in use.
  * - Shutdown the texture system with `texture_system_shutdown()` to free all resources.
  *
+ * Every texture is uploaded with a full mip chain, and sampled trilinearly. Streamed textures are
+ * first uploaded from their small mips only, and their full chains follow a few at a time from
+ * `texture_system_update()`.
+ *
+ * When a residency budget is set, each texture's uploaded size is tracked, along with the frame
+ * the renderer last bound it in. Over budget, textures that were not drawn last frame are shed in
+ * least recently drawn order: first reduced to their small mips, by reloading the image and
+ * uploading only its tail, then evicted so the default texture is drawn. Once they are drawn
+ * again, they are reloaded at full resolution if that fits.
+ *
  * Responsibilities:
  * - Initialize the texture system with `texture_system_initialize()`, providing configuration options.
  * - Acquire textures by name using `texture_system_acquire()`. If the texture is not
@@ -41,6 +58,54 @@
  * - Shutdown the texture system with `texture_system_shutdown()` to free all resources.
  */
 
+/**
+ * @struct texture_stream
+ *
+ * @brief The full mip chain of a streamed texture, waiting to be uploaded.
+ */
+typedef struct texture_stream {
+    /** @brief The name of the texture. */
+    char name[TEXTURE_NAME_MAX_LENGTH];
+    /** @brief The image, whose pixels are a copy owned by the stream. */
+    image_resource_data image;
+    /** @brief The frame the preview was first seen uploaded in, or INVALID_ID_U64 until then. */
+    u64 preview_ready_frame;
+} texture_stream;
+
+/**
+ * @enum texture_residency_level
+ *
+ * @brief How much of a texture is on the GPU.
+ */
+typedef enum texture_residency_level {
+    /** Every mip level is uploaded. */
+    TEXTURE_RESIDENCY_FULL,
+    /** Only the mips no larger than TEXTURE_REDUCED_DIMENSION are uploaded. */
+    TEXTURE_RESIDENCY_REDUCED,
+    /** Nothing is uploaded, and the default texture is drawn instead. */
+    TEXTURE_RESIDENCY_EVICTED
+} texture_residency_level;
+
+/**
+ * @struct texture_residency
+ *
+ * @brief The residency of a registered texture, kept alongside it by slot.
+ */
+typedef struct texture_residency {
+    /** @brief The level the texture is uploaded at. */
+    texture_residency_level level;
+    /** @brief True while a load to change the level, or a streamed full chain, is outstanding. */
+    b8 pending;
+    /** @brief The bytes uploaded. */
+    u64 size;
+    /** @brief The bytes that will be uploaded once the outstanding change lands. */
+    u64 pending_size;
+    /** @brief The bytes of the full mip chain. */
+    u64 full_size;
+    /** @brief The bytes of the reduced mips. */
+    u64 reduced_size;
+} texture_residency;
+
 /**
  * @struct texture_system_config
  *
@@ -70,6 +135,15 @@ typedef struct texture_system_state {
      */
     texture* registered_textures;
 
+    /** @brief The residency of each registered texture, indexed by slot. */
+    texture_residency* residency;
+
+    /** @brief Hands out slots of registered_textures to references. */
+    handle_pool texture_slots;
+
+    /** @brief The residency counters, with resident_bytes kept current. */
+    texture_residency_stats residency_stats;
+
     /**
      * @brief Hashtable for quick texture lookups by name.
      *
@@ -77,6 +151,16 @@ typedef struct texture_system_state {
      * allowing for efficient retrieval of textures by name.
      */
     hashtable registered_texture_table;
+
+    /**
+     * @brief Full mip chains of streamed textures, waiting to replace their previews.
+     *
+     * Kept in the order they were queued, so textures sharpen in the order they loaded.
+     */
+    texture_stream pending_streams[TEXTURE_MAX_PENDING_STREAMS];
+
+    /** @brief The number of pending streams. */
+    u32 pending_stream_count;
 } texture_system_state;
 
 /**
@@ -106,6 +190,80 @@ void destroy_default_textures(texture_system_state* state);
  */
 b8 load_texture(const char* texture_name, texture* t);
 
+/**
+ * @brief Creates a texture from a loaded image, replacing any texture already there, and records
+ * its residency.
+ *
+ * @param texture_name The name of the texture.
+ * @param image The loaded image.
+ * @param reduced True to upload only the image's small mips, if it has any.
+ * @param t Pointer to the registered texture to be filled out.
+ */
+static void create_texture_from_image(const char* texture_name, const image_resource_data* image, b8 reduced, texture* t);
+
+/**
+ * @brief Called when the image of an asynchronously acquired texture has loaded.
+ */
+static void on_texture_loaded(const char* name, const resource* r, void* listener);
+
+/**
+ * @brief Called when the image of a streamed texture has loaded. Uploads a preview from its
+ * small mips, and queues the full chain.
+ */
+static void on_texture_streamed(const char* name, const resource* r, void* listener);
+
+/**
+ * @brief Describes the levels of an image no larger than the reduced dimension.
+ *
+ * @param image The full image.
+ * @param out_preview A pointer to hold the reduced image, whose pixels point into the image.
+ * @return True if the image has smaller mips to reduce to; otherwise False.
+ */
+static b8 reduced_image(const image_resource_data* image, image_resource_data* out_preview);
+
+/**
+ * @brief Drops any full mip chain still waiting to be uploaded for a texture.
+ */
+static void cancel_stream(const char* name);
+
+/**
+ * @brief Restores textures drawn again, and sheds the least recently drawn ones while over budget.
+ */
+static void update_residency();
+
+/**
+ * @brief Requests the image of a texture be reloaded, to reduce or restore it.
+ *
+ * @return True if the load was requested; otherwise False.
+ */
+static b8 request_residency(texture* t, texture_residency* r, b8 reduced);
+
+/**
+ * @brief Called when the image of a texture being reduced has reloaded.
+ */
+static void on_texture_reduced(const char* name, const resource* r, void* listener);
+
+/**
+ * @brief Called when the image of a texture being restored has reloaded.
+ */
+static void on_texture_restored(const char* name, const resource* r, void* listener);
+
+/**
+ * @brief Destroys a texture's GPU resources, keeping its slot, so the default texture is drawn
+ * in its place.
+ */
+static void evict_texture(texture* t, texture_residency* r);
+
+/**
+ * @brief Called when the image of a texture changes on disk. Reloads the texture if it is in use.
+ */
+static void on_image_changed(const char* name, void* listener);
+
+/**
+ * @brief Called when the image of a changed texture has reloaded.
+ */
+static void on_texture_reloaded(const char* name, const resource* r, void* listener);
+
 /**
  * @brief Destroys a texture and releases its resources.
  *
@@ -124,11 +282,15 @@ b8 texture_system_initialize(u64* memory_requirement, void* state, texture_syste
         return False;
     }
 
-    // Block of memory will contain state structure, then block for array, then block for hashtable.
+    // Block of memory will contain state structure, then block for array, then block for
+    // residency, then block for the slot pool, then block for hashtable.
     u64 struct_requirement = sizeof(texture_system_state);
     u64 array_requirement = sizeof(texture) * config.max_texture_count;
+    u64 residency_requirement = sizeof(texture_residency) * config.max_texture_count;
+    u64 slots_requirement = 0;
+    handle_pool_create(config.max_texture_count, &slots_requirement, 0, 0);
     u64 hashtable_requirement = sizeof(texture_reference) * config.max_texture_count;
-    *memory_requirement = struct_requirement + array_requirement + hashtable_requirement;
+    *memory_requirement = struct_requirement + array_requirement + residency_requirement + slots_requirement + hashtable_requirement;
 
     if (!state) {
         return True;
@@ -141,8 +303,19 @@ b8 texture_system_initialize(u64* memory_requirement, void* state, texture_syste
     void* array_block = state + struct_requirement;
     state_ptr->registered_textures = array_block;
 
-    // Hashtable block is after array.
-    void* hashtable_block = array_block + array_requirement;
+    // Residency block is after array.
+    void* residency_block = array_block + array_requirement;
+    state_ptr->residency = residency_block;
+    kzero_memory(state_ptr->residency, residency_requirement);
+    kzero_memory(&state_ptr->residency_stats, sizeof(texture_residency_stats));
+    state_ptr->pending_stream_count = 0;
+
+    // Slot pool block is after residency.
+    void* slots_block = residency_block + residency_requirement;
+    handle_pool_create(config.max_texture_count, &slots_requirement, slots_block, &state_ptr->texture_slots);
+
+    // Hashtable block is after the slot pool.
+    void* hashtable_block = slots_block + slots_requirement;
 
     // Create a hashtable for texture lookups.
     hashtable_create(sizeof(texture_reference), config.max_texture_count, hashtable_block, False, &state_ptr->registered_texture_table);
@@ -150,7 +323,7 @@ b8 texture_system_initialize(u64* memory_requirement, void* state, texture_syste
     // Fill the hashtable with invalid references to use as a default.
     texture_reference invalid_ref;
     invalid_ref.auto_release = False;
-    invalid_ref.handle = INVALID_ID;  // Primary reason for needing default values.
+    invalid_ref.handle = KHANDLE_INVALID;  // Primary reason for needing default values.
     invalid_ref.reference_count = 0;
     hashtable_fill(&state_ptr->registered_texture_table, &invalid_ref);
 
@@ -164,11 +337,16 @@ b8 texture_system_initialize(u64* memory_requirement, void* state, texture_syste
     // Create default textures for use in the system.
     create_default_textures(state_ptr);
 
+    // Reload textures whose images are edited while running.
+    resource_system_register_change_listener(RESOURCE_TYPE_IMAGE, on_image_changed, 0);
+
     return True;
 }
 
 void texture_system_shutdown(void* state) {
     if (state_ptr) {
+        resource_system_unregister_change_listener(RESOURCE_TYPE_IMAGE, on_image_changed, 0);
+
         // Destroy all loaded textures.
         for (u32 i = 0; i < state_ptr->config.max_texture_count; ++i) {
             texture* t = &state_ptr->registered_textures[i];
@@ -177,13 +355,29 @@ void texture_system_shutdown(void* state) {
             }
         }
 
+        // Drop full chains that never made it up.
+        for (u32 i = 0; i < state_ptr->pending_stream_count; ++i) {
+            texture_stream* stream = &state_ptr->pending_streams[i];
+            kfree(stream->image.pixels, stream->image.size, MEMORY_TAG_TEXTURE);
+        }
+        state_ptr->pending_stream_count = 0;
+
         destroy_default_textures(state_ptr);
 
+        // Release the lookup table's key copies and bookkeeping.
+        hashtable_destroy(&state_ptr->registered_texture_table);
+        handle_pool_destroy(&state_ptr->texture_slots);
+
         state_ptr = 0;
     }
 }
 
-texture* texture_system_acquire(const char* name, b8 auto_release) {
+/**
+ * @brief Acquires a texture, loading it if it does not yet exist.
+ *
+ * @param on_loaded Called with the image once it loads on a worker thread, or 0 to load it now.
+ */
+static texture* acquire(const char* name, b8 auto_release, pfn_resource_loaded on_loaded) {
     // Return default texture, but warn about it since this should be returned via get_default_texture();
     if (strings_equali(name, DEFAULT_TEXTURE_NAME)) {
         KWARN("texture_system_acquire called for default texture. Use texture_system_get_default_texture for texture 'default'.");
@@ -197,33 +391,36 @@ texture* texture_system_acquire(const char* name, b8 auto_release) {
             ref.auto_release = auto_release;
         }
         ref.reference_count++;
-        if (ref.handle == INVALID_ID) {
-            // This means no texture exists here. Find a free index first.
-            u32 count = state_ptr->config.max_texture_count;
-            texture* t = 0;
-            for (u32 i = 0; i < count; ++i) {
-                if (state_ptr->registered_textures[i].id == INVALID_ID) {
-                    // A free slot has been found. Use its index as the handle.
-                    ref.handle = i;
-                    t = &state_ptr->registered_textures[i];
-                    break;
-                }
-            }
-
-            // Make sure an empty slot was actually found.
-            if (!t || ref.handle == INVALID_ID) {
+        if (!handle_pool_is_valid(&state_ptr->texture_slots, ref.handle)) {
+            // This means no texture exists here. Take a free slot.
+            if (!handle_pool_acquire(&state_ptr->texture_slots, &ref.handle)) {
                 KFATAL("texture_system_acquire - Texture system cannot hold anymore textures. Adjust configuration to allow more.");
                 return 0;
             }
-
-            // Create new texture.
-            if (!load_texture(name, t)) {
+            texture* t = &state_ptr->registered_textures[handle_pool_index(ref.handle)];
+
+            if (on_loaded) {
+                // Renders as the default texture until the image arrives.
+                kzero_memory(t, sizeof(texture));
+                string_ncopy(t->name, name, TEXTURE_NAME_MAX_LENGTH);
+                t->generation = INVALID_ID;
+                if (!resource_system_load_async(name, RESOURCE_TYPE_IMAGE, on_loaded, 0)) {
+                    KERROR("Failed to request texture '%s'.", name);
+                    t->id = INVALID_ID;
+                    handle_pool_release(&state_ptr->texture_slots, ref.handle);
+                    return 0;
+                }
+            } else if (!load_texture(name, t)) {
+                // Create new texture.
                 KERROR("Failed to load texture '%s'.", name);
+                handle_pool_release(&state_ptr->texture_slots, ref.handle);
                 return 0;
             }
 
-            // Also use the handle as the texture id.
-            t->id = ref.handle;
+            // Also use the slot index as the texture id. Counts as drawn now, so it is not shed
+            // before it has had a chance to be.
+            t->id = handle_pool_index(ref.handle);
+            t->last_used_frame = renderer_get_frame_number();
             KTRACE("Texture '%s' does not yet exist. Created, and ref_count is now %i.", name, ref.reference_count);
         } else {
             KTRACE("Texture '%s' already exists, ref_count increased to %i.", name, ref.reference_count);
@@ -231,7 +428,7 @@ texture* texture_system_acquire(const char* name, b8 auto_release) {
 
         // Update the entry.
         hashtable_set(&state_ptr->registered_texture_table, name, &ref);
-        return &state_ptr->registered_textures[ref.handle];
+        return &state_ptr->registered_textures[handle_pool_index(ref.handle)];
     }
 
     // NOTE: This would only happen in the event something went wrong with the state.
@@ -239,6 +436,98 @@ texture* texture_system_acquire(const char* name, b8 auto_release) {
     return 0;
 }
 
+texture* texture_system_acquire(const char* name, b8 auto_release) {
+    return acquire(name, auto_release, 0);
+}
+
+texture* texture_system_acquire_async(const char* name, b8 auto_release) {
+    return acquire(name, auto_release, on_texture_loaded);
+}
+
+texture* texture_system_acquire_streamed(const char* name, b8 auto_release) {
+    return acquire(name, auto_release, on_texture_streamed);
+}
+
+void texture_system_update() {
+    if (!state_ptr) {
+        return;
+    }
+
+    // Upload up to the budget, but always at least one chain so large textures still arrive.
+    u64 frame_number = renderer_get_frame_number();
+    u64 uploaded = 0;
+    u32 done = 0;
+    u32 kept = 0;
+    for (u32 i = 0; i < state_ptr->pending_stream_count; ++i) {
+        texture_stream* stream = &state_ptr->pending_streams[i];
+
+        // The texture may have been released since its preview went up.
+        texture* t = 0;
+        texture_reference ref;
+        if (hashtable_get(&state_ptr->registered_texture_table, stream->name, &ref) && handle_pool_is_valid(&state_ptr->texture_slots, ref.handle)) {
+            t = &state_ptr->registered_textures[handle_pool_index(ref.handle)];
+            if (t->generation == INVALID_ID) {
+                t = 0;
+            }
+        }
+
+        if (t) {
+            // Only replace the preview once it has been drawn, or it would never be seen, and its
+            // image would be destroyed in the frame it was created.
+            if (stream->preview_ready_frame == INVALID_ID_U64 && renderer_texture_is_ready(t)) {
+                stream->preview_ready_frame = frame_number;
+            }
+            b8 preview_drawn = stream->preview_ready_frame != INVALID_ID_U64 && frame_number > stream->preview_ready_frame;
+            b8 within_budget = done == 0 || uploaded + stream->image.size <= TEXTURE_STREAM_BYTES_PER_UPDATE;
+            if (!preview_drawn || !within_budget) {
+                // Keep the rest in order.
+                state_ptr->pending_streams[kept++] = *stream;
+                continue;
+            }
+
+            u32 id = t->id;
+            create_texture_from_image(stream->name, &stream->image, False, t);
+            t->id = id;
+            state_ptr->residency[handle_pool_index(ref.handle)].pending = False;
+            KTRACE("Texture '%s' streamed in at full resolution.", stream->name);
+            uploaded += stream->image.size;
+            done++;
+        }
+
+        kfree(stream->image.pixels, stream->image.size, MEMORY_TAG_TEXTURE);
+    }
+    state_ptr->pending_stream_count = kept;
+
+    update_residency();
+}
+
+texture_residency_stats texture_system_get_residency_stats() {
+    texture_residency_stats stats = {0};
+    if (!state_ptr) {
+        return stats;
+    }
+
+    stats = state_ptr->residency_stats;
+    stats.budget_bytes = state_ptr->config.max_resident_bytes;
+    for (u32 i = 0; i < state_ptr->config.max_texture_count; ++i) {
+        if (state_ptr->registered_textures[i].id == INVALID_ID) {
+            continue;
+        }
+        switch (state_ptr->residency[i].level) {
+            case TEXTURE_RESIDENCY_FULL:
+                stats.full_count++;
+                break;
+            case TEXTURE_RESIDENCY_REDUCED:
+                stats.reduced_count++;
+                break;
+            case TEXTURE_RESIDENCY_EVICTED:
+                stats.evicted_count++;
+                break;
+        }
+    }
+    return stats;
+}
+
 void texture_system_release(const char* name) {
     // Ignore release requests for the default texture.
     if (strings_equali(name, DEFAULT_TEXTURE_NAME)) {
@@ -259,19 +548,21 @@ void texture_system_release(const char* name) {
         ref.reference_count--;
 
         if (ref.reference_count == 0 && ref.auto_release) {
-            texture* t = &state_ptr->registered_textures[ref.handle];
+            texture* t = &state_ptr->registered_textures[handle_pool_index(ref.handle)];
 
-            // Destroy/Reset texture.
+            // Destroy/Reset texture, and free its slot.
             destroy_texture(t);
+            handle_pool_release(&state_ptr->texture_slots, ref.handle);
+            cancel_stream(name_copy);
 
-            // Reset the reference.
-            ref.handle = INVALID_ID;
-            ref.auto_release = False;
-            KTRACE("Released texture '%s'., Texture unloaded because reference count=0 and auto_release=true.", name);
-        } else {
-            KTRACE("Released texture '%s', now has a reference count of '%i' (auto_release=%s).", name_copy, ref.reference_count, ref.auto_release ? "true" : "false");
+            // Remove the entry, so the name no longer takes up a slot in the table.
+            hashtable_remove(&state_ptr->registered_texture_table, name_copy);
+            KTRACE("Released texture '%s'., Texture unloaded because reference count=0 and auto_release=true.", name_copy);
+            return;
         }
 
+        KTRACE("Released texture '%s', now has a reference count of '%i' (auto_release=%s).", name_copy, ref.reference_count, ref.auto_release ? "true" : "false");
+
         // Update the entry.
         hashtable_set(&state_ptr->registered_texture_table, name_copy, &ref);
     } else {
@@ -294,6 +585,8 @@ b8 create_default_textures(texture_system_state* state) {
     KTRACE("Creating default texture...");
 
     u8 pixels[PIXEL_COUNT * CHANNELS];
+    u32 mip_count = ktex_mip_count(TEX_DIMENSIONS, TEX_DIMENSIONS);
+    u64 chain_size = ktex_data_size(TEXTURE_FORMAT_RGBA8, TEX_DIMENSIONS, TEX_DIMENSIONS, mip_count);
 
     kset_memory(pixels, 255, sizeof(u8) * PIXEL_COUNT * CHANNELS);
 
@@ -324,7 +617,12 @@ b8 create_default_textures(texture_system_state* state) {
     state->default_texture.generation = INVALID_ID;
     state->default_texture.has_transparency = False;
 
-    renderer_create_texture(DEFAULT_TEXTURE_NAME, TEX_DIMENSIONS, TEX_DIMENSIONS, 4, pixels, False, &state->default_texture);
+    // Mipped like everything else, so the checkerboard fades to an even blue in the distance
+    // rather than shimmering.
+    u8* chain = kallocate(chain_size, MEMORY_TAG_TEXTURE);
+    ktex_build_mip_chain(pixels, TEX_DIMENSIONS, TEX_DIMENSIONS, chain);
+    renderer_create_texture(DEFAULT_TEXTURE_NAME, TEX_DIMENSIONS, TEX_DIMENSIONS, 4, TEXTURE_FORMAT_RGBA8, mip_count, chain, False, &state->default_texture);
+    kfree(chain, chain_size, MEMORY_TAG_TEXTURE);
     // Manually set the texture generation to invalid since this is a default texture.
     state->default_texture.generation = INVALID_ID;
 
@@ -345,41 +643,43 @@ b8 load_texture(const char* texture_name, texture* t) {
         return False;
     }
 
-    image_resource_data* resource_data = img_resource.data;
+    create_texture_from_image(texture_name, img_resource.data, False, t);
+
+    // Clean up data.
+    resource_system_unload(&img_resource);
+    return True;
+}
+
+static void create_texture_from_image(const char* texture_name, const image_resource_data* image, b8 reduced, texture* t) {
+    image_resource_data preview;
+    b8 has_preview = reduced_image(image, &preview);
+    const image_resource_data* upload = reduced && has_preview ? &preview : image;
 
     // Use a temporary texture to load into.
     texture temp_texture;
 
-    temp_texture.width = resource_data->width;
-    temp_texture.height = resource_data->height;
-    temp_texture.channel_count = resource_data->channel_count;
+    temp_texture.width = upload->width;
+    temp_texture.height = upload->height;
+    temp_texture.channel_count = upload->channel_count;
+    temp_texture.last_used_frame = t->last_used_frame;
 
     u32 current_generation = t->generation;
     t->generation = INVALID_ID;
 
-    u64 total_size = temp_texture.width * temp_texture.height * temp_texture.channel_count;
-
-    // Check for transparency
-    b32 has_transparency = False;
-    for (u64 i = 0; i < total_size; i += temp_texture.channel_count) {
-        u8 a = resource_data->pixels[i + 3];
-        if (a < 255) {
-            has_transparency = True;
-            break;
-        }
-    }
-
     // Take a copy of the name
     string_ncopy(temp_texture.name, texture_name, TEXTURE_NAME_MAX_LENGTH);
 
-    // Acquire internal texture resources and upload to GPU.
+    // Acquire internal texture resources and upload to GPU. The loader has already found out
+    // whether the image is transparent, or read it from the cooked texture.
     renderer_create_texture(
         texture_name,
         temp_texture.width,
         temp_texture.height,
         temp_texture.channel_count,
-        resource_data->pixels,
-        has_transparency,
+        upload->format,
+        upload->mip_count,
+        upload->pixels,
+        upload->has_transparency,
         &temp_texture);
 
     // Take a copy of the old texture.
@@ -397,12 +697,305 @@ b8 load_texture(const char* texture_name, texture* t) {
         t->generation = current_generation + 1;
     }
 
-    // Clean up data.
-    resource_system_unload(&img_resource);
+    texture_residency* r = &state_ptr->residency[t - state_ptr->registered_textures];
+    state_ptr->residency_stats.resident_bytes -= r->size;
+    state_ptr->residency_stats.resident_bytes += upload->size;
+    r->size = upload->size;
+    r->full_size = image->size;
+    r->reduced_size = has_preview ? preview.size : image->size;
+    r->level = upload == image ? TEXTURE_RESIDENCY_FULL : TEXTURE_RESIDENCY_REDUCED;
+}
+
+static void on_texture_loaded(const char* name, const resource* r, void* listener) {
+    // The texture may have been released, or loaded synchronously, while the image was loading.
+    texture_reference ref;
+    if (!state_ptr || !hashtable_get(&state_ptr->registered_texture_table, name, &ref) || !handle_pool_is_valid(&state_ptr->texture_slots, ref.handle)) {
+        return;
+    }
+    texture* t = &state_ptr->registered_textures[handle_pool_index(ref.handle)];
+    if (t->generation != INVALID_ID) {
+        return;
+    }
+
+    if (!r) {
+        KWARN("Unable to load texture '%s', the default texture will be used.", name);
+        return;
+    }
+
+    u32 id = t->id;
+    create_texture_from_image(name, r->data, False, t);
+    // The renderer replaces the whole texture, so restore the handle.
+    t->id = id;
+    KTRACE("Texture '%s' loaded and swapped in.", name);
+}
+
+static void on_texture_streamed(const char* name, const resource* r, void* listener) {
+    texture_reference ref;
+    if (!state_ptr || !hashtable_get(&state_ptr->registered_texture_table, name, &ref) || !handle_pool_is_valid(&state_ptr->texture_slots, ref.handle)) {
+        return;
+    }
+    texture* t = &state_ptr->registered_textures[handle_pool_index(ref.handle)];
+    if (t->generation != INVALID_ID) {
+        return;
+    }
+
+    if (!r) {
+        KWARN("Unable to load texture '%s', the default texture will be used.", name);
+        return;
+    }
+
+    const image_resource_data* image = r->data;
+    image_resource_data preview;
+    u32 id = t->id;
+    if (state_ptr->pending_stream_count < TEXTURE_MAX_PENDING_STREAMS && reduced_image(image, &preview)) {
+        create_texture_from_image(name, image, True, t);
+
+        // Left alone by residency until the full chain lands.
+        texture_residency* residency = &state_ptr->residency[handle_pool_index(ref.handle)];
+        residency->pending = True;
+        residency->pending_size = residency->full_size;
+
+        // The loader's data is released after this returns, so keep a copy of the full chain.
+        texture_stream* stream = &state_ptr->pending_streams[state_ptr->pending_stream_count++];
+        string_ncopy(stream->name, name, TEXTURE_NAME_MAX_LENGTH);
+        stream->preview_ready_frame = INVALID_ID_U64;
+        stream->image = *image;
+        stream->image.pixels = kallocate(image->size, MEMORY_TAG_TEXTURE);
+        kcopy_memory(stream->image.pixels, image->pixels, image->size);
+        KTRACE("Texture '%s' previewed at %ux%u.", name, preview.width, preview.height);
+    } else {
+        // Small enough to need no preview, or too many are already waiting.
+        create_texture_from_image(name, image, False, t);
+    }
+    t->id = id;
+}
+
+static b8 reduced_image(const image_resource_data* image, image_resource_data* out_preview) {
+    u32 level = 0;
+    while (level + 1 < image->mip_count &&
+           KMAX(image->width >> level, image->height >> level) > TEXTURE_REDUCED_DIMENSION) {
+        level++;
+    }
+    if (level == 0) {
+        return False;
+    }
+
+    // The levels are packed largest first, so the preview is the tail of the chain.
+    u64 offset = ktex_data_size(image->format, image->width, image->height, level);
+    *out_preview = *image;
+    out_preview->width = KMAX(image->width >> level, 1);
+    out_preview->height = KMAX(image->height >> level, 1);
+    out_preview->mip_count = image->mip_count - level;
+    out_preview->pixels = image->pixels + offset;
+    out_preview->size = image->size - offset;
     return True;
 }
 
+static void cancel_stream(const char* name) {
+    for (u32 i = 0; i < state_ptr->pending_stream_count; ++i) {
+        texture_stream* stream = &state_ptr->pending_streams[i];
+        if (strings_equal(stream->name, name)) {
+            kfree(stream->image.pixels, stream->image.size, MEMORY_TAG_TEXTURE);
+            for (u32 j = i + 1; j < state_ptr->pending_stream_count; ++j) {
+                state_ptr->pending_streams[j - 1] = state_ptr->pending_streams[j];
+            }
+            state_ptr->pending_stream_count--;
+            return;
+        }
+    }
+}
+
+static void on_image_changed(const char* name, void* listener) {
+    // Textures that are not loaded pick the change up when they are.
+    texture_reference ref;
+    if (!state_ptr || !hashtable_get(&state_ptr->registered_texture_table, name, &ref) || !handle_pool_is_valid(&state_ptr->texture_slots, ref.handle)) {
+        return;
+    }
+
+    if (!resource_system_load_async(name, RESOURCE_TYPE_IMAGE, on_texture_reloaded, 0)) {
+        KWARN("Unable to request a reload of texture '%s'.", name);
+    }
+}
+
+static void on_texture_reloaded(const char* name, const resource* r, void* listener) {
+    // The texture may have been released while the image was loading.
+    texture_reference ref;
+    if (!state_ptr || !hashtable_get(&state_ptr->registered_texture_table, name, &ref) || !handle_pool_is_valid(&state_ptr->texture_slots, ref.handle)) {
+        return;
+    }
+
+    if (!r) {
+        KWARN("Unable to reload texture '%s', the current image will be kept.", name);
+        return;
+    }
+
+    // Evicted textures load the new image when they are drawn again.
+    texture_residency* residency = &state_ptr->residency[handle_pool_index(ref.handle)];
+    if (residency->level == TEXTURE_RESIDENCY_EVICTED) {
+        return;
+    }
+
+    // Bumps the generation, so materials using the texture rebind it on their next draw. A full
+    // chain or residency change still waiting from before the edit is stale.
+    cancel_stream(name);
+    residency->pending = False;
+    texture* t = &state_ptr->registered_textures[handle_pool_index(ref.handle)];
+    u32 id = t->id;
+    create_texture_from_image(name, r->data, residency->level == TEXTURE_RESIDENCY_REDUCED, t);
+    t->id = id;
+    KINFO("Texture '%s' reloaded.", name);
+}
+
+/** @brief Checks whether a texture was drawn last frame, or is being drawn in this one. */
+static b8 texture_is_visible(const texture* t, u64 frame) {
+    return t->last_used_frame + 1 >= frame;
+}
+
+static void update_residency() {
+    u64 frame = renderer_get_frame_number();
+    u64 budget = state_ptr->config.max_resident_bytes;
+    u32 count = state_ptr->config.max_texture_count;
+
+    // What will be uploaded once the outstanding changes land.
+    u64 projected = 0;
+    for (u32 i = 0; i < count; ++i) {
+        if (state_ptr->registered_textures[i].id != INVALID_ID) {
+            texture_residency* r = &state_ptr->residency[i];
+            projected += r->pending ? r->pending_size : r->size;
+        }
+    }
+
+    // Bring back textures that are being drawn again, as far as they fit.
+    for (u32 i = 0; i < count; ++i) {
+        texture* t = &state_ptr->registered_textures[i];
+        texture_residency* r = &state_ptr->residency[i];
+        if (t->id == INVALID_ID || r->pending || r->level == TEXTURE_RESIDENCY_FULL || !texture_is_visible(t, frame)) {
+            continue;
+        }
+
+        if (!budget || projected - r->size + r->full_size <= budget) {
+            if (request_residency(t, r, False)) {
+                projected += r->full_size - r->size;
+                state_ptr->residency_stats.restorations++;
+            }
+        } else if (r->level == TEXTURE_RESIDENCY_EVICTED && projected + r->reduced_size <= budget) {
+            // The small mips at least beat the default texture.
+            if (request_residency(t, r, True)) {
+                projected += r->reduced_size;
+            }
+        }
+    }
+
+    if (!budget || projected <= budget) {
+        return;
+    }
+
+    // Shed the least recently drawn textures until the rest fit. Textures drawn last frame are
+    // kept, so what is on screen never thrashes; if they alone exceed the budget, it is exceeded.
+    u32 reduced = 0;
+    u32 evicted = 0;
+    while (projected > budget) {
+        u32 lru = INVALID_ID;
+        for (u32 i = 0; i < count; ++i) {
+            texture* t = &state_ptr->registered_textures[i];
+            texture_residency* r = &state_ptr->residency[i];
+            // Nothing uploaded covers both evicted textures and those still loading.
+            if (t->id == INVALID_ID || r->pending || r->size == 0 || texture_is_visible(t, frame)) {
+                continue;
+            }
+            if (lru == INVALID_ID || t->last_used_frame < state_ptr->registered_textures[lru].last_used_frame) {
+                lru = i;
+            }
+        }
+        if (lru == INVALID_ID) {
+            break;
+        }
+
+        texture* t = &state_ptr->registered_textures[lru];
+        texture_residency* r = &state_ptr->residency[lru];
+        if (r->level == TEXTURE_RESIDENCY_FULL && r->reduced_size < r->size && request_residency(t, r, True)) {
+            projected -= r->size - r->reduced_size;
+            state_ptr->residency_stats.reductions++;
+            reduced++;
+        } else {
+            projected -= r->size;
+            evict_texture(t, r);
+            evicted++;
+        }
+    }
+
+    if (reduced || evicted) {
+        KDEBUG("Texture residency over budget: reducing %u and evicting %u textures, %llu of %llu bytes resident.",
+               reduced, evicted, state_ptr->residency_stats.resident_bytes, budget);
+    }
+}
+
+static b8 request_residency(texture* t, texture_residency* r, b8 reduced) {
+    if (!resource_system_load_async(t->name, RESOURCE_TYPE_IMAGE, reduced ? on_texture_reduced : on_texture_restored, 0)) {
+        KWARN("Unable to request a reload of texture '%s' to change its residency.", t->name);
+        return False;
+    }
+    r->pending = True;
+    r->pending_size = reduced ? r->reduced_size : r->full_size;
+    return True;
+}
+
+/**
+ * @brief Uploads a reloaded image at the residency it was reloaded for.
+ */
+static void on_residency_loaded(const char* name, const resource* r, b8 reduced) {
+    texture_reference ref;
+    if (!state_ptr || !hashtable_get(&state_ptr->registered_texture_table, name, &ref) || !handle_pool_is_valid(&state_ptr->texture_slots, ref.handle)) {
+        return;
+    }
+
+    // Dropped if the texture was reloaded, or released and acquired again, in the meantime.
+    texture_residency* residency = &state_ptr->residency[handle_pool_index(ref.handle)];
+    if (!residency->pending) {
+        return;
+    }
+    residency->pending = False;
+
+    if (!r) {
+        KWARN("Unable to reload texture '%s', its residency is unchanged.", name);
+        return;
+    }
+
+    texture* t = &state_ptr->registered_textures[handle_pool_index(ref.handle)];
+    u32 id = t->id;
+    create_texture_from_image(name, r->data, reduced, t);
+    t->id = id;
+    KTRACE("Texture '%s' %s.", name, reduced ? "reduced to its small mips" : "restored to full resolution");
+}
+
+static void on_texture_reduced(const char* name, const resource* r, void* listener) {
+    on_residency_loaded(name, r, True);
+}
+
+static void on_texture_restored(const char* name, const resource* r, void* listener) {
+    on_residency_loaded(name, r, False);
+}
+
+static void evict_texture(texture* t, texture_residency* r) {
+    // The backend clears whatever it is handed, so destroy a copy and keep the name and handle.
+    texture old = *t;
+    renderer_destroy_texture(&old);
+    t->internal_data = 0;
+    t->generation = INVALID_ID;
+
+    state_ptr->residency_stats.resident_bytes -= r->size;
+    state_ptr->residency_stats.evictions++;
+    r->size = 0;
+    r->level = TEXTURE_RESIDENCY_EVICTED;
+    KTRACE("Texture '%s' evicted.", t->name);
+}
+
 void destroy_texture(texture* t) {
+    // Give back its share of the budget.
+    texture_residency* r = &state_ptr->residency[t - state_ptr->registered_textures];
+    state_ptr->residency_stats.resident_bytes -= r->size;
+    kzero_memory(r, sizeof(texture_residency));
+
     // Clean up backend resources.
     renderer_destroy_texture(t);
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "containers/handle_pool.h"
 #include "renderer/renderer_types.inl"
 
 /**
@@ -14,6 +15,13 @@
  * - Initialize the texture system with `texture_system_initialize()`, providing configuration options.
  * - Acquire textures by name using `texture_system_acquire()`. If the texture is not
  * already loaded, it will be loaded from disk.
+ * - Acquire textures without waiting for them to load using `texture_system_acquire_async()`.
+ * The texture renders as the default texture until its image has loaded.
+ * - Acquire large textures with `texture_system_acquire_streamed()` to show their small mips
+ * first, and call `texture_system_update()` each frame to bring in the rest.
+ * - Set `max_resident_bytes` to bound texture memory. `texture_system_update()` sheds the least
+ * recently drawn textures to stay within it, and `texture_system_get_residency_stats()` reports
+ * how it is doing.
  * - Release textures using `texture_system_release()`. If a texture was marked for auto-release,
  * it will be freed when no longer in use.
  * - Shutdown the texture system with `texture_system_shutdown()` to free all resources.
@@ -40,9 +48,10 @@ typedef struct texture_reference {
     u64 reference_count;
 
     /**
-     * @brief Handle to the texture in the registered textures array.
+     * @brief Handle to the texture's slot in the registered textures array. Goes stale once the
+     * texture is released, even if the slot is reused.
      */
-    u32 handle;
+    khandle handle;
 
     /**
      * @brief Auto-release flag.
@@ -58,8 +67,39 @@ typedef struct texture_reference {
 typedef struct texture_system_config {
     /** Maximum number of textures that can be managed by the system. */
     u32 max_texture_count;
+    /**
+     * The most bytes of texture data to keep on the GPU, or 0 for no limit. Textures that have
+     * not been drawn recently are reduced to their small mips, then replaced by the default
+     * texture, to stay within it.
+     */
+    u64 max_resident_bytes;
 } texture_system_config;
 
+/**
+ * @struct texture_residency_stats
+ *
+ * @brief How much texture data is on the GPU, and what the texture system has done to keep it
+ * within budget.
+ */
+typedef struct texture_residency_stats {
+    /** The configured budget in bytes, or 0 for no limit. */
+    u64 budget_bytes;
+    /** The bytes of texture data uploaded, not counting the default texture. */
+    u64 resident_bytes;
+    /** The number of textures uploaded with their full mip chain. */
+    u32 full_count;
+    /** The number of textures uploaded with only their small mips. */
+    u32 reduced_count;
+    /** The number of textures drawn as the default texture until they are seen again. */
+    u32 evicted_count;
+    /** The number of times a texture has been reduced to its small mips. */
+    u64 reductions;
+    /** The number of times a texture has been evicted entirely. */
+    u64 evictions;
+    /** The number of times a reduced or evicted texture has been brought back to full resolution. */
+    u64 restorations;
+} texture_residency_stats;
+
 /**
  * @brief Initializes the texture system.
  *
@@ -91,6 +131,56 @@ void texture_system_shutdown(void* state);
  */
 texture* texture_system_acquire(const char* name, b8 auto_release);
 
+/**
+ * @brief Acquires a texture by name, loading its image on a worker thread if it is not already loaded.
+ *
+ * The returned texture has an invalid generation until its image has loaded, so the renderer
+ * draws the default texture in its place. Once the load finishes, the image is uploaded into
+ * the same texture during `resource_system_update()`, so holders of the pointer see it from
+ * then on. If the image fails to load, the texture stays as the default.
+ *
+ * @param name Name of the texture to acquire.
+ * @param auto_release If true, the texture will be automatically released when no longer in use.
+ * @return Pointer to the acquired texture, or NULL if acquisition failed.
+ */
+texture* texture_system_acquire_async(const char* name, b8 auto_release);
+
+/**
+ * @brief Acquires a texture by name like `texture_system_acquire_async()`, but shows its small
+ * mips first.
+ *
+ * When the image loads, only the mips no larger than 64 pixels a side are uploaded, which is
+ * quick and enough for distant or newly visible surfaces. Once the preview has finished uploading
+ * and been drawn for a frame, the full chain replaces it over the next few calls to
+ * `texture_system_update()`, bumping the generation each time so materials rebind. Until then the
+ * texture reports the size of its preview.
+ *
+ * @param name Name of the texture to acquire.
+ * @param auto_release If true, the texture will be automatically released when no longer in use.
+ * @return Pointer to the acquired texture, or NULL if acquisition failed.
+ */
+texture* texture_system_acquire_streamed(const char* name, b8 auto_release);
+
+/**
+ * @brief Uploads the full mip chains of streamed textures, a few per call, and keeps textures
+ * within the residency budget.
+ *
+ * Textures drawn last frame that are reduced or evicted are reloaded at full resolution if they
+ * fit. While over budget, the least recently drawn textures that were not drawn last frame are
+ * reduced to their small mips, and those already reduced are evicted.
+ *
+ * Should be called once per frame, after `resource_system_update()`.
+ */
+void texture_system_update();
+
+/**
+ * @brief Obtains the residency budget, how much of it is in use, and how often textures have
+ * been reduced, evicted and restored.
+ *
+ * @return The residency counters.
+ */
+KAPI texture_residency_stats texture_system_get_residency_stats();
+
 /**
  * @brief Releases a texture by name.
  *
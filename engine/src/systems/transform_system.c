@@ -0,0 +1,702 @@
+#include "transform_system.h"
+
+#include "core/logger.h"
+#include "core/kmemory.h"
+#include "math/kmath.h"
+#include "systems/job_system.h"
+
+/**
+ * @file transform_system.c
+ *
+ * @brief Implementation of the transform system.
+ *
+ * This module implements the functions defined in `transform_system.h`.
+ *
+ * Transform data is stored by slot rather than by id. On each update after the hierarchy changed,
+ * the slots are repacked in topological order: sorted by depth, so every parent precedes its
+ * children and each depth is a contiguous range of slots, read front to back. `slots` maps
+ * ids to their current slot, so ids stay stable while data moves.
+ *
+ * Every per-slot array is padded to a multiple of four and 16-byte aligned, so four slots at a time
+ * load straight into SIMD registers. Unused slots hold an identity transform.
+ */
+
+/** @brief Set while the slot holds a transform. */
+#define TRANSFORM_FLAG_ACTIVE 0x1
+/** @brief Set when the position, rotation, scale or parent changed since the last update. */
+#define TRANSFORM_FLAG_DIRTY 0x2
+/** @brief Set during an update once the world matrix has been recomputed, so children follow. */
+#define TRANSFORM_FLAG_WORLD_CHANGED 0x4
+
+/** @brief The number of transforms each job of an update processes. A multiple of 4. */
+#define TRANSFORM_JOB_CHUNK_SIZE 4096
+
+/**
+ * @struct transform_system_state
+ *
+ * Internal state structure for the transform system.
+ */
+typedef struct transform_system_state {
+    /** Configuration parameters for the transform system. */
+    transform_system_config config;
+    /** The length of every array: the max transform count rounded up to a multiple of 4. */
+    u32 capacity;
+
+    /** One past the highest id ever handed out. */
+    u32 id_high_water;
+    /** The slot of each id, or INVALID_ID if the id is free. */
+    u32* slots;
+    /** The parent of each id, or INVALID_ID. */
+    u32* parents;
+    /** Ids of destroyed transforms, reused before new ones. */
+    u32* free_ids;
+    /** The number of ids in free_ids. */
+    u32 free_count;
+
+    /** The number of slots in use, including those of transforms destroyed since the last repack. */
+    u32 slot_count;
+    /** Position components of each slot, one array each. */
+    f32* position_x;
+    f32* position_y;
+    f32* position_z;
+    /** Rotation components of each slot, one array each. */
+    f32* rotation_x;
+    f32* rotation_y;
+    f32* rotation_z;
+    f32* rotation_w;
+    /** Scale components of each slot, one array each. */
+    f32* scale_x;
+    f32* scale_y;
+    f32* scale_z;
+    /** Local matrices of each slot as of the last update. */
+    mat4* locals;
+    /** World matrices of each slot as of the last update. */
+    mat4* worlds;
+    /** The slot of the parent of each slot, or INVALID_ID. Valid after a repack. */
+    u32* parent_slots;
+    /** The id in each slot. */
+    u32* slot_ids;
+    /** TRANSFORM_FLAG_* bits of each slot. */
+    u8* flags;
+
+    /** Where each depth starts in the slots, plus one past the end. */
+    u32* level_offsets;
+    /** The number of depths. */
+    u32 level_count;
+
+    /** Scratch space used while repacking, one element per slot. */
+    u32* depths;
+    u32* order;
+    u32* scratch;
+
+    /** Whether the slots need to be repacked before the next update. */
+    b8 hierarchy_dirty;
+    /** Whether anything is dirty, so an update has work to do. */
+    b8 any_dirty;
+} transform_system_state;
+
+/** Static pointer to the system state. */
+static transform_system_state* state_ptr = 0;
+
+/**
+ * @struct transform_job_range
+ *
+ * The range of slots handed to each job of an update.
+ */
+typedef struct transform_job_range {
+    /** The first slot. */
+    u32 start;
+    /** One past the last slot. */
+    u32 end;
+} transform_job_range;
+
+/** @brief Carves an array out of the state block, keeping every array 16-byte aligned. */
+static void* take_array(u8** cursor, u64 size) {
+    void* block = *cursor;
+    *cursor += get_aligned(size, 16);
+    return block;
+}
+
+/** @brief Obtains the size of the state block, with every array 16-byte aligned. */
+static u64 state_block_size(u32 capacity) {
+    u64 size = get_aligned(sizeof(transform_system_state), 16);
+    size += get_aligned(sizeof(f32) * capacity, 16) * 10;
+    size += get_aligned(sizeof(mat4) * capacity, 16) * 2;
+    // slots, parents, free_ids, parent_slots, slot_ids, depths, order and scratch.
+    size += get_aligned(sizeof(u32) * capacity, 16) * 8;
+    size += get_aligned(sizeof(u32) * (capacity + 1), 16);
+    size += get_aligned(sizeof(u8) * capacity, 16);
+    return size;
+}
+
+/** @brief Resets a slot to an identity transform. */
+static void reset_slot(u32 slot) {
+    state_ptr->position_x[slot] = 0.0f;
+    state_ptr->position_y[slot] = 0.0f;
+    state_ptr->position_z[slot] = 0.0f;
+    state_ptr->rotation_x[slot] = 0.0f;
+    state_ptr->rotation_y[slot] = 0.0f;
+    state_ptr->rotation_z[slot] = 0.0f;
+    state_ptr->rotation_w[slot] = 1.0f;
+    state_ptr->scale_x[slot] = 1.0f;
+    state_ptr->scale_y[slot] = 1.0f;
+    state_ptr->scale_z[slot] = 1.0f;
+    state_ptr->locals[slot] = mat4_identity();
+    state_ptr->worlds[slot] = mat4_identity();
+    state_ptr->parent_slots[slot] = INVALID_ID;
+    state_ptr->slot_ids[slot] = INVALID_ID;
+    state_ptr->flags[slot] = 0;
+}
+
+b8 transform_system_initialize(u64* memory_requirement, void* state, transform_system_config config) {
+    if (config.max_transform_count == 0) {
+        KFATAL("transform_system_initialize - config.max_transform_count must be > 0.");
+        return False;
+    }
+
+    u32 capacity = (u32)get_aligned(config.max_transform_count, 4);
+    *memory_requirement = state_block_size(capacity);
+
+    if (!state) {
+        return True;
+    }
+
+    if (((u64)state & 15) != 0) {
+        KFATAL("transform_system_initialize - The state block must be 16-byte aligned.");
+        return False;
+    }
+
+    state_ptr = state;
+    kzero_memory(state_ptr, sizeof(transform_system_state));
+    state_ptr->config = config;
+    state_ptr->capacity = capacity;
+
+    // The arrays follow the state structure.
+    u8* cursor = (u8*)state + get_aligned(sizeof(transform_system_state), 16);
+    state_ptr->position_x = take_array(&cursor, sizeof(f32) * capacity);
+    state_ptr->position_y = take_array(&cursor, sizeof(f32) * capacity);
+    state_ptr->position_z = take_array(&cursor, sizeof(f32) * capacity);
+    state_ptr->rotation_x = take_array(&cursor, sizeof(f32) * capacity);
+    state_ptr->rotation_y = take_array(&cursor, sizeof(f32) * capacity);
+    state_ptr->rotation_z = take_array(&cursor, sizeof(f32) * capacity);
+    state_ptr->rotation_w = take_array(&cursor, sizeof(f32) * capacity);
+    state_ptr->scale_x = take_array(&cursor, sizeof(f32) * capacity);
+    state_ptr->scale_y = take_array(&cursor, sizeof(f32) * capacity);
+    state_ptr->scale_z = take_array(&cursor, sizeof(f32) * capacity);
+    state_ptr->locals = take_array(&cursor, sizeof(mat4) * capacity);
+    state_ptr->worlds = take_array(&cursor, sizeof(mat4) * capacity);
+    state_ptr->slots = take_array(&cursor, sizeof(u32) * capacity);
+    state_ptr->parents = take_array(&cursor, sizeof(u32) * capacity);
+    state_ptr->free_ids = take_array(&cursor, sizeof(u32) * capacity);
+    state_ptr->parent_slots = take_array(&cursor, sizeof(u32) * capacity);
+    state_ptr->slot_ids = take_array(&cursor, sizeof(u32) * capacity);
+    state_ptr->depths = take_array(&cursor, sizeof(u32) * capacity);
+    state_ptr->order = take_array(&cursor, sizeof(u32) * capacity);
+    state_ptr->scratch = take_array(&cursor, sizeof(u32) * capacity);
+    state_ptr->level_offsets = take_array(&cursor, sizeof(u32) * (capacity + 1));
+    state_ptr->flags = take_array(&cursor, sizeof(u8) * capacity);
+
+    for (u32 i = 0; i < capacity; ++i) {
+        state_ptr->slots[i] = INVALID_ID;
+        state_ptr->parents[i] = INVALID_ID;
+        reset_slot(i);
+    }
+
+    return True;
+}
+
+void transform_system_shutdown(void* state) {
+    if (state_ptr) {
+        state_ptr = 0;
+    }
+}
+
+/** @brief Checks that an id refers to a live transform, logging an error if not. */
+static b8 transform_is_valid(u32 id, const char* caller) {
+    if (!state_ptr) {
+        KERROR("%s called before the transform system was initialized.", caller);
+        return False;
+    }
+    if (id >= state_ptr->id_high_water || state_ptr->slots[id] == INVALID_ID) {
+        KERROR("%s - Invalid transform id %u.", caller, id);
+        return False;
+    }
+    return True;
+}
+
+/** @brief Marks a transform as needing its local and world matrices recomputed. */
+static void mark_dirty(u32 id) {
+    state_ptr->flags[state_ptr->slots[id]] |= TRANSFORM_FLAG_DIRTY;
+    state_ptr->any_dirty = True;
+}
+
+static void repack_slots();
+
+u32 transform_create() {
+    return transform_from_position_rotation_scale(vec3_zero(), quat_identity(), vec3_one());
+}
+
+u32 transform_from_position_rotation_scale(vec3 position, quat rotation, vec3 scale) {
+    if (!state_ptr) {
+        KERROR("transform_create called before the transform system was initialized.");
+        return INVALID_ID;
+    }
+
+    u32 id;
+    if (state_ptr->free_count > 0) {
+        id = state_ptr->free_ids[--state_ptr->free_count];
+    } else if (state_ptr->id_high_water < state_ptr->config.max_transform_count) {
+        id = state_ptr->id_high_water++;
+    } else {
+        KERROR("transform_create - All %u transforms in use. Adjust the configuration to allow more.", state_ptr->config.max_transform_count);
+        return INVALID_ID;
+    }
+
+    // New transforms go after every other slot until the next repack. Out of slots means
+    // destroyed transforms left holes, which a repack closes.
+    if (state_ptr->slot_count == state_ptr->capacity) {
+        repack_slots();
+    }
+    u32 slot = state_ptr->slot_count++;
+    reset_slot(slot);
+    state_ptr->slot_ids[slot] = id;
+    state_ptr->flags[slot] = TRANSFORM_FLAG_ACTIVE;
+    state_ptr->slots[id] = slot;
+    state_ptr->parents[id] = INVALID_ID;
+    state_ptr->hierarchy_dirty = True;
+
+    transform_set_position(id, position);
+    transform_set_rotation(id, rotation);
+    transform_set_scale(id, scale);
+    return id;
+}
+
+void transform_destroy(u32 id) {
+    if (!transform_is_valid(id, "transform_destroy")) {
+        return;
+    }
+
+    // Children become roots.
+    for (u32 i = 0; i < state_ptr->id_high_water; ++i) {
+        if (state_ptr->parents[i] == id) {
+            state_ptr->parents[i] = INVALID_ID;
+            mark_dirty(i);
+        }
+    }
+
+    // The slot is left as a hole until the next repack.
+    reset_slot(state_ptr->slots[id]);
+    state_ptr->slots[id] = INVALID_ID;
+    state_ptr->parents[id] = INVALID_ID;
+    state_ptr->free_ids[state_ptr->free_count++] = id;
+    state_ptr->hierarchy_dirty = True;
+}
+
+b8 transform_set_parent(u32 id, u32 parent_id) {
+    if (!transform_is_valid(id, "transform_set_parent")) {
+        return False;
+    }
+
+    if (parent_id != INVALID_ID) {
+        if (!transform_is_valid(parent_id, "transform_set_parent")) {
+            return False;
+        }
+
+        // Refuse to make a transform its own ancestor.
+        for (u32 ancestor = parent_id; ancestor != INVALID_ID; ancestor = state_ptr->parents[ancestor]) {
+            if (ancestor == id) {
+                KWARN("transform_set_parent - Parenting transform %u to %u would create a cycle.", id, parent_id);
+                return False;
+            }
+        }
+    }
+
+    if (state_ptr->parents[id] != parent_id) {
+        state_ptr->parents[id] = parent_id;
+        state_ptr->hierarchy_dirty = True;
+        mark_dirty(id);
+    }
+    return True;
+}
+
+u32 transform_get_parent(u32 id) {
+    if (!transform_is_valid(id, "transform_get_parent")) {
+        return INVALID_ID;
+    }
+    return state_ptr->parents[id];
+}
+
+vec3 transform_get_position(u32 id) {
+    if (!transform_is_valid(id, "transform_get_position")) {
+        return vec3_zero();
+    }
+    u32 slot = state_ptr->slots[id];
+    return vec3_create(state_ptr->position_x[slot], state_ptr->position_y[slot], state_ptr->position_z[slot]);
+}
+
+void transform_set_position(u32 id, vec3 position) {
+    if (!transform_is_valid(id, "transform_set_position")) {
+        return;
+    }
+    u32 slot = state_ptr->slots[id];
+    state_ptr->position_x[slot] = position.x;
+    state_ptr->position_y[slot] = position.y;
+    state_ptr->position_z[slot] = position.z;
+    mark_dirty(id);
+}
+
+quat transform_get_rotation(u32 id) {
+    if (!transform_is_valid(id, "transform_get_rotation")) {
+        return quat_identity();
+    }
+    u32 slot = state_ptr->slots[id];
+    return (quat){state_ptr->rotation_x[slot], state_ptr->rotation_y[slot], state_ptr->rotation_z[slot], state_ptr->rotation_w[slot]};
+}
+
+void transform_set_rotation(u32 id, quat rotation) {
+    if (!transform_is_valid(id, "transform_set_rotation")) {
+        return;
+    }
+    u32 slot = state_ptr->slots[id];
+    state_ptr->rotation_x[slot] = rotation.x;
+    state_ptr->rotation_y[slot] = rotation.y;
+    state_ptr->rotation_z[slot] = rotation.z;
+    state_ptr->rotation_w[slot] = rotation.w;
+    mark_dirty(id);
+}
+
+vec3 transform_get_scale(u32 id) {
+    if (!transform_is_valid(id, "transform_get_scale")) {
+        return vec3_one();
+    }
+    u32 slot = state_ptr->slots[id];
+    return vec3_create(state_ptr->scale_x[slot], state_ptr->scale_y[slot], state_ptr->scale_z[slot]);
+}
+
+void transform_set_scale(u32 id, vec3 scale) {
+    if (!transform_is_valid(id, "transform_set_scale")) {
+        return;
+    }
+    u32 slot = state_ptr->slots[id];
+    state_ptr->scale_x[slot] = scale.x;
+    state_ptr->scale_y[slot] = scale.y;
+    state_ptr->scale_z[slot] = scale.z;
+    mark_dirty(id);
+}
+
+mat4 transform_get_local(u32 id) {
+    if (!transform_is_valid(id, "transform_get_local")) {
+        return mat4_identity();
+    }
+    return state_ptr->locals[state_ptr->slots[id]];
+}
+
+mat4 transform_get_world(u32 id) {
+    if (!transform_is_valid(id, "transform_get_world")) {
+        return mat4_identity();
+    }
+    return state_ptr->worlds[state_ptr->slots[id]];
+}
+
+/** @brief Moves the elements of a per-slot f32 array into their new slots, given the old slot of each new one. */
+static void permute_f32(f32* values, const u32* old_slots, u32 count) {
+    f32* moved = (f32*)state_ptr->scratch;
+    for (u32 i = 0; i < count; ++i) {
+        moved[i] = values[old_slots[i]];
+    }
+    kcopy_memory(values, moved, sizeof(f32) * count);
+}
+
+/**
+ * @brief Repacks the slots in topological order, closing the holes left by destroyed transforms.
+ *
+ * Matrices are not moved. Every transform is marked dirty instead, so the next update recomputes
+ * them all. Hierarchy changes are rare next to transform changes, so this keeps repacks simple.
+ */
+static void repack_slots() {
+    transform_system_state* s = state_ptr;
+    u32 id_count = s->id_high_water;
+
+    for (u32 id = 0; id < id_count; ++id) {
+        s->depths[id] = INVALID_ID;
+    }
+
+    // Find every depth. Walks up to the nearest ancestor of known depth, then fills in the
+    // depths on the way back down, so each transform is only visited once.
+    u32 max_depth = 0;
+    for (u32 id = 0; id < id_count; ++id) {
+        if (s->slots[id] == INVALID_ID || s->depths[id] != INVALID_ID) {
+            continue;
+        }
+
+        u32 chain_length = 0;
+        u32 ancestor = id;
+        while (ancestor != INVALID_ID && s->depths[ancestor] == INVALID_ID) {
+            s->scratch[chain_length++] = ancestor;
+            ancestor = s->parents[ancestor];
+        }
+
+        u32 depth = ancestor == INVALID_ID ? 0 : s->depths[ancestor] + 1;
+        while (chain_length > 0) {
+            s->depths[s->scratch[--chain_length]] = depth++;
+        }
+        max_depth = KMAX(max_depth, depth - 1);
+    }
+
+    // Counting sort by depth. Walking the old slots keeps transforms that were near each other
+    // near each other.
+    u32 live_count = 0;
+    kzero_memory(s->level_offsets, sizeof(u32) * (max_depth + 2));
+    for (u32 id = 0; id < id_count; ++id) {
+        if (s->slots[id] != INVALID_ID) {
+            s->level_offsets[s->depths[id] + 1]++;
+            live_count++;
+        }
+    }
+    s->level_count = live_count > 0 ? max_depth + 1 : 0;
+    for (u32 level = 0; level < s->level_count; ++level) {
+        s->level_offsets[level + 1] += s->level_offsets[level];
+    }
+
+    // order holds the old slot of each new slot.
+    u32* cursors = s->scratch;
+    kcopy_memory(cursors, s->level_offsets, sizeof(u32) * s->level_count);
+    for (u32 slot = 0; slot < s->slot_count; ++slot) {
+        u32 id = s->slot_ids[slot];
+        if (id != INVALID_ID) {
+            s->order[cursors[s->depths[id]]++] = slot;
+        }
+    }
+
+    permute_f32(s->position_x, s->order, live_count);
+    permute_f32(s->position_y, s->order, live_count);
+    permute_f32(s->position_z, s->order, live_count);
+    permute_f32(s->rotation_x, s->order, live_count);
+    permute_f32(s->rotation_y, s->order, live_count);
+    permute_f32(s->rotation_z, s->order, live_count);
+    permute_f32(s->rotation_w, s->order, live_count);
+    permute_f32(s->scale_x, s->order, live_count);
+    permute_f32(s->scale_y, s->order, live_count);
+    permute_f32(s->scale_z, s->order, live_count);
+
+    u32* new_ids = s->scratch;
+    for (u32 slot = 0; slot < live_count; ++slot) {
+        new_ids[slot] = s->slot_ids[s->order[slot]];
+    }
+    for (u32 slot = 0; slot < live_count; ++slot) {
+        u32 id = new_ids[slot];
+        s->slot_ids[slot] = id;
+        s->slots[id] = slot;
+        s->flags[slot] = TRANSFORM_FLAG_ACTIVE | TRANSFORM_FLAG_DIRTY;
+    }
+    for (u32 slot = 0; slot < live_count; ++slot) {
+        u32 parent = s->parents[s->slot_ids[slot]];
+        s->parent_slots[slot] = parent == INVALID_ID ? INVALID_ID : s->slots[parent];
+    }
+
+    // Everything past the live transforms is free again.
+    for (u32 slot = live_count; slot < s->slot_count; ++slot) {
+        reset_slot(slot);
+    }
+    s->slot_count = live_count;
+    s->hierarchy_dirty = False;
+    s->any_dirty = True;
+}
+
+/**
+ * @brief Recomposes the local matrix of a slot as scale, then rotation, then translation.
+ */
+static void compose_local_scalar(u32 slot) {
+    transform_system_state* s = state_ptr;
+    quat q = (quat){s->rotation_x[slot], s->rotation_y[slot], s->rotation_z[slot], s->rotation_w[slot]};
+    mat4 m = quat_to_mat4(q);
+
+    f32* d = s->locals[slot].data;
+    d[0] = m.data[0] * s->scale_x[slot];
+    d[1] = m.data[1] * s->scale_x[slot];
+    d[2] = m.data[2] * s->scale_x[slot];
+    d[3] = 0.0f;
+    d[4] = m.data[4] * s->scale_y[slot];
+    d[5] = m.data[5] * s->scale_y[slot];
+    d[6] = m.data[6] * s->scale_y[slot];
+    d[7] = 0.0f;
+    d[8] = m.data[8] * s->scale_z[slot];
+    d[9] = m.data[9] * s->scale_z[slot];
+    d[10] = m.data[10] * s->scale_z[slot];
+    d[11] = 0.0f;
+    d[12] = s->position_x[slot];
+    d[13] = s->position_y[slot];
+    d[14] = s->position_z[slot];
+    d[15] = 1.0f;
+}
+
+#if KSIMD_ENABLED
+/**
+ * @brief Recomposes the local matrices of four slots at once, one per lane. The first slot is a
+ * multiple of 4. Matches compose_local_scalar().
+ */
+static void compose_locals_simd(u32 first) {
+    transform_system_state* s = state_ptr;
+
+    f32x4 x = f32x4_load(s->rotation_x + first);
+    f32x4 y = f32x4_load(s->rotation_y + first);
+    f32x4 z = f32x4_load(s->rotation_z + first);
+    f32x4 w = f32x4_load(s->rotation_w + first);
+
+    // Normalize the rotations.
+    f32x4 length_squared = f32x4_mul(x, x);
+    length_squared = f32x4_madd(y, y, length_squared);
+    length_squared = f32x4_madd(z, z, length_squared);
+    length_squared = f32x4_madd(w, w, length_squared);
+    f32x4 inverse_length = f32x4_div(f32x4_splat(1.0f), f32x4_sqrt(length_squared));
+    x = f32x4_mul(x, inverse_length);
+    y = f32x4_mul(y, inverse_length);
+    z = f32x4_mul(z, inverse_length);
+    w = f32x4_mul(w, inverse_length);
+
+    // The rotation matrix, as in quat_to_mat4().
+    f32x4 x2 = f32x4_add(x, x);
+    f32x4 y2 = f32x4_add(y, y);
+    f32x4 z2 = f32x4_add(z, z);
+    f32x4 xx = f32x4_mul(x, x2);
+    f32x4 yy = f32x4_mul(y, y2);
+    f32x4 zz = f32x4_mul(z, z2);
+    f32x4 xy = f32x4_mul(x, y2);
+    f32x4 xz = f32x4_mul(x, z2);
+    f32x4 yz = f32x4_mul(y, z2);
+    f32x4 wx = f32x4_mul(w, x2);
+    f32x4 wy = f32x4_mul(w, y2);
+    f32x4 wz = f32x4_mul(w, z2);
+    f32x4 one = f32x4_splat(1.0f);
+    f32x4 zero = f32x4_splat(0.0f);
+
+    f32x4 sx = f32x4_load(s->scale_x + first);
+    f32x4 sy = f32x4_load(s->scale_y + first);
+    f32x4 sz = f32x4_load(s->scale_z + first);
+
+    // Each row holds one element per transform. Transposing turns them into one row per transform.
+    f32x4 r_0 = f32x4_mul(f32x4_sub(one, f32x4_add(yy, zz)), sx);
+    f32x4 r_1 = f32x4_mul(f32x4_sub(xy, wz), sx);
+    f32x4 r_2 = f32x4_mul(f32x4_add(xz, wy), sx);
+    f32x4 r_3 = zero;
+    f32x4_transpose(&r_0, &r_1, &r_2, &r_3);
+    f32x4_store(s->locals[first + 0].data + 0, r_0);
+    f32x4_store(s->locals[first + 1].data + 0, r_1);
+    f32x4_store(s->locals[first + 2].data + 0, r_2);
+    f32x4_store(s->locals[first + 3].data + 0, r_3);
+
+    r_0 = f32x4_mul(f32x4_add(xy, wz), sy);
+    r_1 = f32x4_mul(f32x4_sub(one, f32x4_add(xx, zz)), sy);
+    r_2 = f32x4_mul(f32x4_sub(yz, wx), sy);
+    r_3 = zero;
+    f32x4_transpose(&r_0, &r_1, &r_2, &r_3);
+    f32x4_store(s->locals[first + 0].data + 4, r_0);
+    f32x4_store(s->locals[first + 1].data + 4, r_1);
+    f32x4_store(s->locals[first + 2].data + 4, r_2);
+    f32x4_store(s->locals[first + 3].data + 4, r_3);
+
+    r_0 = f32x4_mul(f32x4_sub(xz, wy), sz);
+    r_1 = f32x4_mul(f32x4_add(yz, wx), sz);
+    r_2 = f32x4_mul(f32x4_sub(one, f32x4_add(xx, yy)), sz);
+    r_3 = zero;
+    f32x4_transpose(&r_0, &r_1, &r_2, &r_3);
+    f32x4_store(s->locals[first + 0].data + 8, r_0);
+    f32x4_store(s->locals[first + 1].data + 8, r_1);
+    f32x4_store(s->locals[first + 2].data + 8, r_2);
+    f32x4_store(s->locals[first + 3].data + 8, r_3);
+
+    r_0 = f32x4_load(s->position_x + first);
+    r_1 = f32x4_load(s->position_y + first);
+    r_2 = f32x4_load(s->position_z + first);
+    r_3 = one;
+    f32x4_transpose(&r_0, &r_1, &r_2, &r_3);
+    f32x4_store(s->locals[first + 0].data + 12, r_0);
+    f32x4_store(s->locals[first + 1].data + 12, r_1);
+    f32x4_store(s->locals[first + 2].data + 12, r_2);
+    f32x4_store(s->locals[first + 3].data + 12, r_3);
+}
+#endif
+
+/**
+ * @brief Recomputes the local and world matrices of the slots in [start, end), all of one depth.
+ * Their parents must already be up to date.
+ *
+ * Both passes run over the same range back to back, so the local matrices are still in cache
+ * when the world matrices read them.
+ */
+static void compose_range(u32 start, u32 end) {
+    transform_system_state* s = state_ptr;
+    u8* flags = s->flags;
+
+    // Local matrices of the dirty slots. Whole groups of four go through SIMD; recomposing all
+    // four costs no more than the dirty ones alone. The ends of the range go one at a time.
+    u32 slot = start;
+#if KSIMD_ENABLED
+    for (; slot < end && (slot & 3) != 0; ++slot) {
+        if (flags[slot] & TRANSFORM_FLAG_DIRTY) {
+            compose_local_scalar(slot);
+        }
+    }
+    for (; slot + 4 <= end; slot += 4) {
+        if ((flags[slot] | flags[slot + 1] | flags[slot + 2] | flags[slot + 3]) & TRANSFORM_FLAG_DIRTY) {
+            compose_locals_simd(slot);
+        }
+    }
+#endif
+    for (; slot < end; ++slot) {
+        if (flags[slot] & TRANSFORM_FLAG_DIRTY) {
+            compose_local_scalar(slot);
+        }
+    }
+
+    // World matrices of the dirty slots, and of those whose parent's world matrix changed.
+    for (slot = start; slot < end; ++slot) {
+        u32 parent = s->parent_slots[slot];
+        u8 slot_flags = flags[slot];
+
+        b8 changed = (slot_flags & TRANSFORM_FLAG_DIRTY) || (parent != INVALID_ID && (flags[parent] & TRANSFORM_FLAG_WORLD_CHANGED));
+        if (changed) {
+            s->worlds[slot] = parent == INVALID_ID ? s->locals[slot] : mat4_mul(s->locals[slot], s->worlds[parent]);
+        }
+        slot_flags &= ~(TRANSFORM_FLAG_DIRTY | TRANSFORM_FLAG_WORLD_CHANGED);
+        flags[slot] = changed ? (slot_flags | TRANSFORM_FLAG_WORLD_CHANGED) : slot_flags;
+    }
+}
+
+static b8 compose_range_job(void* param_data) {
+    transform_job_range* range = param_data;
+    compose_range(range->start, range->end);
+    return True;
+}
+
+void transform_system_update() {
+    if (!state_ptr || (!state_ptr->any_dirty && !state_ptr->hierarchy_dirty)) {
+        return;
+    }
+
+    if (state_ptr->hierarchy_dirty) {
+        repack_slots();
+    }
+
+    // Each depth waits for the one above it, as children read their parent's world matrix.
+    // Depths of a single chunk run directly on the calling thread.
+    for (u32 level = 0; level < state_ptr->level_count; ++level) {
+        u32 start = state_ptr->level_offsets[level];
+        u32 end = state_ptr->level_offsets[level + 1];
+        if (end - start <= TRANSFORM_JOB_CHUNK_SIZE) {
+            compose_range(start, end);
+            continue;
+        }
+
+        job_counter counter = {0};
+        for (u32 chunk = start; chunk < end; chunk += TRANSFORM_JOB_CHUNK_SIZE) {
+            transform_job_range range = {chunk, KMIN(chunk + TRANSFORM_JOB_CHUNK_SIZE, end)};
+            job_info job = job_create_priority(compose_range_job, &range, sizeof(transform_job_range), JOB_PRIORITY_HIGH);
+            job.counter = &counter;
+            job_system_submit(job);
+        }
+        job_counter_wait(&counter);
+    }
+
+    state_ptr->any_dirty = False;
+}
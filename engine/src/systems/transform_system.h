@@ -0,0 +1,170 @@
+#pragma once
+
+#include "math/math_types.h"
+
+/**
+ * @file transform_system.h
+ *
+ * @brief Transform system.
+ *
+ * Stores the position, rotation and scale of every transform in structure-of-arrays form:
+ * one array per component, so four transforms at a time load straight into SIMD registers.
+ * Transforms may have a parent, in which case their world matrix is their local matrix
+ * followed by their parent's world matrix.
+ *
+ * Changing a transform only marks it dirty. `transform_system_update()` then:
+ * - Recomposes the local matrices of dirty transforms, four at a time with SIMD.
+ * - Recomputes the world matrices of dirty transforms and everything below them. The hierarchy
+ *   is kept flattened by depth, so every parent is computed before its children, and each depth
+ *   is a flat range that is split across the job system.
+ *
+ * Usage:
+ * - Initialize the transform system with `transform_system_initialize()`, providing configuration options.
+ *   The state block must be 16-byte aligned.
+ * - Create transforms with `transform_create()` and move them with the `transform_set_*()` functions.
+ * - Call `transform_system_update()` once per frame, then read the results with `transform_get_world()`.
+ * - Shutdown the transform system with `transform_system_shutdown()`.
+ *
+ * NOTE: Not thread-safe, other than the jobs `transform_system_update()` runs internally.
+ */
+
+/**
+ * @struct transform_system_config
+ *
+ * @brief Configuration options for initializing the transform system.
+ */
+typedef struct transform_system_config {
+    /** Maximum number of transforms that can exist at once. */
+    u32 max_transform_count;
+} transform_system_config;
+
+/**
+ * @brief Initializes the transform system.
+ *
+ * @param memory_requirement Pointer to store the required memory size for the transform system.
+ * @param state Pointer to pre-allocated, 16-byte aligned memory for the transform system state.
+ * @param config Configuration options for the transform system.
+ *
+ * @return Returns true if initialization was successful, false otherwise.
+ */
+b8 transform_system_initialize(u64* memory_requirement, void* state, transform_system_config config);
+
+/**
+ * @brief Shuts down the transform system.
+ *
+ * @param state Pointer to the transform system state to be shut down.
+ */
+void transform_system_shutdown(void* state);
+
+/**
+ * @brief Recomputes the local and world matrices of every transform changed since the last update,
+ * and the world matrices of everything below them.
+ */
+KAPI void transform_system_update();
+
+/**
+ * @brief Creates a transform at the origin, with no rotation, a scale of one and no parent.
+ *
+ * @return The id of the transform, or INVALID_ID if the maximum number of transforms exist.
+ */
+KAPI u32 transform_create();
+
+/**
+ * @brief Creates a transform from the given position, rotation and scale, with no parent.
+ *
+ * @param position The position.
+ * @param rotation The rotation.
+ * @param scale The scale.
+ * @return The id of the transform, or INVALID_ID if the maximum number of transforms exist.
+ */
+KAPI u32 transform_from_position_rotation_scale(vec3 position, quat rotation, vec3 scale);
+
+/**
+ * @brief Destroys a transform. Its children become roots, keeping their local transforms.
+ *
+ * @param id The id of the transform.
+ */
+KAPI void transform_destroy(u32 id);
+
+/**
+ * @brief Sets the parent of a transform.
+ *
+ * @param id The id of the transform.
+ * @param parent_id The id of the new parent, or INVALID_ID to make the transform a root.
+ * @return True on success; False if the parent does not exist or would create a cycle.
+ */
+KAPI b8 transform_set_parent(u32 id, u32 parent_id);
+
+/**
+ * @brief Obtains the parent of a transform.
+ *
+ * @param id The id of the transform.
+ * @return The id of the parent, or INVALID_ID if the transform is a root.
+ */
+KAPI u32 transform_get_parent(u32 id);
+
+/**
+ * @brief Obtains the position of a transform, relative to its parent.
+ *
+ * @param id The id of the transform.
+ * @return The position.
+ */
+KAPI vec3 transform_get_position(u32 id);
+
+/**
+ * @brief Sets the position of a transform, relative to its parent.
+ *
+ * @param id The id of the transform.
+ * @param position The position.
+ */
+KAPI void transform_set_position(u32 id, vec3 position);
+
+/**
+ * @brief Obtains the rotation of a transform, relative to its parent.
+ *
+ * @param id The id of the transform.
+ * @return The rotation.
+ */
+KAPI quat transform_get_rotation(u32 id);
+
+/**
+ * @brief Sets the rotation of a transform, relative to its parent.
+ *
+ * @param id The id of the transform.
+ * @param rotation The rotation. Need not be normalized.
+ */
+KAPI void transform_set_rotation(u32 id, quat rotation);
+
+/**
+ * @brief Obtains the scale of a transform, relative to its parent.
+ *
+ * @param id The id of the transform.
+ * @return The scale.
+ */
+KAPI vec3 transform_get_scale(u32 id);
+
+/**
+ * @brief Sets the scale of a transform, relative to its parent.
+ *
+ * @param id The id of the transform.
+ * @param scale The scale.
+ */
+KAPI void transform_set_scale(u32 id, vec3 scale);
+
+/**
+ * @brief Obtains the local matrix of a transform as of the last update: its scale, then its
+ * rotation, then its position.
+ *
+ * @param id The id of the transform.
+ * @return The local matrix.
+ */
+KAPI mat4 transform_get_local(u32 id);
+
+/**
+ * @brief Obtains the world matrix of a transform as of the last update: its local matrix,
+ * then its parent's world matrix.
+ *
+ * @param id The id of the transform.
+ * @return The world matrix.
+ */
+KAPI mat4 transform_get_world(u32 id);
@@ -0,0 +1,358 @@
+#include <defines.h>
+#include <core/logger.h>
+#include <core/kmemory.h>
+#include <core/kstring.h>
+#include <containers/darray.h>
+#include <platform/filesystem.h>
+#include <resources/kpak.h>
+#include <resources/ktex.h>
+
+// Textures are decoded here to be cooked, so the packer keeps its own private copy of stb_image.
+#define STB_IMAGE_STATIC
+#define STB_IMAGE_IMPLEMENTATION
+#include <vendor/stb_image.h>
+
+#if KPLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+/**
+ * @file main.c
+ * @brief Entry point for the asset packer.
+ *
+ * Packs every file under a directory into a single .kpak archive, which the resource system
+ * mounts in place of the loose files.
+ *
+ * Usage: packer [source_dir] [output_path] [--store] [--no-cook]
+ * - source_dir defaults to "../assets", and output_path to "assets.kpak", matching the paths
+ *   the engine uses when run from bin/.
+ * - --store disables compression, so that every entry is read in place.
+ * - --no-cook packs textures as their source PNGs, rather than cooking them.
+ *
+ * Entries are named by their path relative to source_dir, with '/' separators.
+ *
+ * PNGs under textures/ are cooked: decoded, given a full mip chain and block-compressed into a
+ * .ktex entry, which the image loader prefers over the PNG. Cooking happens here, rather than
+ * next to the sources, so that loose assets are always the ones being edited.
+ */
+
+/** @brief The longest path the packer handles. */
+#define PACKER_MAX_PATH 512
+
+/** @brief The directory, within the source directory, whose images are cooked. */
+#define PACKER_TEXTURE_PREFIX "textures/"
+
+/**
+ * @struct packer_file
+ * @brief A file found under the source directory.
+ */
+typedef struct packer_file {
+    /** The path of the file on disk. */
+    char* path;
+    /** The path of the entry within the archive. */
+    char* name;
+} packer_file;
+
+/**
+ * @brief Checks whether a file name ends with an extension, ignoring case.
+ *
+ * @param name The name of the file.
+ * @param extension The extension, including the '.'.
+ * @return True if the name has the extension.
+ */
+static b8 has_extension(const char* name, const char* extension) {
+    u64 length = string_length(name);
+    u64 extension_length = string_length(extension);
+    return length >= extension_length && strings_equali(name + length - extension_length, extension);
+}
+
+/**
+ * @brief Checks whether a file is in a format that is already compressed, and not worth trying again.
+ *
+ * @param name The name of the file.
+ * @return True if the file should be stored as-is.
+ */
+static b8 is_precompressed(const char* name) {
+    return has_extension(name, ".png") || has_extension(name, ".jpg") || has_extension(name, ".jpeg");
+}
+
+/**
+ * @brief Adds a file to the list.
+ *
+ * @param files The darray of files.
+ * @param path The path of the file on disk.
+ * @param name The path of the entry within the archive.
+ * @return The darray, which may have moved.
+ */
+static packer_file* add_file(packer_file* files, const char* path, const char* name) {
+    // Never pack an earlier archive written into the source directory.
+    if (has_extension(name, ".kpak")) {
+        return files;
+    }
+
+    packer_file file;
+    file.path = string_duplicate(path);
+    file.name = string_duplicate(name);
+    darray_push(files, file);
+    return files;
+}
+
+/**
+ * @brief Collects every file under a directory, recursively.
+ *
+ * @param files The darray of files.
+ * @param directory The directory on disk.
+ * @param prefix The entry path of the directory within the archive, or "" for the root.
+ * @return The darray, which may have moved.
+ */
+static packer_file* collect_files(packer_file* files, const char* directory, const char* prefix) {
+    char path[PACKER_MAX_PATH];
+    char name[PACKER_MAX_PATH];
+
+#if KPLATFORM_WINDOWS
+    char pattern[PACKER_MAX_PATH];
+    string_format(pattern, "%s/*", directory);
+
+    WIN32_FIND_DATAA find_data;
+    HANDLE find = FindFirstFileA(pattern, &find_data);
+    if (find == INVALID_HANDLE_VALUE) {
+        KERROR("Unable to read directory '%s'.", directory);
+        return files;
+    }
+
+    do {
+        const char* child = find_data.cFileName;
+        if (strings_equal(child, ".") || strings_equal(child, "..")) {
+            continue;
+        }
+        string_nformat(path, PACKER_MAX_PATH, "%s/%s", directory, child);
+        string_nformat(name, PACKER_MAX_PATH, prefix[0] ? "%s/%s" : "%s%s", prefix, child);
+
+        if (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            files = collect_files(files, path, name);
+        } else {
+            files = add_file(files, path, name);
+        }
+    } while (FindNextFileA(find, &find_data));
+
+    FindClose(find);
+#else
+    DIR* dir = opendir(directory);
+    if (!dir) {
+        KERROR("Unable to read directory '%s'.", directory);
+        return files;
+    }
+
+    struct dirent* child_entry;
+    while ((child_entry = readdir(dir)) != 0) {
+        const char* child = child_entry->d_name;
+        if (strings_equal(child, ".") || strings_equal(child, "..")) {
+            continue;
+        }
+        string_nformat(path, PACKER_MAX_PATH, "%s/%s", directory, child);
+        string_nformat(name, PACKER_MAX_PATH, prefix[0] ? "%s/%s" : "%s%s", prefix, child);
+
+        struct stat info;
+        if (stat(path, &info) != 0) {
+            KWARN("Unable to stat '%s'. Skipping.", path);
+            continue;
+        }
+
+        if (S_ISDIR(info.st_mode)) {
+            files = collect_files(files, path, name);
+        } else if (S_ISREG(info.st_mode)) {
+            files = add_file(files, path, name);
+        }
+    }
+
+    closedir(dir);
+#endif
+
+    return files;
+}
+
+/**
+ * @brief Reads a whole file into a new buffer.
+ *
+ * @param path The path of the file.
+ * @param out_data A pointer to hold the buffer, which is 0 for empty files.
+ * @param out_size A pointer to hold the size of the file.
+ * @return True if the file was read; otherwise False.
+ */
+static b8 read_file(const char* path, u8** out_data, u64* out_size) {
+    *out_data = 0;
+    *out_size = 0;
+
+    file_handle f;
+    if (!filesystem_open(path, FILE_MODE_READ, True, &f)) {
+        return False;
+    }
+
+    u64 size = 0;
+    if (!filesystem_size(&f, &size)) {
+        filesystem_close(&f);
+        return False;
+    }
+
+    if (size) {
+        *out_data = kallocate(size, MEMORY_TAG_ARRAY);
+        u64 read = 0;
+        if (!filesystem_read_all_bytes(&f, *out_data, &read)) {
+            kfree(*out_data, size, MEMORY_TAG_ARRAY);
+            *out_data = 0;
+            filesystem_close(&f);
+            return False;
+        }
+    }
+
+    filesystem_close(&f);
+    *out_size = size;
+    return True;
+}
+
+/**
+ * @brief Checks whether a file is a texture that should be cooked.
+ *
+ * @param name The path of the entry within the archive.
+ * @return True if the file is a PNG under the texture directory.
+ */
+static b8 is_cookable(const char* name) {
+    u64 prefix_length = string_length(PACKER_TEXTURE_PREFIX);
+    if (string_length(name) <= prefix_length) {
+        return False;
+    }
+    for (u64 i = 0; i < prefix_length; ++i) {
+        if (name[i] != PACKER_TEXTURE_PREFIX[i]) {
+            return False;
+        }
+    }
+    return has_extension(name, ".png");
+}
+
+/**
+ * @brief Cooks a texture in place of its source file.
+ *
+ * On success, the file's data is replaced by the cooked texture, and its entry is renamed from
+ * .png to .ktex.
+ *
+ * @param file The file, whose name may be replaced.
+ * @param source The source to cook, whose data and size are replaced.
+ * @return True if the texture was cooked; otherwise False, and the source is left as it was.
+ */
+static b8 cook_texture(packer_file* file, kpak_source* source) {
+    // Flipped to match the image loader, which hands PNGs out bottom row first.
+    stbi_set_flip_vertically_on_load(True);
+    i32 width = 0;
+    i32 height = 0;
+    i32 channel_count = 0;
+    u8* pixels = stbi_load_from_memory(source->data, (i32)source->size, &width, &height, &channel_count, 4);
+    if (!pixels) {
+        KWARN("Unable to decode '%s' to cook it: %s. Packing it as-is.", file->path, stbi_failure_reason());
+        return False;
+    }
+
+    void* cooked = 0;
+    u64 cooked_size = 0;
+    b8 result = ktex_cook(pixels, (u32)width, (u32)height, True, &cooked, &cooked_size);
+    stbi_image_free(pixels);
+    if (!result) {
+        KWARN("Unable to cook '%s'. Packing it as-is.", file->path);
+        return False;
+    }
+
+    char name[PACKER_MAX_PATH];
+    i32 stem_length = (i32)(string_length(file->name) - string_length(".png"));
+    string_nformat(name, PACKER_MAX_PATH, "%.*s.ktex", stem_length, file->name);
+
+    kfree((void*)source->data, source->size, MEMORY_TAG_ARRAY);
+    kfree(file->name, string_length(file->name) + 1, MEMORY_TAG_STRING);
+    file->name = string_duplicate(name);
+    source->name = file->name;
+    source->data = cooked;
+    source->size = cooked_size;
+    return True;
+}
+
+/**
+ * @brief Packer entry point.
+ *
+ * @return 0 if the archive was written; otherwise 1.
+ */
+int main(int argc, char** argv) {
+    const char* source_dir = "../assets";
+    const char* output_path = "assets.kpak";
+    b8 store = False;
+    b8 cook = True;
+
+    u32 positional = 0;
+    for (i32 i = 1; i < argc; ++i) {
+        if (strings_equal(argv[i], "--store")) {
+            store = True;
+        } else if (strings_equal(argv[i], "--no-cook")) {
+            cook = False;
+        } else if (positional == 0) {
+            source_dir = argv[i];
+            positional++;
+        } else if (positional == 1) {
+            output_path = argv[i];
+            positional++;
+        } else {
+            KERROR("Usage: packer [source_dir] [output_path] [--store] [--no-cook]");
+            return 1;
+        }
+    }
+
+    packer_file* files = darray_create(packer_file);
+    files = collect_files(files, source_dir, "");
+    u32 file_count = (u32)darray_length(files);
+
+    kpak_source* sources = kallocate(sizeof(kpak_source) * (file_count ? file_count : 1), MEMORY_TAG_ARRAY);
+    b8 success = True;
+    u64 total_size = 0;
+    u32 cooked_count = 0;
+    u64 cooked_size = 0;
+    for (u32 i = 0; i < file_count; ++i) {
+        u8* data = 0;
+        u64 size = 0;
+        if (!read_file(files[i].path, &data, &size)) {
+            KERROR("Unable to read '%s'.", files[i].path);
+            success = False;
+            break;
+        }
+        total_size += size;
+        sources[i].name = files[i].name;
+        sources[i].data = data;
+        sources[i].size = size;
+        if (cook && is_cookable(files[i].name) && cook_texture(&files[i], &sources[i])) {
+            cooked_count++;
+            cooked_size += sources[i].size;
+        }
+        sources[i].compress = !store && !is_precompressed(files[i].name);
+    }
+
+    if (success) {
+        success = kpak_write(output_path, file_count, sources);
+    }
+    if (success) {
+        KINFO("Packed %u files (%llu bytes) from '%s' into '%s'.", file_count, total_size, source_dir, output_path);
+        if (cooked_count) {
+            KINFO("Cooked %u textures, into %llu bytes.", cooked_count, cooked_size);
+        }
+    }
+
+    for (u32 i = 0; i < file_count; ++i) {
+        if (sources[i].data) {
+            kfree((void*)sources[i].data, sources[i].size, MEMORY_TAG_ARRAY);
+        }
+        kfree(files[i].path, string_length(files[i].path) + 1, MEMORY_TAG_STRING);
+        kfree(files[i].name, string_length(files[i].name) + 1, MEMORY_TAG_STRING);
+    }
+    kfree(sources, sizeof(kpak_source) * (file_count ? file_count : 1), MEMORY_TAG_ARRAY);
+    darray_destroy(files);
+
+    return success ? 0 : 1;
+}
@@ -10,4 +10,12 @@ echo "assets/shaders/Builtin.MaterialShader.frag.glsl -> assets/shaders/Builtin.
 %VULKAN_SDK%\bin\glslc.exe -fshader-stage=frag assets/shaders/Builtin.MaterialShader.frag.glsl -o assets/shaders/Builtin.MaterialShader.frag.spv
 IF %ERRORLEVEL% NEQ 0 (echo Error: %ERRORLEVEL% && exit)
 
+echo "Packing assets..."
+
+REM The packer loads engine.dll from bin\, and writes bin\assets.kpak.
+PUSHD bin
+packer.exe ../assets assets.kpak
+POPD
+IF %ERRORLEVEL% NEQ 0 (echo Error: %ERRORLEVEL% && exit)
+
 echo "Done."
\ No newline at end of file
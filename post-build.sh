@@ -18,4 +18,16 @@ then
 echo "Error:"$ERRORLEVEL && exit
 fi
 
+echo "Packing assets..."
+
+# The packer links against libengine.so from bin/, and writes bin/assets.kpak.
+pushd bin > /dev/null
+./packer ../assets assets.kpak
+ERRORLEVEL=$?
+popd > /dev/null
+if [ $ERRORLEVEL -ne 0 ]
+then
+echo "Error:"$ERRORLEVEL && exit
+fi
+
 echo "Done."
\ No newline at end of file
@@ -24,6 +24,8 @@ b8 create_game(game* out_game) {
     out_game->app_config.start_width = 1280;
     out_game->app_config.start_height = 720;
     out_game->app_config.name = "Koru Engine Testbed";
+    out_game->app_config.heap_size = 256 * 1024 * 1024;  // 256 MB
+    out_game->app_config.staging_buffer_size = 64 * 1024 * 1024;  // 64 MB
 
     // Assign function pointers
     out_game->update = game_update;
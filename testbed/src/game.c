@@ -9,6 +9,7 @@
 
 // TO-DO: (Remove) This should never be available outside the engine
 #include <renderer/renderer_frontend.h>
+#include <systems/texture_system.h>
 
 /**
  * @file game.c
@@ -23,6 +24,56 @@
  * Can be extended to add real gameplay features.
  */
 
+/** @brief The number of particles simulated through the entity world. */
+#define TESTBED_PARTICLE_COUNT 100000
+
+/** @brief How far particles may drift from the origin on each axis before bouncing back. */
+#define TESTBED_PARTICLE_BOUNDS 50.0f
+
+/**
+ * @brief Moves each particle by its velocity, bouncing it off the bounds.
+ */
+static void particle_system(const ecs_view* view, f32 delta_time, void* user_data) {
+    game_state* state = user_data;
+    vec3* positions = ecs_view_get(view, state->position_component);
+    vec3* velocities = ecs_view_get(view, state->velocity_component);
+    for (u32 i = 0; i < view->count; ++i) {
+        for (u32 axis = 0; axis < 3; ++axis) {
+            f32 p = positions[i].elements[axis] + velocities[i].elements[axis] * delta_time;
+            if (p > TESTBED_PARTICLE_BOUNDS || p < -TESTBED_PARTICLE_BOUNDS) {
+                velocities[i].elements[axis] = -velocities[i].elements[axis];
+                p = KCLAMP(p, -TESTBED_PARTICLE_BOUNDS, TESTBED_PARTICLE_BOUNDS);
+            }
+            positions[i].elements[axis] = p;
+        }
+    }
+}
+
+/**
+ * @brief Spawns the particles if none are alive; otherwise destroys them.
+ */
+static void toggle_particles(game_state* state, ecs_world* world) {
+    if (state->particles) {
+        for (u32 i = 0; i < TESTBED_PARTICLE_COUNT; ++i) {
+            ecs_entity_destroy(world, state->particles[i]);
+        }
+        kfree(state->particles, sizeof(ecs_entity) * TESTBED_PARTICLE_COUNT, MEMORY_TAG_GAME);
+        state->particles = 0;
+        KDEBUG("Particles off.");
+        return;
+    }
+
+    ecs_component_mask components = ECS_COMPONENT_BIT(state->position_component) | ECS_COMPONENT_BIT(state->velocity_component);
+    state->particles = kallocate(sizeof(ecs_entity) * TESTBED_PARTICLE_COUNT, MEMORY_TAG_GAME);
+    for (u32 i = 0; i < TESTBED_PARTICLE_COUNT; ++i) {
+        ecs_entity particle = ecs_entity_create(world, components);
+        *(vec3*)ecs_entity_get(world, particle, state->velocity_component) =
+            vec3_create(fkrandom_in_range(-5.0f, 5.0f), fkrandom_in_range(-5.0f, 5.0f), fkrandom_in_range(-5.0f, 5.0f));
+        state->particles[i] = particle;
+    }
+    KDEBUG("Particles on: %u simulated.", TESTBED_PARTICLE_COUNT);
+}
+
 /**
  *
  */
@@ -76,6 +127,26 @@ b8 game_initialize(game* game_inst) {
     state->view = mat4_inverse(state->view);
     state->camera_view_dirty = True;
 
+    // Particles, to exercise the entity world with many simulated objects. None are spawned
+    // until toggled on with P, so they do not weigh on every other measurement.
+    ecs_world* world = game_inst->world;
+    state->particles = 0;
+    state->position_component = ecs_component_register(world, sizeof(vec3));
+    state->velocity_component = ecs_component_register(world, sizeof(vec3));
+    ecs_component_mask position = ECS_COMPONENT_BIT(state->position_component);
+    ecs_component_mask velocity = ECS_COMPONENT_BIT(state->velocity_component);
+
+    ecs_system_config particles = {0};
+    particles.name = "particles";
+    particles.query.all = position | velocity;
+    particles.write = position | velocity;
+    particles.run = particle_system;
+    particles.user_data = state;
+    if (ecs_system_register(world, &particles) == INVALID_ID) {
+        KERROR("Failed to register the particle system.");
+        return False;
+    }
+
     return True;
 }
 
@@ -100,6 +171,15 @@ b8 game_update(game* game_inst, f32 delta_time) {
         KDEBUG("Memory Allocations: %llu (%llu this frame)", alloc_count, alloc_count - prev_alloc_count);
     }
 
+    if (input_is_key_up('E') && input_was_key_down('E')) {
+        KDEBUG("Entities: %u", game_inst->world->entity_count);
+    }
+
+    // Toggle the particle simulation.
+    if (input_is_key_up('P') && input_was_key_down('P')) {
+        toggle_particles((game_state*)game_inst->state, game_inst->world);
+    }
+
     // TODO: temp
     if (input_is_key_up('T') && input_was_key_down('T')) {
         KDEBUG("Swapping texture!");
@@ -107,6 +187,24 @@ b8 game_update(game* game_inst, f32 delta_time) {
 
         event_fire(EVENT_CODE_DEBUG0, game_inst, context);
     }
+
+    // Toggle between direct and indirect drawing.
+    if (input_is_key_up('I') && input_was_key_down('I')) {
+        renderer_draw_mode mode = renderer_get_draw_mode() == RENDERER_DRAW_MODE_DIRECT ? RENDERER_DRAW_MODE_INDIRECT : RENDERER_DRAW_MODE_DIRECT;
+        renderer_set_draw_mode(mode);
+    }
+
+    if (input_is_key_up('C') && input_was_key_down('C')) {
+        render_cull_stats stats = renderer_get_cull_stats();
+        KDEBUG("Culling: %u tested, %u culled, %u drawn.", stats.tested, stats.culled, stats.tested - stats.culled);
+    }
+
+    if (input_is_key_up('R') && input_was_key_down('R')) {
+        texture_residency_stats stats = texture_system_get_residency_stats();
+        KDEBUG("Textures: %llu of %llu bytes resident, %u full, %u reduced, %u evicted (%llu reductions, %llu evictions, %llu restorations).",
+               stats.resident_bytes, stats.budget_bytes, stats.full_count, stats.reduced_count, stats.evicted_count,
+               stats.reductions, stats.evictions, stats.restorations);
+    }
     // TODO: end temp
 
     game_state* state = (game_state*)game_inst->state;
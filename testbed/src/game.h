@@ -46,6 +46,21 @@ typedef struct game_state {
     vec3 camera_euler;
 
     b8 camera_view_dirty;
+
+    /**
+     * @brief The id of the position component of the simulated particles.
+     */
+    u32 position_component;
+
+    /**
+     * @brief The id of the velocity component of the simulated particles.
+     */
+    u32 velocity_component;
+
+    /**
+     * @brief The handles of the simulated particles, or 0 while they are toggled off.
+     */
+    ecs_entity* particles;
 } game_state;
 
 /**
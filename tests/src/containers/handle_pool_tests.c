@@ -0,0 +1,147 @@
+#include "handle_pool_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <containers/handle_pool.h>
+#include <core/kmemory.h>
+
+/**
+ * @file handle_pool_tests.c
+ * @brief Unit tests for the handle pool.
+ *
+ * These tests validate:
+ * - Slots being handed out lowest index first, until the pool runs out
+ * - Released slots being reused, with handles to their previous occupant going stale
+ * - Stale, doubly released and out of range handles being rejected
+ */
+
+/**
+ * @brief Tests that slots are handed out in order until none are left, and that an invalid
+ * capacity is rejected.
+ */
+u8 handle_pool_should_acquire_until_full() {
+    u64 requirement = 0;
+    handle_pool pool;
+    expect_to_be_false(handle_pool_create(0, &requirement, 0, 0));
+
+    expect_to_be_true(handle_pool_create(4, &requirement, 0, 0));
+    void* memory = kallocate(requirement, MEMORY_TAG_ARRAY);
+    expect_to_be_true(handle_pool_create(4, &requirement, memory, &pool));
+    expect_should_be(sizeof(u32) * 4 * 2, requirement);
+    expect_should_be(0, handle_pool_live_count(&pool));
+
+    khandle handles[4];
+    for (u32 i = 0; i < 4; ++i) {
+        expect_to_be_true(handle_pool_acquire(&pool, &handles[i]));
+        expect_should_be(i, handle_pool_index(handles[i]));
+        expect_should_not_be(KHANDLE_INVALID, handles[i]);
+        expect_to_be_true(handle_pool_is_valid(&pool, handles[i]));
+    }
+    expect_should_be(4, handle_pool_live_count(&pool));
+
+    khandle extra;
+    expect_to_be_false(handle_pool_acquire(&pool, &extra));
+
+    // Live slots can be found from their index.
+    expect_should_be(handles[2], handle_pool_handle_at(&pool, 2));
+    expect_should_be(KHANDLE_INVALID, handle_pool_handle_at(&pool, 4));
+
+    handle_pool_destroy(&pool);
+    expect_should_be(0, pool.generations);
+    expect_to_be_false(handle_pool_is_valid(&pool, handles[0]));
+    kfree(memory, requirement, MEMORY_TAG_ARRAY);
+    return True;
+}
+
+/**
+ * @brief Tests that a released slot is handed out again with a new generation, and that handles
+ * to what it held before no longer match.
+ */
+u8 handle_pool_should_reuse_slots_with_new_generations() {
+    u64 requirement = 0;
+    handle_pool pool;
+    expect_to_be_true(handle_pool_create(8, &requirement, 0, 0));
+    void* memory = kallocate(requirement, MEMORY_TAG_ARRAY);
+    expect_to_be_true(handle_pool_create(8, &requirement, memory, &pool));
+
+    khandle first;
+    khandle second;
+    expect_to_be_true(handle_pool_acquire(&pool, &first));
+    expect_to_be_true(handle_pool_acquire(&pool, &second));
+
+    expect_to_be_true(handle_pool_release(&pool, first));
+    expect_to_be_false(handle_pool_is_valid(&pool, first));
+    expect_should_be(KHANDLE_INVALID, handle_pool_handle_at(&pool, 0));
+    expect_to_be_true(handle_pool_is_valid(&pool, second));
+
+    // The most recently released slot is reused first, at a later generation.
+    khandle reused;
+    expect_to_be_true(handle_pool_acquire(&pool, &reused));
+    expect_should_be(handle_pool_index(first), handle_pool_index(reused));
+    b8 newer = handle_pool_generation(reused) > handle_pool_generation(first);
+    expect_to_be_true(newer);
+    expect_to_be_true(handle_pool_is_valid(&pool, reused));
+    expect_to_be_false(handle_pool_is_valid(&pool, first));
+
+    // Churning one slot many times keeps every old handle stale.
+    khandle churned = reused;
+    for (u32 i = 0; i < 1000; ++i) {
+        expect_to_be_true(handle_pool_release(&pool, churned));
+        expect_to_be_true(handle_pool_acquire(&pool, &churned));
+    }
+    expect_should_be(handle_pool_index(first), handle_pool_index(churned));
+    expect_to_be_false(handle_pool_is_valid(&pool, reused));
+    expect_should_be(2, handle_pool_live_count(&pool));
+
+    kfree(memory, requirement, MEMORY_TAG_ARRAY);
+    return True;
+}
+
+/**
+ * @brief Tests that stale, doubly released, zero and out of range handles are rejected without
+ * disturbing live slots.
+ */
+u8 handle_pool_should_reject_invalid_handles() {
+    u64 requirement = 0;
+    handle_pool pool;
+    expect_to_be_true(handle_pool_create(4, &requirement, 0, 0));
+    void* memory = kallocate(requirement, MEMORY_TAG_ARRAY);
+    expect_to_be_true(handle_pool_create(4, &requirement, memory, &pool));
+
+    khandle a;
+    khandle b;
+    expect_to_be_true(handle_pool_acquire(&pool, &a));
+    expect_to_be_true(handle_pool_acquire(&pool, &b));
+
+    expect_to_be_false(handle_pool_is_valid(&pool, KHANDLE_INVALID));
+    expect_to_be_false(handle_pool_release(&pool, KHANDLE_INVALID));
+
+    // A second release of the same handle must not free the slot's next occupant.
+    expect_to_be_true(handle_pool_release(&pool, a));
+    khandle c;
+    expect_to_be_true(handle_pool_acquire(&pool, &c));
+    expect_to_be_false(handle_pool_release(&pool, a));
+    expect_to_be_true(handle_pool_is_valid(&pool, c));
+    expect_should_be(2, handle_pool_live_count(&pool));
+
+    // A free slot's next generation was never handed out.
+    expect_to_be_true(handle_pool_release(&pool, b));
+    khandle forged = ((u64)(handle_pool_generation(b) + 1) << 32) | handle_pool_index(b);
+    expect_to_be_false(handle_pool_is_valid(&pool, forged));
+
+    // Out of range.
+    khandle outside = ((u64)1 << 32) | 4;
+    expect_to_be_false(handle_pool_is_valid(&pool, outside));
+    expect_to_be_false(handle_pool_release(&pool, outside));
+    expect_should_be(1, handle_pool_live_count(&pool));
+
+    kfree(memory, requirement, MEMORY_TAG_ARRAY);
+    return True;
+}
+
+void handle_pool_register_tests() {
+    test_manager_register_test(handle_pool_should_acquire_until_full, "Handle pool should acquire slots until full");
+    test_manager_register_test(handle_pool_should_reuse_slots_with_new_generations, "Handle pool should reuse slots with new generations");
+    test_manager_register_test(handle_pool_should_reject_invalid_handles, "Handle pool should reject stale and invalid handles");
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+/**
+ * @file handle_pool_tests.h
+ * @brief Unit tests for the handle pool implementation.
+ *
+ * Contains function declarations for various handle pool tests.
+ * All tests are registered via `handle_pool_register_tests()`.
+ */
+
+/**
+ * @brief Registers all handle pool tests with the test manager.
+ *
+ * Should be called before `test_manager_run_tests()` in main().
+ */
+void handle_pool_register_tests();
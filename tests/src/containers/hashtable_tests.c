@@ -4,6 +4,9 @@
 
 #include <defines.h>
 #include <containers/hashtable.h>
+#include <core/kmemory.h>
+#include <core/kstring.h>
+#include <core/clock.h>
 
 /**
  * @file hashtable_tests.c
@@ -12,6 +15,8 @@
  * These tests validate core functionality of the `hashtable` including:
  * - Creation and destruction
  * - Setting and getting values
+ * - Collision handling, removal and growth
+ * - Insert/lookup throughput at a high load factor
  *
  * Uses the custom test manager and assertion macros from `test_manager.h`.
  */
@@ -408,6 +413,205 @@ u8 hashtable_should_set_get_and_update_ptr_successfully() {
     return True;
 }
 
+/**
+ * @brief Tests that many colliding names can live in a small table without overwriting each other.
+ *
+ * Verifies:
+ * - Every entry inserted into a 3-slot table can be read back with its own value
+ * - The table grows past its initial size and moves off the provided memory block
+ * - The live entry count matches the number of names inserted
+ */
+u8 hashtable_should_handle_collisions_and_grow() {
+    hashtable table;
+    u64 element_size = sizeof(u64);
+    u32 element_count = 3;
+    u64 memory[3];
+
+    hashtable_create(element_size, element_count, memory, False, &table);
+
+    const u32 entry_count = 256;
+    char name[32];
+    for (u32 i = 0; i < entry_count; ++i) {
+        string_format(name, "collision_%u", i);
+        u64 value = i * 3;
+        expect_to_be_true(hashtable_set(&table, name, &value));
+    }
+
+    expect_should_be(entry_count, table.count);
+    expect_to_be_true(table.element_count > element_count);
+    expect_to_be_true(table.owns_memory);
+    expect_to_be_true(table.memory != (void*)memory);
+
+    for (u32 i = 0; i < entry_count; ++i) {
+        string_format(name, "collision_%u", i);
+        u64 value = 0;
+        hashtable_get(&table, name, &value);
+        expect_should_be(i * 3, value);
+    }
+
+    // Overwriting an existing name should not add a new entry.
+    u64 updated = 999;
+    hashtable_set(&table, "collision_7", &updated);
+    expect_should_be(entry_count, table.count);
+    u64 get_updated = 0;
+    hashtable_get(&table, "collision_7", &get_updated);
+    expect_should_be(999, get_updated);
+
+    hashtable_destroy(&table);
+
+    expect_should_be(0, table.memory);
+    expect_should_be(0, table.element_size);
+    expect_should_be(0, table.element_count);
+
+    return True;
+}
+
+/**
+ * @brief Tests removing entries, and that lookups still find entries probed past a tombstone.
+ *
+ * Verifies:
+ * - Removed entries are no longer found, and return the fill value
+ * - Entries sharing a probe chain with a removed entry are still found
+ * - Removed slots are reused by later inserts
+ */
+u8 hashtable_should_remove_and_reuse_slots() {
+    hashtable table;
+    u64 element_size = sizeof(u64);
+    u32 element_count = 64;
+    u64 memory[64];
+
+    hashtable_create(element_size, element_count, memory, False, &table);
+
+    u64 default_value = INVALID_ID_U64;
+    hashtable_fill(&table, &default_value);
+
+    char name[32];
+    for (u32 i = 0; i < 48; ++i) {
+        string_format(name, "entry_%u", i);
+        u64 value = i;
+        hashtable_set(&table, name, &value);
+    }
+
+    // Remove every other entry.
+    for (u32 i = 0; i < 48; i += 2) {
+        string_format(name, "entry_%u", i);
+        expect_to_be_true(hashtable_remove(&table, name));
+    }
+    expect_should_be(24, table.count);
+    expect_should_be(24, table.tombstone_count);
+
+    // Removing again should report nothing was removed.
+    expect_to_be_false(hashtable_remove(&table, "entry_0"));
+
+    for (u32 i = 0; i < 48; ++i) {
+        string_format(name, "entry_%u", i);
+        u64 value = 0;
+        hashtable_get(&table, name, &value);
+        if (i % 2 == 0) {
+            expect_to_be_false(hashtable_contains(&table, name));
+            expect_should_be(INVALID_ID_U64, value);
+        } else {
+            expect_to_be_true(hashtable_contains(&table, name));
+            expect_should_be(i, value);
+        }
+    }
+
+    // Re-adding should reuse tombstones rather than growing the table.
+    for (u32 i = 0; i < 48; i += 2) {
+        string_format(name, "entry_%u", i);
+        u64 value = i + 100;
+        hashtable_set(&table, name, &value);
+    }
+    expect_should_be(48, table.count);
+    expect_should_be(64, table.element_count);
+
+    for (u32 i = 0; i < 48; i += 2) {
+        string_format(name, "entry_%u", i);
+        u64 value = 0;
+        hashtable_get(&table, name, &value);
+        expect_should_be(i + 100, value);
+    }
+
+    hashtable_destroy(&table);
+
+    expect_should_be(0, table.memory);
+    expect_should_be(0, table.element_size);
+    expect_should_be(0, table.element_count);
+
+    return True;
+}
+
+/**
+ * @brief Benchmarks inserts and lookups with the table held just under its maximum load factor,
+ * then churns removes/inserts to exercise tombstone purging.
+ *
+ * Verifies:
+ * - All entries are found at a high load factor without the table growing
+ * - Churn at a constant live count does not degrade into a rehash per insert
+ * - Timings are logged for comparison between builds
+ */
+u8 hashtable_benchmark_high_load_factor() {
+    const u32 element_count = 16384;
+    // Just under the 7/8 load factor, so the table never grows.
+    const u32 entry_count = (element_count * 7) / 8 - 1;
+
+    hashtable table;
+    u64* memory = kallocate(sizeof(u64) * element_count, MEMORY_TAG_ARRAY);
+    hashtable_create(sizeof(u64), element_count, memory, False, &table);
+
+    char name[32];
+    clock timer;
+    clock_start(&timer);
+    for (u32 i = 0; i < entry_count; ++i) {
+        string_format(name, "textures/bench_%u", i);
+        u64 value = i;
+        hashtable_set(&table, name, &value);
+    }
+    clock_update(&timer);
+    f64 insert_time = timer.elapsed;
+
+    clock_start(&timer);
+    for (u32 i = 0; i < entry_count; ++i) {
+        string_format(name, "textures/bench_%u", i);
+        u64 value = INVALID_ID_U64;
+        hashtable_get(&table, name, &value);
+        expect_should_be(i, value);
+    }
+    clock_update(&timer);
+    f64 lookup_time = timer.elapsed;
+
+    expect_should_be(element_count, table.element_count);
+    expect_should_be(entry_count, table.count);
+
+    // Churn: remove and re-add under new names, keeping the live count constant.
+    clock_start(&timer);
+    for (u32 i = 0; i < entry_count; ++i) {
+        string_format(name, "textures/bench_%u", i);
+        hashtable_remove(&table, name);
+        string_format(name, "materials/bench_%u", i);
+        u64 value = i;
+        hashtable_set(&table, name, &value);
+    }
+    clock_update(&timer);
+    f64 churn_time = timer.elapsed;
+
+    // Tombstones may have forced a single grow, but every live entry must still be present.
+    expect_should_be(entry_count, table.count);
+    expect_to_be_true(table.element_count <= element_count * 2);
+    for (u32 i = 0; i < entry_count; ++i) {
+        string_format(name, "materials/bench_%u", i);
+        expect_to_be_true(hashtable_contains(&table, name));
+    }
+
+    KINFO("Hashtable benchmark (%u entries, %u slots): insert %.6f sec, lookup %.6f sec, remove+insert churn %.6f sec.",
+          entry_count, element_count, insert_time, lookup_time, churn_time);
+
+    hashtable_destroy(&table);
+    kfree(memory, sizeof(u64) * element_count, MEMORY_TAG_ARRAY);
+
+    return True;
+}
+
 void hashtable_allocate_tests() {
     test_manager_register_test(hashtable_should_create_and_destroy, "Hashtable should create and destroy properly");
     test_manager_register_test(hashtable_should_set_and_get_successfully, "Hashtable should set and get successfully");
@@ -418,4 +622,7 @@ void hashtable_allocate_tests() {
     test_manager_register_test(hashtable_try_call_non_ptr_on_ptr_table, "Hashtable try calling non-pointer functions on pointer type table.");
     test_manager_register_test(hashtable_try_call_ptr_on_non_ptr_table, "Hashtable try calling pointer functions on non-pointer type table.");
     test_manager_register_test(hashtable_should_set_get_and_update_ptr_successfully, "Hashtable Should get pointer, update, and get again successfully.");
+    test_manager_register_test(hashtable_should_handle_collisions_and_grow, "Hashtable should handle colliding entries and grow.");
+    test_manager_register_test(hashtable_should_remove_and_reuse_slots, "Hashtable should remove entries and reuse their slots.");
+    test_manager_register_test(hashtable_benchmark_high_load_factor, "Hashtable benchmark at a high load factor.");
 }
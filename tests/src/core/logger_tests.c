@@ -0,0 +1,116 @@
+#include "logger_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <core/kmemory.h>
+#include <core/kstring.h>
+#include <core/kthread.h>
+#include <core/logger.h>
+#include <platform/filesystem.h>
+
+/**
+ * @file logger_tests.c
+ * @brief Unit tests for the asynchronous logger.
+ *
+ * These tests validate that messages logged from several threads at once all reach
+ * console.log intact, or are accounted for by the drop counter.
+ */
+
+/** @brief The number of threads logging at once. */
+#define LOGGER_TEST_THREAD_COUNT 4
+
+/** @brief The number of messages each thread logs. */
+#define LOGGER_TEST_MESSAGE_COUNT 256
+
+/** @brief Prefix of every message logged by this test. */
+#define LOGGER_TEST_TAG "logger test message "
+
+/** @brief Logs LOGGER_TEST_MESSAGE_COUNT tagged messages. */
+static u32 logging_thread(void* params) {
+    u32 thread_index = *(u32*)params;
+    for (u32 i = 0; i < LOGGER_TEST_MESSAGE_COUNT; ++i) {
+        KTRACE(LOGGER_TEST_TAG "%u/%u", thread_index, i);
+    }
+    return 0;
+}
+
+/** @brief Returns a pointer just past the test message tag in line, or 0 if the line has none. */
+static char* find_test_message(char* line) {
+    const char* tag = LOGGER_TEST_TAG;
+    for (char* start = line; *start; ++start) {
+        u32 i = 0;
+        while (tag[i] && start[i] == tag[i]) {
+            i++;
+        }
+        if (!tag[i]) {
+            return start + i;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Tests logging from several threads at once.
+ *
+ * Verifies:
+ * - Every message is either written to console.log in one piece, or counted as dropped
+ * - Each thread's messages are written in the order they were logged
+ */
+u8 logger_should_write_messages_from_many_threads() {
+    u64 requirement = 0;
+    initialize_logging(&requirement, 0);
+    void* state = kallocate(requirement, MEMORY_TAG_APPLICATION);
+    expect_to_be_true(initialize_logging(&requirement, state));
+
+    kthread threads[LOGGER_TEST_THREAD_COUNT];
+    u32 indices[LOGGER_TEST_THREAD_COUNT];
+    for (u32 i = 0; i < LOGGER_TEST_THREAD_COUNT; ++i) {
+        indices[i] = i;
+        expect_to_be_true(kthread_create(logging_thread, &indices[i], False, &threads[i]));
+    }
+    for (u32 i = 0; i < LOGGER_TEST_THREAD_COUNT; ++i) {
+        kthread_wait(&threads[i]);
+        kthread_destroy(&threads[i]);
+    }
+
+    logger_flush();
+    u64 dropped = logger_dropped_count();
+    shutdown_logging(state);
+    kfree(state, requirement, MEMORY_TAG_APPLICATION);
+
+    // Count the test messages that made it out, checking each thread's are in order.
+    file_handle f;
+    expect_to_be_true(filesystem_open("console.log", FILE_MODE_READ, False, &f));
+
+    i32 next_message[LOGGER_TEST_THREAD_COUNT] = {0};
+    u32 found = 0;
+    char line_buf[512] = "";
+    char* p = &line_buf[0];
+    u64 line_length = 0;
+    while (filesystem_read_line(&f, 511, &p, &line_length)) {
+        char* message = find_test_message(line_buf);
+        if (message) {
+            u32 thread_index = 0;
+            u32 message_index = 0;
+            expect_to_be_true(string_to_u32(message, &thread_index));
+            i32 separator = string_index_of(message, '/');
+            expect_to_be_true(separator > 0);
+            expect_to_be_true(string_to_u32(message + separator + 1, &message_index));
+            expect_to_be_true(thread_index < LOGGER_TEST_THREAD_COUNT);
+            expect_to_be_true((i32)message_index >= next_message[thread_index]);
+            next_message[thread_index] = message_index + 1;
+            found++;
+        }
+        kzero_memory(line_buf, sizeof(line_buf));
+    }
+    filesystem_close(&f);
+
+    expect_should_be(LOGGER_TEST_THREAD_COUNT * LOGGER_TEST_MESSAGE_COUNT, found + dropped);
+
+    return True;
+}
+
+void logger_register_tests() {
+    test_manager_register_test(logger_should_write_messages_from_many_threads, "Logger should write messages logged from many threads");
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+/**
+ * @file logger_tests.h
+ * @brief Unit tests for the asynchronous logger.
+ *
+ * Contains function declarations for the logger tests.
+ * All tests are registered via `logger_register_tests()`.
+ */
+
+/**
+ * @brief Registers all logger tests with the test manager.
+ *
+ * Should be called before `test_manager_run_tests()` in main().
+ */
+void logger_register_tests();
@@ -0,0 +1,402 @@
+#include "ecs_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+#include "../test_utils.h"
+
+#include <defines.h>
+#include <core/kmemory.h>
+#include <core/clock.h>
+#include <core/logger.h>
+#include <math/kmath.h>
+#include <ecs/ecs.h>
+#include <systems/job_system.h>
+
+/**
+ * @file ecs_tests.c
+ * @brief Unit tests for the entity component system.
+ *
+ * These tests validate core functionality of `ecs` including:
+ * - Handles going stale once their entity is destroyed, even after its index is reused
+ * - Components keeping their values as entities move between archetypes and chunks
+ * - Queries visiting every matching entity exactly once
+ * - Systems being placed in phases by the components they touch, and run in that order
+ *
+ * A benchmark also logs the time of a system moving 200k entities, run on worker threads.
+ *
+ * Uses the custom test manager and assertion macros from `test_manager.h`.
+ */
+
+/** @brief The number of entities the benchmark moves. */
+#define ECS_BENCHMARK_COUNT 200000
+
+/** @brief The number of worker threads started for the tests that run systems. */
+#define ECS_TEST_WORKERS 4
+
+/** @brief The components used by the tests. */
+typedef struct test_components {
+    u32 position;
+    u32 velocity;
+    u32 tag;
+} test_components;
+
+static void register_components(ecs_world* world, test_components* out_components) {
+    out_components->position = ecs_component_register(world, sizeof(vec3));
+    out_components->velocity = ecs_component_register(world, sizeof(vec3));
+    out_components->tag = ecs_component_register(world, sizeof(u32));
+}
+
+/**
+ * @brief Tests that handles stop referring to an entity once it is destroyed.
+ *
+ * Verifies:
+ * - A stale handle is not alive, and has no components, even once its index is reused
+ * - Destroying through a stale handle leaves the new entity alone
+ * - The null handle never refers to an entity
+ */
+u8 ecs_entity_handles_should_be_generational() {
+    ecs_world world;
+    expect_to_be_true(ecs_world_create(&world));
+    test_components components;
+    register_components(&world, &components);
+
+    ecs_entity first = ecs_entity_create(&world, ECS_COMPONENT_BIT(components.position));
+    expect_should_not_be(ECS_ENTITY_NULL, first);
+    expect_to_be_true(ecs_entity_is_alive(&world, first));
+
+    ecs_entity_destroy(&world, first);
+    expect_to_be_false(ecs_entity_is_alive(&world, first));
+    expect_should_be(0, world.entity_count);
+
+    // The index is reused, with a new generation.
+    ecs_entity second = ecs_entity_create(&world, ECS_COMPONENT_BIT(components.position));
+    expect_should_be((u32)first, (u32)second);
+    expect_should_not_be(first, second);
+    expect_to_be_false(ecs_entity_is_alive(&world, first));
+    expect_to_be_false(ecs_entity_has(&world, first, components.position));
+    expect_to_be_false(ecs_entity_add(&world, first, components.velocity));
+
+    ecs_entity_destroy(&world, first);
+    expect_to_be_true(ecs_entity_is_alive(&world, second));
+    expect_should_be(1, world.entity_count);
+
+    expect_to_be_false(ecs_entity_is_alive(&world, ECS_ENTITY_NULL));
+
+    // Unregistered components are refused.
+    expect_should_be(ECS_ENTITY_NULL, ecs_entity_create(&world, ECS_COMPONENT_BIT(components.tag + 1)));
+
+    ecs_world_destroy(&world);
+    return True;
+}
+
+/**
+ * @brief Tests that components keep their values while entities are created, destroyed and
+ * move between archetypes, spread over many chunks.
+ */
+u8 ecs_components_should_survive_archetype_moves() {
+    const u32 count = 5000;
+    ecs_world world;
+    expect_to_be_true(ecs_world_create(&world));
+    test_components components;
+    register_components(&world, &components);
+
+    ecs_entity* entities = kallocate(sizeof(ecs_entity) * count, MEMORY_TAG_ARRAY);
+    for (u32 i = 0; i < count; ++i) {
+        entities[i] = ecs_entity_create(&world, ECS_COMPONENT_BIT(components.position) | ECS_COMPONENT_BIT(components.tag));
+        vec3* position = ecs_entity_get(&world, entities[i], components.position);
+        *position = vec3_create((f32)i, 0.0f, 0.0f);
+        *(u32*)ecs_entity_get(&world, entities[i], components.tag) = i;
+    }
+
+    // Every other entity gains a velocity, every third loses its position, every fifth is destroyed.
+    for (u32 i = 0; i < count; i += 2) {
+        expect_to_be_true(ecs_entity_add(&world, entities[i], components.velocity));
+        vec3* velocity = ecs_entity_get(&world, entities[i], components.velocity);
+        expect_float_to_be(0.0f, velocity->x);
+        velocity->y = (f32)i;
+    }
+    for (u32 i = 0; i < count; i += 3) {
+        expect_to_be_true(ecs_entity_remove(&world, entities[i], components.position));
+    }
+    for (u32 i = 0; i < count; i += 5) {
+        ecs_entity_destroy(&world, entities[i]);
+    }
+
+    u32 alive = 0;
+    for (u32 i = 0; i < count; ++i) {
+        if (i % 5 == 0) {
+            expect_to_be_false(ecs_entity_is_alive(&world, entities[i]));
+            continue;
+        }
+        alive++;
+        expect_should_be(i, *(u32*)ecs_entity_get(&world, entities[i], components.tag));
+
+        vec3* position = ecs_entity_get(&world, entities[i], components.position);
+        b8 should_have_position = i % 3 != 0;
+        b8 has_position = position != 0;
+        expect_should_be(should_have_position, has_position);
+        if (position) {
+            expect_float_to_be((f32)i, position->x);
+        }
+
+        vec3* velocity = ecs_entity_get(&world, entities[i], components.velocity);
+        b8 should_have_velocity = i % 2 == 0;
+        b8 has_velocity = velocity != 0;
+        expect_should_be(should_have_velocity, has_velocity);
+        if (velocity) {
+            expect_float_to_be((f32)i, velocity->y);
+        }
+    }
+    expect_should_be(alive, world.entity_count);
+
+    kfree(entities, sizeof(ecs_entity) * count, MEMORY_TAG_ARRAY);
+    ecs_world_destroy(&world);
+    return True;
+}
+
+/**
+ * @brief Tests that queries visit every entity they match exactly once, and no others.
+ */
+u8 ecs_queries_should_visit_each_match_once() {
+    const u32 count = 3000;
+    ecs_world world;
+    expect_to_be_true(ecs_world_create(&world));
+    test_components components;
+    register_components(&world, &components);
+
+    u32* visits = kallocate(sizeof(u32) * count, MEMORY_TAG_ARRAY);
+    u32 expected = 0;
+    for (u32 i = 0; i < count; ++i) {
+        ecs_component_mask mask = ECS_COMPONENT_BIT(components.tag);
+        if (i % 2 == 0) {
+            mask |= ECS_COMPONENT_BIT(components.position);
+        }
+        if (i % 3 == 0) {
+            mask |= ECS_COMPONENT_BIT(components.velocity);
+        }
+        ecs_entity entity = ecs_entity_create(&world, mask);
+        *(u32*)ecs_entity_get(&world, entity, components.tag) = i;
+        if (i % 2 == 0 && i % 3 != 0) {
+            expected++;
+        }
+    }
+
+    // Position, but no velocity.
+    ecs_query query;
+    query.all = ECS_COMPONENT_BIT(components.position);
+    query.none = ECS_COMPONENT_BIT(components.velocity);
+    expect_should_be(expected, ecs_query_count(&world, query));
+
+    u32 visited = 0;
+    ecs_query_iter iter = ecs_query_begin(query);
+    while (ecs_query_next(&world, &iter)) {
+        const u32* tags = ecs_view_get(&iter.view, components.tag);
+        b8 has_tags = tags != 0;
+        b8 has_velocities = ecs_view_get(&iter.view, components.velocity) != 0;
+        expect_to_be_true(has_tags);
+        expect_to_be_false(has_velocities);
+        for (u32 i = 0; i < iter.view.count; ++i) {
+            expect_to_be_true(ecs_entity_is_alive(&world, iter.view.entities[i]));
+            visits[tags[i]]++;
+            visited++;
+        }
+    }
+    expect_should_be(expected, visited);
+    for (u32 i = 0; i < count; ++i) {
+        u32 should_visit = (i % 2 == 0 && i % 3 != 0) ? 1 : 0;
+        expect_should_be(should_visit, visits[i]);
+    }
+
+    kfree(visits, sizeof(u32) * count, MEMORY_TAG_ARRAY);
+    ecs_world_destroy(&world);
+    return True;
+}
+
+/** @brief The user data of the test systems. */
+typedef struct test_system_data {
+    test_components components;
+} test_system_data;
+
+/** @brief Moves each entity by its velocity. */
+static void integrate_system(const ecs_view* view, f32 delta_time, void* user_data) {
+    test_system_data* data = user_data;
+    vec3* positions = ecs_view_get(view, data->components.position);
+    const vec3* velocities = ecs_view_get(view, data->components.velocity);
+    for (u32 i = 0; i < view->count; ++i) {
+        positions[i].x += velocities[i].x * delta_time;
+        positions[i].y += velocities[i].y * delta_time;
+        positions[i].z += velocities[i].z * delta_time;
+    }
+}
+
+/** @brief Records each entity's position in its tag. */
+static void record_system(const ecs_view* view, f32 delta_time, void* user_data) {
+    test_system_data* data = user_data;
+    const vec3* positions = ecs_view_get(view, data->components.position);
+    u32* tags = ecs_view_get(view, data->components.tag);
+    for (u32 i = 0; i < view->count; ++i) {
+        tags[i] = (u32)positions[i].x;
+    }
+}
+
+/** @brief Doubles each entity's velocity. */
+static void accelerate_system(const ecs_view* view, f32 delta_time, void* user_data) {
+    test_system_data* data = user_data;
+    vec3* velocities = ecs_view_get(view, data->components.velocity);
+    for (u32 i = 0; i < view->count; ++i) {
+        velocities[i].x *= 2.0f;
+    }
+}
+
+/**
+ * @brief Tests that systems are placed in phases by the components they touch, and that each
+ * phase sees the results of the ones before it.
+ *
+ * Verifies:
+ * - A system reading what an earlier one writes runs after it
+ * - A system writing what an earlier one reads runs after it
+ * - Systems sharing only reads run together
+ */
+u8 ecs_systems_should_be_scheduled_by_conflicts() {
+    const u32 count = 20000;
+    void* job_state = 0;
+    u64 job_state_size = 0;
+    expect_to_be_true(test_start_job_system(ECS_TEST_WORKERS, 256, &job_state, &job_state_size));
+
+    ecs_world world;
+    expect_to_be_true(ecs_world_create(&world));
+    test_system_data data;
+    register_components(&world, &data.components);
+    ecs_component_mask position = ECS_COMPONENT_BIT(data.components.position);
+    ecs_component_mask velocity = ECS_COMPONENT_BIT(data.components.velocity);
+    ecs_component_mask tag = ECS_COMPONENT_BIT(data.components.tag);
+
+    ecs_entity* entities = kallocate(sizeof(ecs_entity) * count, MEMORY_TAG_ARRAY);
+    for (u32 i = 0; i < count; ++i) {
+        entities[i] = ecs_entity_create(&world, position | velocity | tag);
+        vec3* v = ecs_entity_get(&world, entities[i], data.components.velocity);
+        v->x = (f32)(i % 100);
+    }
+
+    ecs_system_config config;
+    kzero_memory(&config, sizeof(ecs_system_config));
+    config.user_data = &data;
+
+    config.name = "integrate";
+    config.query.all = position | velocity;
+    config.read = velocity;
+    config.write = position;
+    config.run = integrate_system;
+    u32 integrate = ecs_system_register(&world, &config);
+
+    config.name = "record";
+    config.query.all = position | tag;
+    config.read = position;
+    config.write = tag;
+    config.run = record_system;
+    u32 record = ecs_system_register(&world, &config);
+
+    config.name = "accelerate";
+    config.query.all = velocity;
+    config.read = 0;
+    config.write = velocity;
+    config.run = accelerate_system;
+    u32 accelerate = ecs_system_register(&world, &config);
+
+    expect_should_be(0, world.systems[integrate].phase);
+    expect_should_be(1, world.systems[record].phase);
+    expect_should_be(1, world.systems[accelerate].phase);
+    expect_should_be(2, world.phase_count);
+
+    // Two steps of one second: x moves by v, then by 2v once accelerated, and the record trails a step.
+    ecs_world_run_systems(&world, 1.0f);
+    ecs_world_run_systems(&world, 1.0f);
+    for (u32 i = 0; i < count; ++i) {
+        f32 v = (f32)(i % 100);
+        expect_float_to_be(3.0f * v, ((vec3*)ecs_entity_get(&world, entities[i], data.components.position))->x);
+        expect_float_to_be(4.0f * v, ((vec3*)ecs_entity_get(&world, entities[i], data.components.velocity))->x);
+        expect_should_be((u32)(3.0f * v), *(u32*)ecs_entity_get(&world, entities[i], data.components.tag));
+    }
+
+    kfree(entities, sizeof(ecs_entity) * count, MEMORY_TAG_ARRAY);
+    ecs_world_destroy(&world);
+    test_stop_job_system(job_state, job_state_size);
+    return True;
+}
+
+/**
+ * @brief Times a system moving 200k entities, inline and on worker threads. Always passes
+ * unless the results are wrong, as timings vary by machine; they are logged instead.
+ */
+u8 ecs_update_benchmark() {
+    ecs_world world;
+    expect_to_be_true(ecs_world_create(&world));
+    test_system_data data;
+    register_components(&world, &data.components);
+    ecs_component_mask position = ECS_COMPONENT_BIT(data.components.position);
+    ecs_component_mask velocity = ECS_COMPONENT_BIT(data.components.velocity);
+
+    clock create;
+    clock_start(&create);
+    for (u32 i = 0; i < ECS_BENCHMARK_COUNT; ++i) {
+        ecs_entity entity = ecs_entity_create(&world, position | velocity);
+        *(vec3*)ecs_entity_get(&world, entity, data.components.velocity) = vec3_create(1.0f, 2.0f, 3.0f);
+    }
+    clock_update(&create);
+
+    ecs_system_config config;
+    kzero_memory(&config, sizeof(ecs_system_config));
+    config.name = "integrate";
+    config.query.all = position | velocity;
+    config.read = velocity;
+    config.write = position;
+    config.run = integrate_system;
+    config.user_data = &data;
+    ecs_system_register(&world, &config);
+
+    const u32 steps = 10;
+    clock inline_clock;
+    clock_start(&inline_clock);
+    for (u32 i = 0; i < steps; ++i) {
+        ecs_world_run_systems(&world, 0.5f);
+    }
+    clock_update(&inline_clock);
+
+    void* job_state = 0;
+    u64 job_state_size = 0;
+    expect_to_be_true(test_start_job_system(ECS_TEST_WORKERS, 256, &job_state, &job_state_size));
+    clock parallel_clock;
+    clock_start(&parallel_clock);
+    for (u32 i = 0; i < steps; ++i) {
+        ecs_world_run_systems(&world, 0.5f);
+    }
+    clock_update(&parallel_clock);
+    test_stop_job_system(job_state, job_state_size);
+
+    // Every entity moved by 20 steps of half its velocity.
+    u32 checked = 0;
+    ecs_query_iter iter = ecs_query_begin(config.query);
+    while (ecs_query_next(&world, &iter)) {
+        const vec3* positions = ecs_view_get(&iter.view, data.components.position);
+        for (u32 i = 0; i < iter.view.count; ++i) {
+            expect_float_to_be(10.0f, positions[i].x);
+            expect_float_to_be(30.0f, positions[i].z);
+        }
+        checked += iter.view.count;
+    }
+    expect_should_be(ECS_BENCHMARK_COUNT, checked);
+
+    KINFO("ECS update of %u entities: %.3fms inline, %.3fms on %u workers. Created in %.2fms.",
+          ECS_BENCHMARK_COUNT, inline_clock.elapsed * 1000.0 / steps, parallel_clock.elapsed * 1000.0 / steps,
+          ECS_TEST_WORKERS, create.elapsed * 1000.0);
+
+    ecs_world_destroy(&world);
+    return True;
+}
+
+void ecs_register_tests() {
+    test_manager_register_test(ecs_entity_handles_should_be_generational, "ECS entity handles should go stale once destroyed");
+    test_manager_register_test(ecs_components_should_survive_archetype_moves, "ECS components should survive moves between archetypes");
+    test_manager_register_test(ecs_queries_should_visit_each_match_once, "ECS queries should visit each matching entity once");
+    test_manager_register_test(ecs_systems_should_be_scheduled_by_conflicts, "ECS systems should be scheduled into phases by conflicts");
+    test_manager_register_test(ecs_update_benchmark, "ECS update benchmark of 200k entities");
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+/**
+ * @file ecs_tests.h
+ * @brief Unit tests for the entity component system.
+ *
+ * Contains function declarations for various ecs tests.
+ * All tests are registered via `ecs_register_tests()`.
+ */
+
+/**
+ * @brief Registers all ecs tests with the test manager.
+ *
+ * Should be called before `test_manager_run_tests()` in main().
+ */
+void ecs_register_tests();
@@ -25,7 +25,7 @@
  * @param actual Actual value returned by the test
  */
 #define expect_should_be(expected, actual)                                                              \
-    if (actual != expected) {                                                                           \
+    if ((actual) != (expected)) {                                                                       \
         KERROR("--> Expected %lld, but got: %lld. File: %s:%d.", expected, actual, __FILE__, __LINE__); \
         return False;                                                                                   \
     }
@@ -40,7 +40,7 @@
  * @param actual Value being tested
  */
 #define expect_should_not_be(expected, actual)                                                                   \
-    if (actual == expected) {                                                                                    \
+    if ((actual) == (expected)) {                                                                                \
         KERROR("--> Expected %d != %d, but they are equal. File: %s:%d.", expected, actual, __FILE__, __LINE__); \
         return False;                                                                                            \
     }
@@ -55,7 +55,7 @@
  * @param actual Float value to compare against
  */
 #define expect_float_to_be(expected, actual)                                                        \
-    if (kabs(expected - actual) > 0.001f) {                                                         \
+    if (kabs((expected) - (actual)) > 0.001f) {                                                     \
         KERROR("--> Expected %f, but got: %f. File: %s:%d.", expected, actual, __FILE__, __LINE__); \
         return False;                                                                               \
     }
@@ -69,7 +69,7 @@
  * @param actual Value to test.
  */
 #define expect_to_be_true(actual)                                                      \
-    if (actual != True) {                                                              \
+    if ((actual) != True) {                                                            \
         KERROR("--> Expected True, but got: False. File: %s:%d.", __FILE__, __LINE__); \
         return False;                                                                  \
     }
@@ -83,7 +83,7 @@
  * @param actual Value to test.
  */
 #define expect_to_be_false(actual)                                                     \
-    if (actual != False) {                                                             \
+    if ((actual) != False) {                                                           \
         KERROR("--> Expected False, but got: true. File: %s:%d.", __FILE__, __LINE__); \
         return False;                                                                  \
     }
\ No newline at end of file
@@ -1,7 +1,25 @@
 #include "test_manager.h"
 
 #include "memory/linear_allocator_tests.h"
+#include "memory/pool_allocator_tests.h"
+#include "memory/dynamic_allocator_tests.h"
+#include "memory/frame_allocator_tests.h"
+#include "memory/buddy_allocator_tests.h"
+#include "memory/freelist_tests.h"
 #include "containers/hashtable_tests.h"
+#include "containers/handle_pool_tests.h"
+#include "platform/filesystem_tests.h"
+#include "systems/job_system_tests.h"
+#include "systems/transform_system_tests.h"
+#include "systems/resource_system_tests.h"
+#include "resources/kpak_tests.h"
+#include "resources/ktex_tests.h"
+#include "renderer/render_batch_tests.h"
+#include "renderer/render_cull_tests.h"
+#include "scene/bvh_tests.h"
+#include "ecs/ecs_tests.h"
+#include "math/kmath_tests.h"
+#include "core/logger_tests.h"
 
 #include <core/logger.h>
 
@@ -26,7 +44,25 @@ int main() {
 
     // Add test registrations here.
     linear_allocator_register_tests();
+    pool_allocator_register_tests();
+    dynamic_allocator_register_tests();
+    frame_allocator_register_tests();
+    buddy_allocator_register_tests();
+    freelist_register_tests();
     hashtable_allocate_tests();
+    handle_pool_register_tests();
+    filesystem_register_tests();
+    job_system_register_tests();
+    transform_system_register_tests();
+    resource_system_register_tests();
+    kpak_register_tests();
+    ktex_register_tests();
+    render_batch_register_tests();
+    render_cull_register_tests();
+    bvh_register_tests();
+    ecs_register_tests();
+    kmath_register_tests();
+    logger_register_tests();
 
     KDEBUG("Starting tests...");
 
@@ -0,0 +1,264 @@
+#include "kmath_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <math/kmath.h>
+#include <core/clock.h>
+#include <core/logger.h>
+
+/**
+ * @file kmath_tests.c
+ * @brief Unit tests for the SIMD math kernels.
+ *
+ * These tests validate the SIMD versions of the hot math functions including:
+ * - vec4 arithmetic matching the scalar versions
+ * - mat4 multiplication and inversion matching the scalar versions
+ * - Quaternion multiplication matching the scalar version
+ *
+ * A benchmark also logs the time per call of the SIMD and scalar versions.
+ * When built without SIMD (see ksimd.h), both sides are the scalar versions.
+ *
+ * Uses the custom test manager and assertion macros from `test_manager.h`.
+ */
+
+/** @brief The number of random inputs each conformance test checks. */
+#define KMATH_TEST_ITERATIONS 1000
+
+/** @brief The number of calls each benchmark times. */
+#define KMATH_BENCHMARK_ITERATIONS 1000000
+
+/** @brief The number of distinct inputs each benchmark cycles through. */
+#define KMATH_BENCHMARK_INPUTS 64
+
+static vec4 random_vec4(f32 min, f32 max) {
+    return vec4_create(fkrandom_in_range(min, max), fkrandom_in_range(min, max), fkrandom_in_range(min, max), fkrandom_in_range(min, max));
+}
+
+static mat4 random_mat4(f32 min, f32 max) {
+    mat4 m;
+    for (u32 i = 0; i < 16; ++i) {
+        m.data[i] = fkrandom_in_range(min, max);
+    }
+    return m;
+}
+
+/** @brief Creates a random matrix far enough from singular to invert accurately. */
+static mat4 random_invertible_mat4() {
+    mat4 m = random_mat4(-1.0f, 1.0f);
+    m.data[0] += 4.0f;
+    m.data[5] += 4.0f;
+    m.data[10] += 4.0f;
+    m.data[15] += 4.0f;
+    return m;
+}
+
+/** @brief Creates a random rotation, which keeps long chains of products bounded. */
+static quat random_rotation() {
+    return quat_normalize(random_vec4(-1.0f, 1.0f));
+}
+
+static b8 vec4_matches(vec4 expected, vec4 actual) {
+    for (u32 i = 0; i < 4; ++i) {
+        f32 e = expected.elements[i];
+        f32 a = actual.elements[i];
+        expect_float_to_be(e, a);
+    }
+    return True;
+}
+
+static b8 mat4_matches(mat4 expected, mat4 actual) {
+    for (u32 i = 0; i < 16; ++i) {
+        f32 e = expected.data[i];
+        f32 a = actual.data[i];
+        expect_float_to_be(e, a);
+    }
+    return True;
+}
+
+/**
+ * @brief Tests that vec4 arithmetic matches the scalar versions.
+ */
+u8 kmath_vec4_should_match_scalar() {
+    for (u32 i = 0; i < KMATH_TEST_ITERATIONS; ++i) {
+        vec4 a = random_vec4(-100.0f, 100.0f);
+        vec4 b = random_vec4(-100.0f, 100.0f);
+        // Keep divisors away from zero.
+        vec4 divisor = random_vec4(0.5f, 10.0f);
+
+        expect_to_be_true(vec4_matches(vec4_add_scalar(a, b), vec4_add(a, b)));
+        expect_to_be_true(vec4_matches(vec4_sub_scalar(a, b), vec4_sub(a, b)));
+        expect_to_be_true(vec4_matches(vec4_mul_scalar(a, b), vec4_mul(a, b)));
+        expect_to_be_true(vec4_matches(vec4_div_scalar(a, divisor), vec4_div(a, divisor)));
+    }
+
+    return True;
+}
+
+/**
+ * @brief Tests that mat4 multiplication matches the scalar version.
+ */
+u8 kmath_mat4_mul_should_match_scalar() {
+    for (u32 i = 0; i < KMATH_TEST_ITERATIONS; ++i) {
+        mat4 a = random_mat4(-2.0f, 2.0f);
+        mat4 b = random_mat4(-2.0f, 2.0f);
+        expect_to_be_true(mat4_matches(mat4_mul_scalar(a, b), mat4_mul(a, b)));
+    }
+
+    // The identity changes nothing, whichever side it is on.
+    mat4 m = random_mat4(-2.0f, 2.0f);
+    expect_to_be_true(mat4_matches(m, mat4_mul(m, mat4_identity())));
+    expect_to_be_true(mat4_matches(m, mat4_mul(mat4_identity(), m)));
+
+    return True;
+}
+
+/**
+ * @brief Tests that mat4 inversion matches the scalar version, and actually inverts.
+ */
+u8 kmath_mat4_inverse_should_match_scalar() {
+    for (u32 i = 0; i < KMATH_TEST_ITERATIONS; ++i) {
+        mat4 m = random_invertible_mat4();
+        mat4 inverse = mat4_inverse(m);
+        expect_to_be_true(mat4_matches(mat4_inverse_scalar(m), inverse));
+        expect_to_be_true(mat4_matches(mat4_identity(), mat4_mul(m, inverse)));
+    }
+
+    // A typical model matrix: rotated, scaled and translated.
+    mat4 model = mat4_mul(quat_to_mat4(random_rotation()), mat4_scale(vec3_create(2.0f, 3.0f, 4.0f)));
+    model.data[12] = 10.0f;
+    model.data[13] = -5.0f;
+    model.data[14] = 3.0f;
+    expect_to_be_true(mat4_matches(mat4_inverse_scalar(model), mat4_inverse(model)));
+    expect_to_be_true(mat4_matches(mat4_identity(), mat4_mul(mat4_inverse(model), model)));
+
+    return True;
+}
+
+/**
+ * @brief Tests that quaternion multiplication matches the scalar version.
+ */
+u8 kmath_quat_mul_should_match_scalar() {
+    for (u32 i = 0; i < KMATH_TEST_ITERATIONS; ++i) {
+        quat a = random_vec4(-10.0f, 10.0f);
+        quat b = random_vec4(-10.0f, 10.0f);
+        expect_to_be_true(vec4_matches(quat_mul_scalar(a, b), quat_mul(a, b)));
+    }
+
+    // Multiplying by the identity changes nothing.
+    quat q = random_rotation();
+    expect_to_be_true(vec4_matches(q, quat_mul(q, quat_identity())));
+
+    return True;
+}
+
+/** @brief Returns the time per call in nanoseconds, given the elapsed time of a benchmark. */
+static f64 nanoseconds_per_call(const clock* c) {
+    return c->elapsed * 1000000000.0 / KMATH_BENCHMARK_ITERATIONS;
+}
+
+static void log_benchmark(const char* name, const clock* scalar, const clock* simd) {
+    f64 scalar_ns = nanoseconds_per_call(scalar);
+    f64 simd_ns = nanoseconds_per_call(simd);
+    KINFO("%s: %.2fns scalar, %.2fns SIMD (%.2fx).", name, scalar_ns, simd_ns, simd_ns > 0.0 ? scalar_ns / simd_ns : 0.0);
+}
+
+/**
+ * @brief Times the SIMD versions against the scalar ones. Always passes, as timings vary by
+ * machine; the results are logged instead.
+ *
+ * Each benchmark chains its calls, each taking the previous result, so none can be skipped.
+ * Rotations keep the chained values bounded.
+ */
+u8 kmath_simd_benchmark() {
+    mat4 matrices[KMATH_BENCHMARK_INPUTS];
+    quat rotations[KMATH_BENCHMARK_INPUTS];
+    for (u32 i = 0; i < KMATH_BENCHMARK_INPUTS; ++i) {
+        rotations[i] = random_rotation();
+        matrices[i] = quat_to_mat4(rotations[i]);
+    }
+
+    clock scalar;
+    clock simd;
+    // Read after each benchmark, so the chains are not optimized away.
+    volatile f32 sink = 0.0f;
+
+    mat4 m = mat4_identity();
+    clock_start(&scalar);
+    for (u32 i = 0; i < KMATH_BENCHMARK_ITERATIONS; ++i) {
+        m = mat4_mul_scalar(m, matrices[i % KMATH_BENCHMARK_INPUTS]);
+    }
+    clock_update(&scalar);
+    sink += m.data[0];
+
+    m = mat4_identity();
+    clock_start(&simd);
+    for (u32 i = 0; i < KMATH_BENCHMARK_ITERATIONS; ++i) {
+        m = mat4_mul(m, matrices[i % KMATH_BENCHMARK_INPUTS]);
+    }
+    clock_update(&simd);
+    sink += m.data[0];
+    log_benchmark("mat4_mul", &scalar, &simd);
+
+    m = matrices[0];
+    clock_start(&scalar);
+    for (u32 i = 0; i < KMATH_BENCHMARK_ITERATIONS; ++i) {
+        m = mat4_inverse_scalar(m);
+    }
+    clock_update(&scalar);
+    sink += m.data[0];
+
+    m = matrices[0];
+    clock_start(&simd);
+    for (u32 i = 0; i < KMATH_BENCHMARK_ITERATIONS; ++i) {
+        m = mat4_inverse(m);
+    }
+    clock_update(&simd);
+    sink += m.data[0];
+    log_benchmark("mat4_inverse", &scalar, &simd);
+
+    quat q = quat_identity();
+    clock_start(&scalar);
+    for (u32 i = 0; i < KMATH_BENCHMARK_ITERATIONS; ++i) {
+        q = quat_mul_scalar(q, rotations[i % KMATH_BENCHMARK_INPUTS]);
+    }
+    clock_update(&scalar);
+    sink += q.x;
+
+    q = quat_identity();
+    clock_start(&simd);
+    for (u32 i = 0; i < KMATH_BENCHMARK_ITERATIONS; ++i) {
+        q = quat_mul(q, rotations[i % KMATH_BENCHMARK_INPUTS]);
+    }
+    clock_update(&simd);
+    sink += q.x;
+    log_benchmark("quat_mul", &scalar, &simd);
+
+    vec4 v = vec4_zero();
+    clock_start(&scalar);
+    for (u32 i = 0; i < KMATH_BENCHMARK_ITERATIONS; ++i) {
+        v = vec4_add_scalar(vec4_mul_scalar(v, rotations[i % KMATH_BENCHMARK_INPUTS]), rotations[(i + 1) % KMATH_BENCHMARK_INPUTS]);
+    }
+    clock_update(&scalar);
+    sink += v.x;
+
+    v = vec4_zero();
+    clock_start(&simd);
+    for (u32 i = 0; i < KMATH_BENCHMARK_ITERATIONS; ++i) {
+        v = vec4_add(vec4_mul(v, rotations[i % KMATH_BENCHMARK_INPUTS]), rotations[(i + 1) % KMATH_BENCHMARK_INPUTS]);
+    }
+    clock_update(&simd);
+    sink += v.x;
+    log_benchmark("vec4_mul + vec4_add", &scalar, &simd);
+
+    (void)sink;
+    return True;
+}
+
+void kmath_register_tests() {
+    test_manager_register_test(kmath_vec4_should_match_scalar, "SIMD vec4 arithmetic should match the scalar versions");
+    test_manager_register_test(kmath_mat4_mul_should_match_scalar, "SIMD mat4 multiplication should match the scalar version");
+    test_manager_register_test(kmath_mat4_inverse_should_match_scalar, "SIMD mat4 inversion should match the scalar version");
+    test_manager_register_test(kmath_quat_mul_should_match_scalar, "SIMD quaternion multiplication should match the scalar version");
+    test_manager_register_test(kmath_simd_benchmark, "SIMD math benchmark against the scalar versions");
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+/**
+ * @file kmath_tests.h
+ * @brief Unit tests for the SIMD math kernels.
+ *
+ * Contains function declarations for various math tests.
+ * All tests are registered via `kmath_register_tests()`.
+ */
+
+/**
+ * @brief Registers all math tests with the test manager.
+ *
+ * Should be called before `test_manager_run_tests()` in main().
+ */
+void kmath_register_tests();
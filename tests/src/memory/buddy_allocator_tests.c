@@ -0,0 +1,205 @@
+#include "buddy_allocator_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <memory/buddy_allocator.h>
+#include <core/kmemory.h>
+
+/**
+ * @file buddy_allocator_tests.c
+ * @brief Unit tests for the buddy allocator subsystem.
+ *
+ * These tests validate core functionality of the `buddy_allocator` including:
+ * - Creation and destruction
+ * - Allocating and freeing blocks, with buddies merged back together
+ * - Aligned allocations
+ * - Handling out-of-space conditions and invalid frees
+ *
+ * Uses the custom test manager and assertion macros from `test_manager.h`.
+ */
+
+/**
+ * @brief Creates an allocator over a range of the given size, with its bookkeeping in a kallocate'd block.
+ */
+static void* create_test_allocator(u64 total_size, u64 min_block_size, u64* out_requirement, buddy_allocator* out_allocator) {
+    buddy_allocator_create(total_size, min_block_size, out_requirement, 0, 0);
+    void* memory = kallocate(*out_requirement, MEMORY_TAG_ARRAY);
+    buddy_allocator_create(total_size, min_block_size, out_requirement, memory, out_allocator);
+    return memory;
+}
+
+/**
+ * @brief Tests that a buddy allocator can be created and destroyed properly.
+ *
+ * Verifies:
+ * - A memory requirement is reported when no memory is provided
+ * - Sizes that are not powers of 2 are rejected
+ * - Size fields are initialized correctly, with the whole range free
+ * - After destruction, all state is reset
+ */
+u8 buddy_allocator_should_create_and_destroy() {
+    u64 requirement = 0;
+    expect_to_be_false(buddy_allocator_create(1000, 16, &requirement, 0, 0));
+    expect_to_be_false(buddy_allocator_create(1024, 24, &requirement, 0, 0));
+    expect_to_be_false(buddy_allocator_create(1024, 2048, &requirement, 0, 0));
+
+    buddy_allocator alloc;
+    void* memory = create_test_allocator(1024, 16, &requirement, &alloc);
+    // One node per possible block: 64 leaves and their 63 ancestors.
+    expect_should_be(127, requirement);
+
+    expect_should_be(1024, alloc.total_size);
+    expect_should_be(16, alloc.min_block_size);
+    expect_should_be(1024, alloc.free_space);
+    expect_should_be(7, alloc.level_count);
+    expect_should_be(1024, buddy_allocator_largest_free_block(&alloc));
+
+    buddy_allocator_destroy(&alloc);
+
+    expect_should_be(0, alloc.tree);
+    expect_should_be(0, alloc.total_size);
+    expect_should_be(0, alloc.free_space);
+
+    kfree(memory, requirement, MEMORY_TAG_ARRAY);
+
+    return True;
+}
+
+/**
+ * @brief Tests allocating and freeing blocks in various orders.
+ *
+ * Ensures:
+ * - Sizes are rounded up to powers of 2 of at least the minimum block size
+ * - Live blocks never overlap
+ * - Freeing everything merges the range back into one block
+ */
+u8 buddy_allocator_should_allocate_free_and_merge() {
+    const u64 total_size = 128 * 1024;
+    u64 requirement = 0;
+    buddy_allocator alloc;
+    void* memory = create_test_allocator(total_size, 256, &requirement, &alloc);
+
+    const u32 count = 24;
+    u64 offsets[24];
+    u64 sizes[24];
+    for (u32 i = 0; i < count; ++i) {
+        // A spread of sizes, most of them not powers of 2.
+        u64 size = 100 + (i * 173);
+        expect_to_be_true(buddy_allocator_allocate(&alloc, size, 1, &offsets[i]));
+        sizes[i] = 256;
+        while (sizes[i] < size) {
+            sizes[i] *= 2;
+        }
+        expect_should_be(0, offsets[i] % sizes[i]);
+    }
+
+    for (u32 i = 0; i < count; ++i) {
+        for (u32 j = i + 1; j < count; ++j) {
+            b8 disjoint = offsets[i] + sizes[i] <= offsets[j] || offsets[j] + sizes[j] <= offsets[i];
+            expect_to_be_true(disjoint);
+        }
+    }
+
+    // Free every other block, then the rest.
+    for (u32 i = 0; i < count; i += 2) {
+        expect_should_be(sizes[i], buddy_allocator_free(&alloc, offsets[i]));
+    }
+    for (u32 i = 1; i < count; i += 2) {
+        expect_should_be(sizes[i], buddy_allocator_free(&alloc, offsets[i]));
+    }
+
+    expect_should_be(total_size, alloc.free_space);
+    expect_should_be(total_size, buddy_allocator_largest_free_block(&alloc));
+
+    u64 offset = 1;
+    expect_to_be_true(buddy_allocator_allocate(&alloc, total_size, 1, &offset));
+    expect_should_be(0, offset);
+
+    buddy_allocator_destroy(&alloc);
+    kfree(memory, requirement, MEMORY_TAG_ARRAY);
+
+    return True;
+}
+
+/**
+ * @brief Tests that allocations honour alignments larger than their size.
+ */
+u8 buddy_allocator_should_allocate_aligned() {
+    u64 requirement = 0;
+    buddy_allocator alloc;
+    void* memory = create_test_allocator(64 * 1024, 256, &requirement, &alloc);
+
+    u64 small = 0;
+    expect_to_be_true(buddy_allocator_allocate(&alloc, 256, 1, &small));
+
+    u64 alignments[3] = {1024, 4096, 16384};
+    u64 offsets[3];
+    for (u32 i = 0; i < 3; ++i) {
+        expect_to_be_true(buddy_allocator_allocate(&alloc, 300, alignments[i], &offsets[i]));
+        expect_should_be(0, offsets[i] % alignments[i]);
+        expect_should_not_be(small, offsets[i]);
+    }
+
+    for (u32 i = 0; i < 3; ++i) {
+        expect_should_be(alignments[i], buddy_allocator_free(&alloc, offsets[i]));
+    }
+    buddy_allocator_free(&alloc, small);
+    expect_should_be(64 * 1024, alloc.free_space);
+
+    buddy_allocator_destroy(&alloc);
+    kfree(memory, requirement, MEMORY_TAG_ARRAY);
+
+    return True;
+}
+
+/**
+ * @brief Tests running out of space, and freeing offsets that were never allocated.
+ *
+ * Ensures:
+ * - Requests larger than the largest free block fail without changing state
+ * - Freeing an unallocated offset, or one inside a block, does nothing
+ */
+u8 buddy_allocator_should_handle_out_of_space() {
+    u64 requirement = 0;
+    buddy_allocator alloc;
+    void* memory = create_test_allocator(4096, 256, &requirement, &alloc);
+
+    u64 offset = 0;
+    expect_to_be_false(buddy_allocator_allocate(&alloc, 8192, 1, &offset));
+
+    u64 half = 0;
+    expect_to_be_true(buddy_allocator_allocate(&alloc, 2048, 1, &half));
+    u64 quarter = 0;
+    expect_to_be_true(buddy_allocator_allocate(&alloc, 1024, 1, &quarter));
+    expect_should_be(1024, buddy_allocator_largest_free_block(&alloc));
+    expect_to_be_false(buddy_allocator_allocate(&alloc, 1025, 1, &offset));
+    expect_should_be(1024, alloc.free_space);
+
+    // Allocations pack from the start of the range, leaving 3072 free.
+    expect_should_be(0, half);
+    expect_should_be(2048, quarter);
+
+    // Never allocated, inside a block, and out of range.
+    expect_should_be(0, buddy_allocator_free(&alloc, 3072));
+    expect_should_be(0, buddy_allocator_free(&alloc, half + 256));
+    expect_should_be(0, buddy_allocator_free(&alloc, 4096));
+    expect_should_be(1024, alloc.free_space);
+
+    expect_should_be(2048, buddy_allocator_free(&alloc, half));
+    expect_should_be(1024, buddy_allocator_free(&alloc, quarter));
+    expect_should_be(0, buddy_allocator_free(&alloc, quarter));
+    expect_should_be(4096, alloc.free_space);
+
+    buddy_allocator_destroy(&alloc);
+    kfree(memory, requirement, MEMORY_TAG_ARRAY);
+
+    return True;
+}
+
+void buddy_allocator_register_tests() {
+    test_manager_register_test(buddy_allocator_should_create_and_destroy, "Buddy allocator should create and destroy");
+    test_manager_register_test(buddy_allocator_should_allocate_free_and_merge, "Buddy allocator should allocate, free and merge blocks");
+    test_manager_register_test(buddy_allocator_should_allocate_aligned, "Buddy allocator should allocate aligned blocks");
+    test_manager_register_test(buddy_allocator_should_handle_out_of_space, "Buddy allocator should handle out of space");
+}
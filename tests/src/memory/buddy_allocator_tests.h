@@ -0,0 +1,16 @@
+#pragma once
+
+/**
+ * @file buddy_allocator_tests.h
+ * @brief Unit tests for the buddy allocator implementation.
+ *
+ * Contains function declarations for various buddy allocator tests.
+ * All tests are registered via `buddy_allocator_register_tests()`.
+ */
+
+/**
+ * @brief Registers all buddy allocator tests with the test manager.
+ *
+ * Should be called before `test_manager_run_tests()` in main().
+ */
+void buddy_allocator_register_tests();
@@ -0,0 +1,303 @@
+#include "dynamic_allocator_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <memory/dynamic_allocator.h>
+#include <core/kmemory.h>
+#include <core/logger.h>
+#include <core/clock.h>
+
+/**
+ * @file dynamic_allocator_tests.c
+ * @brief Unit tests for the dynamic allocator subsystem.
+ *
+ * These tests validate core functionality of the `dynamic_allocator` including:
+ * - Creation and destruction
+ * - Allocating and freeing blocks, with free neighbours merged back together
+ * - Aligned allocations
+ * - Handling out-of-memory conditions
+ * - kallocate/kfree routing through an engine heap
+ * - Alloc/free throughput compared to the platform allocator
+ *
+ * Uses the custom test manager and assertion macros from `test_manager.h`.
+ */
+
+/**
+ * @brief Creates an allocator of the given size, backed by a kallocate'd block.
+ */
+static void* create_test_allocator(u64 total_size, u64* out_requirement, dynamic_allocator* out_allocator) {
+    dynamic_allocator_create(total_size, out_requirement, 0, 0);
+    void* memory = kallocate(*out_requirement, MEMORY_TAG_ARRAY);
+    dynamic_allocator_create(total_size, out_requirement, memory, out_allocator);
+    return memory;
+}
+
+/**
+ * @brief Tests that a dynamic allocator can be created and destroyed properly.
+ *
+ * Verifies:
+ * - A memory requirement is reported when no memory is provided
+ * - Size fields are initialized correctly
+ * - After destruction, all state is reset
+ */
+u8 dynamic_allocator_should_create_and_destroy() {
+    dynamic_allocator alloc;
+    u64 requirement = 0;
+    expect_to_be_true(dynamic_allocator_create(1024, &requirement, 0, 0));
+    expect_to_be_true(requirement > 1024);
+
+    void* memory = kallocate(requirement, MEMORY_TAG_ARRAY);
+    expect_to_be_true(dynamic_allocator_create(1024, &requirement, memory, &alloc));
+
+    expect_should_not_be(0, alloc.memory);
+    expect_should_be(1024, alloc.total_size);
+    // Everything but the terminating block's header is free.
+    expect_to_be_true(alloc.free_space > 1024 - 32 && alloc.free_space < 1024);
+
+    dynamic_allocator_destroy(&alloc);
+
+    expect_should_be(0, alloc.memory);
+    expect_should_be(0, alloc.total_size);
+    expect_should_be(0, alloc.free_space);
+
+    kfree(memory, requirement, MEMORY_TAG_ARRAY);
+
+    return True;
+}
+
+/**
+ * @brief Tests allocating and freeing blocks in various orders.
+ *
+ * Ensures:
+ * - Live blocks never overlap
+ * - Freeing everything merges the pool back into one block, so free space is fully restored
+ *   and a single allocation of most of the pool succeeds
+ */
+u8 dynamic_allocator_should_allocate_free_and_merge() {
+    const u64 total_size = 64 * 1024;
+    dynamic_allocator alloc;
+    u64 requirement = 0;
+    void* memory = create_test_allocator(total_size, &requirement, &alloc);
+    const u64 initial_free = alloc.free_space;
+
+    const u32 block_count = 64;
+    u8* blocks[64];
+    u64 sizes[64];
+    for (u32 i = 0; i < block_count; ++i) {
+        // A spread of sizes, crossing the small/large size class boundary.
+        sizes[i] = 1 + ((i * 37) % 700);
+        blocks[i] = dynamic_allocator_allocate(&alloc, sizes[i]);
+        expect_should_not_be(0, blocks[i]);
+        expect_should_be(0, ((u64)blocks[i]) % DYNAMIC_ALLOCATOR_MIN_ALIGNMENT);
+        expect_to_be_true(dynamic_allocator_block_size(&alloc, blocks[i]) >= sizes[i]);
+        kset_memory(blocks[i], (i32)i, sizes[i]);
+    }
+
+    // Free every other block, then reallocate into the holes.
+    for (u32 i = 0; i < block_count; i += 2) {
+        expect_to_be_true(dynamic_allocator_free(&alloc, blocks[i]));
+    }
+    for (u32 i = 0; i < block_count; i += 2) {
+        blocks[i] = dynamic_allocator_allocate(&alloc, sizes[i]);
+        expect_should_not_be(0, blocks[i]);
+        kset_memory(blocks[i], (i32)i, sizes[i]);
+    }
+
+    // If any blocks overlapped, a pattern would have been overwritten.
+    for (u32 i = 0; i < block_count; ++i) {
+        for (u64 j = 0; j < sizes[i]; ++j) {
+            expect_should_be(i, blocks[i][j]);
+        }
+    }
+
+    // Free in an order that exercises merging with both neighbours.
+    for (u32 i = 1; i < block_count; i += 2) {
+        dynamic_allocator_free(&alloc, blocks[i]);
+    }
+    for (u32 i = 0; i < block_count; i += 2) {
+        dynamic_allocator_free(&alloc, blocks[i]);
+    }
+    expect_should_be(initial_free, alloc.free_space);
+
+    // Everything merged back together, so most of the pool can be allocated at once.
+    void* big = dynamic_allocator_allocate(&alloc, (total_size * 3) / 4);
+    expect_should_not_be(0, big);
+    dynamic_allocator_free(&alloc, big);
+    expect_should_be(initial_free, alloc.free_space);
+
+    dynamic_allocator_destroy(&alloc);
+    kfree(memory, requirement, MEMORY_TAG_ARRAY);
+
+    return True;
+}
+
+/**
+ * @brief Tests allocations with alignments above the minimum.
+ *
+ * Ensures:
+ * - Every block is aligned as requested
+ * - Freeing them restores all free space
+ */
+u8 dynamic_allocator_should_allocate_aligned() {
+    dynamic_allocator alloc;
+    u64 requirement = 0;
+    void* memory = create_test_allocator(256 * 1024, &requirement, &alloc);
+    const u64 initial_free = alloc.free_space;
+
+    const u64 alignments[] = {16, 32, 64, 256, 4096};
+    void* blocks[5 * 4];
+    u32 count = 0;
+    for (u32 i = 0; i < 5; ++i) {
+        for (u32 j = 0; j < 4; ++j) {
+            void* block = dynamic_allocator_allocate_aligned(&alloc, 24 + (j * 100), alignments[i]);
+            expect_should_not_be(0, block);
+            expect_should_be(0, ((u64)block) % alignments[i]);
+            blocks[count++] = block;
+        }
+    }
+
+    KDEBUG("Note: The following error is intentionally caused by this test.");
+    expect_should_be(0, dynamic_allocator_allocate_aligned(&alloc, 16, 48));
+
+    for (u32 i = 0; i < count; ++i) {
+        expect_to_be_true(dynamic_allocator_free(&alloc, blocks[i]));
+    }
+    expect_should_be(initial_free, alloc.free_space);
+
+    dynamic_allocator_destroy(&alloc);
+    kfree(memory, requirement, MEMORY_TAG_ARRAY);
+
+    return True;
+}
+
+/**
+ * @brief Tests that allocations beyond the pool fail cleanly, and bad frees are rejected.
+ */
+u8 dynamic_allocator_should_handle_out_of_memory() {
+    dynamic_allocator alloc;
+    u64 requirement = 0;
+    void* memory = create_test_allocator(4096, &requirement, &alloc);
+
+    void* block = dynamic_allocator_allocate(&alloc, 2048);
+    expect_should_not_be(0, block);
+
+    KDEBUG("Note: The following warning and errors are intentionally caused by this test.");
+    expect_should_be(0, dynamic_allocator_allocate(&alloc, 4096));
+
+    // Foreign and double frees are rejected.
+    u64 outside = 0;
+    expect_to_be_false(dynamic_allocator_free(&alloc, &outside));
+    expect_to_be_true(dynamic_allocator_free(&alloc, block));
+    expect_to_be_false(dynamic_allocator_free(&alloc, block));
+
+    dynamic_allocator_destroy(&alloc);
+    kfree(memory, requirement, MEMORY_TAG_ARRAY);
+
+    return True;
+}
+
+/**
+ * @brief Tests that kallocate/kfree allocate from the engine heap once one is configured,
+ * while blocks allocated before it existed can still be freed.
+ */
+u8 dynamic_allocator_should_back_kallocate() {
+    void* early = kallocate(64, MEMORY_TAG_ARRAY);
+
+    memory_system_config config;
+    config.total_alloc_size = 1024 * 1024;
+    u64 requirement = 0;
+    initialize_memory(&requirement, 0, config);
+    void* state = kallocate(requirement, MEMORY_TAG_ARRAY);
+    expect_to_be_true(initialize_memory(&requirement, state, config));
+
+    u8* block = kallocate(1000, MEMORY_TAG_ARRAY);
+    expect_should_not_be(0, block);
+    for (u32 i = 0; i < 1000; ++i) {
+        expect_should_be(0, block[i]);
+    }
+
+    u8* aligned = kallocate_aligned(100, 256, MEMORY_TAG_ARRAY);
+    expect_should_be(0, ((u64)aligned) % 256);
+
+    kfree_aligned(aligned, 100, 256, MEMORY_TAG_ARRAY);
+    kfree(block, 1000, MEMORY_TAG_ARRAY);
+    kfree(early, 64, MEMORY_TAG_ARRAY);
+
+    shutdown_memory(state);
+    kfree(state, requirement, MEMORY_TAG_ARRAY);
+
+    return True;
+}
+
+/**
+ * @brief Compares dynamic allocator alloc/free throughput against the platform allocator.
+ *
+ * Keeps a rolling window of live blocks of varying sizes to resemble general engine churn.
+ * Timings are logged, not asserted.
+ */
+u8 dynamic_allocator_benchmark_against_platform() {
+    const u32 live_count = 512;
+    const u32 iterations = 200000;
+
+    dynamic_allocator alloc;
+    u64 requirement = 0;
+    void* memory = create_test_allocator(16 * 1024 * 1024, &requirement, &alloc);
+
+    void* live[512];
+    u64 live_sizes[512];
+    kzero_memory(live, sizeof(live));
+
+    clock timer;
+    clock_start(&timer);
+    for (u32 i = 0; i < iterations; ++i) {
+        u32 slot = (i * 7919) % live_count;
+        if (live[slot]) {
+            kfree(live[slot], live_sizes[slot], MEMORY_TAG_ARRAY);
+        }
+        live_sizes[slot] = 16 + ((i * 2654435761u) % 4096);
+        live[slot] = kallocate(live_sizes[slot], MEMORY_TAG_ARRAY);
+    }
+    for (u32 i = 0; i < live_count; ++i) {
+        kfree(live[i], live_sizes[i], MEMORY_TAG_ARRAY);
+        live[i] = 0;
+    }
+    clock_update(&timer);
+    f64 platform_time = timer.elapsed;
+
+    const u64 initial_free = alloc.free_space;
+    clock_start(&timer);
+    for (u32 i = 0; i < iterations; ++i) {
+        u32 slot = (i * 7919) % live_count;
+        if (live[slot]) {
+            dynamic_allocator_free(&alloc, live[slot]);
+        }
+        live_sizes[slot] = 16 + ((i * 2654435761u) % 4096);
+        live[slot] = dynamic_allocator_allocate(&alloc, live_sizes[slot]);
+        expect_should_not_be(0, live[slot]);
+    }
+    for (u32 i = 0; i < live_count; ++i) {
+        dynamic_allocator_free(&alloc, live[i]);
+    }
+    clock_update(&timer);
+    f64 dynamic_time = timer.elapsed;
+
+    expect_should_be(initial_free, alloc.free_space);
+
+    KINFO("Dynamic allocator benchmark (%u alloc/free pairs of 16-4111 bytes): platform %.6f sec, dynamic %.6f sec.",
+          iterations, platform_time, dynamic_time);
+
+    dynamic_allocator_destroy(&alloc);
+    kfree(memory, requirement, MEMORY_TAG_ARRAY);
+
+    return True;
+}
+
+void dynamic_allocator_register_tests() {
+    test_manager_register_test(dynamic_allocator_should_create_and_destroy, "Dynamic allocator should create and destroy");
+    test_manager_register_test(dynamic_allocator_should_allocate_free_and_merge, "Dynamic allocator should allocate, free and merge blocks");
+    test_manager_register_test(dynamic_allocator_should_allocate_aligned, "Dynamic allocator should allocate aligned blocks");
+    test_manager_register_test(dynamic_allocator_should_handle_out_of_memory, "Dynamic allocator should handle out of memory");
+    test_manager_register_test(dynamic_allocator_should_back_kallocate, "Dynamic allocator should back kallocate when configured");
+    test_manager_register_test(dynamic_allocator_benchmark_against_platform, "Dynamic allocator benchmark against the platform allocator");
+}
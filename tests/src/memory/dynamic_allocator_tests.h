@@ -0,0 +1,16 @@
+#pragma once
+
+/**
+ * @file dynamic_allocator_tests.h
+ * @brief Unit tests for the dynamic allocator implementation.
+ *
+ * Contains function declarations for various dynamic allocator tests.
+ * All tests are registered via `dynamic_allocator_register_tests()`.
+ */
+
+/**
+ * @brief Registers all dynamic allocator tests with the test manager.
+ *
+ * Should be called before `test_manager_run_tests()` in main().
+ */
+void dynamic_allocator_register_tests();
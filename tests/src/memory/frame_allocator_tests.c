@@ -0,0 +1,79 @@
+#include "frame_allocator_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <memory/frame_allocator.h>
+#include <core/kmemory.h>
+
+/**
+ * @file frame_allocator_tests.c
+ * @brief Unit tests for the frame allocator.
+ *
+ * These tests validate core functionality of the frame allocator including:
+ * - Aligned allocation within a frame
+ * - Blocks surviving one frame boundary, and their memory being reused after two
+ * - No heap allocations in steady state
+ *
+ * Uses the custom test manager and assertion macros from `test_manager.h`.
+ */
+
+/**
+ * @brief Tests allocating across frames.
+ *
+ * Validates:
+ * - Blocks are aligned and usage is tracked
+ * - Data written in frame N is intact during frame N + 1
+ * - Frame N + 2 reuses frame N's memory
+ * - Allocating does not touch kallocate
+ */
+u8 frame_allocator_should_double_buffer_frames() {
+    frame_allocator_config config;
+    config.frame_size = 4096;
+    u64 requirement = 0;
+    frame_allocator_initialize(&requirement, 0, config);
+    void* state = kallocate(requirement, MEMORY_TAG_APPLICATION);
+    expect_to_be_true(frame_allocator_initialize(&requirement, state, config));
+
+    u64 alloc_count = get_memory_alloc_count();
+
+    // Frame 0.
+    u32* frame0 = frame_alloc(sizeof(u32) * 4, 16);
+    expect_should_not_be(0, frame0);
+    expect_should_be(0, ((u64)frame0) % 16);
+    for (u32 i = 0; i < 4; ++i) {
+        frame0[i] = 100 + i;
+    }
+    expect_to_be_true(frame_allocator_frame_usage() >= sizeof(u32) * 4);
+    frame_allocator_end_frame();
+
+    // Frame 1: frame 0's data is still intact.
+    expect_should_be(0, frame_allocator_frame_usage());
+    u32* frame1 = frame_alloc(sizeof(u32) * 4, 64);
+    expect_should_not_be(0, frame1);
+    expect_should_be(0, ((u64)frame1) % 64);
+    for (u32 i = 0; i < 4; ++i) {
+        frame1[i] = 200 + i;
+        expect_should_be(100 + i, frame0[i]);
+    }
+    frame_allocator_end_frame();
+
+    // Frame 2 reuses frame 0's buffer, while frame 1's data is still intact.
+    u32* frame2 = frame_alloc(sizeof(u32) * 4, 16);
+    expect_should_be(frame0, frame2);
+    for (u32 i = 0; i < 4; ++i) {
+        expect_should_be(200 + i, frame1[i]);
+    }
+    frame_allocator_end_frame();
+
+    expect_should_be(alloc_count, get_memory_alloc_count());
+
+    frame_allocator_shutdown(state);
+    kfree(state, requirement, MEMORY_TAG_APPLICATION);
+
+    return True;
+}
+
+void frame_allocator_register_tests() {
+    test_manager_register_test(frame_allocator_should_double_buffer_frames, "Frame allocator should double buffer frames");
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+/**
+ * @file frame_allocator_tests.h
+ * @brief Unit tests for the frame allocator implementation.
+ *
+ * Contains function declarations for various frame allocator tests.
+ * All tests are registered via `frame_allocator_register_tests()`.
+ */
+
+/**
+ * @brief Registers all frame allocator tests with the test manager.
+ *
+ * Should be called before `test_manager_run_tests()` in main().
+ */
+void frame_allocator_register_tests();
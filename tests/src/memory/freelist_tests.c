@@ -0,0 +1,226 @@
+#include "freelist_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <memory/freelist.h>
+#include <core/kmemory.h>
+
+/**
+ * @file freelist_tests.c
+ * @brief Unit tests for the free list subsystem.
+ *
+ * These tests validate core functionality of the `freelist` including:
+ * - Creation and destruction
+ * - Allocating and freeing ranges, with free neighbours merged back together
+ * - Reusing freed ranges
+ * - Growing the managed block
+ * - Handling out-of-space conditions and invalid frees
+ *
+ * Uses the custom test manager and assertion macros from `test_manager.h`.
+ */
+
+/**
+ * @brief Creates a free list over a block of the given size, with its ranges in a kallocate'd block.
+ */
+static void* create_test_list(u64 total_size, u32 max_ranges, u64* out_requirement, freelist* out_list) {
+    freelist_create(total_size, max_ranges, out_requirement, 0, 0);
+    void* memory = kallocate(*out_requirement, MEMORY_TAG_ARRAY);
+    freelist_create(total_size, max_ranges, out_requirement, memory, out_list);
+    return memory;
+}
+
+/**
+ * @brief Tests that a free list can be created and destroyed properly.
+ *
+ * Verifies:
+ * - A memory requirement is reported when no memory is provided
+ * - The whole block starts out as one free range
+ * - After destruction, all state is reset
+ */
+u8 freelist_should_create_and_destroy() {
+    u64 requirement = 0;
+    freelist list;
+    void* memory = create_test_list(1000, 8, &requirement, &list);
+    expect_should_be(sizeof(freelist_range) * 8, requirement);
+
+    expect_should_be(1000, list.total_size);
+    expect_should_be(1000, list.free_space);
+    expect_should_be(1, list.range_count);
+    expect_should_be(1000, freelist_largest_free_block(&list));
+
+    freelist_destroy(&list);
+
+    expect_should_be(0, list.ranges);
+    expect_should_be(0, list.total_size);
+    expect_should_be(0, list.free_space);
+
+    kfree(memory, requirement, MEMORY_TAG_ARRAY);
+
+    return True;
+}
+
+/**
+ * @brief Tests allocating and freeing ranges in various orders.
+ *
+ * Ensures:
+ * - Ranges are handed out back to back at exactly the size requested
+ * - Freeing in any order merges neighbours, never leaving two adjacent free ranges
+ * - Freeing everything restores a single free range covering the block
+ */
+u8 freelist_should_allocate_free_and_merge() {
+    u64 requirement = 0;
+    freelist list;
+    void* memory = create_test_list(1000, 8, &requirement, &list);
+
+    u64 offsets[5];
+    u64 sizes[5] = {100, 60, 240, 20, 80};
+    u64 expected_offset = 0;
+    for (u32 i = 0; i < 5; ++i) {
+        expect_to_be_true(freelist_allocate_block(&list, sizes[i], &offsets[i]));
+        expect_should_be(expected_offset, offsets[i]);
+        expected_offset += sizes[i];
+    }
+    expect_should_be(500, list.free_space);
+    expect_should_be(1, list.range_count);
+
+    // Free 1 and 3, leaving them apart; then 2 joins them into one range.
+    expect_to_be_true(freelist_free_block(&list, sizes[1], offsets[1]));
+    expect_to_be_true(freelist_free_block(&list, sizes[3], offsets[3]));
+    expect_should_be(3, list.range_count);
+    expect_to_be_true(freelist_free_block(&list, sizes[2], offsets[2]));
+    expect_should_be(2, list.range_count);
+    expect_should_be(500, freelist_largest_free_block(&list));
+
+    // The last block joins the tail; the first joins everything.
+    expect_to_be_true(freelist_free_block(&list, sizes[4], offsets[4]));
+    expect_to_be_true(freelist_free_block(&list, sizes[0], offsets[0]));
+    expect_should_be(1, list.range_count);
+    expect_should_be(1000, list.free_space);
+    expect_should_be(1000, freelist_largest_free_block(&list));
+
+    freelist_destroy(&list);
+    kfree(memory, requirement, MEMORY_TAG_ARRAY);
+
+    return True;
+}
+
+/**
+ * @brief Tests that freed ranges are reused, with the best-fitting or lowest range chosen.
+ */
+u8 freelist_should_reuse_freed_ranges() {
+    u64 requirement = 0;
+    freelist list;
+    void* memory = create_test_list(1000, 8, &requirement, &list);
+
+    u64 a, b, c, d;
+    expect_to_be_true(freelist_allocate_block(&list, 200, &a));
+    expect_to_be_true(freelist_allocate_block(&list, 100, &b));
+    expect_to_be_true(freelist_allocate_block(&list, 50, &c));
+    expect_to_be_true(freelist_allocate_block(&list, 100, &d));
+
+    // Free ranges: [0, 200), [300, 350), and the 550 byte tail.
+    expect_to_be_true(freelist_free_block(&list, 200, a));
+    expect_to_be_true(freelist_free_block(&list, 50, c));
+
+    u64 offset = 0;
+    expect_to_be_true(freelist_allocate_block(&list, 40, &offset));
+    expect_should_be(c, offset);
+    expect_to_be_true(freelist_allocate_block(&list, 150, &offset));
+    expect_should_be(a, offset);
+    expect_to_be_true(freelist_allocate_block(&list, 500, &offset));
+    expect_should_be(450, offset);
+
+    // The lowest fit ignores better fits further along.
+    expect_to_be_true(freelist_free_block(&list, 100, b));
+    expect_to_be_true(freelist_allocate_block_lowest(&list, 10, &offset));
+    expect_should_be(150, offset);
+
+    freelist_destroy(&list);
+    kfree(memory, requirement, MEMORY_TAG_ARRAY);
+
+    return True;
+}
+
+/**
+ * @brief Tests growing the managed block, including when its tail is allocated.
+ */
+u8 freelist_should_resize() {
+    u64 requirement = 0;
+    freelist list;
+    void* memory = create_test_list(100, 8, &requirement, &list);
+
+    u64 offset = 0;
+    expect_to_be_true(freelist_allocate_block(&list, 100, &offset));
+    expect_to_be_false(freelist_allocate_block(&list, 50, &offset));
+
+    expect_to_be_false(freelist_resize(&list, 50));
+    expect_to_be_true(freelist_resize(&list, 300));
+    expect_should_be(300, list.total_size);
+    expect_should_be(200, list.free_space);
+
+    expect_to_be_true(freelist_allocate_block(&list, 50, &offset));
+    expect_should_be(100, offset);
+
+    // A free tail is extended rather than split into a second range.
+    expect_to_be_true(freelist_resize(&list, 400));
+    expect_should_be(1, list.range_count);
+    expect_should_be(250, freelist_largest_free_block(&list));
+
+    freelist_destroy(&list);
+    kfree(memory, requirement, MEMORY_TAG_ARRAY);
+
+    return True;
+}
+
+/**
+ * @brief Tests running out of space and invalid frees.
+ *
+ * Ensures:
+ * - Requests larger than the largest free range fail without changing state
+ * - Double frees, overlapping frees and out-of-range frees are rejected
+ * - Frees that would need more ranges than the list holds are rejected
+ */
+u8 freelist_should_handle_out_of_space_and_invalid_frees() {
+    u64 requirement = 0;
+    freelist list;
+    void* memory = create_test_list(100, 2, &requirement, &list);
+
+    u64 offsets[5];
+    for (u32 i = 0; i < 5; ++i) {
+        expect_to_be_true(freelist_allocate_block(&list, 20, &offsets[i]));
+    }
+    u64 offset = 0;
+    expect_to_be_false(freelist_allocate_block(&list, 1, &offset));
+    expect_should_be(0, list.free_space);
+
+    expect_to_be_true(freelist_free_block(&list, 20, offsets[0]));
+    expect_to_be_false(freelist_free_block(&list, 20, offsets[0]));
+    expect_to_be_false(freelist_free_block(&list, 30, offsets[1] - 5));
+    expect_to_be_false(freelist_free_block(&list, 20, 90));
+    expect_should_be(20, list.free_space);
+
+    // Two ranges are already tracked, so a third apart from them cannot be.
+    expect_to_be_true(freelist_free_block(&list, 20, offsets[2]));
+    expect_should_be(2, list.range_count);
+    expect_to_be_false(freelist_free_block(&list, 20, offsets[4]));
+    expect_should_be(40, list.free_space);
+
+    // Joining the two needs no new range.
+    expect_to_be_true(freelist_free_block(&list, 20, offsets[1]));
+    expect_should_be(1, list.range_count);
+    expect_should_be(60, list.free_space);
+
+    freelist_destroy(&list);
+    kfree(memory, requirement, MEMORY_TAG_ARRAY);
+
+    return True;
+}
+
+void freelist_register_tests() {
+    test_manager_register_test(freelist_should_create_and_destroy, "Freelist should create and destroy");
+    test_manager_register_test(freelist_should_allocate_free_and_merge, "Freelist should allocate, free and merge ranges");
+    test_manager_register_test(freelist_should_reuse_freed_ranges, "Freelist should reuse freed ranges");
+    test_manager_register_test(freelist_should_resize, "Freelist should grow");
+    test_manager_register_test(freelist_should_handle_out_of_space_and_invalid_frees, "Freelist should handle out of space and invalid frees");
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+/**
+ * @file freelist_tests.h
+ * @brief Unit tests for the free list implementation.
+ *
+ * Contains function declarations for various free list tests.
+ * All tests are registered via `freelist_register_tests()`.
+ */
+
+/**
+ * @brief Registers all free list tests with the test manager.
+ *
+ * Should be called before `test_manager_run_tests()` in main().
+ */
+void freelist_register_tests();
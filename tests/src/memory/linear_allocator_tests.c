@@ -15,6 +15,7 @@
  * - Multiple allocations up to capacity
  * - Handling out-of-memory conditions
  * - Resetting all allocations
+ * - Aligned allocations
  *
  * Uses the custom test manager and assertion macros from `test_manager.h`.
  */
@@ -152,7 +153,7 @@ u8 linear_allocator_multi_allocation_all_space_then_free() {
     }
 
     // Validate that pointer is reset.
-    linear_allocator_free_all(&alloc);
+    linear_allocator_free_all(&alloc, True);
     expect_should_be(0, alloc.allocated);
 
     linear_allocator_destroy(&alloc);
@@ -160,10 +161,40 @@ u8 linear_allocator_multi_allocation_all_space_then_free() {
     return True;
 }
 
+/**
+ * @brief Tests aligned allocations, and that free_all without clearing leaves memory untouched.
+ *
+ * Validates:
+ * - Blocks are aligned as requested, with padding counted as allocated
+ * - `free_all()` with clear = False resets the pointer without zeroing
+ */
+u8 linear_allocator_aligned_allocation_then_free_without_clear() {
+    linear_allocator alloc;
+    linear_allocator_create(1024, 0, &alloc);
+
+    u8* first = linear_allocator_allocate(&alloc, 3);
+    expect_should_not_be(0, first);
+    first[0] = 0xAB;
+
+    u8* aligned = linear_allocator_allocate_aligned(&alloc, 8, 64);
+    expect_should_not_be(0, aligned);
+    expect_should_be(0, ((u64)aligned) % 64);
+    expect_should_be((u64)(aligned - (u8*)alloc.memory) + 8, alloc.allocated);
+
+    linear_allocator_free_all(&alloc, False);
+    expect_should_be(0, alloc.allocated);
+    expect_should_be(0xAB, ((u8*)alloc.memory)[0]);
+
+    linear_allocator_destroy(&alloc);
+
+    return True;
+}
+
 void linear_allocator_register_tests() {
     test_manager_register_test(linear_allocator_should_create_and_destroy, "Linear allocator should create and destroy");
     test_manager_register_test(linear_allocator_single_allocation_all_space, "Linear allocator single alloc for all space");
     test_manager_register_test(linear_allocator_multi_allocation_all_space, "Linear allocator multi alloc for all space");
     test_manager_register_test(linear_allocator_multi_allocation_over_allocate, "Linear allocator try over allocate");
     test_manager_register_test(linear_allocator_multi_allocation_all_space_then_free, "Linear allocator allocated should be 0 after free_all");
+    test_manager_register_test(linear_allocator_aligned_allocation_then_free_without_clear, "Linear allocator aligned alloc and free_all without clear");
 }
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include "pool_allocator_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <memory/pool_allocator.h>
+#include <core/kmemory.h>
+#include <core/logger.h>
+#include <core/clock.h>
+
+/**
+ * @file pool_allocator_tests.c
+ * @brief Unit tests for the pool allocator subsystem.
+ *
+ * These tests validate core functionality of the `pool_allocator` including:
+ * - Creation and destruction
+ * - Allocating and freeing blocks, and reuse of freed blocks
+ * - Growing by chunks, and respecting the chunk limit
+ * - Alloc/free throughput compared to kallocate/kfree
+ *
+ * Uses the custom test manager and assertion macros from `test_manager.h`.
+ */
+
+/**
+ * @brief Tests that a pool allocator can be created and destroyed properly.
+ *
+ * Verifies:
+ * - The block size is rounded up to the block alignment
+ * - The first chunk is allocated up front
+ * - After destruction, all state is reset
+ */
+u8 pool_allocator_should_create_and_destroy() {
+    pool_allocator pool;
+    expect_to_be_true(pool_allocator_create(20, 8, 0, MEMORY_TAG_UNKNOWN, &pool));
+
+    expect_should_be(32, pool.block_size);
+    expect_should_be(1, pool.chunk_count);
+    expect_should_be(8, pool_allocator_capacity(&pool));
+    expect_should_be(0, pool.allocated_count);
+    expect_should_not_be(0, pool.free_list);
+
+    pool_allocator_destroy(&pool);
+
+    expect_should_be(0, pool.block_size);
+    expect_should_be(0, pool.chunk_count);
+    expect_should_be(0, pool.free_list);
+    expect_should_be(0, pool.chunks);
+
+    return True;
+}
+
+/**
+ * @brief Tests allocating every block in a chunk, then freeing and reallocating.
+ *
+ * Ensures:
+ * - Every block is distinct and aligned
+ * - A freed block is handed out again by the next allocation
+ */
+u8 pool_allocator_should_allocate_and_reuse_blocks() {
+    const u32 block_count = 16;
+    pool_allocator pool;
+    pool_allocator_create(sizeof(u64) * 3, block_count, 1, MEMORY_TAG_UNKNOWN, &pool);
+
+    void* blocks[16];
+    for (u32 i = 0; i < block_count; ++i) {
+        blocks[i] = pool_allocator_allocate(&pool);
+        expect_should_not_be(0, blocks[i]);
+        expect_should_be(0, ((u64)blocks[i]) % 16);
+        // Write over the whole block to make sure nothing else lives there.
+        kset_memory(blocks[i], (i32)i, pool.block_size);
+    }
+    expect_should_be(block_count, pool.allocated_count);
+
+    for (u32 i = 0; i < block_count; ++i) {
+        for (u32 j = 0; j < pool.block_size; ++j) {
+            expect_should_be(i, ((u8*)blocks[i])[j]);
+        }
+    }
+
+    pool_allocator_free(&pool, blocks[5]);
+    expect_should_be(block_count - 1, pool.allocated_count);
+
+    void* reused = pool_allocator_allocate(&pool);
+    expect_should_be(blocks[5], reused);
+    expect_should_be(block_count, pool.peak_count);
+
+    for (u32 i = 0; i < block_count; ++i) {
+        pool_allocator_free(&pool, blocks[i]);
+    }
+    expect_should_be(0, pool.allocated_count);
+
+    pool_allocator_destroy(&pool);
+
+    return True;
+}
+
+/**
+ * @brief Tests that the pool grows by whole chunks, and stops at the chunk limit.
+ *
+ * Ensures:
+ * - Allocating past the first chunk adds another
+ * - A pool at its chunk limit fails allocations rather than growing
+ */
+u8 pool_allocator_should_grow_until_limit() {
+    pool_allocator pool;
+    pool_allocator_create(sizeof(u64), 4, 2, MEMORY_TAG_UNKNOWN, &pool);
+
+    void* blocks[8];
+    for (u32 i = 0; i < 8; ++i) {
+        blocks[i] = pool_allocator_allocate(&pool);
+        expect_should_not_be(0, blocks[i]);
+    }
+    expect_should_be(2, pool.chunk_count);
+    expect_should_be(8, pool_allocator_capacity(&pool));
+
+    KDEBUG("Note: The following error is intentionally caused by this test.");
+    void* overflow = pool_allocator_allocate(&pool);
+    expect_should_be(0, overflow);
+    expect_should_be(2, pool.chunk_count);
+
+    for (u32 i = 0; i < 8; ++i) {
+        pool_allocator_free(&pool, blocks[i]);
+    }
+    pool_allocator_destroy(&pool);
+
+    return True;
+}
+
+/**
+ * @brief Compares pool alloc/free throughput against kallocate/kfree.
+ *
+ * Allocates and frees a texture-data-sized block many times, keeping a rolling window
+ * of live blocks to resemble resource churn. Timings are logged, not asserted.
+ */
+u8 pool_allocator_benchmark_against_kallocate() {
+    const u64 block_size = 96;
+    const u32 live_count = 256;
+    const u32 iterations = 200000;
+
+    void* live[256];
+    kzero_memory(live, sizeof(live));
+
+    clock timer;
+    clock_start(&timer);
+    for (u32 i = 0; i < iterations; ++i) {
+        u32 slot = i % live_count;
+        if (live[slot]) {
+            kfree(live[slot], block_size, MEMORY_TAG_TEXTURE);
+        }
+        live[slot] = kallocate(block_size, MEMORY_TAG_TEXTURE);
+    }
+    for (u32 i = 0; i < live_count; ++i) {
+        kfree(live[i], block_size, MEMORY_TAG_TEXTURE);
+        live[i] = 0;
+    }
+    clock_update(&timer);
+    f64 kallocate_time = timer.elapsed;
+
+    pool_allocator pool;
+    pool_allocator_create(block_size, 64, 0, MEMORY_TAG_TEXTURE, &pool);
+
+    clock_start(&timer);
+    for (u32 i = 0; i < iterations; ++i) {
+        u32 slot = i % live_count;
+        if (live[slot]) {
+            pool_allocator_free(&pool, live[slot]);
+        }
+        live[slot] = pool_allocator_allocate(&pool);
+    }
+    for (u32 i = 0; i < live_count; ++i) {
+        pool_allocator_free(&pool, live[i]);
+    }
+    clock_update(&timer);
+    f64 pool_time = timer.elapsed;
+
+    expect_should_be(0, pool.allocated_count);
+    expect_should_be(live_count, pool.peak_count);
+
+    KINFO("Pool allocator benchmark (%u alloc/free pairs of %llu bytes): kallocate %.6f sec, pool %.6f sec.",
+          iterations, block_size, kallocate_time, pool_time);
+
+    pool_allocator_destroy(&pool);
+
+    return True;
+}
+
+void pool_allocator_register_tests() {
+    test_manager_register_test(pool_allocator_should_create_and_destroy, "Pool allocator should create and destroy");
+    test_manager_register_test(pool_allocator_should_allocate_and_reuse_blocks, "Pool allocator should allocate and reuse blocks");
+    test_manager_register_test(pool_allocator_should_grow_until_limit, "Pool allocator should grow by chunks until its limit");
+    test_manager_register_test(pool_allocator_benchmark_against_kallocate, "Pool allocator benchmark against kallocate");
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+/**
+ * @file pool_allocator_tests.h
+ * @brief Unit tests for the pool allocator implementation.
+ *
+ * Contains function declarations for various pool allocator tests.
+ * All tests are registered via `pool_allocator_register_tests()`.
+ */
+
+/**
+ * @brief Registers all pool allocator tests with the test manager.
+ *
+ * Should be called before `test_manager_run_tests()` in main().
+ */
+void pool_allocator_register_tests();
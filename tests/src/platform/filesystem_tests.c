@@ -0,0 +1,144 @@
+#include "filesystem_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+#include "../test_utils.h"
+
+#include <defines.h>
+#include <core/kmemory.h>
+#include <core/kstring.h>
+#include <platform/filesystem.h>
+#include <platform/platform.h>
+
+#include <stdio.h>
+
+#if KPLATFORM_LINUX
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @file filesystem_tests.c
+ * @brief Unit tests for the filesystem layer.
+ *
+ * These tests validate:
+ * - Mapping a file exposing its contents, and empty or missing files not mapping
+ * - Watching a directory tree reporting written files by relative path, including files in
+ *   directories created after the watch started
+ *
+ * Files are written to the working directory and removed afterward.
+ */
+
+/** @brief The directory the watch test writes into. */
+#define WATCH_TEST_DIR "filesystem_watch_test"
+
+/**
+ * @brief Tests that a mapped file holds its contents, and that empty and missing files do not map.
+ */
+u8 filesystem_map_should_expose_contents() {
+    const char* path = "filesystem_map_test.txt";
+    const char* text = "Mapped straight into memory.";
+    expect_to_be_true(test_write_text(path, text));
+
+    file_mapping mapping;
+    expect_to_be_true(filesystem_map(path, &mapping));
+    expect_should_be(string_length(text), mapping.size);
+    b8 matches = True;
+    for (u64 i = 0; i < mapping.size; ++i) {
+        matches = matches && ((const char*)mapping.memory)[i] == text[i];
+    }
+    expect_to_be_true(matches);
+
+    filesystem_unmap(&mapping);
+    expect_should_be(0, mapping.memory);
+    expect_should_be(0, mapping.size);
+
+    // Empty files cannot be mapped.
+    expect_to_be_true(test_write_text(path, ""));
+    expect_to_be_false(filesystem_map(path, &mapping));
+    expect_should_be(0, mapping.memory);
+
+    remove(path);
+    expect_to_be_false(filesystem_map(path, &mapping));
+    return True;
+}
+
+/** @brief What the watch test has seen. */
+typedef struct watch_results {
+    /** The number of files reported. */
+    u32 count;
+    /** The number of times "a.txt" was reported. */
+    u32 root_file;
+    /** The number of times "sub/b.txt" was reported. */
+    u32 nested_file;
+} watch_results;
+
+static void on_file_changed(const char* path, void* listener) {
+    watch_results* results = listener;
+    results->count++;
+    if (strings_equal(path, "a.txt")) {
+        results->root_file++;
+    } else if (strings_equal(path, "sub/b.txt")) {
+        results->nested_file++;
+    }
+}
+
+/** @brief Polls a watch until it reports something, or a generous limit passes. */
+static void poll_until_reported(file_watch* watch, watch_results* results) {
+    u32 start = results->count;
+    for (u32 i = 0; i < 1000 && results->count == start; ++i) {
+        filesystem_watch_poll(watch, on_file_changed, results);
+        platform_sleep(1);
+    }
+}
+
+/**
+ * @brief Tests that a watch reports files written under it by relative path, and follows new
+ * directories.
+ */
+u8 filesystem_watch_should_report_written_files() {
+#if KPLATFORM_LINUX
+    mkdir(WATCH_TEST_DIR, 0755);
+
+    file_watch watch;
+    expect_to_be_true(filesystem_watch_create(WATCH_TEST_DIR, &watch));
+
+    watch_results results;
+    kzero_memory(&results, sizeof(watch_results));
+
+    // Nothing has been written yet.
+    expect_should_be(0, filesystem_watch_poll(&watch, on_file_changed, &results));
+
+    expect_to_be_true(test_write_text(WATCH_TEST_DIR "/a.txt", "first"));
+    poll_until_reported(&watch, &results);
+    expect_should_be(1, results.root_file);
+
+    // A directory created after the watch started is watched once the watch sees it.
+    mkdir(WATCH_TEST_DIR "/sub", 0755);
+    filesystem_watch_poll(&watch, on_file_changed, &results);
+    expect_to_be_true(test_write_text(WATCH_TEST_DIR "/sub/b.txt", "second"));
+    poll_until_reported(&watch, &results);
+    expect_should_be(1, results.nested_file);
+    expect_should_be(2, results.count);
+
+    filesystem_watch_destroy(&watch);
+    expect_should_be(0, watch.internal_data);
+    expect_should_be(0, filesystem_watch_poll(&watch, on_file_changed, &results));
+
+    remove(WATCH_TEST_DIR "/sub/b.txt");
+    rmdir(WATCH_TEST_DIR "/sub");
+    remove(WATCH_TEST_DIR "/a.txt");
+    rmdir(WATCH_TEST_DIR);
+
+    // Missing directories cannot be watched.
+    expect_to_be_false(filesystem_watch_create(WATCH_TEST_DIR, &watch));
+    return True;
+#else
+    // File watching is only implemented with inotify.
+    return BYPASS;
+#endif
+}
+
+void filesystem_register_tests() {
+    test_manager_register_test(filesystem_map_should_expose_contents, "Filesystem map should expose file contents");
+    test_manager_register_test(filesystem_watch_should_report_written_files, "Filesystem watch should report written files");
+}
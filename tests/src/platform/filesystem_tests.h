@@ -0,0 +1,16 @@
+#pragma once
+
+/**
+ * @file filesystem_tests.h
+ * @brief Unit tests for the filesystem layer.
+ *
+ * Contains function declarations for various filesystem tests.
+ * All tests are registered via `filesystem_register_tests()`.
+ */
+
+/**
+ * @brief Registers all filesystem tests with the test manager.
+ *
+ * Should be called before `test_manager_run_tests()` in main().
+ */
+void filesystem_register_tests();
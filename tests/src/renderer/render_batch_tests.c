@@ -0,0 +1,196 @@
+#include "render_batch_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <renderer/render_batch.h>
+#include <core/kmemory.h>
+
+/**
+ * @file render_batch_tests.c
+ * @brief Unit tests for draw sorting and batching.
+ *
+ * These tests validate core functionality of `render_batch` including:
+ * - Sort keys ordering by pipeline, then material, then geometry
+ * - Merging draws of the same geometry and material into instanced batches
+ * - Keeping the submission order of instances within a batch
+ * - Skipping geometries that have not been uploaded
+ *
+ * Uses the custom test manager and assertion macros from `test_manager.h`.
+ */
+
+/** @brief The batches and transforms built from a set of geometries, in kallocate'd blocks. */
+typedef struct test_batches {
+    void* scratch;
+    u64 scratch_size;
+    mat4* transforms;
+    render_batch* batches;
+    u32 count;
+    u32 batch_count;
+} test_batches;
+
+static void build_test_batches(const geometry_render_data* geometries, u32 count, material* default_material, test_batches* out) {
+    out->count = count;
+    out->scratch_size = render_batch_scratch_size(count);
+    out->scratch = kallocate(out->scratch_size, MEMORY_TAG_ARRAY);
+    out->transforms = kallocate(sizeof(mat4) * count, MEMORY_TAG_ARRAY);
+    out->batches = kallocate(sizeof(render_batch) * count, MEMORY_TAG_ARRAY);
+    out->batch_count = render_batch_build(geometries, count, default_material, out->scratch, out->transforms, out->batches);
+}
+
+static void destroy_test_batches(test_batches* batches) {
+    kfree(batches->scratch, batches->scratch_size, MEMORY_TAG_ARRAY);
+    kfree(batches->transforms, sizeof(mat4) * batches->count, MEMORY_TAG_ARRAY);
+    kfree(batches->batches, sizeof(render_batch) * batches->count, MEMORY_TAG_ARRAY);
+}
+
+/** @brief Creates a model matrix whose first element identifies it. */
+static mat4 tagged_transform(f32 tag) {
+    mat4 m;
+    kzero_memory(&m, sizeof(mat4));
+    m.data[0] = tag;
+    return m;
+}
+
+/**
+ * @brief Tests that sort keys order by pipeline first, then material, then geometry.
+ */
+u8 render_batch_key_should_order_by_state() {
+    expect_to_be_true(render_batch_key_create(0, 1, 0) > render_batch_key_create(0, 0, 0xFFFFFFFF));
+    expect_to_be_true(render_batch_key_create(1, 0, 0) > render_batch_key_create(0, 0xFFFFFF, 0xFFFFFFFF));
+    expect_to_be_true(render_batch_key_create(0, 2, 5) < render_batch_key_create(0, 2, 6));
+    expect_should_be(render_batch_key_create(3, 7, 9), render_batch_key_create(3, 7, 9));
+
+    // Ids wider than their field do not spill into the fields above.
+    expect_should_be(render_batch_key_create(0, 0, 1), render_batch_key_create(0, 0x1000000, 1));
+
+    return True;
+}
+
+/**
+ * @brief Tests that draws of the same geometry and material are merged into instanced batches.
+ *
+ * Ensures:
+ * - Batches come out in key order, whatever order the draws were submitted in
+ * - Each batch's instances are contiguous in the transform array, in submission order
+ * - Geometries without a material batch with those using the default material
+ */
+u8 render_batch_should_merge_instances() {
+    material default_material = {};
+    default_material.id = 0;
+    material other_material = {};
+    other_material.id = 1;
+
+    geometry a = {};
+    a.id = 10;
+    a.internal_id = 0;
+    a.material = &other_material;
+    geometry b = {};
+    b.id = 20;
+    b.internal_id = 1;
+    b.material = 0;
+
+    // Interleave the draws: a, b, a, b, a.
+    geometry_render_data geometries[5];
+    for (u32 i = 0; i < 5; ++i) {
+        geometries[i].geometry = (i % 2 == 0) ? &a : &b;
+        geometries[i].model = tagged_transform((f32)i);
+    }
+
+    test_batches result;
+    build_test_batches(geometries, 5, &default_material, &result);
+
+    // b uses the default material (id 0), so sorts ahead of a.
+    expect_should_be(2, result.batch_count);
+    expect_should_be(&b, result.batches[0].geometry);
+    expect_should_be(&default_material, result.batches[0].material);
+    expect_should_be(0, result.batches[0].first_instance);
+    expect_should_be(2, result.batches[0].instance_count);
+    expect_should_be(&a, result.batches[1].geometry);
+    expect_should_be(&other_material, result.batches[1].material);
+    expect_should_be(2, result.batches[1].first_instance);
+    expect_should_be(3, result.batches[1].instance_count);
+
+    // Instances keep their submission order within a batch.
+    f32 expected_tags[5] = {1, 3, 0, 2, 4};
+    for (u32 i = 0; i < 5; ++i) {
+        expect_float_to_be(expected_tags[i], result.transforms[i].data[0]);
+    }
+
+    destroy_test_batches(&result);
+
+    return True;
+}
+
+/**
+ * @brief Tests sorting a larger set of draws.
+ *
+ * Ensures:
+ * - Every batch's key is greater than the previous one's
+ * - Every draw ends up in exactly one batch
+ * - Geometries that are not uploaded are skipped
+ */
+u8 render_batch_should_sort_many_draws() {
+    const u32 material_count = 7;
+    const u32 geometry_count = 13;
+    const u32 draw_count = 1000;
+
+    material materials[7];
+    for (u32 i = 0; i < material_count; ++i) {
+        kzero_memory(&materials[i], sizeof(material));
+        materials[i].id = (i * 5 + 3) % material_count;
+    }
+
+    geometry geometries[13];
+    for (u32 i = 0; i < geometry_count; ++i) {
+        kzero_memory(&geometries[i], sizeof(geometry));
+        // Ids spread over several bytes, so more than one radix pass is needed.
+        geometries[i].id = (i * 7919) % 65536 + (i << 20);
+        geometries[i].internal_id = (i == 4) ? INVALID_ID : i;
+        geometries[i].material = &materials[i % material_count];
+    }
+
+    geometry_render_data* draws = kallocate(sizeof(geometry_render_data) * draw_count, MEMORY_TAG_ARRAY);
+    u32 expected_draws = 0;
+    for (u32 i = 0; i < draw_count; ++i) {
+        u32 g = (i * 31 + 17) % geometry_count;
+        draws[i].geometry = &geometries[g];
+        draws[i].model = tagged_transform((f32)i);
+        if (g != 4) {
+            expected_draws++;
+        }
+    }
+
+    test_batches result;
+    build_test_batches(draws, draw_count, 0, &result);
+
+    // One batch per uploaded geometry, as each has a single material.
+    expect_should_be(geometry_count - 1, result.batch_count);
+
+    u32 instance_total = 0;
+    u64 previous_key = 0;
+    for (u32 i = 0; i < result.batch_count; ++i) {
+        const render_batch* batch = &result.batches[i];
+        expect_should_not_be(&geometries[4], batch->geometry);
+        expect_should_be(instance_total, batch->first_instance);
+
+        u64 key = render_batch_key_create(0, batch->material->id, batch->geometry->id);
+        if (i > 0) {
+            expect_to_be_true(key > previous_key);
+        }
+        previous_key = key;
+        instance_total += batch->instance_count;
+    }
+    expect_should_be(expected_draws, instance_total);
+
+    destroy_test_batches(&result);
+    kfree(draws, sizeof(geometry_render_data) * draw_count, MEMORY_TAG_ARRAY);
+
+    return True;
+}
+
+void render_batch_register_tests() {
+    test_manager_register_test(render_batch_key_should_order_by_state, "Render batch keys should order by pipeline, material, then geometry");
+    test_manager_register_test(render_batch_should_merge_instances, "Render batch should merge instances of the same geometry and material");
+    test_manager_register_test(render_batch_should_sort_many_draws, "Render batch should sort many draws");
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+/**
+ * @file render_batch_tests.h
+ * @brief Unit tests for draw sorting and batching.
+ *
+ * Contains function declarations for various render batch tests.
+ * All tests are registered via `render_batch_register_tests()`.
+ */
+
+/**
+ * @brief Registers all render batch tests with the test manager.
+ *
+ * Should be called before `test_manager_run_tests()` in main().
+ */
+void render_batch_register_tests();
@@ -0,0 +1,151 @@
+#include "render_cull_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <math/kmath.h>
+#include <renderer/render_cull.h>
+
+/**
+ * @file render_cull_tests.c
+ * @brief Unit tests for frustum culling.
+ *
+ * These tests validate core functionality of `render_cull` including:
+ * - Extracting normalized, inward-facing planes from a view and projection
+ * - Keeping geometries inside or straddling the frustum, in order, and culling the rest
+ * - Moving bounds with translation and scale
+ * - Culling with the box what the sphere alone would keep
+ *
+ * Every test looks down -z from the origin, with a 90 degree field of view, so the side planes
+ * are where |x| or |y| equals -z. The near plane is at z = -1 and the far plane at z = -100.
+ *
+ * Uses the custom test manager and assertion macros from `test_manager.h`.
+ */
+
+static frustum test_frustum() {
+    mat4 projection = mat4_perspective(deg_to_rad(90.0f), 1.0f, 1.0f, 100.0f);
+    return render_cull_frustum_create(mat4_mul(mat4_identity(), projection));
+}
+
+/** @brief Creates a geometry with the bounds of a box around the origin. */
+static geometry box_geometry(vec3 half_extents) {
+    geometry g = {};
+    g.extents.min = vec3_mul_scalar(half_extents, -1.0f);
+    g.extents.max = half_extents;
+    g.center = vec3_zero();
+    g.radius = vec3_length(half_extents);
+    return g;
+}
+
+static geometry_render_data placed(geometry* g, vec3 position, vec3 scale) {
+    geometry_render_data data;
+    data.geometry = g;
+    data.model = mat4_mul(mat4_scale(scale), mat4_translation(position));
+    return data;
+}
+
+static f32 plane_distance(vec4 plane, vec3 point) {
+    return plane.x * point.x + plane.y * point.y + plane.z * point.z + plane.w;
+}
+
+/**
+ * @brief Tests that the planes face inward, are normalized, and lie where the projection puts them.
+ */
+u8 render_cull_frustum_should_match_projection() {
+    frustum f = test_frustum();
+
+    for (u32 i = 0; i < 6; ++i) {
+        vec4 plane = f.planes[i];
+        expect_float_to_be(1.0f, ksqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z));
+        // A point in the middle of the frustum is inside every plane.
+        expect_to_be_true(plane_distance(plane, vec3_create(0.0f, 0.0f, -10.0f)) > 0.0f);
+    }
+
+    // Left, right, bottom, top, near, far.
+    expect_float_to_be(0.0f, plane_distance(f.planes[0], vec3_create(-10.0f, 0.0f, -10.0f)));
+    expect_float_to_be(0.0f, plane_distance(f.planes[1], vec3_create(10.0f, 0.0f, -10.0f)));
+    expect_float_to_be(0.0f, plane_distance(f.planes[2], vec3_create(0.0f, -10.0f, -10.0f)));
+    expect_float_to_be(0.0f, plane_distance(f.planes[3], vec3_create(0.0f, 10.0f, -10.0f)));
+    expect_float_to_be(0.0f, plane_distance(f.planes[4], vec3_create(0.0f, 0.0f, -1.0f)));
+    expect_float_to_be(0.0f, plane_distance(f.planes[5], vec3_create(0.0f, 0.0f, -100.0f)));
+
+    return True;
+}
+
+/**
+ * @brief Tests that geometries inside or straddling the frustum are kept in their original order,
+ * and the rest culled and counted.
+ *
+ * Uses a count that is not a multiple of 4, with an empty entry, so the SIMD groups do not line
+ * up with the input.
+ */
+u8 render_cull_should_keep_visible_geometries_in_order() {
+    frustum f = test_frustum();
+    geometry cube = box_geometry(vec3_one());
+
+    geometry_render_data data[10];
+    data[0] = placed(&cube, vec3_create(0.0f, 0.0f, -10.0f), vec3_one());     // In front.
+    data[1] = placed(&cube, vec3_create(0.0f, 0.0f, 10.0f), vec3_one());      // Behind.
+    data[2] = placed(&cube, vec3_create(-100.0f, 0.0f, -10.0f), vec3_one());  // Far to the left.
+    data[3] = placed(&cube, vec3_create(-10.5f, 0.0f, -10.0f), vec3_one());   // Straddling the left plane.
+    data[4] = placed(0, vec3_zero(), vec3_one());                             // Empty.
+    data[5] = placed(&cube, vec3_create(0.0f, 0.0f, -200.0f), vec3_one());    // Past the far plane.
+    data[6] = placed(&cube, vec3_create(0.0f, 0.0f, -0.1f), vec3_one());      // Straddling the near plane.
+    data[7] = placed(&cube, vec3_create(0.0f, 30.0f, -10.0f), vec3_one());    // Above.
+    data[8] = placed(&cube, vec3_create(-30.0f, 0.0f, -10.0f), vec3_create(25.0f, 25.0f, 25.0f));  // Off to the left, but scaled into view.
+    data[9] = placed(&cube, vec3_create(5.0f, -5.0f, -50.0f), vec3_one());    // In front.
+
+    geometry_render_data visible[10];
+    render_cull_stats stats;
+    u32 visible_count = render_cull_geometries(&f, data, 10, visible, &stats);
+
+    expect_should_be(5, visible_count);
+    expect_should_be(9, stats.tested);
+    expect_should_be(4, stats.culled);
+    expect_float_to_be(-10.0f, visible[0].model.data[14]);
+    expect_float_to_be(-10.5f, visible[1].model.data[12]);
+    expect_float_to_be(-0.1f, visible[2].model.data[14]);
+    expect_float_to_be(-30.0f, visible[3].model.data[12]);
+    expect_float_to_be(-50.0f, visible[4].model.data[14]);
+
+    // Nothing to test.
+    visible_count = render_cull_geometries(&f, data, 0, visible, &stats);
+    expect_should_be(0, visible_count);
+    expect_should_be(0, stats.tested);
+
+    return True;
+}
+
+/**
+ * @brief Tests that a long, thin box whose bounding sphere reaches into the frustum is still
+ * culled by its box, and kept once it is moved to reach in.
+ */
+u8 render_cull_box_should_cull_what_sphere_keeps() {
+    frustum f = test_frustum();
+    geometry rod = box_geometry(vec3_create(20.0f, 0.5f, 0.5f));
+
+    // Spans x from -45 to -5 at z = -2, where the frustum spans -2 to 2.
+    geometry_render_data data[2];
+    data[0] = placed(&rod, vec3_create(-25.0f, 0.0f, -2.0f), vec3_one());
+    // Spans x from -30 to 10, crossing into view.
+    data[1] = placed(&rod, vec3_create(-10.0f, 0.0f, -2.0f), vec3_one());
+
+    // The sphere of the first reaches past the left plane.
+    vec4 left = f.planes[0];
+    expect_to_be_true(plane_distance(left, vec3_create(-25.0f, 0.0f, -2.0f)) + rod.radius > 0.0f);
+
+    geometry_render_data visible[2];
+    render_cull_stats stats;
+    u32 visible_count = render_cull_geometries(&f, data, 2, visible, &stats);
+    expect_should_be(1, visible_count);
+    expect_should_be(1, stats.culled);
+    expect_float_to_be(-10.0f, visible[0].model.data[12]);
+
+    return True;
+}
+
+void render_cull_register_tests() {
+    test_manager_register_test(render_cull_frustum_should_match_projection, "Render cull frustum planes should match the projection");
+    test_manager_register_test(render_cull_should_keep_visible_geometries_in_order, "Render cull should keep visible geometries in order and count the rest");
+    test_manager_register_test(render_cull_box_should_cull_what_sphere_keeps, "Render cull should cull by box what the sphere alone would keep");
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+/**
+ * @file render_cull_tests.h
+ * @brief Unit tests for frustum culling.
+ *
+ * Contains function declarations for various render cull tests.
+ * All tests are registered via `render_cull_register_tests()`.
+ */
+
+/**
+ * @brief Registers all render cull tests with the test manager.
+ *
+ * Should be called before `test_manager_run_tests()` in main().
+ */
+void render_cull_register_tests();
@@ -0,0 +1,263 @@
+#include "kpak_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <core/kmemory.h>
+#include <core/kstring.h>
+#include <resources/kpak.h>
+#include <resources/resource_types.h>
+#include <systems/resource_system.h>
+
+#include <stdio.h>
+
+/**
+ * @file kpak_tests.c
+ * @brief Unit tests for the packed asset archive.
+ *
+ * These tests validate:
+ * - The codec round-tripping repetitive, random and empty data, and rejecting corrupt input
+ * - Archives finding every entry by path, with stored entries read in place and aligned
+ * - Invalid archives and duplicate paths being rejected
+ * - The resource system serving loaders from a mounted archive
+ *
+ * Archives are written to the working directory and removed afterward.
+ */
+
+/** @brief The path test archives are written to. */
+#define KPAK_TEST_PATH "kpak_test.kpak"
+
+/** @brief Some text that compresses well. */
+static const char* test_text =
+    "The quick brown fox jumps over the lazy dog. The quick brown fox jumps over the lazy dog.\n"
+    "The quick brown fox jumps over the lazy dog. The quick brown fox jumps over the lazy dog.\n"
+    "The quick brown fox jumps over the lazy dog. The quick brown fox jumps over the lazy dog.\n";
+
+/** @brief Fills a buffer with bytes that do not compress, from a fixed seed. */
+static void fill_random(u8* data, u64 size) {
+    u32 state = 0x12345678;
+    for (u64 i = 0; i < size; ++i) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        data[i] = (u8)state;
+    }
+}
+
+/** @brief Checks whether two blocks of memory hold the same bytes. */
+static b8 bytes_equal(const void* a, const void* b, u64 size) {
+    for (u64 i = 0; i < size; ++i) {
+        if (((const u8*)a)[i] != ((const u8*)b)[i]) {
+            return False;
+        }
+    }
+    return True;
+}
+
+/** @brief Compresses then decompresses data, checking it comes back the same. */
+static b8 round_trip(const void* data, u64 size, u64* out_compressed_size) {
+    u64 bound = kpak_compress_bound(size);
+    u8* compressed = kallocate(bound, MEMORY_TAG_ARRAY);
+    u8* decompressed = kallocate(size ? size : 1, MEMORY_TAG_ARRAY);
+
+    u64 compressed_size = kpak_compress(data, size, compressed);
+    b8 result = compressed_size <= bound && kpak_decompress(compressed, compressed_size, decompressed, size) &&
+                bytes_equal(decompressed, data, size);
+
+    *out_compressed_size = compressed_size;
+    kfree(compressed, bound, MEMORY_TAG_ARRAY);
+    kfree(decompressed, size ? size : 1, MEMORY_TAG_ARRAY);
+    return result;
+}
+
+/**
+ * @brief Tests that the codec round-trips data, shrinks repetitive data, and rejects corrupt input.
+ */
+u8 kpak_codec_should_round_trip() {
+    u64 compressed_size = 0;
+
+    // Repetitive text shrinks.
+    u64 text_size = string_length(test_text);
+    expect_to_be_true(round_trip(test_text, text_size, &compressed_size));
+    b8 shrank = compressed_size < text_size / 2;
+    expect_to_be_true(shrank);
+
+    // A long run, whose match overlaps itself and needs extra length bytes.
+    u8 run[5000];
+    kset_memory(run, 'a', sizeof(run));
+    expect_to_be_true(round_trip(run, sizeof(run), &compressed_size));
+    b8 run_shrank = compressed_size < 64;
+    expect_to_be_true(run_shrank);
+
+    // Random data survives, within the bound.
+    u64 random_size = 100000;
+    u8* random = kallocate(random_size, MEMORY_TAG_ARRAY);
+    fill_random(random, random_size);
+    expect_to_be_true(round_trip(random, random_size, &compressed_size));
+
+    // Tiny and empty inputs.
+    expect_to_be_true(round_trip("abc", 3, &compressed_size));
+    expect_to_be_true(round_trip("", 0, &compressed_size));
+
+    // Truncated input, and a size that does not match, are rejected.
+    u8 compressed[512];
+    u8 decompressed[512];
+    u64 size = kpak_compress(test_text, text_size, compressed);
+    expect_to_be_false(kpak_decompress(compressed, size - 3, decompressed, text_size));
+    expect_to_be_false(kpak_decompress(compressed, size, decompressed, text_size - 1));
+
+    // An offset reaching before the start of the output is rejected.
+    u8 bad[] = {0x10, 'x', 0x10, 0x00};
+    expect_to_be_false(kpak_decompress(bad, sizeof(bad), decompressed, 5));
+
+    kfree(random, random_size, MEMORY_TAG_ARRAY);
+    return True;
+}
+
+/**
+ * @brief Tests that every entry of a written archive is found and read back, with stored
+ * entries pointing into the mapping at the archive's alignment.
+ */
+u8 kpak_archive_should_find_and_read_entries() {
+    u64 random_size = 4096;
+    u8* random = kallocate(random_size, MEMORY_TAG_ARRAY);
+    fill_random(random, random_size);
+
+    kpak_source sources[4];
+    sources[0] = (kpak_source){"materials/test.kmt", test_text, string_length(test_text), True};
+    sources[1] = (kpak_source){"textures/noise.bin", random, random_size, True};
+    sources[2] = (kpak_source){"empty.txt", "", 0, True};
+    sources[3] = (kpak_source){"shaders/stored.txt", test_text, string_length(test_text), False};
+    expect_to_be_true(kpak_write(KPAK_TEST_PATH, 4, sources));
+
+    kpak pak;
+    expect_to_be_true(kpak_open(KPAK_TEST_PATH, &pak));
+    expect_should_be(4, pak.header->entry_count);
+
+    const u8* begin = pak.mapping.memory;
+    const u8* end = begin + pak.mapping.size;
+
+    for (u32 i = 0; i < 4; ++i) {
+        const kpak_entry* entry = kpak_find(&pak, sources[i].name);
+        expect_should_not_be(0, entry);
+        expect_should_be(0, entry->offset % KPAK_ALIGNMENT);
+
+        kpak_data data;
+        expect_to_be_true(kpak_read(&pak, entry, &data));
+        expect_should_be(sources[i].size, data.size);
+        expect_to_be_true(bytes_equal(data.data, sources[i].data, data.size));
+
+        // Only the text asked to be compressed is; the rest is read in place.
+        b8 expect_compressed = i == 0;
+        b8 compressed = entry->compression == KPAK_COMPRESSION_LZ;
+        b8 in_mapping = (const u8*)data.data >= begin && (const u8*)data.data <= end;
+        expect_should_be(expect_compressed, compressed);
+        expect_should_be(expect_compressed, data.owned);
+        expect_should_be(!expect_compressed, in_mapping);
+        kpak_data_release(&data);
+    }
+
+    // Lookups are exact.
+    expect_should_be(0, kpak_find(&pak, "materials/missing.kmt"));
+    expect_should_be(0, kpak_find(&pak, "materials/test.km"));
+    expect_should_be(0, kpak_find(&pak, "Materials/test.kmt"));
+
+    kpak_close(&pak);
+    remove(KPAK_TEST_PATH);
+    kfree(random, random_size, MEMORY_TAG_ARRAY);
+    return True;
+}
+
+/**
+ * @brief Tests that duplicate paths are not written, and that files which are not archives are
+ * not opened.
+ */
+u8 kpak_archive_should_reject_invalid_input() {
+    kpak_source sources[2];
+    sources[0] = (kpak_source){"same.txt", "a", 1, False};
+    sources[1] = (kpak_source){"same.txt", "b", 1, False};
+    expect_to_be_false(kpak_write(KPAK_TEST_PATH, 2, sources));
+
+    // A file that is not an archive.
+    file_handle f;
+    expect_to_be_true(filesystem_open(KPAK_TEST_PATH, FILE_MODE_WRITE, True, &f));
+    u64 written = 0;
+    u8 junk[256];
+    fill_random(junk, sizeof(junk));
+    expect_to_be_true(filesystem_write(&f, sizeof(junk), junk, &written));
+    filesystem_close(&f);
+
+    kpak pak;
+    expect_to_be_false(kpak_open(KPAK_TEST_PATH, &pak));
+    expect_should_be(0, pak.mapping.memory);
+
+    // A missing file.
+    remove(KPAK_TEST_PATH);
+    expect_to_be_false(kpak_open(KPAK_TEST_PATH, &pak));
+    return True;
+}
+
+/**
+ * @brief Tests that loaders read from the mounted archive, using stored files in place.
+ *
+ * The base path does not exist, so anything loaded must come from the archive.
+ */
+u8 kpak_resource_system_should_load_from_archive() {
+    const char* material_text =
+        "version=0.1\n"
+        "# A comment.\n"
+        "name=packed_material\n"
+        "diffuse_color=0.5 0.25 1.0 1.0\n"
+        "diffuse_map_name=paving";
+    const char* notes = "Stored in the archive.";
+
+    kpak_source sources[2];
+    sources[0] = (kpak_source){"materials/packed.kmt", material_text, string_length(material_text), True};
+    sources[1] = (kpak_source){"notes.txt", notes, string_length(notes), False};
+    expect_to_be_true(kpak_write(KPAK_TEST_PATH, 2, sources));
+
+    resource_system_config config;
+    config.max_loader_count = 32;
+    config.asset_base_path = "missing_assets";
+    config.max_async_load_count = 8;
+    config.archive_path = KPAK_TEST_PATH;
+    config.watch_for_changes = False;
+
+    u64 size = 0;
+    resource_system_initialize(&size, 0, config);
+    void* state = kallocate(size, MEMORY_TAG_APPLICATION);
+    expect_to_be_true(resource_system_initialize(&size, state, config));
+
+    // Stored text is used in place.
+    resource text;
+    expect_to_be_true(resource_system_load("notes.txt", RESOURCE_TYPE_TEXT, &text));
+    expect_should_be(string_length(notes), text.data_size);
+    expect_to_be_true(resource_system_is_packed(text.data));
+    expect_to_be_true(bytes_equal(text.data, notes, text.data_size));
+    resource_system_unload(&text);
+
+    // The material is parsed line by line out of the archive.
+    resource material;
+    expect_to_be_true(resource_system_load("packed", RESOURCE_TYPE_MATERIAL, &material));
+    material_config* config_data = material.data;
+    expect_to_be_true(strings_equal("packed_material", config_data->name));
+    expect_to_be_true(strings_equal("paving", config_data->diffuse_map_name));
+    expect_float_to_be(0.25f, config_data->diffuse_color.y);
+    resource_system_unload(&material);
+
+    // Files missing from the archive fall back to loose files, which do not exist either.
+    resource missing;
+    expect_to_be_false(resource_system_load("missing.txt", RESOURCE_TYPE_TEXT, &missing));
+
+    resource_system_shutdown(state);
+    kfree(state, size, MEMORY_TAG_APPLICATION);
+    remove(KPAK_TEST_PATH);
+    return True;
+}
+
+void kpak_register_tests() {
+    test_manager_register_test(kpak_codec_should_round_trip, "Kpak codec should round-trip data and reject corrupt input");
+    test_manager_register_test(kpak_archive_should_find_and_read_entries, "Kpak archive should find and read every entry");
+    test_manager_register_test(kpak_archive_should_reject_invalid_input, "Kpak archive should reject duplicate paths and invalid files");
+    test_manager_register_test(kpak_resource_system_should_load_from_archive, "Kpak resource system should load from a mounted archive");
+}
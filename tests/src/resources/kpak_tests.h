@@ -0,0 +1,16 @@
+#pragma once
+
+/**
+ * @file kpak_tests.h
+ * @brief Unit tests for the packed asset archive.
+ *
+ * Contains function declarations for various archive tests.
+ * All tests are registered via `kpak_register_tests()`.
+ */
+
+/**
+ * @brief Registers all archive tests with the test manager.
+ *
+ * Should be called before `test_manager_run_tests()` in main().
+ */
+void kpak_register_tests();
@@ -0,0 +1,316 @@
+#include "ktex_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <core/kmemory.h>
+#include <resources/kpak.h>
+#include <resources/ktex.h>
+#include <resources/resource_types.h>
+#include <systems/resource_system.h>
+
+#include <stdio.h>
+
+/**
+ * @file ktex_tests.c
+ * @brief Unit tests for the cooked texture container.
+ *
+ * These tests validate:
+ * - BC1 and BC3 blocks decoding close to what was encoded, including partial edge blocks
+ * - Cooking choosing the format from the transparency of the image, and building a full mip chain
+ * - Mip chains built at load time matching the box filter exactly, on both the vector and scalar paths
+ * - Truncated or inconsistent cooked textures being rejected
+ * - The image loader preferring cooked textures, and using them in place from an archive
+ *
+ * Archives are written to the working directory and removed afterward.
+ */
+
+/** @brief The path test archives are written to. */
+#define KTEX_TEST_PATH "ktex_test.kpak"
+
+/** @brief Fills an image with colors that lie on a line, which BC1 represents well. */
+static void fill_gradient(u8* pixels, u32 width, u32 height) {
+    for (u32 y = 0; y < height; ++y) {
+        for (u32 x = 0; x < width; ++x) {
+            u8* pixel = pixels + (y * width + x) * 4;
+            u8 value = (u8)(x * 16 + y * 4);
+            pixel[0] = value;
+            pixel[1] = value;
+            pixel[2] = value / 2;
+            pixel[3] = 255;
+        }
+    }
+}
+
+/** @brief Gets the largest difference between two images in any of the given channels. */
+static i32 max_error(const u8* a, const u8* b, u32 pixel_count, u32 first_channel, u32 channel_count) {
+    i32 largest = 0;
+    for (u32 i = 0; i < pixel_count; ++i) {
+        for (u32 c = first_channel; c < first_channel + channel_count; ++c) {
+            i32 difference = a[i * 4 + c] - b[i * 4 + c];
+            difference = difference < 0 ? -difference : difference;
+            largest = KMAX(largest, difference);
+        }
+    }
+    return largest;
+}
+
+/**
+ * @brief Tests that BC1 and BC3 blocks decode close to the pixels they were encoded from.
+ */
+u8 ktex_codec_should_round_trip_blocks() {
+    // Not a multiple of the block size, so the edge blocks are partial.
+    const u32 width = 10;
+    const u32 height = 6;
+    u8 pixels[10 * 6 * 4];
+    u8 decoded[10 * 6 * 4];
+    u8 blocks[3 * 2 * 16];
+
+    fill_gradient(pixels, width, height);
+    expect_should_be(48, ktex_level_size(TEXTURE_FORMAT_BC1, width, height));
+    ktex_encode(TEXTURE_FORMAT_BC1, pixels, width, height, blocks);
+    ktex_decode(TEXTURE_FORMAT_BC1, blocks, width, height, decoded);
+    b8 color_close = max_error(pixels, decoded, width * height, 0, 3) <= 16;
+    b8 opaque = max_error(pixels, decoded, width * height, 3, 1) == 0;
+    expect_to_be_true(color_close);
+    expect_to_be_true(opaque);
+
+    // A solid color is only off by the rounding to 5:6:5.
+    for (u32 i = 0; i < width * height; ++i) {
+        pixels[i * 4 + 0] = 200;
+        pixels[i * 4 + 1] = 100;
+        pixels[i * 4 + 2] = 50;
+    }
+    ktex_encode(TEXTURE_FORMAT_BC1, pixels, width, height, blocks);
+    ktex_decode(TEXTURE_FORMAT_BC1, blocks, width, height, decoded);
+    b8 solid_close = max_error(pixels, decoded, width * height, 0, 3) <= 4;
+    expect_to_be_true(solid_close);
+
+    // BC3 keeps a gradient of alpha alongside the color.
+    for (u32 y = 0; y < height; ++y) {
+        for (u32 x = 0; x < width; ++x) {
+            pixels[(y * width + x) * 4 + 3] = (u8)(x * 25 + y * 5);
+        }
+    }
+    expect_should_be(96, ktex_level_size(TEXTURE_FORMAT_BC3, width, height));
+    ktex_encode(TEXTURE_FORMAT_BC3, pixels, width, height, blocks);
+    ktex_decode(TEXTURE_FORMAT_BC3, blocks, width, height, decoded);
+    b8 alpha_close = max_error(pixels, decoded, width * height, 3, 1) <= 8;
+    solid_close = max_error(pixels, decoded, width * height, 0, 3) <= 4;
+    expect_to_be_true(alpha_close);
+    expect_to_be_true(solid_close);
+    return True;
+}
+
+/**
+ * @brief Tests that cooking picks BC1 for opaque images and BC3 for transparent ones, and fills
+ * in every level of the mip chain.
+ */
+u8 ktex_cook_should_build_mip_chain() {
+    const u32 width = 16;
+    const u32 height = 8;
+    u8 pixels[16 * 8 * 4];
+    fill_gradient(pixels, width, height);
+
+    // 16x8, 8x4, 4x2, 2x1 and 1x1, each at least one 8-byte block.
+    expect_should_be(5, ktex_mip_count(width, height));
+    void* cooked = 0;
+    u64 cooked_size = 0;
+    expect_to_be_true(ktex_cook(pixels, width, height, True, &cooked, &cooked_size));
+    expect_should_be(sizeof(ktex_header) + 104, cooked_size);
+
+    image_resource_data image;
+    expect_to_be_true(ktex_parse(cooked, cooked_size, &image));
+    expect_should_be(TEXTURE_FORMAT_BC1, image.format);
+    expect_should_be(width, image.width);
+    expect_should_be(height, image.height);
+    expect_should_be(5, image.mip_count);
+    expect_should_be(104, image.size);
+    expect_to_be_false(image.has_transparency);
+    kfree(cooked, cooked_size, MEMORY_TAG_ARRAY);
+
+    // A single translucent pixel needs BC3.
+    pixels[3] = 128;
+    expect_to_be_true(ktex_cook(pixels, width, height, True, &cooked, &cooked_size));
+    expect_to_be_true(ktex_parse(cooked, cooked_size, &image));
+    expect_should_be(TEXTURE_FORMAT_BC3, image.format);
+    expect_to_be_true(image.has_transparency);
+    kfree(cooked, cooked_size, MEMORY_TAG_ARRAY);
+
+    // Uncompressed, the levels are exactly the box-filtered image.
+    u8 odd[5 * 3 * 4];
+    for (u32 i = 0; i < 5 * 3; ++i) {
+        odd[i * 4 + 0] = (u8)(i * 10);
+        odd[i * 4 + 1] = 40;
+        odd[i * 4 + 2] = 80;
+        odd[i * 4 + 3] = 255;
+    }
+    expect_to_be_true(ktex_cook(odd, 5, 3, False, &cooked, &cooked_size));
+    expect_to_be_true(ktex_parse(cooked, cooked_size, &image));
+    expect_should_be(TEXTURE_FORMAT_RGBA8, image.format);
+    expect_should_be(3, image.mip_count);
+
+    u8 level1[2 * 1 * 4];
+    ktex_downsample(odd, 5, 3, level1);
+    // Pixels 0, 1, 5 and 6 of the first level.
+    expect_should_be(30, level1[0]);
+    const u8* cooked_level1 = image.pixels + 5 * 3 * 4;
+    b8 level1_matches = max_error(level1, cooked_level1, 2, 0, 4) == 0;
+    expect_to_be_true(level1_matches);
+    expect_should_be(40, image.pixels[image.size - 3]);
+    kfree(cooked, cooked_size, MEMORY_TAG_ARRAY);
+    return True;
+}
+
+/**
+ * @brief Tests that a built mip chain is each level box-filtered from the last, for images wide
+ * enough to use the vector path and odd enough to need the scalar tail.
+ */
+u8 ktex_build_mip_chain_should_match_box_filter() {
+    const u32 width = 37;
+    const u32 height = 5;
+    u8 pixels[37 * 5 * 4];
+    for (u32 i = 0; i < width * height * 4; ++i) {
+        // Neighbours differ enough that a rounding slip in any lane would show.
+        pixels[i] = (u8)(i * 37 + (i >> 3) * 11);
+    }
+
+    // 37x5, 18x2, 9x1, 4x1, 2x1 and 1x1.
+    u32 mip_count = ktex_mip_count(width, height);
+    expect_should_be(6, mip_count);
+    u64 chain_size = ktex_data_size(TEXTURE_FORMAT_RGBA8, width, height, mip_count);
+    u8* chain = kallocate(chain_size, MEMORY_TAG_ARRAY);
+    expect_to_be_true(ktex_build_mip_chain(pixels, width, height, chain));
+
+    b8 level0_matches = max_error(pixels, chain, width * height, 0, 4) == 0;
+    expect_to_be_true(level0_matches);
+
+    // Check every level against a plain per-pixel filter of the one before.
+    const u8* previous = chain;
+    u32 level_width = width;
+    u32 level_height = height;
+    b8 levels_match = True;
+    for (u32 level = 1; level < mip_count; ++level) {
+        u32 next_width = KMAX(level_width / 2, 1);
+        u32 next_height = KMAX(level_height / 2, 1);
+        const u8* current = previous + level_width * level_height * 4;
+        for (u32 y = 0; y < next_height; ++y) {
+            for (u32 x = 0; x < next_width; ++x) {
+                u32 x0 = KMIN(x * 2, level_width - 1);
+                u32 x1 = KMIN(x * 2 + 1, level_width - 1);
+                u32 y0 = KMIN(y * 2, level_height - 1);
+                u32 y1 = KMIN(y * 2 + 1, level_height - 1);
+                for (u32 c = 0; c < 4; ++c) {
+                    u32 sum = previous[(y0 * level_width + x0) * 4 + c] + previous[(y0 * level_width + x1) * 4 + c] +
+                              previous[(y1 * level_width + x0) * 4 + c] + previous[(y1 * level_width + x1) * 4 + c];
+                    levels_match = levels_match && current[(y * next_width + x) * 4 + c] == (u8)((sum + 2) >> 2);
+                }
+            }
+        }
+        previous = current;
+        level_width = next_width;
+        level_height = next_height;
+    }
+    expect_to_be_true(levels_match);
+
+    kfree(chain, chain_size, MEMORY_TAG_ARRAY);
+    return True;
+}
+
+/**
+ * @brief Tests that cooked textures which are truncated or inconsistent are not parsed.
+ */
+u8 ktex_parse_should_reject_invalid_data() {
+    u8 pixels[16 * 8 * 4];
+    fill_gradient(pixels, 16, 8);
+    void* cooked = 0;
+    u64 cooked_size = 0;
+    expect_to_be_true(ktex_cook(pixels, 16, 8, True, &cooked, &cooked_size));
+    ktex_header* header = cooked;
+    image_resource_data image;
+
+    expect_to_be_false(ktex_parse(cooked, cooked_size - 1, &image));
+    expect_to_be_false(ktex_parse(cooked, sizeof(ktex_header) - 1, &image));
+
+    header->magic = KPAK_MAGIC;
+    expect_to_be_false(ktex_parse(cooked, cooked_size, &image));
+    header->magic = KTEX_MAGIC;
+
+    // More levels than a 16x8 image has.
+    header->mip_count = 6;
+    expect_to_be_false(ktex_parse(cooked, cooked_size, &image));
+    header->mip_count = 5;
+
+    header->format = TEXTURE_FORMAT_COUNT;
+    expect_to_be_false(ktex_parse(cooked, cooked_size, &image));
+    header->format = TEXTURE_FORMAT_BC1;
+
+    header->data_size--;
+    expect_to_be_false(ktex_parse(cooked, cooked_size, &image));
+    header->data_size++;
+
+    expect_to_be_true(ktex_parse(cooked, cooked_size, &image));
+    kfree(cooked, cooked_size, MEMORY_TAG_ARRAY);
+    return True;
+}
+
+/**
+ * @brief Tests that the image loader uses a cooked texture in place from the archive, and does
+ * not use an invalid one.
+ *
+ * The base path does not exist, so there are no source PNGs to fall back to.
+ */
+u8 ktex_image_loader_should_prefer_cooked_textures() {
+    u8 pixels[16 * 8 * 4];
+    fill_gradient(pixels, 16, 8);
+    void* cooked = 0;
+    u64 cooked_size = 0;
+    expect_to_be_true(ktex_cook(pixels, 16, 8, True, &cooked, &cooked_size));
+
+    u8 junk[64];
+    kset_memory(junk, 0xAB, sizeof(junk));
+
+    kpak_source sources[2];
+    sources[0] = (kpak_source){"textures/cooked.ktex", cooked, cooked_size, False};
+    sources[1] = (kpak_source){"textures/broken.ktex", junk, sizeof(junk), False};
+    expect_to_be_true(kpak_write(KTEX_TEST_PATH, 2, sources));
+    kfree(cooked, cooked_size, MEMORY_TAG_ARRAY);
+
+    resource_system_config config;
+    config.max_loader_count = 32;
+    config.asset_base_path = "missing_assets";
+    config.max_async_load_count = 8;
+    config.archive_path = KTEX_TEST_PATH;
+    config.watch_for_changes = False;
+
+    u64 size = 0;
+    resource_system_initialize(&size, 0, config);
+    void* state = kallocate(size, MEMORY_TAG_APPLICATION);
+    expect_to_be_true(resource_system_initialize(&size, state, config));
+
+    resource image;
+    expect_to_be_true(resource_system_load("cooked", RESOURCE_TYPE_IMAGE, &image));
+    image_resource_data* data = image.data;
+    expect_should_be(TEXTURE_FORMAT_BC1, data->format);
+    expect_should_be(5, data->mip_count);
+    expect_should_be(16, data->width);
+    expect_to_be_false(data->has_transparency);
+    // Stored in the archive, so the blocks are used where they lie.
+    expect_to_be_true(resource_system_is_packed(data->pixels));
+    resource_system_unload(&image);
+
+    expect_to_be_false(resource_system_load("broken", RESOURCE_TYPE_IMAGE, &image));
+
+    resource_system_shutdown(state);
+    kfree(state, size, MEMORY_TAG_APPLICATION);
+    remove(KTEX_TEST_PATH);
+    return True;
+}
+
+void ktex_register_tests() {
+    test_manager_register_test(ktex_codec_should_round_trip_blocks, "Ktex codec should round-trip BC1 and BC3 blocks");
+    test_manager_register_test(ktex_cook_should_build_mip_chain, "Ktex cook should pick a format and build a mip chain");
+    test_manager_register_test(ktex_build_mip_chain_should_match_box_filter, "Ktex mip chain should match the box filter");
+    test_manager_register_test(ktex_parse_should_reject_invalid_data, "Ktex parse should reject invalid data");
+    test_manager_register_test(ktex_image_loader_should_prefer_cooked_textures, "Ktex image loader should prefer cooked textures");
+}
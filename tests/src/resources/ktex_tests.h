@@ -0,0 +1,16 @@
+#pragma once
+
+/**
+ * @file ktex_tests.h
+ * @brief Unit tests for the cooked texture container.
+ *
+ * Contains function declarations for various cooked texture tests.
+ * All tests are registered via `ktex_register_tests()`.
+ */
+
+/**
+ * @brief Registers all cooked texture tests with the test manager.
+ *
+ * Should be called before `test_manager_run_tests()` in main().
+ */
+void ktex_register_tests();
@@ -0,0 +1,331 @@
+#include "bvh_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <core/kmemory.h>
+#include <core/clock.h>
+#include <core/logger.h>
+#include <math/kmath.h>
+#include <renderer/render_cull.h>
+#include <scene/bvh.h>
+
+/**
+ * @file bvh_tests.c
+ * @brief Unit tests for the bounding volume hierarchy.
+ *
+ * These tests validate core functionality of `bvh` including:
+ * - Frustum, overlap and ray queries finding exactly what testing every box finds
+ * - Refitting after proxies move, and rebuilding after they are added or removed
+ * - Refusing proxies past the capacity
+ *
+ * A benchmark also logs the time of frustum culling with the hierarchy against testing every
+ * box, at 1k and 10k boxes. Build the tests with -DKBENCHMARK to run it at 10k, 100k and 1M
+ * boxes instead, which takes seconds.
+ *
+ * Uses the custom test manager and assertion macros from `test_manager.h`.
+ */
+
+/** @brief The number of boxes the conformance tests use. */
+#define BVH_TEST_COUNT 2000
+
+/** @brief The number of queries of each kind the conformance tests run. */
+#define BVH_TEST_QUERIES 50
+
+static extents_3d random_box(f32 world_size, f32 max_size) {
+    vec3 center = vec3_create(fkrandom_in_range(-world_size, world_size), fkrandom_in_range(-world_size, world_size), fkrandom_in_range(-world_size, world_size));
+    vec3 half = vec3_create(fkrandom_in_range(0.1f, max_size), fkrandom_in_range(0.1f, max_size), fkrandom_in_range(0.1f, max_size));
+    extents_3d box;
+    box.min = vec3_sub(center, half);
+    box.max = vec3_add(center, half);
+    return box;
+}
+
+/** @brief A frustum at a random position, looking in a random direction. */
+static frustum random_frustum(f32 world_size, f32 far_clip) {
+    vec3 position = vec3_create(fkrandom_in_range(-world_size, world_size), fkrandom_in_range(-world_size, world_size), fkrandom_in_range(-world_size, world_size));
+    vec3 target = vec3_add(position, vec3_create(fkrandom_in_range(-1.0f, 1.0f), fkrandom_in_range(-0.5f, 0.5f), fkrandom_in_range(-1.0f, 1.0f)));
+    mat4 view = mat4_look_at(position, target, vec3_up());
+    mat4 projection = mat4_perspective(deg_to_rad(60.0f), 16.0f / 9.0f, 0.1f, far_clip);
+    return render_cull_frustum_create(mat4_mul(view, projection));
+}
+
+/** @brief Whether a box may be inside a frustum, tested the same way as the hierarchy does. */
+static b8 box_in_frustum(const frustum* f, extents_3d box) {
+    vec3 center = vec3_mul_scalar(vec3_add(box.min, box.max), 0.5f);
+    vec3 half = vec3_mul_scalar(vec3_sub(box.max, box.min), 0.5f);
+    for (u32 p = 0; p < 6; ++p) {
+        vec4 plane = f->planes[p];
+        f32 distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+        f32 reach = kabs(plane.x) * half.x + kabs(plane.y) * half.y + kabs(plane.z) * half.z;
+        if (distance + reach < 0.0f) {
+            return False;
+        }
+    }
+    return True;
+}
+
+static b8 boxes_overlap(extents_3d a, extents_3d b) {
+    return a.min.x <= b.max.x && a.max.x >= b.min.x &&
+           a.min.y <= b.max.y && a.max.y >= b.min.y &&
+           a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+/** @brief The distance at which a ray enters a box, or K_INFINITY if it misses. */
+static f32 ray_enter(ray r, extents_3d box, f32 max_distance) {
+    f32 near = 0.0f;
+    f32 far = max_distance;
+    for (u32 axis = 0; axis < 3; ++axis) {
+        f32 d = r.direction.elements[axis];
+        f32 inverse = d != 0.0f ? 1.0f / d : K_INFINITY;
+        f32 t_0 = (box.min.elements[axis] - r.origin.elements[axis]) * inverse;
+        f32 t_1 = (box.max.elements[axis] - r.origin.elements[axis]) * inverse;
+        near = KMAX(near, KMIN(t_0, t_1));
+        far = KMIN(far, KMAX(t_0, t_1));
+    }
+    return near <= far ? near : K_INFINITY;
+}
+
+/**
+ * @brief Checks that a query's results are exactly the live boxes expected, each once.
+ * user data is the index of each box.
+ */
+static b8 results_match(const u32* results, u32 result_count, const b8* expected, const b8* live, u32 count, u8* seen) {
+    kzero_memory(seen, count);
+    for (u32 i = 0; i < result_count; ++i) {
+        expect_to_be_true(results[i] < count);
+        expect_should_be(0, seen[results[i]]);
+        seen[results[i]] = 1;
+    }
+    for (u32 i = 0; i < count; ++i) {
+        b8 want = live[i] && expected[i];
+        expect_should_be(want, seen[i]);
+    }
+    return True;
+}
+
+/** @brief Runs every kind of query against the hierarchy and against every live box. */
+static b8 queries_match_brute_force(const bvh* tree, const extents_3d* boxes, const b8* live, u32 count) {
+    u32* results = kallocate(sizeof(u32) * count, MEMORY_TAG_ARRAY);
+    b8* expected = kallocate(sizeof(b8) * count, MEMORY_TAG_ARRAY);
+    u8* seen = kallocate(count, MEMORY_TAG_ARRAY);
+
+    for (u32 q = 0; q < BVH_TEST_QUERIES; ++q) {
+        frustum f = random_frustum(100.0f, 80.0f);
+        for (u32 i = 0; i < count; ++i) {
+            expected[i] = box_in_frustum(&f, boxes[i]);
+        }
+        u32 result_count = bvh_query_frustum(tree, &f, results, count);
+        expect_to_be_true(results_match(results, result_count, expected, live, count, seen));
+
+        extents_3d area = random_box(100.0f, 30.0f);
+        for (u32 i = 0; i < count; ++i) {
+            expected[i] = boxes_overlap(boxes[i], area);
+        }
+        result_count = bvh_query_overlap(tree, area, results, count);
+        expect_to_be_true(results_match(results, result_count, expected, live, count, seen));
+
+        ray r;
+        r.origin = vec3_create(fkrandom_in_range(-120.0f, 120.0f), fkrandom_in_range(-120.0f, 120.0f), fkrandom_in_range(-120.0f, 120.0f));
+        r.direction = vec3_normalized(vec3_create(fkrandom_in_range(-1.0f, 1.0f), fkrandom_in_range(-1.0f, 1.0f), fkrandom_in_range(-1.0f, 1.0f)));
+        f32 nearest = K_INFINITY;
+        for (u32 i = 0; i < count; ++i) {
+            if (live[i]) {
+                nearest = KMIN(nearest, ray_enter(r, boxes[i], 500.0f));
+            }
+        }
+        bvh_hit hit;
+        b8 was_hit = bvh_raycast(tree, r, 500.0f, &hit);
+        b8 should_hit = nearest != K_INFINITY;
+        expect_should_be(should_hit, was_hit);
+        if (was_hit) {
+            expect_float_to_be(nearest, hit.distance);
+            expect_float_to_be(nearest, ray_enter(r, boxes[hit.user_data], 500.0f));
+        }
+    }
+
+    kfree(results, sizeof(u32) * count, MEMORY_TAG_ARRAY);
+    kfree(expected, sizeof(b8) * count, MEMORY_TAG_ARRAY);
+    kfree(seen, count, MEMORY_TAG_ARRAY);
+    return True;
+}
+
+/**
+ * @brief Tests that frustum, overlap and ray queries find exactly what testing every box finds,
+ * after the build, after boxes move, and after boxes are removed and added.
+ */
+u8 bvh_queries_should_match_brute_force() {
+    bvh tree;
+    expect_to_be_true(bvh_create(BVH_TEST_COUNT, &tree));
+
+    extents_3d boxes[BVH_TEST_COUNT];
+    b8 live[BVH_TEST_COUNT];
+    u32 proxies[BVH_TEST_COUNT];
+    for (u32 i = 0; i < BVH_TEST_COUNT; ++i) {
+        boxes[i] = random_box(100.0f, 3.0f);
+        live[i] = True;
+        proxies[i] = bvh_add(&tree, boxes[i], i);
+        expect_should_not_be(INVALID_ID, proxies[i]);
+    }
+    bvh_update(&tree);
+    expect_to_be_true(queries_match_brute_force(&tree, boxes, live, BVH_TEST_COUNT));
+
+    // Small moves refit the tree.
+    for (u32 i = 0; i < BVH_TEST_COUNT; i += 3) {
+        vec3 offset = vec3_create(fkrandom_in_range(-2.0f, 2.0f), fkrandom_in_range(-2.0f, 2.0f), fkrandom_in_range(-2.0f, 2.0f));
+        boxes[i].min = vec3_add(boxes[i].min, offset);
+        boxes[i].max = vec3_add(boxes[i].max, offset);
+        bvh_move(&tree, proxies[i], boxes[i]);
+    }
+    bvh_update(&tree);
+    expect_to_be_true(queries_match_brute_force(&tree, boxes, live, BVH_TEST_COUNT));
+
+    // Moving everything far away degrades the tree, which is rebuilt.
+    for (u32 i = 0; i < BVH_TEST_COUNT; ++i) {
+        boxes[i] = random_box(100.0f, 3.0f);
+        bvh_move(&tree, proxies[i], boxes[i]);
+    }
+    bvh_update(&tree);
+    expect_to_be_true(tree.cost <= tree.build_cost * 1.5f);
+    expect_to_be_true(queries_match_brute_force(&tree, boxes, live, BVH_TEST_COUNT));
+
+    // Removed proxies are no longer found, and their ids are reused.
+    for (u32 i = 0; i < BVH_TEST_COUNT; i += 2) {
+        bvh_remove(&tree, proxies[i]);
+        live[i] = False;
+    }
+    bvh_update(&tree);
+    expect_should_be(BVH_TEST_COUNT / 2, tree.proxy_count);
+    expect_to_be_true(queries_match_brute_force(&tree, boxes, live, BVH_TEST_COUNT));
+
+    boxes[0] = random_box(100.0f, 3.0f);
+    live[0] = True;
+    proxies[0] = bvh_add(&tree, boxes[0], 0);
+    expect_should_be(proxies[BVH_TEST_COUNT - 2], proxies[0]);
+    bvh_update(&tree);
+    expect_to_be_true(queries_match_brute_force(&tree, boxes, live, BVH_TEST_COUNT));
+
+    bvh_destroy(&tree);
+    return True;
+}
+
+/**
+ * @brief Tests the edge cases: an empty tree, a full tree, a single proxy, and boxes that all
+ * share a centre.
+ */
+u8 bvh_should_handle_edge_cases() {
+    bvh tree;
+    expect_to_be_false(bvh_create(0, &tree));
+    expect_to_be_true(bvh_create(64, &tree));
+
+    u32 results[64];
+    frustum f = random_frustum(1.0f, 100.0f);
+    extents_3d everything = {{{{-1000.0f, -1000.0f, -1000.0f}}}, {{{1000.0f, 1000.0f, 1000.0f}}}};
+    ray r = {vec3_create(0.0f, 0.0f, -10.0f), vec3_create(0.0f, 0.0f, 1.0f)};
+    bvh_hit hit;
+
+    bvh_update(&tree);
+    expect_should_be(0, bvh_query_frustum(&tree, &f, results, 64));
+    expect_should_be(0, bvh_query_overlap(&tree, everything, results, 64));
+    expect_to_be_false(bvh_raycast(&tree, r, 100.0f, &hit));
+
+    // One box at the origin.
+    extents_3d unit = {{{{-1.0f, -1.0f, -1.0f}}}, {{{1.0f, 1.0f, 1.0f}}}};
+    u32 first = bvh_add(&tree, unit, 7);
+    bvh_update(&tree);
+    expect_should_be(1, bvh_query_overlap(&tree, everything, results, 64));
+    expect_should_be(7, results[0]);
+    expect_to_be_true(bvh_raycast(&tree, r, 100.0f, &hit));
+    expect_should_be(first, hit.proxy);
+    expect_float_to_be(9.0f, hit.distance);
+    // Out of reach.
+    expect_to_be_false(bvh_raycast(&tree, r, 5.0f, &hit));
+
+    // Many boxes around the same centre, which cannot be split by position.
+    for (u32 i = 1; i < 64; ++i) {
+        extents_3d box = unit;
+        box.max.x += (f32)i;
+        box.min.x -= (f32)i;
+        expect_should_not_be(INVALID_ID, bvh_add(&tree, box, 7 + i));
+    }
+    expect_should_be(INVALID_ID, bvh_add(&tree, unit, 0));
+    bvh_update(&tree);
+    expect_should_be(64, bvh_query_overlap(&tree, everything, results, 64));
+    // Queries stop once the results are full.
+    expect_should_be(10, bvh_query_overlap(&tree, everything, results, 10));
+
+    bvh_destroy(&tree);
+    return True;
+}
+
+/**
+ * @brief Times one frustum query each way over the given number of boxes, spread over a cube
+ * reaching world_size from the origin on each axis, and logs it.
+ */
+static b8 benchmark_count(u32 count, f32 world_size) {
+    extents_3d* boxes = kallocate(sizeof(extents_3d) * count, MEMORY_TAG_ARRAY);
+    u32* results = kallocate(sizeof(u32) * count, MEMORY_TAG_ARRAY);
+
+    bvh tree;
+    expect_to_be_true(bvh_create(count, &tree));
+    for (u32 i = 0; i < count; ++i) {
+        boxes[i] = random_box(world_size, 1.0f);
+        bvh_add(&tree, boxes[i], i);
+    }
+
+    clock build;
+    clock_start(&build);
+    bvh_update(&tree);
+    clock_update(&build);
+
+    frustum f = random_frustum(0.0f, world_size);
+
+    clock brute;
+    clock_start(&brute);
+    u32 brute_count = 0;
+    for (u32 i = 0; i < count; ++i) {
+        if (box_in_frustum(&f, boxes[i])) {
+            results[brute_count++] = i;
+        }
+    }
+    clock_update(&brute);
+
+    clock hierarchy;
+    clock_start(&hierarchy);
+    u32 bvh_count = bvh_query_frustum(&tree, &f, results, count);
+    clock_update(&hierarchy);
+
+    expect_should_be(brute_count, bvh_count);
+    KINFO("BVH culling of %u boxes (%u visible): %.3fms brute force, %.3fms with the BVH (%.1fx). Built in %.2fms.",
+          count, bvh_count, brute.elapsed * 1000.0, hierarchy.elapsed * 1000.0,
+          hierarchy.elapsed > 0.0 ? brute.elapsed / hierarchy.elapsed : 0.0, build.elapsed * 1000.0);
+
+    bvh_destroy(&tree);
+    kfree(results, sizeof(u32) * count, MEMORY_TAG_ARRAY);
+    kfree(boxes, sizeof(extents_3d) * count, MEMORY_TAG_ARRAY);
+    return True;
+}
+
+/**
+ * @brief Times frustum culling with the hierarchy against testing every box. Always passes
+ * unless the two disagree, as timings vary by machine; the results are logged instead.
+ */
+u8 bvh_culling_benchmark() {
+    // The world grows with the cube root of the count, so the boxes are equally dense in each.
+#ifdef KBENCHMARK
+    expect_to_be_true(benchmark_count(10000, 108.0f));
+    expect_to_be_true(benchmark_count(100000, 232.0f));
+    expect_to_be_true(benchmark_count(1000000, 500.0f));
+#else
+    // Large counts take seconds, so they are opt-in.
+    expect_to_be_true(benchmark_count(1000, 50.0f));
+    expect_to_be_true(benchmark_count(10000, 108.0f));
+#endif
+    return True;
+}
+
+void bvh_register_tests() {
+    test_manager_register_test(bvh_queries_should_match_brute_force, "BVH queries should match testing every box");
+    test_manager_register_test(bvh_should_handle_edge_cases, "BVH should handle empty, full and degenerate trees");
+    test_manager_register_test(bvh_culling_benchmark, "BVH culling benchmark against brute force");
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+/**
+ * @file bvh_tests.h
+ * @brief Unit tests for the bounding volume hierarchy.
+ *
+ * Contains function declarations for various bvh tests.
+ * All tests are registered via `bvh_register_tests()`.
+ */
+
+/**
+ * @brief Registers all bvh tests with the test manager.
+ *
+ * Should be called before `test_manager_run_tests()` in main().
+ */
+void bvh_register_tests();
@@ -0,0 +1,198 @@
+#include "job_system_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+#include "../test_utils.h"
+
+#include <defines.h>
+#include <core/kmemory.h>
+#include <core/clock.h>
+#include <systems/job_system.h>
+
+/**
+ * @file job_system_tests.c
+ * @brief Unit tests for the job system.
+ *
+ * These tests validate core functionality of the job system including:
+ * - Running every submitted job exactly once across worker threads
+ * - Holding jobs back until their dependency counter reaches zero
+ * - Submitting jobs from within running jobs (stolen by other workers)
+ *
+ * Each test starts and stops its own job system instance.
+ */
+
+/** @brief Parameters passed to the counting jobs. */
+typedef struct count_job_params {
+    /** Counter shared by all jobs. */
+    _Atomic u32* sum;
+    /** Value each job adds to the sum. */
+    u32 amount;
+} count_job_params;
+
+/** @brief Adds the given amount to the shared sum. */
+static b8 count_job(void* param_data) {
+    count_job_params* params = param_data;
+    atomic_fetch_add(params->sum, params->amount);
+    return True;
+}
+
+/**
+ * @brief Tests that every submitted job runs exactly once, including when more jobs are
+ * submitted than there are job slots.
+ *
+ * Verifies:
+ * - The counter reaches zero once all jobs are done
+ * - The shared sum matches the sum of all job amounts
+ */
+u8 job_system_should_run_all_jobs() {
+    void* state;
+    u64 size;
+    expect_to_be_true(test_start_job_system(4, 256, &state, &size));
+    expect_to_be_true(job_system_worker_count() >= 1);
+
+    _Atomic u32 sum = 0;
+    job_counter counter = {0};
+    const u32 job_count = 200;
+    u32 expected = 0;
+    for (u32 i = 0; i < job_count; ++i) {
+        count_job_params params = {&sum, i};
+        job_info job = job_create_priority(count_job, &params, sizeof(count_job_params), (job_priority)(i % JOB_PRIORITY_COUNT));
+        job.counter = &counter;
+        expect_to_be_true(job_system_submit(job));
+        expected += i;
+    }
+
+    job_counter_wait(&counter);
+    expect_to_be_true(job_counter_is_done(&counter));
+    expect_should_be(expected, atomic_load(&sum));
+
+    test_stop_job_system(state, size);
+    return True;
+}
+
+/** @brief Parameters passed to the dependency test jobs. */
+typedef struct ordered_job_params {
+    /** Number of first-stage jobs that have finished. */
+    _Atomic u32* finished;
+    /** Set to the finished count observed by the second-stage job. */
+    _Atomic u32* observed;
+} ordered_job_params;
+
+/** @brief First stage: spins briefly so that the second stage would overtake it without a dependency. */
+static b8 first_stage_job(void* param_data) {
+    ordered_job_params* params = param_data;
+    clock c;
+    clock_start(&c);
+    do {
+        clock_update(&c);
+    } while (c.elapsed < 0.002);
+    atomic_fetch_add(params->finished, 1);
+    return True;
+}
+
+/** @brief Second stage: records how many first-stage jobs had finished when it started. */
+static b8 second_stage_job(void* param_data) {
+    ordered_job_params* params = param_data;
+    atomic_store(params->observed, atomic_load(params->finished));
+    return True;
+}
+
+/**
+ * @brief Tests that a job with a dependency does not start until the dependency counter reaches zero.
+ *
+ * Verifies:
+ * - The dependent job observes every first-stage job as finished
+ */
+u8 job_system_should_respect_dependencies() {
+    void* state;
+    u64 size;
+    expect_to_be_true(test_start_job_system(4, 64, &state, &size));
+
+    _Atomic u32 finished = 0;
+    _Atomic u32 observed = 0;
+    ordered_job_params params = {&finished, &observed};
+
+    job_counter first_stage = {0};
+    job_counter second_stage = {0};
+
+    // The first stage is counted in as each job is submitted, so the dependent job is parked
+    // until all of them are done, even though it has a higher priority.
+    const u32 first_stage_count = 8;
+    for (u32 i = 0; i < first_stage_count; ++i) {
+        job_info first = job_create_priority(first_stage_job, &params, sizeof(ordered_job_params), JOB_PRIORITY_LOW);
+        first.counter = &first_stage;
+        expect_to_be_true(job_system_submit(first));
+    }
+
+    job_info second = job_create_priority(second_stage_job, &params, sizeof(ordered_job_params), JOB_PRIORITY_HIGH);
+    second.dependency = &first_stage;
+    second.counter = &second_stage;
+    expect_to_be_true(job_system_submit(second));
+
+    job_counter_wait(&first_stage);
+    job_counter_wait(&second_stage);
+    expect_should_be(first_stage_count, atomic_load(&observed));
+
+    test_stop_job_system(state, size);
+    return True;
+}
+
+/** @brief Parameters passed to the fan-out job. */
+typedef struct fan_out_job_params {
+    /** Counter shared by the child jobs. */
+    _Atomic u32* sum;
+    /** Counter the child jobs report to. */
+    job_counter* children;
+    /** Number of child jobs to submit. */
+    u32 child_count;
+} fan_out_job_params;
+
+/** @brief Submits child jobs from a worker thread, leaving them on that worker's deque to be stolen. */
+static b8 fan_out_job(void* param_data) {
+    fan_out_job_params* params = param_data;
+    for (u32 i = 0; i < params->child_count; ++i) {
+        count_job_params child_params = {params->sum, 1};
+        job_info child = job_create(count_job, &child_params, sizeof(count_job_params));
+        child.counter = params->children;
+        job_system_submit(child);
+    }
+    return True;
+}
+
+/**
+ * @brief Tests submitting jobs from within running jobs.
+ *
+ * Verifies:
+ * - All child jobs run, whether popped by their owner or stolen by another thread
+ */
+u8 job_system_should_run_nested_jobs() {
+    void* state;
+    u64 size;
+    expect_to_be_true(test_start_job_system(4, 512, &state, &size));
+
+    _Atomic u32 sum = 0;
+    job_counter parents = {0};
+    job_counter children = {0};
+
+    const u32 parent_count = 4;
+    const u32 child_count = 64;
+    for (u32 i = 0; i < parent_count; ++i) {
+        fan_out_job_params params = {&sum, &children, child_count};
+        job_info parent = job_create(fan_out_job, &params, sizeof(fan_out_job_params));
+        parent.counter = &parents;
+        expect_to_be_true(job_system_submit(parent));
+    }
+
+    // Children are counted in by their parents, so wait for the parents first.
+    job_counter_wait(&parents);
+    job_counter_wait(&children);
+    expect_should_be(parent_count * child_count, atomic_load(&sum));
+
+    test_stop_job_system(state, size);
+    return True;
+}
+
+void job_system_register_tests() {
+    test_manager_register_test(job_system_should_run_all_jobs, "Job system should run every submitted job once.");
+    test_manager_register_test(job_system_should_respect_dependencies, "Job system should hold jobs until their dependency is done.");
+    test_manager_register_test(job_system_should_run_nested_jobs, "Job system should run jobs submitted from other jobs.");
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+/**
+ * @file job_system_tests.h
+ * @brief Unit tests for the job system.
+ *
+ * All tests are registered via `job_system_register_tests()`.
+ */
+
+/**
+ * @brief Registers all job system tests with the test manager.
+ *
+ * Should be called before `test_manager_run_tests()` in main().
+ */
+void job_system_register_tests();
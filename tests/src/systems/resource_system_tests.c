@@ -0,0 +1,380 @@
+#include "resource_system_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+#include "../test_utils.h"
+
+#include <defines.h>
+#include <core/kmemory.h>
+#include <core/kstring.h>
+#include <core/kthread.h>
+#include <platform/platform.h>
+#include <systems/job_system.h>
+#include <systems/resource_system.h>
+
+#include <platform/filesystem.h>
+
+#include <stdatomic.h>
+#include <stdio.h>
+
+#if KPLATFORM_LINUX
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @file resource_system_tests.c
+ * @brief Unit tests for the resource system.
+ *
+ * These tests validate asynchronous loading including:
+ * - Callbacks running only from `resource_system_update()`, on the main thread
+ * - Concurrent requests for the same resource sharing a single load
+ * - Failed loads reporting no resource, and successful ones being unloaded after their callbacks
+ * - Changed asset files being reported once they settle, by resource name and type
+ * - Loaders being initialized on registration, and left unregistered if that fails
+ *
+ * Loads go through a test loader registered for static meshes, which has no built-in loader.
+ */
+
+/** @brief The number of distinct resources the threaded test loads. */
+#define RESOURCE_TEST_NAME_COUNT 50
+
+/** @brief The number of times the test loader has loaded a resource. */
+static _Atomic u32 load_count;
+
+/** @brief The number of times the test loader has unloaded a resource. */
+static _Atomic u32 unload_count;
+
+/** @brief The data every successful test load returns. */
+static u32 test_data = 42;
+
+/** @brief Loads every resource except "missing". */
+static b8 test_loader_load(struct resource_loader* self, const char* name, resource* out_resource) {
+    atomic_fetch_add(&load_count, 1);
+    if (strings_equal(name, "missing")) {
+        return False;
+    }
+    out_resource->name = name;
+    out_resource->full_path = 0;
+    out_resource->data = &test_data;
+    out_resource->data_size = sizeof(u32);
+    return True;
+}
+
+static void test_loader_unload(struct resource_loader* self, resource* resource) {
+    atomic_fetch_add(&unload_count, 1);
+    resource->data = 0;
+}
+
+/** @brief What the test callbacks have seen. */
+typedef struct load_results {
+    /** The number of callbacks with a resource. */
+    u32 loaded;
+    /** The number of callbacks without a resource. */
+    u32 failed;
+    /** The number of callbacks that ran off the main thread. */
+    u32 wrong_thread;
+    /** The id of the main thread. */
+    u64 main_thread;
+} load_results;
+
+static void on_loaded(const char* name, const resource* r, void* listener) {
+    load_results* results = listener;
+    if (kthread_get_id() != results->main_thread) {
+        results->wrong_thread++;
+    }
+    if (r && r->data && *(u32*)r->data == test_data) {
+        results->loaded++;
+    } else {
+        results->failed++;
+    }
+}
+
+/** @brief Requests the same resource again from its own callback. */
+static void on_loaded_request_again(const char* name, const resource* r, void* listener) {
+    on_loaded(name, r, listener);
+    resource_system_load_async(name, RESOURCE_TYPE_STATIC_MESH, on_loaded, listener);
+}
+
+/** @brief The number of times the counted loader has been shut down. */
+static u32 shutdown_count;
+
+static b8 failing_loader_initialize(struct resource_loader* self) {
+    return False;
+}
+
+static b8 counted_loader_initialize(struct resource_loader* self) {
+    return True;
+}
+
+static void counted_loader_shutdown(struct resource_loader* self) {
+    shutdown_count++;
+}
+
+/** @brief Starts a resource system with the test loader, storing the state block in out_state. */
+static b8 start_resource_system(void** out_state, u64* out_size) {
+    resource_system_config config;
+    config.max_loader_count = 32;
+    config.asset_base_path = "../assets";
+    config.max_async_load_count = 64;
+    config.archive_path = 0;
+    config.watch_for_changes = False;
+
+    resource_system_initialize(out_size, 0, config);
+    *out_state = kallocate(*out_size, MEMORY_TAG_APPLICATION);
+    if (!resource_system_initialize(out_size, *out_state, config)) {
+        return False;
+    }
+
+    resource_loader loader;
+    kzero_memory(&loader, sizeof(resource_loader));
+    loader.type = RESOURCE_TYPE_STATIC_MESH;
+    loader.load = test_loader_load;
+    loader.unload = test_loader_unload;
+    loader.type_path = "";
+
+    atomic_store(&load_count, 0);
+    atomic_store(&unload_count, 0);
+    return resource_system_register_loader(loader);
+}
+
+/** @brief Stops the resource system started with start_resource_system(). */
+static void stop_resource_system(void* state, u64 size) {
+    resource_system_shutdown(state);
+    kfree(state, size, MEMORY_TAG_APPLICATION);
+}
+
+/**
+ * @brief Tests that asynchronous loads only call back from `resource_system_update()`, and that
+ * requests for the same resource share one load.
+ *
+ * Runs without a job system, so every load happens as it is requested.
+ */
+u8 resource_async_loads_should_complete_on_update() {
+    void* state = 0;
+    u64 size = 0;
+    expect_to_be_true(start_resource_system(&state, &size));
+
+    load_results results;
+    kzero_memory(&results, sizeof(load_results));
+    results.main_thread = kthread_get_id();
+
+    expect_to_be_true(resource_system_load_async("first", RESOURCE_TYPE_STATIC_MESH, on_loaded, &results));
+    expect_to_be_true(resource_system_load_async("first", RESOURCE_TYPE_STATIC_MESH, on_loaded, &results));
+    expect_to_be_true(resource_system_load_async("missing", RESOURCE_TYPE_STATIC_MESH, on_loaded, &results));
+
+    // Custom types are only loaded synchronously.
+    expect_to_be_false(resource_system_load_async("first", RESOURCE_TYPE_CUSTOM, on_loaded, &results));
+
+    // Loaded, but not yet delivered.
+    expect_should_be(2, atomic_load(&load_count));
+    expect_should_be(0, results.loaded + results.failed);
+
+    resource_system_update();
+    expect_should_be(2, results.loaded);
+    expect_should_be(1, results.failed);
+    expect_should_be(1, atomic_load(&unload_count));
+
+    // Nothing is delivered twice.
+    resource_system_update();
+    expect_should_be(3, results.loaded + results.failed);
+
+    // Requesting the resource again from its own callback starts a new load.
+    expect_to_be_true(resource_system_load_async("second", RESOURCE_TYPE_STATIC_MESH, on_loaded_request_again, &results));
+    resource_system_update();
+    resource_system_update();
+    expect_should_be(4, atomic_load(&load_count));
+    expect_should_be(4, results.loaded);
+    expect_should_be(3, atomic_load(&unload_count));
+
+    stop_resource_system(state, size);
+    return True;
+}
+
+/**
+ * @brief Tests that loads spread over worker threads are each run once, and delivered on the
+ * main thread.
+ */
+u8 resource_async_loads_should_run_on_workers() {
+    void* job_state = 0;
+    u64 job_size = 0;
+    expect_to_be_true(test_start_job_system(4, 256, &job_state, &job_size));
+
+    void* state = 0;
+    u64 size = 0;
+    expect_to_be_true(start_resource_system(&state, &size));
+
+    load_results results;
+    kzero_memory(&results, sizeof(load_results));
+    results.main_thread = kthread_get_id();
+
+    // Every name twice, so the second request joins the first whether or not it has finished.
+    char names[RESOURCE_TEST_NAME_COUNT][16];
+    for (u32 i = 0; i < RESOURCE_TEST_NAME_COUNT; ++i) {
+        string_format(names[i], "mesh_%u", i);
+        expect_to_be_true(resource_system_load_async(names[i], RESOURCE_TYPE_STATIC_MESH, on_loaded, &results));
+        expect_to_be_true(resource_system_load_async(names[i], RESOURCE_TYPE_STATIC_MESH, on_loaded, &results));
+    }
+
+    // Poll like the frame loop would, with a generous limit in case the machine is busy.
+    for (u32 frame = 0; frame < 5000 && results.loaded < RESOURCE_TEST_NAME_COUNT * 2; ++frame) {
+        resource_system_update();
+        platform_sleep(1);
+    }
+
+    expect_should_be(RESOURCE_TEST_NAME_COUNT * 2, results.loaded);
+    expect_should_be(0, results.failed);
+    expect_should_be(0, results.wrong_thread);
+    expect_should_be(RESOURCE_TEST_NAME_COUNT, atomic_load(&load_count));
+    expect_should_be(RESOURCE_TEST_NAME_COUNT, atomic_load(&unload_count));
+
+    stop_resource_system(state, size);
+    test_stop_job_system(job_state, job_size);
+    return True;
+}
+
+/** @brief The base path the change test watches. */
+#define RESOURCE_WATCH_TEST_DIR "resource_watch_test"
+
+/** @brief What the change listeners have seen. */
+typedef struct change_results {
+    /** The number of changed images. */
+    u32 images;
+    /** The number of changed materials. */
+    u32 materials;
+    /** The name of the last changed resource. */
+    char last_name[64];
+} change_results;
+
+static void on_image_changed(const char* name, void* listener) {
+    change_results* results = listener;
+    results->images++;
+    string_ncopy(results->last_name, name, sizeof(results->last_name) - 1);
+}
+
+static void on_material_changed(const char* name, void* listener) {
+    change_results* results = listener;
+    results->materials++;
+    string_ncopy(results->last_name, name, sizeof(results->last_name) - 1);
+}
+
+/** @brief Updates like the frame loop would until a change is reported, or a generous limit passes. */
+static void update_until_changed(change_results* results) {
+    u32 start = results->images + results->materials;
+    for (u32 frame = 0; frame < 2000 && results->images + results->materials == start; ++frame) {
+        resource_system_update();
+        platform_sleep(1);
+    }
+}
+
+/**
+ * @brief Tests that changed files are reported to the listeners of their type once they stop
+ * being written, and that files outside any type path are not reported.
+ */
+u8 resource_changes_should_settle_before_reporting() {
+#if KPLATFORM_LINUX
+    mkdir(RESOURCE_WATCH_TEST_DIR, 0755);
+    mkdir(RESOURCE_WATCH_TEST_DIR "/textures", 0755);
+    mkdir(RESOURCE_WATCH_TEST_DIR "/materials", 0755);
+
+    resource_system_config config;
+    config.max_loader_count = 32;
+    config.asset_base_path = RESOURCE_WATCH_TEST_DIR;
+    config.max_async_load_count = 8;
+    config.archive_path = 0;
+    config.watch_for_changes = True;
+
+    u64 size = 0;
+    resource_system_initialize(&size, 0, config);
+    void* state = kallocate(size, MEMORY_TAG_APPLICATION);
+    expect_to_be_true(resource_system_initialize(&size, state, config));
+
+    change_results results;
+    kzero_memory(&results, sizeof(change_results));
+    expect_to_be_true(resource_system_register_change_listener(RESOURCE_TYPE_IMAGE, on_image_changed, &results));
+    expect_to_be_true(resource_system_register_change_listener(RESOURCE_TYPE_MATERIAL, on_material_changed, &results));
+
+    // Several writes in quick succession are reported once, after they settle.
+    for (u32 i = 0; i < 3; ++i) {
+        expect_to_be_true(test_write_text(RESOURCE_WATCH_TEST_DIR "/textures/brick.png", "not really a png"));
+    }
+    resource_system_update();
+    expect_should_be(0, results.images);
+
+    update_until_changed(&results);
+    expect_should_be(1, results.images);
+    expect_to_be_true(strings_equal("brick", results.last_name));
+
+    // Files outside the type paths are not resources that can be reloaded.
+    expect_to_be_true(test_write_text(RESOURCE_WATCH_TEST_DIR "/notes.txt", "ignored"));
+
+    // Names below a type path keep their directories.
+    mkdir(RESOURCE_WATCH_TEST_DIR "/materials/walls", 0755);
+    resource_system_update();
+    expect_to_be_true(test_write_text(RESOURCE_WATCH_TEST_DIR "/materials/walls/stone.kmt", "name=stone"));
+    update_until_changed(&results);
+    expect_should_be(1, results.materials);
+    expect_should_be(1, results.images);
+    expect_to_be_true(strings_equal("walls/stone", results.last_name));
+
+    // Unregistered listeners are not called.
+    resource_system_unregister_change_listener(RESOURCE_TYPE_IMAGE, on_image_changed, &results);
+    expect_to_be_true(test_write_text(RESOURCE_WATCH_TEST_DIR "/textures/brick.png", "still not a png"));
+    expect_to_be_true(test_write_text(RESOURCE_WATCH_TEST_DIR "/materials/walls/stone.kmt", "name=stone"));
+    update_until_changed(&results);
+    expect_should_be(1, results.images);
+    expect_should_be(2, results.materials);
+
+    resource_system_shutdown(state);
+    kfree(state, size, MEMORY_TAG_APPLICATION);
+
+    remove(RESOURCE_WATCH_TEST_DIR "/materials/walls/stone.kmt");
+    rmdir(RESOURCE_WATCH_TEST_DIR "/materials/walls");
+    rmdir(RESOURCE_WATCH_TEST_DIR "/materials");
+    remove(RESOURCE_WATCH_TEST_DIR "/textures/brick.png");
+    rmdir(RESOURCE_WATCH_TEST_DIR "/textures");
+    remove(RESOURCE_WATCH_TEST_DIR "/notes.txt");
+    rmdir(RESOURCE_WATCH_TEST_DIR);
+    return True;
+#else
+    // File watching is only implemented with inotify.
+    return BYPASS;
+#endif
+}
+
+/**
+ * @brief Tests that a loader failing to initialize is not registered, and that registered
+ * loaders are shut down with the resource system.
+ */
+u8 resource_loaders_should_initialize_on_registration() {
+    void* state = 0;
+    u64 size = 0;
+    expect_to_be_true(start_resource_system(&state, &size));
+
+    resource_loader loader;
+    kzero_memory(&loader, sizeof(resource_loader));
+    loader.type = RESOURCE_TYPE_CUSTOM;
+    loader.custom_type = "failing";
+    loader.load = test_loader_load;
+    loader.unload = test_loader_unload;
+    loader.type_path = "";
+    loader.initialize = failing_loader_initialize;
+    expect_to_be_false(resource_system_register_loader(loader));
+
+    // Custom loaders share a type, so this only registers if the failed one did not.
+    loader.custom_type = "counted";
+    loader.initialize = counted_loader_initialize;
+    loader.shutdown = counted_loader_shutdown;
+    expect_to_be_true(resource_system_register_loader(loader));
+
+    shutdown_count = 0;
+    stop_resource_system(state, size);
+    expect_should_be(1, shutdown_count);
+    return True;
+}
+
+void resource_system_register_tests() {
+    test_manager_register_test(resource_async_loads_should_complete_on_update, "Resource async loads should complete on update and share requests");
+    test_manager_register_test(resource_async_loads_should_run_on_workers, "Resource async loads should run on workers and call back on the main thread");
+    test_manager_register_test(resource_changes_should_settle_before_reporting, "Resource changes should settle before being reported");
+    test_manager_register_test(resource_loaders_should_initialize_on_registration, "Resource loaders should initialize on registration");
+}
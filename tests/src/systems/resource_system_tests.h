@@ -0,0 +1,16 @@
+#pragma once
+
+/**
+ * @file resource_system_tests.h
+ * @brief Unit tests for the resource system.
+ *
+ * Contains function declarations for various resource system tests.
+ * All tests are registered via `resource_system_register_tests()`.
+ */
+
+/**
+ * @brief Registers all resource system tests with the test manager.
+ *
+ * Should be called before `test_manager_run_tests()` in main().
+ */
+void resource_system_register_tests();
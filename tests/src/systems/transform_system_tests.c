@@ -0,0 +1,291 @@
+#include "transform_system_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+#include "../test_utils.h"
+
+#include <defines.h>
+#include <core/kmemory.h>
+#include <core/clock.h>
+#include <core/logger.h>
+#include <math/kmath.h>
+#include <systems/job_system.h>
+#include <systems/transform_system.h>
+
+/**
+ * @file transform_system_tests.c
+ * @brief Unit tests for the transform system.
+ *
+ * These tests validate core functionality of the transform system including:
+ * - Composing local matrices from scale, rotation and translation, matching the mat4 functions
+ * - Composing world matrices through a hierarchy created out of order
+ * - Only recomputing what changed, and propagating changes to children
+ * - Refusing cycles, and detaching children when their parent is destroyed
+ * - Keeping ids stable while their data is repacked
+ *
+ * A benchmark also logs the time to update 100k transforms, with and without worker threads.
+ * Each test starts and stops its own transform system instance.
+ */
+
+/** @brief The number of transforms the benchmark updates. */
+#define TRANSFORM_BENCHMARK_COUNT 100000
+
+/** @brief The number of updates the benchmark times. */
+#define TRANSFORM_BENCHMARK_ITERATIONS 10
+
+/** @brief Starts a transform system, storing the state block in out_state. */
+static b8 start_transform_system(u32 max_transform_count, void** out_state, u64* out_size) {
+    transform_system_config config;
+    config.max_transform_count = max_transform_count;
+
+    transform_system_initialize(out_size, 0, config);
+    *out_state = kallocate_aligned(*out_size, 16, MEMORY_TAG_TRANSFORM);
+    return transform_system_initialize(out_size, *out_state, config);
+}
+
+/** @brief Stops the transform system started with start_transform_system(). */
+static void stop_transform_system(void* state, u64 size) {
+    transform_system_shutdown(state);
+    kfree_aligned(state, size, 16, MEMORY_TAG_TRANSFORM);
+}
+
+static b8 mat4_matches(mat4 expected, mat4 actual) {
+    for (u32 i = 0; i < 16; ++i) {
+        f32 e = expected.data[i];
+        f32 a = actual.data[i];
+        expect_float_to_be(e, a);
+    }
+    return True;
+}
+
+/** @brief The local matrix of a transform, built with the mat4 functions. */
+static mat4 expected_local(vec3 position, quat rotation, vec3 scale) {
+    return mat4_mul(mat4_mul(mat4_scale(scale), quat_to_mat4(rotation)), mat4_translation(position));
+}
+
+static vec3 random_vec3(f32 min, f32 max) {
+    return vec3_create(fkrandom_in_range(min, max), fkrandom_in_range(min, max), fkrandom_in_range(min, max));
+}
+
+static quat random_rotation() {
+    return quat_from_axis_angle(vec3_normalized(random_vec3(0.1f, 1.0f)), fkrandom_in_range(-K_PI, K_PI), True);
+}
+
+/**
+ * @brief Tests that local matrices are scale, then rotation, then translation.
+ *
+ * Uses a count that is not a multiple of 4, so the last SIMD group is only partly used.
+ */
+u8 transform_local_should_compose_scale_rotation_translation() {
+    void* state;
+    u64 size;
+    expect_to_be_true(start_transform_system(64, &state, &size));
+
+    const u32 count = 37;
+    u32 ids[37];
+    vec3 positions[37];
+    quat rotations[37];
+    vec3 scales[37];
+    for (u32 i = 0; i < count; ++i) {
+        positions[i] = random_vec3(-10.0f, 10.0f);
+        rotations[i] = random_rotation();
+        scales[i] = random_vec3(0.5f, 2.0f);
+        ids[i] = transform_from_position_rotation_scale(positions[i], rotations[i], scales[i]);
+        expect_should_not_be(INVALID_ID, ids[i]);
+    }
+
+    transform_system_update();
+
+    for (u32 i = 0; i < count; ++i) {
+        mat4 expected = expected_local(positions[i], rotations[i], scales[i]);
+        expect_to_be_true(mat4_matches(expected, transform_get_local(ids[i])));
+        // Roots have no parent to follow.
+        expect_to_be_true(mat4_matches(expected, transform_get_world(ids[i])));
+    }
+
+    stop_transform_system(state, size);
+    return True;
+}
+
+/**
+ * @brief Tests that world matrices follow their parents, including when children are created
+ * before their parents, and when only an ancestor changes.
+ */
+u8 transform_world_should_follow_parents() {
+    void* state;
+    u64 size;
+    expect_to_be_true(start_transform_system(16, &state, &size));
+
+    // Created in reverse, so ids are not in hierarchy order.
+    u32 grandchild = transform_from_position_rotation_scale(vec3_create(0.0f, 0.0f, 1.0f), random_rotation(), vec3_one());
+    u32 child = transform_from_position_rotation_scale(vec3_create(0.0f, 2.0f, 0.0f), random_rotation(), vec3_create(2.0f, 2.0f, 2.0f));
+    u32 root = transform_from_position_rotation_scale(vec3_create(5.0f, 0.0f, 0.0f), random_rotation(), vec3_one());
+    expect_to_be_true(transform_set_parent(child, root));
+    expect_to_be_true(transform_set_parent(grandchild, child));
+    expect_should_be(child, transform_get_parent(grandchild));
+
+    transform_system_update();
+
+    mat4 expected = mat4_mul(mat4_mul(transform_get_local(grandchild), transform_get_local(child)), transform_get_local(root));
+    expect_to_be_true(mat4_matches(expected, transform_get_world(grandchild)));
+
+    // Moving only the root moves everything below it.
+    transform_set_position(root, vec3_create(-3.0f, 1.0f, 4.0f));
+    transform_system_update();
+
+    expected = mat4_mul(mat4_mul(transform_get_local(grandchild), transform_get_local(child)), transform_get_local(root));
+    expect_to_be_true(mat4_matches(expected, transform_get_world(grandchild)));
+    expect_float_to_be(-3.0f, transform_get_world(root).data[12]);
+
+    stop_transform_system(state, size);
+    return True;
+}
+
+/**
+ * @brief Tests that cycles are refused, and that destroying a parent turns its children into roots.
+ */
+u8 transform_hierarchy_should_refuse_cycles_and_detach_children() {
+    void* state;
+    u64 size;
+    expect_to_be_true(start_transform_system(16, &state, &size));
+
+    u32 root = transform_from_position_rotation_scale(vec3_create(5.0f, 0.0f, 0.0f), quat_identity(), vec3_one());
+    u32 child = transform_from_position_rotation_scale(vec3_create(0.0f, 2.0f, 0.0f), quat_identity(), vec3_one());
+    expect_to_be_true(transform_set_parent(child, root));
+
+    // Neither a transform nor its descendants can become its parent.
+    expect_to_be_false(transform_set_parent(root, child));
+    expect_to_be_false(transform_set_parent(root, root));
+    expect_should_be(INVALID_ID, transform_get_parent(root));
+
+    transform_system_update();
+    expect_float_to_be(5.0f, transform_get_world(child).data[12]);
+
+    transform_destroy(root);
+    expect_should_be(INVALID_ID, transform_get_parent(child));
+    transform_system_update();
+
+    // The child keeps its local transform, which is now its world transform.
+    expect_float_to_be(0.0f, transform_get_world(child).data[12]);
+    expect_float_to_be(2.0f, transform_get_world(child).data[13]);
+
+    // The destroyed id is reused.
+    u32 reused = transform_create();
+    expect_should_be(root, reused);
+    expect_should_be(INVALID_ID, transform_get_parent(reused));
+
+    stop_transform_system(state, size);
+    return True;
+}
+
+/**
+ * @brief Tests that ids keep their data when the slots are repacked, including when creating a
+ * transform has to repack to reuse the slots of destroyed ones.
+ */
+u8 transform_ids_should_survive_repacking() {
+    void* state;
+    u64 size;
+    expect_to_be_true(start_transform_system(4, &state, &size));
+
+    u32 ids[4];
+    for (u32 i = 0; i < 4; ++i) {
+        ids[i] = transform_from_position_rotation_scale(vec3_create((f32)i, 0.0f, 0.0f), quat_identity(), vec3_one());
+    }
+    // Children first in the slots, so repacking moves them.
+    expect_to_be_true(transform_set_parent(ids[0], ids[3]));
+    expect_to_be_true(transform_set_parent(ids[1], ids[3]));
+    transform_system_update();
+
+    // Every slot is taken until the destroyed ones are repacked away.
+    transform_destroy(ids[2]);
+    transform_destroy(ids[1]);
+    u32 a = transform_from_position_rotation_scale(vec3_create(10.0f, 0.0f, 0.0f), quat_identity(), vec3_one());
+    u32 b = transform_from_position_rotation_scale(vec3_create(20.0f, 0.0f, 0.0f), quat_identity(), vec3_one());
+    expect_should_not_be(INVALID_ID, a);
+    expect_should_not_be(INVALID_ID, b);
+    expect_should_be(INVALID_ID, transform_create());
+    expect_to_be_true(transform_set_parent(b, ids[0]));
+    transform_system_update();
+
+    expect_float_to_be(3.0f, transform_get_world(ids[3]).data[12]);
+    expect_float_to_be(3.0f, transform_get_world(ids[0]).data[12]);
+    expect_float_to_be(10.0f, transform_get_world(a).data[12]);
+    expect_float_to_be(23.0f, transform_get_world(b).data[12]);
+    expect_float_to_be(20.0f, transform_get_position(b).x);
+
+    stop_transform_system(state, size);
+    return True;
+}
+
+/** @brief Marks every benchmark transform dirty, then times the update. Returns the average in milliseconds. */
+static f64 time_benchmark_updates(const u32* ids) {
+    f64 total = 0.0;
+    for (u32 iteration = 0; iteration < TRANSFORM_BENCHMARK_ITERATIONS; ++iteration) {
+        for (u32 i = 0; i < TRANSFORM_BENCHMARK_COUNT; ++i) {
+            transform_set_position(ids[i], vec3_create((f32)iteration, (f32)i, 0.0f));
+        }
+
+        clock c;
+        clock_start(&c);
+        transform_system_update();
+        clock_update(&c);
+        total += c.elapsed;
+    }
+    return total * 1000.0 / TRANSFORM_BENCHMARK_ITERATIONS;
+}
+
+/**
+ * @brief Times the update of 100k dirty transforms in a shallow hierarchy, on the calling thread
+ * alone and then with worker threads. Always passes, as timings vary by machine; the results
+ * are logged instead.
+ */
+u8 transform_system_benchmark() {
+    void* state;
+    u64 size;
+    expect_to_be_true(start_transform_system(TRANSFORM_BENCHMARK_COUNT, &state, &size));
+
+    // Every eighth transform is a root, and the rest children of the transform before them.
+    u32* ids = kallocate(sizeof(u32) * TRANSFORM_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    for (u32 i = 0; i < TRANSFORM_BENCHMARK_COUNT; ++i) {
+        ids[i] = transform_from_position_rotation_scale(random_vec3(-10.0f, 10.0f), random_rotation(), vec3_one());
+        if (i % 8 != 0) {
+            transform_set_parent(ids[i], ids[i - 1]);
+        }
+    }
+    transform_system_update();
+
+    f64 single_thread_ms = time_benchmark_updates(ids);
+
+    void* job_system_state;
+    u64 job_system_size;
+    expect_to_be_true(test_start_job_system(0, 256, &job_system_state, &job_system_size));
+
+    f64 threaded_ms = time_benchmark_updates(ids);
+    KINFO("Updating %u transforms: %.3fms on one thread, %.3fms with %u workers.", TRANSFORM_BENCHMARK_COUNT, single_thread_ms, threaded_ms, job_system_worker_count());
+
+    test_stop_job_system(job_system_state, job_system_size);
+
+    // The last update is still correct.
+    u32 last = ids[TRANSFORM_BENCHMARK_COUNT - 1];
+    mat4 expected = transform_get_local(last);
+    for (u32 parent = transform_get_parent(last); parent != INVALID_ID; parent = transform_get_parent(parent)) {
+        expected = mat4_mul(expected, transform_get_local(parent));
+    }
+    mat4 actual = transform_get_world(last);
+    for (u32 i = 0; i < 16; ++i) {
+        // Positions reach the hundreds of thousands, so compare relative to their size.
+        f32 tolerance = KMAX(0.001f, kabs(expected.data[i]) * 0.0001f);
+        expect_to_be_true(kabs(expected.data[i] - actual.data[i]) <= tolerance);
+    }
+
+    kfree(ids, sizeof(u32) * TRANSFORM_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    stop_transform_system(state, size);
+    return True;
+}
+
+void transform_system_register_tests() {
+    test_manager_register_test(transform_local_should_compose_scale_rotation_translation, "Transform local matrices should be scale, then rotation, then translation");
+    test_manager_register_test(transform_world_should_follow_parents, "Transform world matrices should follow their parents");
+    test_manager_register_test(transform_hierarchy_should_refuse_cycles_and_detach_children, "Transform hierarchy should refuse cycles and detach children of destroyed parents");
+    test_manager_register_test(transform_ids_should_survive_repacking, "Transform ids should keep their data when the slots are repacked");
+    test_manager_register_test(transform_system_benchmark, "Transform system benchmark of 100k transforms");
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+/**
+ * @file transform_system_tests.h
+ * @brief Unit tests for the transform system.
+ *
+ * Contains function declarations for various transform system tests.
+ * All tests are registered via `transform_system_register_tests()`.
+ */
+
+/**
+ * @brief Registers all transform system tests with the test manager.
+ *
+ * Should be called before `test_manager_run_tests()` in main().
+ */
+void transform_system_register_tests();
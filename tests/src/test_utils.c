@@ -0,0 +1,37 @@
+#include "test_utils.h"
+
+#include <core/kmemory.h>
+#include <core/kstring.h>
+#include <platform/filesystem.h>
+#include <systems/job_system.h>
+
+/**
+ * @file test_utils.c
+ * @brief Implementation of the helpers shared by the unit tests.
+ */
+
+b8 test_start_job_system(u32 max_worker_count, u32 max_job_count, void** out_state, u64* out_size) {
+    job_system_config config;
+    config.max_worker_count = max_worker_count;
+    config.max_job_count = max_job_count;
+
+    job_system_initialize(out_size, 0, config);
+    *out_state = kallocate(*out_size, MEMORY_TAG_JOB);
+    return job_system_initialize(out_size, *out_state, config);
+}
+
+void test_stop_job_system(void* state, u64 size) {
+    job_system_shutdown(state);
+    kfree(state, size, MEMORY_TAG_JOB);
+}
+
+b8 test_write_text(const char* path, const char* text) {
+    file_handle f;
+    if (!filesystem_open(path, FILE_MODE_WRITE, True, &f)) {
+        return False;
+    }
+    u64 written = 0;
+    b8 result = filesystem_write(&f, string_length(text), text, &written);
+    filesystem_close(&f);
+    return result;
+}
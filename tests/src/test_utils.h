@@ -0,0 +1,38 @@
+#pragma once
+
+#include <defines.h>
+
+/**
+ * @file test_utils.h
+ * @brief Helpers shared by the unit tests.
+ *
+ * Setup that more than one test file needs lives here rather than being copied into each.
+ */
+
+/**
+ * @brief Starts a job system for a test, allocating its state block.
+ *
+ * @param max_worker_count The most worker threads to start. 0 uses one per spare core.
+ * @param max_job_count The number of job slots.
+ * @param out_state A pointer to hold the state block.
+ * @param out_size A pointer to hold the size of the state block.
+ * @return True if the job system started; otherwise False.
+ */
+b8 test_start_job_system(u32 max_worker_count, u32 max_job_count, void** out_state, u64* out_size);
+
+/**
+ * @brief Stops a job system started with test_start_job_system() and frees its state block.
+ *
+ * @param state The state block.
+ * @param size The size of the state block.
+ */
+void test_stop_job_system(void* state, u64 size);
+
+/**
+ * @brief Writes text to a file, replacing it.
+ *
+ * @param path The path of the file.
+ * @param text The text to write.
+ * @return True if the file was written; otherwise False.
+ */
+b8 test_write_text(const char* path, const char* text);